@@ -0,0 +1,469 @@
+//
+// IPC 服务端压测工具
+// 模拟 N 个驱动客户端（注册 → 轮询音量 → 注销 循环）和 M 个控制客户端
+// （连续设置音量），统计往返延迟分位数和吞吐量，结果以 JSON 输出
+//
+// 用法: ipc_bench [--drivers N] [--controllers M] [--duration SEC]
+//                 [--polls K] [--socket PATH] [--spawn-server]
+//                 [--output FILE]
+//
+
+#include "ipc/ipc_client.h"
+#include "ipc/ipc_protocol.h"
+#include "ipc/ipc_reactor.h"
+#include "ipc/ipc_server.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BENCH_DEFAULT_DRIVERS 8
+#define BENCH_DEFAULT_CONTROLLERS 2
+#define BENCH_DEFAULT_DURATION_SEC 5.0
+#define BENCH_DEFAULT_POLLS 20 // 每次注册后的音量轮询次数
+#define BENCH_PID_BASE 100000  // 模拟 PID 起点（不需要真实进程）
+#define BENCH_PID_STRIDE 10000 // 每个驱动客户端的 PID 区间
+
+// 统计的操作类型
+typedef enum
+{
+  kBenchOpRegister = 0,
+  kBenchOpGetVolume,
+  kBenchOpUnregister,
+  kBenchOpSetVolume,
+  kBenchOpCount
+} BenchOp;
+
+static const char *const kBenchOpNames[kBenchOpCount]
+  = {"register", "get_volume", "unregister", "set_volume"};
+
+// 单个操作的延迟样本（纳秒）
+typedef struct
+{
+  uint64_t *samples;
+  size_t count;
+  size_t capacity;
+  uint64_t errors; // 服务端返回非 OK 状态的次数
+} BenchSamples;
+
+// 每个压测线程的上下文
+typedef struct
+{
+  int index;
+  bool is_driver;
+  uint32_t polls;
+  uint64_t deadline_ns;
+  int drivers; // 控制客户端用于选择目标 PID
+  bool transport_failed;
+  BenchSamples ops[kBenchOpCount];
+} BenchWorker;
+
+// 当前每个驱动客户端注册的 PID（控制客户端据此选择目标）
+static _Atomic pid_t *g_live_pids = NULL;
+
+static uint64_t
+now_ns (void)
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+static int
+samples_push (BenchSamples *s, uint64_t value)
+{
+  if (s->count == s->capacity)
+    {
+      size_t new_cap = s->capacity > 0 ? s->capacity * 2 : 4096;
+      uint64_t *grown = realloc (s->samples, new_cap * sizeof (uint64_t));
+      if (grown == NULL)
+	return -1;
+      s->samples = grown;
+      s->capacity = new_cap;
+    }
+  s->samples[s->count++] = value;
+  return 0;
+}
+
+static int
+compare_u64 (const void *a, const void *b)
+{
+  uint64_t x = *(const uint64_t *) a;
+  uint64_t y = *(const uint64_t *) b;
+  return (x > y) - (x < y);
+}
+
+// 已排序样本的分位数（最近秩法）
+static uint64_t
+percentile (const uint64_t *sorted, size_t count, double p)
+{
+  if (count == 0)
+    return 0;
+  size_t rank = (size_t) (p * (double) count + 0.999999);
+  if (rank == 0)
+    rank = 1;
+  if (rank > count)
+    rank = count;
+  return sorted[rank - 1];
+}
+
+// 发送一次请求并返回服务端状态；传输失败返回 kIPCStatusServiceUnavailable
+static int32_t
+bench_call (IPCClientContext *ctx, uint16_t command, const void *payload,
+	    uint32_t payload_len, BenchSamples *samples)
+{
+  IPCMessageHeader request;
+  ipc_init_header (&request, command, payload_len,
+		   ipc_client_next_request_id (ctx));
+
+  IPCMessageHeader response = {0};
+  uint8_t buffer[IPC_MAX_PAYLOAD_SIZE];
+
+  uint64_t start = now_ns ();
+  if (ipc_client_send_sync (ctx, &request, payload, &response, buffer,
+			    sizeof (buffer))
+      != 0)
+    return kIPCStatusServiceUnavailable;
+  uint64_t elapsed = now_ns () - start;
+
+  int32_t status = kIPCStatusInvalidHeader;
+  if (response.command == kIPCCommandResponse
+      && response.payload_len >= sizeof (IPCResponse))
+    {
+      IPCResponse resp;
+      memcpy (&resp, buffer, sizeof (resp));
+      status = resp.status;
+    }
+
+  samples_push (samples, elapsed);
+  if (status != kIPCStatusOK)
+    samples->errors++;
+  return status;
+}
+
+// 驱动客户端：注册 → 轮询 → 注销，模拟应用频繁启停
+static void
+run_driver (BenchWorker *worker, IPCClientContext *ctx)
+{
+  uint32_t cycle = 0;
+  while (now_ns () < worker->deadline_ns)
+    {
+      pid_t pid = (pid_t) (BENCH_PID_BASE + worker->index * BENCH_PID_STRIDE
+			   + (int) (cycle++ % BENCH_PID_STRIDE));
+
+      uint8_t payload[sizeof (IPCRegisterRequest) + 32];
+      IPCRegisterRequest *req = (IPCRegisterRequest *) payload;
+      req->pid = pid;
+      req->initial_volume = 1.0f;
+      req->muted = false;
+      int name_len = snprintf ((char *) payload + sizeof (IPCRegisterRequest),
+			       32, "bench.driver.%d", worker->index);
+      uint32_t payload_len
+	= (uint32_t) (sizeof (IPCRegisterRequest) + (size_t) name_len + 1);
+
+      if (bench_call (ctx, kIPCCommandRegister, payload, payload_len,
+		      &worker->ops[kBenchOpRegister])
+	  == kIPCStatusServiceUnavailable)
+	{
+	  worker->transport_failed = true;
+	  return;
+	}
+      atomic_store (&g_live_pids[worker->index], pid);
+
+      for (uint32_t i = 0; i < worker->polls; i++)
+	{
+	  if (bench_call (ctx, kIPCCommandGetVolume, &pid, sizeof (pid),
+			  &worker->ops[kBenchOpGetVolume])
+	      == kIPCStatusServiceUnavailable)
+	    {
+	      worker->transport_failed = true;
+	      return;
+	    }
+	}
+
+      atomic_store (&g_live_pids[worker->index], 0);
+      if (bench_call (ctx, kIPCCommandUnregister, &pid, sizeof (pid),
+		      &worker->ops[kBenchOpUnregister])
+	  == kIPCStatusServiceUnavailable)
+	{
+	  worker->transport_failed = true;
+	  return;
+	}
+    }
+}
+
+// 控制客户端：对当前存活的 PID 连续设置音量
+static void
+run_controller (BenchWorker *worker, IPCClientContext *ctx)
+{
+  uint32_t seed = (uint32_t) worker->index * 2654435761u + 1;
+  while (now_ns () < worker->deadline_ns)
+    {
+      seed = seed * 1103515245u + 12345u;
+      int target = worker->drivers > 0 ? (int) (seed % worker->drivers) : 0;
+      pid_t pid = worker->drivers > 0 ? atomic_load (&g_live_pids[target]) : 0;
+
+      IPCSetVolumeRequest req;
+      req.pid = pid > 0 ? pid : BENCH_PID_BASE;
+      req.volume = (float) (seed % 101) / 100.0f;
+
+      if (bench_call (ctx, kIPCCommandSetVolume, &req, sizeof (req),
+		      &worker->ops[kBenchOpSetVolume])
+	  == kIPCStatusServiceUnavailable)
+	{
+	  worker->transport_failed = true;
+	  return;
+	}
+    }
+}
+
+static void *
+worker_thread_func (void *arg)
+{
+  BenchWorker *worker = (BenchWorker *) arg;
+
+  IPCClientContext ctx;
+  ipc_client_init (&ctx);
+  if (ipc_client_connect (&ctx) != 0)
+    {
+      worker->transport_failed = true;
+      return NULL;
+    }
+
+  if (worker->is_driver)
+    run_driver (worker, &ctx);
+  else
+    run_controller (worker, &ctx);
+
+  ipc_client_cleanup (&ctx);
+  return NULL;
+}
+
+static void *
+server_thread_func (void *arg)
+{
+  ipc_server_run ((IPCServerContext *) arg);
+  return NULL;
+}
+
+static void
+write_latency_json (FILE *out, const char *name, BenchSamples *merged,
+		    bool trailing_comma)
+{
+  qsort (merged->samples, merged->count, sizeof (uint64_t), compare_u64);
+  uint64_t max = merged->count > 0 ? merged->samples[merged->count - 1] : 0;
+
+  fprintf (out,
+	   "    \"%s\": {\"count\": %zu, \"errors\": %llu, "
+	   "\"p50_us\": %.2f, \"p99_us\": %.2f, \"p999_us\": %.2f, "
+	   "\"max_us\": %.2f}%s\n",
+	   name, merged->count, (unsigned long long) merged->errors,
+	   percentile (merged->samples, merged->count, 0.50) / 1000.0,
+	   percentile (merged->samples, merged->count, 0.99) / 1000.0,
+	   percentile (merged->samples, merged->count, 0.999) / 1000.0,
+	   max / 1000.0, trailing_comma ? "," : "");
+}
+
+// 合并各线程同类操作的样本
+static void
+merge_samples (BenchSamples *dst, const BenchSamples *src)
+{
+  for (size_t i = 0; i < src->count; i++)
+    samples_push (dst, src->samples[i]);
+  dst->errors += src->errors;
+}
+
+static void
+print_usage (const char *prog)
+{
+  fprintf (stderr,
+	   "用法: %s [选项]\n"
+	   "  --drivers N       模拟驱动客户端数量 (默认 %d)\n"
+	   "  --controllers M   音量控制客户端数量 (默认 %d)\n"
+	   "  --duration SEC    压测时长，秒 (默认 %.0f)\n"
+	   "  --polls K         每次注册后的音量轮询次数 (默认 %d)\n"
+	   "  --socket PATH     目标服务端 socket 路径\n"
+	   "  --spawn-server    在进程内启动服务端（使用临时 socket）\n"
+	   "  --output FILE     JSON 输出文件 (默认 stdout)\n",
+	   prog, BENCH_DEFAULT_DRIVERS, BENCH_DEFAULT_CONTROLLERS,
+	   BENCH_DEFAULT_DURATION_SEC, BENCH_DEFAULT_POLLS);
+}
+
+int
+main (int argc, char *argv[])
+{
+  int drivers = BENCH_DEFAULT_DRIVERS;
+  int controllers = BENCH_DEFAULT_CONTROLLERS;
+  double duration = BENCH_DEFAULT_DURATION_SEC;
+  uint32_t polls = BENCH_DEFAULT_POLLS;
+  const char *socket_path = NULL;
+  const char *output_path = NULL;
+  bool spawn_server = false;
+
+  for (int i = 1; i < argc; i++)
+    {
+      const char *arg = argv[i];
+      bool has_value = i + 1 < argc;
+      if (strcmp (arg, "--drivers") == 0 && has_value)
+	drivers = atoi (argv[++i]);
+      else if (strcmp (arg, "--controllers") == 0 && has_value)
+	controllers = atoi (argv[++i]);
+      else if (strcmp (arg, "--duration") == 0 && has_value)
+	duration = atof (argv[++i]);
+      else if (strcmp (arg, "--polls") == 0 && has_value)
+	polls = (uint32_t) atoi (argv[++i]);
+      else if (strcmp (arg, "--socket") == 0 && has_value)
+	socket_path = argv[++i];
+      else if (strcmp (arg, "--output") == 0 && has_value)
+	output_path = argv[++i];
+      else if (strcmp (arg, "--spawn-server") == 0)
+	spawn_server = true;
+      else
+	{
+	  print_usage (argv[0]);
+	  return 2;
+	}
+    }
+
+  if (drivers < 0 || controllers < 0 || drivers + controllers == 0
+      || duration <= 0.0)
+    {
+      print_usage (argv[0]);
+      return 2;
+    }
+
+  char temp_socket[128];
+  if (spawn_server && socket_path == NULL)
+    {
+      snprintf (temp_socket, sizeof (temp_socket), "/tmp/audioctl_bench_%d.sock",
+		(int) getpid ());
+      socket_path = temp_socket;
+    }
+  if (socket_path != NULL)
+    setenv (IPC_SOCKET_PATH_ENV, socket_path, 1);
+
+  // 服务端日志写 stdout，进程内启动时把它重定向到 stderr，保证 JSON 干净
+  FILE *out = stdout;
+  if (output_path != NULL)
+    {
+      out = fopen (output_path, "w");
+      if (out == NULL)
+	{
+	  perror ("fopen");
+	  return 1;
+	}
+    }
+  else if (spawn_server)
+    {
+      int json_fd = dup (STDOUT_FILENO);
+      fflush (stdout);
+      dup2 (STDERR_FILENO, STDOUT_FILENO);
+      out = json_fd >= 0 ? fdopen (json_fd, "w") : NULL;
+      if (out == NULL)
+	return 1;
+    }
+
+  IPCServerContext server;
+  pthread_t server_thread;
+  if (spawn_server)
+    {
+      if (ipc_server_init (&server) != 0
+	  || pthread_create (&server_thread, NULL, server_thread_func, &server)
+	       != 0)
+	{
+	  fprintf (stderr, "无法启动进程内服务端\n");
+	  return 1;
+	}
+    }
+
+  int total = drivers + controllers;
+  BenchWorker *workers = calloc ((size_t) total, sizeof (BenchWorker));
+  pthread_t *threads = calloc ((size_t) total, sizeof (pthread_t));
+  g_live_pids = calloc ((size_t) (drivers > 0 ? drivers : 1), sizeof (pid_t));
+  if (workers == NULL || threads == NULL || g_live_pids == NULL)
+    {
+      fprintf (stderr, "内存不足\n");
+      return 1;
+    }
+
+  uint64_t start = now_ns ();
+  uint64_t deadline = start + (uint64_t) (duration * 1e9);
+  for (int i = 0; i < total; i++)
+    {
+      workers[i].index = i < drivers ? i : i - drivers;
+      workers[i].is_driver = i < drivers;
+      workers[i].polls = polls;
+      workers[i].deadline_ns = deadline;
+      workers[i].drivers = drivers;
+      if (pthread_create (&threads[i], NULL, worker_thread_func, &workers[i])
+	  != 0)
+	{
+	  fprintf (stderr, "无法创建压测线程\n");
+	  return 1;
+	}
+    }
+
+  for (int i = 0; i < total; i++)
+    pthread_join (threads[i], NULL);
+  double elapsed_sec = (double) (now_ns () - start) / 1e9;
+
+  if (spawn_server)
+    {
+      ipc_server_stop (&server);
+      pthread_join (server_thread, NULL);
+      ipc_server_cleanup (&server);
+    }
+
+  // 汇总
+  BenchSamples merged[kBenchOpCount];
+  BenchSamples all;
+  memset (merged, 0, sizeof (merged));
+  memset (&all, 0, sizeof (all));
+  int failed_workers = 0;
+  for (int i = 0; i < total; i++)
+    {
+      if (workers[i].transport_failed)
+	failed_workers++;
+      for (int op = 0; op < kBenchOpCount; op++)
+	{
+	  merge_samples (&merged[op], &workers[i].ops[op]);
+	  merge_samples (&all, &workers[i].ops[op]);
+	  free (workers[i].ops[op].samples);
+	}
+    }
+
+  fprintf (out, "{\n");
+  fprintf (out, "  \"backend\": \"%s\",\n", ipc_reactor_backend_name ());
+  fprintf (out, "  \"drivers\": %d,\n", drivers);
+  fprintf (out, "  \"controllers\": %d,\n", controllers);
+  fprintf (out, "  \"polls_per_cycle\": %u,\n", polls);
+  fprintf (out, "  \"duration_sec\": %.3f,\n", elapsed_sec);
+  fprintf (out, "  \"messages\": %zu,\n", all.count);
+  fprintf (out, "  \"msgs_per_sec\": %.1f,\n",
+	   elapsed_sec > 0.0 ? (double) all.count / elapsed_sec : 0.0);
+  fprintf (out, "  \"failed_clients\": %d,\n", failed_workers);
+  fprintf (out, "  \"latency\": {\n");
+  for (int op = 0; op < kBenchOpCount; op++)
+    write_latency_json (out, kBenchOpNames[op], &merged[op], true);
+  write_latency_json (out, "all", &all, false);
+  fprintf (out, "  }\n");
+  fprintf (out, "}\n");
+
+  if (out != stdout)
+    fclose (out);
+
+  for (int op = 0; op < kBenchOpCount; op++)
+    free (merged[op].samples);
+  free (all.samples);
+  free (workers);
+  free (threads);
+  free ((void *) g_live_pids);
+
+  // 所有客户端都失败说明服务端不可用
+  return (failed_workers == total) ? 1 : 0;
+}
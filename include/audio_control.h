@@ -54,6 +54,10 @@ find_device_by_uid (const char *uid);
 const char *
 getTransportTypeName (UInt32 transportType);
 
+// 输出设备当前数据源是否为耳机（内建耳机孔或报告数据源的外接声卡）
+Boolean
+isHeadphoneDevice (AudioDeviceID deviceId);
+
 const char *
 getFormatFlagsDescription (UInt32 formatFlags);
 
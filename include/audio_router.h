@@ -10,25 +10,131 @@
 #include <CoreAudio/CoreAudio.h>
 #include <stdatomic.h>
 #include <stdbool.h>
+#include "ipc/ipc_protocol.h"
+#include "router/router_convert.h"
+#include "router/router_dsp.h"
+#include "router/router_loudness.h"
+#include "router/router_pipeline.h"
 
-// 环形缓冲区大小（约 42ms @ 48kHz，双声道）- 优化延迟
-#define ROUTER_BUFFER_FRAME_COUNT 2048
-#define ROUTER_MAX_CHANNELS 2
-// 位掩码：2048-1 = 0x7FF，用于快速索引
-#define ROUTER_BUFFER_MASK (ROUTER_BUFFER_FRAME_COUNT * ROUTER_MAX_CHANNELS - 1)
+// 预分配区
+#define ROUTER_SCRATCH_FRAMES 4096 // 暂存区帧数（单次回调上限）
 
-// 环形缓冲区结构
+// 监控周期（毫秒）
+#define ROUTER_MONITOR_DEFAULT_INTERVAL_MS 5000
+#define ROUTER_MONITOR_MIN_INTERVAL_MS 100
+// 进程内保留的监控快照数量
+#define ROUTER_STATS_HISTORY IPC_ROUTER_STATS_HISTORY
+
+// 端到端延迟测量
+#define ROUTER_TIMESTAMP_TAGS 64     // 输入块时间戳槽位数（2 的幂）
+#define ROUTER_LATENCY_BUCKET_US 250 // 延迟直方图桶宽
+#define ROUTER_LATENCY_BUCKETS 512   // 桶数（覆盖 128ms，最后一桶为溢出）
+
+// 回调负载：耗时超过 IO 周期的该百分比即记为一次超时
+#define ROUTER_LOAD_DEFAULT_THRESHOLD_PERCENT 80
+
+// 空闲模式：输入连续静音超过该时长后进入低活动模式
+#define ROUTER_IDLE_DEFAULT_TIMEOUT_MS 10000
+#define ROUTER_IDLE_MONITOR_INTERVAL_FACTOR 4 // 空闲时监控周期放大倍数
+
+// 整数输出：等待虚拟格式生效的次数（每次 10ms）
+#define ROUTER_FORMAT_SETTLE_TRIES 20
+
+// 实时事件追踪
+#define ROUTER_TRACE_EVENTS 4096	     // 每个 IOProc 的事件槽位数（2 的幂）
+#define ROUTER_TRACE_DRAIN_INTERVAL_MS 250 // 导出线程的写盘周期
+
+// 频谱分析：没有频谱帧订阅者时抽头关闭，按该周期询问服务端是否有人订阅
+#define ROUTER_SPECTRUM_PROBE_INTERVAL_MS 1000
+
+// 输入块时间戳：记录某个帧序号进入输入 IOProc 的主机时间
+// 输入回调写入，输出回调按帧序号查找；写入顺序为 host_time -> frame_start，
+// 读取后复核 frame_start 以丢弃被覆盖的槽位
 typedef struct
 {
-  float *buffer;
-  uint32_t capacity;
-  atomic_uint write_pos;
-  atomic_uint read_pos;
-  // 性能监控
-  atomic_uint peak_usage;	// 峰值使用率 (0-100%)
-  atomic_uint current_usage;	// 当前使用率
-  atomic_uint samples_buffered; // 当前缓存的采样数
-} RouterRingBuffer;
+  _Atomic uint64_t frame_start; // 块首帧的累计帧序号
+  _Atomic uint64_t host_time;	// 块首帧的输入时间戳 (mHostTime)
+} RouterTimestampTag;
+
+// 端到端延迟统计（输出回调写入，监控线程按周期读取并清零）
+typedef struct
+{
+  RouterTimestampTag tags[ROUTER_TIMESTAMP_TAGS];
+  _Atomic uint64_t tag_count;	// 已写入的时间戳数量
+  uint64_t frames_written;	// 已写入环形缓冲区的帧数（仅输入回调）
+  uint64_t frames_read;		// 已从环形缓冲区读出的帧数（仅输出回调）
+  uint64_t device_latency_ns;	// 设备延迟 + 安全偏移（启动时查询）
+  _Atomic uint32_t histogram[ROUTER_LATENCY_BUCKETS];
+  _Atomic uint64_t sum_us;
+  _Atomic uint32_t count;
+  _Atomic uint32_t min_us;
+  _Atomic uint32_t max_us;
+} RouterLatencyTracker;
+
+// IOProc 负载统计（回调写入，监控线程按周期读取并清零）
+typedef struct
+{
+  _Atomic uint64_t busy_ns;	  // 周期内回调耗时之和
+  _Atomic uint64_t period_ns;	  // 周期内对应 IO 周期长度之和
+  _Atomic uint32_t peak_permille; // 周期内单次回调的峰值负载
+  _Atomic uint32_t overruns;	  // 周期内超过阈值的回调次数
+} RouterCallbackLoad;
+
+// 监控快照槽位
+// 只有监控线程写入；读者通过序列号检测并丢弃写入中或已被覆盖的槽位
+typedef struct
+{
+  _Atomic uint32_t sequence; // 奇数表示正在写入
+  IPCRouterStatsSnapshot snapshot;
+} RouterStatsSlot;
+
+// 监控快照环（单写者、多读者、无锁）
+typedef struct
+{
+  RouterStatsSlot slots[ROUTER_STATS_HISTORY];
+  _Atomic uint64_t published; // 已发布的快照总数
+} RouterStatsRing;
+
+// 追踪事件类型
+typedef enum
+{
+  kRouterTraceInputCallback = 0,  // 输入 IOProc 一次回调
+  kRouterTraceOutputCallback = 1, // 输出 IOProc 一次回调
+  kRouterTraceOverrun = 2,	  // 环形缓冲区空间不足，输入块被丢弃
+  kRouterTraceUnderrun = 3,	  // 环形缓冲区数据不足，输出静音
+  kRouterTraceLoadOverrun = 4,	  // 回调耗时超过负载阈值
+} RouterTraceEventType;
+
+// 追踪事件（由 IOProc 写入，导出线程转换为 Chrome trace JSON）
+typedef struct
+{
+  uint64_t host_time;	// 回调开始时的主机时间 (mach_absolute_time)
+  uint32_t duration_ns; // 回调耗时（xrun 事件为 0）
+  uint32_t fill_frames; // 事件发生时环形缓冲区中的帧数
+  uint32_t frames;	// 本次回调请求的帧数
+  uint32_t type;	// RouterTraceEventType
+} RouterTraceEvent;
+
+// 追踪事件环（每个 IOProc 一个：单生产者、单消费者、无锁、预分配）
+// 写满时丢弃新事件并计数，不阻塞实时线程
+typedef struct
+{
+  RouterTraceEvent events[ROUTER_TRACE_EVENTS];
+  _Atomic uint64_t head;    // 已写入事件数（仅 IOProc 写）
+  _Atomic uint64_t tail;    // 已导出事件数（仅导出线程写）
+  _Atomic uint64_t dropped; // 因环满丢弃的事件数
+} RouterTraceRing;
+
+// 预分配内存区（首次启动时映射、预缺页并 mlock，之后复用，不释放）
+// 只容纳环形缓冲区、暂存区和追踪事件环；DSP 状态随各模块的生命周期
+// 单独锁定分配 (router_locked_alloc)
+typedef struct
+{
+  uint8_t *base; // 起始地址
+  size_t size;	 // 总字节数
+  size_t used;	 // 已划分字节数
+  bool locked;	 // mlock 是否成功
+} RouterArena;
 
 // Router 上下文
 typedef struct
@@ -40,18 +146,34 @@ typedef struct
   AudioDeviceIOProcID output_proc_id;
 
   RouterRingBuffer ring_buffer;
+  float *ring_storage; // 环形缓冲区存储（位于预分配区）
+  float *scratch;      // 回调暂存区，ROUTER_SCRATCH_FRAMES 帧（位于预分配区）
+  float *convert;      // 整数输出的渲染区，ROUTER_SCRATCH_FRAMES 帧（位于预分配区）
   bool is_running;
 
   // 音频格式信息
   uint32_t sample_rate;
   uint32_t channels;
   uint32_t bits_per_channel;
+  RouterSampleFormat output_format; // 输出回调缓冲区的采样格式
 
   // 统计信息 (使用原子变量确保线程安全)
   _Atomic uint64_t frames_transferred;
   _Atomic uint32_t underrun_count;
   _Atomic uint32_t overrun_count;
 
+  // 静音检测（输入回调写入）
+  _Atomic uint64_t silent_frames;     // 累计整块静音的输入帧数
+  _Atomic uint64_t silent_run_frames; // 当前连续静音的帧数（有声时清零）
+  _Atomic bool idle;		      // 是否处于空闲（低活动）模式
+
+  // 端到端延迟（基于 IOProc 时间戳）
+  RouterLatencyTracker latency;
+
+  // 回调负载
+  RouterCallbackLoad input_load;
+  RouterCallbackLoad output_load;
+
   // 性能监控
   _Atomic uint32_t latency_ms;	// 当前延迟 (毫秒)
   _Atomic float watermark_peak; // Watermark 峰值 (0.0-1.0)
@@ -64,6 +186,8 @@ typedef struct
 
 /**
  * 获取 Router 性能监控信息
+ * latency_ms 为缓冲延迟估算（缓存帧数 / 采样率）；基于 IOProc 时间戳的
+ * 端到端延迟见 audio_router_get_stats_history 返回的快照
  *
  * @param latency_ms 当前延迟毫秒数
  * @param watermark_peak 缓冲区使用峰值 (0.0-1.0)
@@ -74,6 +198,128 @@ bool
 audio_router_get_performance_info (uint32_t *latency_ms, float *watermark_peak,
 				   uint32_t *buffered_frames);
 
+/**
+ * 设置监控周期
+ * 在下一个周期开始时生效；停止 Router 不受周期影响，会立即唤醒监控线程
+ *
+ * @param interval_ms 周期毫秒数（小于 ROUTER_MONITOR_MIN_INTERVAL_MS 时取最小值）
+ */
+void
+audio_router_set_monitor_interval (uint32_t interval_ms);
+
+/**
+ * 设置回调负载超时阈值
+ * 单次回调耗时超过 IO 周期（请求帧数 / 采样率）的该百分比时计为一次超时，
+ * 计入快照并写入追踪时间线；可在运行中调用
+ *
+ * @param percent 百分比（1-100，超出范围时截断）
+ */
+void
+audio_router_set_load_threshold (uint32_t percent);
+
+/**
+ * 替换输出通路的 DSP 链（可在 Router 运行中调用）
+ * 链跨启动保留；Router 启动时按设备格式重新 prepare 所有处理器，运行中
+ * 加入的处理器立即 prepare。返回后不在新链中的处理器可以安全销毁
+ * 默认链为 参数均衡器 -> 卷积器 -> 交叉馈送 -> 预读限制器（前三者的
+ * 配置由 IPC 服务下发），替换后这些处理器不再生效
+ *
+ * @param processors 处理器数组（按处理顺序），count 为 0 时可为 NULL
+ * @param count 级数（不超过 ROUTER_DSP_MAX_STAGES）
+ * @return 成功返回 0，失败返回 -1（原链保持不变）
+ */
+int
+audio_router_set_dsp_chain (RouterDspProcessor *const *processors,
+			    uint32_t count);
+
+/**
+ * 旁路或恢复 DSP 链中的某一级（立即生效）
+ *
+ * @param index 级序号
+ * @param bypass true 跳过该级
+ * @return 成功返回 0，序号无效返回 -1
+ */
+int
+audio_router_set_dsp_bypass (uint32_t index, bool bypass);
+
+/**
+ * 设置输出限制器参数（默认链的最后一级）
+ * 释放时间和上限立即生效；预读时长决定限制器引入的延迟，在下次启动
+ * （prepare）时生效
+ *
+ * @param lookahead_ms 预读时长（1-5 ms）
+ * @param release_ms 释放时间（1-5000 ms）
+ * @param ceiling_db 输出真峰值上限（-24-0 dBTP）
+ * @return 成功返回 0，参数超出范围返回 -1（原参数保持不变）
+ */
+int
+audio_router_set_limiter (float lookahead_ms, float release_ms,
+			  float ceiling_db);
+
+/**
+ * 读取主输出（DSP 链之后）的响度读数（无锁，可在任意线程调用）
+ * 每个监控周期同时上报给 IPC 服务，CLI 通过 audioctl loudness 读取
+ *
+ * @param reading 输出读数；Router 未启动过时各项为 ROUTER_LOUDNESS_MIN_LUFS
+ */
+void
+audio_router_get_loudness (RouterLoudnessReading *reading);
+
+/**
+ * 设置空闲超时
+ * 输入连续静音超过该时长后 Router 进入空闲模式：监控周期放大
+ * ROUTER_IDLE_MONITOR_INTERVAL_FACTOR 倍，追踪只记录 xrun 不再记录每次回调；
+ * 输入恢复有声时立即退出。静音块本身始终走快速路径，与是否空闲无关
+ *
+ * @param timeout_ms 超时毫秒数，0 表示不进入空闲模式
+ */
+void
+audio_router_set_idle_timeout (uint32_t timeout_ms);
+
+/**
+ * 设置是否以整数格式直接输出（在 audio_router_start 之前调用）
+ * 启用后启动时读取输出流的物理格式：若为 16/24/32 位整数，把虚拟格式设为
+ * 同一格式（不可混音，其他应用无法同时使用该设备），由 Router 完成转换和
+ * 抖动，省去 HAL 转换器的一次拷贝；设备不接受时退回 Float32。停止时恢复
+ * 原来的虚拟格式
+ *
+ * @param enable 是否启用（默认关闭）
+ */
+void
+audio_router_set_integer_output (bool enable);
+
+/**
+ * 设置整数输出的抖动模式（在 audio_router_start 之前调用，默认 TPDF）
+ *
+ * @param mode 抖动模式
+ * @return 成功返回 0，模式无效返回 -1
+ */
+int
+audio_router_set_dither (RouterDitherMode mode);
+
+/**
+ * 读取最近的监控快照（无锁，可在任意线程调用）
+ * 每个周期的快照同时上报给 IPC 服务，CLI 通过 audioctl router-stats 读取
+ *
+ * @param snapshots 输出数组（按时间顺序，最旧在前）
+ * @param max_snapshots 数组容量
+ * @return 写入的快照数量
+ */
+uint32_t
+audio_router_get_stats_history (IPCRouterStatsSnapshot *snapshots,
+				uint32_t max_snapshots);
+
+/**
+ * 设置实时事件追踪文件（在 audio_router_start 之前调用）
+ * 启用后两个 IOProc 的每次回调以及欠载/过载都会记录时间戳、缓冲区帧数、
+ * 请求帧数和回调耗时，由后台线程周期性写成 Chrome trace JSON（数组格式，
+ * 进程被杀时文件缺少结尾的 ] 也能被 chrome://tracing 和 Perfetto 打开）
+ *
+ * @param path 输出文件路径，NULL 或空字符串表示关闭追踪
+ */
+void
+audio_router_set_trace_file (const char *path);
+
 /**
  * 设置日志输出模式
  * @param enable true 使用控制台 printf 输出，false 使用 os_log
@@ -19,9 +19,13 @@ app_volume_driver_init (void);
 void
 app_volume_driver_cleanup (void);
 
+// 后台连接管理线程是否已连上 IPC 服务（原子读取，可在实时线程调用）
+bool
+app_volume_driver_is_connected (void);
+
 #pragma mark - 客户端管理
 
-// 添加客户端（bundleId 和 name 暂时保留参数但内部未使用）
+// 添加客户端（name 为空时使用 bundleId 作为注册名称，注册异步完成）
 OSStatus
 app_volume_driver_add_client (UInt32 clientID, pid_t pid, const char *bundleId,
 			      const char *name);
@@ -54,7 +58,7 @@ app_volume_driver_get_client_pids (pid_t *outPids, UInt32 maxCount,
 
 #pragma mark - 音量应用
 
-// 获取指定客户端的音量（简化版本返回默认值）
+// 获取指定客户端已发布的音量（无锁，不访问 IPC）
 Float32
 app_volume_driver_get_volume (UInt32 clientID, bool *outIsMuted);
 
@@ -0,0 +1,246 @@
+//
+// 异步流水线 IPC 客户端
+// 单连接上允许多个未完成请求，响应按 request_id 匹配，事件消息复用同一连接
+//
+
+#ifndef AUDIOCTL_IPC_ASYNC_CLIENT_H
+#define AUDIOCTL_IPC_ASYNC_CLIENT_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "ipc/ipc_protocol.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// 配置
+// ============================================================================
+
+#define IPC_ASYNC_MAX_PENDING 64		// 最大未完成请求数
+#define IPC_ASYNC_SEND_BUFFER_SIZE (64 * 1024)	// 发送队列大小
+#define IPC_ASYNC_DEFAULT_TIMEOUT_MS 5000	// 默认请求超时
+
+// ============================================================================
+// 回调类型
+// ============================================================================
+
+/**
+ * 请求完成回调（在客户端 IO 线程中调用，不得长时间阻塞）
+ *
+ * @param user_data 提交请求时传入的用户数据
+ * @param status 服务端状态码；超时返回 kIPCStatusServiceUnavailable
+ * @param data IPCResponse 之后的附加数据（可为 NULL）
+ * @param data_len 附加数据长度
+ */
+typedef void (*IPCAsyncCallback) (void *user_data, int32_t status,
+				  const void *data, uint32_t data_len);
+
+/**
+ * 事件回调（在客户端 IO 线程中调用）
+ *
+ * @param user_data 注册时传入的用户数据
+ * @param topic 事件主题 (IPCEventTopic)
+ * @param data 事件数据
+ * @param data_len 事件数据长度
+ */
+typedef void (*IPCEventCallback) (void *user_data, uint32_t topic,
+				  const void *data, uint32_t data_len);
+
+// ============================================================================
+// 数据结构
+// ============================================================================
+
+// 未完成请求表项
+typedef struct IPCAsyncPending
+{
+  bool in_use;
+  uint32_t request_id;	   // 请求ID
+  uint64_t deadline_ms;	   // 超时时间点（单调时钟毫秒）
+  IPCAsyncCallback callback; // 完成回调
+  void *user_data;	   // 用户数据
+} IPCAsyncPending;
+
+// Future：把回调转换为可等待的结果
+typedef struct IPCAsyncFuture
+{
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  bool done;
+  int32_t status;
+  uint32_t data_len;
+  uint8_t data[IPC_MAX_PAYLOAD_SIZE];
+} IPCAsyncFuture;
+
+// 异步客户端上下文
+typedef struct IPCAsyncClient
+{
+  int fd;		      // Socket 文件描述符（非阻塞）
+  int wake_fds[2];	      // 唤醒 IO 线程的管道
+  atomic_bool connected;      // 连接状态
+  atomic_bool running;	      // IO 线程运行标志
+  pthread_t io_thread;	      // IO 线程
+  bool io_thread_started;     // IO 线程是否已创建
+  uint32_t timeout_ms;	      // 请求超时
+  pthread_mutex_t lock;	      // 保护未完成请求表和发送队列
+  IPCAsyncPending pending[IPC_ASYNC_MAX_PENDING];
+  uint32_t pending_count;     // 未完成请求数
+  uint32_t next_request_id;   // 下一个请求ID（0 保留给事件）
+  uint8_t *send_buf;	      // 待发送数据
+  size_t send_len;	      // 待发送字节数
+  uint8_t *recv_buf;	      // 接收缓冲区（仅 IO 线程访问）
+  size_t recv_len;	      // 已接收字节数
+  IPCEventCallback event_callback; // 事件回调
+  void *event_user_data;	   // 事件回调用户数据
+} IPCAsyncClient;
+
+// ============================================================================
+// 客户端 API
+// ============================================================================
+
+/**
+ * 初始化异步客户端
+ *
+ * @param client 客户端上下文指针
+ * @param event_callback 事件回调（可为 NULL）
+ * @param user_data 事件回调用户数据
+ * @return 成功返回 0，失败返回 -1
+ */
+int
+ipc_async_client_init (IPCAsyncClient *client, IPCEventCallback event_callback,
+		       void *user_data);
+
+/**
+ * 连接到 IPC 服务端并启动 IO 线程
+ *
+ * @param client 客户端上下文指针
+ * @return 成功返回 0，失败返回 -1
+ */
+int
+ipc_async_client_connect (IPCAsyncClient *client);
+
+/**
+ * 断开连接并停止 IO 线程
+ * 所有未完成请求以 kIPCStatusServiceUnavailable 完成
+ *
+ * @param client 客户端上下文指针
+ */
+void
+ipc_async_client_disconnect (IPCAsyncClient *client);
+
+/**
+ * 释放客户端资源
+ *
+ * @param client 客户端上下文指针
+ */
+void
+ipc_async_client_cleanup (IPCAsyncClient *client);
+
+/**
+ * 检查是否已连接
+ *
+ * @param client 客户端上下文指针
+ * @return 已连接返回 true
+ */
+bool
+ipc_async_client_is_connected (IPCAsyncClient *client);
+
+/**
+ * 设置请求超时
+ *
+ * @param client 客户端上下文指针
+ * @param timeout_ms 超时毫秒数
+ */
+void
+ipc_async_client_set_timeout (IPCAsyncClient *client, uint32_t timeout_ms);
+
+/**
+ * 提交异步请求（不阻塞）
+ * 请求写入发送队列后立即返回，响应到达时在 IO 线程中调用回调。
+ * 返回 0 时回调恰好调用一次（响应、超时或断开）；返回 -1 时请求未登记，
+ * 回调不会被调用，user_data 可以立即释放
+ *
+ * @param client 客户端上下文指针
+ * @param command 指令类型
+ * @param payload 请求负载（可为 NULL）
+ * @param payload_len 负载长度
+ * @param callback 完成回调（可为 NULL，表示不关心结果）
+ * @param user_data 回调用户数据
+ * @param out_request_id 输出分配的请求ID（可为 NULL）
+ * @return 成功返回 0；未连接、请求表满或发送队列满返回 -1
+ */
+int
+ipc_async_client_request (IPCAsyncClient *client, uint16_t command,
+			  const void *payload, uint32_t payload_len,
+			  IPCAsyncCallback callback, void *user_data,
+			  uint32_t *out_request_id);
+
+/**
+ * 订阅事件主题（异步）
+ *
+ * @param client 客户端上下文指针
+ * @param topics IPCEventTopic 位掩码，0 表示取消所有订阅
+ * @param callback 完成回调（可为 NULL）
+ * @param user_data 回调用户数据
+ * @return 成功返回 0，失败返回 -1
+ */
+int
+ipc_async_client_subscribe (IPCAsyncClient *client, uint32_t topics,
+			    IPCAsyncCallback callback, void *user_data);
+
+// ============================================================================
+// Future API
+// ============================================================================
+
+/**
+ * 初始化 Future
+ *
+ * @param future Future 指针
+ */
+void
+ipc_async_future_init (IPCAsyncFuture *future);
+
+/**
+ * 销毁 Future
+ *
+ * @param future Future 指针
+ */
+void
+ipc_async_future_destroy (IPCAsyncFuture *future);
+
+/**
+ * 以 Future 形式提交请求
+ *
+ * @param client 客户端上下文指针
+ * @param command 指令类型
+ * @param payload 请求负载（可为 NULL）
+ * @param payload_len 负载长度
+ * @param future 已初始化的 Future
+ * @return 成功返回 0；失败返回 -1，此时 Future 不会被完成，可以立即销毁
+ */
+int
+ipc_async_client_request_future (IPCAsyncClient *client, uint16_t command,
+				 const void *payload, uint32_t payload_len,
+				 IPCAsyncFuture *future);
+
+/**
+ * 等待 Future 完成
+ * 超时返回后 Future 仍被请求表引用，必须等到它完成（请求超时或客户端
+ * 断开时都会完成）才能销毁
+ *
+ * @param future Future 指针
+ * @param timeout_ms 最长等待毫秒数
+ * @return 完成返回 true，超时返回 false
+ */
+bool
+ipc_async_future_wait (IPCAsyncFuture *future, uint32_t timeout_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIOCTL_IPC_ASYNC_CLIENT_H
@@ -29,6 +29,7 @@ typedef struct IPCClientContext
   bool cached_muted;	    // 缓存的静音状态
   uint64_t cache_timestamp; // 缓存时间戳
   bool cache_valid;	    // 缓存是否有效
+  uint32_t next_request_id; // 下一个请求ID（0 保留给服务端事件）
 } IPCClientContext;
 
 // ============================================================================
@@ -103,14 +104,24 @@ int
 ipc_client_recv (IPCClientContext *ctx, IPCMessageHeader *header, void *payload,
 		 size_t payload_size);
 
+/**
+ * 分配下一个请求ID（跳过保留值 0）
+ *
+ * @param ctx 客户端上下文指针
+ * @return 请求ID
+ */
+uint32_t
+ipc_client_next_request_id (IPCClientContext *ctx);
+
 /**
  * 发送请求并等待响应（同步调用）
+ * 只接受 request_id 与请求一致的响应，期间收到的事件消息会被丢弃
  *
  * @param ctx 客户端上下文指针
  * @param request_header 请求头
  * @param request_payload 请求负载
  * @param response_header 输出响应头
- * @param response_payload 输出响应负载
+ * @param response_payload 输出响应负载（超出缓冲区的部分被截断）
  * @param response_size 响应缓冲区大小
  * @return 成功返回 0，失败返回 -1
  */
@@ -262,6 +273,244 @@ int
 ipc_client_list_apps (IPCClientContext *ctx, IPCAppInfo **apps,
 		      uint32_t *count);
 
+// ============================================================================
+// 服务端统计
+// ============================================================================
+
+/**
+ * 获取服务端统计（kIPCCommandGetStats，条目多于单帧容量时自动分页）
+ *
+ * @param ctx 客户端上下文指针
+ * @param stats 输出整体统计
+ * @param commands 输出各指令统计数组（可为 NULL）
+ * @param max_commands commands 数组容量（IPC_STATS_MAX_COMMANDS 可容纳全部）
+ * @param count 输出写入 commands 的条目数（可为 NULL）
+ * @return 成功返回 0，失败返回 -1
+ */
+int
+ipc_client_get_stats (IPCClientContext *ctx, IPCServerStats *stats,
+		      IPCCommandStats *commands, uint32_t max_commands,
+		      uint32_t *count);
+
+/**
+ * 获取最近的 Router 性能快照（kIPCCommandGetRouterStats）
+ *
+ * @param ctx 客户端上下文指针
+ * @param snapshots 输出快照数组（按时间顺序，最旧在前）
+ * @param max_snapshots 数组容量
+ * @param count 输出快照数量
+ * @return 成功返回 0，失败返回 -1
+ */
+int
+ipc_client_get_router_stats (IPCClientContext *ctx,
+			     IPCRouterStatsSnapshot *snapshots,
+			     uint32_t max_snapshots, uint32_t *count);
+
+/**
+ * 获取均衡器配置（kIPCCommandGetEqualizer）
+ *
+ * @param ctx 客户端上下文指针
+ * @param config 输出配置
+ * @return 成功返回 0，失败返回 -1
+ */
+int
+ipc_client_get_equalizer (IPCClientContext *ctx, IPCEqualizerConfig *config);
+
+/**
+ * 设置均衡器配置（kIPCCommandSetEqualizer）
+ *
+ * @param ctx 客户端上下文指针
+ * @param config 新配置
+ * @return 成功返回 0；服务不可用或参数超出范围返回 -1
+ */
+int
+ipc_client_set_equalizer (IPCClientContext *ctx,
+			  const IPCEqualizerConfig *config);
+
+/**
+ * 获取响度均衡配置（kIPCCommandGetNormalizer）
+ *
+ * @param ctx 客户端上下文指针
+ * @param config 输出配置
+ * @return 成功返回 0，失败返回 -1
+ */
+int
+ipc_client_get_normalizer (IPCClientContext *ctx, IPCNormalizerConfig *config);
+
+/**
+ * 设置响度均衡配置（kIPCCommandSetNormalizer）
+ *
+ * @param ctx 客户端上下文指针
+ * @param config 新配置
+ * @return 成功返回 0；服务不可用或参数超出范围返回 -1
+ */
+int
+ipc_client_set_normalizer (IPCClientContext *ctx,
+			   const IPCNormalizerConfig *config);
+
+/**
+ * 获取闪避规则（kIPCCommandGetDucking）
+ *
+ * @param ctx 客户端上下文指针
+ * @param config 输出配置
+ * @return 成功返回 0，失败返回 -1
+ */
+int
+ipc_client_get_ducking (IPCClientContext *ctx, IPCDuckingConfig *config);
+
+/**
+ * 设置闪避规则（kIPCCommandSetDucking）
+ *
+ * @param ctx 客户端上下文指针
+ * @param config 新配置
+ * @return 成功返回 0；服务不可用或参数超出范围返回 -1
+ */
+int
+ipc_client_set_ducking (IPCClientContext *ctx,
+			const IPCDuckingConfig *config);
+
+/**
+ * 获取各应用的声道混合规则（kIPCCommandGetChannelMix）
+ *
+ * @param ctx 客户端上下文指针
+ * @param config 输出规则表
+ * @return 成功返回 0，失败返回 -1
+ */
+int
+ipc_client_get_channel_mix (IPCClientContext *ctx,
+			    IPCChannelMixConfig *config);
+
+/**
+ * 批量更新声道混合规则（kIPCCommandSetChannelMix），只发送 count 条规则
+ *
+ * @param ctx 客户端上下文指针
+ * @param update 批量更新（中性规则表示删除该应用的规则）
+ * @param config 输出合并后的规则表（可为 NULL）
+ * @return 成功返回 0；服务不可用、参数超出范围或规则表已满返回 -1
+ */
+int
+ipc_client_update_channel_mix (IPCClientContext *ctx,
+			       const IPCChannelMixConfig *update,
+			       IPCChannelMixConfig *config);
+
+/**
+ * 获取卷积器配置（kIPCCommandGetConvolver）
+ *
+ * @param ctx 客户端上下文指针
+ * @param config 输出配置
+ * @return 成功返回 0，失败返回 -1
+ */
+int
+ipc_client_get_convolver (IPCClientContext *ctx, IPCConvolverConfig *config);
+
+/**
+ * 设置卷积器配置（kIPCCommandSetConvolver）
+ *
+ * @param ctx 客户端上下文指针
+ * @param config 新配置
+ * @return 成功返回 0；服务不可用或参数无效返回 -1
+ */
+int
+ipc_client_set_convolver (IPCClientContext *ctx,
+			  const IPCConvolverConfig *config);
+
+/**
+ * 获取交叉馈送配置（kIPCCommandGetCrossfeed）
+ *
+ * @param ctx 客户端上下文指针
+ * @param config 输出配置
+ * @return 成功返回 0，失败返回 -1
+ */
+int
+ipc_client_get_crossfeed (IPCClientContext *ctx, IPCCrossfeedConfig *config);
+
+/**
+ * 设置交叉馈送配置（kIPCCommandSetCrossfeed）
+ *
+ * @param ctx 客户端上下文指针
+ * @param config 新配置
+ * @return 成功返回 0；服务不可用或参数无效返回 -1
+ */
+int
+ipc_client_set_crossfeed (IPCClientContext *ctx,
+			  const IPCCrossfeedConfig *config);
+
+/**
+ * 获取频谱分析配置（kIPCCommandGetSpectrum）
+ *
+ * @param ctx 客户端上下文指针
+ * @param config 输出配置
+ * @return 成功返回 0，失败返回 -1
+ */
+int
+ipc_client_get_spectrum (IPCClientContext *ctx, IPCSpectrumConfig *config);
+
+/**
+ * 设置频谱分析配置（kIPCCommandSetSpectrum）
+ *
+ * @param ctx 客户端上下文指针
+ * @param config 新配置
+ * @return 成功返回 0；服务不可用或参数无效返回 -1
+ */
+int
+ipc_client_set_spectrum (IPCClientContext *ctx,
+			 const IPCSpectrumConfig *config);
+
+/**
+ * 获取录音请求和 Router 最近上报的状态（kIPCCommandGetRecording）
+ *
+ * @param ctx 客户端上下文指针
+ * @param report 输出
+ * @return 成功返回 0，失败返回 -1
+ */
+int
+ipc_client_get_recording (IPCClientContext *ctx, IPCRecordReport *report);
+
+/**
+ * 发送录音请求（kIPCCommandSetRecording）
+ *
+ * @param ctx 客户端上下文指针
+ * @param config 请求（generation 由服务端分配）
+ * @param generation 输出服务端分配的请求序号，可为 NULL
+ * @return 成功返回 0；服务不可用或参数无效返回 -1
+ */
+int
+ipc_client_set_recording (IPCClientContext *ctx, const IPCRecordConfig *config,
+			  uint32_t *generation);
+
+/**
+ * 获取网络推流配置（kIPCCommandGetStream）
+ *
+ * @param ctx 客户端上下文指针
+ * @param config 输出配置
+ * @return 成功返回 0，失败返回 -1
+ */
+int
+ipc_client_get_stream (IPCClientContext *ctx, IPCStreamConfig *config);
+
+/**
+ * 设置网络推流配置（kIPCCommandSetStream）
+ *
+ * @param ctx 客户端上下文指针
+ * @param config 新配置
+ * @return 成功返回 0；服务不可用或参数无效返回 -1
+ */
+int
+ipc_client_set_stream (IPCClientContext *ctx, const IPCStreamConfig *config);
+
+/**
+ * 获取主输出和各应用的最新响度读数（kIPCCommandGetLoudness）
+ *
+ * @param ctx 客户端上下文指针
+ * @param entries 输出读数数组（主输出如有则在最前）
+ * @param max_entries 数组容量
+ * @param count 输出读数数量
+ * @return 成功返回 0，失败返回 -1
+ */
+int
+ipc_client_get_loudness (IPCClientContext *ctx, IPCLoudnessEntry *entries,
+			 uint32_t max_entries, uint32_t *count);
+
 // ============================================================================
 // 自动重连机制
 // ============================================================================
@@ -5,6 +5,7 @@
 #ifndef AUDIOCTL_IPC_PROTOCOL_H
 #define AUDIOCTL_IPC_PROTOCOL_H
 
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <sys/types.h>
@@ -19,6 +20,7 @@ extern "C" {
 // ============================================================================
 
 #define IPC_SOCKET_FILENAME "daemon.sock"
+#define IPC_SOCKET_PATH_ENV "AUDIOCTL_SOCKET_PATH" // 路径覆盖
 #define IPC_SOCKET_BACKLOG 16
 #define IPC_MAX_PAYLOAD_SIZE 4096
 #define IPC_PROTOCOL_VERSION 1
@@ -43,7 +45,9 @@ typedef struct __attribute__ ((packed))
 // 指令集 (Command Types)
 // ============================================================================
 
-typedef enum : uint16_t
+// 线路上以 uint16_t 传输（见 IPCMessageHeader.command），枚举本身不指定底层
+// 类型，以便在不支持 C23 枚举底层类型的编译器（如 Linux 上的 GCC）上构建
+typedef enum
 {
   // 客户端注册/注销
   kIPCCommandRegister = 0x0001,	  // 应用注册（驱动调用）
@@ -58,17 +62,86 @@ typedef enum : uint16_t
   // 状态查询
   kIPCCommandListClients = 0x0200, // 列出所有连接的客户端
   kIPCCommandPing = 0x0201,	   // 心跳检测
+  kIPCCommandGetStats = 0x0202,	   // 获取服务端统计 (IPCServerStats)
+
+  // Router 性能快照
+  kIPCCommandPublishRouterStats = 0x0300, // Router 上报快照（Router 调用）
+  kIPCCommandGetRouterStats = 0x0301,	  // 获取最近的 Router 快照
+
+  // 事件订阅
+  kIPCCommandSubscribe = 0x0400, // 订阅事件主题（掩码为 0 表示取消订阅）
+
+  // 均衡器
+  kIPCCommandGetEqualizer = 0x0500, // 获取均衡器配置 (IPCEqualizerConfig)
+  kIPCCommandSetEqualizer = 0x0501, // 设置均衡器配置并推送给订阅者
+
+  // 响度计量
+  kIPCCommandPublishLoudness = 0x0600, // 上报响度读数（驱动、Router 调用）
+  kIPCCommandGetLoudness = 0x0601,     // 获取主输出和各应用的最新读数
+  kIPCCommandGetNormalizer = 0x0602, // 获取响度均衡配置 (IPCNormalizerConfig)
+  kIPCCommandSetNormalizer = 0x0603, // 设置响度均衡配置并推送给订阅者
+  kIPCCommandGetDucking = 0x0604,    // 获取闪避规则 (IPCDuckingConfig)
+  kIPCCommandSetDucking = 0x0605,    // 设置闪避规则并推送给订阅者
+
+  // 声道矩阵
+  kIPCCommandGetChannelMix = 0x0700, // 获取各应用声道混合规则
+  kIPCCommandSetChannelMix = 0x0701, // 批量更新规则并推送给订阅者
+
+  // 卷积
+  kIPCCommandGetConvolver = 0x0800, // 获取卷积器配置 (IPCConvolverConfig)
+  kIPCCommandSetConvolver = 0x0801, // 设置卷积器配置并推送给订阅者
+
+  // 交叉馈送
+  kIPCCommandGetCrossfeed = 0x0900, // 获取交叉馈送配置 (IPCCrossfeedConfig)
+  kIPCCommandSetCrossfeed = 0x0901, // 设置交叉馈送配置并推送给订阅者
+
+  // 频谱分析
+  kIPCCommandGetSpectrum = 0x0A00, // 获取频谱分析配置 (IPCSpectrumConfig)
+  kIPCCommandSetSpectrum = 0x0A01, // 设置频谱分析配置并推送给订阅者
+  kIPCCommandPublishSpectrum = 0x0A02, // 上报一帧频谱（Router 调用）
+
+  // 录音
+  kIPCCommandGetRecording = 0x0B00, // 获取录音请求和状态 (IPCRecordReport)
+  kIPCCommandSetRecording = 0x0B01, // 开始/停止/换文件并推送给订阅者
+  kIPCCommandPublishRecording = 0x0B02, // 上报录音状态（Router 调用）
+
+  // 网络推流
+  kIPCCommandGetStream = 0x0C00, // 获取网络推流配置 (IPCStreamConfig)
+  kIPCCommandSetStream = 0x0C01, // 设置网络推流配置并推送给订阅者
 
   // 响应
   kIPCCommandResponse = 0x8000, // 通用响应
   kIPCCommandError = 0x8001,	// 错误响应
+  kIPCCommandEvent = 0x8002,	// 服务端主动推送的事件（request_id 为 0）
 } IPCCommand;
 
+// ============================================================================
+// 事件主题 (Event Topics)
+// ============================================================================
+
+// 位掩码，可组合订阅
+typedef enum
+{
+  kIPCEventTopicVolume = 1u << 0,    // 应用音量/静音变更
+  kIPCEventTopicEqualizer = 1u << 1, // 均衡器配置变更 (IPCEqualizerConfig)
+  kIPCEventTopicNormalizer = 1u << 2, // 响度均衡配置变更 (IPCNormalizerConfig)
+  kIPCEventTopicDucking = 1u << 3,    // 闪避规则变更 (IPCDuckingConfig)
+  kIPCEventTopicChannelMix = 1u << 4, // 声道混合规则变更 (IPCChannelMixConfig)
+  kIPCEventTopicConvolver = 1u << 5,  // 卷积器配置变更 (IPCConvolverConfig)
+  kIPCEventTopicCrossfeed = 1u << 6,  // 交叉馈送配置变更 (IPCCrossfeedConfig)
+  kIPCEventTopicSpectrum = 1u << 7,   // 频谱分析配置变更 (IPCSpectrumConfig)
+  kIPCEventTopicSpectrumFrame = 1u << 8, // 频谱帧 (IPCSpectrumFrame)
+  kIPCEventTopicRecording = 1u << 9,	 // 录音请求变更 (IPCRecordConfig)
+  kIPCEventTopicRecordingStatus = 1u << 10, // 录音状态 (IPCRecordStatus)
+  kIPCEventTopicStream = 1u << 11, // 网络推流配置变更 (IPCStreamConfig)
+} IPCEventTopic;
+
 // ============================================================================
 // 状态码
 // ============================================================================
 
-typedef enum : int32_t
+// 线路上以 int32_t 传输（见 IPCResponse.status）
+typedef enum
 {
   kIPCStatusOK = 0,		     // 成功
   kIPCStatusInvalidHeader = -1,	     // 无效的消息头
@@ -78,6 +151,7 @@ typedef enum : int32_t
   kIPCStatusInvalidVolume = -5,	     // 无效音量值
   kIPCStatusServiceUnavailable = -6, // 服务不可用
   kIPCStatusInternalError = -7,	     // 内部错误
+  kIPCStatusInvalidParameter = -8,   // 参数超出范围
 } IPCStatus;
 
 // ============================================================================
@@ -133,6 +207,458 @@ typedef struct __attribute__ ((packed))
   bool muted;	  // 静音状态
 } IPCVolumeResponse;
 
+// 事件订阅请求
+typedef struct __attribute__ ((packed))
+{
+  uint32_t topics; // IPCEventTopic 位掩码
+} IPCSubscribeRequest;
+
+// 事件消息头（kIPCCommandEvent 的负载前缀）
+typedef struct __attribute__ ((packed))
+{
+  uint32_t topic;    // IPCEventTopic（单个位）
+  uint32_t data_len; // 事件数据长度
+		     // 变长字段：事件数据
+} IPCEventHeader;
+
+// 音量变更事件（kIPCEventTopicVolume）
+typedef struct __attribute__ ((packed))
+{
+  pid_t pid;	// 应用进程ID
+  float volume; // 当前音量
+  bool muted;	// 当前静音状态
+} IPCVolumeEvent;
+
+// ============================================================================
+// 服务端统计 (kIPCCommandGetStats)
+// ============================================================================
+
+// 耗时直方图按 2 的幂分桶（单位微秒）：
+// 桶 0 为 < 1us，桶 i 为 [2^(i-1), 2^i) us，最后一个桶包含所有更大的值
+#define IPC_STATS_HISTOGRAM_BUCKETS 16
+// 按状态码统计的槽位数，下标为 -status
+// （kIPCStatusOK ... kIPCStatusInvalidParameter）
+#define IPC_STATS_STATUS_COUNT 9
+// 服务端统计槽位数上限（每个已知指令一个，另加一个未知指令槽位），
+// 客户端据此分配接收数组
+#define IPC_STATS_MAX_COMMANDS 64
+
+// 统计请求（可省略，等同于 first = 0）：条目较多时单帧放不下，按页读取
+typedef struct __attribute__ ((packed))
+{
+  uint32_t first; // 从第几个有请求的指令开始
+} IPCStatsRequest;
+
+// 单个指令的统计
+typedef struct __attribute__ ((packed))
+{
+  uint16_t command;   // IPCCommand（0 表示未知指令或无效消息头）
+  uint16_t reserved;  // 保留，填 0
+  uint64_t requests;  // 请求数
+  uint64_t bytes_in;  // 接收字节数（含消息头）
+  uint64_t bytes_out; // 响应字节数（含消息头）
+  uint64_t total_ns;  // 累计处理耗时
+  uint64_t max_ns;    // 最大处理耗时
+  uint32_t status_counts[IPC_STATS_STATUS_COUNT];  // 按响应状态码计数
+  uint32_t histogram[IPC_STATS_HISTOGRAM_BUCKETS]; // 处理耗时分布
+} IPCCommandStats;
+
+// 服务端整体统计（响应数据前缀，随后是 command_count 个 IPCCommandStats，
+// 只列出有请求的指令，从请求的 first 开始）
+typedef struct __attribute__ ((packed))
+{
+  uint64_t uptime_ms;	      // 服务端运行时间
+  uint32_t connections;	      // 当前连接数
+  uint32_t peak_connections;  // 峰值连接数
+  uint64_t total_connections; // 累计接受的连接数
+  uint64_t events_sent;	      // 推送的事件消息数
+  uint64_t event_bytes_out;   // 推送的事件字节数
+  uint64_t loop_iterations;   // 事件循环迭代次数（不含空转）
+  uint64_t loop_total_ns;     // 事件循环累计处理耗时（不含等待）
+  uint64_t loop_max_ns;	      // 单次迭代最大处理耗时
+  uint32_t loop_histogram[IPC_STATS_HISTOGRAM_BUCKETS]; // 迭代耗时分布
+  uint32_t total_commands;    // 有请求的指令总数（大于 first + command_count
+			      // 时还有后续页）
+  uint32_t command_count;     // 随后的 IPCCommandStats 数量
+} IPCServerStats;
+
+// 单帧统计响应能容纳的条目数
+#define IPC_STATS_PAGE_ENTRIES                                                 \
+  ((IPC_MAX_PAYLOAD_SIZE - sizeof (IPCResponse) - sizeof (IPCServerStats))     \
+   / sizeof (IPCCommandStats))
+
+// ============================================================================
+// Router 性能快照 (kIPCCommandPublishRouterStats / kIPCCommandGetRouterStats)
+// ============================================================================
+
+// 服务端保留的快照数量（受单帧负载上限约束）
+#define IPC_ROUTER_STATS_HISTORY 40
+
+// Router 监控线程每个周期生成一条快照
+typedef struct __attribute__ ((packed))
+{
+  uint64_t timestamp_ms;   // 生成时间（Unix 毫秒）
+  uint32_t uptime_sec;	   // Router 运行时间
+  uint32_t interval_ms;	   // 统计周期
+  uint32_t sample_rate;	   // 采样率
+  uint32_t latency_ms;	   // 缓冲延迟（缓存帧数 / 采样率）
+  uint32_t fill_percent;   // 周期结束时的缓冲区使用率
+  uint32_t peak_percent;   // 周期内的缓冲区峰值使用率
+  uint32_t underruns;	   // 周期内欠载次数
+  uint32_t overruns;	   // 周期内过载次数
+  uint64_t frames;	   // 周期内传输帧数
+  uint64_t frames_total;   // 累计传输帧数
+  // 端到端延迟：帧进入输入 IOProc 到在物理设备上播放
+  // （IOProc 时间戳之差 + 设备报告的延迟和安全偏移）
+  uint32_t e2e_samples;	      // 周期内测量次数（0 表示无有效测量）
+  uint32_t e2e_min_us;	      // 最小值
+  uint32_t e2e_avg_us;	      // 平均值
+  uint32_t e2e_p99_us;	      // p99（直方图桶上界）
+  uint32_t e2e_max_us;	      // 最大值
+  uint32_t device_latency_us; // 其中设备延迟 + 安全偏移部分
+  // IOProc 负载：回调耗时 / IO 周期长度，单位千分比
+  uint16_t input_load_avg;     // 输入回调周期平均负载
+  uint16_t input_load_peak;    // 输入回调周期峰值负载
+  uint16_t output_load_avg;    // 输出回调周期平均负载
+  uint16_t output_load_peak;   // 输出回调周期峰值负载
+  uint16_t load_threshold;     // 超时判定阈值
+  uint16_t silent_permille;    // 周期内整块静音的输入帧占比（千分比）
+  uint32_t load_overruns;      // 周期内负载超过阈值的回调次数
+  uint16_t flags;	       // IPC_ROUTER_FLAG_*
+  uint16_t limiter_gr_cdb;     // 周期内输出限制器的最大增益衰减（0.01 dB）
+} IPCRouterStatsSnapshot;
+
+// 快照标志
+#define IPC_ROUTER_FLAG_IDLE 0x0001 // 周期结束时处于空闲（低活动）模式
+
+// ============================================================================
+// 均衡器 (kIPCCommandGetEqualizer / kIPCCommandSetEqualizer)
+// ============================================================================
+
+#define IPC_EQ_MAX_BANDS 10	    // 最大段数
+#define IPC_EQ_MIN_FREQ 10.0f	    // 频率下限 (Hz)
+#define IPC_EQ_MAX_FREQ 40000.0f    // 频率上限 (Hz)
+#define IPC_EQ_MAX_GAIN_DB 24.0f    // 增益绝对值上限 (dB)
+#define IPC_EQ_MIN_Q 0.1f	    // Q 下限
+#define IPC_EQ_MAX_Q 24.0f	    // Q 上限
+
+// 滤波器类型
+typedef enum
+{
+  kIPCEqualizerPeaking = 0,   // 峰值
+  kIPCEqualizerLowShelf = 1,  // 低架
+  kIPCEqualizerHighShelf = 2, // 高架
+  kIPCEqualizerHighPass = 3,  // 高通
+  kIPCEqualizerLowPass = 4,   // 低通
+  kIPCEqualizerTypeCount
+} IPCEqualizerType;
+
+// 单段参数
+typedef struct __attribute__ ((packed))
+{
+  uint8_t type;	     // IPCEqualizerType
+  uint8_t enabled;   // 0 表示该段直通
+  uint16_t reserved; // 保留，填 0
+  float frequency;   // 中心/截止频率 (Hz)
+  float gain_db;     // 增益 (dB)，高通/低通忽略
+  float q;	     // 品质因数（架式滤波器为斜率）
+} IPCEqualizerBand;
+
+// 完整配置（服务端保存最近一次设置，Router 连接时获取并订阅变更）
+typedef struct __attribute__ ((packed))
+{
+  uint8_t enabled;    // 0 表示整体直通
+  uint8_t band_count; // 有效段数 (0 ~ IPC_EQ_MAX_BANDS)
+  uint16_t reserved;  // 保留，填 0
+  float preamp_db;    // 前级增益 (dB)
+  IPCEqualizerBand bands[IPC_EQ_MAX_BANDS];
+} IPCEqualizerConfig;
+
+// ============================================================================
+// 响度计量 (kIPCCommandPublishLoudness / kIPCCommandGetLoudness)
+// ============================================================================
+
+#define IPC_LOUDNESS_MAX_ENTRIES 65   // 主输出 + 驱动的最大客户端数
+#define IPC_LOUDNESS_NAME_MAX 32      // 应用名称长度上限（含结尾 0）
+#define IPC_LOUDNESS_STALE_MS 5000    // 应用读数超过该时长未更新即丢弃
+#define IPC_LOUDNESS_MIN_LUFS -120.0f // 读数下限：无信号或尚无门限块
+#define IPC_LOUDNESS_MASTER_PID 0     // 主输出（Router 混音）使用的 PID
+
+// 一路读数（EBU R128：K 加权响度，真峰值为 4 倍过采样估计）
+typedef struct __attribute__ ((packed))
+{
+  pid_t pid;		 // 应用进程ID，IPC_LOUDNESS_MASTER_PID 为主输出
+  float momentary_lufs;	 // 瞬时响度（最近 400ms）
+  float short_term_lufs; // 短期响度（最近 3s）
+  float integrated_lufs; // 积分响度（门限后，自开始测量）
+  float true_peak_dbtp;	 // 最大真峰值（自开始测量）
+  float agc_gain_db;	 // 自动增益：响度均衡与闪避之和（主输出为 0）
+  char name[IPC_LOUDNESS_NAME_MAX]; // 应用名称（查询响应中由服务端填写）
+} IPCLoudnessEntry;
+
+// 读数列表（负载前缀，随后是 count 个 IPCLoudnessEntry）
+// 上报：驱动每次上报全部应用（替换服务端保存的应用读数），Router 只上报
+// 主输出；查询：主输出（如有）在前，其后是各应用
+typedef struct __attribute__ ((packed))
+{
+  uint32_t count; // 条目数（不超过 IPC_LOUDNESS_MAX_ENTRIES）
+} IPCLoudnessReport;
+
+// ============================================================================
+// 响度均衡 (kIPCCommandGetNormalizer / kIPCCommandSetNormalizer)
+// ============================================================================
+
+#define IPC_NORMALIZER_MIN_TARGET_LUFS -40.0f // 目标响度下限
+#define IPC_NORMALIZER_MAX_TARGET_LUFS -5.0f  // 目标响度上限
+#define IPC_NORMALIZER_MAX_BOOST_DB 24.0f     // 最大提升量的上限
+#define IPC_NORMALIZER_MAX_CUT_DB 40.0f	      // 最大衰减量的上限
+#define IPC_NORMALIZER_MIN_RATE_DB 0.1f	      // 起音/释放速率下限 (dB/s)
+#define IPC_NORMALIZER_MAX_RATE_DB 60.0f      // 起音/释放速率上限 (dB/s)
+
+// 完整配置（服务端保存最近一次设置，驱动连接时获取并订阅变更）
+// 启用后驱动按各应用的短期响度把它们拉向同一目标，叠加在应用音量之上
+typedef struct __attribute__ ((packed))
+{
+  uint8_t enabled;	  // 0 表示关闭（增益平滑回到 0 dB）
+  uint8_t reserved[3];	  // 保留，填 0
+  float target_lufs;	  // 目标短期响度 (LUFS)
+  float max_boost_db;	  // 最大提升 (dB)
+  float max_cut_db;	  // 最大衰减 (dB)
+  float attack_db_per_s;  // 应用变响时增益下降的速率 (dB/s)
+  float release_db_per_s; // 应用变轻时增益上升的速率 (dB/s)
+} IPCNormalizerConfig;
+
+// ============================================================================
+// 闪避 (kIPCCommandGetDucking / kIPCCommandSetDucking)
+// ============================================================================
+
+#define IPC_DUCKING_MAX_APPS 8		     // 每个列表的应用数上限
+#define IPC_DUCKING_ID_MAX 64		     // Bundle ID 长度上限（含结尾 0）
+#define IPC_DUCKING_MAX_DEPTH_DB 40.0f	     // 衰减深度上限
+#define IPC_DUCKING_MIN_THRESHOLD_LUFS -70.0f // 人声活动门限下限
+#define IPC_DUCKING_MAX_THRESHOLD_LUFS -10.0f // 人声活动门限上限
+#define IPC_DUCKING_MIN_RAMP_MS 1.0f	     // 起音/释放时间下限
+#define IPC_DUCKING_MAX_TIME_MS 10000.0f     // 起音/保持/释放时间上限
+
+// 应用在闪避规则中的角色
+typedef enum
+{
+  kIPCDuckingRoleNone = 0,  // 不参与
+  kIPCDuckingRoleVoice = 1, // 人声应用：有声音时触发闪避
+  kIPCDuckingRoleMedia = 2, // 媒体应用：闪避时被衰减
+} IPCDuckingRole;
+
+// 完整规则（服务端保存最近一次设置，驱动连接时获取并订阅变更）
+// 应用按 Bundle ID 或应用名称匹配（不区分大小写），同时出现在两个列表中时
+// 视为人声应用
+typedef struct __attribute__ ((packed))
+{
+  uint8_t enabled;	// 0 表示关闭（被衰减的应用按释放时间恢复）
+  uint8_t voice_count;	// 人声应用数 (0 ~ IPC_DUCKING_MAX_APPS)
+  uint8_t media_count;	// 媒体应用数 (0 ~ IPC_DUCKING_MAX_APPS)
+  uint8_t reserved;	// 保留，填 0
+  float depth_db;	// 衰减深度 (dB)
+  float threshold_lufs; // 人声应用瞬时响度达到该值视为正在说话
+  float attack_ms;	// 衰减到深度所需时间
+  float hold_ms;	// 人声停止后保持衰减的时间
+  float release_ms;	// 恢复到原音量所需时间
+  char voice[IPC_DUCKING_MAX_APPS][IPC_DUCKING_ID_MAX]; // 人声应用
+  char media[IPC_DUCKING_MAX_APPS][IPC_DUCKING_ID_MAX]; // 媒体应用
+} IPCDuckingConfig;
+
+// ============================================================================
+// 声道矩阵 (kIPCCommandGetChannelMix / kIPCCommandSetChannelMix)
+// ============================================================================
+
+#define IPC_CHANNEL_MIX_MAX_APPS 16 // 规则数上限
+#define IPC_CHANNEL_MIX_ID_MAX 64   // Bundle ID 长度上限（含结尾 0）
+
+// 规则标志
+enum
+{
+  kIPCChannelMixMono = 1u << 0, // 左右混合为单声道
+  kIPCChannelMixSwap = 1u << 1, // 左右互换
+};
+
+// 单个应用的立体声混合规则（平衡、声像均为 0 且无标志时等同于无规则）
+typedef struct __attribute__ ((packed))
+{
+  char app[IPC_CHANNEL_MIX_ID_MAX]; // Bundle ID 或应用名称（不区分大小写）
+  float balance;		    // 平衡 (-1 左 ~ 1 右)
+  float pan;			    // 声像 (-1 左 ~ 1 右)
+  uint8_t flags;		    // kIPCChannelMixMono | kIPCChannelMixSwap
+  uint8_t reserved[3];		    // 保留，填 0
+} IPCChannelMixRule;
+
+// 规则表（服务端保存，驱动连接时获取并订阅变更）
+// 也用作批量更新的请求：逐条按应用合并，中性规则表示删除该应用的规则，
+// 整批全部有效才生效；响应为合并后的规则表
+typedef struct __attribute__ ((packed))
+{
+  uint8_t count;       // 规则数 (0 ~ IPC_CHANNEL_MIX_MAX_APPS)
+  uint8_t reserved[3]; // 保留，填 0
+  IPCChannelMixRule rules[IPC_CHANNEL_MIX_MAX_APPS];
+} IPCChannelMixConfig;
+
+// ============================================================================
+// 卷积 (kIPCCommandGetConvolver / kIPCCommandSetConvolver)
+// ============================================================================
+
+#define IPC_CONVOLVER_PATH_MAX 1024	 // IR 文件路径长度上限（含结尾 0）
+#define IPC_CONVOLVER_MIN_GAIN_DB -24.0f // 输出增益下限
+#define IPC_CONVOLVER_MAX_GAIN_DB 12.0f	 // 输出增益上限
+
+// 完整配置（服务端保存最近一次设置，Router 连接时获取并订阅变更）
+// Router 收到后在非实时线程读取 IR 文件并预先变换，再替换到卷积器
+typedef struct __attribute__ ((packed))
+{
+  uint8_t enabled;		     // 0 表示直通
+  uint8_t reserved[3];		     // 保留，填 0
+  float gain_db;		     // 输出增益 (dB)，补偿 IR 的整体电平
+  char path[IPC_CONVOLVER_PATH_MAX]; // IR 文件（WAV）绝对路径，可为空
+} IPCConvolverConfig;
+
+// ============================================================================
+// 交叉馈送 (kIPCCommandGetCrossfeed / kIPCCommandSetCrossfeed)
+// ============================================================================
+
+// 开关模式
+typedef enum
+{
+  kIPCCrossfeedOff = 0,	 // 关闭
+  kIPCCrossfeedOn = 1,	 // 始终开启
+  kIPCCrossfeedAuto = 2, // 输出数据源报告为耳机时开启（见 isHeadphoneDevice）
+  kIPCCrossfeedModeCount
+} IPCCrossfeedMode;
+
+// 强度预设（取值与 RouterCrossfeedPreset 一致）
+typedef enum
+{
+  kIPCCrossfeedLight = 0,  // 轻
+  kIPCCrossfeedMedium = 1, // 中
+  kIPCCrossfeedStrong = 2, // 强
+  kIPCCrossfeedPresetCount
+} IPCCrossfeedPreset;
+
+// 完整配置（服务端保存最近一次设置，Router 连接时获取并订阅变更）
+typedef struct __attribute__ ((packed))
+{
+  uint8_t mode;	       // IPCCrossfeedMode
+  uint8_t preset;      // IPCCrossfeedPreset
+  uint8_t reserved[2]; // 保留，填 0
+} IPCCrossfeedConfig;
+
+// ============================================================================
+// 频谱分析 (kIPCCommandGetSpectrum / kIPCCommandSetSpectrum /
+//           kIPCCommandPublishSpectrum)
+// ============================================================================
+
+#define IPC_SPECTRUM_MIN_SIZE 256	 // 变换长度下限
+#define IPC_SPECTRUM_MAX_SIZE 8192	 // 变换长度上限
+#define IPC_SPECTRUM_MAX_BANDS 128	 // 频带数上限
+#define IPC_SPECTRUM_MAX_FPS 60		 // 帧率上限
+#define IPC_SPECTRUM_MAX_DECIMATION 8 // 抽取倍数上限（1、2、4、8）
+
+// 完整配置（服务端保存最近一次设置，Router 连接时获取并订阅变更）
+// Router 只在有频谱帧订阅者时才分析，其余时间抽头关闭
+typedef struct __attribute__ ((packed))
+{
+  uint16_t fft_size;   // 变换长度（2 的幂）
+  uint8_t band_count;  // 对数频带数 (1 ~ IPC_SPECTRUM_MAX_BANDS)
+  uint8_t fps;	       // 帧率上限 (1 ~ IPC_SPECTRUM_MAX_FPS)
+  uint8_t decimation;  // 分析前的抽取倍数，降低采样率以提高低频分辨率
+  uint8_t reserved[3]; // 保留，填 0
+} IPCSpectrumConfig;
+
+// 一帧频谱（Router 上报，服务端原样推送给 kIPCEventTopicSpectrumFrame
+// 的订阅者）。只传 band_count 个频带，负载长度随之变化；band_count 为 0
+// 的帧不推送，响应中的订阅者数用于判断是否需要继续分析
+typedef struct __attribute__ ((packed))
+{
+  uint32_t sequence;	// 帧序号
+  uint32_t sample_rate; // 分析采样率（抽取后）
+  uint16_t fft_size;	// 变换长度
+  uint8_t band_count;	// 频带数 (0 ~ IPC_SPECTRUM_MAX_BANDS)
+  uint8_t reserved;	// 保留，填 0
+  float min_freq;	// 最低频带下沿 (Hz)
+  float max_freq;	// 最高频带上沿 (Hz)
+  float bands[IPC_SPECTRUM_MAX_BANDS]; // 各频带电平 (dBFS)，按频率升序
+} IPCSpectrumFrame;
+
+// 不含频带的帧头长度
+#define IPC_SPECTRUM_FRAME_HEADER_SIZE (offsetof (IPCSpectrumFrame, bands))
+
+// ============================================================================
+// 录音 (kIPCCommandGetRecording / kIPCCommandSetRecording /
+//       kIPCCommandPublishRecording)
+// ============================================================================
+
+#define IPC_RECORD_PATH_MAX 1024 // 目录和文件路径的最大长度（含结尾 NUL）
+
+// 文件格式（取值与 RouterRecordFormat 一致）
+typedef enum
+{
+  kIPCRecordWav = 0, // 32 位 float WAV（单个文件不超过 4 GB）
+  kIPCRecordCaf = 1, // 32 位 float CAF
+  kIPCRecordFormatCount
+} IPCRecordFormat;
+
+// 录音请求（服务端保存最近一次设置，Router 连接时获取并订阅变更）
+// 每次有效的设置都得到新的 generation，录音中再次开始即换新文件
+typedef struct __attribute__ ((packed))
+{
+  uint8_t recording;			  // 1 开始（或换文件），0 停止
+  uint8_t format;			  // IPCRecordFormat
+  uint8_t reserved[2];			  // 保留，填 0
+  uint32_t generation;			  // 请求序号（服务端分配，设置时忽略）
+  char directory[IPC_RECORD_PATH_MAX]; // 录音目录（绝对路径，开始时不能为空）
+} IPCRecordConfig;
+
+// 录音状态（Router 每个监控周期和处理完请求后上报）
+typedef struct __attribute__ ((packed))
+{
+  uint8_t recording;	     // 是否正在录音
+  uint8_t format;	     // 当前（或最近一个）文件的格式
+  uint8_t reserved[2];	     // 保留，填 0
+  int32_t error;	     // 最近一次失败的 errno（0 表示没有）
+  uint32_t generation;	     // 已处理的请求序号
+  uint32_t files;	     // Router 启动以来打开的文件数
+  uint32_t sample_rate;	     // 采样率
+  uint32_t channels;	     // 声道数
+  uint32_t dropped_blocks;   // 写盘跟不上时丢弃的块数
+  uint64_t frames;	     // 当前文件已写入的帧数
+  uint64_t dropped_frames;   // 丢弃的总帧数
+  char path[IPC_RECORD_PATH_MAX]; // 当前（或最近一个）文件
+} IPCRecordStatus;
+
+// kIPCCommandGetRecording 的响应
+typedef struct __attribute__ ((packed))
+{
+  IPCRecordConfig config; // 当前请求
+  uint8_t status_valid;	  // Router 是否上报过状态
+  uint8_t reserved[3];	  // 保留，填 0
+  IPCRecordStatus status; // 最近一次上报的状态
+} IPCRecordReport;
+
+// ============================================================================
+// 网络推流 (kIPCCommandGetStream / kIPCCommandSetStream)
+// ============================================================================
+
+#define IPC_STREAM_HOST_MAX 256	   // 目标主机的最大长度（含结尾 NUL）
+#define IPC_STREAM_DEFAULT_PORT 5004 // 默认 UDP 端口
+#define IPC_STREAM_MIN_PTIME_MS 1    // 包时长下限
+#define IPC_STREAM_MAX_PTIME_MS 10   // 包时长上限
+
+// 完整配置（服务端保存最近一次设置，Router 连接时获取并订阅变更）
+// 开启时 Router 把输出以 RTP（L24）发往 host:port，由 audioctl receive 播放
+typedef struct __attribute__ ((packed))
+{
+  uint8_t enabled;		  // 是否推流
+  uint8_t ptime_ms;		  // 包时长 (IPC_STREAM_MIN_PTIME_MS ~ MAX)
+  uint16_t port;		  // 目标 UDP 端口
+  char host[IPC_STREAM_HOST_MAX]; // 目标 IPv4 地址或主机名，开启时不能为空
+} IPCStreamConfig;
+
 // ============================================================================
 // 工具函数
 // ============================================================================
@@ -140,6 +666,7 @@ typedef struct __attribute__ ((packed))
 /**
  * 获取 IPC Socket 文件完整路径
  * 路径: ~/Library/Application Support/audioctl/daemon.sock
+ * 设置了 AUDIOCTL_SOCKET_PATH 环境变量时使用该路径
  *
  * @param path 输出缓冲区
  * @param path_size 缓冲区大小
@@ -154,7 +681,7 @@ get_ipc_socket_path (char *path, size_t path_size);
  * @param header 消息头指针
  * @param command 指令类型
  * @param payload_len 负载长度
- * @param request_id 请求ID（0表示自动分配）
+ * @param request_id 请求ID（0 保留给服务端推送的事件）
  */
 void
 ipc_init_header (IPCMessageHeader *header, uint16_t command,
@@ -178,6 +705,233 @@ ipc_validate_header (const IPCMessageHeader *header);
 const char *
 ipc_status_to_string (int32_t status);
 
+/**
+ * 将指令类型转换为可读字符串
+ *
+ * @param command 指令类型
+ * @return 指令名称字符串
+ */
+const char *
+ipc_command_to_string (uint16_t command);
+
+/**
+ * 检查均衡器配置是否有效（段数、类型和各参数范围）
+ *
+ * @param config 配置指针
+ * @return 有效返回 true
+ */
+bool
+ipc_equalizer_config_is_valid (const IPCEqualizerConfig *config);
+
+/**
+ * 填入响度均衡的默认配置（关闭，目标 -18 LUFS）
+ *
+ * @param config 配置指针
+ */
+void
+ipc_normalizer_config_init (IPCNormalizerConfig *config);
+
+/**
+ * 检查响度均衡配置是否有效（各参数范围）
+ *
+ * @param config 配置指针
+ * @return 有效返回 true
+ */
+bool
+ipc_normalizer_config_is_valid (const IPCNormalizerConfig *config);
+
+/**
+ * 填入默认闪避规则（关闭；常见会议应用为人声，常见播放器和浏览器为媒体）
+ *
+ * @param config 配置指针
+ */
+void
+ipc_ducking_config_init (IPCDuckingConfig *config);
+
+/**
+ * 检查闪避规则是否有效（列表长度、各 ID 以 0 结尾且非空、参数范围）
+ *
+ * @param config 配置指针
+ * @return 有效返回 true
+ */
+bool
+ipc_ducking_config_is_valid (const IPCDuckingConfig *config);
+
+/**
+ * 按规则确定应用的角色
+ *
+ * @param config 配置指针
+ * @param bundle_id 应用 Bundle ID（可为 NULL）
+ * @param name 应用名称（可为 NULL）
+ * @return IPCDuckingRole
+ */
+IPCDuckingRole
+ipc_ducking_config_role (const IPCDuckingConfig *config, const char *bundle_id,
+			 const char *name);
+
+/**
+ * 清空声道混合规则表
+ *
+ * @param config 规则表指针
+ */
+void
+ipc_channel_mix_config_init (IPCChannelMixConfig *config);
+
+/**
+ * 规则是否为中性（不改变声道）
+ *
+ * @param rule 规则指针
+ * @return 中性返回 true
+ */
+bool
+ipc_channel_mix_rule_is_neutral (const IPCChannelMixRule *rule);
+
+/**
+ * 检查规则表是否有效（规则数、ID 以 0 结尾且非空、应用不重复、参数范围、
+ * 标志位）
+ *
+ * @param config 规则表指针
+ * @return 有效返回 true
+ */
+bool
+ipc_channel_mix_config_is_valid (const IPCChannelMixConfig *config);
+
+/**
+ * 把一批规则合并进规则表：已有应用的规则被替换，中性规则删除该应用
+ *
+ * @param config 规则表指针
+ * @param update 批量更新
+ * @return 成功返回 0；更新无效或合并后超出规则数上限返回 -1（规则表不变）
+ */
+int
+ipc_channel_mix_config_merge (IPCChannelMixConfig *config,
+			      const IPCChannelMixConfig *update);
+
+/**
+ * 查找应用的规则
+ *
+ * @param config 规则表指针
+ * @param bundle_id 应用 Bundle ID（可为 NULL）
+ * @param name 应用名称（可为 NULL）
+ * @return 匹配的规则，没有时返回 NULL
+ */
+const IPCChannelMixRule *
+ipc_channel_mix_config_find (const IPCChannelMixConfig *config,
+			     const char *bundle_id, const char *name);
+
+/**
+ * 检查卷积器配置是否有效：增益在范围内，路径以 0 结尾且为空或绝对路径，
+ * 启用时路径不能为空
+ *
+ * @param config 配置指针
+ * @return 有效返回 true
+ */
+bool
+ipc_convolver_config_is_valid (const IPCConvolverConfig *config);
+
+/**
+ * 交叉馈送默认配置（自动、中等强度）
+ *
+ * @param config 配置指针
+ */
+void
+ipc_crossfeed_config_init (IPCCrossfeedConfig *config);
+
+/**
+ * 检查交叉馈送配置是否有效（模式和预设在范围内）
+ *
+ * @param config 配置指针
+ * @return 有效返回 true
+ */
+bool
+ipc_crossfeed_config_is_valid (const IPCCrossfeedConfig *config);
+
+/**
+ * 频谱分析默认配置（2048 点、64 个频带、30 帧/秒、不抽取）
+ *
+ * @param config 配置指针
+ */
+void
+ipc_spectrum_config_init (IPCSpectrumConfig *config);
+
+/**
+ * 检查频谱分析配置是否有效（变换长度为范围内的 2 的幂，频带数、帧率在
+ * 范围内，抽取倍数为 1、2、4 或 8）
+ *
+ * @param config 配置指针
+ * @return 有效返回 true
+ */
+bool
+ipc_spectrum_config_is_valid (const IPCSpectrumConfig *config);
+
+/**
+ * 检查上报的频谱帧是否有效：负载长度与频带数一致，频带数和变换长度
+ * 在范围内
+ *
+ * @param frame 帧指针
+ * @param length 负载长度
+ * @return 有效返回 true
+ */
+bool
+ipc_spectrum_frame_is_valid (const IPCSpectrumFrame *frame, uint32_t length);
+
+/**
+ * 检查录音请求是否有效：格式在范围内，目录以 NUL 结尾，非空时为绝对
+ * 路径，开始录音时不能为空
+ *
+ * @param config 请求指针
+ * @return 有效返回 true
+ */
+bool
+ipc_record_config_is_valid (const IPCRecordConfig *config);
+
+/**
+ * 检查上报的录音状态是否有效（格式在范围内，路径以 NUL 结尾）
+ *
+ * @param status 状态指针
+ * @return 有效返回 true
+ */
+bool
+ipc_record_status_is_valid (const IPCRecordStatus *status);
+
+/**
+ * 网络推流默认配置（关闭、2 ms、端口 5004）
+ *
+ * @param config 配置指针
+ */
+void
+ipc_stream_config_init (IPCStreamConfig *config);
+
+/**
+ * 检查网络推流配置是否有效：包时长在范围内，端口非 0，主机以 NUL
+ * 结尾，开启时不能为空
+ *
+ * @param config 配置指针
+ * @return 有效返回 true
+ */
+bool
+ipc_stream_config_is_valid (const IPCStreamConfig *config);
+
+/**
+ * 计算耗时所在的直方图桶
+ *
+ * @param ns 耗时（纳秒）
+ * @return 桶下标 (0 ~ IPC_STATS_HISTOGRAM_BUCKETS - 1)
+ */
+uint32_t
+ipc_stats_bucket_for_ns (uint64_t ns);
+
+/**
+ * 由直方图估算分位数
+ * 返回分位数所在桶的上界，落在最后一个桶时返回该桶的下界
+ *
+ * @param histogram 直方图 (IPC_STATS_HISTOGRAM_BUCKETS 个桶)
+ * @param quantile 分位数 (0.0 - 1.0)
+ * @return 估算值（微秒），直方图为空返回 0
+ */
+uint64_t
+ipc_stats_histogram_quantile_us (const uint32_t *histogram, double quantile);
+
 #ifdef __cplusplus
 }
 #endif
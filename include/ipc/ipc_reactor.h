@@ -0,0 +1,168 @@
+//
+// IPC 事件循环抽象 (Reactor)
+// macOS 使用 kqueue，Linux 使用边沿触发 epoll；两种后端都是边沿触发语义，
+// 调用者必须在收到可读/可写事件后一直读写到 EAGAIN
+//
+
+#ifndef AUDIOCTL_IPC_REACTOR_H
+#define AUDIOCTL_IPC_REACTOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// 配置
+// ============================================================================
+
+#define IPC_REACTOR_MAX_TIMERS 8 // 最大定时器数量
+
+// ============================================================================
+// 事件类型
+// ============================================================================
+
+// 位掩码：注册兴趣时使用 Read/Write，返回事件时可能附带其余标志
+typedef enum
+{
+  kIPCReactorRead = 1u << 0,	// 可读
+  kIPCReactorWrite = 1u << 1,	// 可写
+  kIPCReactorHangup = 1u << 2,	// 对端关闭或出错
+  kIPCReactorTimer = 1u << 3,	// 定时器到期
+  kIPCReactorWakeup = 1u << 4, // 被 ipc_reactor_wakeup 唤醒
+} IPCReactorEventType;
+
+// 就绪事件
+typedef struct IPCReactorEvent
+{
+  int fd;	     // 就绪的文件描述符（定时器和唤醒事件为 -1）
+  uint32_t timer_id; // 到期的定时器ID（仅 kIPCReactorTimer）
+  uint32_t events;   // IPCReactorEventType 位掩码
+} IPCReactorEvent;
+
+// 定时器表项
+typedef struct IPCReactorTimerEntry
+{
+  bool in_use;
+  uint32_t id; // 调用者指定的定时器ID
+  int fd;      // timerfd（仅 epoll 后端）
+} IPCReactorTimerEntry;
+
+// Reactor 上下文
+typedef struct IPCReactor
+{
+  int backend_fd;  // kqueue 或 epoll 实例
+  int wake_fds[2]; // 唤醒管道（读端注册到后端）
+  IPCReactorTimerEntry timers[IPC_REACTOR_MAX_TIMERS];
+} IPCReactor;
+
+// ============================================================================
+// Reactor API
+// ============================================================================
+
+/**
+ * 初始化 Reactor
+ *
+ * @param reactor Reactor 指针
+ * @return 成功返回 0，失败返回 -1
+ */
+int
+ipc_reactor_init (IPCReactor *reactor);
+
+/**
+ * 释放 Reactor 资源（不关闭已注册的文件描述符）
+ *
+ * @param reactor Reactor 指针
+ */
+void
+ipc_reactor_cleanup (IPCReactor *reactor);
+
+/**
+ * 注册文件描述符（边沿触发）
+ *
+ * @param reactor Reactor 指针
+ * @param fd 非阻塞文件描述符
+ * @param interest kIPCReactorRead / kIPCReactorWrite 组合
+ * @return 成功返回 0，失败返回 -1
+ */
+int
+ipc_reactor_add (IPCReactor *reactor, int fd, uint32_t interest);
+
+/**
+ * 修改已注册文件描述符的兴趣集合
+ *
+ * @param reactor Reactor 指针
+ * @param fd 文件描述符
+ * @param interest kIPCReactorRead / kIPCReactorWrite 组合
+ * @return 成功返回 0，失败返回 -1
+ */
+int
+ipc_reactor_modify (IPCReactor *reactor, int fd, uint32_t interest);
+
+/**
+ * 注销文件描述符（必须在 close 之前调用）
+ *
+ * @param reactor Reactor 指针
+ * @param fd 文件描述符
+ */
+void
+ipc_reactor_remove (IPCReactor *reactor, int fd);
+
+/**
+ * 添加周期定时器
+ *
+ * @param reactor Reactor 指针
+ * @param timer_id 定时器ID（到期事件中原样返回）
+ * @param interval_ms 周期毫秒数（必须大于 0）
+ * @return 成功返回 0，ID 重复或定时器表满返回 -1
+ */
+int
+ipc_reactor_add_timer (IPCReactor *reactor, uint32_t timer_id,
+		       uint32_t interval_ms);
+
+/**
+ * 删除定时器
+ *
+ * @param reactor Reactor 指针
+ * @param timer_id 定时器ID
+ */
+void
+ipc_reactor_remove_timer (IPCReactor *reactor, uint32_t timer_id);
+
+/**
+ * 唤醒正在等待的 ipc_reactor_wait
+ * 只使用 write()，可在信号处理函数和其他线程中调用
+ *
+ * @param reactor Reactor 指针
+ */
+void
+ipc_reactor_wakeup (IPCReactor *reactor);
+
+/**
+ * 等待就绪事件
+ *
+ * @param reactor Reactor 指针
+ * @param events 输出事件数组
+ * @param max_events 数组容量
+ * @param timeout_ms 超时毫秒数，-1 表示无限等待
+ * @return 就绪事件数（被信号中断返回 0），失败返回 -1
+ */
+int
+ipc_reactor_wait (IPCReactor *reactor, IPCReactorEvent *events,
+		  int max_events, int timeout_ms);
+
+/**
+ * 获取当前后端名称
+ *
+ * @return "kqueue" 或 "epoll"
+ */
+const char *
+ipc_reactor_backend_name (void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIOCTL_IPC_REACTOR_H
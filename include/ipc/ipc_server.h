@@ -5,9 +5,12 @@
 #ifndef AUDIOCTL_IPC_SERVER_H
 #define AUDIOCTL_IPC_SERVER_H
 
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <sys/types.h>
+#include "ipc/ipc_protocol.h"
+#include "ipc/ipc_reactor.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -35,10 +38,10 @@ typedef struct IPCClientEntry
 typedef struct IPCServerContext
 {
   int listen_fd;	    // 监听 socket
-  int epoll_fd;		    // epoll 文件描述符（macOS 使用 kqueue）
+  IPCReactor reactor;	    // 事件循环（macOS: kqueue，Linux: epoll）
   IPCClientEntry *clients;  // 客户端链表头
   uint32_t client_count;    // 客户端数量
-  bool running;		    // 运行状态
+  atomic_bool running;	    // 运行状态
   uint32_t next_request_id; // 下一个请求ID
 } IPCServerContext;
 
@@ -57,7 +60,7 @@ ipc_server_init (IPCServerContext *ctx);
 
 /**
  * 运行 IPC 服务端主循环
- * 阻塞直到接收到停止信号
+ * 阻塞直到接收到停止信号或 ipc_server_stop 被调用
  *
  * @param ctx 服务端上下文指针
  */
@@ -66,6 +69,7 @@ ipc_server_run (IPCServerContext *ctx);
 
 /**
  * 停止 IPC 服务端
+ * 可在其他线程中调用，正在等待的事件循环会被立即唤醒
  *
  * @param ctx 服务端上下文指针
  */
@@ -160,6 +164,38 @@ ipc_server_set_mute (IPCServerContext *ctx, pid_t pid, bool muted);
 IPCClientEntry *
 ipc_server_list_clients (IPCServerContext *ctx, uint32_t *count);
 
+/**
+ * 向订阅了指定主题的连接广播事件
+ * 事件写入连接的发送缓冲区后立即尝试发送；对端长期不读取导致缓冲区
+ * 超过上限时该连接会被断开
+ *
+ * @param ctx 服务端上下文指针
+ * @param topic 事件主题 (IPCEventTopic)
+ * @param data 事件数据（可为 NULL）
+ * @param data_len 事件数据长度
+ * @return 成功投递的连接数，失败返回 -1
+ */
+int
+ipc_server_broadcast_event (IPCServerContext *ctx, uint32_t topic,
+			    const void *data, uint32_t data_len);
+
+/**
+ * 获取服务端统计快照
+ * 计数器使用无锁原子操作维护，可在任意线程调用；各字段分别读取，
+ * 彼此之间不保证严格一致
+ *
+ * @param ctx 服务端上下文指针
+ * @param stats 输出整体统计（total_commands 为有请求的指令总数）
+ * @param first 跳过前 first 个有请求的指令（分页）
+ * @param commands 输出各指令统计（可为 NULL，只包含有请求的指令）
+ * @param max_commands commands 数组容量
+ * @return 写入 commands 的条目数
+ */
+uint32_t
+ipc_server_get_stats (IPCServerContext *ctx, IPCServerStats *stats,
+		      uint32_t first, IPCCommandStats *commands,
+		      uint32_t max_commands);
+
 /**
  * 获取客户端数量
  *
@@ -0,0 +1,183 @@
+//
+// 跨应用响度均衡（自动增益）
+// 以每个应用自己的短期响度为依据，把它缓慢拉向共同的目标响度：
+// 增益每个 IO 块更新一次（降低按起音速率、提升按释放速率限速），
+// 块内逐采样线性插值，叠加在用户设置的应用音量之上。
+// 响度读数来自音量调节之前的测量，属于前馈控制，不会形成反馈环路
+//
+
+#ifndef AUDIOCTL_ROUTER_AGC_H
+#define AUDIOCTL_ROUTER_AGC_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// 配置
+// ============================================================================
+
+#define ROUTER_AGC_MIN_TARGET_LUFS -40.0f // 目标响度下限
+#define ROUTER_AGC_MAX_TARGET_LUFS -5.0f  // 目标响度上限
+#define ROUTER_AGC_MAX_BOOST_DB 24.0f	  // 最大提升量的上限
+#define ROUTER_AGC_MAX_CUT_DB 40.0f	  // 最大衰减量的上限
+#define ROUTER_AGC_MIN_RATE_DB 0.1f	  // 起音/释放速率下限 (dB/s)
+#define ROUTER_AGC_MAX_RATE_DB 60.0f	  // 起音/释放速率上限 (dB/s)
+#define ROUTER_AGC_GATE_LUFS -50.0f // 短期响度低于该值（停顿、静音）时保持增益
+
+#define ROUTER_AGC_DEFAULT_TARGET_LUFS -18.0f
+#define ROUTER_AGC_DEFAULT_MAX_BOOST_DB 12.0f
+#define ROUTER_AGC_DEFAULT_MAX_CUT_DB 24.0f
+#define ROUTER_AGC_DEFAULT_ATTACK_DB 6.0f  // 变响时的衰减速率 (dB/s)
+#define ROUTER_AGC_DEFAULT_RELEASE_DB 1.5f // 变轻时的提升速率 (dB/s)
+
+// 均衡参数（所有应用共用）
+typedef struct
+{
+  bool enabled;		  // 关闭时增益按速率限制回到 0 dB
+  float target_lufs;	  // 目标短期响度 (LUFS)
+  float max_boost_db;	  // 最大提升 (dB)
+  float max_cut_db;	  // 最大衰减 (dB)
+  float attack_db_per_s;  // 增益下降速率 (dB/s)
+  float release_db_per_s; // 增益上升速率 (dB/s)
+} RouterAgcParams;
+
+// 共享参数（控制线程写、各实时通道每块读取；各字段独立生效）
+typedef struct
+{
+  atomic_bool enabled;
+  _Atomic float target_lufs;
+  _Atomic float max_boost_db;
+  _Atomic float max_cut_db;
+  _Atomic float attack_db_per_s;
+  _Atomic float release_db_per_s;
+} RouterAgcControl;
+
+// 单个通道的增益状态（由调用者分配）
+typedef struct
+{
+  _Atomic float published_db; // 当前总增益 (dB，含叠加增益)，供任意线程读取
+  atomic_bool reset_pending;  // 由实时线程在下一块开始时复位
+
+  // 实时线程
+  float gain_db; // 当前增益 (dB)
+  float from;	 // 本块起点的线性增益
+  float to;	 // 本块终点的线性增益
+} RouterAgc;
+
+// ============================================================================
+// API
+// ============================================================================
+
+/**
+ * 初始化共享参数（默认值，未启用）
+ *
+ * @param control 共享参数指针
+ */
+void
+router_agc_control_init (RouterAgcControl *control);
+
+/**
+ * 检查参数是否在有效范围内
+ *
+ * @param params 参数
+ * @return 有效返回 true
+ */
+bool
+router_agc_params_are_valid (const RouterAgcParams *params);
+
+/**
+ * 设置参数（控制线程，可在实时线程处理期间调用）
+ *
+ * @param control 共享参数指针
+ * @param params 参数
+ * @return 成功返回 0；参数超出范围返回 -1（原参数保持不变）
+ */
+int
+router_agc_set_params (RouterAgcControl *control,
+		       const RouterAgcParams *params);
+
+/**
+ * 读取当前参数（任意线程）
+ *
+ * @param control 共享参数指针
+ * @param params 输出参数
+ */
+void
+router_agc_get_params (RouterAgcControl *control, RouterAgcParams *params);
+
+/**
+ * 初始化通道增益状态（0 dB）
+ *
+ * @param agc 增益状态指针
+ */
+void
+router_agc_init (RouterAgc *agc);
+
+/**
+ * 请求把通道增益复位到 0 dB（任意线程，通道分配给新应用时调用）
+ * 实时线程在下一次 update 开始时执行
+ *
+ * @param agc 增益状态指针
+ */
+void
+router_agc_reset (RouterAgc *agc);
+
+/**
+ * 按本块开始时的响度读数更新增益（实时线程，每块一次）
+ * 本块终点的增益向 目标响度 - 当前响度 靠拢，单块变化量不超过
+ * 速率 × 块时长；读数低于 ROUTER_AGC_GATE_LUFS 时保持不变
+ *
+ * @param agc 增益状态指针
+ * @param params 参数
+ * @param loudness_lufs 通道当前的短期响度
+ * @param offset_db 叠加的其他自动增益（如闪避，调用方已做平滑），
+ *                  与均衡增益一起在块内插值
+ * @param frames 本块帧数
+ * @param sample_rate 采样率
+ */
+void
+router_agc_update (RouterAgc *agc, const RouterAgcParams *params,
+		   float loudness_lufs, float offset_db, uint32_t frames,
+		   uint32_t sample_rate);
+
+/**
+ * 本块是否需要施加增益（起点和终点都为 0 dB 时返回 false）
+ *
+ * @param agc 增益状态指针
+ * @return 需要施加返回 true
+ */
+bool
+router_agc_is_active (const RouterAgc *agc);
+
+/**
+ * 对交错采样施加 音量 × 增益，增益在块内从起点线性过渡到终点（实时线程）
+ *
+ * @param agc 增益状态指针
+ * @param buffer 交错采样，frames × channels 个
+ * @param frames 帧数
+ * @param channels 声道数
+ * @param volume 用户设置的音量
+ */
+void
+router_agc_apply (const RouterAgc *agc, float *buffer, uint32_t frames,
+		  uint32_t channels, float volume);
+
+/**
+ * 读取最近发布的总增益（任意线程）
+ *
+ * @param agc 增益状态指针
+ * @return 当前增益 (dB)，含叠加增益
+ */
+float
+router_agc_read_gain_db (RouterAgc *agc);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIOCTL_ROUTER_AGC_H
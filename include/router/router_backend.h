@@ -0,0 +1,218 @@
+//
+// Router 源/汇后端与离线管线
+// 把 Router 的信号通路从 CoreAudio 设备中解耦：源产生交错 float 采样，
+// 汇消费处理后的采样。离线管线按块驱动 源 -> 环形缓冲区 -> 输出处理 -> 汇，
+// 不受实时时钟约束，可在 Linux 上做吞吐基准和逐位一致的回归测试
+//
+
+#ifndef AUDIOCTL_ROUTER_BACKEND_H
+#define AUDIOCTL_ROUTER_BACKEND_H
+
+#include "router/router_dsp.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// 配置
+// ============================================================================
+
+#define ROUTER_OFFLINE_DEFAULT_BLOCK_FRAMES 512 // 默认块大小
+#define ROUTER_OFFLINE_MAX_BLOCK_FRAMES 1024	// 块大小上限（环形缓冲区一半）
+
+// 32 位 float WAV 文件头长度：RIFF(12) + fmt(8+18) + fact(8+4) + data(8)
+#define ROUTER_WAV_FLOAT_HEADER_SIZE 58
+
+// ============================================================================
+// 后端接口
+// ============================================================================
+
+typedef struct RouterSource RouterSource;
+typedef struct RouterSink RouterSink;
+
+// 音频源
+struct RouterSource
+{
+  uint32_t sample_rate; // 采样率
+  uint32_t channels;	// 声道数
+  /**
+   * 读取交错 float 采样
+   * @return 读取的帧数，0 表示结束
+   */
+  uint32_t (*read) (RouterSource *source, float *dst, uint32_t frames);
+  void (*close) (RouterSource *source);
+  void *state; // 后端私有状态
+};
+
+// 音频汇
+struct RouterSink
+{
+  uint32_t sample_rate; // 采样率
+  uint32_t channels;	// 声道数
+  /**
+   * 写入交错 float 采样
+   * @return 成功返回 0，失败返回 -1
+   */
+  int (*write) (RouterSink *sink, const float *src, uint32_t frames);
+  int (*close) (RouterSink *sink);
+  void *state; // 后端私有状态
+};
+
+// 离线管线配置
+typedef struct
+{
+  uint32_t block_frames; // 每块帧数（模拟 IOProc 缓冲区大小）
+  float gain;		 // 增益补偿，语义同 router_render_output
+  RouterDspHost *dsp;	 // DSP 链（可为 NULL），运行前按源格式和块大小配置
+} RouterOfflineConfig;
+
+// 离线管线统计
+typedef struct
+{
+  uint64_t frames_in;	  // 从源读取的帧数
+  uint64_t frames_out;	  // 写入汇的帧数
+  uint64_t silent_frames; // 输入中整块静音的帧数（不拷贝，只推进写指针）
+  uint32_t overruns;	  // 环形缓冲区过载次数
+  uint32_t underruns;	  // 环形缓冲区欠载次数
+  uint64_t elapsed_ns;	  // 处理耗时（单调时钟）
+} RouterOfflineStats;
+
+// ============================================================================
+// 源
+// ============================================================================
+
+/**
+ * 打开 WAV 文件作为源
+ * 支持 16/24/32 位整数 PCM 和 32 位 float（含 WAVE_FORMAT_EXTENSIBLE）
+ *
+ * @param source 源指针
+ * @param path 文件路径
+ * @return 成功返回 0，文件无法打开、格式不支持或声道数超过
+ *         ROUTER_MAX_CHANNELS 返回 -1
+ */
+int
+router_source_open_wav (RouterSource *source, const char *path);
+
+/**
+ * 打开合成源：确定性的正弦测试信号（第 n 个声道为 440×(n+1) Hz，幅度 0.5）
+ *
+ * @param source 源指针
+ * @param sample_rate 采样率
+ * @param channels 声道数（1 至 ROUTER_MAX_CHANNELS）
+ * @param frames 总帧数
+ * @return 成功返回 0，参数无效返回 -1
+ */
+int
+router_source_open_synthetic (RouterSource *source, uint32_t sample_rate,
+			      uint32_t channels, uint64_t frames);
+
+/**
+ * 关闭源并释放资源
+ *
+ * @param source 源指针
+ */
+void
+router_source_close (RouterSource *source);
+
+// ============================================================================
+// 汇
+// ============================================================================
+
+/**
+ * 打开 WAV 文件作为汇（32 位 float，关闭时回填长度）
+ *
+ * @param sink 汇指针
+ * @param path 文件路径
+ * @param sample_rate 采样率
+ * @param channels 声道数
+ * @return 成功返回 0，失败返回 -1
+ */
+int
+router_sink_open_wav (RouterSink *sink, const char *path, uint32_t sample_rate,
+		      uint32_t channels);
+
+/**
+ * 生成 32 位 float WAV 文件头（ROUTER_WAV_FLOAT_HEADER_SIZE 字节，小端）
+ * 数据长度超过 32 位时按 32 位截断，调用者负责在此之前换文件
+ *
+ * @param header 输出缓冲区
+ * @param sample_rate 采样率
+ * @param channels 声道数
+ * @param frames 数据帧数
+ */
+void
+router_wav_build_float_header (uint8_t *header, uint32_t sample_rate,
+			       uint32_t channels, uint64_t frames);
+
+/**
+ * 打开空汇：丢弃采样，只累计帧数和校验和（用于基准和回归比对）
+ *
+ * @param sink 汇指针
+ * @param sample_rate 采样率
+ * @param channels 声道数
+ * @return 成功返回 0，失败返回 -1
+ */
+int
+router_sink_open_null (RouterSink *sink, uint32_t sample_rate,
+		       uint32_t channels);
+
+/**
+ * 获取空汇的校验和（采样位模式的 FNV-1a 64）
+ *
+ * @param sink 由 router_sink_open_null 打开的汇
+ * @return 校验和；不是空汇返回 0
+ */
+uint64_t
+router_sink_null_checksum (const RouterSink *sink);
+
+// FNV-1a 64 初始值
+#define ROUTER_CHECKSUM_INIT 0xcbf29ce484222325ULL
+
+/**
+ * 计算采样位模式的 FNV-1a 64 校验和（可分段累计）
+ *
+ * @param hash 上一段的结果，首段传 ROUTER_CHECKSUM_INIT
+ * @param samples 采样
+ * @param count 采样数
+ * @return 累计后的校验和
+ */
+uint64_t
+router_checksum_update (uint64_t hash, const float *samples, uint32_t count);
+
+/**
+ * 关闭汇并释放资源
+ *
+ * @param sink 汇指针
+ * @return 成功返回 0，写盘失败返回 -1
+ */
+int
+router_sink_close (RouterSink *sink);
+
+// ============================================================================
+// 离线管线
+// ============================================================================
+
+/**
+ * 以最快速度运行离线管线，直到源结束且环形缓冲区排空
+ * 每块依次执行 源读取 -> router_ring_write -> router_render_output -> 汇写入，
+ * 与实时 IOProc 使用同一套处理代码（整块静音时改用 router_ring_write_silence）
+ *
+ * @param source 已打开的源
+ * @param sink 已打开的汇（采样率和声道数须与源一致）
+ * @param config 配置（NULL 使用默认块大小和单位增益）
+ * @param stats 输出统计（可为 NULL）
+ * @return 成功返回 0；参数无效、分配失败、DSP 链准备失败或汇写入失败返回 -1
+ */
+int
+router_offline_run (RouterSource *source, RouterSink *sink,
+		    const RouterOfflineConfig *config,
+		    RouterOfflineStats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIOCTL_ROUTER_BACKEND_H
@@ -0,0 +1,132 @@
+//
+// Router 输出格式转换（float -> 整数 PCM）
+// 物理格式为 16/24/32 位整数的设备可以直接接收整数采样，省去 HAL 转换器的
+// 一次拷贝。转换先把一段采样量化成 int32（加抖动、削波），再按目标格式
+// 写出；不整形时量化循环没有跨采样的依赖，编译器可以向量化。
+// TPDF 抖动由计数器哈希生成（不依赖上一个随机数），噪声整形使用二阶误差
+// 反馈，把量化噪声从中低频推向高频，只能逐采样计算
+//
+
+#ifndef AUDIOCTL_ROUTER_CONVERT_H
+#define AUDIOCTL_ROUTER_CONVERT_H
+
+#include "router/router_pipeline.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// 格式
+// ============================================================================
+
+// 输出采样格式（均为本机字节序、有符号、交错）
+typedef enum
+{
+  kRouterSampleFloat32 = 0,	 // 32 位 float（不转换）
+  kRouterSampleInt16 = 1,	 // 16 位
+  kRouterSampleInt24 = 2,	 // 24 位紧凑（每个采样 3 字节）
+  kRouterSampleInt24High = 3, // 24 位放在 32 位容器的高位（低字节为 0）
+  kRouterSampleInt24Low = 4,	 // 24 位放在 32 位容器的低位（符号扩展）
+  kRouterSampleInt32 = 5,	 // 32 位
+  kRouterSampleFormatCount
+} RouterSampleFormat;
+
+// 抖动模式
+typedef enum
+{
+  kRouterDitherOff = 0,	   // 直接舍入
+  kRouterDitherTpdf = 1,   // 三角分布抖动（±1 LSB）
+  kRouterDitherShaped = 2, // 三角分布抖动 + 二阶噪声整形
+  kRouterDitherModeCount
+} RouterDitherMode;
+
+// 抖动状态（每个输出流一份，只由实时线程访问）
+typedef struct
+{
+  RouterDitherMode mode;
+  uint32_t counter;				 // 抖动序列的位置
+  float error[ROUTER_MAX_CHANNELS][2];	 // 噪声整形：各声道最近两个误差 (LSB)
+} RouterDither;
+
+/**
+ * 由 PCM 格式描述得到输出采样格式（只接受本机字节序、交错的有符号整数
+ * 或 32 位 float）
+ *
+ * @param is_float 是否为浮点
+ * @param is_signed_integer 是否为有符号整数
+ * @param is_aligned_high 采样不占满容器时是否靠高位
+ * @param bits 有效位数
+ * @param bytes 每个采样占用的字节数
+ * @param format 输出格式
+ * @return 成功返回 0；不支持的格式返回 -1
+ */
+int
+router_sample_format_from_pcm (bool is_float, bool is_signed_integer,
+			       bool is_aligned_high, uint32_t bits,
+			       uint32_t bytes, RouterSampleFormat *format);
+
+/**
+ * 每个采样占用的字节数
+ *
+ * @param format 采样格式
+ * @return 字节数
+ */
+uint32_t
+router_sample_format_bytes (RouterSampleFormat format);
+
+/**
+ * 采样格式的有效位数
+ *
+ * @param format 采样格式
+ * @return 位数
+ */
+uint32_t
+router_sample_format_bits (RouterSampleFormat format);
+
+/**
+ * 采样格式的名称（用于日志）
+ *
+ * @param format 采样格式
+ * @return 名称字符串
+ */
+const char *
+router_sample_format_name (RouterSampleFormat format);
+
+// ============================================================================
+// 转换
+// ============================================================================
+
+/**
+ * 初始化抖动状态（非实时线程）
+ *
+ * @param dither 抖动状态指针
+ * @param mode 抖动模式
+ */
+void
+router_dither_init (RouterDither *dither, RouterDitherMode mode);
+
+/**
+ * 把交错 float 采样（满刻度 ±1.0）转换为目标格式（实时线程，不分配内存）
+ * 超出满刻度的值削波，NaN 输出 0。32 位整数不加抖动：float 的 24 位尾数
+ * 本身就比 32 位的量化步长粗
+ *
+ * @param dither 抖动状态指针
+ * @param format 目标格式（kRouterSampleFloat32 时原样拷贝）
+ * @param src 输入采样
+ * @param dst 输出缓冲区（frames * channels 个目标格式的采样）
+ * @param frames 帧数
+ * @param channels 声道数（超过 ROUTER_MAX_CHANNELS 时不做噪声整形）
+ */
+void
+router_convert_from_float (RouterDither *dither, RouterSampleFormat format,
+			   const float *src, void *dst, uint32_t frames,
+			   uint32_t channels);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIOCTL_ROUTER_CONVERT_H
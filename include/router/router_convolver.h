@@ -0,0 +1,157 @@
+//
+// Router 分块卷积器
+// 用于房间校正、耳机 IR 等长冲激响应：IR 按 ROUTER_CONVOLVER_BLOCK 帧均匀
+// 分块，每块预先变换到频域；处理时每凑满一块输入做一次 2 倍块长的 FFT，
+// 与各分块的频谱在频域乘加后逆变换，按重叠保留法取后半段输出。
+// 延迟固定为一个分块，计算量与 IR 长度成正比。
+// IR 的读取和变换都在控制线程完成，实时线程只做输入变换、乘加和逆变换
+//
+
+#ifndef AUDIOCTL_ROUTER_CONVOLVER_H
+#define AUDIOCTL_ROUTER_CONVOLVER_H
+
+#include "router/router_dsp.h"
+#include "router/router_fft.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// 配置
+// ============================================================================
+
+#define ROUTER_CONVOLVER_BLOCK 256	   // 分块帧数（即引入的延迟）
+#define ROUTER_CONVOLVER_MAX_CHANNELS 8	   // 支持的最大声道数
+#define ROUTER_CONVOLVER_MAX_IR_FRAMES 192000 // IR 长度上限（48 kHz 下 4 秒）
+#define ROUTER_CONVOLVER_MAX_PARTITIONS                                        \
+  (ROUTER_CONVOLVER_MAX_IR_FRAMES / ROUTER_CONVOLVER_BLOCK)
+#define ROUTER_CONVOLVER_MIN_GAIN_DB -24.0f // 输出增益下限
+#define ROUTER_CONVOLVER_MAX_GAIN_DB 12.0f  // 输出增益上限
+
+// 每个分块频谱的存放长度：BLOCK + 1 个频点补齐到 8 的倍数，
+// 乘加循环可以整段按向量处理（补齐部分为 0）
+#define ROUTER_CONVOLVER_BIN_STRIDE ((ROUTER_CONVOLVER_BLOCK + 8) & ~7u)
+
+// 预先变换好的冲激响应（控制线程创建，交给卷积器后只读）
+// 频谱按 [声道][分块][频点] 排列，实部和虚部分开存放
+typedef struct
+{
+  uint32_t sample_rate; // IR 的采样率，与处理格式不一致时直通
+  uint32_t channels;	// 1：所有声道共用；否则须等于处理声道数，逐声道对应
+  uint32_t frames;	// IR 长度（帧）
+  uint32_t partitions;	// 分块数
+  float *re;
+  float *im;
+} RouterConvolverIr;
+
+// 卷积器（由调用者分配；历史缓冲在 prepare 时按声道数分配）
+typedef struct
+{
+  RouterDspProcessor processor; // 加入 DSP 链的处理器
+
+  // 控制线程发布 IR，实时线程每次处理前登记（风险指针，同 RouterDspHost）
+  _Atomic (RouterConvolverIr *) active;
+  _Atomic (RouterConvolverIr *) in_use;
+
+  // 实时线程
+  uint32_t channels;	  // 声道数
+  uint32_t sample_rate;	  // 采样率
+  uint32_t fill;	  // 当前块已收集的帧数
+  uint32_t head;	  // 频域延迟线中最新一块的位置
+  uint32_t history;	  // 延迟线中有效的块数（复位后从 0 开始）
+  bool running;		  // 上一次处理是否在卷积（从直通切换过来时复位历史）
+  RouterFft fft;	  // 2 × BLOCK 点变换
+  float *input;		  // 每声道 [上一块 | 当前块]，2 × BLOCK 帧
+  float *output;	  // 每声道已算好的一块输出，BLOCK 帧
+  float *fdl_re;	  // 频域延迟线 [声道][块][频点]
+  float *fdl_im;
+  float *acc_re;	  // 乘加累加器，BIN_STRIDE 个
+  float *acc_im;
+  float *time;		  // 逆变换输出，2 × BLOCK 个
+} RouterConvolver;
+
+// ============================================================================
+// 冲激响应
+// ============================================================================
+
+/**
+ * 由交错采样创建 IR：按块补零做 FFT（控制线程，内部分配内存）
+ *
+ * @param samples 交错采样，frames × channels 个
+ * @param frames 帧数 (1 ~ ROUTER_CONVOLVER_MAX_IR_FRAMES)
+ * @param channels 声道数 (1 ~ ROUTER_CONVOLVER_MAX_CHANNELS)
+ * @param sample_rate 采样率
+ * @param gain 线性增益（并入频谱，处理时不再单独相乘）
+ * @return 成功返回新建的 IR；参数无效或内存不足返回 NULL
+ */
+RouterConvolverIr *
+router_convolver_ir_create (const float *samples, uint32_t frames,
+			    uint32_t channels, uint32_t sample_rate, float gain);
+
+/**
+ * 从 WAV 文件读取 IR（16/24/32 位整数或 32 位浮点，单声道或立体声）
+ *
+ * @param path 文件路径
+ * @param gain 线性增益
+ * @return 成功返回新建的 IR；文件无法读取、格式不支持或过长返回 NULL
+ */
+RouterConvolverIr *
+router_convolver_ir_load_wav (const char *path, float gain);
+
+/**
+ * 释放 IR（不能释放已交给卷积器的 IR）
+ *
+ * @param ir IR 指针，可为 NULL
+ */
+void
+router_convolver_ir_destroy (RouterConvolverIr *ir);
+
+// ============================================================================
+// 卷积器
+// ============================================================================
+
+/**
+ * 初始化卷积器（无 IR，直通）并填好 processor，可直接加入 DSP 链
+ *
+ * @param convolver 卷积器指针
+ */
+void
+router_convolver_init (RouterConvolver *convolver);
+
+/**
+ * 释放卷积器持有的缓冲区和 IR（调用时不得有实时线程在处理）
+ *
+ * @param convolver 卷积器指针
+ */
+void
+router_convolver_destroy (RouterConvolver *convolver);
+
+/**
+ * 替换 IR（控制线程，可在实时线程处理期间调用）
+ * 接管 ir 的所有权；等待实时线程离开旧 IR 后释放旧 IR。
+ * 输入历史在频域延迟线中保留，新 IR 从下一块起生效
+ *
+ * @param convolver 卷积器指针
+ * @param ir 新 IR，NULL 表示直通
+ */
+void
+router_convolver_set_ir (RouterConvolver *convolver, RouterConvolverIr *ir);
+
+/**
+ * 当前 IR 是否与处理格式匹配（即是否在做卷积）
+ *
+ * @param convolver 卷积器指针
+ * @return 正在卷积返回 true
+ */
+bool
+router_convolver_is_active (RouterConvolver *convolver);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIOCTL_ROUTER_CONVOLVER_H
@@ -0,0 +1,124 @@
+//
+// Router 耳机交叉馈送
+// 参考 Bauer / Linkwitz 的做法：每个声道经一阶低通、再延迟约 0.1 ms 后
+// 混入另一侧，本侧经一阶高架补偿被分走的低频，模拟扬声器听音时双耳都能
+// 听到两只音箱的效果，减轻硬声像内容在耳机上的疲劳感。
+// 只处理立体声；关闭且淡出完成后直接返回，不做任何运算
+//
+
+#ifndef AUDIOCTL_ROUTER_CROSSFEED_H
+#define AUDIOCTL_ROUTER_CROSSFEED_H
+
+#include "router/router_dsp.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// 配置
+// ============================================================================
+
+#define ROUTER_CROSSFEED_DELAY_US 100 // 交叉通路在低通之外的额外延迟
+#define ROUTER_CROSSFEED_RAMP_MS 10  // 开关和切换强度时的淡入淡出时长
+#define ROUTER_CROSSFEED_TAIL_MS 20  // 静音输入后的尾音时长
+#define ROUTER_CROSSFEED_DELAY_CAP 32 // 延迟线容量（2 的幂，192 kHz 下仍够用）
+
+// 强度预设（取值与 IPC 协议的 IPCCrossfeedConfig.preset 一致）
+// 交叉量为低频处对侧相对本侧的电平差，越小越强
+typedef enum
+{
+  kRouterCrossfeedLight = 0,  // 650 Hz，9.5 dB
+  kRouterCrossfeedMedium = 1, // 700 Hz，6.0 dB
+  kRouterCrossfeedStrong = 2, // 700 Hz，4.5 dB
+  kRouterCrossfeedPresetCount
+} RouterCrossfeedPreset;
+
+// 一组滤波器系数
+typedef struct
+{
+  float lo_a0, lo_b1;	      // 交叉通路一阶低通
+  float hi_a0, hi_a1, hi_b1;  // 直达通路一阶高架
+  float gain;		      // 整体增益，使单声道内容低频保持 0 dB
+} RouterCrossfeedCoeffs;
+
+// 交叉馈送（由调用者分配，不在内部分配内存）
+// 控制线程写入目标，实时线程每块读取；目标变化时先淡出到直通，
+// 在直通状态换系数并清零历史，再淡入，整个过程不产生爆音
+typedef struct
+{
+  RouterDspProcessor processor; // 加入 DSP 链的处理器
+
+  // 控制线程写、实时线程每块读取：0 表示关闭，否则为预设 + 1
+  _Atomic uint32_t target;
+
+  // 实时线程
+  uint32_t channels;		  // 声道数（不是 2 时始终直通）
+  uint32_t sample_rate;		  // 采样率
+  uint32_t current;		  // 系数对应的目标（同 target 编码）
+  uint32_t delay;		  // 交叉通路延迟帧数
+  uint32_t delay_pos;		  // 延迟线写位置
+  float wet;			  // 处理结果所占比例 (0 ~ 1)
+  float wet_step;		  // 淡入淡出时每帧的变化量
+  RouterCrossfeedCoeffs coeffs;	  // 当前系数
+  float lo[2];			  // 低通状态
+  float hi[2];			  // 高架输出状态
+  float x1[2];			  // 高架上一帧输入
+  float delay_line[2][ROUTER_CROSSFEED_DELAY_CAP]; // 低通输出的延迟线
+} RouterCrossfeed;
+
+// ============================================================================
+// API
+// ============================================================================
+
+/**
+ * 初始化交叉馈送（关闭）并填好 processor，可直接加入 DSP 链
+ *
+ * @param crossfeed 交叉馈送指针
+ */
+void
+router_crossfeed_init (RouterCrossfeed *crossfeed);
+
+/**
+ * 按预设计算系数（任意线程，不分配内存）
+ *
+ * @param preset 预设
+ * @param sample_rate 采样率
+ * @param coeffs 输出系数
+ * @return 成功返回 0；预设无效或采样率为 0 返回 -1
+ */
+int
+router_crossfeed_design (RouterCrossfeedPreset preset, uint32_t sample_rate,
+			 RouterCrossfeedCoeffs *coeffs);
+
+/**
+ * 设置开关和强度（控制线程，可在实时线程处理期间调用）
+ *
+ * @param crossfeed 交叉馈送指针
+ * @param enabled 是否启用
+ * @param preset 强度预设（关闭时忽略）
+ * @return 成功返回 0；预设无效返回 -1（原设置保持不变）
+ */
+int
+router_crossfeed_set (RouterCrossfeed *crossfeed, bool enabled,
+		      RouterCrossfeedPreset preset);
+
+/**
+ * 读取当前设置
+ *
+ * @param crossfeed 交叉馈送指针
+ * @param preset 输出强度预设（可为 NULL，关闭时不写入）
+ * @return 启用返回 true
+ */
+bool
+router_crossfeed_get (RouterCrossfeed *crossfeed,
+		      RouterCrossfeedPreset *preset);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIOCTL_ROUTER_CROSSFEED_H
@@ -0,0 +1,210 @@
+//
+// Router DSP 链
+// 输出通路上的有序处理器列表：每个处理器在非实时线程 prepare，在输出
+// IOProc 中对交错采样原地 process。控制线程可无锁替换整条链、单独旁路
+// 某一级，每一级的耗时按周期统计
+//
+
+#ifndef AUDIOCTL_ROUTER_DSP_H
+#define AUDIOCTL_ROUTER_DSP_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// 配置
+// ============================================================================
+
+#define ROUTER_DSP_MAX_STAGES 8 // 链的最大级数
+#define ROUTER_DSP_NAME_MAX 32	// 处理器名称长度上限（含结尾 0）
+
+// ============================================================================
+// 处理器接口
+// ============================================================================
+
+// 处理格式（prepare 时传入，process 时不再变化）
+typedef struct
+{
+  uint32_t sample_rate; // 采样率
+  uint32_t max_frames;	// 单次 process 的最大帧数（更大的块由链拆分）
+  uint32_t channels;	// 声道数（交错）
+  // 链内共享的暂存区：max_frames × channels 个 float，由宿主预分配；
+  // 只在一次 process 调用内有效，各级之间不保留内容
+  float *scratch;
+} RouterDspFormat;
+
+typedef struct RouterDspProcessor RouterDspProcessor;
+
+// 处理器（由调用者创建和销毁，链只引用不拥有）
+struct RouterDspProcessor
+{
+  const char *name; // 用于统计和日志
+  /**
+   * 准备处理（非实时线程）：按格式分配状态、计算系数并清零历史
+   * 处理器正在某条运行中的链里时不会被再次 prepare
+   *
+   * @return 成功返回 0，失败返回 -1
+   */
+  int (*prepare) (RouterDspProcessor *processor,
+		  const RouterDspFormat *format);
+  /**
+   * 原地处理交错采样（实时线程）：不得加锁、分配内存或做系统调用
+   *
+   * @param buffer 交错采样，frames × channels 个
+   * @param frames 帧数（不超过 max_frames）
+   */
+  void (*process) (RouterDspProcessor *processor, float *buffer,
+		   uint32_t frames);
+  // 输入变为静音后仍可能输出非零的帧数（混响、限制器预读等），
+  // 超过后链对静音块跳过处理；在 prepare 中设置
+  uint32_t tail_frames;
+  void *state; // 处理器私有状态
+};
+
+// ============================================================================
+// 链与宿主
+// ============================================================================
+
+// 链中的一级（旁路和统计由实时线程与控制线程共享）
+typedef struct
+{
+  RouterDspProcessor *processor;
+  _Atomic bool bypass;
+  _Atomic uint64_t busy_ns;	  // 周期内处理耗时之和
+  _Atomic uint64_t frames;	  // 周期内处理的帧数
+  _Atomic uint32_t calls;	  // 周期内调用次数
+  _Atomic uint32_t peak_permille; // 周期内单次调用的峰值负载
+} RouterDspStage;
+
+// 一条链（控制线程构建，发布后只读，替换后由控制线程释放）
+typedef struct
+{
+  uint32_t count;
+  uint32_t tail_frames; // 各级 tail_frames 的最大值
+  RouterDspStage stages[ROUTER_DSP_MAX_STAGES];
+} RouterDspChain;
+
+// DSP 宿主：持有当前链并负责安全替换
+// 实时线程处理前把当前链登记到 in_use（风险指针），控制线程替换后等待
+// 旧链不再被登记才释放，实时线程一侧无锁、无等待
+typedef struct
+{
+  _Atomic (RouterDspChain *) active; // 当前发布的链（NULL 表示空链）
+  _Atomic (RouterDspChain *) in_use; // 实时线程正在使用的链
+  pthread_mutex_t control_mutex;     // 串行化控制线程操作
+  RouterDspFormat format;	     // 当前格式
+  bool configured;		     // 是否已设置格式
+  uint32_t silent_frames; // 连续静音帧数（仅实时线程）
+} RouterDspHost;
+
+// 每一级的周期统计
+typedef struct
+{
+  char name[ROUTER_DSP_NAME_MAX];
+  bool bypass;
+  uint32_t calls;	  // 调用次数
+  uint64_t frames;	  // 处理帧数
+  uint16_t avg_permille;  // 平均负载：耗时 / 对应音频时长，千分比
+  uint16_t peak_permille; // 单次调用峰值负载
+} RouterDspStageStats;
+
+// ============================================================================
+// 控制线程 API
+// ============================================================================
+
+/**
+ * 初始化宿主（空链、未设置格式）
+ *
+ * @param host 宿主指针
+ */
+void
+router_dsp_host_init (RouterDspHost *host);
+
+/**
+ * 释放宿主持有的链（处理器由调用者销毁）
+ * 调用时不得有实时线程在处理
+ *
+ * @param host 宿主指针
+ */
+void
+router_dsp_host_destroy (RouterDspHost *host);
+
+/**
+ * 设置处理格式并重新 prepare 当前链的所有处理器
+ * 只能在没有实时线程处理时调用（Router 启动 IOProc 之前）
+ *
+ * @param host 宿主指针
+ * @param format 处理格式（scratch 须至少 max_frames × channels 个 float）
+ * @return 成功返回 0；有处理器 prepare 失败时清空链并返回 -1
+ */
+int
+router_dsp_host_configure (RouterDspHost *host, const RouterDspFormat *format);
+
+/**
+ * 替换整条链（可在实时线程处理期间调用）
+ * 已设置格式时先 prepare 新加入的处理器（已在旧链中的处理器保留状态、
+ * 旁路标志和统计），再原子发布新链，等待实时线程离开旧链后释放旧链。
+ * 返回后不在新链中的处理器可以安全销毁
+ *
+ * @param host 宿主指针
+ * @param processors 处理器数组（按处理顺序），count 为 0 时可为 NULL
+ * @param count 级数（不超过 ROUTER_DSP_MAX_STAGES）
+ * @return 成功返回 0；级数过多或 prepare 失败返回 -1（旧链保持不变）
+ */
+int
+router_dsp_host_set_chain (RouterDspHost *host,
+			   RouterDspProcessor *const *processors,
+			   uint32_t count);
+
+/**
+ * 设置某一级的旁路（立即生效）
+ *
+ * @param host 宿主指针
+ * @param index 级序号
+ * @param bypass true 跳过该级
+ * @return 成功返回 0，序号无效返回 -1
+ */
+int
+router_dsp_host_set_bypass (RouterDspHost *host, uint32_t index, bool bypass);
+
+/**
+ * 取出每一级的周期统计并清零
+ *
+ * @param host 宿主指针
+ * @param stats 输出数组
+ * @param max_stats 数组容量
+ * @return 写入的级数
+ */
+uint32_t
+router_dsp_host_collect_stats (RouterDspHost *host, RouterDspStageStats *stats,
+			       uint32_t max_stats);
+
+// ============================================================================
+// 实时线程 API
+// ============================================================================
+
+/**
+ * 依次执行链中未旁路的各级（输出 IOProc / 离线管线）
+ * 块大小超过 max_frames 时拆分处理；静音块在链的尾音结束后整块跳过
+ *
+ * @param host 宿主指针
+ * @param buffer 交错采样，原地处理
+ * @param frames 帧数
+ * @param silent 输入块是否为静音
+ * @return 实际执行了处理返回 true（静音块因此可能不再是静音）
+ */
+bool
+router_dsp_host_process (RouterDspHost *host, float *buffer, uint32_t frames,
+			 bool silent);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIOCTL_ROUTER_DSP_H
@@ -0,0 +1,158 @@
+//
+// 自动闪避（ducking）
+// “人声”应用（会议、通话）有声音时，平滑衰减“媒体”应用：
+// 人声通道每块上报自己的瞬时响度，超过门限即记为活动；媒体通道每块
+// 检查最近一次活动是否在保持时间内，按起音时间衰减到设定深度，活动
+// 结束并经过保持时间后按释放时间恢复。增益以 dB 线性变化，每块更新一次，
+// 由调用方交给逐采样插值的增益斜坡施加
+//
+
+#ifndef AUDIOCTL_ROUTER_DUCK_H
+#define AUDIOCTL_ROUTER_DUCK_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// 配置
+// ============================================================================
+
+#define ROUTER_DUCK_MAX_DEPTH_DB 40.0f	    // 衰减深度上限
+#define ROUTER_DUCK_MIN_THRESHOLD_LUFS -70.0f // 人声活动门限下限
+#define ROUTER_DUCK_MAX_THRESHOLD_LUFS -10.0f // 人声活动门限上限
+#define ROUTER_DUCK_MIN_RAMP_MS 1.0f	    // 起音/释放时间下限
+#define ROUTER_DUCK_MAX_TIME_MS 10000.0f    // 起音/保持/释放时间上限
+
+#define ROUTER_DUCK_DEFAULT_DEPTH_DB 12.0f
+#define ROUTER_DUCK_DEFAULT_THRESHOLD_LUFS -45.0f
+#define ROUTER_DUCK_DEFAULT_ATTACK_MS 150.0f
+#define ROUTER_DUCK_DEFAULT_HOLD_MS 1000.0f
+#define ROUTER_DUCK_DEFAULT_RELEASE_MS 1500.0f
+
+// 闪避参数
+typedef struct
+{
+  bool enabled;		// 关闭时媒体通道按释放时间恢复
+  float depth_db;	// 衰减深度 (dB，正数)
+  float threshold_lufs; // 人声瞬时响度达到该值视为活动
+  float attack_ms;	// 从 0 dB 衰减到深度所需时间
+  float hold_ms;	// 人声停止后保持衰减的时间
+  float release_ms;	// 从深度恢复到 0 dB 所需时间
+} RouterDuckParams;
+
+// 共享状态：参数由控制线程写入，人声活动由任意实时通道上报
+typedef struct
+{
+  atomic_bool enabled;
+  _Atomic float depth_db;
+  _Atomic float threshold_lufs;
+  _Atomic float attack_ms;
+  _Atomic float hold_ms;
+  _Atomic float release_ms;
+  _Atomic uint64_t voice_ns; // 最近一次人声活动的时刻（0 表示尚未出现）
+} RouterDuckControl;
+
+// 单个媒体通道的闪避增益（实时线程）
+typedef struct
+{
+  float gain_db; // 当前增益 (dB，不大于 0)
+} RouterDuck;
+
+// ============================================================================
+// API
+// ============================================================================
+
+/**
+ * 初始化共享状态（默认参数，未启用，无人声活动）
+ *
+ * @param control 共享状态指针
+ */
+void
+router_duck_control_init (RouterDuckControl *control);
+
+/**
+ * 检查参数是否在有效范围内
+ *
+ * @param params 参数
+ * @return 有效返回 true
+ */
+bool
+router_duck_params_are_valid (const RouterDuckParams *params);
+
+/**
+ * 设置参数（控制线程，可在实时线程处理期间调用）
+ *
+ * @param control 共享状态指针
+ * @param params 参数
+ * @return 成功返回 0；参数超出范围返回 -1（原参数保持不变）
+ */
+int
+router_duck_set_params (RouterDuckControl *control,
+			const RouterDuckParams *params);
+
+/**
+ * 读取当前参数（任意线程）
+ *
+ * @param control 共享状态指针
+ * @param params 输出参数
+ */
+void
+router_duck_get_params (RouterDuckControl *control, RouterDuckParams *params);
+
+/**
+ * 上报人声通道本块的瞬时响度（实时线程），达到门限时记录活动时刻
+ *
+ * @param control 共享状态指针
+ * @param params 参数
+ * @param loudness_lufs 人声通道当前的瞬时响度
+ * @param now_ns 单调时钟（纳秒，不为 0）
+ */
+void
+router_duck_report_voice (RouterDuckControl *control,
+			  const RouterDuckParams *params, float loudness_lufs,
+			  uint64_t now_ns);
+
+/**
+ * 媒体通道是否应处于闪避状态（最近一次人声活动在保持时间内）
+ *
+ * @param control 共享状态指针
+ * @param params 参数
+ * @param now_ns 单调时钟（纳秒）
+ * @return 应衰减返回 true；未启用时返回 false
+ */
+bool
+router_duck_is_engaged (RouterDuckControl *control,
+			const RouterDuckParams *params, uint64_t now_ns);
+
+/**
+ * 初始化媒体通道增益（0 dB）
+ *
+ * @param duck 通道增益指针
+ */
+void
+router_duck_init (RouterDuck *duck);
+
+/**
+ * 按本块是否闪避更新通道增益（实时线程，每块一次）
+ *
+ * @param duck 通道增益指针
+ * @param params 参数
+ * @param engaged 本块是否闪避
+ * @param frames 本块帧数
+ * @param sample_rate 采样率
+ * @return 本块终点的增益 (dB)
+ */
+float
+router_duck_update (RouterDuck *duck, const RouterDuckParams *params,
+		    bool engaged, uint32_t frames, uint32_t sample_rate);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIOCTL_ROUTER_DUCK_H
@@ -0,0 +1,175 @@
+//
+// Router 参数均衡器
+// 最多 10 段双二阶滤波器串联（峰值、低/高架、高通、低通），作为 DSP 链
+// 中的一级运行。每段滤波器的状态按声道连续存放，逐帧同时更新所有声道
+// （声道对应向量通道）。参数变化时系数在约 10ms 内逐帧线性过渡，不产生爆音
+//
+
+#ifndef AUDIOCTL_ROUTER_EQ_H
+#define AUDIOCTL_ROUTER_EQ_H
+
+#include "router/router_dsp.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// 配置
+// ============================================================================
+
+#define ROUTER_EQ_MAX_BANDS 10	  // 最大段数
+#define ROUTER_EQ_MAX_CHANNELS 8  // 支持的最大声道数
+#define ROUTER_EQ_RAMP_MS 10	  // 系数过渡时长
+#define ROUTER_EQ_TAIL_MS 250	  // 静音输入后的尾音时长
+#define ROUTER_EQ_MIN_FREQ 10.0f  // 中心/截止频率下限 (Hz)
+#define ROUTER_EQ_MAX_FREQ 40000.0f // 频率上限 (Hz)，设计时再按采样率收窄
+#define ROUTER_EQ_MAX_GAIN_DB 24.0f // 单段增益和前级增益的绝对值上限
+#define ROUTER_EQ_MIN_Q 0.1f	    // Q 下限
+#define ROUTER_EQ_MAX_Q 24.0f	    // Q 上限
+
+// 滤波器类型（取值与 IPC 协议的 IPCEqualizerBand.type 一致）
+typedef enum
+{
+  kRouterEqPeaking = 0,	  // 峰值：以 frequency 为中心提升/衰减 gain_db
+  kRouterEqLowShelf = 1,  // 低架：frequency 以下提升/衰减 gain_db
+  kRouterEqHighShelf = 2, // 高架：frequency 以上提升/衰减 gain_db
+  kRouterEqHighPass = 3,  // 二阶高通（忽略 gain_db）
+  kRouterEqLowPass = 4,	  // 二阶低通（忽略 gain_db）
+  kRouterEqTypeCount
+} RouterEqBandType;
+
+// 单段参数
+typedef struct
+{
+  RouterEqBandType type;
+  bool enabled;
+  float frequency; // 中心/截止频率 (Hz)
+  float gain_db;   // 增益 (dB)
+  float q;	   // 品质因数（架式滤波器为斜率）
+} RouterEqBand;
+
+// 双二阶系数（已按 a0 归一化）
+typedef struct
+{
+  float b0, b1, b2, a1, a2;
+} RouterEqBiquad;
+
+// 一组完整系数
+typedef struct
+{
+  float preamp;	       // 前级线性增益
+  uint32_t band_count; // 需要处理的段数（其后各段均为直通）
+  RouterEqBiquad bands[ROUTER_EQ_MAX_BANDS];
+} RouterEqCoeffs;
+
+// 均衡器（由调用者分配，不在内部分配内存）
+// 控制线程把新系数写入三缓冲的后台槽位后原子交换到中间槽位，实时线程
+// 在块开始时取走中间槽位作为过渡目标，两边都不等待对方
+typedef struct
+{
+  RouterDspProcessor processor; // 加入 DSP 链的处理器
+
+  // 控制线程
+  pthread_mutex_t mutex; // 保护参数、采样率和后台槽位
+  RouterEqBand bands[ROUTER_EQ_MAX_BANDS];
+  uint32_t band_count;
+  float preamp_db;
+  bool enabled;		// 关闭时所有系数为直通
+  uint32_t sample_rate; // prepare 前为 0，此时只保存参数
+  uint32_t back;	// 后台槽位
+
+  // 共享：中间槽位序号 | 新数据标志
+  RouterEqCoeffs slots[3];
+  _Atomic uint32_t middle;
+
+  // 实时线程
+  uint32_t front;	   // 当前过渡目标所在槽位
+  uint32_t channels;	   // 声道数
+  uint32_t ramp_frames;	   // 一次过渡的帧数
+  uint32_t ramp_left;	   // 当前过渡剩余帧数
+  RouterEqCoeffs current;  // 当前系数（过渡中逐帧逼近目标）
+  RouterEqCoeffs step;	   // 过渡中每帧的系数增量
+  uint32_t active_bands;   // 当前和目标中需要处理的段数较大者
+  // 滤波器状态（直接 II 型转置），每段按声道连续存放
+  float z1[ROUTER_EQ_MAX_BANDS][ROUTER_EQ_MAX_CHANNELS];
+  float z2[ROUTER_EQ_MAX_BANDS][ROUTER_EQ_MAX_CHANNELS];
+} RouterEq;
+
+// ============================================================================
+// API
+// ============================================================================
+
+/**
+ * 初始化均衡器（关闭、无段）并填好 processor，可直接加入 DSP 链
+ *
+ * @param eq 均衡器指针
+ */
+void
+router_eq_init (RouterEq *eq);
+
+/**
+ * 释放均衡器（须已从 DSP 链移除）
+ *
+ * @param eq 均衡器指针
+ */
+void
+router_eq_destroy (RouterEq *eq);
+
+/**
+ * 检查单段参数是否在有效范围内
+ *
+ * @param band 单段参数
+ * @return 有效返回 true
+ */
+bool
+router_eq_band_is_valid (const RouterEqBand *band);
+
+/**
+ * 设置均衡器参数（控制线程，可在实时线程处理期间调用）
+ * 已 prepare 时立即计算系数并发布，实时线程在下一块开始过渡
+ *
+ * @param eq 均衡器指针
+ * @param enabled false 时整体直通（同样平滑过渡）
+ * @param preamp_db 前级增益 (dB)
+ * @param bands 各段参数，band_count 为 0 时可为 NULL
+ * @param band_count 段数（不超过 ROUTER_EQ_MAX_BANDS）
+ * @return 成功返回 0；段数过多或参数超出范围返回 -1（原参数保持不变）
+ */
+int
+router_eq_set_config (RouterEq *eq, bool enabled, float preamp_db,
+		      const RouterEqBand *bands, uint32_t band_count);
+
+/**
+ * 按 RBJ Audio EQ Cookbook 计算单段系数
+ * 频率超过 0.45 × 采样率时收窄到该值
+ *
+ * @param band 单段参数（enabled 为 false 时输出直通系数）
+ * @param sample_rate 采样率
+ * @param out 输出系数
+ */
+void
+router_eq_design (const RouterEqBand *band, uint32_t sample_rate,
+		  RouterEqBiquad *out);
+
+/**
+ * 计算系数在某个频率处的幅度响应
+ *
+ * @param coeffs 系数
+ * @param frequency 频率 (Hz)
+ * @param sample_rate 采样率
+ * @return 幅度响应 (dB)
+ */
+double
+router_eq_response_db (const RouterEqBiquad *coeffs, double frequency,
+		       uint32_t sample_rate);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIOCTL_ROUTER_EQ_H
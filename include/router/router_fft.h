@@ -0,0 +1,89 @@
+//
+// 实数 FFT
+// 长度为 2 的幂的实数序列与其非负频率一半频谱之间的变换：内部做一次
+// 长度减半的基 2 复数 FFT，再按奇偶拆分得到 N/2 + 1 个频点。频谱按实部、
+// 虚部两个数组分开存放，便于调用方逐频点做向量乘加
+//
+
+#ifndef AUDIOCTL_ROUTER_FFT_H
+#define AUDIOCTL_ROUTER_FFT_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// 配置
+// ============================================================================
+
+#define ROUTER_FFT_MIN_SIZE 4	  // 变换长度下限
+#define ROUTER_FFT_MAX_SIZE 65536 // 变换长度上限
+
+// 变换计划（旋转因子、位反转表和工作区，在 init 时分配）
+// 同一个计划不能被多个线程同时使用
+typedef struct
+{
+  uint32_t size;       // 实数变换长度 N
+  uint32_t half;       // 复数变换长度 N/2，也是最高频点的序号
+  uint32_t *bitrev;    // 复数变换的位反转表，half 个
+  float *twiddle_re;   // 复数变换旋转因子 e^(-2πik/half)，half/2 个
+  float *twiddle_im;
+  float *split_re;     // 奇偶拆分旋转因子 e^(-2πik/N)，half 个
+  float *split_im;
+  float *work_re;      // 工作区，half 个
+  float *work_im;
+} RouterFft;
+
+// ============================================================================
+// API
+// ============================================================================
+
+/**
+ * 创建变换计划（非实时线程，内部分配内存）
+ *
+ * @param fft 计划指针
+ * @param size 实数变换长度（2 的幂，ROUTER_FFT_MIN_SIZE ~ ROUTER_FFT_MAX_SIZE）
+ * @return 成功返回 0；长度无效或内存不足返回 -1
+ */
+int
+router_fft_init (RouterFft *fft, uint32_t size);
+
+/**
+ * 释放计划持有的内存（可重复调用）
+ *
+ * @param fft 计划指针
+ */
+void
+router_fft_destroy (RouterFft *fft);
+
+/**
+ * 正变换：X[k] = Σ x[n] e^(-2πikn/N)，k = 0 ~ N/2（不分配内存）
+ *
+ * @param fft 计划指针
+ * @param input 实数输入，N 个
+ * @param re 频谱实部，N/2 + 1 个
+ * @param im 频谱虚部，N/2 + 1 个（第 0 和第 N/2 个频点为 0）
+ */
+void
+router_fft_forward (RouterFft *fft, const float *input, float *re, float *im);
+
+/**
+ * 逆变换（含 1/N 缩放，与正变换互逆，不分配内存）
+ * 输入视为共轭对称频谱的非负频率一半，第 0 和第 N/2 个频点的虚部被忽略
+ *
+ * @param fft 计划指针
+ * @param re 频谱实部，N/2 + 1 个
+ * @param im 频谱虚部，N/2 + 1 个
+ * @param output 实数输出，N 个（不能与 re/im 重叠）
+ */
+void
+router_fft_inverse (RouterFft *fft, const float *re, const float *im,
+		    float *output);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIOCTL_ROUTER_FFT_H
@@ -0,0 +1,92 @@
+//
+// Router 帧环（单生产者、单消费者、无锁）
+// 实时线程把整块交错采样推入环，非实时线程（写盘、网络）取出。读写位置是
+// 单调递增的帧计数，容量为 2 的幂；空间不足时丢弃整块并计数，生产者从不
+// 等待。存储由调用者分配（通常来自 router_locked_alloc）
+//
+
+#ifndef AUDIOCTL_ROUTER_FRAME_RING_H
+#define AUDIOCTL_ROUTER_FRAME_RING_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 帧环
+typedef struct
+{
+  // 初始化后只读
+  float *storage;    // capacity * channels 个采样（调用者管理）
+  uint32_t capacity; // 容量（帧，2 的幂）
+  uint32_t channels;
+
+  // 共享：单调递增的读写帧计数
+  _Atomic uint64_t write_pos;
+  _Atomic uint64_t read_pos;
+  _Atomic uint32_t dropped_blocks; // 空间不足丢弃的块数
+  _Atomic uint64_t dropped_frames; // 空间不足丢弃的帧数
+} RouterFrameRing;
+
+/**
+ * 绑定存储并清零计数（不分配内存，非实时线程）
+ *
+ * @param ring 帧环指针
+ * @param storage capacity * channels 个 float 的存储
+ * @param capacity 容量（帧，2 的幂）
+ * @param channels 声道数
+ * @return 成功返回 0；参数无效返回 -1
+ */
+int
+router_frame_ring_init (RouterFrameRing *ring, float *storage,
+			uint32_t capacity, uint32_t channels);
+
+/**
+ * 推入一块交错采样（生产者，实时线程安全）
+ * 空间不足时丢弃整块并计入 dropped_blocks / dropped_frames（release 语义，
+ * 消费者可以据此推进时间线）
+ *
+ * @param ring 帧环指针
+ * @param buffer 交错采样
+ * @param frames 帧数
+ * @return 成功返回 true；丢弃时返回 false
+ */
+bool
+router_frame_ring_push (RouterFrameRing *ring, const float *buffer,
+			uint32_t frames);
+
+/**
+ * 可读帧数（消费者）
+ *
+ * @param ring 帧环指针
+ * @return 帧数
+ */
+uint64_t
+router_frame_ring_available (RouterFrameRing *ring);
+
+/**
+ * 取出若干帧（消费者）
+ *
+ * @param ring 帧环指针
+ * @param buffer 输出缓冲区（frames * channels 个采样）
+ * @param frames 帧数（不超过 router_frame_ring_available）
+ */
+void
+router_frame_ring_read (RouterFrameRing *ring, float *buffer, uint32_t frames);
+
+/**
+ * 丢弃全部可读帧（消费者）
+ *
+ * @param ring 帧环指针
+ */
+void
+router_frame_ring_discard (RouterFrameRing *ring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIOCTL_ROUTER_FRAME_RING_H
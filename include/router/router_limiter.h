@@ -0,0 +1,167 @@
+//
+// Router 预读砖墙限制器
+// 作为 DSP 链的最后一级，保证输出的真峰值（4 倍过采样估计）不超过上限。
+// 输入延迟“预读时长”后输出，增益在峰值到达之前的预读窗口内平滑下降，
+// 之后按释放时间指数恢复。窗口最小值用单调队列维护，每帧均摊 O(1)
+//
+
+#ifndef AUDIOCTL_ROUTER_LIMITER_H
+#define AUDIOCTL_ROUTER_LIMITER_H
+
+#include "router/router_dsp.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// 配置
+// ============================================================================
+
+#define ROUTER_LIMITER_MAX_CHANNELS 8	     // 支持的最大声道数
+#define ROUTER_LIMITER_MAX_SAMPLE_RATE 192000 // 预读缓冲按该采样率预分配
+#define ROUTER_LIMITER_MIN_LOOKAHEAD_MS 1.0f // 预读时长下限
+#define ROUTER_LIMITER_MAX_LOOKAHEAD_MS 5.0f // 预读时长上限
+#define ROUTER_LIMITER_MIN_RELEASE_MS 1.0f   // 释放时间下限
+#define ROUTER_LIMITER_MAX_RELEASE_MS 5000.0f // 释放时间上限
+#define ROUTER_LIMITER_MIN_CEILING_DB -24.0f // 上限电平下限 (dBTP)
+#define ROUTER_LIMITER_MAX_CEILING_DB 0.0f   // 上限电平上限 (dBTP)
+
+#define ROUTER_LIMITER_DEFAULT_LOOKAHEAD_MS 1.5f
+#define ROUTER_LIMITER_DEFAULT_RELEASE_MS 50.0f
+#define ROUTER_LIMITER_DEFAULT_CEILING_DB -1.0f
+
+// 真峰值插值滤波器：每个相位的抽头数（窗函数 sinc，群延迟为其一半）
+#define ROUTER_LIMITER_TP_TAPS 12
+#define ROUTER_LIMITER_TP_PHASES 3 // 两个采样之间的插值点数（4 倍过采样）
+#define ROUTER_LIMITER_TP_LANES 4  // 系数按 4 路存放（末路为 0），各相位并行计算
+
+// 预读帧数上限及窗口队列容量（2 的幂，不小于最大窗口长度）
+#define ROUTER_LIMITER_MAX_LOOKAHEAD_FRAMES                                    \
+  (ROUTER_LIMITER_MAX_SAMPLE_RATE / 1000 * 5) // ROUTER_LIMITER_MAX_LOOKAHEAD_MS
+#define ROUTER_LIMITER_WINDOW_CAP 1024
+#define ROUTER_LIMITER_MAX_DELAY_FRAMES                                        \
+  (ROUTER_LIMITER_MAX_LOOKAHEAD_FRAMES + ROUTER_LIMITER_TP_TAPS / 2)
+
+// 限制器参数
+typedef struct
+{
+  float lookahead_ms; // 预读时长（同时是限制器引入的延迟）
+  float release_ms;   // 增益恢复到 1 - 1/e 所需时间
+  float ceiling_db;   // 输出真峰值上限 (dBTP)
+} RouterLimiterParams;
+
+// 限制器（由调用者分配，不在内部分配内存）
+// 释放时间和上限电平随时生效；预读时长改变延迟，在下一次 prepare 时生效
+typedef struct
+{
+  RouterDspProcessor processor; // 加入 DSP 链的处理器
+
+  // 控制线程写、实时线程每块读取
+  _Atomic float lookahead_ms;
+  _Atomic float release_ms;
+  _Atomic float ceiling_db;
+
+  // 统计：周期内最大增益衰减（0.01 dB），由 router_limiter_collect 取出清零
+  _Atomic uint32_t gr_peak_cdb;
+
+  // 实时线程
+  uint32_t channels;	   // 声道数
+  uint32_t sample_rate;	   // 采样率
+  uint32_t window;	   // 窗口长度（预读帧数 + 1）
+  uint32_t delay;	   // 输出相对输入的延迟帧数
+  uint32_t delay_pos;	   // 延迟线写位置
+  uint32_t tp_pos;	   // 插值历史写位置
+  uint32_t frame_index;	   // 已处理帧数（回绕无影响）
+  float release_ms_cached; // 计算 release_coeff 时的释放时间
+  float release_coeff;	   // 每帧释放系数
+  float ceiling;	   // 线性上限
+  float hold_peak;	   // 最近两块输入的峰值（判断能否跳过插值）
+  float last_between;	   // 上一帧中心采样之后的插值峰值
+  float gain;		   // 释放平滑后的增益
+  double box_sum;	   // 平滑窗口内增益之和
+  uint32_t box_pos;	   // 平滑窗口写位置
+  uint32_t queue_head;	   // 单调队列头（最小值）
+  uint32_t queue_tail;	   // 单调队列尾
+  float tp_bound;	   // 插值相对采样峰值的最大放大倍数
+  float tp_coeffs[ROUTER_LIMITER_TP_TAPS][ROUTER_LIMITER_TP_LANES];
+  // 每声道插值历史，写两份使任意 TAPS 个连续采样在内存中连续
+  float tp_history[ROUTER_LIMITER_MAX_CHANNELS][2 * ROUTER_LIMITER_TP_TAPS];
+  float queue_gain[ROUTER_LIMITER_WINDOW_CAP];	   // 单调递增的所需增益
+  uint32_t queue_frame[ROUTER_LIMITER_WINDOW_CAP]; // 对应的帧序号
+  float box[ROUTER_LIMITER_WINDOW_CAP];		   // 平滑窗口
+  float delay_line[ROUTER_LIMITER_MAX_DELAY_FRAMES
+		   * ROUTER_LIMITER_MAX_CHANNELS];
+} RouterLimiter;
+
+// ============================================================================
+// API
+// ============================================================================
+
+/**
+ * 初始化限制器（默认参数）并填好 processor，可直接加入 DSP 链
+ *
+ * @param limiter 限制器指针
+ */
+void
+router_limiter_init (RouterLimiter *limiter);
+
+/**
+ * 检查参数是否在有效范围内
+ *
+ * @param params 参数
+ * @return 有效返回 true
+ */
+bool
+router_limiter_params_are_valid (const RouterLimiterParams *params);
+
+/**
+ * 设置参数（控制线程，可在实时线程处理期间调用）
+ *
+ * @param limiter 限制器指针
+ * @param params 参数
+ * @return 成功返回 0；参数超出范围返回 -1（原参数保持不变）
+ */
+int
+router_limiter_set_params (RouterLimiter *limiter,
+			   const RouterLimiterParams *params);
+
+/**
+ * 读取当前参数
+ *
+ * @param limiter 限制器指针
+ * @param params 输出参数
+ */
+void
+router_limiter_get_params (RouterLimiter *limiter,
+			   RouterLimiterParams *params);
+
+/**
+ * 取出上次调用以来的最大增益衰减并清零（任意线程）
+ *
+ * @param limiter 限制器指针
+ * @return 最大增益衰减，单位 0.01 dB；未发生限制返回 0
+ */
+uint32_t
+router_limiter_collect (RouterLimiter *limiter);
+
+/**
+ * 计算真峰值插值滤波器系数（窗函数 sinc，4 倍过采样，响度计共用）
+ * 第 p 个相位位于 TAPS 个连续采样中第 TAPS/2 - 1 与 TAPS/2 个之间的
+ * (p + 1) / 4 处
+ *
+ * @param coeffs 输出系数，coeffs[j][p] 为第 p 个相位的第 j 个抽头（末路为 0）
+ * @return 插值相对采样峰值的最大放大倍数
+ */
+float
+router_limiter_design_true_peak (
+  float coeffs[ROUTER_LIMITER_TP_TAPS][ROUTER_LIMITER_TP_LANES]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIOCTL_ROUTER_LIMITER_H
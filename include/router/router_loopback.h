@@ -0,0 +1,74 @@
+//
+// Router 回环缓冲区（虚拟设备输出 -> 输入）
+// 驱动的 WriteMix 写入混音后的交错采样，ReadInput 取出。写入从不等待也不
+// 检查空间，读写位置按缓冲区大小回绕。静音块只推进写位置，读者遇到整块
+// 静音时直接输出零，不拷贝
+//
+
+#ifndef AUDIOCTL_ROUTER_LOOPBACK_H
+#define AUDIOCTL_ROUTER_LOOPBACK_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 缓冲区大小（采样数）
+#define ROUTER_LOOPBACK_SAMPLES 16384
+
+// 回环缓冲区（单生产者、单消费者）
+typedef struct
+{
+  float buffer[ROUTER_LOOPBACK_SAMPLES];
+  atomic_uint write_pos; // 采样索引，按 ROUTER_LOOPBACK_SAMPLES 回绕
+  atomic_uint read_pos;
+  // 静音标记：(标记时的写位置 << 32) | 该位置之前连续静音的采样数，0 表示
+  // 无标记。读者只在写位置与标记一致时采信；有声写入先撤销标记再发布写位置
+  _Atomic uint64_t silence;
+  // 自上次写入有声数据以来写入的静音采样数（仅生产者，达到缓冲区大小即饱和）
+  // 饱和时缓冲区已全是零，静音写入只需推进写位置
+  uint32_t zero_fill;
+} RouterLoopback;
+
+// 静态初始化：缓冲区全零，静音写入可以直接走快速路径
+#define ROUTER_LOOPBACK_INIT {.zero_fill = ROUTER_LOOPBACK_SAMPLES}
+
+/**
+ * 清零缓冲区和读写位置（调用时不能有并发读写）
+ *
+ * @param loopback 回环缓冲区指针
+ */
+void
+router_loopback_reset (RouterLoopback *loopback);
+
+/**
+ * 写入交错采样（生产者，实时线程安全）
+ *
+ * @param loopback 回环缓冲区指针
+ * @param samples 交错采样
+ * @param count 采样数（不超过 ROUTER_LOOPBACK_SAMPLES）
+ */
+void
+router_loopback_write (RouterLoopback *loopback, const float *samples,
+		       uint32_t count);
+
+/**
+ * 读取交错采样（消费者，实时线程安全）
+ *
+ * @param loopback 回环缓冲区指针
+ * @param samples 输出缓冲区
+ * @param count 采样数
+ * @return 成功返回 true；数据不足时输出静音、不推进读位置并返回 false
+ */
+bool
+router_loopback_read (RouterLoopback *loopback, float *samples,
+		      uint32_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIOCTL_ROUTER_LOOPBACK_H
@@ -0,0 +1,147 @@
+//
+// Router 响度计（ITU-R BS.1770 / EBU R128）
+// 对交错采样做 K 加权，按 100ms 子块累计能量：瞬时响度取最近 4 个子块
+// （400ms），短期响度取最近 30 个子块（3s）；积分响度把每个 400ms 门限块
+// （重叠 75%）计入按 0.1 LU 分桶的直方图，再做 -70 LUFS 绝对门限和 -10 LU
+// 相对门限，内存与测量时长无关。真峰值用 4 倍过采样插值估计（与限制器
+// 相同的插值滤波器）。实时线程每个子块发布一次读数，任意线程可读取
+//
+
+#ifndef AUDIOCTL_ROUTER_LOUDNESS_H
+#define AUDIOCTL_ROUTER_LOUDNESS_H
+
+#include "router/router_limiter.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// 配置
+// ============================================================================
+
+#define ROUTER_LOUDNESS_MAX_CHANNELS 8		  // 支持的最大声道数
+#define ROUTER_LOUDNESS_BLOCK_MS 100		  // 子块时长
+#define ROUTER_LOUDNESS_MOMENTARY_BLOCKS 4	  // 瞬时响度窗口（400ms）
+#define ROUTER_LOUDNESS_SHORT_TERM_BLOCKS 30	  // 短期响度窗口（3s）
+#define ROUTER_LOUDNESS_ABSOLUTE_GATE_LUFS -70.0f // 积分响度绝对门限
+#define ROUTER_LOUDNESS_RELATIVE_GATE_LU -10.0f	  // 积分响度相对门限
+#define ROUTER_LOUDNESS_HISTOGRAM_MAX_LUFS 10.0f  // 直方图上限（更响的计入末桶）
+#define ROUTER_LOUDNESS_HISTOGRAM_BINS 800	  // 绝对门限到上限，每桶 0.1 LU
+#define ROUTER_LOUDNESS_MIN_LUFS -120.0f // 读数下限：无信号或尚无门限块
+
+// 一组读数（响度单位 LUFS，真峰值单位 dBTP，均不低于 ROUTER_LOUDNESS_MIN_LUFS）
+typedef struct
+{
+  float momentary_lufs;	 // 瞬时响度（最近 400ms）
+  float short_term_lufs; // 短期响度（最近 3s）
+  float integrated_lufs; // 积分响度（自上次重置）
+  float true_peak_dbtp;	 // 最大真峰值（自上次重置）
+} RouterLoudnessReading;
+
+// 响度计（由调用者分配，不在内部分配内存）
+typedef struct
+{
+  // 实时线程发布、任意线程读取
+  _Atomic float momentary_lufs;
+  _Atomic float short_term_lufs;
+  _Atomic float integrated_lufs;
+  _Atomic float true_peak; // 线性
+  atomic_bool reset_pending; // 由实时线程在下一块开始时清零状态
+
+  // 实时线程
+  uint32_t sample_rate;	 // 采样率（prepare 前为 0，此时 process 不做任何事）
+  uint32_t channels;	 // 声道数
+  uint32_t block_frames; // 子块帧数
+  uint32_t block_pos;	 // 当前子块已累计的帧数
+  double block_sum;	 // 当前子块加权平方和
+  uint32_t block_next;	 // 子块能量环写位置
+  uint32_t block_count;	 // 已完成的子块数（饱和于短期窗口长度）
+  double blocks[ROUTER_LOUDNESS_SHORT_TERM_BLOCKS]; // 各子块的均方能量
+  uint32_t histogram[ROUTER_LOUDNESS_HISTOGRAM_BINS]; // 门限块响度分布
+  double weights[ROUTER_LOUDNESS_MAX_CHANNELS];	      // 声道权重
+  // K 加权：高架 + 高通两级双二阶（直接 II 型转置），按 a0 归一化
+  double shelf_b[3], shelf_a[2];
+  double highpass_a[2]; // 高通分子固定为 1, -2, 1
+  double z[ROUTER_LOUDNESS_MAX_CHANNELS][4];
+  float peak;	   // 最大真峰值（线性）
+  float hold_peak; // 上一块输入的采样峰值（判断能否跳过插值）
+  uint32_t tp_pos; // 插值历史写位置
+  float tp_bound;  // 插值相对采样峰值的最大放大倍数
+  float tp_coeffs[ROUTER_LIMITER_TP_TAPS][ROUTER_LIMITER_TP_LANES];
+  float tp_history[ROUTER_LOUDNESS_MAX_CHANNELS][2 * ROUTER_LIMITER_TP_TAPS];
+} RouterLoudness;
+
+// ============================================================================
+// API
+// ============================================================================
+
+/**
+ * 初始化响度计（未 prepare，读数为下限）
+ *
+ * @param meter 响度计指针
+ */
+void
+router_loudness_init (RouterLoudness *meter);
+
+/**
+ * 按格式计算滤波器系数并清零所有状态（非实时线程，不得与 process 并发）
+ *
+ * @param meter 响度计指针
+ * @param sample_rate 采样率
+ * @param channels 声道数；6 声道及以上按 5.1 排列加权（第 4 声道 LFE
+ *                 不计入，第 5 声道起为环绕声道，权重 1.41）
+ * @return 成功返回 0；采样率为 0 或声道数超出范围返回 -1
+ */
+int
+router_loudness_prepare (RouterLoudness *meter, uint32_t sample_rate,
+			 uint32_t channels);
+
+/**
+ * 测量交错采样（实时线程，不修改输入）
+ *
+ * @param meter 响度计指针
+ * @param buffer 交错采样，frames × channels 个
+ * @param frames 帧数
+ */
+void
+router_loudness_process (RouterLoudness *meter, const float *buffer,
+			 uint32_t frames);
+
+/**
+ * 计入一段数字静音（实时线程）
+ * 与对全零采样调用 router_loudness_process 等价，但不需要缓冲区，也不做
+ * 逐采样计算；调用方跳过静音块时用它保持时间轴
+ *
+ * @param meter 响度计指针
+ * @param frames 帧数
+ */
+void
+router_loudness_add_silence (RouterLoudness *meter, uint32_t frames);
+
+/**
+ * 请求重置积分响度、真峰值和所有窗口（任意线程）
+ * 实时线程在下一次 process / add_silence 开始时执行
+ *
+ * @param meter 响度计指针
+ */
+void
+router_loudness_reset (RouterLoudness *meter);
+
+/**
+ * 读取最近发布的读数（任意线程）
+ *
+ * @param meter 响度计指针
+ * @param reading 输出读数
+ */
+void
+router_loudness_read (RouterLoudness *meter, RouterLoudnessReading *reading);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIOCTL_ROUTER_LOUDNESS_H
@@ -0,0 +1,140 @@
+//
+// 声道矩阵
+// 输出声道 o = Σ 增益[o][i] × 输入声道 i，支持 N×M（声道数不同时可做
+// 上混/下混）。设置时按矩阵形状分类：单位矩阵直接跳过，对角矩阵逐声道
+// 缩放，双声道 2×2 矩阵按两帧四路向量计算，其余按通用路径逐帧计算。
+// 立体声的平衡、声像、单声道混合和左右互换都可以表示为 2×2 矩阵
+//
+
+#ifndef AUDIOCTL_ROUTER_MATRIX_H
+#define AUDIOCTL_ROUTER_MATRIX_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// 配置
+// ============================================================================
+
+#define ROUTER_MATRIX_MAX_CHANNELS 8 // 输入/输出声道数上限
+#define ROUTER_MATRIX_MAX_GAIN 4.0f  // 单个增益的绝对值上限 (+12 dB)
+
+// 矩阵形状（决定处理路径）
+typedef enum
+{
+  kRouterMatrixIdentity = 0, // 单位矩阵：不处理
+  kRouterMatrixDiagonal = 1, // 对角矩阵：逐声道缩放
+  kRouterMatrixFull = 2,     // 一般矩阵：声道间混合
+} RouterMatrixKind;
+
+typedef struct
+{
+  uint32_t inputs;	 // 输入声道数
+  uint32_t outputs;	 // 输出声道数
+  RouterMatrixKind kind; // 由 router_matrix_set 计算
+  // gains[o][i]：输入声道 i 混入输出声道 o 的增益
+  float gains[ROUTER_MATRIX_MAX_CHANNELS][ROUTER_MATRIX_MAX_CHANNELS];
+} RouterMatrix;
+
+// 立体声混合参数（生成 2×2 矩阵）
+typedef struct
+{
+  float balance; // 平衡 (-1 ~ 1)：衰减另一侧声道，0 为居中
+  float pan;	 // 声像 (-1 ~ 1)：把另一侧声道并入这一侧，0 为居中
+  bool mono;	 // 左右混合为单声道 ((L + R) / 2)
+  bool swap;	 // 左右互换
+} RouterStereoMix;
+
+// ============================================================================
+// API
+// ============================================================================
+
+/**
+ * 初始化为单位矩阵；声道数不同时输出声道 o 取输入声道 o（多余的输出为 0）
+ *
+ * @param matrix 矩阵指针
+ * @param inputs 输入声道数 (1 ~ ROUTER_MATRIX_MAX_CHANNELS)
+ * @param outputs 输出声道数 (1 ~ ROUTER_MATRIX_MAX_CHANNELS)
+ * @return 成功返回 0，声道数超出范围返回 -1
+ */
+int
+router_matrix_init (RouterMatrix *matrix, uint32_t inputs, uint32_t outputs);
+
+/**
+ * 设置全部增益并重新分类
+ *
+ * @param matrix 矩阵指针
+ * @param inputs 输入声道数
+ * @param outputs 输出声道数
+ * @param gains 按行排列的 outputs × inputs 个增益（第 o 行为输出声道 o）
+ * @return 成功返回 0；声道数超出范围或增益无效（非有限值、超过上限）
+ *         返回 -1（原矩阵保持不变）
+ */
+int
+router_matrix_set (RouterMatrix *matrix, uint32_t inputs, uint32_t outputs,
+		   const float *gains);
+
+/**
+ * 检查立体声混合参数是否在有效范围内
+ *
+ * @param mix 参数
+ * @return 有效返回 true
+ */
+bool
+router_stereo_mix_is_valid (const RouterStereoMix *mix);
+
+/**
+ * 按立体声混合参数生成 2×2 矩阵，依次为 互换 -> 单声道 -> 声像 -> 平衡
+ *
+ * @param matrix 矩阵指针
+ * @param mix 参数
+ * @return 成功返回 0，参数超出范围返回 -1（原矩阵保持不变）
+ */
+int
+router_matrix_from_stereo (RouterMatrix *matrix, const RouterStereoMix *mix);
+
+/**
+ * 原地处理交错采样（实时线程），要求输入输出声道数相同
+ *
+ * @param matrix 矩阵指针
+ * @param buffer 交错采样，frames × inputs 个
+ * @param frames 帧数
+ */
+void
+router_matrix_apply (const RouterMatrix *matrix, float *buffer,
+		     uint32_t frames);
+
+/**
+ * 从输入缓冲区处理到输出缓冲区（实时线程，声道数可以不同）
+ *
+ * @param matrix 矩阵指针
+ * @param input 交错输入，frames × inputs 个
+ * @param output 交错输出，frames × outputs 个（不能与 input 重叠）
+ * @param frames 帧数
+ */
+void
+router_matrix_process (const RouterMatrix *matrix, const float *input,
+		       float *output, uint32_t frames);
+
+/**
+ * 原地处理交错采样，增益在块内从 from 逐帧线性过渡到 to（实时线程），
+ * 用于矩阵变化时避免爆音；两个矩阵的声道数必须相同且输入输出相等
+ *
+ * @param from 起点矩阵
+ * @param to 终点矩阵（本块最后一帧恰好使用该矩阵）
+ * @param buffer 交错采样，frames × inputs 个
+ * @param frames 帧数
+ */
+void
+router_matrix_apply_ramp (const RouterMatrix *from, const RouterMatrix *to,
+			  float *buffer, uint32_t frames);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIOCTL_ROUTER_MATRIX_H
@@ -0,0 +1,51 @@
+//
+// Router 实时内存
+// 实时线程在每个回调里访问的大块缓冲区（卷积器延迟线、录音环等）不能在
+// 运行中缺页：这里的分配直接映射匿名页（已清零），逐页写入预缺页后
+// mlock。锁定失败（超出 RLIMIT_MEMLOCK）只影响是否常驻，不影响分配结果。
+// 固定大小、随 Router 生命周期的缓冲区放在 audio_router 的预分配区；
+// 生命周期不同（IR 替换、录音器、离线测试）的缓冲区使用这里的分配
+//
+
+#ifndef AUDIOCTL_ROUTER_MEMORY_H
+#define AUDIOCTL_ROUTER_MEMORY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * 分配清零、预缺页并尽量锁定的内存（非实时线程）
+ * 返回的地址按 64 字节对齐
+ *
+ * @param bytes 字节数
+ * @return 成功返回内存指针；bytes 为 0 或映射失败返回 NULL
+ */
+void *
+router_locked_alloc (size_t bytes);
+
+/**
+ * 释放 router_locked_alloc 分配的内存（非实时线程）
+ *
+ * @param ptr 内存指针（可为 NULL）
+ */
+void
+router_locked_free (void *ptr);
+
+/**
+ * 查询分配是否已被 mlock 锁定
+ *
+ * @param ptr router_locked_alloc 返回的指针
+ * @return 已锁定返回 true
+ */
+bool
+router_locked_is_locked (const void *ptr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIOCTL_ROUTER_MEMORY_H
@@ -0,0 +1,165 @@
+//
+// Router 信号通路（与 CoreAudio 无关的部分）
+// 环形缓冲区和输出块处理由实时 IOProc 与离线管线（router_backend.h）
+// 共用，保证离线基准和回归测试覆盖的就是实际运行的代码
+//
+
+#ifndef AUDIOCTL_ROUTER_PIPELINE_H
+#define AUDIOCTL_ROUTER_PIPELINE_H
+
+#include "router/router_dsp.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// 配置
+// ============================================================================
+
+// 环形缓冲区大小（约 42ms @ 48kHz，双声道）- 优化延迟
+#define ROUTER_BUFFER_FRAME_COUNT 2048
+#define ROUTER_MAX_CHANNELS 2
+#define ROUTER_BUFFER_SAMPLES (ROUTER_BUFFER_FRAME_COUNT * ROUTER_MAX_CHANNELS)
+// 位掩码：采样数 - 1，用于快速索引
+#define ROUTER_BUFFER_MASK (ROUTER_BUFFER_SAMPLES - 1)
+
+// ============================================================================
+// 数据结构
+// ============================================================================
+
+// 环形缓冲区结构（单生产者、单消费者、无锁）
+typedef struct
+{
+  float *buffer;
+  uint32_t capacity;
+  atomic_uint write_pos;
+  atomic_uint read_pos;
+  // 性能监控
+  atomic_uint peak_usage;	// 峰值使用率 (0-100%)
+  atomic_uint current_usage;	// 当前使用率
+  atomic_uint samples_buffered; // 当前缓存的采样数
+  atomic_uint interval_peak;	// 本监控周期内的峰值使用率
+  // 静音标记：(静音区起点 << 32) | 1，0 表示尾部不是静音
+  // 起点之后写入的全是静音，读者据此整块跳过拷贝
+  _Atomic uint64_t silence_mark;
+  // 自上次写入非静音数据以来写入的静音采样数（仅生产者，达到容量即饱和）
+  // 达到容量时存储已全部为零，静音写入只需推进写指针
+  uint32_t zero_fill;
+} RouterRingBuffer;
+
+// ============================================================================
+// 环形缓冲区 API
+// ============================================================================
+
+/**
+ * 绑定存储并清零（不分配内存）
+ *
+ * @param rb 环形缓冲区指针
+ * @param storage ROUTER_BUFFER_SAMPLES 个 float 的存储
+ */
+void
+router_ring_init (RouterRingBuffer *rb, float *storage);
+
+/**
+ * 解除存储绑定（存储由调用者管理，不释放）
+ *
+ * @param rb 环形缓冲区指针
+ */
+void
+router_ring_detach (RouterRingBuffer *rb);
+
+/**
+ * 写入交错采样（生产者）
+ *
+ * @param rb 环形缓冲区指针
+ * @param data 交错采样
+ * @param frame_count 帧数
+ * @param channels 声道数
+ * @return 成功返回 true；空间不足时丢弃整块并返回 false（过载）
+ */
+bool
+router_ring_write (RouterRingBuffer *rb, const float *data,
+		   uint32_t frame_count, uint32_t channels);
+
+/**
+ * 写入一段静音（生产者）
+ * 不拷贝采样，只推进写指针并标记静音区；存储中还有旧数据时才清零对应槽位
+ *
+ * @param rb 环形缓冲区指针
+ * @param frame_count 帧数
+ * @param channels 声道数
+ * @return 成功返回 true；空间不足时丢弃整块并返回 false（过载）
+ */
+bool
+router_ring_write_silence (RouterRingBuffer *rb, uint32_t frame_count,
+			   uint32_t channels);
+
+/**
+ * 读取交错采样（消费者）
+ *
+ * @param rb 环形缓冲区指针
+ * @param data 输出缓冲区
+ * @param frame_count 帧数
+ * @param channels 声道数
+ * @return 成功返回 true；数据不足时输出静音并返回 false（欠载）
+ */
+bool
+router_ring_read (RouterRingBuffer *rb, float *data, uint32_t frame_count,
+		  uint32_t channels);
+
+/**
+ * 获取当前缓存的采样数
+ *
+ * @param rb 环形缓冲区指针
+ * @return 采样数（帧数 × 声道数）
+ */
+uint32_t
+router_ring_buffered_samples (RouterRingBuffer *rb);
+
+// ============================================================================
+// 静音检测
+// ============================================================================
+
+/**
+ * 判断一块采样是否全为零（+0.0 和 -0.0 都算静音，NaN 不算）
+ * 内层循环无分支，可被编译器自动向量化；每 64 个采样检查一次以便尽早退出
+ *
+ * @param samples 采样
+ * @param count 采样数
+ * @return 全为零（或 count 为 0）返回 true
+ */
+bool
+router_buffer_is_silent (const float *samples, uint32_t count);
+
+// ============================================================================
+// 输出块处理
+// ============================================================================
+
+/**
+ * 处理一个输出块：从环形缓冲区读出，应用增益补偿，再执行 DSP 链
+ * 输出 IOProc 和离线管线都调用这里；新的处理器通过 DSP 链接入
+ * 整块位于静音区或欠载时直接清零输出并跳过增益，DSP 链只在尾音期内处理
+ *
+ * @param rb 环形缓冲区指针
+ * @param dst 输出缓冲区（交错）
+ * @param frames 帧数
+ * @param channels 声道数
+ * @param gain 增益补偿（只在 0 < gain < 1 时生效）
+ * @param dsp DSP 宿主（可为 NULL）
+ * @param silent 输出本块是否为静音（可为 NULL）
+ * @return 数据不足（欠载，输出静音）返回 false
+ */
+bool
+router_render_output (RouterRingBuffer *rb, float *dst, uint32_t frames,
+		      uint32_t channels, float gain, RouterDspHost *dsp,
+		      bool *silent);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIOCTL_ROUTER_PIPELINE_H
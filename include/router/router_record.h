@@ -0,0 +1,180 @@
+//
+// Router 录音
+// 实时线程一侧只把输出块拷进一个大容量的单生产者/单消费者环（环满时丢弃
+// 整块并计数，从不等待）；写盘线程攒够一批后一次写入，文件按段预先分配
+// 空间。WAV 每秒回填一次文件头，CAF 的数据块长度在录音期间记为"到文件
+// 末尾"，进程意外退出时留下的文件都能直接播放。
+// 开始、停止和换文件都由写盘线程完成，控制函数等它处理完才返回
+//
+
+#ifndef AUDIOCTL_ROUTER_RECORD_H
+#define AUDIOCTL_ROUTER_RECORD_H
+
+#include "router/router_frame_ring.h"
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// 配置
+// ============================================================================
+
+#define ROUTER_RECORD_DEFAULT_RING_FRAMES (1u << 19) // 约 10.9 秒 @ 48 kHz
+#define ROUTER_RECORD_BATCH_FRAMES 8192		     // 每次写盘的帧数
+#define ROUTER_RECORD_POLL_MS 100		     // 写盘线程的检查周期
+#define ROUTER_RECORD_HEADER_INTERVAL_MS 1000	     // 回填文件头的周期
+#define ROUTER_RECORD_PREALLOC_BYTES (64u << 20)     // 每次预分配的文件空间
+
+// 文件格式（取值与 IPC 协议的 IPCRecordConfig.format 一致）
+typedef enum
+{
+  kRouterRecordWav = 0, // RIFF/WAVE，32 位 float（单个文件不超过 4 GB，
+			// 到达上限时自动换文件）
+  kRouterRecordCaf = 1, // Core Audio Format，32 位 float，无长度上限
+  kRouterRecordFormatCount
+} RouterRecordFormat;
+
+// 录音状态快照
+typedef struct
+{
+  bool recording;	  // 是否正在录音
+  RouterRecordFormat format; // 当前（或最近一个）文件的格式
+  uint64_t frames;	  // 当前文件已写入的帧数
+  uint64_t total_frames;  // 初始化以来写入的总帧数
+  uint64_t dropped_frames; // 写盘跟不上时丢弃的总帧数
+  uint32_t dropped_blocks; // 丢弃的块数
+  uint32_t files;	   // 初始化以来打开的文件数
+  int error;		   // 最近一次失败的 errno（0 表示没有）
+  char path[PATH_MAX];	   // 当前（或最近一个）文件
+} RouterRecordStatus;
+
+// 录音器（由调用者分配，init 时分配环并启动写盘线程）
+typedef struct
+{
+  uint32_t channels;
+  _Atomic bool enabled; // 实时线程是否写入
+  RouterFrameRing ring; // 实时线程推入、写盘线程取出；存储预缺页并锁定
+
+  // 控制请求与写盘线程状态（受 mutex 保护）
+  pthread_t thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;	// 唤醒写盘线程
+  pthread_cond_t done;	// 请求处理完成
+  bool running;		// 写盘线程是否继续
+  uint32_t request;	// 待处理的请求（内部编码）
+  uint32_t request_seq; // 请求序号
+  uint32_t applied_seq; // 已处理的请求序号
+  int request_result;	// 最近一个请求的结果
+  char request_dir[PATH_MAX];
+  RouterRecordFormat request_format;
+  uint32_t request_rate;
+  RouterRecordStatus status;
+
+  // 写盘线程私有
+  int fd;
+  uint32_t sample_rate;	   // 当前文件的采样率
+  uint64_t reserved_bytes; // 已预分配到的文件偏移
+  uint64_t header_ms;	   // 上次回填文件头的时间（单调时钟）
+  char dir[PATH_MAX];	   // 当前录音目录
+  float *batch;		   // 写盘暂存，ROUTER_RECORD_BATCH_FRAMES 帧
+} RouterRecorder;
+
+// ============================================================================
+// API
+// ============================================================================
+
+/**
+ * 初始化录音器：分配环和暂存区（预先缺页）并启动写盘线程（非实时线程）
+ *
+ * @param recorder 录音器指针
+ * @param capacity_frames 环容量（帧，2 的幂且不小于
+ *        ROUTER_RECORD_BATCH_FRAMES）
+ * @param channels 声道数
+ * @return 成功返回 0；参数无效、内存不足或无法创建线程返回 -1
+ */
+int
+router_recorder_init (RouterRecorder *recorder, uint32_t capacity_frames,
+		      uint32_t channels);
+
+/**
+ * 停止录音（写完环中剩余的采样）、结束写盘线程并释放资源
+ * 调用前实时线程必须已经停止调用 router_recorder_push
+ *
+ * @param recorder 录音器指针
+ */
+void
+router_recorder_destroy (RouterRecorder *recorder);
+
+/**
+ * 在目录中开始录音，文件名为 audioctl-年月日-时分秒.wav/.caf（重名时追加
+ * 序号）；已在录音时先写完并关闭当前文件，再无缝接到新文件
+ *
+ * @param recorder 录音器指针
+ * @param dir 已存在的目录（绝对路径）
+ * @param format 文件格式
+ * @param sample_rate 采样率
+ * @return 成功返回 0；参数无效或无法创建文件返回 -1（errno 记录在状态中，
+ *         此时不在录音）
+ */
+int
+router_recorder_start (RouterRecorder *recorder, const char *dir,
+		       RouterRecordFormat format, uint32_t sample_rate);
+
+/**
+ * 在当前目录换一个新文件继续录音（不丢失采样）
+ *
+ * @param recorder 录音器指针
+ * @return 成功返回 0；不在录音或无法创建文件返回 -1
+ */
+int
+router_recorder_rotate (RouterRecorder *recorder);
+
+/**
+ * 停止录音：写完环中剩余的采样、回填文件头并关闭文件
+ *
+ * @param recorder 录音器指针
+ */
+void
+router_recorder_stop (RouterRecorder *recorder);
+
+/**
+ * 立即把环中的采样写盘并回填文件头（不在录音时什么也不做）
+ *
+ * @param recorder 录音器指针
+ */
+void
+router_recorder_flush (RouterRecorder *recorder);
+
+/**
+ * 写入一块交错采样（实时线程）：未录音时立即返回；环中放不下整块时
+ * 丢弃整块并计数
+ *
+ * @param recorder 录音器指针
+ * @param buffer 交错采样
+ * @param frames 帧数
+ */
+void
+router_recorder_push (RouterRecorder *recorder, const float *buffer,
+		      uint32_t frames);
+
+/**
+ * 读取状态快照（任意非实时线程）
+ *
+ * @param recorder 录音器指针
+ * @param status 输出状态
+ */
+void
+router_recorder_get_status (RouterRecorder *recorder,
+			    RouterRecordStatus *status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIOCTL_ROUTER_RECORD_H
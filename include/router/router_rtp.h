@@ -0,0 +1,304 @@
+//
+// Router 网络推流（RTP/UDP）
+// 发送端：实时线程只把输出块拷进无锁环（环满时丢弃整块并计数）；网络线程
+// 把环中的采样切成固定时长的 RTP 包（L24 大端，1 ~ 10 ms），一次调用内
+// 凑齐的包批量发出。接收端：网络线程批量收包放进预分配的包队列；音频线程
+// 取出后按 RTP 时间戳写入抖动缓冲，缓冲达到目标延迟才开始播放，再按缓冲
+// 深度微调重采样比例，抵消两端时钟的漂移。
+// 采样率由负载类型表示（96 起的动态类型，见 router_rtp_payload_type），
+// 两端不需要额外协商；Linux 上使用 sendmmsg/recvmmsg，其他平台逐包收发
+//
+
+#ifndef AUDIOCTL_ROUTER_RTP_H
+#define AUDIOCTL_ROUTER_RTP_H
+
+#include "router/router_frame_ring.h"
+#include "router/router_pipeline.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// 配置
+// ============================================================================
+
+#define ROUTER_RTP_DEFAULT_PORT 5004	  // 默认 UDP 端口
+#define ROUTER_RTP_MIN_PTIME_MS 1	  // 包时长下限
+#define ROUTER_RTP_MAX_PTIME_MS 10	  // 包时长上限
+#define ROUTER_RTP_DEFAULT_PTIME_MS 2	  // 默认包时长
+#define ROUTER_RTP_MAX_LATENCY_MS 500	  // 接收端目标延迟上限
+#define ROUTER_RTP_DEFAULT_LATENCY_MS 20 // 接收端默认目标延迟
+#define ROUTER_RTP_MAX_DRIFT_PPM 1000	  // 漂移校正的最大幅度
+#define ROUTER_RTP_HEADER_SIZE 12	  // RTP 固定头（无 CSRC、无扩展）
+#define ROUTER_RTP_BASE_PAYLOAD_TYPE 96 // 第一个动态负载类型
+#define ROUTER_RTP_MAX_PACKET_FRAMES 960 // 单包帧数上限（10 ms @ 96 kHz）
+#define ROUTER_RTP_MAX_PAYLOAD                                                 \
+  (ROUTER_RTP_MAX_PACKET_FRAMES * ROUTER_MAX_CHANNELS * 3)
+#define ROUTER_RTP_BATCH 32		  // 单次批量收发的包数
+#define ROUTER_RTP_SEND_RING_FRAMES 8192  // 发送环容量（帧，2 的幂）
+#define ROUTER_RTP_QUEUE_PACKETS 256	  // 接收包队列容量（2 的幂）
+#define ROUTER_RTP_JITTER_FRAMES 131072	  // 抖动缓冲容量（帧，2 的幂）
+
+typedef struct RouterRtpPool RouterRtpPool; // 预分配的包和消息头（内部）
+
+// 发送端统计
+typedef struct
+{
+  uint64_t packets;	    // 已发送的包数
+  uint64_t bytes;	    // 已发送的字节数（含 RTP 头）
+  uint32_t send_errors;	    // 发送失败（含内核缓冲区满）丢弃的包数
+  uint32_t dropped_blocks;  // 网络线程跟不上时实时线程丢弃的块数
+} RouterRtpSenderStats;
+
+// 发送端（由调用者分配；init 一次，之后可以多次 open/close）
+typedef struct
+{
+  uint32_t channels;
+  _Atomic bool enabled; // 实时线程是否写入
+  // 实时线程推入、网络线程取出；存储预缺页并锁定。网络线程按丢弃的帧数
+  // 推进时间戳
+  RouterFrameRing ring;
+
+  // 网络线程
+  int fd;
+  uint32_t sample_rate;
+  uint32_t packet_frames; // 每包帧数
+  uint8_t payload_type;
+  bool marker;		  // 下一个包置 M 位（开始或中断之后）
+  uint16_t sequence;
+  uint32_t timestamp;	  // 下一个包的 RTP 时间戳
+  uint32_t ssrc;
+  uint32_t fill;	  // 当前包已填入的帧数
+  uint64_t dropped_seen;  // 已计入时间戳的丢弃帧数
+  RouterRtpPool *pool;
+  _Atomic uint64_t packets;
+  _Atomic uint64_t bytes;
+  _Atomic uint32_t send_errors;
+} RouterRtpSender;
+
+// 接收端统计
+typedef struct
+{
+  uint64_t packets;    // 收到的有效包数
+  uint32_t lost;       // 按序号推算丢失的包数
+  uint32_t late;       // 到达时已经播放过的包数
+  uint32_t invalid;    // 格式不符被丢弃的包数
+  uint32_t resets;     // 重新同步次数（新的发送端、长时间中断或缓冲溢出）
+  uint32_t underruns;  // 缓冲耗尽后重新缓冲的次数
+  uint32_t sample_rate; // 当前流的采样率（0 表示尚未收到）
+  bool playing;	       // 是否已开始播放
+  float fill_ms;       // 当前缓冲深度
+  float drift_ppm;     // 当前漂移校正（正值表示发送端时钟偏快）
+} RouterRtpReceiverStats;
+
+// 接收端（由调用者分配，init 时分配包队列和抖动缓冲）
+typedef struct
+{
+  uint32_t channels;
+  uint32_t output_rate; // 输出设备的采样率
+  uint32_t latency_ms;  // 目标延迟
+  int fd;
+  uint16_t port;	// 实际绑定的端口
+  RouterRtpPool *pool;
+
+  // 包队列：网络线程写，音频线程读
+  _Atomic uint32_t queue_write;
+  _Atomic uint32_t queue_read;
+
+  // 音频线程
+  float *jitter;	    // ROUTER_RTP_JITTER_FRAMES * channels 个采样
+  bool locked;		    // 是否已锁定发送端
+  bool playing;		    // 是否已开始播放
+  uint32_t ssrc;
+  uint8_t payload_type;
+  uint32_t stream_rate;
+  uint32_t target_frames;   // 目标缓冲深度（流的帧数）
+  uint16_t next_sequence;   // 期望的下一个序号
+  uint32_t ref_timestamp;   // 最近一个最新包的时间戳
+  int64_t ref_position;	    // 与 ref_timestamp 对应的缓冲位置
+  int64_t write_head;	    // 已写入的最远位置（不含）
+  int64_t start_position;   // 本次缓冲的起点
+  double read_position;	    // 播放位置（带小数）
+  double fill_average;	    // 平滑后的缓冲深度（帧）
+  double drift_integral;    // 漂移校正的积分项 (ppm)
+
+  // 统计（音频线程写，任意线程读）
+  _Atomic uint64_t stat_packets;
+  _Atomic uint32_t stat_lost;
+  _Atomic uint32_t stat_late;
+  _Atomic uint32_t stat_invalid;
+  _Atomic uint32_t stat_resets;
+  _Atomic uint32_t stat_underruns;
+  _Atomic uint32_t stat_rate;
+  _Atomic bool stat_playing;
+  _Atomic float stat_fill_ms;
+  _Atomic float stat_drift_ppm;
+} RouterRtpReceiver;
+
+// ============================================================================
+// 负载类型
+// ============================================================================
+
+/**
+ * 采样率对应的负载类型（L24，声道数固定为 ROUTER_MAX_CHANNELS）
+ *
+ * @param sample_rate 采样率
+ * @return 负载类型；不支持的采样率返回 -1
+ */
+int
+router_rtp_payload_type (uint32_t sample_rate);
+
+/**
+ * 负载类型对应的采样率
+ *
+ * @param payload_type 负载类型
+ * @return 采样率；未知类型返回 0
+ */
+uint32_t
+router_rtp_payload_rate (uint8_t payload_type);
+
+// ============================================================================
+// 发送端
+// ============================================================================
+
+/**
+ * 初始化发送端（不打开连接，非实时线程）
+ *
+ * @param sender 发送端指针
+ * @param channels 声道数 (1 ~ ROUTER_MAX_CHANNELS)
+ * @return 成功返回 0；参数无效或内存不足返回 -1
+ */
+int
+router_rtp_sender_init (RouterRtpSender *sender, uint32_t channels);
+
+/**
+ * 关闭连接并释放发送环和预分配的包
+ *
+ * @param sender 发送端指针
+ */
+void
+router_rtp_sender_destroy (RouterRtpSender *sender);
+
+/**
+ * 打开到 host:port 的 UDP 连接并开始接收实时线程的采样（非实时线程，
+ * 网络线程不在运行时调用）。每次打开都使用新的 SSRC 和随机起始序号
+ *
+ * @param sender 发送端指针
+ * @param host IPv4 地址或主机名
+ * @param port UDP 端口
+ * @param sample_rate 采样率（须有对应的负载类型）
+ * @param ptime_ms 包时长 (ROUTER_RTP_MIN_PTIME_MS ~ ROUTER_RTP_MAX_PTIME_MS)
+ * @return 成功返回 0；参数无效、无法解析主机或无法创建套接字返回 -1
+ */
+int
+router_rtp_sender_open (RouterRtpSender *sender, const char *host,
+			uint16_t port, uint32_t sample_rate, uint32_t ptime_ms);
+
+/**
+ * 停止接收采样并关闭连接（未打开时什么也不做）
+ *
+ * @param sender 发送端指针
+ */
+void
+router_rtp_sender_close (RouterRtpSender *sender);
+
+/**
+ * 写入一块交错采样（实时线程）：未打开时立即返回；环中放不下整块时
+ * 丢弃整块并计数
+ *
+ * @param sender 发送端指针
+ * @param buffer 交错采样
+ * @param frames 帧数
+ */
+void
+router_rtp_sender_push (RouterRtpSender *sender, const float *buffer,
+			uint32_t frames);
+
+/**
+ * 把环中的采样打包发送（网络线程）：凑满的包一次批量发出，不足一包的
+ * 采样留到下次
+ *
+ * @param sender 发送端指针
+ * @return 本次发出的包数
+ */
+uint32_t
+router_rtp_sender_pump (RouterRtpSender *sender);
+
+/**
+ * 读取发送端统计（任意线程）
+ *
+ * @param sender 发送端指针
+ * @param stats 输出统计
+ */
+void
+router_rtp_sender_get_stats (RouterRtpSender *sender,
+			     RouterRtpSenderStats *stats);
+
+// ============================================================================
+// 接收端
+// ============================================================================
+
+/**
+ * 创建接收端：在所有 IPv4 地址的 port 上监听（非实时线程）
+ *
+ * @param receiver 接收端指针
+ * @param port UDP 端口，0 表示由系统分配（见 receiver->port）
+ * @param output_rate 输出设备的采样率（与流不同时一并重采样）
+ * @param channels 输出声道数 (1 ~ ROUTER_MAX_CHANNELS)
+ * @param latency_ms 目标延迟 (1 ~ ROUTER_RTP_MAX_LATENCY_MS)
+ * @return 成功返回 0；参数无效、端口被占用或内存不足返回 -1
+ */
+int
+router_rtp_receiver_init (RouterRtpReceiver *receiver, uint16_t port,
+			  uint32_t output_rate, uint32_t channels,
+			  uint32_t latency_ms);
+
+/**
+ * 关闭套接字并释放内存
+ *
+ * @param receiver 接收端指针
+ */
+void
+router_rtp_receiver_destroy (RouterRtpReceiver *receiver);
+
+/**
+ * 等待并批量接收数据包放入包队列（网络线程）
+ *
+ * @param receiver 接收端指针
+ * @param timeout_ms 没有数据时最多等待的时间，0 表示不等待
+ * @return 本次放入队列的包数；套接字出错返回 -1
+ */
+int
+router_rtp_receiver_poll (RouterRtpReceiver *receiver, int timeout_ms);
+
+/**
+ * 输出一块交错采样（音频线程，不分配内存、不做系统调用）：先把队列中
+ * 的包写入抖动缓冲，缓冲不足时输出静音
+ *
+ * @param receiver 接收端指针
+ * @param dst 输出缓冲区
+ * @param frames 帧数
+ */
+void
+router_rtp_receiver_read (RouterRtpReceiver *receiver, float *dst,
+			  uint32_t frames);
+
+/**
+ * 读取接收端统计（任意线程）
+ *
+ * @param receiver 接收端指针
+ * @param stats 输出统计
+ */
+void
+router_rtp_receiver_get_stats (RouterRtpReceiver *receiver,
+			       RouterRtpReceiverStats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIOCTL_ROUTER_RTP_H
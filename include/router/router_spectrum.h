@@ -0,0 +1,187 @@
+//
+// Router 频谱分析
+// 分为两部分：实时线程一侧的分析抽头把输出混为单声道，经抗混叠低通后
+// 按整数倍抽取写入无锁环（不做变换）；非实时线程一侧的分析器从环中取出采样，
+// 保留最近一个窗长的历史，加 Hann 窗做实数 FFT，再把幅度谱按对数频率
+// 合并成若干频带（每个频带取最大值，满幅正弦为 0 dBFS）
+//
+
+#ifndef AUDIOCTL_ROUTER_SPECTRUM_H
+#define AUDIOCTL_ROUTER_SPECTRUM_H
+
+#include "router/router_eq.h"
+#include "router/router_fft.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// 配置
+// ============================================================================
+
+#define ROUTER_SPECTRUM_RING_SIZE 16384	  // 分析环容量（抽取后的采样数，2 的幂）
+#define ROUTER_SPECTRUM_MIN_SIZE 256	  // 变换长度下限
+#define ROUTER_SPECTRUM_MAX_SIZE 8192	  // 变换长度上限（不超过环容量的一半）
+#define ROUTER_SPECTRUM_MAX_BANDS 128	  // 频带数上限
+#define ROUTER_SPECTRUM_MAX_DECIMATION 8  // 抽取倍数上限
+#define ROUTER_SPECTRUM_MIN_FREQ 20.0f	  // 最低频带的下沿 (Hz)
+#define ROUTER_SPECTRUM_FLOOR_DB -120.0f  // 频带读数下限 (dBFS)
+#define ROUTER_SPECTRUM_AA_SECTIONS 4	  // 抗混叠低通的二阶节数（8 阶）
+
+// 分析抽头（由调用者分配，不在内部分配内存）
+// 实时线程是唯一的生产者，分析线程是唯一的消费者
+typedef struct
+{
+  // 控制线程写、实时线程每块读取：0 表示关闭（不拷贝）
+  _Atomic uint32_t decimation;
+
+  // 共享：单调递增的读写计数（回绕无影响）
+  _Atomic uint32_t write_pos;
+  _Atomic uint32_t read_pos;
+  _Atomic uint32_t dropped; // 环满时丢弃的块数，由 collect 取出清零
+
+  // 初始化时计算：各抽取倍数的抗混叠低通（Butterworth，截止频率为抽取后
+  // 采样率的 0.4 倍），倍数为 1 时不滤波
+  RouterEqBiquad aa[ROUTER_SPECTRUM_MAX_DECIMATION + 1]
+		   [ROUTER_SPECTRUM_AA_SECTIONS];
+
+  // 实时线程
+  uint32_t active; // 当前使用的抽取倍数（变化时清空滤波器状态）
+  uint32_t phase;  // 距上一个输出采样的帧数
+  float z1[ROUTER_SPECTRUM_AA_SECTIONS]; // 滤波器状态（转置直接 II 型）
+  float z2[ROUTER_SPECTRUM_AA_SECTIONS];
+  float ring[ROUTER_SPECTRUM_RING_SIZE];
+} RouterSpectrumTap;
+
+// 分析器（init 时分配，只在一个非实时线程中使用）
+typedef struct
+{
+  uint32_t size;	// 变换长度
+  uint32_t band_count;	// 频带数
+  uint32_t sample_rate; // 抽取后的采样率
+  float max_freq;	// 最高频带的上沿（抽取后的奈奎斯特频率）
+  float scale;		// 幅度归一化（2 / 窗函数之和）
+  uint32_t history_pos; // 历史写位置
+  RouterFft fft;
+  float *window;	// Hann 窗，size 个
+  float *history;	// 最近 size 个采样（环形）
+  float *frame;		// 加窗后的变换输入，size 个
+  float *re;		// 频谱，size / 2 + 1 个
+  float *im;
+  uint32_t band_lo[ROUTER_SPECTRUM_MAX_BANDS]; // 各频带的首个频点
+  uint32_t band_hi[ROUTER_SPECTRUM_MAX_BANDS]; // 各频带的末个频点之后
+} RouterSpectrumAnalyzer;
+
+// ============================================================================
+// 分析抽头
+// ============================================================================
+
+/**
+ * 初始化抽头（关闭）并计算抗混叠滤波器系数（非实时线程）
+ *
+ * @param tap 抽头指针
+ */
+void
+router_spectrum_tap_init (RouterSpectrumTap *tap);
+
+/**
+ * 设置抽取倍数（控制线程，可在实时线程处理期间调用）
+ *
+ * @param tap 抽头指针
+ * @param decimation 抽取倍数 (1 ~ ROUTER_SPECTRUM_MAX_DECIMATION)，0 表示关闭
+ * @return 成功返回 0；倍数超出范围返回 -1
+ */
+int
+router_spectrum_tap_set_decimation (RouterSpectrumTap *tap,
+				    uint32_t decimation);
+
+/**
+ * 写入一块交错采样（实时线程）：混为单声道，经抗混叠低通后每 decimation
+ * 帧取一个写入环（抽取后的频谱在 0.8 倍奈奎斯特频率以上开始滚降）。
+ * 关闭时立即返回；环中放不下整块时丢弃整块并计数
+ *
+ * @param tap 抽头指针
+ * @param buffer 交错采样
+ * @param frames 帧数
+ * @param channels 声道数
+ */
+void
+router_spectrum_tap_push (RouterSpectrumTap *tap, const float *buffer,
+			  uint32_t frames, uint32_t channels);
+
+/**
+ * 取出环中的采样（分析线程）
+ *
+ * @param tap 抽头指针
+ * @param samples 输出缓冲区
+ * @param max_samples 最多取出的采样数
+ * @return 取出的采样数
+ */
+uint32_t
+router_spectrum_tap_read (RouterSpectrumTap *tap, float *samples,
+			  uint32_t max_samples);
+
+/**
+ * 取出上次调用以来丢弃的块数并清零（任意线程）
+ *
+ * @param tap 抽头指针
+ * @return 丢弃的块数
+ */
+uint32_t
+router_spectrum_tap_collect_dropped (RouterSpectrumTap *tap);
+
+// ============================================================================
+// 分析器
+// ============================================================================
+
+/**
+ * 创建分析器（非实时线程，内部分配内存）
+ *
+ * @param analyzer 分析器指针
+ * @param size 变换长度（2 的幂，ROUTER_SPECTRUM_MIN_SIZE ~ ROUTER_SPECTRUM_MAX_SIZE）
+ * @param band_count 频带数 (1 ~ ROUTER_SPECTRUM_MAX_BANDS)
+ * @param sample_rate 抽取后的采样率（奈奎斯特频率须高于最低频带下沿）
+ * @return 成功返回 0；参数无效或内存不足返回 -1
+ */
+int
+router_spectrum_analyzer_init (RouterSpectrumAnalyzer *analyzer, uint32_t size,
+			       uint32_t band_count, uint32_t sample_rate);
+
+/**
+ * 释放分析器持有的内存（可重复调用）
+ *
+ * @param analyzer 分析器指针
+ */
+void
+router_spectrum_analyzer_destroy (RouterSpectrumAnalyzer *analyzer);
+
+/**
+ * 追加采样到历史（只保留最近 size 个）
+ *
+ * @param analyzer 分析器指针
+ * @param samples 单声道采样
+ * @param count 采样数
+ */
+void
+router_spectrum_analyzer_push (RouterSpectrumAnalyzer *analyzer,
+			       const float *samples, uint32_t count);
+
+/**
+ * 对当前历史做一次变换，输出各频带电平
+ *
+ * @param analyzer 分析器指针
+ * @param bands_db 输出，band_count 个 (dBFS，不低于 ROUTER_SPECTRUM_FLOOR_DB)
+ */
+void
+router_spectrum_analyzer_compute (RouterSpectrumAnalyzer *analyzer,
+				  float *bands_db);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIOCTL_ROUTER_SPECTRUM_H
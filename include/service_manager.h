@@ -58,4 +58,67 @@ print_version (void);
 void
 print_service_status (void);
 
+// 打印 IPC 服务端统计（指令计数、错误、处理耗时分布、连接数）
+int
+print_ipc_stats (void);
+
+// 打印 Router 最近的性能快照（由 Router 上报给 IPC 服务）
+// limit 为 0 时显示全部
+int
+print_router_stats (uint32_t limit);
+
+// 打印主输出和各应用的响度读数（由 Router 和驱动上报给 IPC 服务）
+int
+print_loudness (void);
+
+// 均衡器命令（audioctl eq ...）：通过 IPC 服务读取或修改配置，
+// 服务把新配置推送给 Router，Router 平滑过渡到新系数
+int
+equalizer_command (int argc, char *argv[]);
+
+// 响度均衡命令（audioctl normalize ...）：通过 IPC 服务读取或修改配置，
+// 服务把新配置推送给驱动，各应用的自动增益按速率限制过渡
+int
+normalizer_command (int argc, char *argv[]);
+
+// 闪避命令（audioctl duck ...）：通过 IPC 服务读取或修改规则，
+// 服务把新规则推送给驱动，媒体应用按起音/释放时间过渡
+int
+ducking_command (int argc, char *argv[]);
+
+// 声道混合命令（audioctl mix ...）：通过 IPC 服务批量更新各应用的规则，
+// 服务把新规则表推送给驱动，驱动在一个 IO 块内过渡到新矩阵
+int
+channel_mix_command (int argc, char *argv[]);
+
+// 卷积命令（audioctl convolve ...）：通过 IPC 服务读取或修改配置，
+// 服务把新配置推送给 Router，Router 在非实时线程读取 IR 后替换
+int
+convolver_command (int argc, char *argv[]);
+
+// 交叉馈送命令（audioctl crossfeed ...）：通过 IPC 服务读取或修改配置，
+// 自动模式下由 Router 按输出设备的传输类型决定是否开启
+int
+crossfeed_command (int argc, char *argv[]);
+
+// 频谱分析命令（audioctl spectrum ...）：读取或修改分析配置；watch 订阅
+// Router 上报的频谱帧并在终端逐帧刷新
+int
+spectrum_command (int argc, char *argv[]);
+
+// 录音命令（audioctl record ...）：通过 IPC 服务请求 Router 开始、停止录音
+// 或换文件，等待 Router 处理完后显示状态
+int
+record_command (int argc, char *argv[]);
+
+// 网络推流命令（audioctl stream ...）：通过 IPC 服务设置 Router 推流的
+// 目标和包时长，Router 收到后重新打开连接
+int
+stream_command (int argc, char *argv[]);
+
+// 推流接收命令（audioctl receive ...）：在本机默认输出设备上播放收到的
+// RTP 流，不需要 IPC 服务
+int
+receive_command (int argc, char *argv[]);
+
 #endif // AUDIOCTL_SERVICE_MANAGER_H
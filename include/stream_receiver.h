@@ -0,0 +1,22 @@
+//
+// 网络推流接收端：把 Router 推送的 RTP 流在本机默认输出设备上播放
+// 网络线程批量收包，输出设备的 IOProc 从抖动缓冲读取并按时钟漂移重采样
+//
+
+#ifndef AUDIOCTL_STREAM_RECEIVER_H
+#define AUDIOCTL_STREAM_RECEIVER_H
+
+#include <stdint.h>
+
+/**
+ * 在 port 上接收并播放，每秒打印一次统计，直到 Ctrl+C 或 seconds 秒后
+ *
+ * @param port UDP 端口
+ * @param latency_ms 目标延迟（毫秒）
+ * @param seconds 运行时长，0 表示直到 Ctrl+C
+ * @return 成功返回 0；端口被占用或无法打开输出设备返回 -1
+ */
+int
+stream_receiver_run (uint16_t port, uint32_t latency_ms, uint32_t seconds);
+
+#endif // AUDIOCTL_STREAM_RECEIVER_H
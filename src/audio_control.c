@@ -753,6 +753,24 @@ getTransportTypeName (const UInt32 transportType)
     }
 }
 
+// 耳机端口的数据源 'hdpn'（即 IOKit 的 kIOAudioOutputPortSubTypeHeadphones）
+#define kHeadphoneDataSource 0x6864706EU
+
+// 判断输出设备是否为耳机：只认输出数据源报告的耳机端口（内建耳机孔，
+// 以及同样报告数据源的 USB 声卡）。传输类型本身不是证据，蓝牙和 USB
+// 设备也可能是音箱，无法确认时按非耳机处理
+Boolean
+isHeadphoneDevice (AudioDeviceID deviceId)
+{
+  UInt32 dataSource = 0;
+  UInt32 dataSize = sizeof (UInt32);
+  return getAudioProperty (deviceId, kAudioDevicePropertyDataSource,
+			   kAudioDevicePropertyScopeOutput, 0, &dataSource,
+			   &dataSize)
+	   == noErr
+	 && dataSource == kHeadphoneDataSource;
+}
+
 const char *
 getFormatFlagsDescription (const UInt32 formatFlags)
 {
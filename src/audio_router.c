@@ -6,12 +6,27 @@
 //
 
 #include "audio_router.h"
+#include "audio_control.h"
+#include "ipc/ipc_async_client.h"
+#include "router/router_convolver.h"
+#include "router/router_crossfeed.h"
+#include "router/router_eq.h"
+#include "router/router_limiter.h"
+#include "router/router_loudness.h"
+#include "router/router_memory.h"
+#include "router/router_record.h"
+#include "router/router_rtp.h"
+#include "router/router_spectrum.h"
 #include <CoreAudio/CoreAudio.h>
+#include <limits.h>
+#include <mach/mach_time.h>
+#include <math.h>
 #include <os/log.h>
 #include <pthread.h>
 #include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/time.h>
 #include <sys/syslog.h>
 #include <time.h>
@@ -39,8 +54,142 @@ static bool g_console_log_mode = false;
   } while (0)
 
 static AudioRouterContext g_router = {0};
+
+// 监控线程：在条件变量上定时等待，停止时立即唤醒
 static pthread_t g_monitor_thread = 0;
-static volatile int g_monitor_running = 0;
+static pthread_mutex_t g_monitor_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_monitor_cond = PTHREAD_COND_INITIALIZER;
+static bool g_monitor_running = false; // 受 g_monitor_mutex 保护
+static _Atomic uint32_t g_monitor_interval_ms
+  = ROUTER_MONITOR_DEFAULT_INTERVAL_MS;
+
+// 监控快照环
+static RouterStatsRing g_stats_ring;
+
+// 回调负载超时阈值（千分比）
+static _Atomic uint32_t g_load_threshold_permille
+  = ROUTER_LOAD_DEFAULT_THRESHOLD_PERCENT * 10;
+
+// 空闲超时（毫秒，0 表示不进入空闲模式）
+static _Atomic uint32_t g_idle_timeout_ms = ROUTER_IDLE_DEFAULT_TIMEOUT_MS;
+
+// 输出通路的 DSP 链（跨启动保留，首次使用时初始化）
+static RouterDspHost g_dsp_host;
+static pthread_once_t g_dsp_host_once = PTHREAD_ONCE_INIT;
+
+// 参数均衡器：默认链的第一级，参数由 IPC 服务下发
+static RouterEq g_eq;
+
+// 分块卷积器：位于均衡器与限制器之间，IR 由 IPC 服务下发的配置指定
+static RouterConvolver g_convolver;
+
+// 耳机交叉馈送：位于卷积器与限制器之间。IPC 配置为自动时按输出设备的
+// 数据源开关（IPC IO 线程写配置，监控线程写设备判断结果）
+static RouterCrossfeed g_crossfeed;
+static _Atomic uint32_t g_crossfeed_mode = kIPCCrossfeedOff;
+static _Atomic uint32_t g_crossfeed_preset = kIPCCrossfeedMedium;
+static atomic_bool g_output_is_headphones = false;
+
+// 预读限制器：默认链的最后一级，保证输出真峰值不超过上限
+static RouterLimiter g_limiter;
+
+// 主输出响度计：测量 DSP 链之后送往物理设备的信号
+static RouterLoudness g_loudness;
+
+_Static_assert (ROUTER_LOUDNESS_MIN_LUFS == IPC_LOUDNESS_MIN_LUFS,
+		"router and IPC loudness floors must match");
+_Static_assert (ROUTER_EQ_MAX_BANDS == IPC_EQ_MAX_BANDS,
+		"router and IPC equalizer band limits must match");
+_Static_assert ((int) kRouterEqPeaking == kIPCEqualizerPeaking
+		  && (int) kRouterEqLowShelf == kIPCEqualizerLowShelf
+		  && (int) kRouterEqHighShelf == kIPCEqualizerHighShelf
+		  && (int) kRouterEqHighPass == kIPCEqualizerHighPass
+		  && (int) kRouterEqLowPass == kIPCEqualizerLowPass,
+		"router and IPC equalizer types must match");
+_Static_assert ((int) kRouterCrossfeedLight == kIPCCrossfeedLight
+		  && (int) kRouterCrossfeedMedium == kIPCCrossfeedMedium
+		  && (int) kRouterCrossfeedStrong == kIPCCrossfeedStrong,
+		"router and IPC crossfeed presets must match");
+
+// 频谱分析：输出回调只把抽取后的单声道采样写入抽头，变换和上报都在
+// 频谱线程完成。配置由频谱线程的 IPC IO 线程整体写入（8 字节，一次原子
+// 存取），订阅者数由上报的响应更新；没有订阅者时抽头保持关闭
+static RouterSpectrumTap g_spectrum_tap;
+static _Atomic uint64_t g_spectrum_config;
+static _Atomic uint32_t g_spectrum_listeners = 0;
+static pthread_t g_spectrum_thread = 0;
+static pthread_mutex_t g_spectrum_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_spectrum_cond = PTHREAD_COND_INITIALIZER;
+static bool g_spectrum_running = false; // 受 g_spectrum_mutex 保护
+
+_Static_assert (sizeof (IPCSpectrumConfig) == sizeof (uint64_t),
+		"spectrum config must fit in one atomic word");
+_Static_assert (ROUTER_SPECTRUM_MIN_SIZE == IPC_SPECTRUM_MIN_SIZE
+		  && ROUTER_SPECTRUM_MAX_SIZE == IPC_SPECTRUM_MAX_SIZE
+		  && ROUTER_SPECTRUM_MAX_BANDS == IPC_SPECTRUM_MAX_BANDS
+		  && ROUTER_SPECTRUM_MAX_DECIMATION
+		       == IPC_SPECTRUM_MAX_DECIMATION,
+		"router and IPC spectrum limits must match");
+
+// 录音：输出回调把送往设备的采样拷进录音器的环，写盘在录音器自己的
+// 线程完成。录音器在首次启动时创建并一直复用；请求由监控线程的 IPC IO
+// 线程按序号应用，处理完立即上报状态
+static RouterRecorder g_recorder;
+static bool g_recorder_ready = false;
+static _Atomic uint32_t g_record_generation = 0; // 已应用的请求序号
+static uint32_t g_record_dropped_logged = 0;	 // 仅监控线程访问
+
+_Static_assert ((int) kRouterRecordWav == kIPCRecordWav
+		  && (int) kRouterRecordCaf == kIPCRecordCaf,
+		"router and IPC record formats must match");
+
+// 网络推流：输出回调把送往设备的采样拷进发送端的环，打包和批量发送在
+// 推流线程完成。发送端在首次启动时创建并一直复用；配置由监控线程的
+// IPC IO 线程应用（先停推流线程再重新打开连接），关闭时推流线程不运行
+static RouterRtpSender g_rtp_sender;
+static bool g_rtp_sender_ready = false;
+static IPCStreamConfig g_stream_applied; // 已应用的配置（仅 IO 线程访问）
+static uint32_t g_stream_pump_ms = 1;	 // 推流线程的唤醒周期
+static pthread_t g_stream_thread = 0;
+static pthread_mutex_t g_stream_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_stream_cond = PTHREAD_COND_INITIALIZER;
+static bool g_stream_running = false;	    // 受 g_stream_mutex 保护
+static RouterRtpSenderStats g_stream_logged; // 仅监控线程访问
+
+_Static_assert (ROUTER_RTP_DEFAULT_PORT == IPC_STREAM_DEFAULT_PORT
+		  && ROUTER_RTP_MIN_PTIME_MS == IPC_STREAM_MIN_PTIME_MS
+		  && ROUTER_RTP_MAX_PTIME_MS == IPC_STREAM_MAX_PTIME_MS,
+		"router and IPC stream limits must match");
+
+// 整数输出：启动时按输出流的物理格式协商；输出回调先在渲染区得到 float，
+// 最后一次转换（加抖动）写入设备缓冲区。修改过虚拟格式时停止后恢复
+static atomic_bool g_integer_output = false;
+static RouterDitherMode g_dither_mode = kRouterDitherTpdf;
+static RouterDither g_output_dither; // 仅输出回调访问（启动前初始化）
+static AudioStreamID g_output_stream = kAudioObjectUnknown;
+static AudioStreamBasicDescription g_saved_output_format;
+static bool g_output_format_changed = false;
+static const char *const kDitherModeNames[kRouterDitherModeCount]
+  = {"off", "tpdf", "shaped"};
+
+// 主机时间 (mach_absolute_time) 到纳秒的换算
+static mach_timebase_info_data_t g_timebase = {1, 1};
+
+// 预分配内存区：环形缓冲区、暂存区和追踪事件环都从这里划分，
+// 首次启动时一次性映射、预缺页并锁定，之后的启动和切换设备都复用
+static RouterArena g_arena = {0};
+
+// 实时事件追踪：每个 IOProc 一个事件环（位于预分配区），导出线程周期性写盘
+static RouterTraceRing *g_trace_input_ring = NULL;
+static RouterTraceRing *g_trace_output_ring = NULL;
+static atomic_bool g_trace_enabled = false;
+static char g_trace_path[PATH_MAX] = {0};
+static FILE *g_trace_file = NULL;
+static uint64_t g_trace_base_time = 0; // 追踪起点（主机时间）
+static pthread_t g_trace_thread = 0;
+static pthread_mutex_t g_trace_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_trace_cond = PTHREAD_COND_INITIALIZER;
+static bool g_trace_running = false; // 受 g_trace_mutex 保护
 
 // 设置控制台日志模式
 void
@@ -49,11 +198,6 @@ audio_router_set_console_log_mode (bool enable)
   g_console_log_mode = enable;
 }
 
-// Watermark 监控间隔 (秒)
-#define MONITOR_INTERVAL_SEC 5
-// 总采样数 (帧数 * 通道数)
-#define TOTAL_SAMPLES (ROUTER_BUFFER_FRAME_COUNT * ROUTER_MAX_CHANNELS)
-
 // ====== 性能监控辅助函数 ======
 
 // 获取当前时间戳 (微秒)
@@ -74,156 +218,382 @@ calculate_latency_ms (uint32_t buffered_frames, uint32_t sample_rate)
   return (buffered_frames * 1000) / sample_rate;
 }
 
-// ====== 环形缓冲区实现 (Lock-Free + Bitmask优化) ======
+// ====== DSP 链 ======
 
 static void
-rb_init (RouterRingBuffer *rb)
+dsp_host_init_once (void)
 {
-  // 使用固定大小，必须是2的幂次方以便位掩码
-  rb->capacity = TOTAL_SAMPLES;
-  rb->buffer = (float *) aligned_alloc (64, rb->capacity * sizeof (float));
-  if (!rb->buffer)
-    {
-      fprintf (stderr, "[AudioRouter] Error: Failed to allocate ring buffer\n");
-      rb->capacity = 0;
-      return;
-    }
-  // 清零缓冲区
-  memset (rb->buffer, 0, rb->capacity * sizeof (float));
-  atomic_init (&rb->write_pos, 0);
-  atomic_init (&rb->read_pos, 0);
-  atomic_init (&rb->peak_usage, 0);
-  atomic_init (&rb->current_usage, 0);
-  atomic_init (&rb->samples_buffered, 0);
+  router_dsp_host_init (&g_dsp_host);
+  router_eq_init (&g_eq);
+  router_convolver_init (&g_convolver);
+  router_crossfeed_init (&g_crossfeed);
+  router_limiter_init (&g_limiter);
+  router_loudness_init (&g_loudness);
+  RouterDspProcessor *chain[]
+    = {&g_eq.processor, &g_convolver.processor, &g_crossfeed.processor,
+       &g_limiter.processor};
+  router_dsp_host_set_chain (&g_dsp_host, chain, 4);
 }
 
-static void
-rb_destroy (RouterRingBuffer *rb)
+static RouterDspHost *
+dsp_host (void)
 {
-  if (rb->buffer)
-    {
-      free (rb->buffer);
-      rb->buffer = NULL;
-      rb->capacity = 0;
-    }
+  pthread_once (&g_dsp_host_once, dsp_host_init_once);
+  return &g_dsp_host;
 }
 
-// 更新性能统计
-static inline void
-rb_update_stats (RouterRingBuffer *rb, uint32_t buffered_samples)
-{
-  // 计算当前使用率 (0-100%)
-  uint32_t usage_percent = (buffered_samples * 100) / rb->capacity;
-  atomic_store_explicit (&rb->current_usage, usage_percent,
-			 memory_order_relaxed);
-  atomic_store_explicit (&rb->samples_buffered, buffered_samples,
-			 memory_order_relaxed);
-  // 更新峰值
-  uint32_t peak = atomic_load_explicit (&rb->peak_usage, memory_order_relaxed);
-  if (usage_percent > peak)
-    {
-      atomic_store_explicit (&rb->peak_usage, usage_percent,
-			     memory_order_relaxed);
-    }
+// 按 IPC 配置和输出设备类型决定交叉馈送的开关（IO 线程和监控线程）
+static void
+crossfeed_refresh (void)
+{
+  uint32_t mode = atomic_load (&g_crossfeed_mode);
+  RouterCrossfeedPreset preset
+    = (RouterCrossfeedPreset) atomic_load (&g_crossfeed_preset);
+  bool enabled = mode == kIPCCrossfeedOn
+		 || (mode == kIPCCrossfeedAuto
+		     && atomic_load (&g_output_is_headphones));
+
+  dsp_host ();
+  RouterCrossfeedPreset previous = preset;
+  bool was_enabled = router_crossfeed_get (&g_crossfeed, &previous);
+  if (enabled == was_enabled && (!enabled || previous == preset))
+    return;
+  router_crossfeed_set (&g_crossfeed, enabled, preset);
+  if (enabled)
+    ROUTER_LOG_INFO ("[Router 交叉馈送] 已开启 | 强度:%s%s",
+		     preset == kRouterCrossfeedLight	? "轻"
+		     : preset == kRouterCrossfeedMedium ? "中"
+							: "强",
+		     mode == kIPCCrossfeedAuto ? " | 输出设备为耳机" : "");
+  else
+    ROUTER_LOG_INFO ("[Router 交叉馈送] 已关闭");
 }
 
-// Write data (called by input callback - Producer)
-// 使用位掩码替代取模运算，速度提升10-20倍
+// 重新判断输出设备是否为耳机（内建设备插拔耳机会改变输出端口）
 static void
-rb_write (RouterRingBuffer *rb, const float *data, uint32_t frame_count,
-	  uint32_t channels)
+crossfeed_poll_device (void)
 {
-  // Check if buffer is valid and initialized
-  if (rb == NULL || rb->buffer == NULL || data == NULL)
+  bool headphones = g_router.output_device != kAudioObjectUnknown
+		    && isHeadphoneDevice (g_router.output_device);
+  if (atomic_exchange (&g_output_is_headphones, headphones) != headphones)
+    crossfeed_refresh ();
+}
+
+// ====== 预分配内存区 ======
+
+#define ARENA_ALIGN 64
+
+static size_t
+arena_align (size_t size)
+{
+  return (size + ARENA_ALIGN - 1) & ~(size_t) (ARENA_ALIGN - 1);
+}
+
+// 从预分配区划分一块内存（仅在 IOProc 启动前调用），空间不足返回 NULL
+static void *
+arena_alloc (RouterArena *arena, size_t size)
+{
+  size_t offset = arena_align (arena->used);
+  if (arena->base == NULL || offset + size > arena->size)
+    return NULL;
+  arena->used = offset + size;
+  return arena->base + offset;
+}
+
+// 映射预分配区（预缺页并锁定）并划分各缓冲区；已映射时直接返回
+// 锁定失败只告警
+static int
+arena_reserve (RouterArena *arena)
+{
+  if (arena->base != NULL)
+    return 0;
+
+  size_t size = arena_align (ROUTER_BUFFER_SAMPLES * sizeof (float))
+		+ 2 * arena_align (ROUTER_SCRATCH_FRAMES * ROUTER_MAX_CHANNELS
+				   * sizeof (float))
+		+ 2 * arena_align (sizeof (RouterTraceRing));
+  uint8_t *base = router_locked_alloc (size);
+  if (base == NULL)
     {
-      return;
+      fprintf (stderr, "[AudioRouter] Error: 无法映射 %zu 字节预分配区\n",
+	       size);
+      return -1;
     }
 
-  uint32_t sample_count = frame_count * channels;
-  uint32_t current_write
-    = atomic_load_explicit (&rb->write_pos, memory_order_relaxed);
-  uint32_t current_read
-    = atomic_load_explicit (&rb->read_pos, memory_order_acquire);
+  arena->locked = router_locked_is_locked (base);
+  if (!arena->locked)
+    fprintf (stderr,
+	     "[AudioRouter] Warning: mlock 失败，预分配区可能被换出\n");
+
+  arena->base = base;
+  arena->size = size;
+  arena->used = 0;
+
+  g_router.ring_storage = arena_alloc (arena, ROUTER_BUFFER_SAMPLES * sizeof (float));
+  g_router.scratch = arena_alloc (arena, ROUTER_SCRATCH_FRAMES
+					   * ROUTER_MAX_CHANNELS
+					   * sizeof (float));
+  g_router.convert = arena_alloc (arena, ROUTER_SCRATCH_FRAMES
+					   * ROUTER_MAX_CHANNELS
+					   * sizeof (float));
+  g_trace_input_ring = arena_alloc (arena, sizeof (RouterTraceRing));
+  g_trace_output_ring = arena_alloc (arena, sizeof (RouterTraceRing));
+  return 0;
+}
 
-  // 计算已用空间和空闲空间
-  uint32_t size;
-  if (current_write >= current_read)
-    size = current_write - current_read;
-  else
-    size = rb->capacity - current_read + current_write;
+// ====== 端到端延迟测量 ======
 
-  // capacity - 1 是为了区分满和空
-  uint32_t free_space = rb->capacity - 1 - size;
+// 主机时间差换算为纳秒
+static inline uint64_t
+host_delta_to_ns (uint64_t delta)
+{
+  return delta * g_timebase.numer / g_timebase.denom;
+}
 
-  if (free_space < sample_count)
+// 记录输入块的时间戳（输入回调）
+static inline void
+latency_tag_input (RouterLatencyTracker *tracker,
+		   const AudioTimeStamp *input_time, uint32_t frames)
+{
+  if (input_time != NULL
+      && (input_time->mFlags & kAudioTimeStampHostTimeValid) != 0)
     {
-      atomic_fetch_add_explicit (&g_router.overrun_count, 1,
+      uint64_t index
+	= atomic_load_explicit (&tracker->tag_count, memory_order_relaxed);
+      RouterTimestampTag *tag
+	= &tracker->tags[index & (ROUTER_TIMESTAMP_TAGS - 1)];
+      atomic_store_explicit (&tag->frame_start, UINT64_MAX,
+			     memory_order_relaxed);
+      atomic_store_explicit (&tag->host_time, input_time->mHostTime,
+			     memory_order_relaxed);
+      atomic_store_explicit (&tag->frame_start, tracker->frames_written,
+			     memory_order_release);
+      atomic_store_explicit (&tracker->tag_count, index + 1,
+			     memory_order_release);
+    }
+  tracker->frames_written += frames;
+}
+
+// 查找输出帧对应的输入时间戳并记录端到端延迟（输出回调）
+// 延迟 = 播放时间 - (块输入时间 + 块内偏移) + 设备延迟和安全偏移
+static inline void
+latency_measure_output (RouterLatencyTracker *tracker,
+			const AudioTimeStamp *output_time, uint32_t frames,
+			uint32_t sample_rate)
+{
+  uint64_t frame = tracker->frames_read;
+  tracker->frames_read += frames;
+
+  if (output_time == NULL
+      || (output_time->mFlags & kAudioTimeStampHostTimeValid) == 0
+      || sample_rate == 0)
+    return;
+
+  uint64_t count
+    = atomic_load_explicit (&tracker->tag_count, memory_order_acquire);
+  uint64_t oldest = count > ROUTER_TIMESTAMP_TAGS ? count - ROUTER_TIMESTAMP_TAGS
+						  : 0;
+  for (uint64_t index = count; index > oldest; index--)
+    {
+      const RouterTimestampTag *tag
+	= &tracker->tags[(index - 1) & (ROUTER_TIMESTAMP_TAGS - 1)];
+      uint64_t frame_start
+	= atomic_load_explicit (&tag->frame_start, memory_order_acquire);
+      if (frame_start == UINT64_MAX || frame_start > frame)
+	continue;
+
+      uint64_t input_host
+	= atomic_load_explicit (&tag->host_time, memory_order_relaxed);
+      if (atomic_load_explicit (&tag->frame_start, memory_order_relaxed)
+	    != frame_start
+	  || output_time->mHostTime < input_host)
+	return;
+
+      uint64_t offset_ns = (frame - frame_start) * 1000000000ULL / sample_rate;
+      uint64_t delta_ns = host_delta_to_ns (output_time->mHostTime - input_host);
+      if (delta_ns < offset_ns)
+	return;
+
+      uint64_t latency_us
+	= (delta_ns - offset_ns + tracker->device_latency_ns) / 1000;
+      uint32_t value = latency_us > UINT32_MAX ? UINT32_MAX
+					       : (uint32_t) latency_us;
+
+      uint32_t bucket = value / ROUTER_LATENCY_BUCKET_US;
+      if (bucket >= ROUTER_LATENCY_BUCKETS)
+	bucket = ROUTER_LATENCY_BUCKETS - 1;
+      atomic_fetch_add_explicit (&tracker->histogram[bucket], 1,
+				 memory_order_relaxed);
+      atomic_fetch_add_explicit (&tracker->sum_us, value,
 				 memory_order_relaxed);
-      // 策略：丢弃新数据以保持同步
+      atomic_fetch_add_explicit (&tracker->count, 1, memory_order_relaxed);
+
+      // 单写者：监控线程清零时偶尔丢失一次极值更新可以接受
+      if (value
+	  < atomic_load_explicit (&tracker->min_us, memory_order_relaxed))
+	atomic_store_explicit (&tracker->min_us, value, memory_order_relaxed);
+      if (value
+	  > atomic_load_explicit (&tracker->max_us, memory_order_relaxed))
+	atomic_store_explicit (&tracker->max_us, value, memory_order_relaxed);
       return;
     }
+}
 
-  // 使用位掩码替代取模运算 - 关键优化！
-  for (uint32_t i = 0; i < sample_count; i++)
+// 重置端到端延迟统计（启动前调用）
+static void
+latency_reset (RouterLatencyTracker *tracker, uint64_t device_latency_ns)
+{
+  for (uint32_t i = 0; i < ROUTER_TIMESTAMP_TAGS; i++)
     {
-      rb->buffer[current_write & ROUTER_BUFFER_MASK] = data[i];
-      current_write++;
+      atomic_store (&tracker->tags[i].frame_start, UINT64_MAX);
+      atomic_store (&tracker->tags[i].host_time, 0);
     }
-
-  atomic_store_explicit (&rb->write_pos, current_write, memory_order_release);
-
-  // 更新性能统计
-  rb_update_stats (rb, size + sample_count);
+  atomic_store (&tracker->tag_count, 0);
+  tracker->frames_written = 0;
+  tracker->frames_read = 0;
+  tracker->device_latency_ns = device_latency_ns;
+  for (uint32_t i = 0; i < ROUTER_LATENCY_BUCKETS; i++)
+    atomic_store (&tracker->histogram[i], 0);
+  atomic_store (&tracker->sum_us, 0);
+  atomic_store (&tracker->count, 0);
+  atomic_store (&tracker->min_us, UINT32_MAX);
+  atomic_store (&tracker->max_us, 0);
 }
 
-// Read data (called by output callback - Consumer)
-// 使用位掩码替代取模运算
+// 取出一个周期的端到端延迟统计并清零（监控线程）
 static void
-rb_read (RouterRingBuffer *rb, float *data, uint32_t frame_count,
-	 uint32_t channels)
+latency_collect (RouterLatencyTracker *tracker,
+		 IPCRouterStatsSnapshot *snapshot)
 {
-  // Check if buffer is valid and initialized
-  if (rb == NULL || rb->buffer == NULL || data == NULL)
+  uint32_t counts[ROUTER_LATENCY_BUCKETS];
+  uint64_t total = 0;
+  for (uint32_t i = 0; i < ROUTER_LATENCY_BUCKETS; i++)
     {
-      return;
+      counts[i] = atomic_exchange_explicit (&tracker->histogram[i], 0,
+					    memory_order_relaxed);
+      total += counts[i];
+    }
+  uint64_t sum
+    = atomic_exchange_explicit (&tracker->sum_us, 0, memory_order_relaxed);
+  uint32_t count
+    = atomic_exchange_explicit (&tracker->count, 0, memory_order_relaxed);
+  uint32_t min_us = atomic_exchange_explicit (&tracker->min_us, UINT32_MAX,
+					      memory_order_relaxed);
+  uint32_t max_us
+    = atomic_exchange_explicit (&tracker->max_us, 0, memory_order_relaxed);
+
+  snapshot->device_latency_us = (uint32_t) (tracker->device_latency_ns / 1000);
+  if (count == 0 || total == 0)
+    return;
+
+  // p99 取所在桶的上界
+  uint64_t rank = (total * 99 + 99) / 100;
+  uint64_t seen = 0;
+  uint32_t p99_us = max_us;
+  for (uint32_t i = 0; i < ROUTER_LATENCY_BUCKETS - 1; i++)
+    {
+      seen += counts[i];
+      if (seen >= rank)
+	{
+	  p99_us = (i + 1) * ROUTER_LATENCY_BUCKET_US;
+	  break;
+	}
     }
 
-  uint32_t sample_count = frame_count * channels;
-  uint32_t current_read
-    = atomic_load_explicit (&rb->read_pos, memory_order_relaxed);
-  uint32_t current_write
-    = atomic_load_explicit (&rb->write_pos, memory_order_acquire);
+  snapshot->e2e_samples = count;
+  snapshot->e2e_min_us = min_us;
+  snapshot->e2e_avg_us = (uint32_t) (sum / count);
+  snapshot->e2e_p99_us = p99_us < max_us ? p99_us : max_us;
+  snapshot->e2e_max_us = max_us;
+}
 
-  // 计算可用数据量
-  uint32_t available;
-  if (current_write >= current_read)
-    available = current_write - current_read;
-  else
-    available = rb->capacity - current_read + current_write;
+// ====== 实时事件追踪 ======
 
-  if (available < sample_count)
-    {
-      atomic_fetch_add_explicit (&g_router.underrun_count, 1,
-				 memory_order_relaxed);
-      // 数据不足，输出静音
-      memset (data, 0, sample_count * sizeof (float));
+// 记录一个追踪事件（IOProc 调用，无锁、无分配；环满时丢弃并计数）
+static inline void
+trace_record (RouterTraceRing *ring, RouterTraceEventType type,
+	      uint64_t host_time, uint32_t duration_ns, uint32_t frames)
+{
+  if (!atomic_load_explicit (&g_trace_enabled, memory_order_relaxed))
+    return;
 
-      // 更新统计
-      rb_update_stats (rb, available);
+  uint64_t head = atomic_load_explicit (&ring->head, memory_order_relaxed);
+  uint64_t tail = atomic_load_explicit (&ring->tail, memory_order_acquire);
+  if (head - tail >= ROUTER_TRACE_EVENTS)
+    {
+      atomic_fetch_add_explicit (&ring->dropped, 1, memory_order_relaxed);
       return;
     }
 
-  // 使用位掩码替代取模运算 - 关键优化！
-  for (uint32_t i = 0; i < sample_count; i++)
+  RouterTraceEvent *event = &ring->events[head & (ROUTER_TRACE_EVENTS - 1)];
+  event->host_time = host_time;
+  event->duration_ns = duration_ns;
+  event->fill_frames
+    = atomic_load_explicit (&g_router.ring_buffer.samples_buffered,
+			    memory_order_relaxed)
+      / g_router.channels;
+  event->frames = frames;
+  event->type = type;
+  atomic_store_explicit (&ring->head, head + 1, memory_order_release);
+}
+
+// ====== 回调负载 ======
+
+// 记录一次回调的耗时（IOProc 调用）
+// 负载 = 耗时 / IO 周期，IO 周期由本次请求的帧数和采样率得出
+static inline void
+load_record (RouterCallbackLoad *load, RouterTraceRing *ring,
+	     uint64_t callback_start, uint32_t duration_ns, uint32_t frames)
+{
+  if (g_router.sample_rate == 0 || frames == 0)
+    return;
+
+  uint64_t period_ns = (uint64_t) frames * 1000000000ULL / g_router.sample_rate;
+  uint32_t permille = (uint32_t) ((uint64_t) duration_ns * 1000 / period_ns);
+
+  atomic_fetch_add_explicit (&load->busy_ns, duration_ns,
+			     memory_order_relaxed);
+  atomic_fetch_add_explicit (&load->period_ns, period_ns,
+			     memory_order_relaxed);
+  if (permille
+      > atomic_load_explicit (&load->peak_permille, memory_order_relaxed))
+    atomic_store_explicit (&load->peak_permille, permille,
+			   memory_order_relaxed);
+
+  if (permille >= atomic_load_explicit (&g_load_threshold_permille,
+					memory_order_relaxed))
     {
-      data[i] = rb->buffer[current_read & ROUTER_BUFFER_MASK];
-      current_read++;
+      atomic_fetch_add_explicit (&load->overruns, 1, memory_order_relaxed);
+      trace_record (ring, kRouterTraceLoadOverrun, callback_start,
+		    duration_ns, frames);
     }
+}
 
-  atomic_store_explicit (&rb->read_pos, current_read, memory_order_release);
+// 取出一个周期的负载统计并清零（监控线程），返回超时次数
+static uint32_t
+load_collect (RouterCallbackLoad *load, uint16_t *avg_permille,
+	      uint16_t *peak_permille)
+{
+  uint64_t busy
+    = atomic_exchange_explicit (&load->busy_ns, 0, memory_order_relaxed);
+  uint64_t period
+    = atomic_exchange_explicit (&load->period_ns, 0, memory_order_relaxed);
+  uint32_t peak
+    = atomic_exchange_explicit (&load->peak_permille, 0, memory_order_relaxed);
+
+  uint64_t avg = period > 0 ? busy * 1000 / period : 0;
+  *avg_permille = avg > UINT16_MAX ? UINT16_MAX : (uint16_t) avg;
+  *peak_permille = peak > UINT16_MAX ? UINT16_MAX : (uint16_t) peak;
+  return atomic_exchange_explicit (&load->overruns, 0, memory_order_relaxed);
+}
 
-  // 更新性能统计
-  rb_update_stats (rb, available - sample_count);
+static void
+load_reset (RouterCallbackLoad *load)
+{
+  atomic_store (&load->busy_ns, 0);
+  atomic_store (&load->period_ns, 0);
+  atomic_store (&load->peak_permille, 0);
+  atomic_store (&load->overruns, 0);
 }
 
 // ====== IO 回调函数 ======
@@ -238,11 +608,12 @@ input_callback (AudioDeviceID inDevice, const AudioTimeStamp *inNow,
 {
   (void) inDevice;
   (void) inNow;
-  (void) inInputTime;
   (void) outOutputData;
   (void) inOutputTime;
   (void) inClientData;
 
+  uint64_t callback_start = mach_absolute_time ();
+
   if (!g_router.is_running || inInputData->mNumberBuffers == 0)
     {
       return noErr;
@@ -258,9 +629,54 @@ input_callback (AudioDeviceID inDevice, const AudioTimeStamp *inNow,
   uint32_t frames
     = inputBuffer->mDataByteSize / (sizeof (float) * g_router.channels);
 
-  rb_write (&g_router.ring_buffer, src, frames, g_router.channels);
+  // 整块静音时只推进写指针，下游读到静音区直接清零输出、跳过处理；
+  // 连续静音超过空闲超时进入空闲模式，一旦有声立即退出
+  bool written;
+  bool idle = false;
+  if (router_buffer_is_silent (src, frames * g_router.channels))
+    {
+      written = router_ring_write_silence (&g_router.ring_buffer, frames,
+					   g_router.channels);
+      atomic_fetch_add_explicit (&g_router.silent_frames, frames,
+				 memory_order_relaxed);
+      uint64_t run
+	= atomic_fetch_add_explicit (&g_router.silent_run_frames, frames,
+				     memory_order_relaxed)
+	  + frames;
+      uint32_t timeout_ms
+	= atomic_load_explicit (&g_idle_timeout_ms, memory_order_relaxed);
+      idle = timeout_ms > 0
+	     && run * 1000 >= (uint64_t) timeout_ms * g_router.sample_rate;
+    }
+  else
+    {
+      written = router_ring_write (&g_router.ring_buffer, src, frames,
+				   g_router.channels);
+      atomic_store_explicit (&g_router.silent_run_frames, 0,
+			     memory_order_relaxed);
+    }
+  atomic_store_explicit (&g_router.idle, idle, memory_order_relaxed);
+
+  if (written)
+    latency_tag_input (&g_router.latency, inInputTime, frames);
+  else
+    {
+      atomic_fetch_add_explicit (&g_router.overrun_count, 1,
+				 memory_order_relaxed);
+      trace_record (g_trace_input_ring, kRouterTraceOverrun, callback_start,
+		    0, frames);
+    }
   g_router.frames_transferred += frames;
 
+  uint32_t duration_ns
+    = (uint32_t) host_delta_to_ns (mach_absolute_time () - callback_start);
+  load_record (&g_router.input_load, g_trace_input_ring, callback_start,
+	       duration_ns, frames);
+  // 空闲模式下追踪只保留 xrun 和负载超时
+  if (!idle)
+    trace_record (g_trace_input_ring, kRouterTraceInputCallback,
+		  callback_start, duration_ns, frames);
+
   return noErr;
 }
 
@@ -276,9 +692,10 @@ output_callback (AudioDeviceID inDevice, const AudioTimeStamp *inNow,
   (void) inNow;
   (void) inInputData;
   (void) inInputTime;
-  (void) inOutputTime;
   (void) inClientData;
 
+  uint64_t callback_start = mach_absolute_time ();
+
   if (!g_router.is_running || outOutputData->mNumberBuffers == 0)
     {
       return noErr;
@@ -290,31 +707,75 @@ output_callback (AudioDeviceID inDevice, const AudioTimeStamp *inNow,
       return noErr;
     }
 
+  // 整数输出时先渲染到渲染区，最后转换写入设备缓冲区；单次回调超过
+  // 渲染区容量的部分输出静音
+  RouterSampleFormat format = g_router.output_format;
+  uint32_t frame_bytes
+    = router_sample_format_bytes (format) * g_router.channels;
+  uint32_t frames = outputBuffer->mDataByteSize / frame_bytes;
   float *dst = (float *) outputBuffer->mData;
-  uint32_t frames
-    = outputBuffer->mDataByteSize / (sizeof (float) * g_router.channels);
-
-  rb_read (&g_router.ring_buffer, dst, frames, g_router.channels);
+  if (format != kRouterSampleFloat32)
+    {
+      if (frames > ROUTER_SCRATCH_FRAMES)
+	{
+	  memset ((uint8_t *) outputBuffer->mData
+		    + (size_t) ROUTER_SCRATCH_FRAMES * frame_bytes,
+		  0, (size_t) (frames - ROUTER_SCRATCH_FRAMES) * frame_bytes);
+	  frames = ROUTER_SCRATCH_FRAMES;
+	}
+      dst = g_router.convert;
+    }
 
-  // 【增益补偿】应用固定增益，防止AGC导致的音量突增
-  // 增益值由启动时传入的物理设备音量决定
+  // 读出并处理（增益补偿、DSP 链），与离线管线共用 router_render_output
   float gain
     = atomic_load_explicit (&g_router.output_gain, memory_order_relaxed);
-  if (gain < 1.0f && gain > 0.0f)
+  bool silent;
+  if (router_render_output (&g_router.ring_buffer, dst, frames,
+			    g_router.channels, gain, &g_dsp_host, &silent))
+    latency_measure_output (&g_router.latency, inOutputTime, frames,
+			    g_router.sample_rate);
+  else
     {
-      for (uint32_t i = 0; i < frames * g_router.channels; i++)
-	{
-	  dst[i] *= gain;
-	}
+      atomic_fetch_add_explicit (&g_router.underrun_count, 1,
+				 memory_order_relaxed);
+      trace_record (g_trace_output_ring, kRouterTraceUnderrun, callback_start,
+		    0, frames);
     }
 
+  // 主输出响度：整块静音时只推进时间轴
+  if (silent)
+    router_loudness_add_silence (&g_loudness, frames);
+  else
+    router_loudness_process (&g_loudness, dst, frames);
+
+  // 频谱抽头：关闭时立即返回，开启时只做抽取和拷贝
+  router_spectrum_tap_push (&g_spectrum_tap, dst, frames, g_router.channels);
+
+  // 录音：未录音时立即返回，写盘跟不上时丢弃整块而不等待
+  router_recorder_push (&g_recorder, dst, frames);
+
+  // 网络推流：未推流时立即返回，推流线程跟不上时丢弃整块而不等待
+  router_rtp_sender_push (&g_rtp_sender, dst, frames);
+
+  if (format != kRouterSampleFloat32)
+    router_convert_from_float (&g_output_dither, format, dst,
+			       outputBuffer->mData, frames, g_router.channels);
+
+  uint32_t duration_ns
+    = (uint32_t) host_delta_to_ns (mach_absolute_time () - callback_start);
+  load_record (&g_router.output_load, g_trace_output_ring, callback_start,
+	       duration_ns, frames);
+  if (!atomic_load_explicit (&g_router.idle, memory_order_relaxed))
+    trace_record (g_trace_output_ring, kRouterTraceOutputCallback,
+		  callback_start, duration_ns, frames);
   return noErr;
 }
 
 // ====== 设备查找 ======
 
+// 通过 HAL 直接把 UID 转换为设备 ID
 static AudioDeviceID
-find_device_by_uid (const char *uid)
+lookup_device_by_uid (const char *uid)
 {
   AudioObjectPropertyAddress addr
     = {kAudioHardwarePropertyTranslateUIDToDevice,
@@ -359,11 +820,177 @@ get_device_sample_rate (AudioDeviceID device, uint32_t *sample_rate)
   return false;
 }
 
+// 查询设备延迟 + 安全偏移（帧数），查询失败的项按 0 计
+static uint32_t
+get_device_latency_frames (AudioDeviceID device, AudioObjectPropertyScope scope)
+{
+  AudioObjectPropertySelector selectors[]
+    = {kAudioDevicePropertyLatency, kAudioDevicePropertySafetyOffset};
+  uint32_t total = 0;
+
+  for (size_t i = 0; i < sizeof (selectors) / sizeof (selectors[0]); i++)
+    {
+      AudioObjectPropertyAddress addr
+	= {selectors[i], scope, kAudioObjectPropertyElementMain};
+      UInt32 frames = 0;
+      UInt32 size = sizeof (frames);
+      if (AudioObjectGetPropertyData (device, &addr, 0, NULL, &size, &frames)
+	  == noErr)
+	total += frames;
+    }
+  return total;
+}
+
+// ====== 输出格式协商 ======
+
+// 设备的第一个输出流
+static AudioStreamID
+get_output_stream (AudioDeviceID device)
+{
+  AudioObjectPropertyAddress addr
+    = {kAudioDevicePropertyStreams, kAudioObjectPropertyScopeOutput,
+       kAudioObjectPropertyElementMain};
+  AudioStreamID stream = kAudioObjectUnknown;
+  UInt32 size = sizeof (stream);
+  if (AudioObjectGetPropertyData (device, &addr, 0, NULL, &size, &stream)
+	!= noErr
+      || size < sizeof (stream))
+    return kAudioObjectUnknown;
+  return stream;
+}
+
+static bool
+get_stream_format (AudioStreamID stream, AudioObjectPropertySelector selector,
+		   AudioStreamBasicDescription *format)
+{
+  AudioObjectPropertyAddress addr
+    = {selector, kAudioObjectPropertyScopeGlobal,
+       kAudioObjectPropertyElementMain};
+  UInt32 size = sizeof (*format);
+  return AudioObjectGetPropertyData (stream, &addr, 0, NULL, &size, format)
+	   == noErr;
+}
+
+static bool
+set_virtual_format (AudioStreamID stream,
+		    const AudioStreamBasicDescription *format)
+{
+  AudioObjectPropertyAddress addr
+    = {kAudioStreamPropertyVirtualFormat, kAudioObjectPropertyScopeGlobal,
+       kAudioObjectPropertyElementMain};
+  return AudioObjectSetPropertyData (stream, &addr, 0, NULL, sizeof (*format),
+				     format)
+	   == noErr;
+}
+
+// 流格式对应的采样格式：要求线性 PCM、本机字节序、交错且声道数与
+// Router 一致
+static bool
+stream_sample_format (const AudioStreamBasicDescription *asbd,
+		      RouterSampleFormat *format)
+{
+  UInt32 flags = asbd->mFormatFlags;
+  if (asbd->mFormatID != kAudioFormatLinearPCM
+      || (flags & kAudioFormatFlagIsBigEndian) != kAudioFormatFlagsNativeEndian
+      || (flags & kAudioFormatFlagIsNonInterleaved) != 0
+      || asbd->mChannelsPerFrame != g_router.channels
+      || asbd->mBytesPerFrame % g_router.channels != 0)
+    return false;
+  return router_sample_format_from_pcm (
+	   (flags & kAudioFormatFlagIsFloat) != 0,
+	   (flags & kAudioFormatFlagIsSignedInteger) != 0,
+	   (flags & kAudioFormatFlagIsAlignedHigh) != 0,
+	   asbd->mBitsPerChannel, asbd->mBytesPerFrame / g_router.channels,
+	   format)
+	 == 0;
+}
+
+// 恢复协商前的虚拟格式（未修改时什么也不做）
+static void
+restore_output_format (void)
+{
+  if (!g_output_format_changed)
+    return;
+  if (!set_virtual_format (g_output_stream, &g_saved_output_format))
+    fprintf (stderr, "[AudioRouter] Warning: 无法恢复输出流的虚拟格式\n");
+  g_output_format_changed = false;
+  g_router.output_format = kRouterSampleFloat32;
+}
+
+// 协商输出格式：默认 Float32（由 HAL 转换到物理格式）；启用整数输出且
+// 物理格式为整数时，把虚拟格式设为同一格式并标记为不可混音。虚拟格式的
+// 修改是异步生效的，读回一致才使用，超时则恢复并退回 Float32
+static void
+negotiate_output_format (void)
+{
+  g_router.output_format = kRouterSampleFloat32;
+  g_output_format_changed = false;
+  g_output_stream = get_output_stream (g_router.output_device);
+
+  AudioStreamBasicDescription physical;
+  RouterSampleFormat format;
+  if (g_output_stream == kAudioObjectUnknown
+      || !get_stream_format (g_output_stream,
+			     kAudioStreamPropertyPhysicalFormat, &physical)
+      || !stream_sample_format (&physical, &format))
+    {
+      ROUTER_LOG_INFO ("物理格式: 无法识别，按 Float32 输出");
+      return;
+    }
+  ROUTER_LOG_INFO ("物理格式: %s, %u 位", router_sample_format_name (format),
+		   (unsigned) physical.mBitsPerChannel);
+  if (format == kRouterSampleFloat32 || !atomic_load (&g_integer_output))
+    return;
+
+  if (!get_stream_format (g_output_stream, kAudioStreamPropertyVirtualFormat,
+			  &g_saved_output_format))
+    return;
+  AudioStreamBasicDescription requested = physical;
+  requested.mFormatFlags |= kAudioFormatFlagIsNonMixable;
+  if (!set_virtual_format (g_output_stream, &requested))
+    {
+      fprintf (stderr, "⚠️ 设备不接受整数虚拟格式，使用 Float32 输出\n");
+      return;
+    }
+  g_output_format_changed = true;
+
+  for (int tries = 0; tries < ROUTER_FORMAT_SETTLE_TRIES; tries++)
+    {
+      AudioStreamBasicDescription actual;
+      RouterSampleFormat actual_format;
+      if (get_stream_format (g_output_stream,
+			     kAudioStreamPropertyVirtualFormat, &actual)
+	  && stream_sample_format (&actual, &actual_format)
+	  && actual_format == format)
+	{
+	  g_router.output_format = format;
+	  return;
+	}
+      struct timespec ts = {0, 10000000}; // 10ms
+      nanosleep (&ts, NULL);
+    }
+
+  fprintf (stderr, "⚠️ 整数虚拟格式未生效，使用 Float32 输出\n");
+  restore_output_format ();
+}
+
 // 前向声明
 static void
 start_monitor_thread (void);
 static void
 stop_monitor_thread (void);
+static void
+start_spectrum_thread (void);
+static void
+stop_spectrum_thread (void);
+static void
+start_stream_thread (void);
+static void
+stop_stream_thread (void);
+static void
+start_trace (void);
+static void
+stop_trace (void);
 
 // ====== 公共 API ======
 
@@ -395,7 +1022,7 @@ audio_router_start (const char *physical_device_uid)
   g_router.input_device = vInfo.deviceId;
 
   // Get physical device
-  g_router.output_device = find_device_by_uid (physical_device_uid);
+  g_router.output_device = lookup_device_by_uid (physical_device_uid);
   if (g_router.output_device == kAudioObjectUnknown)
     {
       fprintf (stderr, "❌ 无法找到物理设备: %s\n", physical_device_uid);
@@ -426,15 +1053,74 @@ audio_router_start (const char *physical_device_uid)
 
   g_router.sample_rate = virtual_rate;
   g_router.channels = 2;	  // Assume stereo
-  g_router.bits_per_channel = 32; // Float32
+
+  // 输出格式：IOProc 创建前确定，输出回调按它解释设备缓冲区
+  negotiate_output_format ();
+  g_router.bits_per_channel
+    = router_sample_format_bits (g_router.output_format);
+  router_dither_init (&g_output_dither, g_dither_mode);
+
+  // 预分配区只在首次启动时映射，之后复用；IOProc 不会触发缺页
+  if (arena_reserve (&g_arena) != 0)
+    {
+      restore_output_format ();
+      return kAudioHardwareUnspecifiedError;
+    }
 
   // Initialize Ring Buffer
-  rb_init (&g_router.ring_buffer);
+  router_ring_init (&g_router.ring_buffer, g_router.ring_storage);
+
+  // DSP 链按新格式重新准备，共享暂存区位于预分配区
+  RouterDspFormat dsp_format = {g_router.sample_rate, ROUTER_SCRATCH_FRAMES,
+				g_router.channels, g_router.scratch};
+  if (router_dsp_host_configure (dsp_host (), &dsp_format) != 0)
+    fprintf (stderr, "[AudioRouter] Warning: DSP 链准备失败，已清空\n");
+  router_loudness_prepare (&g_loudness, g_router.sample_rate,
+			   g_router.channels);
+  router_spectrum_tap_init (&g_spectrum_tap);
+  crossfeed_poll_device ();
+
+  // 录音器只在首次启动时创建；重新启动后服务端保存的录音请求按新格式
+  // 重新应用（写入新文件）
+  if (!g_recorder_ready)
+    g_recorder_ready
+      = router_recorder_init (&g_recorder, ROUTER_RECORD_DEFAULT_RING_FRAMES,
+			      g_router.channels)
+	== 0;
+  if (!g_recorder_ready)
+    fprintf (stderr, "[AudioRouter] Warning: 录音器创建失败，录音不可用\n");
+  atomic_store (&g_record_generation, 0);
+
+  // 推流发送端同样只创建一次；重新启动后按新的采样率重新打开连接
+  if (!g_rtp_sender_ready)
+    g_rtp_sender_ready
+      = router_rtp_sender_init (&g_rtp_sender, g_router.channels) == 0;
+  if (!g_rtp_sender_ready)
+    fprintf (stderr, "[AudioRouter] Warning: 推流发送端创建失败，推流不可用\n");
+  memset (&g_stream_applied, 0, sizeof (g_stream_applied));
+
+  // 端到端延迟：IOProc 时间戳之外还要计入两端设备的延迟和安全偏移
+  mach_timebase_info (&g_timebase);
+  uint32_t input_latency_frames
+    = get_device_latency_frames (g_router.input_device,
+				 kAudioObjectPropertyScopeInput);
+  uint32_t output_latency_frames
+    = get_device_latency_frames (g_router.output_device,
+				 kAudioObjectPropertyScopeOutput);
+  uint64_t device_latency_ns
+    = (uint64_t) input_latency_frames * 1000000000ULL / virtual_rate
+      + (uint64_t) output_latency_frames * 1000000000ULL / physical_rate;
+  latency_reset (&g_router.latency, device_latency_ns);
+  load_reset (&g_router.input_load);
+  load_reset (&g_router.output_load);
 
   // Reset statistics (使用原子操作)
   atomic_store_explicit (&g_router.frames_transferred, 0, memory_order_relaxed);
   atomic_store_explicit (&g_router.underrun_count, 0, memory_order_relaxed);
   atomic_store_explicit (&g_router.overrun_count, 0, memory_order_relaxed);
+  atomic_store_explicit (&g_router.silent_frames, 0, memory_order_relaxed);
+  atomic_store_explicit (&g_router.silent_run_frames, 0, memory_order_relaxed);
+  atomic_store_explicit (&g_router.idle, false, memory_order_relaxed);
 
   // 初始化输出增益为1.0（无增益）
   atomic_store_explicit (&g_router.output_gain, 1.0f, memory_order_relaxed);
@@ -449,7 +1135,8 @@ audio_router_start (const char *physical_device_uid)
   if (status != noErr)
     {
       fprintf (stderr, "❌ 创建输入 IOProc 失败: %d\n", status);
-      rb_destroy (&g_router.ring_buffer);
+      router_ring_detach (&g_router.ring_buffer);
+      restore_output_format ();
       return status;
     }
 
@@ -460,10 +1147,14 @@ audio_router_start (const char *physical_device_uid)
       fprintf (stderr, "❌ 创建输出 IOProc 失败: %d\n", status);
       AudioDeviceDestroyIOProcID (g_router.input_device,
 				  g_router.input_proc_id);
-      rb_destroy (&g_router.ring_buffer);
+      router_ring_detach (&g_router.ring_buffer);
+      restore_output_format ();
       return status;
     }
 
+  // 追踪需要在 IO 启动前就绪，才能记录启动阶段的 xrun
+  start_trace ();
+
   // Start IO
   status = AudioDeviceStart (g_router.input_device, g_router.input_proc_id);
   if (status != noErr)
@@ -486,8 +1177,9 @@ audio_router_start (const char *physical_device_uid)
 
   g_router.is_running = true;
 
-  // 启动监控线程
+  // 启动监控线程和频谱线程
   start_monitor_thread ();
+  start_spectrum_thread ();
 
   ROUTER_LOG_INFO ("✅ Router 已启动");
   ROUTER_LOG_INFO ("音频流: Virtual Device -> Ring Buffer -> Physical Device");
@@ -495,14 +1187,28 @@ audio_router_start (const char *physical_device_uid)
 		   g_router.channels);
   ROUTER_LOG_INFO ("缓冲区: %u 帧 (约 %u ms)", ROUTER_BUFFER_FRAME_COUNT,
 		   (ROUTER_BUFFER_FRAME_COUNT * 1000) / g_router.sample_rate);
-  ROUTER_LOG_INFO ("监控: 每 %d 秒报告一次性能状态", MONITOR_INTERVAL_SEC);
+  if (g_router.output_format == kRouterSampleFloat32)
+    ROUTER_LOG_INFO ("输出格式: Float32");
+  else
+    ROUTER_LOG_INFO ("输出格式: %s（直接输出，抖动 %s）",
+		     router_sample_format_name (g_router.output_format),
+		     kDitherModeNames[g_output_dither.mode]);
+  ROUTER_LOG_INFO ("预分配区: %zu KB (%s)", g_arena.size / 1024,
+		   g_arena.locked ? "已锁定" : "未锁定");
+  ROUTER_LOG_INFO ("设备延迟: 输入 %u 帧, 输出 %u 帧 (含安全偏移, 约 %.1f ms)",
+		   input_latency_frames, output_latency_frames,
+		   device_latency_ns / 1e6);
+  ROUTER_LOG_INFO ("监控: 每 %u ms 报告一次性能状态",
+		   atomic_load (&g_monitor_interval_ms));
 
   return noErr;
 
 cleanup:
+  stop_trace ();
   AudioDeviceDestroyIOProcID (g_router.input_device, g_router.input_proc_id);
   AudioDeviceDestroyIOProcID (g_router.output_device, g_router.output_proc_id);
-  rb_destroy (&g_router.ring_buffer);
+  router_ring_detach (&g_router.ring_buffer);
+  restore_output_format ();
   return status;
 }
 
@@ -518,19 +1224,29 @@ audio_router_stop (void)
 
   g_router.is_running = false;
 
-  // 停止监控线程
+  // 停止频谱线程和监控线程
+  stop_spectrum_thread ();
   stop_monitor_thread ();
 
   // 停止 IO
   AudioDeviceStop (g_router.output_device, g_router.output_proc_id);
   AudioDeviceStop (g_router.input_device, g_router.input_proc_id);
 
+  // IO 停止后导出剩余追踪事件，写完并关闭录音文件，关闭推流连接
+  stop_trace ();
+  if (g_recorder_ready)
+    router_recorder_stop (&g_recorder);
+  stop_stream_thread ();
+  if (g_rtp_sender_ready)
+    router_rtp_sender_close (&g_rtp_sender);
+
   // 销毁 IO Proc
   AudioDeviceDestroyIOProcID (g_router.output_device, g_router.output_proc_id);
   AudioDeviceDestroyIOProcID (g_router.input_device, g_router.input_proc_id);
 
   // 销毁 Ring Buffer
-  rb_destroy (&g_router.ring_buffer);
+  router_ring_detach (&g_router.ring_buffer);
+  restore_output_format ();
 
   ROUTER_LOG_INFO ("✅ Router 已停止");
 }
@@ -605,6 +1321,404 @@ audio_router_get_stats (uint64_t *frames_transferred, uint32_t *underruns,
 
 // ====== 性能监控线程 ======
 
+// 发布一条快照到快照环（只由监控线程调用）
+static void
+stats_ring_publish (const IPCRouterStatsSnapshot *snapshot)
+{
+  uint64_t index
+    = atomic_load_explicit (&g_stats_ring.published, memory_order_relaxed);
+  RouterStatsSlot *slot = &g_stats_ring.slots[index % ROUTER_STATS_HISTORY];
+
+  uint32_t seq = atomic_load_explicit (&slot->sequence, memory_order_relaxed);
+  atomic_store_explicit (&slot->sequence, seq + 1, memory_order_relaxed);
+  atomic_thread_fence (memory_order_release);
+  slot->snapshot = *snapshot;
+  atomic_store_explicit (&slot->sequence, seq + 2, memory_order_release);
+  atomic_store_explicit (&g_stats_ring.published, index + 1,
+			 memory_order_release);
+}
+
+// 在条件变量上等待一个周期，返回 false 表示线程应退出
+static bool
+thread_wait (pthread_mutex_t *mutex, pthread_cond_t *cond,
+	     const bool *running_flag, uint32_t timeout_ms)
+{
+  struct timespec deadline;
+  clock_gettime (CLOCK_REALTIME, &deadline);
+  deadline.tv_sec += timeout_ms / 1000;
+  deadline.tv_nsec += (long) (timeout_ms % 1000) * 1000000L;
+  if (deadline.tv_nsec >= 1000000000L)
+    {
+      deadline.tv_sec++;
+      deadline.tv_nsec -= 1000000000L;
+    }
+
+  pthread_mutex_lock (mutex);
+  while (*running_flag)
+    {
+      if (pthread_cond_timedwait (cond, mutex, &deadline) != 0)
+	break;
+    }
+  bool running = *running_flag;
+  pthread_mutex_unlock (mutex);
+
+  return running;
+}
+
+// 把 IPC 下发的均衡器配置交给处理器（客户端 IO 线程，不阻塞实时线程）
+static void
+eq_apply_config (const void *data, uint32_t data_len)
+{
+  if (data == NULL || data_len < sizeof (IPCEqualizerConfig))
+    return;
+  IPCEqualizerConfig config;
+  memcpy (&config, data, sizeof (config));
+  if (!ipc_equalizer_config_is_valid (&config))
+    return;
+
+  RouterEqBand bands[ROUTER_EQ_MAX_BANDS];
+  for (uint32_t i = 0; i < config.band_count; i++)
+    {
+      bands[i].type = (RouterEqBandType) config.bands[i].type;
+      bands[i].enabled = config.bands[i].enabled != 0;
+      bands[i].frequency = config.bands[i].frequency;
+      bands[i].gain_db = config.bands[i].gain_db;
+      bands[i].q = config.bands[i].q;
+    }
+  dsp_host ();
+  if (router_eq_set_config (&g_eq, config.enabled != 0, config.preamp_db,
+			    bands, config.band_count)
+      == 0)
+    ROUTER_LOG_INFO ("[Router EQ] %s | %u 段 | 前级:%.1f dB",
+		     config.enabled ? "已启用" : "已关闭", config.band_count,
+		     config.preamp_db);
+}
+
+// 把 IPC 下发的卷积器配置交给处理器（客户端 IO 线程）
+// 读取 IR 文件和预先变换都在这里完成，实时线程只看到替换后的 IR
+static void
+convolver_apply_config (const void *data, uint32_t data_len)
+{
+  // 最近一次生效的配置（仅 IO 线程访问），重连后取回相同配置时不重复读取
+  static IPCConvolverConfig applied;
+
+  if (data == NULL || data_len < sizeof (IPCConvolverConfig))
+    return;
+  IPCConvolverConfig config;
+  memcpy (&config, data, sizeof (config));
+  if (!ipc_convolver_config_is_valid (&config)
+      || memcmp (&config, &applied, sizeof (config)) == 0)
+    return;
+  applied = config;
+
+  dsp_host ();
+  if (!config.enabled)
+    {
+      router_convolver_set_ir (&g_convolver, NULL);
+      ROUTER_LOG_INFO ("[Router 卷积] 已关闭");
+      return;
+    }
+
+  float gain = powf (10.0f, config.gain_db / 20.0f);
+  RouterConvolverIr *ir = router_convolver_ir_load_wav (config.path, gain);
+  if (ir == NULL)
+    {
+      // 文件修正后再次下发相同配置时重新读取
+      memset (&applied, 0, sizeof (applied));
+      router_convolver_set_ir (&g_convolver, NULL);
+      ROUTER_LOG_INFO ("[Router 卷积] 无法读取 IR: %s", config.path);
+      return;
+    }
+  ROUTER_LOG_INFO ("[Router 卷积] 已启用 | %.2f 秒 | %u 声道 | %u Hz | "
+		   "增益:%.1f dB",
+		   (double) ir->frames / ir->sample_rate, ir->channels,
+		   ir->sample_rate, config.gain_db);
+  if (ir->sample_rate != g_router.sample_rate)
+    ROUTER_LOG_INFO ("[Router 卷积] IR 采样率与输出 (%u Hz) 不一致，暂时直通",
+		     g_router.sample_rate);
+  router_convolver_set_ir (&g_convolver, ir);
+}
+
+// 记录 IPC 下发的交叉馈送配置（客户端 IO 线程）
+static void
+crossfeed_apply_config (const void *data, uint32_t data_len)
+{
+  if (data == NULL || data_len < sizeof (IPCCrossfeedConfig))
+    return;
+  IPCCrossfeedConfig config;
+  memcpy (&config, data, sizeof (config));
+  if (!ipc_crossfeed_config_is_valid (&config))
+    return;
+  atomic_store (&g_crossfeed_mode, config.mode);
+  atomic_store (&g_crossfeed_preset, config.preset);
+  crossfeed_refresh ();
+}
+
+// 上报录音状态（不等待响应）
+static void
+record_publish_status (IPCAsyncClient *client)
+{
+  if (!g_recorder_ready)
+    return;
+  RouterRecordStatus status;
+  router_recorder_get_status (&g_recorder, &status);
+  IPCRecordStatus report;
+  memset (&report, 0, sizeof (report));
+  report.recording = status.recording;
+  report.format = (uint8_t) status.format;
+  report.error = status.error;
+  report.generation = atomic_load (&g_record_generation);
+  report.files = status.files;
+  report.sample_rate = g_router.sample_rate;
+  report.channels = g_router.channels;
+  report.dropped_blocks = status.dropped_blocks;
+  report.frames = status.frames;
+  report.dropped_frames = status.dropped_frames;
+  snprintf (report.path, sizeof (report.path), "%s", status.path);
+  ipc_async_client_request (client, kIPCCommandPublishRecording, &report,
+			    sizeof (report), NULL, NULL, NULL);
+}
+
+// 应用 IPC 下发的录音请求（客户端 IO 线程；开始和停止要等写盘线程
+// 写完当前文件，不影响实时线程）
+static void
+record_apply_config (IPCAsyncClient *client, const void *data,
+		     uint32_t data_len)
+{
+  if (!g_recorder_ready || data == NULL || data_len < sizeof (IPCRecordConfig))
+    return;
+  IPCRecordConfig config;
+  memcpy (&config, data, sizeof (config));
+  if (!ipc_record_config_is_valid (&config)
+      || config.generation == atomic_load (&g_record_generation))
+    return;
+
+  RouterRecordStatus status;
+  if (config.recording)
+    {
+      int result = router_recorder_start (&g_recorder, config.directory,
+					  (RouterRecordFormat) config.format,
+					  g_router.sample_rate);
+      router_recorder_get_status (&g_recorder, &status);
+      if (result == 0)
+	ROUTER_LOG_INFO ("[Router 录音] 写入 %s", status.path);
+      else
+	ROUTER_LOG_INFO ("[Router 录音] 无法在 %s 中录音: %s",
+			 config.directory, strerror (status.error));
+    }
+  else
+    {
+      router_recorder_get_status (&g_recorder, &status);
+      if (status.recording)
+	{
+	  router_recorder_stop (&g_recorder);
+	  router_recorder_get_status (&g_recorder, &status);
+	  ROUTER_LOG_INFO ("[Router 录音] 已停止，%s 共 %.1f 秒", status.path,
+			   (double) status.frames / g_router.sample_rate);
+	}
+    }
+  atomic_store (&g_record_generation, config.generation);
+  record_publish_status (client);
+}
+
+// 录音丢块时记录日志（监控线程）
+static void
+record_check_dropped (void)
+{
+  if (!g_recorder_ready)
+    return;
+  uint32_t dropped = atomic_load (&g_recorder.ring.dropped_blocks);
+  if (dropped != g_record_dropped_logged)
+    {
+      syslog (LOG_ERR, "[Router 录音] 写盘跟不上，已丢弃 %u 块",
+	      dropped - g_record_dropped_logged);
+      g_record_dropped_logged = dropped;
+    }
+}
+
+// 应用 IPC 下发的推流配置（客户端 IO 线程）：停推流线程、重新打开
+// 连接，开启时再启动推流线程；解析主机名可能阻塞，不影响实时线程
+static void
+stream_apply_config (const void *data, uint32_t data_len)
+{
+  if (!g_rtp_sender_ready || data == NULL
+      || data_len < sizeof (IPCStreamConfig))
+    return;
+  IPCStreamConfig config;
+  memcpy (&config, data, sizeof (config));
+  if (!ipc_stream_config_is_valid (&config)
+      || memcmp (&config, &g_stream_applied, sizeof (config)) == 0)
+    return;
+  g_stream_applied = config;
+
+  stop_stream_thread ();
+  router_rtp_sender_close (&g_rtp_sender);
+  if (!config.enabled)
+    {
+      ROUTER_LOG_INFO ("[Router 推流] 已关闭");
+      return;
+    }
+  if (router_rtp_payload_type (g_router.sample_rate) < 0)
+    {
+      ROUTER_LOG_INFO ("[Router 推流] 不支持 %u Hz，未开启",
+		       g_router.sample_rate);
+      return;
+    }
+  if (router_rtp_sender_open (&g_rtp_sender, config.host, config.port,
+			      g_router.sample_rate, config.ptime_ms)
+      != 0)
+    {
+      ROUTER_LOG_INFO ("[Router 推流] 无法连接 %s:%u", config.host,
+		       config.port);
+      return;
+    }
+  // 每半个包时长唤醒一次，凑满的包尽快发出
+  g_stream_pump_ms = config.ptime_ms > 1 ? config.ptime_ms / 2u : 1;
+  start_stream_thread ();
+  ROUTER_LOG_INFO ("[Router 推流] RTP -> %s:%u | %u Hz | 包时长:%u ms",
+		   config.host, config.port, g_router.sample_rate,
+		   config.ptime_ms);
+}
+
+// 推流丢块或发送失败时记录日志（监控线程）
+static void
+stream_check_stats (void)
+{
+  if (!g_rtp_sender_ready)
+    return;
+  RouterRtpSenderStats stats;
+  router_rtp_sender_get_stats (&g_rtp_sender, &stats);
+  if (stats.dropped_blocks != g_stream_logged.dropped_blocks
+      || stats.send_errors != g_stream_logged.send_errors)
+    syslog (LOG_ERR, "[Router 推流] 推流线程跟不上丢弃 %u 块，发送失败 %u 包",
+	    stats.dropped_blocks - g_stream_logged.dropped_blocks,
+	    stats.send_errors - g_stream_logged.send_errors);
+  g_stream_logged = stats;
+}
+
+// user_data 为监控线程的 IPC 客户端
+static void
+dsp_event_callback (void *user_data, uint32_t topic, const void *data,
+		    uint32_t data_len)
+{
+  if (topic == kIPCEventTopicEqualizer)
+    eq_apply_config (data, data_len);
+  else if (topic == kIPCEventTopicConvolver)
+    convolver_apply_config (data, data_len);
+  else if (topic == kIPCEventTopicCrossfeed)
+    crossfeed_apply_config (data, data_len);
+  else if (topic == kIPCEventTopicRecording)
+    record_apply_config (user_data, data, data_len);
+  else if (topic == kIPCEventTopicStream)
+    stream_apply_config (data, data_len);
+}
+
+static void
+eq_response_callback (void *user_data, int32_t status, const void *data,
+		      uint32_t data_len)
+{
+  (void) user_data;
+  if (status == kIPCStatusOK)
+    eq_apply_config (data, data_len);
+}
+
+static void
+convolver_response_callback (void *user_data, int32_t status,
+			     const void *data, uint32_t data_len)
+{
+  (void) user_data;
+  if (status == kIPCStatusOK)
+    convolver_apply_config (data, data_len);
+}
+
+static void
+crossfeed_response_callback (void *user_data, int32_t status,
+			     const void *data, uint32_t data_len)
+{
+  (void) user_data;
+  if (status == kIPCStatusOK)
+    crossfeed_apply_config (data, data_len);
+}
+
+// 响应为 IPCRecordReport，只取其中的请求；user_data 为 IPC 客户端
+static void
+record_response_callback (void *user_data, int32_t status, const void *data,
+			  uint32_t data_len)
+{
+  if (status == kIPCStatusOK)
+    record_apply_config (user_data, data, data_len);
+}
+
+static void
+stream_response_callback (void *user_data, int32_t status, const void *data,
+			  uint32_t data_len)
+{
+  (void) user_data;
+  if (status == kIPCStatusOK)
+    stream_apply_config (data, data_len);
+}
+
+// 确保已连接 IPC 服务；新建连接时订阅 DSP 配置变更并取回当前配置
+static bool
+monitor_connect_ipc (IPCAsyncClient *client, bool *client_ready)
+{
+  if (!*client_ready)
+    *client_ready
+      = ipc_async_client_init (client, dsp_event_callback, client) == 0;
+  if (!*client_ready)
+    return false;
+
+  if (ipc_async_client_is_connected (client))
+    return true;
+
+  ipc_async_client_disconnect (client);
+  if (ipc_async_client_connect (client) != 0)
+    return false;
+  ipc_async_client_subscribe (client,
+			      kIPCEventTopicEqualizer | kIPCEventTopicConvolver
+				| kIPCEventTopicCrossfeed
+				| kIPCEventTopicRecording | kIPCEventTopicStream,
+			      NULL, NULL);
+  ipc_async_client_request (client, kIPCCommandGetEqualizer, NULL, 0,
+			    eq_response_callback, NULL, NULL);
+  ipc_async_client_request (client, kIPCCommandGetConvolver, NULL, 0,
+			    convolver_response_callback, NULL, NULL);
+  ipc_async_client_request (client, kIPCCommandGetCrossfeed, NULL, 0,
+			    crossfeed_response_callback, NULL, NULL);
+  ipc_async_client_request (client, kIPCCommandGetRecording, NULL, 0,
+			    record_response_callback, client, NULL);
+  ipc_async_client_request (client, kIPCCommandGetStream, NULL, 0,
+			    stream_response_callback, NULL, NULL);
+  return true;
+}
+
+// 把快照和主输出响度上报给 IPC 服务（不等待响应；服务未运行时下个周期重试）
+static void
+monitor_publish_ipc (IPCAsyncClient *client, bool *client_ready,
+		     const IPCRouterStatsSnapshot *snapshot,
+		     const RouterLoudnessReading *reading)
+{
+  if (!monitor_connect_ipc (client, client_ready))
+    return;
+
+  ipc_async_client_request (client, kIPCCommandPublishRouterStats, snapshot,
+			    sizeof (*snapshot), NULL, NULL, NULL);
+
+  struct __attribute__ ((packed))
+  {
+    IPCLoudnessReport header;
+    IPCLoudnessEntry entry;
+  } report = {{1}, {0}};
+  report.entry.pid = IPC_LOUDNESS_MASTER_PID;
+  report.entry.momentary_lufs = reading->momentary_lufs;
+  report.entry.short_term_lufs = reading->short_term_lufs;
+  report.entry.integrated_lufs = reading->integrated_lufs;
+  report.entry.true_peak_dbtp = reading->true_peak_dbtp;
+  ipc_async_client_request (client, kIPCCommandPublishLoudness, &report,
+			    sizeof (report), NULL, NULL, NULL);
+  record_publish_status (client);
+}
+
 static void *
 monitor_thread_func (void *arg)
 {
@@ -615,12 +1729,24 @@ monitor_thread_func (void *arg)
   uint32_t last_underruns = 0;
   uint32_t last_overruns = 0;
   uint64_t last_frames = 0;
+  uint64_t last_silent_frames = 0;
+  bool idle = false;
+  IPCAsyncClient ipc_client;
+  bool ipc_client_ready = false;
 
-  while (g_monitor_running && g_router.is_running)
-    {
-      sleep (MONITOR_INTERVAL_SEC);
+  // 启动时立即连接，不必等一个监控周期才取回均衡器配置
+  monitor_connect_ipc (&ipc_client, &ipc_client_ready);
 
-      // 注: 循环条件已检查 g_router.is_running，这里不需要额外检查
+  for (;;)
+    {
+      // 空闲模式下放大监控周期（输入恢复有声时在下一次醒来后恢复）
+      uint32_t interval_ms = atomic_load (&g_monitor_interval_ms);
+      if (idle)
+	interval_ms *= ROUTER_IDLE_MONITOR_INTERVAL_FACTOR;
+      if (!thread_wait (&g_monitor_mutex, &g_monitor_cond, &g_monitor_running,
+			interval_ms)
+	  || !g_router.is_running)
+	break;
 
       // 获取当前统计
       uint32_t current_underruns
@@ -630,19 +1756,22 @@ monitor_thread_func (void *arg)
       uint64_t current_frames
 	= atomic_load_explicit (&g_router.frames_transferred,
 				memory_order_relaxed);
+      uint64_t current_silent_frames
+	= atomic_load_explicit (&g_router.silent_frames, memory_order_relaxed);
 
       // 计算增量
       uint32_t underrun_delta = current_underruns - last_underruns;
       uint32_t overrun_delta = current_overruns - last_overruns;
       uint64_t frames_delta = current_frames - last_frames;
+      uint64_t silent_delta = current_silent_frames - last_silent_frames;
 
-      // 获取 Watermark
+      // 获取 Watermark（周期峰值读取后清零）
       uint32_t current_usage
 	= atomic_load_explicit (&g_router.ring_buffer.current_usage,
 				memory_order_relaxed);
       uint32_t peak_usage
-	= atomic_load_explicit (&g_router.ring_buffer.peak_usage,
-				memory_order_relaxed);
+	= atomic_exchange_explicit (&g_router.ring_buffer.interval_peak,
+				    current_usage, memory_order_relaxed);
       uint32_t samples_buffered
 	= atomic_load_explicit (&g_router.ring_buffer.samples_buffered,
 				memory_order_relaxed);
@@ -654,34 +1783,117 @@ monitor_thread_func (void *arg)
 	= calculate_latency_ms (buffered_frames, g_router.sample_rate);
 
       // 计算运行时间
-      uint64_t elapsed_us = get_time_us () - g_router.start_time;
-      uint32_t elapsed_sec = (uint32_t) (elapsed_us / 1000000);
+      uint64_t now_us = get_time_us ();
+      uint32_t elapsed_sec
+	= (uint32_t) ((now_us - g_router.start_time) / 1000000);
+
+      IPCRouterStatsSnapshot snapshot = {0};
+      snapshot.timestamp_ms = now_us / 1000;
+      snapshot.uptime_sec = elapsed_sec;
+      snapshot.interval_ms = interval_ms;
+      snapshot.sample_rate = g_router.sample_rate;
+      snapshot.latency_ms = latency_ms;
+      snapshot.fill_percent = current_usage;
+      snapshot.peak_percent = peak_usage;
+      snapshot.underruns = underrun_delta;
+      snapshot.overruns = overrun_delta;
+      snapshot.frames = frames_delta;
+      snapshot.frames_total = current_frames;
+      latency_collect (&g_router.latency, &snapshot);
+      snapshot.load_threshold
+	= (uint16_t) atomic_load (&g_load_threshold_permille);
+      uint16_t load_avg = 0;
+      uint16_t load_peak = 0;
+      snapshot.load_overruns
+	= load_collect (&g_router.input_load, &load_avg, &load_peak);
+      snapshot.input_load_avg = load_avg;
+      snapshot.input_load_peak = load_peak;
+      snapshot.load_overruns
+	+= load_collect (&g_router.output_load, &load_avg, &load_peak);
+      snapshot.output_load_avg = load_avg;
+      snapshot.output_load_peak = load_peak;
+      snapshot.silent_permille
+	= frames_delta > 0 ? (uint16_t) (silent_delta * 1000 / frames_delta)
+			   : 0;
+      uint32_t limiter_gr = router_limiter_collect (&g_limiter);
+      snapshot.limiter_gr_cdb
+	= (uint16_t) (limiter_gr < UINT16_MAX ? limiter_gr : UINT16_MAX);
+      bool now_idle
+	= atomic_load_explicit (&g_router.idle, memory_order_relaxed);
+      if (now_idle)
+	snapshot.flags |= IPC_ROUTER_FLAG_IDLE;
+      if (now_idle && !idle)
+	ROUTER_LOG_INFO ("[Router Monitor] 输入持续静音，进入空闲模式");
+      else if (!now_idle && idle)
+	ROUTER_LOG_INFO ("[Router Monitor] 输入恢复，退出空闲模式");
+      idle = now_idle;
+      // 日志取两个 IOProc 中较高的负载
+      uint16_t load_avg_max = snapshot.input_load_avg > load_avg
+				? snapshot.input_load_avg
+				: load_avg;
+      uint16_t load_peak_max = snapshot.input_load_peak > load_peak
+				 ? snapshot.input_load_peak
+				 : load_peak;
+      RouterLoudnessReading loudness;
+      router_loudness_read (&g_loudness, &loudness);
+      stats_ring_publish (&snapshot);
+      monitor_publish_ipc (&ipc_client, &ipc_client_ready, &snapshot,
+			   &loudness);
+      crossfeed_poll_device ();
+      record_check_dropped ();
+      stream_check_stats ();
 
       // 输出到系统日志
-      if (underrun_delta > 0 || overrun_delta > 0)
+      if (underrun_delta > 0 || overrun_delta > 0
+	  || snapshot.load_overruns > 0)
 	{
 	  syslog (LOG_ERR,
 		  "[Router Monitor] %02u:%02u | 延迟:%ums | "
 		  "缓冲:%u%% | 峰值:%u%% | 传输:%llu | "
-		  "Underrun:%u | Overrun:%u",
+		  "Underrun:%u | Overrun:%u | 负载超时:%u",
 		  elapsed_sec / 60, elapsed_sec % 60, latency_ms, current_usage,
-		  peak_usage, frames_delta, underrun_delta, overrun_delta);
+		  peak_usage, (unsigned long long) frames_delta, underrun_delta,
+		  overrun_delta, snapshot.load_overruns);
 	}
       else
 	{
 	  ROUTER_LOG_INFO ("[Router Monitor] %02u:%02u | 延迟:%ums | "
-			   "缓冲:%u%% | 峰值:%u%% | 传输:%llu | 状态:健康",
+			   "端到端:%.1f/%.1fms | 缓冲:%u%% | 峰值:%u%% | "
+			   "负载:%.1f%%/%.1f%% | 传输:%llu | 静音:%.1f%% | "
+			   "压限:%.1fdB | 响度:%.1fLUFS | 状态:%s",
 			   elapsed_sec / 60, elapsed_sec % 60, latency_ms,
-			   current_usage, peak_usage,
-			   (unsigned long long) frames_delta);
+			   snapshot.e2e_avg_us / 1000.0,
+			   snapshot.e2e_p99_us / 1000.0, current_usage,
+			   peak_usage, load_avg_max / 10.0,
+			   load_peak_max / 10.0,
+			   (unsigned long long) frames_delta,
+			   snapshot.silent_permille / 10.0,
+			   snapshot.limiter_gr_cdb / 100.0,
+			   loudness.short_term_lufs, idle ? "空闲" : "健康");
 	}
 
+      // DSP 链各级负载（链非空时）
+      RouterDspStageStats dsp_stats[ROUTER_DSP_MAX_STAGES];
+      uint32_t dsp_count
+	= router_dsp_host_collect_stats (dsp_host (), dsp_stats,
+					 ROUTER_DSP_MAX_STAGES);
+      for (uint32_t i = 0; i < dsp_count; i++)
+	ROUTER_LOG_INFO ("[Router DSP] #%u %s | 负载:%.1f%%/%.1f%% | "
+			 "调用:%u%s",
+			 i, dsp_stats[i].name, dsp_stats[i].avg_permille / 10.0,
+			 dsp_stats[i].peak_permille / 10.0, dsp_stats[i].calls,
+			 dsp_stats[i].bypass ? " | 旁路" : "");
+
       // 更新上次记录
       last_underruns = current_underruns;
       last_overruns = current_overruns;
       last_frames = current_frames;
+      last_silent_frames = current_silent_frames;
     }
 
+  if (ipc_client_ready)
+    ipc_async_client_cleanup (&ipc_client);
+
   ROUTER_LOG_INFO ("[Router Monitor] 监控线程停止");
   return NULL;
 }
@@ -690,19 +1902,29 @@ monitor_thread_func (void *arg)
 static void
 start_monitor_thread (void)
 {
-  g_monitor_running = 1;
+  pthread_mutex_lock (&g_monitor_mutex);
+  g_monitor_running = true;
+  pthread_mutex_unlock (&g_monitor_mutex);
+
   if (pthread_create (&g_monitor_thread, NULL, monitor_thread_func, NULL) != 0)
     {
       fprintf (stderr, "[AudioRouter] Warning: 无法创建监控线程\n");
-      g_monitor_running = 0;
+      pthread_mutex_lock (&g_monitor_mutex);
+      g_monitor_running = false;
+      pthread_mutex_unlock (&g_monitor_mutex);
+      g_monitor_thread = 0;
     }
 }
 
-// 停止监控线程
+// 停止监控线程（唤醒正在等待的监控线程，不必等完整个周期）
 static void
 stop_monitor_thread (void)
 {
-  g_monitor_running = 0;
+  pthread_mutex_lock (&g_monitor_mutex);
+  g_monitor_running = false;
+  pthread_cond_broadcast (&g_monitor_cond);
+  pthread_mutex_unlock (&g_monitor_mutex);
+
   if (g_monitor_thread != 0)
     {
       pthread_join (g_monitor_thread, NULL);
@@ -710,6 +1932,588 @@ stop_monitor_thread (void)
     }
 }
 
+// ====== 频谱线程 ======
+
+static IPCSpectrumConfig
+spectrum_config_load (void)
+{
+  uint64_t word = atomic_load (&g_spectrum_config);
+  IPCSpectrumConfig config;
+  memcpy (&config, &word, sizeof (config));
+  if (!ipc_spectrum_config_is_valid (&config))
+    ipc_spectrum_config_init (&config);
+  return config;
+}
+
+// 记录 IPC 下发的频谱分析配置（客户端 IO 线程），频谱线程下个周期生效
+static void
+spectrum_apply_config (const void *data, uint32_t data_len)
+{
+  if (data == NULL || data_len < sizeof (IPCSpectrumConfig))
+    return;
+  IPCSpectrumConfig config;
+  memcpy (&config, data, sizeof (config));
+  if (!ipc_spectrum_config_is_valid (&config))
+    return;
+  uint64_t word;
+  memcpy (&word, &config, sizeof (word));
+  atomic_store (&g_spectrum_config, word);
+}
+
+static void
+spectrum_event_callback (void *user_data, uint32_t topic, const void *data,
+			 uint32_t data_len)
+{
+  (void) user_data;
+  if (topic == kIPCEventTopicSpectrum)
+    spectrum_apply_config (data, data_len);
+}
+
+static void
+spectrum_config_response_callback (void *user_data, int32_t status,
+				   const void *data, uint32_t data_len)
+{
+  (void) user_data;
+  if (status == kIPCStatusOK)
+    spectrum_apply_config (data, data_len);
+}
+
+// 上报的响应是频谱帧订阅者数
+static void
+spectrum_publish_response_callback (void *user_data, int32_t status,
+				    const void *data, uint32_t data_len)
+{
+  (void) user_data;
+  uint32_t listeners = 0;
+  if (status == kIPCStatusOK && data != NULL && data_len >= sizeof (listeners))
+    memcpy (&listeners, data, sizeof (listeners));
+  atomic_store (&g_spectrum_listeners, listeners);
+}
+
+// 确保已连接 IPC 服务；新建连接时订阅配置变更并取回当前配置
+static bool
+spectrum_connect_ipc (IPCAsyncClient *client, bool *client_ready)
+{
+  if (!*client_ready)
+    *client_ready
+      = ipc_async_client_init (client, spectrum_event_callback, NULL) == 0;
+  if (!*client_ready)
+    return false;
+
+  if (ipc_async_client_is_connected (client))
+    return true;
+
+  atomic_store (&g_spectrum_listeners, 0);
+  ipc_async_client_disconnect (client);
+  if (ipc_async_client_connect (client) != 0)
+    return false;
+  ipc_async_client_subscribe (client, kIPCEventTopicSpectrum, NULL, NULL);
+  ipc_async_client_request (client, kIPCCommandGetSpectrum, NULL, 0,
+			    spectrum_config_response_callback, NULL, NULL);
+  return true;
+}
+
+static void *
+spectrum_thread_func (void *arg)
+{
+  (void) arg;
+
+  // 单实例线程，较大的缓冲区放在静态区而不是线程栈上
+  static float samples[ROUTER_SPECTRUM_RING_SIZE];
+  static IPCSpectrumFrame frame;
+  float bands[ROUTER_SPECTRUM_MAX_BANDS];
+  RouterSpectrumAnalyzer analyzer;
+  bool analyzer_ready = false;
+  IPCSpectrumConfig applied = {0};
+  IPCAsyncClient ipc_client;
+  bool ipc_client_ready = false;
+  uint32_t probe_elapsed_ms = ROUTER_SPECTRUM_PROBE_INTERVAL_MS;
+  uint32_t sequence = 0;
+
+  for (;;)
+    {
+      IPCSpectrumConfig config = spectrum_config_load ();
+      uint32_t period_ms = 1000 / config.fps;
+      if (!thread_wait (&g_spectrum_mutex, &g_spectrum_cond,
+			&g_spectrum_running, period_ms)
+	  || !g_router.is_running)
+	break;
+
+      // 服务未运行或没有订阅者：关闭抽头，定期只发一个空帧询问订阅者数
+      bool connected = spectrum_connect_ipc (&ipc_client, &ipc_client_ready);
+      if (!connected || atomic_load (&g_spectrum_listeners) == 0)
+	{
+	  if (analyzer_ready)
+	    {
+	      router_spectrum_tap_set_decimation (&g_spectrum_tap, 0);
+	      router_spectrum_analyzer_destroy (&analyzer);
+	      analyzer_ready = false;
+	      ROUTER_LOG_INFO ("[Router 频谱] 无订阅者，已停止分析");
+	    }
+	  probe_elapsed_ms += period_ms;
+	  if (connected && probe_elapsed_ms >= ROUTER_SPECTRUM_PROBE_INTERVAL_MS)
+	    {
+	      memset (&frame, 0, IPC_SPECTRUM_FRAME_HEADER_SIZE);
+	      ipc_async_client_request (
+		&ipc_client, kIPCCommandPublishSpectrum, &frame,
+		IPC_SPECTRUM_FRAME_HEADER_SIZE,
+		spectrum_publish_response_callback, NULL, NULL);
+	      probe_elapsed_ms = 0;
+	    }
+	  continue;
+	}
+
+      // 配置或采样率变化时重建分析器，丢弃环中按旧倍数抽取的采样
+      uint32_t rate = g_router.sample_rate / config.decimation;
+      if (!analyzer_ready || memcmp (&config, &applied, sizeof (config)) != 0
+	  || analyzer.sample_rate != rate)
+	{
+	  if (analyzer_ready)
+	    router_spectrum_analyzer_destroy (&analyzer);
+	  analyzer_ready = router_spectrum_analyzer_init (&analyzer,
+							  config.fft_size,
+							  config.band_count,
+							  rate)
+			   == 0;
+	  applied = config;
+	  router_spectrum_tap_set_decimation (
+	    &g_spectrum_tap, analyzer_ready ? config.decimation : 0);
+	  router_spectrum_tap_read (&g_spectrum_tap, samples,
+				    ROUTER_SPECTRUM_RING_SIZE);
+	  router_spectrum_tap_collect_dropped (&g_spectrum_tap);
+	  if (!analyzer_ready)
+	    {
+	      ROUTER_LOG_INFO ("[Router 频谱] 无法创建分析器 (%u 点 @ %u Hz)",
+			       config.fft_size, rate);
+	      continue;
+	    }
+	  ROUTER_LOG_INFO ("[Router 频谱] 开始分析 | %u 点 | %u 频带 | %u Hz | "
+			   "%u 帧/秒",
+			   config.fft_size, config.band_count, rate,
+			   config.fps);
+	}
+
+      uint32_t count = router_spectrum_tap_read (&g_spectrum_tap, samples,
+						 ROUTER_SPECTRUM_RING_SIZE);
+      router_spectrum_analyzer_push (&analyzer, samples, count);
+      router_spectrum_analyzer_compute (&analyzer, bands);
+      memcpy (frame.bands, bands, config.band_count * sizeof (float));
+      frame.sequence = sequence++;
+      frame.sample_rate = rate;
+      frame.fft_size = config.fft_size;
+      frame.band_count = config.band_count;
+      frame.reserved = 0;
+      frame.min_freq = ROUTER_SPECTRUM_MIN_FREQ;
+      frame.max_freq = analyzer.max_freq;
+      ipc_async_client_request (&ipc_client, kIPCCommandPublishSpectrum,
+				&frame,
+				(uint32_t) (IPC_SPECTRUM_FRAME_HEADER_SIZE
+					    + config.band_count
+						* sizeof (float)),
+				spectrum_publish_response_callback, NULL, NULL);
+
+      uint32_t dropped = router_spectrum_tap_collect_dropped (&g_spectrum_tap);
+      if (dropped > 0)
+	ROUTER_LOG_INFO ("[Router 频谱] 分析跟不上，丢弃 %u 块", dropped);
+    }
+
+  router_spectrum_tap_set_decimation (&g_spectrum_tap, 0);
+  if (analyzer_ready)
+    router_spectrum_analyzer_destroy (&analyzer);
+  if (ipc_client_ready)
+    ipc_async_client_cleanup (&ipc_client);
+  atomic_store (&g_spectrum_listeners, 0);
+  return NULL;
+}
+
+// 启动频谱线程（无订阅者时只做周期性询问）
+static void
+start_spectrum_thread (void)
+{
+  pthread_mutex_lock (&g_spectrum_mutex);
+  g_spectrum_running = true;
+  pthread_mutex_unlock (&g_spectrum_mutex);
+
+  if (pthread_create (&g_spectrum_thread, NULL, spectrum_thread_func, NULL)
+      != 0)
+    {
+      fprintf (stderr, "[AudioRouter] Warning: 无法创建频谱线程\n");
+      pthread_mutex_lock (&g_spectrum_mutex);
+      g_spectrum_running = false;
+      pthread_mutex_unlock (&g_spectrum_mutex);
+      g_spectrum_thread = 0;
+    }
+}
+
+// 停止频谱线程
+static void
+stop_spectrum_thread (void)
+{
+  pthread_mutex_lock (&g_spectrum_mutex);
+  g_spectrum_running = false;
+  pthread_cond_broadcast (&g_spectrum_cond);
+  pthread_mutex_unlock (&g_spectrum_mutex);
+
+  if (g_spectrum_thread != 0)
+    {
+      pthread_join (g_spectrum_thread, NULL);
+      g_spectrum_thread = 0;
+    }
+}
+
+// ====== 推流线程 ======
+
+static void *
+stream_thread_func (void *arg)
+{
+  (void) arg;
+
+  ROUTER_LOG_INFO ("[Router 推流] 推流线程启动");
+  do
+    router_rtp_sender_pump (&g_rtp_sender);
+  while (thread_wait (&g_stream_mutex, &g_stream_cond, &g_stream_running,
+		      g_stream_pump_ms));
+  ROUTER_LOG_INFO ("[Router 推流] 推流线程停止");
+  return NULL;
+}
+
+// 启动推流线程（发送端已打开）
+static void
+start_stream_thread (void)
+{
+  pthread_mutex_lock (&g_stream_mutex);
+  g_stream_running = true;
+  pthread_mutex_unlock (&g_stream_mutex);
+
+  if (pthread_create (&g_stream_thread, NULL, stream_thread_func, NULL) != 0)
+    {
+      fprintf (stderr, "[AudioRouter] Warning: 无法创建推流线程\n");
+      pthread_mutex_lock (&g_stream_mutex);
+      g_stream_running = false;
+      pthread_mutex_unlock (&g_stream_mutex);
+      g_stream_thread = 0;
+    }
+}
+
+// 停止推流线程（未运行时什么也不做）
+static void
+stop_stream_thread (void)
+{
+  pthread_mutex_lock (&g_stream_mutex);
+  g_stream_running = false;
+  pthread_cond_broadcast (&g_stream_cond);
+  pthread_mutex_unlock (&g_stream_mutex);
+
+  if (g_stream_thread != 0)
+    {
+      pthread_join (g_stream_thread, NULL);
+      g_stream_thread = 0;
+    }
+}
+
+// ====== 追踪导出线程 ======
+
+// 主机时间转换为相对追踪起点的微秒数
+static double
+trace_time_us (uint64_t host_time)
+{
+  if (host_time < g_trace_base_time)
+    return 0.0;
+  return host_delta_to_ns (host_time - g_trace_base_time) / 1000.0;
+}
+
+// 把一个事件写成 Chrome trace JSON（tid 1 为输入 IOProc，2 为输出 IOProc）
+static void
+trace_write_event (FILE *fp, const RouterTraceEvent *event, int tid)
+{
+  double ts = trace_time_us (event->host_time);
+
+  switch (event->type)
+    {
+    case kRouterTraceInputCallback:
+    case kRouterTraceOutputCallback:
+      fprintf (fp,
+	       ",\n{\"name\":\"%s\",\"cat\":\"ioproc\",\"ph\":\"X\","
+	       "\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,"
+	       "\"args\":{\"frames\":%u,\"fill_frames\":%u}}",
+	       event->type == kRouterTraceInputCallback ? "input" : "output",
+	       (int) getpid (), tid, ts, event->duration_ns / 1000.0,
+	       event->frames, event->fill_frames);
+      // 缓冲区水位以计数器轨道显示
+      fprintf (fp,
+	       ",\n{\"name\":\"ring_fill\",\"ph\":\"C\",\"pid\":%d,"
+	       "\"ts\":%.3f,\"args\":{\"frames\":%u}}",
+	       (int) getpid (), ts, event->fill_frames);
+      break;
+    case kRouterTraceOverrun:
+    case kRouterTraceUnderrun:
+      fprintf (fp,
+	       ",\n{\"name\":\"%s\",\"cat\":\"xrun\",\"ph\":\"i\","
+	       "\"s\":\"g\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,"
+	       "\"args\":{\"frames\":%u,\"fill_frames\":%u}}",
+	       event->type == kRouterTraceOverrun ? "overrun" : "underrun",
+	       (int) getpid (), tid, ts, event->frames, event->fill_frames);
+      break;
+    case kRouterTraceLoadOverrun:
+      fprintf (fp,
+	       ",\n{\"name\":\"load_overrun\",\"cat\":\"load\","
+	       "\"ph\":\"i\",\"s\":\"t\",\"pid\":%d,\"tid\":%d,"
+	       "\"ts\":%.3f,\"args\":{\"frames\":%u,\"duration_us\":%.3f}}",
+	       (int) getpid (), tid, ts, event->frames,
+	       event->duration_ns / 1000.0);
+      break;
+    default:
+      break;
+    }
+}
+
+// 导出一个事件环中的全部事件
+static void
+trace_drain_ring (FILE *fp, RouterTraceRing *ring, int tid)
+{
+  uint64_t tail = atomic_load_explicit (&ring->tail, memory_order_relaxed);
+  uint64_t head = atomic_load_explicit (&ring->head, memory_order_acquire);
+
+  for (; tail < head; tail++)
+    {
+      RouterTraceEvent event
+	= ring->events[tail & (ROUTER_TRACE_EVENTS - 1)];
+      // 先复制再推进 tail，槽位释放后才可能被 IOProc 覆盖
+      atomic_store_explicit (&ring->tail, tail + 1, memory_order_release);
+      trace_write_event (fp, &event, tid);
+    }
+
+  uint64_t dropped
+    = atomic_exchange_explicit (&ring->dropped, 0, memory_order_relaxed);
+  if (dropped > 0)
+    fprintf (fp,
+	     ",\n{\"name\":\"trace_dropped\",\"cat\":\"trace\","
+	     "\"ph\":\"i\",\"s\":\"t\",\"pid\":%d,\"tid\":%d,"
+	     "\"ts\":%.3f,\"args\":{\"events\":%llu}}",
+	     (int) getpid (), tid, trace_time_us (mach_absolute_time ()),
+	     (unsigned long long) dropped);
+}
+
+static void
+trace_drain (void)
+{
+  trace_drain_ring (g_trace_file, g_trace_input_ring, 1);
+  trace_drain_ring (g_trace_file, g_trace_output_ring, 2);
+  fflush (g_trace_file);
+}
+
+static void *
+trace_thread_func (void *arg)
+{
+  (void) arg;
+
+  // 停止时最后再导出一次，保证 IO 停止前的事件全部写盘
+  bool running = true;
+  while (running)
+    {
+      running = thread_wait (&g_trace_mutex, &g_trace_cond, &g_trace_running,
+			     ROUTER_TRACE_DRAIN_INTERVAL_MS);
+      trace_drain ();
+    }
+  return NULL;
+}
+
+// 打开追踪文件并启动导出线程（未设置追踪文件时什么也不做）
+static void
+start_trace (void)
+{
+  if (g_trace_path[0] == '\0')
+    return;
+
+  g_trace_file = fopen (g_trace_path, "w");
+  if (g_trace_file == NULL)
+    {
+      fprintf (stderr, "⚠️ 无法创建追踪文件 %s，追踪已禁用\n", g_trace_path);
+      return;
+    }
+
+  // Chrome trace 数组格式：第一条之后的事件都以 ",\n" 开头
+  fprintf (g_trace_file,
+	   "[\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,"
+	   "\"args\":{\"name\":\"audioctl router\"}},\n"
+	   "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":1,"
+	   "\"args\":{\"name\":\"input IOProc\"}},\n"
+	   "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":2,"
+	   "\"args\":{\"name\":\"output IOProc\"}}",
+	   (int) getpid (), (int) getpid (), (int) getpid ());
+
+  RouterTraceRing *rings[] = {g_trace_input_ring, g_trace_output_ring};
+  for (size_t i = 0; i < sizeof (rings) / sizeof (rings[0]); i++)
+    {
+      atomic_store (&rings[i]->head, 0);
+      atomic_store (&rings[i]->tail, 0);
+      atomic_store (&rings[i]->dropped, 0);
+    }
+  g_trace_base_time = mach_absolute_time ();
+
+  pthread_mutex_lock (&g_trace_mutex);
+  g_trace_running = true;
+  pthread_mutex_unlock (&g_trace_mutex);
+
+  if (pthread_create (&g_trace_thread, NULL, trace_thread_func, NULL) != 0)
+    {
+      fprintf (stderr, "[AudioRouter] Warning: 无法创建追踪导出线程\n");
+      pthread_mutex_lock (&g_trace_mutex);
+      g_trace_running = false;
+      pthread_mutex_unlock (&g_trace_mutex);
+      g_trace_thread = 0;
+      fclose (g_trace_file);
+      g_trace_file = NULL;
+      return;
+    }
+
+  atomic_store (&g_trace_enabled, true);
+  ROUTER_LOG_INFO ("追踪: 实时事件写入 %s", g_trace_path);
+}
+
+// 停止追踪：关闭记录、等导出线程写完剩余事件后关闭文件
+static void
+stop_trace (void)
+{
+  atomic_store (&g_trace_enabled, false);
+
+  pthread_mutex_lock (&g_trace_mutex);
+  g_trace_running = false;
+  pthread_cond_broadcast (&g_trace_cond);
+  pthread_mutex_unlock (&g_trace_mutex);
+
+  if (g_trace_thread != 0)
+    {
+      pthread_join (g_trace_thread, NULL);
+      g_trace_thread = 0;
+    }
+
+  if (g_trace_file != NULL)
+    {
+      fprintf (g_trace_file, "\n]\n");
+      fclose (g_trace_file);
+      g_trace_file = NULL;
+    }
+}
+
+void
+audio_router_set_trace_file (const char *path)
+{
+  if (path == NULL)
+    g_trace_path[0] = '\0';
+  else
+    snprintf (g_trace_path, sizeof (g_trace_path), "%s", path);
+}
+
+void
+audio_router_set_load_threshold (uint32_t percent)
+{
+  if (percent < 1)
+    percent = 1;
+  if (percent > 100)
+    percent = 100;
+  atomic_store (&g_load_threshold_permille, percent * 10);
+}
+
+int
+audio_router_set_dsp_chain (RouterDspProcessor *const *processors,
+			    uint32_t count)
+{
+  return router_dsp_host_set_chain (dsp_host (), processors, count);
+}
+
+int
+audio_router_set_dsp_bypass (uint32_t index, bool bypass)
+{
+  return router_dsp_host_set_bypass (dsp_host (), index, bypass);
+}
+
+int
+audio_router_set_limiter (float lookahead_ms, float release_ms,
+			  float ceiling_db)
+{
+  dsp_host ();
+  RouterLimiterParams params = {lookahead_ms, release_ms, ceiling_db};
+  if (router_limiter_set_params (&g_limiter, &params) != 0)
+    return -1;
+  ROUTER_LOG_INFO ("[Router Limiter] 预读:%.1fms | 释放:%.0fms | "
+		   "上限:%.1f dBTP",
+		   lookahead_ms, release_ms, ceiling_db);
+  return 0;
+}
+
+void
+audio_router_get_loudness (RouterLoudnessReading *reading)
+{
+  dsp_host ();
+  router_loudness_read (&g_loudness, reading);
+}
+
+void
+audio_router_set_idle_timeout (uint32_t timeout_ms)
+{
+  atomic_store (&g_idle_timeout_ms, timeout_ms);
+}
+
+void
+audio_router_set_integer_output (bool enable)
+{
+  atomic_store (&g_integer_output, enable);
+}
+
+int
+audio_router_set_dither (RouterDitherMode mode)
+{
+  if (!(mode >= kRouterDitherOff && mode < kRouterDitherModeCount))
+    return -1;
+  g_dither_mode = mode;
+  return 0;
+}
+
+void
+audio_router_set_monitor_interval (uint32_t interval_ms)
+{
+  if (interval_ms < ROUTER_MONITOR_MIN_INTERVAL_MS)
+    interval_ms = ROUTER_MONITOR_MIN_INTERVAL_MS;
+  atomic_store (&g_monitor_interval_ms, interval_ms);
+}
+
+uint32_t
+audio_router_get_stats_history (IPCRouterStatsSnapshot *snapshots,
+				uint32_t max_snapshots)
+{
+  if (snapshots == NULL || max_snapshots == 0)
+    return 0;
+
+  uint64_t published
+    = atomic_load_explicit (&g_stats_ring.published, memory_order_acquire);
+  uint64_t available
+    = published < ROUTER_STATS_HISTORY ? published : ROUTER_STATS_HISTORY;
+  if (available > max_snapshots)
+    available = max_snapshots;
+
+  uint32_t count = 0;
+  for (uint64_t index = published - available; index < published; index++)
+    {
+      const RouterStatsSlot *slot
+	= &g_stats_ring.slots[index % ROUTER_STATS_HISTORY];
+      uint32_t before
+	= atomic_load_explicit (&slot->sequence, memory_order_acquire);
+      if (before & 1u)
+	continue; // 正在写入
+
+      IPCRouterStatsSnapshot copy = slot->snapshot;
+      atomic_thread_fence (memory_order_acquire);
+      uint32_t after
+	= atomic_load_explicit (&slot->sequence, memory_order_relaxed);
+      if (before != after)
+	continue; // 读取期间被覆盖
+
+      snapshots[count++] = copy;
+    }
+  return count;
+}
+
 // ====== 公共 API 实现 ======
 
 bool
@@ -141,9 +141,14 @@ get_support_directory (char *path, size_t path_size)
       return -1;
     }
 
+#ifdef __APPLE__
   // 构建路径: ~/Library/Application Support/audioctl/
   int written = snprintf (path, path_size,
 			  "%s/Library/Application Support/audioctl", home);
+#else
+  // 其他平台（Linux 压测/CI）没有 ~/Library，使用单层目录 ~/.audioctl/
+  int written = snprintf (path, path_size, "%s/.audioctl", home);
+#endif
   if (written < 0 || (size_t) written >= path_size)
     {
       fprintf (stderr, "错误: 路径缓冲区太小\n");
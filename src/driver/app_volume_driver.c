@@ -2,48 +2,717 @@
 // Driver-side per-app volume control
 // Created by AhogeK on 02/05/26.
 //
-// Uses IPC client with local cache for real-time audio processing
+// IPC 连接由后台连接管理线程负责（连接、退避重连、重新注册、音量同步），
+// 实时 IO 线程只读取原子连接标志和已发布的每客户端音量，并为每个客户端
+// 测量响度，读数由连接管理线程定期上报。启用响度均衡时，IO 线程按各
+// 客户端的短期响度每块更新一次自动增益，叠加在音量之上；启用闪避时，
+// 人声应用的瞬时响度触发媒体应用的衰减，闪避增益并入同一个增益斜坡。
+// 增益之后按各应用的声道混合规则施加 2×2 矩阵（平衡、声像、单声道、互换）
 
 #include "driver/app_volume_driver.h"
+#include <math.h>
 #include <os/lock.h>
+#include <pthread.h>
 #include <stdatomic.h>
-#include <sys/time.h>
-#include "ipc/ipc_client.h"
-
-// Cache TTL in milliseconds, must match ipc_client.c
-#define IPC_CACHE_TTL_MS 100
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "ipc/ipc_async_client.h"
+#include "router/router_agc.h"
+#include "router/router_duck.h"
+#include "router/router_loudness.h"
+#include "router/router_matrix.h"
+#include "router/router_pipeline.h"
+
+// 连接管理线程参数
+#define MANAGER_BACKOFF_MIN_MS 100     // 首次重连等待
+#define MANAGER_BACKOFF_MAX_MS 5000    // 最大重连等待
+#define MANAGER_RESYNC_INTERVAL_MS 1000 // 周期性全量音量同步间隔
+#define MANAGER_REQUEST_TIMEOUT_MS 1000 // 单个请求超时
+
+// 响度测量格式（与虚拟设备固定的 48kHz 交错立体声一致）
+#define METER_SAMPLE_RATE 48000
+#define METER_CHANNELS 2
 
 // Client entry structure
+// 原子字段由 IO 线程无锁读取；写入方在 g_clientLock 保护下串行修改
 typedef struct
 {
-  UInt32 clientID;
-  pid_t pid;
-  bool active;
+  _Atomic UInt32 clientID;
+  _Atomic pid_t pid;
+  atomic_bool active;
+  _Atomic Float32 volume;  // 已发布的音量（IO 线程读取）
+  atomic_bool muted;	   // 已发布的静音状态
+  _Atomic uint8_t duckRole; // 闪避角色 (IPCDuckingRole)
+  _Atomic uint64_t mixWord; // 打包的声道混合规则（见 pack_mix_rule）
+  atomic_bool slotReset;   // 槽位刚分配，IO 线程在下一块复位闪避和声道矩阵
+  bool registered;	   // 是否已向服务端注册（仅在锁内访问）
+  char name[128];	   // 注册使用的应用名称（仅在锁内访问）
+  char bundleId[128];	   // Bundle ID，可能为空（仅在锁内访问）
 } ClientEntry;
 
 #define MAX_CLIENTS 64U
 
 static ClientEntry g_clients[MAX_CLIENTS];
+
+// 每个客户端槽位的响度计（只由 IO 线程更新；槽位分配给新客户端时请求重置）
+static RouterLoudness g_meters[MAX_CLIENTS];
+
+// 响度均衡：参数由连接管理线程从服务端同步，增益按客户端槽位独立维护
+static RouterAgcControl g_agcControl;
+static RouterAgc g_agc[MAX_CLIENTS];
+
+_Static_assert (ROUTER_AGC_MIN_TARGET_LUFS == IPC_NORMALIZER_MIN_TARGET_LUFS
+		  && ROUTER_AGC_MAX_TARGET_LUFS
+		       == IPC_NORMALIZER_MAX_TARGET_LUFS
+		  && ROUTER_AGC_MAX_BOOST_DB == IPC_NORMALIZER_MAX_BOOST_DB
+		  && ROUTER_AGC_MAX_CUT_DB == IPC_NORMALIZER_MAX_CUT_DB
+		  && ROUTER_AGC_MIN_RATE_DB == IPC_NORMALIZER_MIN_RATE_DB
+		  && ROUTER_AGC_MAX_RATE_DB == IPC_NORMALIZER_MAX_RATE_DB,
+		"router and IPC normalizer ranges must match");
+
+// 闪避：参数和人声活动由所有客户端共享，增益按客户端槽位独立维护；
+// 规则副本用于给新客户端匹配角色（在 g_clientLock 保护下访问）
+static RouterDuckControl g_duckControl;
+static RouterDuck g_duck[MAX_CLIENTS];
+static IPCDuckingConfig g_duckConfig;
+
+_Static_assert (ROUTER_DUCK_MAX_DEPTH_DB == IPC_DUCKING_MAX_DEPTH_DB
+		  && ROUTER_DUCK_MIN_THRESHOLD_LUFS
+		       == IPC_DUCKING_MIN_THRESHOLD_LUFS
+		  && ROUTER_DUCK_MAX_THRESHOLD_LUFS
+		       == IPC_DUCKING_MAX_THRESHOLD_LUFS
+		  && ROUTER_DUCK_MIN_RAMP_MS == IPC_DUCKING_MIN_RAMP_MS
+		  && ROUTER_DUCK_MAX_TIME_MS == IPC_DUCKING_MAX_TIME_MS,
+		"router and IPC ducking ranges must match");
+
+// 声道矩阵：规则表副本用于给新客户端匹配规则（在 g_clientLock 保护下访问），
+// 各槽位当前使用的矩阵只由 IO 线程访问
+typedef struct
+{
+  uint64_t word;       // 矩阵对应的打包规则
+  RouterMatrix matrix; // 当前矩阵
+} SlotMix;
+
+static IPCChannelMixConfig g_mixConfig;
+static SlotMix g_mix[MAX_CLIENTS];
+
+// 规则打包为一个 64 位字，IO 线程一次原子读取即可得到完整规则：
+// 位 0-15 平衡、16-31 声像（× MIX_SCALE 的有符号整数），32-39 标志。
+// 中性规则打包为 0
+#define MIX_SCALE 10000.0f
 static os_unfair_lock g_clientLock = OS_UNFAIR_LOCK_INIT;
 static atomic_int g_clientCount = 0;
 
+// 待注销的 PID（在 g_clientLock 保护下访问）：服务端处理完才移除，
+// 发送失败、超时或断开时保留，下一轮重发
+typedef struct
+{
+  pid_t pid;
+  bool inFlight; // 已发出、等待完成
+} PendingUnregister;
+static PendingUnregister g_pendingUnregister[MAX_CLIENTS];
+static UInt32 g_pendingUnregisterCount = 0;
+
 static bool g_initialized = false;
 
-// IPC client context (for fetching volume from server)
-static IPCClientContext g_ipcClient = {0};
+// IPC 客户端（仅连接管理线程和客户端 IO 线程使用）
+static IPCAsyncClient g_ipcClient;
 static bool g_ipcInitialized = false;
+static atomic_bool g_ipcConnected = false;
+
+// 连接管理线程
+static pthread_t g_managerThread;
+static pthread_mutex_t g_managerMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_managerCond = PTHREAD_COND_INITIALIZER;
+static bool g_managerRunning = false;
+static bool g_managerStarted = false;
+static bool g_managerDirty = false; // 客户端列表有变化
 
 // Local volume table (IPC cache)
 static AppVolumeTable g_volumeTable = {0};
 static os_unfair_lock g_tableLock = OS_UNFAIR_LOCK_INIT;
 
-// Timestamp function for real-time audio path
+#pragma mark - Channel Mix
+
+static uint64_t
+pack_mix_rule (const IPCChannelMixRule *rule)
+{
+  if (rule == NULL)
+    return 0;
+  int16_t balance = (int16_t) lrintf (rule->balance * MIX_SCALE);
+  int16_t pan = (int16_t) lrintf (rule->pan * MIX_SCALE);
+  return (uint64_t) (uint16_t) balance | (uint64_t) (uint16_t) pan << 16
+	 | (uint64_t) rule->flags << 32;
+}
+
+// 由打包规则生成矩阵（规则已在服务端和打包前校验过）
+static void
+build_mix_matrix (uint64_t word, RouterMatrix *matrix)
+{
+  RouterStereoMix mix = {
+    .balance = (float) (int16_t) (word & 0xFFFF) / MIX_SCALE,
+    .pan = (float) (int16_t) ((word >> 16) & 0xFFFF) / MIX_SCALE,
+    .mono = ((word >> 32) & kIPCChannelMixMono) != 0,
+    .swap = ((word >> 32) & kIPCChannelMixSwap) != 0,
+  };
+  if (router_matrix_from_stereo (matrix, &mix) != 0)
+    router_matrix_init (matrix, METER_CHANNELS, METER_CHANNELS);
+}
+
+// 按规则表为客户端匹配规则（调用者持有 g_clientLock）
 static uint64_t
-get_timestamp_ms (void)
+match_mix_word (const ClientEntry *entry)
 {
-  struct timeval tv;
-  gettimeofday (&tv, NULL);
-  return (uint64_t) tv.tv_sec * 1000 + tv.tv_usec / 1000;
+  return pack_mix_rule (ipc_channel_mix_config_find (
+    &g_mixConfig, entry->bundleId[0] ? entry->bundleId : NULL, entry->name));
+}
+
+#pragma mark - Connection Manager
+
+// 唤醒连接管理线程处理客户端变化
+static void
+manager_signal (void)
+{
+  pthread_mutex_lock (&g_managerMutex);
+  g_managerDirty = true;
+  pthread_cond_signal (&g_managerCond);
+  pthread_mutex_unlock (&g_managerMutex);
+}
+
+// 等待指定时间，或直到客户端列表变化/线程停止
+// 返回 false 表示线程应当退出
+static bool
+manager_wait (uint32_t timeout_ms)
+{
+  struct timespec deadline;
+  clock_gettime (CLOCK_REALTIME, &deadline);
+  deadline.tv_sec += timeout_ms / 1000;
+  deadline.tv_nsec += (long) (timeout_ms % 1000) * 1000000L;
+  if (deadline.tv_nsec >= 1000000000L)
+    {
+      deadline.tv_sec++;
+      deadline.tv_nsec -= 1000000000L;
+    }
+
+  pthread_mutex_lock (&g_managerMutex);
+  while (g_managerRunning && !g_managerDirty)
+    {
+      if (pthread_cond_timedwait (&g_managerCond, &g_managerMutex, &deadline)
+	  != 0)
+	break;
+    }
+  g_managerDirty = false;
+  bool running = g_managerRunning;
+  pthread_mutex_unlock (&g_managerMutex);
+
+  return running;
+}
+
+// 把服务端音量发布到该 PID 的所有客户端槽位
+static void
+publish_volume (pid_t pid, float volume, bool muted)
+{
+  for (UInt32 i = 0; i < MAX_CLIENTS; i++)
+    {
+      ClientEntry *entry = &g_clients[i];
+      if (atomic_load_explicit (&entry->active, memory_order_acquire)
+	  && atomic_load_explicit (&entry->pid, memory_order_relaxed) == pid)
+	{
+	  atomic_store_explicit (&entry->volume, volume, memory_order_relaxed);
+	  atomic_store_explicit (&entry->muted, muted, memory_order_relaxed);
+	}
+    }
+}
+
+// 发布服务端的响度均衡配置（无效配置忽略，保持原参数）
+static void
+apply_normalizer_config (const void *data, uint32_t data_len)
+{
+  if (data == NULL || data_len < sizeof (IPCNormalizerConfig))
+    return;
+
+  IPCNormalizerConfig config;
+  memcpy (&config, data, sizeof (config));
+  RouterAgcParams params = {
+    .enabled = config.enabled != 0,
+    .target_lufs = config.target_lufs,
+    .max_boost_db = config.max_boost_db,
+    .max_cut_db = config.max_cut_db,
+    .attack_db_per_s = config.attack_db_per_s,
+    .release_db_per_s = config.release_db_per_s,
+  };
+  router_agc_set_params (&g_agcControl, &params);
+}
+
+// 发布服务端的闪避规则：重新匹配所有客户端的角色，再更新参数
+static void
+apply_ducking_config (const void *data, uint32_t data_len)
+{
+  if (data == NULL || data_len < sizeof (IPCDuckingConfig))
+    return;
+
+  IPCDuckingConfig config;
+  memcpy (&config, data, sizeof (config));
+  if (!ipc_ducking_config_is_valid (&config))
+    return;
+
+  os_unfair_lock_lock (&g_clientLock);
+  g_duckConfig = config;
+  for (UInt32 i = 0; i < MAX_CLIENTS; i++)
+    {
+      ClientEntry *entry = &g_clients[i];
+      if (!atomic_load (&entry->active))
+	continue;
+      IPCDuckingRole role = ipc_ducking_config_role (
+	&g_duckConfig, entry->bundleId[0] ? entry->bundleId : NULL,
+	entry->name);
+      atomic_store (&entry->duckRole, (uint8_t) role);
+    }
+  os_unfair_lock_unlock (&g_clientLock);
+
+  RouterDuckParams params = {
+    .enabled = config.enabled != 0,
+    .depth_db = config.depth_db,
+    .threshold_lufs = config.threshold_lufs,
+    .attack_ms = config.attack_ms,
+    .hold_ms = config.hold_ms,
+    .release_ms = config.release_ms,
+  };
+  router_duck_set_params (&g_duckControl, &params);
+}
+
+// 发布服务端的声道混合规则：重新匹配所有客户端，IO 线程在下一块过渡
+static void
+apply_channel_mix_config (const void *data, uint32_t data_len)
+{
+  if (data == NULL || data_len < sizeof (IPCChannelMixConfig))
+    return;
+
+  IPCChannelMixConfig config;
+  memcpy (&config, data, sizeof (config));
+  if (!ipc_channel_mix_config_is_valid (&config))
+    return;
+
+  os_unfair_lock_lock (&g_clientLock);
+  g_mixConfig = config;
+  for (UInt32 i = 0; i < MAX_CLIENTS; i++)
+    {
+      ClientEntry *entry = &g_clients[i];
+      if (atomic_load (&entry->active))
+	atomic_store (&entry->mixWord, match_mix_word (entry));
+    }
+  os_unfair_lock_unlock (&g_clientLock);
+}
+
+// 订阅事件（在 IPC 客户端 IO 线程中调用）：音量变更、响度均衡配置变更、
+// 闪避规则变更、声道混合规则变更
+static void
+on_ipc_event (void *user_data, uint32_t topic, const void *data,
+	      uint32_t data_len)
+{
+  (void) user_data;
+  if (topic == kIPCEventTopicChannelMix)
+    {
+      apply_channel_mix_config (data, data_len);
+      return;
+    }
+  if (topic == kIPCEventTopicNormalizer)
+    {
+      apply_normalizer_config (data, data_len);
+      return;
+    }
+  if (topic == kIPCEventTopicDucking)
+    {
+      apply_ducking_config (data, data_len);
+      return;
+    }
+  if (topic != kIPCEventTopicVolume || data_len < sizeof (IPCVolumeEvent))
+    return;
+
+  IPCVolumeEvent event;
+  memcpy (&event, data, sizeof (event));
+  publish_volume (event.pid, event.volume, event.muted);
+}
+
+// 响度均衡配置查询完成
+static void
+on_normalizer_response (void *user_data, int32_t status, const void *data,
+			uint32_t data_len)
+{
+  (void) user_data;
+  if (status == kIPCStatusOK)
+    apply_normalizer_config (data, data_len);
+}
+
+// 闪避规则查询完成
+static void
+on_ducking_response (void *user_data, int32_t status, const void *data,
+		     uint32_t data_len)
+{
+  (void) user_data;
+  if (status == kIPCStatusOK)
+    apply_ducking_config (data, data_len);
+}
+
+// 声道混合规则查询完成
+static void
+on_channel_mix_response (void *user_data, int32_t status, const void *data,
+			 uint32_t data_len)
+{
+  (void) user_data;
+  if (status == kIPCStatusOK)
+    apply_channel_mix_config (data, data_len);
+}
+
+// 音量查询完成
+static void
+on_volume_response (void *user_data, int32_t status, const void *data,
+		    uint32_t data_len)
+{
+  if (status != kIPCStatusOK || data_len < sizeof (IPCVolumeResponse))
+    return;
+
+  IPCVolumeResponse resp;
+  memcpy (&resp, data, sizeof (resp));
+  if (resp.status == kIPCStatusOK)
+    publish_volume ((pid_t) (intptr_t) user_data, resp.volume, resp.muted);
+}
+
+// 注册完成：服务端已存在该应用时也视为已注册，只有连接失败才需要重试
+static void
+on_register_complete (void *user_data, int32_t status, const void *data,
+		      uint32_t data_len)
+{
+  (void) data;
+  (void) data_len;
+  if (status != kIPCStatusServiceUnavailable)
+    return;
+
+  pid_t pid = (pid_t) (intptr_t) user_data;
+  os_unfair_lock_lock (&g_clientLock);
+  for (UInt32 i = 0; i < MAX_CLIENTS; i++)
+    {
+      if (atomic_load (&g_clients[i].active)
+	  && atomic_load (&g_clients[i].pid) == pid)
+	g_clients[i].registered = false;
+    }
+  os_unfair_lock_unlock (&g_clientLock);
+}
+
+// 该 PID 是否还有活动客户端（调用者持有 g_clientLock）
+static bool
+pid_is_active_locked (pid_t pid)
+{
+  for (UInt32 i = 0; i < MAX_CLIENTS; i++)
+    {
+      if (atomic_load (&g_clients[i].active)
+	  && atomic_load (&g_clients[i].pid) == pid)
+	return true;
+    }
+  return false;
+}
+
+// 移除第 index 个待注销项（调用者持有 g_clientLock）
+static void
+remove_pending_unregister_locked (UInt32 index)
+{
+  g_pendingUnregister[index]
+    = g_pendingUnregister[--g_pendingUnregisterCount];
+}
+
+// 注销完成：服务端已处理（包括找不到该应用）即移除；连接失败时留在队列中
+// 重发，期间该进程重新出现则直接移除，不再注销
+static void
+on_unregister_complete (void *user_data, int32_t status, const void *data,
+			uint32_t data_len)
+{
+  (void) data;
+  (void) data_len;
+
+  pid_t pid = (pid_t) (intptr_t) user_data;
+  os_unfair_lock_lock (&g_clientLock);
+  for (UInt32 i = 0; i < g_pendingUnregisterCount; i++)
+    {
+      PendingUnregister *item = &g_pendingUnregister[i];
+      if (item->pid != pid || !item->inFlight)
+	continue;
+      if (status == kIPCStatusServiceUnavailable && !pid_is_active_locked (pid))
+	item->inFlight = false;
+      else
+	remove_pending_unregister_locked (i);
+      break;
+    }
+  os_unfair_lock_unlock (&g_clientLock);
+}
+
+// 提交待注销和待注册请求
+// 返回本轮是否提交了新的注册
+static bool
+submit_registrations (void)
+{
+  pid_t unregister[MAX_CLIENTS];
+  UInt32 unregisterCount = 0;
+
+  struct
+  {
+    pid_t pid;
+    char name[128];
+  } pending[MAX_CLIENTS];
+  UInt32 pendingCount = 0;
+
+  os_unfair_lock_lock (&g_clientLock);
+  for (UInt32 i = 0; i < g_pendingUnregisterCount;)
+    {
+      PendingUnregister *item = &g_pendingUnregister[i];
+      if (item->inFlight)
+	{
+	  i++;
+	  continue;
+	}
+      // 进程已重新出现：保留服务端注册，不再注销
+      if (pid_is_active_locked (item->pid))
+	{
+	  remove_pending_unregister_locked (i);
+	  continue;
+	}
+      item->inFlight = true;
+      unregister[unregisterCount++] = item->pid;
+      i++;
+    }
+
+  for (UInt32 i = 0; i < MAX_CLIENTS; i++)
+    {
+      ClientEntry *entry = &g_clients[i];
+      if (!atomic_load (&entry->active) || entry->registered)
+	continue;
+
+      // 同一进程的多个客户端只注册一次
+      pid_t pid = atomic_load (&entry->pid);
+      for (UInt32 j = 0; j < MAX_CLIENTS; j++)
+	{
+	  if (atomic_load (&g_clients[j].active)
+	      && atomic_load (&g_clients[j].pid) == pid)
+	    g_clients[j].registered = true;
+	}
+
+      pending[pendingCount].pid = pid;
+      memcpy (pending[pendingCount].name, entry->name,
+	      sizeof (pending[pendingCount].name));
+      pendingCount++;
+    }
+  os_unfair_lock_unlock (&g_clientLock);
+
+  for (UInt32 i = 0; i < unregisterCount; i++)
+    {
+      void *user_data = (void *) (intptr_t) unregister[i];
+      if (ipc_async_client_request (&g_ipcClient, kIPCCommandUnregister,
+				    &unregister[i], sizeof (pid_t),
+				    on_unregister_complete, user_data, NULL)
+	  != 0)
+	on_unregister_complete (user_data, kIPCStatusServiceUnavailable, NULL,
+				0);
+    }
+
+  for (UInt32 i = 0; i < pendingCount; i++)
+    {
+      uint8_t payload[sizeof (IPCRegisterRequest) + sizeof (pending[i].name)];
+      size_t nameLen = strlen (pending[i].name) + 1;
+
+      IPCRegisterRequest *req = (IPCRegisterRequest *) payload;
+      req->pid = pending[i].pid;
+      req->initial_volume = 1.0f;
+      req->muted = false;
+      memcpy (payload + sizeof (IPCRegisterRequest), pending[i].name, nameLen);
+
+      void *user_data = (void *) (intptr_t) pending[i].pid;
+      if (ipc_async_client_request (&g_ipcClient, kIPCCommandRegister,
+				    payload,
+				    (uint32_t) (sizeof (IPCRegisterRequest)
+						+ nameLen),
+				    on_register_complete, user_data, NULL)
+	  != 0)
+	on_register_complete (user_data, kIPCStatusServiceUnavailable, NULL, 0);
+    }
+
+  return pendingCount > 0;
+}
+
+// 为所有活动 PID 提交音量查询，结果在回调中发布
+static void
+submit_resync (void)
+{
+  pid_t pids[MAX_CLIENTS];
+  UInt32 count = 0;
+
+  os_unfair_lock_lock (&g_clientLock);
+  for (UInt32 i = 0; i < MAX_CLIENTS; i++)
+    {
+      if (!atomic_load (&g_clients[i].active))
+	continue;
+
+      pid_t pid = atomic_load (&g_clients[i].pid);
+      bool seen = false;
+      for (UInt32 j = 0; j < count; j++)
+	{
+	  if (pids[j] == pid)
+	    {
+	      seen = true;
+	      break;
+	    }
+	}
+      if (!seen)
+	pids[count++] = pid;
+    }
+  os_unfair_lock_unlock (&g_clientLock);
+
+  for (UInt32 i = 0; i < count; i++)
+    {
+      ipc_async_client_request (&g_ipcClient, kIPCCommandGetVolume, &pids[i],
+				sizeof (pid_t), on_volume_response,
+				(void *) (intptr_t) pids[i], NULL);
+    }
+}
+
+// 上报所有客户端的响度读数（整体替换服务端保存的应用读数）
+// 同一进程有多个客户端时取短期响度最高的一个
+static void
+submit_loudness (void)
+{
+  struct __attribute__ ((packed))
+  {
+    IPCLoudnessReport header;
+    IPCLoudnessEntry entries[MAX_CLIENTS];
+  } report;
+  memset (&report, 0, sizeof (report));
+
+  os_unfair_lock_lock (&g_clientLock);
+  for (UInt32 i = 0; i < MAX_CLIENTS; i++)
+    {
+      if (!atomic_load (&g_clients[i].active))
+	continue;
+
+      pid_t pid = atomic_load (&g_clients[i].pid);
+      RouterLoudnessReading reading;
+      router_loudness_read (&g_meters[i], &reading);
+
+      IPCLoudnessEntry *entry = NULL;
+      for (UInt32 j = 0; j < report.header.count; j++)
+	{
+	  if (report.entries[j].pid == pid)
+	    {
+	      entry = &report.entries[j];
+	      break;
+	    }
+	}
+      if (entry != NULL && entry->short_term_lufs >= reading.short_term_lufs)
+	continue;
+      if (entry == NULL)
+	entry = &report.entries[report.header.count++];
+
+      entry->pid = pid;
+      entry->momentary_lufs = reading.momentary_lufs;
+      entry->short_term_lufs = reading.short_term_lufs;
+      entry->integrated_lufs = reading.integrated_lufs;
+      entry->true_peak_dbtp = reading.true_peak_dbtp;
+      entry->agc_gain_db = router_agc_read_gain_db (&g_agc[i]);
+    }
+  os_unfair_lock_unlock (&g_clientLock);
+
+  ipc_async_client_request (&g_ipcClient, kIPCCommandPublishLoudness, &report,
+			    (uint32_t) (sizeof (report.header)
+					+ report.header.count
+					    * sizeof (IPCLoudnessEntry)),
+			    NULL, NULL, NULL);
+}
+
+// 连接断开后所有客户端都需要重新注册
+static void
+mark_all_unregistered (void)
+{
+  os_unfair_lock_lock (&g_clientLock);
+  for (UInt32 i = 0; i < MAX_CLIENTS; i++)
+    {
+      g_clients[i].registered = false;
+    }
+  os_unfair_lock_unlock (&g_clientLock);
+}
+
+static uint64_t
+monotonic_ns (void)
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+static uint64_t
+monotonic_ms (void)
+{
+  return monotonic_ns () / 1000000;
+}
+
+// 连接管理线程：低优先级，负责所有可能阻塞的 IPC 工作
+static void *
+connection_manager_thread_func (void *arg)
+{
+  (void) arg;
+  pthread_set_qos_class_self_np (QOS_CLASS_UTILITY, 0);
+
+  uint32_t backoff = MANAGER_BACKOFF_MIN_MS;
+  uint64_t lastResync = 0;
+
+  for (;;)
+    {
+      if (!ipc_async_client_is_connected (&g_ipcClient))
+	{
+	  if (atomic_exchange (&g_ipcConnected, false))
+	    mark_all_unregistered ();
+
+	  if (ipc_async_client_connect (&g_ipcClient) != 0)
+	    {
+	      if (!manager_wait (backoff))
+		break;
+	      backoff = backoff * 2 > MANAGER_BACKOFF_MAX_MS
+			  ? MANAGER_BACKOFF_MAX_MS
+			  : backoff * 2;
+	      continue;
+	    }
+
+	  backoff = MANAGER_BACKOFF_MIN_MS;
+	  ipc_async_client_subscribe (&g_ipcClient,
+				      kIPCEventTopicVolume
+					| kIPCEventTopicNormalizer
+					| kIPCEventTopicDucking
+					| kIPCEventTopicChannelMix,
+				      NULL, NULL);
+	  ipc_async_client_request (&g_ipcClient, kIPCCommandGetNormalizer,
+				    NULL, 0, on_normalizer_response, NULL,
+				    NULL);
+	  ipc_async_client_request (&g_ipcClient, kIPCCommandGetDucking, NULL,
+				    0, on_ducking_response, NULL, NULL);
+	  ipc_async_client_request (&g_ipcClient, kIPCCommandGetChannelMix,
+				    NULL, 0, on_channel_mix_response, NULL,
+				    NULL);
+	  atomic_store (&g_ipcConnected, true);
+	  lastResync = 0;
+	}
+
+      // 注册请求先于查询发出，服务端按顺序处理，新客户端能立即拿到音量
+      bool registered = submit_registrations ();
+      uint64_t now = monotonic_ms ();
+      if (registered || now - lastResync >= MANAGER_RESYNC_INTERVAL_MS)
+	{
+	  submit_resync ();
+	  submit_loudness ();
+	  lastResync = now;
+	}
+
+      if (!manager_wait (MANAGER_RESYNC_INTERVAL_MS))
+	break;
+    }
+
+  return NULL;
 }
 
 #pragma mark - Initialization and Cleanup
@@ -58,20 +727,49 @@ app_volume_driver_init (void)
 
   os_unfair_lock_lock (&g_clientLock);
   memset (g_clients, 0, sizeof (g_clients));
+  memset (&g_duckConfig, 0, sizeof (g_duckConfig));
+  ipc_channel_mix_config_init (&g_mixConfig);
+  g_pendingUnregisterCount = 0;
   atomic_store (&g_clientCount, 0);
   os_unfair_lock_unlock (&g_clientLock);
 
+  // IO 开始前准备好所有响度计、均衡和闪避增益（连接服务端之前两者保持关闭）
+  router_agc_control_init (&g_agcControl);
+  router_duck_control_init (&g_duckControl);
+  for (UInt32 i = 0; i < MAX_CLIENTS; i++)
+    {
+      router_loudness_init (&g_meters[i]);
+      router_loudness_prepare (&g_meters[i], METER_SAMPLE_RATE,
+			       METER_CHANNELS);
+      router_agc_init (&g_agc[i]);
+      router_duck_init (&g_duck[i]);
+      g_mix[i].word = 0;
+      router_matrix_init (&g_mix[i].matrix, METER_CHANNELS, METER_CHANNELS);
+    }
+
   os_unfair_lock_lock (&g_tableLock);
   memset (&g_volumeTable, 0, sizeof (g_volumeTable));
   os_unfair_lock_unlock (&g_tableLock);
 
-  // 初始化 IPC 客户端
-  if (!g_ipcInitialized)
+  // 初始化 IPC 客户端，连接由后台线程完成，不阻塞 coreaudiod
+  if (!g_ipcInitialized
+      && ipc_async_client_init (&g_ipcClient, on_ipc_event, NULL) == 0)
     {
-      ipc_client_init (&g_ipcClient);
-      // 尝试连接 IPC 服务
-      ipc_client_connect (&g_ipcClient);
+      ipc_async_client_set_timeout (&g_ipcClient, MANAGER_REQUEST_TIMEOUT_MS);
       g_ipcInitialized = true;
+
+      g_managerRunning = true;
+      g_managerDirty = false;
+      if (pthread_create (&g_managerThread, NULL,
+			  connection_manager_thread_func, NULL)
+	  == 0)
+	{
+	  g_managerStarted = true;
+	}
+      else
+	{
+	  g_managerRunning = false;
+	}
     }
 
   g_initialized = true;
@@ -85,36 +783,60 @@ app_volume_driver_cleanup (void)
       return;
     }
 
-  os_unfair_lock_lock (&g_clientLock);
-  memset (g_clients, 0, sizeof (g_clients));
-  atomic_store (&g_clientCount, 0);
-  os_unfair_lock_unlock (&g_clientLock);
+  // 先停止连接管理线程，再关闭 IPC 客户端
+  if (g_managerStarted)
+    {
+      pthread_mutex_lock (&g_managerMutex);
+      g_managerRunning = false;
+      pthread_cond_signal (&g_managerCond);
+      pthread_mutex_unlock (&g_managerMutex);
+      pthread_join (g_managerThread, NULL);
+      g_managerStarted = false;
+    }
 
-  // 清理 IPC 客户端
   if (g_ipcInitialized)
     {
-      ipc_client_disconnect (&g_ipcClient);
-      ipc_client_cleanup (&g_ipcClient);
+      ipc_async_client_cleanup (&g_ipcClient);
       g_ipcInitialized = false;
     }
+  atomic_store (&g_ipcConnected, false);
+
+  os_unfair_lock_lock (&g_clientLock);
+  memset (g_clients, 0, sizeof (g_clients));
+  g_pendingUnregisterCount = 0;
+  atomic_store (&g_clientCount, 0);
+  os_unfair_lock_unlock (&g_clientLock);
 
   g_initialized = false;
 }
 
+bool
+app_volume_driver_is_connected (void)
+{
+  return atomic_load_explicit (&g_ipcConnected, memory_order_acquire);
+}
+
 #pragma mark - Client Management
 
 OSStatus
 app_volume_driver_add_client (UInt32 clientID, pid_t pid, const char *bundleId,
 			      const char *name)
 {
+  const char *appName = name;
+  if (appName == NULL)
+    {
+      appName = bundleId ? bundleId : "Unknown";
+    }
+
   os_unfair_lock_lock (&g_clientLock);
 
   // 检查是否已存在
   for (UInt32 i = 0; i < MAX_CLIENTS; i++)
     {
-      if (g_clients[i].active && g_clients[i].clientID == clientID)
+      if (atomic_load (&g_clients[i].active)
+	  && atomic_load (&g_clients[i].clientID) == clientID)
 	{
-	  g_clients[i].pid = pid;
+	  atomic_store (&g_clients[i].pid, pid);
 	  os_unfair_lock_unlock (&g_clientLock);
 	  return noErr;
 	}
@@ -123,28 +845,48 @@ app_volume_driver_add_client (UInt32 clientID, pid_t pid, const char *bundleId,
   // 查找空槽
   for (UInt32 i = 0; i < MAX_CLIENTS; i++)
     {
-      if (g_clients[i].active)
+      ClientEntry *entry = &g_clients[i];
+      if (atomic_load (&entry->active))
 	{
 	  continue;
 	}
 
-      g_clients[i].clientID = clientID;
-      g_clients[i].pid = pid;
-      g_clients[i].active = true;
-      atomic_fetch_add (&g_clientCount, 1);
-      os_unfair_lock_unlock (&g_clientLock);
-
-      // 通过 IPC 注册到服务端
-      if (g_ipcInitialized && ipc_client_is_connected (&g_ipcClient))
+      atomic_store (&entry->clientID, clientID);
+      atomic_store (&entry->pid, pid);
+      atomic_store (&entry->volume, 1.0f);
+      atomic_store (&entry->muted, false);
+      entry->registered = false;
+      strncpy (entry->name, appName, sizeof (entry->name) - 1);
+      entry->name[sizeof (entry->name) - 1] = '\0';
+      snprintf (entry->bundleId, sizeof (entry->bundleId), "%s",
+		bundleId ? bundleId : "");
+      atomic_store (&entry->duckRole,
+		    (uint8_t) ipc_ducking_config_role (&g_duckConfig, bundleId,
+						       appName));
+      atomic_store (&entry->mixWord, match_mix_word (entry));
+      atomic_store (&entry->slotReset, true);
+      router_loudness_reset (&g_meters[i]);
+      router_agc_reset (&g_agc[i]);
+
+      // 同一进程已有客户端时沿用其已发布的音量
+      for (UInt32 j = 0; j < MAX_CLIENTS; j++)
 	{
-	  const char *appName = name;
-	  if (appName == NULL)
+	  if (atomic_load (&g_clients[j].active)
+	      && atomic_load (&g_clients[j].pid) == pid)
 	    {
-	      appName = bundleId ? bundleId : "Unknown";
+	      atomic_store (&entry->volume, atomic_load (&g_clients[j].volume));
+	      atomic_store (&entry->muted, atomic_load (&g_clients[j].muted));
+	      entry->registered = g_clients[j].registered;
+	      break;
 	    }
-	  ipc_client_register_app (&g_ipcClient, pid, appName, 1.0f, false);
 	}
 
+      atomic_store_explicit (&entry->active, true, memory_order_release);
+      atomic_fetch_add (&g_clientCount, 1);
+      os_unfair_lock_unlock (&g_clientLock);
+
+      // 注册由连接管理线程异步完成
+      manager_signal ();
       return noErr;
     }
 
@@ -155,30 +897,39 @@ app_volume_driver_add_client (UInt32 clientID, pid_t pid, const char *bundleId,
 OSStatus
 app_volume_driver_remove_client (UInt32 clientID)
 {
-  pid_t removedPid = 0;
-
   os_unfair_lock_lock (&g_clientLock);
 
   for (UInt32 i = 0; i < MAX_CLIENTS; i++)
     {
-      if (g_clients[i].active && g_clients[i].clientID == clientID)
+      ClientEntry *entry = &g_clients[i];
+      if (!atomic_load (&entry->active)
+	  || atomic_load (&entry->clientID) != clientID)
+	continue;
+
+      pid_t removedPid = atomic_load (&entry->pid);
+      bool wasRegistered = entry->registered;
+      atomic_store_explicit (&entry->active, false, memory_order_release);
+      atomic_store (&entry->clientID, 0);
+      atomic_store (&entry->pid, 0);
+      entry->registered = false;
+      atomic_fetch_sub (&g_clientCount, 1);
+
+      // 同一进程仍有其他客户端时保留服务端注册
+      bool queued = false;
+      if (wasRegistered && removedPid > 0 && !pid_is_active_locked (removedPid)
+	  && g_pendingUnregisterCount < MAX_CLIENTS)
 	{
-	  removedPid = g_clients[i].pid;
-	  g_clients[i].active = false;
-	  g_clients[i].clientID = 0;
-	  g_clients[i].pid = 0;
-	  atomic_fetch_sub (&g_clientCount, 1);
-	  os_unfair_lock_unlock (&g_clientLock);
-
-	  // 通过 IPC 从服务端注销
-	  if (g_ipcInitialized && removedPid > 0
-	      && ipc_client_is_connected (&g_ipcClient))
-	    {
-	      ipc_client_unregister_app (&g_ipcClient, removedPid);
-	    }
-
-	  return noErr;
+	  g_pendingUnregister[g_pendingUnregisterCount].pid = removedPid;
+	  g_pendingUnregister[g_pendingUnregisterCount].inFlight = false;
+	  g_pendingUnregisterCount++;
+	  queued = true;
 	}
+      os_unfair_lock_unlock (&g_clientLock);
+
+      // 注销由连接管理线程异步完成
+      if (queued)
+	manager_signal ();
+      return noErr;
     }
 
   os_unfair_lock_unlock (&g_clientLock);
@@ -190,18 +941,18 @@ app_volume_driver_get_pid (UInt32 clientID)
 {
   pid_t result = -1;
 
-  // 尝试获取锁，如果拿不到就算了（避免实时线程阻塞）
-  if (os_unfair_lock_trylock (&g_clientLock))
+  // 无锁读取已发布的客户端表（可能在实时线程中调用）
+  for (UInt32 i = 0; i < MAX_CLIENTS; i++)
     {
-      for (UInt32 i = 0; i < MAX_CLIENTS; i++)
+      if (atomic_load_explicit (&g_clients[i].active, memory_order_acquire)
+	  && atomic_load_explicit (&g_clients[i].clientID,
+				   memory_order_relaxed)
+	       == clientID)
 	{
-	  if (g_clients[i].active && g_clients[i].clientID == clientID)
-	    {
-	      result = g_clients[i].pid;
-	      break;
-	    }
+	  result = atomic_load_explicit (&g_clients[i].pid,
+					 memory_order_relaxed);
+	  break;
 	}
-      os_unfair_lock_unlock (&g_clientLock);
     }
 
   return result;
@@ -252,9 +1003,9 @@ app_volume_driver_get_client_pids (pid_t *outPids, UInt32 maxCount,
 	  break;
 	}
 
-      if (g_clients[i].active)
+      if (atomic_load (&g_clients[i].active))
 	{
-	  outPids[count++] = g_clients[i].pid;
+	  outPids[count++] = atomic_load (&g_clients[i].pid);
 	}
     }
 
@@ -266,32 +1017,36 @@ app_volume_driver_get_client_pids (pid_t *outPids, UInt32 maxCount,
 
 #pragma mark - Volume Application
 
-// Real-time audio path: never blocks, only uses cache
-// Note: this function is called from real-time audio thread (IOProc), must not
-// block
-Float32
-app_volume_driver_get_volume (UInt32 clientID, bool *outIsMuted)
+// Real-time audio path: never blocks, never touches the socket
+// 查找客户端槽位，未找到返回 -1
+static int
+find_client_slot (UInt32 clientID)
+{
+  for (UInt32 i = 0; i < MAX_CLIENTS; i++)
+    {
+      ClientEntry *entry = &g_clients[i];
+      if (atomic_load_explicit (&entry->active, memory_order_acquire)
+	  && atomic_load_explicit (&entry->clientID, memory_order_relaxed)
+	       == clientID)
+	return (int) i;
+    }
+  return -1;
+}
+
+// 只读取连接管理线程发布的音量；断开期间保留最后一次同步的值，
+// 避免服务重启时音量跳变
+static Float32
+load_slot_volume (int slot, bool *outIsMuted)
 {
   Float32 volume = 1.0f; // Default volume
   bool isMuted = false;
 
-  // Get PID using TryLock
-  pid_t pid = app_volume_driver_get_pid (clientID);
-
-  // Real-time path only reads cache, never triggers synchronous IPC
-  // When cache expires, use default value to avoid blocking audio thread
-  if (pid > 0 && g_ipcInitialized)
+  if (slot >= 0)
     {
-      // Only check cache, don't trigger update
-      uint64_t now = get_timestamp_ms ();
-      if (g_ipcClient.cache_valid && g_ipcClient.cached_pid == pid
-	  && (now - g_ipcClient.cache_timestamp) < IPC_CACHE_TTL_MS)
-	{
-	  volume = g_ipcClient.cached_volume;
-	  isMuted = g_ipcClient.cached_muted;
-	}
-      // When cache expires, use default (volume=1.0), don't trigger IPC
-      // Cache update is done by background thread
+      volume = atomic_load_explicit (&g_clients[slot].volume,
+				     memory_order_relaxed);
+      isMuted = atomic_load_explicit (&g_clients[slot].muted,
+				      memory_order_relaxed);
     }
 
   if (outIsMuted)
@@ -299,6 +1054,73 @@ app_volume_driver_get_volume (UInt32 clientID, bool *outIsMuted)
   return volume;
 }
 
+Float32
+app_volume_driver_get_volume (UInt32 clientID, bool *outIsMuted)
+{
+  return load_slot_volume (find_client_slot (clientID), outIsMuted);
+}
+
+// 闪避：人声应用达到门限时上报活动，媒体应用按是否处于闪避更新增益；
+// 角色变化或闪避关闭后，残留的衰减按释放时间恢复
+// 返回本块终点的闪避增益 (dB)
+static float
+update_slot_ducking (int slot, const RouterDuckParams *params,
+		     float momentary_lufs, UInt32 frameCount)
+{
+  ClientEntry *entry = &g_clients[slot];
+  RouterDuck *duck = &g_duck[slot];
+  uint8_t role = atomic_load_explicit (&entry->duckRole, memory_order_relaxed);
+  bool engaged = false;
+  if (params->enabled && role == kIPCDuckingRoleVoice)
+    router_duck_report_voice (&g_duckControl, params, momentary_lufs,
+			      monotonic_ns ());
+  else if (params->enabled && role == kIPCDuckingRoleMedia)
+    engaged = router_duck_is_engaged (&g_duckControl, params, monotonic_ns ());
+
+  if (!engaged && duck->gain_db == 0.0f)
+    return 0.0f;
+  return router_duck_update (duck, params, engaged, frameCount,
+			     METER_SAMPLE_RATE);
+}
+
+// 槽位分配给新客户端后的第一块：闪避增益归零，矩阵直接采用当前规则
+static void
+reset_slot_state (int slot)
+{
+  ClientEntry *entry = &g_clients[slot];
+  if (!atomic_load_explicit (&entry->slotReset, memory_order_relaxed)
+      || !atomic_exchange_explicit (&entry->slotReset, false,
+				    memory_order_acquire))
+    return;
+
+  router_duck_init (&g_duck[slot]);
+  SlotMix *mix = &g_mix[slot];
+  mix->word = atomic_load_explicit (&entry->mixWord, memory_order_relaxed);
+  build_mix_matrix (mix->word, &mix->matrix);
+}
+
+// 声道矩阵：规则变化的那一块从旧矩阵逐帧过渡到新矩阵，之后按矩阵形状
+// 走快速路径（无规则时为单位矩阵，直接返回）。静音块只更新状态
+static void
+apply_slot_mix (int slot, float *buffer, UInt32 frameCount, bool silent)
+{
+  SlotMix *mix = &g_mix[slot];
+  uint64_t word
+    = atomic_load_explicit (&g_clients[slot].mixWord, memory_order_relaxed);
+  if (word != mix->word)
+    {
+      RouterMatrix target;
+      build_mix_matrix (word, &target);
+      if (!silent)
+	router_matrix_apply_ramp (&mix->matrix, &target, buffer, frameCount);
+      mix->matrix = target;
+      mix->word = word;
+      return;
+    }
+  if (!silent)
+    router_matrix_apply (&mix->matrix, buffer, frameCount);
+}
+
 void
 app_volume_driver_apply_volume (UInt32 clientID, void *buffer,
 				UInt32 frameCount, UInt32 channels)
@@ -306,8 +1128,44 @@ app_volume_driver_apply_volume (UInt32 clientID, void *buffer,
   if (buffer == NULL || frameCount == 0)
     return;
 
+  int slot = find_client_slot (clientID);
+  RouterAgc *agc = NULL;
+  bool silent = false;
+
+  // 测量应用自身的输出（音量和静音之前），作为跨应用统一响度的依据
+  if (slot >= 0 && channels == METER_CHANNELS)
+    {
+      reset_slot_state (slot);
+      silent = router_buffer_is_silent ((const float *) buffer,
+					frameCount * channels);
+      if (silent)
+	router_loudness_add_silence (&g_meters[slot], frameCount);
+      else
+	router_loudness_process (&g_meters[slot], (const float *) buffer,
+				 frameCount);
+
+      // 响度均衡和闪避都依据本块测量后的读数，两者都关闭时不读取
+      RouterAgcParams agcParams;
+      RouterDuckParams duckParams;
+      router_agc_get_params (&g_agcControl, &agcParams);
+      router_duck_get_params (&g_duckControl, &duckParams);
+      RouterLoudnessReading reading;
+      reading.momentary_lufs = ROUTER_LOUDNESS_MIN_LUFS;
+      reading.short_term_lufs = ROUTER_LOUDNESS_MIN_LUFS;
+      if (agcParams.enabled || duckParams.enabled)
+	router_loudness_read (&g_meters[slot], &reading);
+
+      // 均衡增益每块按短期响度更新一次（关闭后平滑回到 0 dB），
+      // 闪避增益作为叠加量一起进入增益斜坡
+      float duckDb = update_slot_ducking (slot, &duckParams,
+					  reading.momentary_lufs, frameCount);
+      agc = &g_agc[slot];
+      router_agc_update (agc, &agcParams, reading.short_term_lufs, duckDb,
+			 frameCount, METER_SAMPLE_RATE);
+    }
+
   bool isMuted = false;
-  Float32 volume = app_volume_driver_get_volume (clientID, &isMuted);
+  Float32 volume = load_slot_volume (slot, &isMuted);
 
   // 静音处理
   if (isMuted)
@@ -316,19 +1174,28 @@ app_volume_driver_apply_volume (UInt32 clientID, void *buffer,
       return;
     }
 
-  // 音量为 1.0 时直接返回（零拷贝）
-  if (volume >= 0.999f)
-    return;
-
-  // 应用音量 (Interleaved: L R L R ...)
-  Float32 *samples = (Float32 *) buffer;
-  UInt32 totalSamples = frameCount * channels;
-
-  // 简单标量乘法
-  for (UInt32 i = 0; i < totalSamples; i++)
+  // 均衡增益与音量合并为一次乘法，块内逐采样插值；静音块无需处理
+  if (agc != NULL && router_agc_is_active (agc))
+    {
+      if (!silent)
+	router_agc_apply (agc, (float *) buffer, frameCount, channels, volume);
+    }
+  else if (volume < 0.999f) // 音量为 1.0 时不处理（零拷贝）
     {
-      samples[i] *= volume;
+      // 应用音量 (Interleaved: L R L R ...)
+      Float32 *samples = (Float32 *) buffer;
+      UInt32 totalSamples = frameCount * channels;
+
+      // 简单标量乘法
+      for (UInt32 i = 0; i < totalSamples; i++)
+	{
+	  samples[i] *= volume;
+	}
     }
+
+  // 矩阵是线性的，放在增益之后与之前结果相同
+  if (slot >= 0 && channels == METER_CHANNELS)
+    apply_slot_mix (slot, (float *) buffer, frameCount, silent);
 }
 
 void
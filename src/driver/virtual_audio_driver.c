@@ -4,6 +4,7 @@
 #include <pthread.h>
 #include <stdatomic.h>
 #include "driver/app_volume_driver.h"
+#include "router/router_loopback.h"
 
 // 定义输出流和输入流（支持双工操作）
 enum
@@ -32,9 +33,7 @@ static const UInt32 kZeroTimeStampPeriod = 4096;
 static atomic_uint_fast64_t gZTS_Seed = 1;
 
 // Loopback buffer for input stream reading output data
-static Float32 gLoopbackBuffer[16384];
-static volatile atomic_uint gLoopbackWritePos = 0;
-static volatile atomic_uint gLoopbackReadPos = 0;
+static RouterLoopback gLoopback = ROUTER_LOOPBACK_INIT;
 
 // 定义 Log Subsystem
 static os_log_t gLog = NULL;
@@ -309,12 +308,9 @@ VirtualAudioDriver_StopIO (AudioServerPlugInDriverRef __unused inDriver,
 
   if (prevCount == 1)
     {
-      // 最后一个客户端停止，重置 ring buffer
-      atomic_store_explicit (&gLoopbackWritePos, 0, memory_order_relaxed);
-      atomic_store_explicit (&gLoopbackReadPos, 0, memory_order_relaxed);
-      // 清零缓冲区（防止下次启动读到垃圾数据）
-      // 注意：memset 不是原子操作，但此时所有 IO 都已停止，是安全的
-      memset (gLoopbackBuffer, 0, sizeof (gLoopbackBuffer));
+      // 最后一个客户端停止，重置 ring buffer（清零缓冲区，防止下次启动
+      // 读到垃圾数据；此时所有 IO 都已停止，是安全的）
+      router_loopback_reset (&gLoopback);
       // 自增 Seed 强制 Host 重新收敛
       atomic_fetch_add_explicit (&gZTS_Seed, 1, memory_order_release);
 
@@ -469,16 +465,7 @@ VirtualAudioDriver_DoIOOperation (
     {
       // 将处理后的音频数据写入 loopback 缓冲区
       // 已经是 Interleaved 格式 (LRLRLR...)，直接拷贝即可
-      UInt32 writePos = atomic_load (&gLoopbackWritePos);
-      UInt32 totalSamples = frames * 2;
-
-      for (UInt32 i = 0; i < totalSamples; i++)
-	{
-	  gLoopbackBuffer[writePos] = samples[i];
-	  writePos = (writePos + 1)
-		     % (sizeof (gLoopbackBuffer) / sizeof (gLoopbackBuffer[0]));
-	}
-      atomic_store (&gLoopbackWritePos, writePos);
+      router_loopback_write (&gLoopback, samples, frames * 2);
 
       // [Freewheel] 推进时间轴
       // 这是最关键的一步：只有在这里，我们才认为时间真正前进了
@@ -488,34 +475,7 @@ VirtualAudioDriver_DoIOOperation (
   // 处理输入操作：从 loopback 缓冲区读取数据
   else if (inOperationID == kAudioServerPlugInIOOperationReadInput)
     {
-      UInt32 readPos = atomic_load (&gLoopbackReadPos);
-      UInt32 writePos = atomic_load (&gLoopbackWritePos);
-      UInt32 bufferSize
-	= sizeof (gLoopbackBuffer) / sizeof (gLoopbackBuffer[0]);
-
-      // 计算可用数据量（采样点数）
-      UInt32 available;
-      if (writePos >= readPos)
-	available = writePos - readPos;
-      else
-	available = bufferSize - readPos + writePos;
-
-      UInt32 sampleCount = frames * 2;
-
-      if (available >= sampleCount)
-	{
-	  for (UInt32 i = 0; i < sampleCount; i++)
-	    {
-	      samples[i] = gLoopbackBuffer[readPos];
-	      readPos = (readPos + 1) % bufferSize;
-	    }
-	  atomic_store (&gLoopbackReadPos, readPos);
-	}
-      else
-	{
-	  // 数据不足，输出静音
-	  memset (samples, 0, sampleCount * sizeof (Float32));
-	}
+      router_loopback_read (&gLoopback, samples, frames * 2);
     }
 
   return 0;
@@ -977,11 +937,19 @@ VirtualAudioDriver_AddDeviceClient (
 {
   if (inClientInfo)
     {
-      // Register with local driver
-      app_volume_driver_add_client (inClientInfo->mClientID,
-				    inClientInfo->mProcessID, NULL, NULL);
+      char bundleId[128] = {0};
+      const char *bundleIdPtr = NULL;
+      if (inClientInfo->mBundleID != NULL
+	  && CFStringGetCString (inClientInfo->mBundleID, bundleId,
+				 sizeof (bundleId), kCFStringEncodingUTF8))
+	{
+	  bundleIdPtr = bundleId;
+	}
 
-      // This will be implemented in the new IPC architecture
+      // Register with local driver (IPC registration happens in background)
+      app_volume_driver_add_client (inClientInfo->mClientID,
+				    inClientInfo->mProcessID, bundleIdPtr,
+				    NULL);
     }
   return 0;
 }
@@ -996,8 +964,6 @@ VirtualAudioDriver_RemoveDeviceClient (
     {
       // Unregister from local driver
       app_volume_driver_remove_client (inClientInfo->mClientID);
-
-      // This will be implemented in the new IPC architecture
     }
   return 0;
 }
@@ -0,0 +1,650 @@
+//
+// 异步流水线 IPC 客户端实现
+// 调用线程只负责入队和非阻塞发送，接收、分发和超时由 IO 线程完成
+//
+
+#include "ipc/ipc_async_client.h"
+#include "ipc/ipc_protocol.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+// 接收缓冲区可容纳两条最大消息，保证总能解析出至少一条完整消息
+#define IPC_ASYNC_FRAME_MAX (sizeof (IPCMessageHeader) + IPC_MAX_PAYLOAD_SIZE)
+#define IPC_ASYNC_RECV_BUFFER_SIZE (IPC_ASYNC_FRAME_MAX * 2)
+// IO 线程轮询间隔（用于超时扫描）
+#define IPC_ASYNC_POLL_INTERVAL_MS 50
+
+#ifdef MSG_NOSIGNAL
+#define IPC_ASYNC_SEND_FLAGS MSG_NOSIGNAL
+#else
+#define IPC_ASYNC_SEND_FLAGS 0
+#endif
+
+// 单调时钟毫秒
+static uint64_t
+get_monotonic_ms (void)
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000 + (uint64_t) ts.tv_nsec / 1000000;
+}
+
+static int
+set_nonblocking (int fd)
+{
+  int flags = fcntl (fd, F_GETFL, 0);
+  if (flags == -1)
+    return -1;
+  return fcntl (fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+// 唤醒 IO 线程
+static void
+wake_io_thread (IPCAsyncClient *client)
+{
+  if (client->wake_fds[1] >= 0)
+    {
+      uint8_t byte = 1;
+      (void) write (client->wake_fds[1], &byte, 1);
+    }
+}
+
+static void
+drain_wake_pipe (IPCAsyncClient *client)
+{
+  uint8_t buf[64];
+  while (read (client->wake_fds[0], buf, sizeof (buf)) > 0)
+    {
+    }
+}
+
+static void
+close_wake_pipe (IPCAsyncClient *client)
+{
+  for (int i = 0; i < 2; i++)
+    {
+      if (client->wake_fds[i] >= 0)
+	{
+	  close (client->wake_fds[i]);
+	  client->wake_fds[i] = -1;
+	}
+    }
+}
+
+// 尽可能多地发送队列中的数据（调用者持有锁）
+// 返回 0 表示正常（可能仍有剩余），-1 表示连接错误
+static int
+flush_send_locked (IPCAsyncClient *client)
+{
+  size_t offset = 0;
+  while (offset < client->send_len)
+    {
+      ssize_t sent = send (client->fd, client->send_buf + offset,
+			   client->send_len - offset, IPC_ASYNC_SEND_FLAGS);
+      if (sent > 0)
+	{
+	  offset += (size_t) sent;
+	  continue;
+	}
+      if (sent < 0 && errno == EINTR)
+	continue;
+      if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+	break;
+      return -1;
+    }
+
+  if (offset > 0)
+    {
+      memmove (client->send_buf, client->send_buf + offset,
+	       client->send_len - offset);
+      client->send_len -= offset;
+    }
+  return 0;
+}
+
+// 取出指定请求ID的表项（调用者持有锁）
+static bool
+take_pending_locked (IPCAsyncClient *client, uint32_t request_id,
+		     IPCAsyncPending *out)
+{
+  for (uint32_t i = 0; i < IPC_ASYNC_MAX_PENDING; i++)
+    {
+      IPCAsyncPending *slot = &client->pending[i];
+      if (slot->in_use && slot->request_id == request_id)
+	{
+	  *out = *slot;
+	  memset (slot, 0, sizeof (*slot));
+	  client->pending_count--;
+	  return true;
+	}
+    }
+  return false;
+}
+
+// 以指定状态完成表项（过期或全部）
+static void
+complete_pending (IPCAsyncClient *client, bool only_expired, int32_t status)
+{
+  IPCAsyncPending done[IPC_ASYNC_MAX_PENDING];
+  uint32_t done_count = 0;
+  uint64_t now = get_monotonic_ms ();
+
+  pthread_mutex_lock (&client->lock);
+  for (uint32_t i = 0; i < IPC_ASYNC_MAX_PENDING; i++)
+    {
+      IPCAsyncPending *slot = &client->pending[i];
+      if (!slot->in_use || (only_expired && slot->deadline_ms > now))
+	continue;
+      done[done_count++] = *slot;
+      memset (slot, 0, sizeof (*slot));
+      client->pending_count--;
+    }
+  pthread_mutex_unlock (&client->lock);
+
+  // 在锁外调用回调，允许回调中提交新请求
+  for (uint32_t i = 0; i < done_count; i++)
+    {
+      if (done[i].callback != NULL)
+	done[i].callback (done[i].user_data, status, NULL, 0);
+    }
+}
+
+// 分发一条完整消息
+static void
+dispatch_frame (IPCAsyncClient *client, const IPCMessageHeader *header,
+		const uint8_t *payload)
+{
+  if (header->command == kIPCCommandEvent)
+    {
+      if (header->payload_len < sizeof (IPCEventHeader)
+	  || client->event_callback == NULL)
+	return;
+
+      IPCEventHeader event;
+      memcpy (&event, payload, sizeof (event));
+      uint32_t data_len = header->payload_len - sizeof (IPCEventHeader);
+      if (event.data_len < data_len)
+	data_len = event.data_len;
+      client->event_callback (client->event_user_data, event.topic,
+			      payload + sizeof (IPCEventHeader), data_len);
+      return;
+    }
+
+  IPCAsyncPending pending;
+  pthread_mutex_lock (&client->lock);
+  bool found = take_pending_locked (client, header->request_id, &pending);
+  pthread_mutex_unlock (&client->lock);
+
+  // 已超时或未知的响应直接丢弃
+  if (!found || pending.callback == NULL)
+    return;
+
+  if (header->command != kIPCCommandResponse
+      || header->payload_len < sizeof (IPCResponse))
+    {
+      pending.callback (pending.user_data, kIPCStatusInvalidHeader, NULL, 0);
+      return;
+    }
+
+  IPCResponse resp;
+  memcpy (&resp, payload, sizeof (resp));
+  uint32_t data_len = header->payload_len - sizeof (IPCResponse);
+  if (resp.data_len < data_len)
+    data_len = resp.data_len;
+  pending.callback (pending.user_data, resp.status,
+		    data_len > 0 ? payload + sizeof (IPCResponse) : NULL,
+		    data_len);
+}
+
+// 读取所有可用数据并分发完整消息
+// 返回 0 表示连接正常，-1 表示连接关闭或协议错误
+static int
+read_available (IPCAsyncClient *client)
+{
+  for (;;)
+    {
+      ssize_t received
+	= recv (client->fd, client->recv_buf + client->recv_len,
+		IPC_ASYNC_RECV_BUFFER_SIZE - client->recv_len, 0);
+      if (received == 0)
+	return -1;
+      if (received < 0)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  if (errno == EAGAIN || errno == EWOULDBLOCK)
+	    return 0;
+	  return -1;
+	}
+      client->recv_len += (size_t) received;
+
+      // 解析缓冲区中所有完整消息
+      size_t offset = 0;
+      while (client->recv_len - offset >= sizeof (IPCMessageHeader))
+	{
+	  IPCMessageHeader header;
+	  memcpy (&header, client->recv_buf + offset, sizeof (header));
+	  if (!ipc_validate_header (&header))
+	    return -1;
+
+	  size_t frame_len = sizeof (header) + header.payload_len;
+	  if (client->recv_len - offset < frame_len)
+	    break;
+
+	  dispatch_frame (client, &header,
+			  client->recv_buf + offset + sizeof (header));
+	  offset += frame_len;
+	}
+
+      if (offset > 0)
+	{
+	  memmove (client->recv_buf, client->recv_buf + offset,
+		   client->recv_len - offset);
+	  client->recv_len -= offset;
+	}
+    }
+}
+
+// IO 线程：接收、分发、刷新发送队列、扫描超时
+static void *
+io_thread_func (void *arg)
+{
+  IPCAsyncClient *client = (IPCAsyncClient *) arg;
+
+  while (atomic_load_explicit (&client->running, memory_order_acquire))
+    {
+      pthread_mutex_lock (&client->lock);
+      bool want_write = client->send_len > 0;
+      pthread_mutex_unlock (&client->lock);
+
+      struct pollfd fds[2];
+      fds[0].fd = client->fd;
+      fds[0].events = POLLIN | (want_write ? POLLOUT : 0);
+      fds[0].revents = 0;
+      fds[1].fd = client->wake_fds[0];
+      fds[1].events = POLLIN;
+      fds[1].revents = 0;
+
+      int ready = poll (fds, 2, IPC_ASYNC_POLL_INTERVAL_MS);
+      if (ready < 0 && errno != EINTR)
+	break;
+
+      if (ready > 0)
+	{
+	  if (fds[1].revents & POLLIN)
+	    drain_wake_pipe (client);
+
+	  if (fds[0].revents & (POLLIN | POLLHUP | POLLERR))
+	    {
+	      if (read_available (client) != 0)
+		break;
+	    }
+
+	  if (fds[0].revents & POLLOUT)
+	    {
+	      pthread_mutex_lock (&client->lock);
+	      int result = flush_send_locked (client);
+	      pthread_mutex_unlock (&client->lock);
+	      if (result != 0)
+		break;
+	    }
+	}
+
+      complete_pending (client, true, kIPCStatusServiceUnavailable);
+    }
+
+  // 连接已断开：其余请求不会再有响应
+  atomic_store_explicit (&client->connected, false, memory_order_release);
+  complete_pending (client, false, kIPCStatusServiceUnavailable);
+  return NULL;
+}
+
+int
+ipc_async_client_init (IPCAsyncClient *client, IPCEventCallback event_callback,
+		       void *user_data)
+{
+  if (client == NULL)
+    return -1;
+
+  memset (client, 0, sizeof (IPCAsyncClient));
+  client->fd = -1;
+  client->wake_fds[0] = -1;
+  client->wake_fds[1] = -1;
+  atomic_init (&client->connected, false);
+  atomic_init (&client->running, false);
+  client->timeout_ms = IPC_ASYNC_DEFAULT_TIMEOUT_MS;
+  client->next_request_id = 1;
+  client->event_callback = event_callback;
+  client->event_user_data = user_data;
+
+  client->send_buf = malloc (IPC_ASYNC_SEND_BUFFER_SIZE);
+  client->recv_buf = malloc (IPC_ASYNC_RECV_BUFFER_SIZE);
+  if (client->send_buf == NULL || client->recv_buf == NULL)
+    {
+      free (client->send_buf);
+      free (client->recv_buf);
+      client->send_buf = NULL;
+      client->recv_buf = NULL;
+      return -1;
+    }
+
+  if (pthread_mutex_init (&client->lock, NULL) != 0)
+    {
+      free (client->send_buf);
+      free (client->recv_buf);
+      client->send_buf = NULL;
+      client->recv_buf = NULL;
+      return -1;
+    }
+
+  return 0;
+}
+
+int
+ipc_async_client_connect (IPCAsyncClient *client)
+{
+  if (client == NULL || client->send_buf == NULL)
+    return -1;
+
+  if (ipc_async_client_is_connected (client) || client->io_thread_started)
+    ipc_async_client_disconnect (client);
+
+  char socket_path[PATH_MAX];
+  if (get_ipc_socket_path (socket_path, sizeof (socket_path)) != 0)
+    return -1;
+
+  int fd = socket (AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0)
+    return -1;
+
+#ifdef SO_NOSIGPIPE
+  int on = 1;
+  setsockopt (fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof (on));
+#endif
+
+  struct sockaddr_un addr;
+  memset (&addr, 0, sizeof (addr));
+  addr.sun_family = AF_UNIX;
+  strncpy (addr.sun_path, socket_path, sizeof (addr.sun_path) - 1);
+
+  // Unix socket 的 connect 不涉及网络往返，连接建立后再切换为非阻塞
+  if (connect (fd, (struct sockaddr *) &addr, sizeof (addr)) < 0
+      || set_nonblocking (fd) < 0)
+    {
+      close (fd);
+      return -1;
+    }
+
+  if (pipe (client->wake_fds) != 0)
+    {
+      client->wake_fds[0] = -1;
+      client->wake_fds[1] = -1;
+      close (fd);
+      return -1;
+    }
+  set_nonblocking (client->wake_fds[0]);
+  set_nonblocking (client->wake_fds[1]);
+
+  client->fd = fd;
+  client->send_len = 0;
+  client->recv_len = 0;
+  atomic_store_explicit (&client->connected, true, memory_order_release);
+  atomic_store_explicit (&client->running, true, memory_order_release);
+
+  if (pthread_create (&client->io_thread, NULL, io_thread_func, client) != 0)
+    {
+      atomic_store (&client->connected, false);
+      atomic_store (&client->running, false);
+      close_wake_pipe (client);
+      close (fd);
+      client->fd = -1;
+      return -1;
+    }
+  client->io_thread_started = true;
+
+  return 0;
+}
+
+void
+ipc_async_client_disconnect (IPCAsyncClient *client)
+{
+  if (client == NULL)
+    return;
+
+  atomic_store_explicit (&client->running, false, memory_order_release);
+  if (client->io_thread_started)
+    {
+      wake_io_thread (client);
+      pthread_join (client->io_thread, NULL);
+      client->io_thread_started = false;
+    }
+
+  atomic_store_explicit (&client->connected, false, memory_order_release);
+  complete_pending (client, false, kIPCStatusServiceUnavailable);
+
+  if (client->fd >= 0)
+    {
+      close (client->fd);
+      client->fd = -1;
+    }
+  close_wake_pipe (client);
+
+  pthread_mutex_lock (&client->lock);
+  client->send_len = 0;
+  pthread_mutex_unlock (&client->lock);
+  client->recv_len = 0;
+}
+
+void
+ipc_async_client_cleanup (IPCAsyncClient *client)
+{
+  if (client == NULL || client->send_buf == NULL)
+    return;
+
+  ipc_async_client_disconnect (client);
+  pthread_mutex_destroy (&client->lock);
+  free (client->send_buf);
+  free (client->recv_buf);
+  client->send_buf = NULL;
+  client->recv_buf = NULL;
+}
+
+bool
+ipc_async_client_is_connected (IPCAsyncClient *client)
+{
+  if (client == NULL)
+    return false;
+  return atomic_load_explicit (&client->connected, memory_order_acquire);
+}
+
+void
+ipc_async_client_set_timeout (IPCAsyncClient *client, uint32_t timeout_ms)
+{
+  if (client != NULL && timeout_ms > 0)
+    client->timeout_ms = timeout_ms;
+}
+
+int
+ipc_async_client_request (IPCAsyncClient *client, uint16_t command,
+			  const void *payload, uint32_t payload_len,
+			  IPCAsyncCallback callback, void *user_data,
+			  uint32_t *out_request_id)
+{
+  if (client == NULL || payload_len > IPC_MAX_PAYLOAD_SIZE
+      || (payload == NULL && payload_len > 0))
+    return -1;
+  if (!ipc_async_client_is_connected (client))
+    return -1;
+
+  size_t frame_len = sizeof (IPCMessageHeader) + payload_len;
+
+  pthread_mutex_lock (&client->lock);
+
+  if (client->pending_count >= IPC_ASYNC_MAX_PENDING
+      || client->send_len + frame_len > IPC_ASYNC_SEND_BUFFER_SIZE)
+    {
+      pthread_mutex_unlock (&client->lock);
+      return -1;
+    }
+
+  uint32_t request_id = client->next_request_id++;
+  if (request_id == 0)
+    request_id = client->next_request_id++;
+
+  // 先登记再发送，保证响应到达时一定能找到表项
+  IPCAsyncPending *slot = NULL;
+  for (uint32_t i = 0; i < IPC_ASYNC_MAX_PENDING; i++)
+    {
+      if (!client->pending[i].in_use)
+	{
+	  slot = &client->pending[i];
+	  break;
+	}
+    }
+  slot->in_use = true;
+  slot->request_id = request_id;
+  slot->deadline_ms = get_monotonic_ms () + client->timeout_ms;
+  slot->callback = callback;
+  slot->user_data = user_data;
+  client->pending_count++;
+
+  IPCMessageHeader header;
+  ipc_init_header (&header, command, payload_len, request_id);
+  memcpy (client->send_buf + client->send_len, &header, sizeof (header));
+  if (payload_len > 0)
+    {
+      memcpy (client->send_buf + client->send_len + sizeof (header), payload,
+	      payload_len);
+    }
+  client->send_len += frame_len;
+
+  int result = flush_send_locked (client);
+  if (result != 0)
+    {
+      // 连接已损坏：在锁内撤销登记，失败只通过返回值报告，IO 线程清理
+      // 连接时不会再调用这个回调
+      memset (slot, 0, sizeof (*slot));
+      client->pending_count--;
+    }
+  bool has_remaining = client->send_len > 0;
+  pthread_mutex_unlock (&client->lock);
+
+  if (result != 0)
+    {
+      wake_io_thread (client);
+      return -1;
+    }
+
+  // 内核缓冲区已满，剩余数据由 IO 线程在可写时发送
+  if (has_remaining)
+    wake_io_thread (client);
+
+  if (out_request_id != NULL)
+    *out_request_id = request_id;
+  return 0;
+}
+
+int
+ipc_async_client_subscribe (IPCAsyncClient *client, uint32_t topics,
+			    IPCAsyncCallback callback, void *user_data)
+{
+  IPCSubscribeRequest req;
+  req.topics = topics;
+  return ipc_async_client_request (client, kIPCCommandSubscribe, &req,
+				   sizeof (req), callback, user_data, NULL);
+}
+
+// ============================================================================
+// Future
+// ============================================================================
+
+void
+ipc_async_future_init (IPCAsyncFuture *future)
+{
+  if (future == NULL)
+    return;
+
+  pthread_mutex_init (&future->mutex, NULL);
+  pthread_cond_init (&future->cond, NULL);
+  future->done = false;
+  future->status = kIPCStatusOK;
+  future->data_len = 0;
+}
+
+void
+ipc_async_future_destroy (IPCAsyncFuture *future)
+{
+  if (future == NULL)
+    return;
+
+  pthread_cond_destroy (&future->cond);
+  pthread_mutex_destroy (&future->mutex);
+}
+
+static void
+future_callback (void *user_data, int32_t status, const void *data,
+		 uint32_t data_len)
+{
+  IPCAsyncFuture *future = (IPCAsyncFuture *) user_data;
+
+  pthread_mutex_lock (&future->mutex);
+  future->status = status;
+  future->data_len = data_len;
+  if (data != NULL && data_len > 0)
+    memcpy (future->data, data, data_len);
+  future->done = true;
+  pthread_cond_broadcast (&future->cond);
+  pthread_mutex_unlock (&future->mutex);
+}
+
+int
+ipc_async_client_request_future (IPCAsyncClient *client, uint16_t command,
+				 const void *payload, uint32_t payload_len,
+				 IPCAsyncFuture *future)
+{
+  if (future == NULL)
+    return -1;
+
+  future->done = false;
+  future->data_len = 0;
+  return ipc_async_client_request (client, command, payload, payload_len,
+				   future_callback, future, NULL);
+}
+
+bool
+ipc_async_future_wait (IPCAsyncFuture *future, uint32_t timeout_ms)
+{
+  if (future == NULL)
+    return false;
+
+  struct timeval now;
+  gettimeofday (&now, NULL);
+  struct timespec deadline;
+  uint64_t nsec = (uint64_t) now.tv_usec * 1000
+		  + (uint64_t) (timeout_ms % 1000) * 1000000;
+  deadline.tv_sec
+    = now.tv_sec + (time_t) (timeout_ms / 1000) + (time_t) (nsec / 1000000000);
+  deadline.tv_nsec = (long) (nsec % 1000000000);
+
+  pthread_mutex_lock (&future->mutex);
+  while (!future->done)
+    {
+      if (pthread_cond_timedwait (&future->cond, &future->mutex, &deadline)
+	  == ETIMEDOUT)
+	break;
+    }
+  bool done = future->done;
+  pthread_mutex_unlock (&future->mutex);
+
+  return done;
+}
@@ -8,12 +8,14 @@
 #include <errno.h>
 #include <limits.h>
 #include <math.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/socket.h>
 #include <sys/time.h>
 #include <sys/un.h>
+#include <time.h>
 #include <unistd.h>
 
 // 配置参数
@@ -67,6 +69,7 @@ ipc_client_init (IPCClientContext *ctx)
   ctx->cached_muted = false;
   ctx->cache_valid = false;
   ctx->reconnect_attempts = 0;
+  ctx->next_request_id = 1;
 
   return 0;
 }
@@ -221,7 +224,8 @@ ipc_client_recv (IPCClientContext *ctx, IPCMessageHeader *header, void *payload,
     return -1;
 
   // 接收头
-  ssize_t received = recv (ctx->fd, header, sizeof (IPCMessageHeader), 0);
+  ssize_t received
+    = recv (ctx->fd, header, sizeof (IPCMessageHeader), MSG_WAITALL);
   if (received <= 0)
     {
       ctx->connected = false;
@@ -248,7 +252,7 @@ ipc_client_recv (IPCClientContext *ctx, IPCMessageHeader *header, void *payload,
 	  return -1;
 	}
 
-      received = recv (ctx->fd, payload, header->payload_len, 0);
+      received = recv (ctx->fd, payload, header->payload_len, MSG_WAITALL);
       if (received != (ssize_t) header->payload_len)
 	{
 	  ctx->connected = false;
@@ -260,6 +264,19 @@ ipc_client_recv (IPCClientContext *ctx, IPCMessageHeader *header, void *payload,
   return 0;
 }
 
+// 分配请求ID
+uint32_t
+ipc_client_next_request_id (IPCClientContext *ctx)
+{
+  if (ctx == NULL)
+    return 1;
+
+  uint32_t id = ctx->next_request_id++;
+  if (id == 0)
+    id = ctx->next_request_id++;
+  return id;
+}
+
 // 同步发送请求并接收响应
 int
 ipc_client_send_sync (IPCClientContext *ctx,
@@ -277,14 +294,80 @@ ipc_client_send_sync (IPCClientContext *ctx,
       return -1;
     }
 
-  // 接收响应
-  if (ipc_client_recv (ctx, response_header, response_payload, response_size)
+  // 接收响应：跳过事件和不属于本次请求的消息，保持流同步
+  uint8_t buffer[IPC_MAX_PAYLOAD_SIZE];
+  for (;;)
+    {
+      if (ipc_client_recv (ctx, response_header, buffer, sizeof (buffer)) != 0)
+	{
+	  return -1;
+	}
+
+      if (response_header->command == kIPCCommandEvent
+	  || response_header->request_id != request_header->request_id)
+	{
+	  continue;
+	}
+
+      if (response_payload != NULL && response_size > 0)
+	{
+	  size_t copy_len = response_header->payload_len;
+	  if (copy_len > response_size)
+	    copy_len = response_size;
+	  memcpy (response_payload, buffer, copy_len);
+	}
+      return 0;
+    }
+}
+
+// 发送请求并解析通用响应 (IPCResponse + 附加数据)
+// 传输失败返回 kIPCStatusServiceUnavailable，否则返回服务端状态码
+static int32_t
+ipc_client_call (IPCClientContext *ctx, uint16_t command, const void *payload,
+		 uint32_t payload_len, void *data, size_t data_size,
+		 uint32_t *data_len)
+{
+  if (data_len != NULL)
+    *data_len = 0;
+  if (!ipc_client_is_connected (ctx))
+    return kIPCStatusServiceUnavailable;
+
+  IPCMessageHeader request;
+  ipc_init_header (&request, command, payload_len,
+		   ipc_client_next_request_id (ctx));
+
+  IPCMessageHeader response = {0};
+  uint8_t buffer[IPC_MAX_PAYLOAD_SIZE];
+
+  if (ipc_client_send_sync (ctx, &request, payload, &response, buffer,
+			    sizeof (buffer))
       != 0)
     {
-      return -1;
+      return kIPCStatusServiceUnavailable;
     }
 
-  return 0;
+  if (response.command != kIPCCommandResponse
+      || response.payload_len < sizeof (IPCResponse))
+    {
+      return kIPCStatusInvalidHeader;
+    }
+
+  IPCResponse resp;
+  memcpy (&resp, buffer, sizeof (resp));
+
+  uint32_t available = response.payload_len - (uint32_t) sizeof (IPCResponse);
+  if (resp.data_len < available)
+    available = resp.data_len;
+
+  if (data != NULL && data_size > 0)
+    {
+      size_t copy_len = available < data_size ? available : data_size;
+      memcpy (data, buffer + sizeof (IPCResponse), copy_len);
+    }
+  if (data_len != NULL)
+    *data_len = available;
+
+  return resp.status;
 }
 
 // 快速获取音量（带缓存，非阻塞）
@@ -314,27 +397,14 @@ ipc_client_get_volume_fast (IPCClientContext *ctx, pid_t pid, float *volume,
       return -1;
     }
 
-  // 构建请求
-  IPCMessageHeader request;
-  ipc_init_header (&request, kIPCCommandGetVolume, sizeof (pid_t), 1);
-
   // 发送请求并接收响应
-  IPCMessageHeader response = {0};
   IPCVolumeResponse vol_response = {0};
-
-  if (ipc_client_send_sync (ctx, &request, &pid, &response, &vol_response,
-			    sizeof (vol_response))
-      != 0)
-    {
-      // 请求失败，使用缓存值
-      *volume = ctx->cached_volume;
-      *muted = ctx->cached_muted;
-      return -1;
-    }
+  int32_t status = ipc_client_call (ctx, kIPCCommandGetVolume, &pid,
+				    sizeof (pid_t), &vol_response,
+				    sizeof (vol_response), NULL);
 
   // 检查响应状态
-  if (response.command == kIPCCommandResponse
-      && vol_response.status == kIPCStatusOK)
+  if (status == kIPCStatusOK && vol_response.status == kIPCStatusOK)
     {
       // 更新缓存
       ctx->cached_pid = pid;
@@ -348,7 +418,7 @@ ipc_client_get_volume_fast (IPCClientContext *ctx, pid_t pid, float *volume,
       return 0;
     }
 
-  // 服务端返回错误，使用缓存值
+  // 请求失败或服务端返回错误，使用缓存值
   *volume = ctx->cached_volume;
   *muted = ctx->cached_muted;
   return -1;
@@ -366,21 +436,12 @@ ipc_client_refresh_cache (IPCClientContext *ctx, pid_t pid)
       return -1;
     }
 
-  IPCMessageHeader request;
-  ipc_init_header (&request, kIPCCommandGetVolume, sizeof (pid_t), 1);
-
-  IPCMessageHeader response = {0};
   IPCVolumeResponse vol_response = {0};
+  int32_t status = ipc_client_call (ctx, kIPCCommandGetVolume, &pid,
+				    sizeof (pid_t), &vol_response,
+				    sizeof (vol_response), NULL);
 
-  if (ipc_client_send_sync (ctx, &request, &pid, &response, &vol_response,
-			    sizeof (vol_response))
-      != 0)
-    {
-      return -1;
-    }
-
-  if (response.command == kIPCCommandResponse
-      && vol_response.status == kIPCStatusOK)
+  if (status == kIPCStatusOK && vol_response.status == kIPCStatusOK)
     {
       ctx->cached_pid = pid;
       ctx->cached_volume = vol_response.volume;
@@ -431,23 +492,11 @@ ipc_client_register_app (IPCClientContext *ctx, pid_t pid, const char *app_name,
   req->muted = muted;
   memcpy (payload + sizeof (IPCRegisterRequest), app_name, name_len);
 
-  IPCMessageHeader request;
-  ipc_init_header (&request, kIPCCommandRegister, (uint32_t) payload_len, 1);
-
-  IPCMessageHeader response = {0};
-  IPCResponse resp = {0};
-
-  int result = ipc_client_send_sync (ctx, &request, payload, &response, &resp,
-				     sizeof (resp));
+  int32_t status = ipc_client_call (ctx, kIPCCommandRegister, payload,
+				    (uint32_t) payload_len, NULL, 0, NULL);
   free (payload);
 
-  if (result != 0)
-    return -1;
-
-  return (response.command == kIPCCommandResponse
-	  && resp.status == kIPCStatusOK)
-	   ? 0
-	   : -1;
+  return (status == kIPCStatusOK) ? 0 : -1;
 }
 
 // 注销应用
@@ -459,23 +508,10 @@ ipc_client_unregister_app (IPCClientContext *ctx, pid_t pid)
   if (!ipc_client_is_connected (ctx))
     return -1;
 
-  IPCMessageHeader request;
-  ipc_init_header (&request, kIPCCommandUnregister, sizeof (pid_t), 1);
-
-  IPCMessageHeader response = {0};
-  IPCResponse resp = {0};
-
-  if (ipc_client_send_sync (ctx, &request, &pid, &response, &resp,
-			    sizeof (resp))
-      != 0)
-    {
-      return -1;
-    }
+  int32_t status = ipc_client_call (ctx, kIPCCommandUnregister, &pid,
+				    sizeof (pid_t), NULL, 0, NULL);
 
-  return (response.command == kIPCCommandResponse
-	  && resp.status == kIPCStatusOK)
-	   ? 0
-	   : -1;
+  return (status == kIPCStatusOK) ? 0 : -1;
 }
 
 // 获取应用音量
@@ -488,21 +524,12 @@ ipc_client_get_app_volume (IPCClientContext *ctx, pid_t pid, float *volume,
   if (!ipc_client_is_connected (ctx))
     return -1;
 
-  IPCMessageHeader request;
-  ipc_init_header (&request, kIPCCommandGetVolume, sizeof (pid_t), 1);
-
-  IPCMessageHeader response = {0};
   IPCVolumeResponse vol_response = {0};
+  int32_t status = ipc_client_call (ctx, kIPCCommandGetVolume, &pid,
+				    sizeof (pid_t), &vol_response,
+				    sizeof (vol_response), NULL);
 
-  if (ipc_client_send_sync (ctx, &request, &pid, &response, &vol_response,
-			    sizeof (vol_response))
-      != 0)
-    {
-      return -1;
-    }
-
-  if (response.command == kIPCCommandResponse
-      && vol_response.status == kIPCStatusOK)
+  if (status == kIPCStatusOK && vol_response.status == kIPCStatusOK)
     {
       *volume = vol_response.volume;
       *muted = vol_response.muted;
@@ -525,23 +552,10 @@ ipc_client_set_app_volume (IPCClientContext *ctx, pid_t pid, float volume)
   req.pid = pid;
   req.volume = volume;
 
-  IPCMessageHeader request;
-  ipc_init_header (&request, kIPCCommandSetVolume, sizeof (req), 1);
-
-  IPCMessageHeader response = {0};
-  IPCResponse resp = {0};
-
-  if (ipc_client_send_sync (ctx, &request, &req, &response, &resp,
-			    sizeof (resp))
-      != 0)
-    {
-      return -1;
-    }
+  int32_t status
+    = ipc_client_call (ctx, kIPCCommandSetVolume, &req, sizeof (req), NULL, 0, NULL);
 
-  return (response.command == kIPCCommandResponse
-	  && resp.status == kIPCStatusOK)
-	   ? 0
-	   : -1;
+  return (status == kIPCStatusOK) ? 0 : -1;
 }
 
 // 设置应用静音
@@ -557,23 +571,10 @@ ipc_client_set_app_mute (IPCClientContext *ctx, pid_t pid, bool muted)
   req.pid = pid;
   req.muted = muted;
 
-  IPCMessageHeader request;
-  ipc_init_header (&request, kIPCCommandSetMute, sizeof (req), 1);
-
-  IPCMessageHeader response = {0};
-  IPCResponse resp = {0};
-
-  if (ipc_client_send_sync (ctx, &request, &req, &response, &resp,
-			    sizeof (resp))
-      != 0)
-    {
-      return -1;
-    }
+  int32_t status
+    = ipc_client_call (ctx, kIPCCommandSetMute, &req, sizeof (req), NULL, 0, NULL);
 
-  return (response.command == kIPCCommandResponse
-	  && resp.status == kIPCStatusOK)
-	   ? 0
-	   : -1;
+  return (status == kIPCStatusOK) ? 0 : -1;
 }
 
 // Ping 服务端
@@ -585,23 +586,10 @@ ipc_client_ping (IPCClientContext *ctx)
   if (!ipc_client_is_connected (ctx))
     return -1;
 
-  IPCMessageHeader request;
-  ipc_init_header (&request, kIPCCommandPing, 0, 1);
-
-  IPCMessageHeader response = {0};
-  IPCResponse resp = {0};
-
-  if (ipc_client_send_sync (ctx, &request, NULL, &response, &resp,
-			    sizeof (resp))
-      != 0)
-    {
-      return -1;
-    }
+  int32_t status
+    = ipc_client_call (ctx, kIPCCommandPing, NULL, 0, NULL, 0, NULL);
 
-  return (response.command == kIPCCommandResponse
-	  && resp.status == kIPCStatusOK)
-	   ? 0
-	   : -1;
+  return (status == kIPCStatusOK) ? 0 : -1;
 }
 
 // 检查是否需要重连
@@ -682,35 +670,26 @@ ipc_client_list_apps (IPCClientContext *ctx, IPCAppInfo **apps, uint32_t *count)
   if (!ipc_client_is_connected (ctx))
     return -1;
 
-  IPCMessageHeader request;
-  ipc_init_header (&request, kIPCCommandListClients, 0, 1);
-
-  IPCMessageHeader response = {0};
   // 分配缓冲区接收列表数据
   uint8_t *buffer = malloc (IPC_MAX_PAYLOAD_SIZE);
   if (buffer == NULL)
     return -1;
 
-  if (ipc_client_send_sync (ctx, &request, NULL, &response, buffer,
-			    IPC_MAX_PAYLOAD_SIZE)
-      != 0)
-    {
-      free (buffer);
-      return -1;
-    }
-
-  if (response.command != kIPCCommandResponse || response.payload_len == 0)
+  uint32_t data_len = 0;
+  int32_t status = ipc_client_call (ctx, kIPCCommandListClients, NULL, 0,
+				    buffer, IPC_MAX_PAYLOAD_SIZE, &data_len);
+  if (status != kIPCStatusOK || data_len == 0)
     {
       free (buffer);
       *apps = NULL;
       *count = 0;
-      return (response.command == kIPCCommandResponse) ? 0 : -1;
+      return (status == kIPCStatusOK) ? 0 : -1;
     }
 
   // 计算客户端数量
   size_t entry_size
     = sizeof (pid_t) + sizeof (float) + sizeof (bool) + sizeof (uint64_t) + 256;
-  uint32_t app_count = response.payload_len / (uint32_t) entry_size;
+  uint32_t app_count = data_len / (uint32_t) entry_size;
 
   if (app_count == 0)
     {
@@ -760,3 +739,408 @@ ipc_client_list_apps (IPCClientContext *ctx, IPCAppInfo **apps, uint32_t *count)
 
   return 0;
 }
+
+// 获取服务端统计：条目超过单帧容量时按页读取，直到取完或填满 commands
+int
+ipc_client_get_stats (IPCClientContext *ctx, IPCServerStats *stats,
+		      IPCCommandStats *commands, uint32_t max_commands,
+		      uint32_t *count)
+{
+  if (count != NULL)
+    *count = 0;
+  if (ctx == NULL || stats == NULL)
+    return -1;
+  if (commands == NULL)
+    max_commands = 0;
+
+  uint8_t buffer[IPC_MAX_PAYLOAD_SIZE];
+  uint32_t collected = 0;
+  for (;;)
+    {
+      IPCStatsRequest req = {collected};
+      uint32_t data_len = 0;
+      int32_t status
+	= ipc_client_call (ctx, kIPCCommandGetStats, &req, sizeof (req),
+			   buffer, sizeof (buffer), &data_len);
+      if (status != kIPCStatusOK || data_len < sizeof (IPCServerStats))
+	return -1;
+
+      IPCServerStats page;
+      memcpy (&page, buffer, sizeof (page));
+      if (collected == 0)
+	*stats = page;
+
+      // 只复制实际收到的条目，兼容槽位数不同的服务端
+      uint32_t available = (data_len - (uint32_t) sizeof (IPCServerStats))
+			   / sizeof (IPCCommandStats);
+      uint32_t entries = page.command_count;
+      if (entries > available)
+	entries = available;
+      if (entries > max_commands - collected)
+	entries = max_commands - collected;
+      if (entries > 0)
+	memcpy (commands + collected, buffer + sizeof (IPCServerStats),
+		entries * sizeof (IPCCommandStats));
+      collected += entries;
+
+      if (entries == 0 || collected >= max_commands
+	  || collected >= page.total_commands)
+	break;
+    }
+
+  stats->command_count = collected;
+  if (count != NULL)
+    *count = collected;
+  return 0;
+}
+
+// 获取均衡器配置
+int
+ipc_client_get_equalizer (IPCClientContext *ctx, IPCEqualizerConfig *config)
+{
+  if (ctx == NULL || config == NULL)
+    return -1;
+
+  uint32_t data_len = 0;
+  int32_t status = ipc_client_call (ctx, kIPCCommandGetEqualizer, NULL, 0,
+				    config, sizeof (*config), &data_len);
+  if (status != kIPCStatusOK || data_len < sizeof (*config))
+    return -1;
+  return 0;
+}
+
+// 设置均衡器配置
+int
+ipc_client_set_equalizer (IPCClientContext *ctx,
+			  const IPCEqualizerConfig *config)
+{
+  if (ctx == NULL || config == NULL)
+    return -1;
+  if (!ipc_client_is_connected (ctx))
+    return -1;
+
+  int32_t status = ipc_client_call (ctx, kIPCCommandSetEqualizer, config,
+				    sizeof (*config), NULL, 0, NULL);
+  return (status == kIPCStatusOK) ? 0 : -1;
+}
+
+// 获取响度均衡配置
+int
+ipc_client_get_normalizer (IPCClientContext *ctx, IPCNormalizerConfig *config)
+{
+  if (ctx == NULL || config == NULL)
+    return -1;
+
+  uint32_t data_len = 0;
+  int32_t status = ipc_client_call (ctx, kIPCCommandGetNormalizer, NULL, 0,
+				    config, sizeof (*config), &data_len);
+  if (status != kIPCStatusOK || data_len < sizeof (*config))
+    return -1;
+  return 0;
+}
+
+// 设置响度均衡配置
+int
+ipc_client_set_normalizer (IPCClientContext *ctx,
+			   const IPCNormalizerConfig *config)
+{
+  if (ctx == NULL || config == NULL)
+    return -1;
+  if (!ipc_client_is_connected (ctx))
+    return -1;
+
+  int32_t status = ipc_client_call (ctx, kIPCCommandSetNormalizer, config,
+				    sizeof (*config), NULL, 0, NULL);
+  return (status == kIPCStatusOK) ? 0 : -1;
+}
+
+// 获取闪避规则
+int
+ipc_client_get_ducking (IPCClientContext *ctx, IPCDuckingConfig *config)
+{
+  if (ctx == NULL || config == NULL)
+    return -1;
+
+  uint32_t data_len = 0;
+  int32_t status = ipc_client_call (ctx, kIPCCommandGetDucking, NULL, 0,
+				    config, sizeof (*config), &data_len);
+  if (status != kIPCStatusOK || data_len < sizeof (*config))
+    return -1;
+  return 0;
+}
+
+// 设置闪避规则
+int
+ipc_client_set_ducking (IPCClientContext *ctx,
+			const IPCDuckingConfig *config)
+{
+  if (ctx == NULL || config == NULL)
+    return -1;
+  if (!ipc_client_is_connected (ctx))
+    return -1;
+
+  int32_t status = ipc_client_call (ctx, kIPCCommandSetDucking, config,
+				    sizeof (*config), NULL, 0, NULL);
+  return (status == kIPCStatusOK) ? 0 : -1;
+}
+
+// 获取各应用的声道混合规则
+int
+ipc_client_get_channel_mix (IPCClientContext *ctx,
+			    IPCChannelMixConfig *config)
+{
+  if (ctx == NULL || config == NULL)
+    return -1;
+
+  uint32_t data_len = 0;
+  int32_t status = ipc_client_call (ctx, kIPCCommandGetChannelMix, NULL, 0,
+				    config, sizeof (*config), &data_len);
+  if (status != kIPCStatusOK || data_len < sizeof (*config))
+    return -1;
+  return 0;
+}
+
+// 批量更新声道混合规则
+int
+ipc_client_update_channel_mix (IPCClientContext *ctx,
+			       const IPCChannelMixConfig *update,
+			       IPCChannelMixConfig *config)
+{
+  if (ctx == NULL || update == NULL
+      || update->count > IPC_CHANNEL_MIX_MAX_APPS)
+    return -1;
+  if (!ipc_client_is_connected (ctx))
+    return -1;
+
+  IPCChannelMixConfig merged;
+  uint32_t data_len = 0;
+  uint32_t request_len
+    = (uint32_t) (offsetof (IPCChannelMixConfig, rules)
+		  + update->count * sizeof (IPCChannelMixRule));
+  int32_t status
+    = ipc_client_call (ctx, kIPCCommandSetChannelMix, update, request_len,
+		       &merged, sizeof (merged), &data_len);
+  if (status != kIPCStatusOK || data_len < sizeof (merged))
+    return -1;
+  if (config != NULL)
+    *config = merged;
+  return 0;
+}
+
+// 获取卷积器配置
+int
+ipc_client_get_convolver (IPCClientContext *ctx, IPCConvolverConfig *config)
+{
+  if (ctx == NULL || config == NULL)
+    return -1;
+
+  uint32_t data_len = 0;
+  int32_t status = ipc_client_call (ctx, kIPCCommandGetConvolver, NULL, 0,
+				    config, sizeof (*config), &data_len);
+  if (status != kIPCStatusOK || data_len < sizeof (*config))
+    return -1;
+  return 0;
+}
+
+// 设置卷积器配置
+int
+ipc_client_set_convolver (IPCClientContext *ctx,
+			  const IPCConvolverConfig *config)
+{
+  if (ctx == NULL || config == NULL)
+    return -1;
+  if (!ipc_client_is_connected (ctx))
+    return -1;
+
+  int32_t status = ipc_client_call (ctx, kIPCCommandSetConvolver, config,
+				    sizeof (*config), NULL, 0, NULL);
+  return (status == kIPCStatusOK) ? 0 : -1;
+}
+
+// 获取交叉馈送配置
+int
+ipc_client_get_crossfeed (IPCClientContext *ctx, IPCCrossfeedConfig *config)
+{
+  if (ctx == NULL || config == NULL)
+    return -1;
+
+  uint32_t data_len = 0;
+  int32_t status = ipc_client_call (ctx, kIPCCommandGetCrossfeed, NULL, 0,
+				    config, sizeof (*config), &data_len);
+  if (status != kIPCStatusOK || data_len < sizeof (*config))
+    return -1;
+  return 0;
+}
+
+// 设置交叉馈送配置
+int
+ipc_client_set_crossfeed (IPCClientContext *ctx,
+			  const IPCCrossfeedConfig *config)
+{
+  if (ctx == NULL || config == NULL)
+    return -1;
+  if (!ipc_client_is_connected (ctx))
+    return -1;
+
+  int32_t status = ipc_client_call (ctx, kIPCCommandSetCrossfeed, config,
+				    sizeof (*config), NULL, 0, NULL);
+  return (status == kIPCStatusOK) ? 0 : -1;
+}
+
+// 获取频谱分析配置
+int
+ipc_client_get_spectrum (IPCClientContext *ctx, IPCSpectrumConfig *config)
+{
+  if (ctx == NULL || config == NULL)
+    return -1;
+
+  uint32_t data_len = 0;
+  int32_t status = ipc_client_call (ctx, kIPCCommandGetSpectrum, NULL, 0,
+				    config, sizeof (*config), &data_len);
+  if (status != kIPCStatusOK || data_len < sizeof (*config))
+    return -1;
+  return 0;
+}
+
+// 设置频谱分析配置
+int
+ipc_client_set_spectrum (IPCClientContext *ctx,
+			 const IPCSpectrumConfig *config)
+{
+  if (ctx == NULL || config == NULL)
+    return -1;
+  if (!ipc_client_is_connected (ctx))
+    return -1;
+
+  int32_t status = ipc_client_call (ctx, kIPCCommandSetSpectrum, config,
+				    sizeof (*config), NULL, 0, NULL);
+  return (status == kIPCStatusOK) ? 0 : -1;
+}
+
+// 获取录音请求和状态
+int
+ipc_client_get_recording (IPCClientContext *ctx, IPCRecordReport *report)
+{
+  if (ctx == NULL || report == NULL)
+    return -1;
+
+  uint32_t data_len = 0;
+  int32_t status = ipc_client_call (ctx, kIPCCommandGetRecording, NULL, 0,
+				    report, sizeof (*report), &data_len);
+  if (status != kIPCStatusOK || data_len < sizeof (*report))
+    return -1;
+  return 0;
+}
+
+// 发送录音请求
+int
+ipc_client_set_recording (IPCClientContext *ctx, const IPCRecordConfig *config,
+			  uint32_t *generation)
+{
+  if (ctx == NULL || config == NULL)
+    return -1;
+  if (!ipc_client_is_connected (ctx))
+    return -1;
+
+  IPCRecordConfig applied;
+  uint32_t data_len = 0;
+  int32_t status
+    = ipc_client_call (ctx, kIPCCommandSetRecording, config, sizeof (*config),
+		       &applied, sizeof (applied), &data_len);
+  if (status != kIPCStatusOK || data_len < sizeof (applied))
+    return -1;
+  if (generation != NULL)
+    *generation = applied.generation;
+  return 0;
+}
+
+// 获取网络推流配置
+int
+ipc_client_get_stream (IPCClientContext *ctx, IPCStreamConfig *config)
+{
+  if (ctx == NULL || config == NULL)
+    return -1;
+
+  uint32_t data_len = 0;
+  int32_t status = ipc_client_call (ctx, kIPCCommandGetStream, NULL, 0,
+				    config, sizeof (*config), &data_len);
+  if (status != kIPCStatusOK || data_len < sizeof (*config))
+    return -1;
+  return 0;
+}
+
+// 设置网络推流配置
+int
+ipc_client_set_stream (IPCClientContext *ctx, const IPCStreamConfig *config)
+{
+  if (ctx == NULL || config == NULL)
+    return -1;
+  if (!ipc_client_is_connected (ctx))
+    return -1;
+
+  int32_t status = ipc_client_call (ctx, kIPCCommandSetStream, config,
+				    sizeof (*config), NULL, 0, NULL);
+  return (status == kIPCStatusOK) ? 0 : -1;
+}
+
+// 获取最近的 Router 性能快照
+int
+ipc_client_get_router_stats (IPCClientContext *ctx,
+			     IPCRouterStatsSnapshot *snapshots,
+			     uint32_t max_snapshots, uint32_t *count)
+{
+  if (ctx == NULL || snapshots == NULL || count == NULL)
+    return -1;
+  *count = 0;
+
+  uint8_t buffer[IPC_MAX_PAYLOAD_SIZE];
+  uint32_t data_len = 0;
+  int32_t status = ipc_client_call (ctx, kIPCCommandGetRouterStats, NULL, 0,
+				    buffer, sizeof (buffer), &data_len);
+  if (status != kIPCStatusOK)
+    return -1;
+
+  // 容量不足时保留最新的快照
+  uint32_t available = data_len / (uint32_t) sizeof (IPCRouterStatsSnapshot);
+  uint32_t skip = available > max_snapshots ? available - max_snapshots : 0;
+  uint32_t entries = available - skip;
+  if (entries > 0)
+    memcpy (snapshots, buffer + skip * sizeof (IPCRouterStatsSnapshot),
+	    entries * sizeof (IPCRouterStatsSnapshot));
+  *count = entries;
+  return 0;
+}
+
+// 获取最新的响度读数
+int
+ipc_client_get_loudness (IPCClientContext *ctx, IPCLoudnessEntry *entries,
+			 uint32_t max_entries, uint32_t *count)
+{
+  if (ctx == NULL || entries == NULL || count == NULL)
+    return -1;
+  *count = 0;
+
+  uint8_t buffer[IPC_MAX_PAYLOAD_SIZE];
+  uint32_t data_len = 0;
+  int32_t status = ipc_client_call (ctx, kIPCCommandGetLoudness, NULL, 0,
+				    buffer, sizeof (buffer), &data_len);
+  if (status != kIPCStatusOK || data_len < sizeof (IPCLoudnessReport))
+    return -1;
+
+  // 只复制实际收到的条目
+  IPCLoudnessReport report;
+  memcpy (&report, buffer, sizeof (report));
+  uint32_t available = (data_len - (uint32_t) sizeof (report))
+		       / (uint32_t) sizeof (IPCLoudnessEntry);
+  uint32_t n = report.count < available ? report.count : available;
+  if (n > max_entries)
+    n = max_entries;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      memcpy (&entries[i], buffer + sizeof (report) + i * sizeof (entries[i]),
+	      sizeof (entries[i]));
+      entries[i].name[IPC_LOUDNESS_NAME_MAX - 1] = '\0';
+    }
+  *count = n;
+  return 0;
+}
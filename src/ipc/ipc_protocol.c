@@ -8,11 +8,26 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <limits.h>
+#include <math.h>
 
 int
 get_ipc_socket_path (char *path, size_t path_size)
 {
+  // 环境变量覆盖，便于在隔离环境中运行服务端和压测工具
+  const char *override = getenv (IPC_SOCKET_PATH_ENV);
+  if (override != NULL && override[0] != '\0')
+    {
+      if (strlen (override) >= path_size)
+	{
+	  fprintf (stderr, "错误: 路径缓冲区太小\n");
+	  return -1;
+	}
+      strcpy (path, override);
+      return 0;
+    }
+
   char support_dir[PATH_MAX];
   if (get_support_directory (support_dir, sizeof (support_dir)) != 0)
     {
@@ -79,8 +94,35 @@ ipc_validate_header (const IPCMessageHeader *header)
     case kIPCCommandSetMute:
     case kIPCCommandListClients:
     case kIPCCommandPing:
+    case kIPCCommandGetStats:
+    case kIPCCommandPublishRouterStats:
+    case kIPCCommandGetRouterStats:
+    case kIPCCommandSubscribe:
+    case kIPCCommandGetEqualizer:
+    case kIPCCommandSetEqualizer:
+    case kIPCCommandPublishLoudness:
+    case kIPCCommandGetLoudness:
+    case kIPCCommandGetNormalizer:
+    case kIPCCommandSetNormalizer:
+    case kIPCCommandGetDucking:
+    case kIPCCommandSetDucking:
+    case kIPCCommandGetChannelMix:
+    case kIPCCommandSetChannelMix:
+    case kIPCCommandGetConvolver:
+    case kIPCCommandSetConvolver:
+    case kIPCCommandGetCrossfeed:
+    case kIPCCommandSetCrossfeed:
+    case kIPCCommandGetSpectrum:
+    case kIPCCommandSetSpectrum:
+    case kIPCCommandPublishSpectrum:
+    case kIPCCommandGetRecording:
+    case kIPCCommandSetRecording:
+    case kIPCCommandPublishRecording:
+    case kIPCCommandGetStream:
+    case kIPCCommandSetStream:
     case kIPCCommandResponse:
     case kIPCCommandError:
+    case kIPCCommandEvent:
       return true;
     default:
       return false;
@@ -108,7 +150,506 @@ ipc_status_to_string (int32_t status)
       return "Service unavailable";
     case kIPCStatusInternalError:
       return "Internal error";
+    case kIPCStatusInvalidParameter:
+      return "Invalid parameter";
     default:
       return "Unknown status";
     }
 }
+
+// 将指令类型转换为可读字符串
+const char *
+ipc_command_to_string (uint16_t command)
+{
+  switch (command)
+    {
+    case kIPCCommandRegister:
+      return "register";
+    case kIPCCommandUnregister:
+      return "unregister";
+    case kIPCCommandGetVolume:
+      return "get-volume";
+    case kIPCCommandSetVolume:
+      return "set-volume";
+    case kIPCCommandGetMute:
+      return "get-mute";
+    case kIPCCommandSetMute:
+      return "set-mute";
+    case kIPCCommandListClients:
+      return "list-clients";
+    case kIPCCommandPing:
+      return "ping";
+    case kIPCCommandGetStats:
+      return "get-stats";
+    case kIPCCommandPublishRouterStats:
+      return "publish-router";
+    case kIPCCommandGetRouterStats:
+      return "get-router";
+    case kIPCCommandSubscribe:
+      return "subscribe";
+    case kIPCCommandGetEqualizer:
+      return "get-eq";
+    case kIPCCommandSetEqualizer:
+      return "set-eq";
+    case kIPCCommandPublishLoudness:
+      return "publish-lufs";
+    case kIPCCommandGetLoudness:
+      return "get-lufs";
+    case kIPCCommandGetNormalizer:
+      return "get-normalize";
+    case kIPCCommandSetNormalizer:
+      return "set-normalize";
+    case kIPCCommandGetDucking:
+      return "get-ducking";
+    case kIPCCommandSetDucking:
+      return "set-ducking";
+    case kIPCCommandGetChannelMix:
+      return "get-mix";
+    case kIPCCommandSetChannelMix:
+      return "set-mix";
+    case kIPCCommandGetConvolver:
+      return "get-convolve";
+    case kIPCCommandSetConvolver:
+      return "set-convolve";
+    case kIPCCommandGetCrossfeed:
+      return "get-crossfeed";
+    case kIPCCommandSetCrossfeed:
+      return "set-crossfeed";
+    case kIPCCommandGetSpectrum:
+      return "get-spectrum";
+    case kIPCCommandSetSpectrum:
+      return "set-spectrum";
+    case kIPCCommandPublishSpectrum:
+      return "publish-spec";
+    case kIPCCommandGetRecording:
+      return "get-record";
+    case kIPCCommandSetRecording:
+      return "set-record";
+    case kIPCCommandPublishRecording:
+      return "publish-rec";
+    case kIPCCommandGetStream:
+      return "get-stream";
+    case kIPCCommandSetStream:
+      return "set-stream";
+    default:
+      return "unknown";
+    }
+}
+
+// 检查均衡器配置是否有效
+bool
+ipc_equalizer_config_is_valid (const IPCEqualizerConfig *config)
+{
+  if (config == NULL || config->band_count > IPC_EQ_MAX_BANDS
+      || !(fabsf (config->preamp_db) <= IPC_EQ_MAX_GAIN_DB))
+    return false;
+
+  // 比较均写成“在范围内”的形式再取反，NaN 同样被拒绝
+  for (uint32_t i = 0; i < config->band_count; i++)
+    {
+      const IPCEqualizerBand *band = &config->bands[i];
+      if (band->type >= kIPCEqualizerTypeCount
+	  || !(band->frequency >= IPC_EQ_MIN_FREQ
+	       && band->frequency <= IPC_EQ_MAX_FREQ)
+	  || !(fabsf (band->gain_db) <= IPC_EQ_MAX_GAIN_DB)
+	  || !(band->q >= IPC_EQ_MIN_Q && band->q <= IPC_EQ_MAX_Q))
+	return false;
+    }
+  return true;
+}
+
+// 填入响度均衡的默认配置
+void
+ipc_normalizer_config_init (IPCNormalizerConfig *config)
+{
+  memset (config, 0, sizeof (*config));
+  config->target_lufs = -18.0f;
+  config->max_boost_db = 12.0f;
+  config->max_cut_db = 24.0f;
+  config->attack_db_per_s = 6.0f;
+  config->release_db_per_s = 1.5f;
+}
+
+// 检查响度均衡配置是否有效
+bool
+ipc_normalizer_config_is_valid (const IPCNormalizerConfig *config)
+{
+  // 比较均写成“在范围内”的形式，NaN 不满足任何一项
+  return config != NULL && config->target_lufs >= IPC_NORMALIZER_MIN_TARGET_LUFS
+	 && config->target_lufs <= IPC_NORMALIZER_MAX_TARGET_LUFS
+	 && config->max_boost_db >= 0.0f
+	 && config->max_boost_db <= IPC_NORMALIZER_MAX_BOOST_DB
+	 && config->max_cut_db >= 0.0f
+	 && config->max_cut_db <= IPC_NORMALIZER_MAX_CUT_DB
+	 && config->attack_db_per_s >= IPC_NORMALIZER_MIN_RATE_DB
+	 && config->attack_db_per_s <= IPC_NORMALIZER_MAX_RATE_DB
+	 && config->release_db_per_s >= IPC_NORMALIZER_MIN_RATE_DB
+	 && config->release_db_per_s <= IPC_NORMALIZER_MAX_RATE_DB;
+}
+
+// 默认闪避规则中的应用
+static const char *const kDefaultVoiceApps[] = {
+  "us.zoom.xos",	 "com.microsoft.teams2", "com.microsoft.teams",
+  "com.apple.FaceTime", "com.hnc.Discord",	 "com.tinyspeck.slackmacgap",
+};
+static const char *const kDefaultMediaApps[] = {
+  "com.spotify.client", "com.apple.Music", "com.apple.TV",
+  "com.apple.Safari",	"com.google.Chrome", "org.videolan.vlc",
+};
+
+// 填入默认闪避规则
+void
+ipc_ducking_config_init (IPCDuckingConfig *config)
+{
+  memset (config, 0, sizeof (*config));
+  config->depth_db = 12.0f;
+  config->threshold_lufs = -45.0f;
+  config->attack_ms = 150.0f;
+  config->hold_ms = 1000.0f;
+  config->release_ms = 1500.0f;
+
+  size_t voice = sizeof (kDefaultVoiceApps) / sizeof (kDefaultVoiceApps[0]);
+  size_t media = sizeof (kDefaultMediaApps) / sizeof (kDefaultMediaApps[0]);
+  for (size_t i = 0; i < voice; i++)
+    snprintf (config->voice[i], IPC_DUCKING_ID_MAX, "%s", kDefaultVoiceApps[i]);
+  for (size_t i = 0; i < media; i++)
+    snprintf (config->media[i], IPC_DUCKING_ID_MAX, "%s", kDefaultMediaApps[i]);
+  config->voice_count = (uint8_t) voice;
+  config->media_count = (uint8_t) media;
+}
+
+// 列表中的 ID 必须以 0 结尾且非空
+static bool
+ducking_list_is_valid (const char list[][IPC_DUCKING_ID_MAX], uint32_t count)
+{
+  if (count > IPC_DUCKING_MAX_APPS)
+    return false;
+  for (uint32_t i = 0; i < count; i++)
+    {
+      if (list[i][0] == '\0'
+	  || memchr (list[i], '\0', IPC_DUCKING_ID_MAX) == NULL)
+	return false;
+    }
+  return true;
+}
+
+// 检查闪避规则是否有效
+bool
+ipc_ducking_config_is_valid (const IPCDuckingConfig *config)
+{
+  // 比较均写成“在范围内”的形式，NaN 不满足任何一项
+  return config != NULL
+	 && ducking_list_is_valid (config->voice, config->voice_count)
+	 && ducking_list_is_valid (config->media, config->media_count)
+	 && config->depth_db >= 0.0f
+	 && config->depth_db <= IPC_DUCKING_MAX_DEPTH_DB
+	 && config->threshold_lufs >= IPC_DUCKING_MIN_THRESHOLD_LUFS
+	 && config->threshold_lufs <= IPC_DUCKING_MAX_THRESHOLD_LUFS
+	 && config->attack_ms >= IPC_DUCKING_MIN_RAMP_MS
+	 && config->attack_ms <= IPC_DUCKING_MAX_TIME_MS
+	 && config->hold_ms >= 0.0f && config->hold_ms <= IPC_DUCKING_MAX_TIME_MS
+	 && config->release_ms >= IPC_DUCKING_MIN_RAMP_MS
+	 && config->release_ms <= IPC_DUCKING_MAX_TIME_MS;
+}
+
+static bool
+ducking_list_contains (const char list[][IPC_DUCKING_ID_MAX], uint32_t count,
+		       const char *bundle_id, const char *name)
+{
+  for (uint32_t i = 0; i < count && i < IPC_DUCKING_MAX_APPS; i++)
+    {
+      if ((bundle_id != NULL
+	   && strncasecmp (list[i], bundle_id, IPC_DUCKING_ID_MAX) == 0)
+	  || (name != NULL && strncasecmp (list[i], name, IPC_DUCKING_ID_MAX) == 0))
+	return true;
+    }
+  return false;
+}
+
+// 按规则确定应用的角色
+IPCDuckingRole
+ipc_ducking_config_role (const IPCDuckingConfig *config, const char *bundle_id,
+			 const char *name)
+{
+  if (config == NULL)
+    return kIPCDuckingRoleNone;
+  if (ducking_list_contains (config->voice, config->voice_count, bundle_id,
+			     name))
+    return kIPCDuckingRoleVoice;
+  if (ducking_list_contains (config->media, config->media_count, bundle_id,
+			     name))
+    return kIPCDuckingRoleMedia;
+  return kIPCDuckingRoleNone;
+}
+
+// 清空声道混合规则表
+void
+ipc_channel_mix_config_init (IPCChannelMixConfig *config)
+{
+  memset (config, 0, sizeof (*config));
+}
+
+// 规则是否为中性
+bool
+ipc_channel_mix_rule_is_neutral (const IPCChannelMixRule *rule)
+{
+  return rule->balance == 0.0f && rule->pan == 0.0f && rule->flags == 0;
+}
+
+static bool
+channel_mix_rule_is_valid (const IPCChannelMixRule *rule)
+{
+  // 比较均写成“在范围内”的形式，NaN 不满足任何一项
+  return rule->app[0] != '\0'
+	 && memchr (rule->app, '\0', IPC_CHANNEL_MIX_ID_MAX) != NULL
+	 && rule->balance >= -1.0f && rule->balance <= 1.0f
+	 && rule->pan >= -1.0f && rule->pan <= 1.0f
+	 && (rule->flags & ~(kIPCChannelMixMono | kIPCChannelMixSwap)) == 0;
+}
+
+// 查找应用 ID 所在位置，未找到返回 -1
+static int
+channel_mix_index (const IPCChannelMixConfig *config, const char *app)
+{
+  for (uint32_t i = 0; i < config->count && i < IPC_CHANNEL_MIX_MAX_APPS; i++)
+    {
+      if (strncasecmp (config->rules[i].app, app, IPC_CHANNEL_MIX_ID_MAX) == 0)
+	return (int) i;
+    }
+  return -1;
+}
+
+// 检查规则表是否有效
+bool
+ipc_channel_mix_config_is_valid (const IPCChannelMixConfig *config)
+{
+  if (config == NULL || config->count > IPC_CHANNEL_MIX_MAX_APPS)
+    return false;
+  for (uint32_t i = 0; i < config->count; i++)
+    {
+      const IPCChannelMixRule *rule = &config->rules[i];
+      if (!channel_mix_rule_is_valid (rule))
+	return false;
+      for (uint32_t j = 0; j < i; j++)
+	{
+	  if (strncasecmp (config->rules[j].app, rule->app,
+			   IPC_CHANNEL_MIX_ID_MAX)
+	      == 0)
+	    return false;
+	}
+    }
+  return true;
+}
+
+// 把一批规则合并进规则表（在副本上合并，成功后整体替换）
+int
+ipc_channel_mix_config_merge (IPCChannelMixConfig *config,
+			      const IPCChannelMixConfig *update)
+{
+  if (config == NULL || !ipc_channel_mix_config_is_valid (update))
+    return -1;
+
+  IPCChannelMixConfig merged = *config;
+  for (uint32_t i = 0; i < update->count; i++)
+    {
+      const IPCChannelMixRule *rule = &update->rules[i];
+      int index = channel_mix_index (&merged, rule->app);
+      if (ipc_channel_mix_rule_is_neutral (rule))
+	{
+	  if (index < 0)
+	    continue;
+	  // 删除：后面的规则前移，保持顺序
+	  memmove (&merged.rules[index], &merged.rules[index + 1],
+		   (merged.count - (uint32_t) index - 1)
+		     * sizeof (IPCChannelMixRule));
+	  merged.count--;
+	  memset (&merged.rules[merged.count], 0, sizeof (IPCChannelMixRule));
+	  continue;
+	}
+      if (index < 0)
+	{
+	  if (merged.count >= IPC_CHANNEL_MIX_MAX_APPS)
+	    return -1;
+	  index = merged.count++;
+	}
+      merged.rules[index] = *rule;
+      memset (merged.rules[index].reserved, 0,
+	      sizeof (merged.rules[index].reserved));
+    }
+
+  *config = merged;
+  return 0;
+}
+
+// 查找应用的规则
+const IPCChannelMixRule *
+ipc_channel_mix_config_find (const IPCChannelMixConfig *config,
+			     const char *bundle_id, const char *name)
+{
+  if (config == NULL)
+    return NULL;
+  int index = bundle_id != NULL ? channel_mix_index (config, bundle_id) : -1;
+  if (index < 0 && name != NULL)
+    index = channel_mix_index (config, name);
+  return index >= 0 ? &config->rules[index] : NULL;
+}
+
+// 检查卷积器配置是否有效
+bool
+ipc_convolver_config_is_valid (const IPCConvolverConfig *config)
+{
+  if (config == NULL || !(config->gain_db >= IPC_CONVOLVER_MIN_GAIN_DB
+			  && config->gain_db <= IPC_CONVOLVER_MAX_GAIN_DB))
+    return false;
+  if (memchr (config->path, '\0', sizeof (config->path)) == NULL)
+    return false;
+  if (config->path[0] == '\0')
+    return config->enabled == 0;
+  return config->path[0] == '/';
+}
+
+// 交叉馈送默认配置
+void
+ipc_crossfeed_config_init (IPCCrossfeedConfig *config)
+{
+  memset (config, 0, sizeof (*config));
+  config->mode = kIPCCrossfeedOff;
+  config->preset = kIPCCrossfeedMedium;
+}
+
+// 检查交叉馈送配置是否有效
+bool
+ipc_crossfeed_config_is_valid (const IPCCrossfeedConfig *config)
+{
+  return config != NULL && config->mode < kIPCCrossfeedModeCount
+	 && config->preset < kIPCCrossfeedPresetCount;
+}
+
+// 频谱分析默认配置
+void
+ipc_spectrum_config_init (IPCSpectrumConfig *config)
+{
+  memset (config, 0, sizeof (*config));
+  config->fft_size = 2048;
+  config->band_count = 64;
+  config->fps = 30;
+  config->decimation = 1;
+}
+
+// 检查频谱分析配置是否有效
+bool
+ipc_spectrum_config_is_valid (const IPCSpectrumConfig *config)
+{
+  if (config == NULL)
+    return false;
+  uint32_t size = config->fft_size;
+  uint32_t decimation = config->decimation;
+  return size >= IPC_SPECTRUM_MIN_SIZE && size <= IPC_SPECTRUM_MAX_SIZE
+	 && (size & (size - 1)) == 0 && config->band_count >= 1
+	 && config->band_count <= IPC_SPECTRUM_MAX_BANDS && config->fps >= 1
+	 && config->fps <= IPC_SPECTRUM_MAX_FPS && decimation >= 1
+	 && decimation <= IPC_SPECTRUM_MAX_DECIMATION
+	 && (decimation & (decimation - 1)) == 0;
+}
+
+// 检查上报的频谱帧是否有效
+bool
+ipc_spectrum_frame_is_valid (const IPCSpectrumFrame *frame, uint32_t length)
+{
+  if (frame == NULL || length < IPC_SPECTRUM_FRAME_HEADER_SIZE
+      || frame->band_count > IPC_SPECTRUM_MAX_BANDS
+      || length != IPC_SPECTRUM_FRAME_HEADER_SIZE
+			+ frame->band_count * sizeof (float))
+    return false;
+  if (frame->band_count == 0)
+    return true;
+  uint32_t size = frame->fft_size;
+  return size >= IPC_SPECTRUM_MIN_SIZE && size <= IPC_SPECTRUM_MAX_SIZE
+	 && (size & (size - 1)) == 0 && frame->sample_rate > 0;
+}
+
+// 检查录音请求是否有效
+bool
+ipc_record_config_is_valid (const IPCRecordConfig *config)
+{
+  if (config == NULL || config->format >= kIPCRecordFormatCount
+      || memchr (config->directory, '\0', sizeof (config->directory)) == NULL)
+    return false;
+  if (config->directory[0] == '\0')
+    return config->recording == 0;
+  return config->directory[0] == '/';
+}
+
+// 检查上报的录音状态是否有效
+bool
+ipc_record_status_is_valid (const IPCRecordStatus *status)
+{
+  return status != NULL && status->format < kIPCRecordFormatCount
+	 && memchr (status->path, '\0', sizeof (status->path)) != NULL;
+}
+
+// 网络推流默认配置
+void
+ipc_stream_config_init (IPCStreamConfig *config)
+{
+  memset (config, 0, sizeof (*config));
+  config->ptime_ms = 2;
+  config->port = IPC_STREAM_DEFAULT_PORT;
+}
+
+// 检查网络推流配置是否有效
+bool
+ipc_stream_config_is_valid (const IPCStreamConfig *config)
+{
+  if (config == NULL || config->ptime_ms < IPC_STREAM_MIN_PTIME_MS
+      || config->ptime_ms > IPC_STREAM_MAX_PTIME_MS || config->port == 0
+      || memchr (config->host, '\0', sizeof (config->host)) == NULL)
+    return false;
+  return config->enabled == 0 || config->host[0] != '\0';
+}
+
+// 计算耗时所在的直方图桶
+uint32_t
+ipc_stats_bucket_for_ns (uint64_t ns)
+{
+  uint64_t us = ns / 1000;
+  if (us == 0)
+    return 0;
+
+  // floor(log2(us)) + 1
+  uint32_t bucket = 0;
+  while (us != 0)
+    {
+      us >>= 1;
+      bucket++;
+    }
+  return bucket < IPC_STATS_HISTOGRAM_BUCKETS ? bucket
+					      : IPC_STATS_HISTOGRAM_BUCKETS - 1;
+}
+
+// 由直方图估算分位数
+uint64_t
+ipc_stats_histogram_quantile_us (const uint32_t *histogram, double quantile)
+{
+  if (histogram == NULL)
+    return 0;
+
+  uint64_t total = 0;
+  for (uint32_t i = 0; i < IPC_STATS_HISTOGRAM_BUCKETS; i++)
+    total += histogram[i];
+  if (total == 0)
+    return 0;
+
+  uint64_t rank = (uint64_t) (quantile * (double) total + 0.999999);
+  if (rank == 0)
+    rank = 1;
+
+  uint64_t seen = 0;
+  for (uint32_t i = 0; i < IPC_STATS_HISTOGRAM_BUCKETS - 1; i++)
+    {
+      seen += histogram[i];
+      if (seen >= rank)
+	return 1ULL << i;
+    }
+  return 1ULL << (IPC_STATS_HISTOGRAM_BUCKETS - 2);
+}
@@ -0,0 +1,434 @@
+//
+// IPC 事件循环抽象实现
+// kqueue 使用 EV_CLEAR、epoll 使用 EPOLLET，保持两种后端的边沿触发语义一致
+//
+
+#include "ipc/ipc_reactor.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(__APPLE__) || defined(__FreeBSD__)
+#define IPC_REACTOR_KQUEUE 1
+#include <sys/event.h>
+#include <time.h>
+#elif defined(__linux__)
+#define IPC_REACTOR_EPOLL 1
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#else
+#error "ipc_reactor: unsupported platform (need kqueue or epoll)"
+#endif
+
+#ifdef IPC_REACTOR_EPOLL
+// epoll_event.data.u64 高 32 位存放来源标签，低 32 位存放 fd 或定时器ID
+#define IPC_REACTOR_TAG_FD 0ULL
+#define IPC_REACTOR_TAG_TIMER 1ULL
+#define IPC_REACTOR_TAG_WAKEUP 2ULL
+#define IPC_REACTOR_MAKE_DATA(tag, value)                                      \
+  (((tag) << 32) | (uint64_t) (uint32_t) (value))
+#endif
+
+static int
+set_nonblocking (int fd)
+{
+  int flags = fcntl (fd, F_GETFL, 0);
+  if (flags == -1)
+    return -1;
+  return fcntl (fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+static IPCReactorTimerEntry *
+find_timer (IPCReactor *reactor, uint32_t timer_id)
+{
+  for (int i = 0; i < IPC_REACTOR_MAX_TIMERS; i++)
+    {
+      if (reactor->timers[i].in_use && reactor->timers[i].id == timer_id)
+	return &reactor->timers[i];
+    }
+  return NULL;
+}
+
+static void
+drain_wake_pipe (IPCReactor *reactor)
+{
+  uint8_t buf[64];
+  while (read (reactor->wake_fds[0], buf, sizeof (buf)) > 0)
+    {
+    }
+}
+
+int
+ipc_reactor_init (IPCReactor *reactor)
+{
+  if (reactor == NULL)
+    return -1;
+
+  memset (reactor, 0, sizeof (IPCReactor));
+  reactor->wake_fds[0] = -1;
+  reactor->wake_fds[1] = -1;
+  for (int i = 0; i < IPC_REACTOR_MAX_TIMERS; i++)
+    reactor->timers[i].fd = -1;
+
+#ifdef IPC_REACTOR_KQUEUE
+  reactor->backend_fd = kqueue ();
+#else
+  reactor->backend_fd = epoll_create1 (EPOLL_CLOEXEC);
+#endif
+  if (reactor->backend_fd < 0)
+    return -1;
+
+  if (pipe (reactor->wake_fds) != 0)
+    {
+      reactor->wake_fds[0] = -1;
+      reactor->wake_fds[1] = -1;
+      ipc_reactor_cleanup (reactor);
+      return -1;
+    }
+  set_nonblocking (reactor->wake_fds[0]);
+  set_nonblocking (reactor->wake_fds[1]);
+
+#ifdef IPC_REACTOR_KQUEUE
+  struct kevent ev;
+  EV_SET (&ev, reactor->wake_fds[0], EVFILT_READ, EV_ADD | EV_CLEAR, 0, 0,
+	  NULL);
+  int result = kevent (reactor->backend_fd, &ev, 1, NULL, 0, NULL);
+#else
+  struct epoll_event ev;
+  memset (&ev, 0, sizeof (ev));
+  ev.events = EPOLLIN | EPOLLET;
+  ev.data.u64 = IPC_REACTOR_MAKE_DATA (IPC_REACTOR_TAG_WAKEUP, 0);
+  int result
+    = epoll_ctl (reactor->backend_fd, EPOLL_CTL_ADD, reactor->wake_fds[0], &ev);
+#endif
+  if (result < 0)
+    {
+      ipc_reactor_cleanup (reactor);
+      return -1;
+    }
+
+  return 0;
+}
+
+void
+ipc_reactor_cleanup (IPCReactor *reactor)
+{
+  if (reactor == NULL)
+    return;
+
+  for (int i = 0; i < IPC_REACTOR_MAX_TIMERS; i++)
+    {
+      if (reactor->timers[i].in_use)
+	ipc_reactor_remove_timer (reactor, reactor->timers[i].id);
+    }
+
+  for (int i = 0; i < 2; i++)
+    {
+      if (reactor->wake_fds[i] >= 0)
+	{
+	  close (reactor->wake_fds[i]);
+	  reactor->wake_fds[i] = -1;
+	}
+    }
+
+  if (reactor->backend_fd >= 0)
+    {
+      close (reactor->backend_fd);
+      reactor->backend_fd = -1;
+    }
+}
+
+#ifdef IPC_REACTOR_KQUEUE
+// kqueue 的读写是两个独立过滤器，分别添加或删除
+static int
+kqueue_apply (IPCReactor *reactor, int fd, uint32_t interest, bool adding)
+{
+  struct kevent changes[2];
+  int count = 0;
+
+  if (interest & kIPCReactorRead)
+    EV_SET (&changes[count++], fd, EVFILT_READ, EV_ADD | EV_CLEAR, 0, 0, NULL);
+  else if (!adding)
+    EV_SET (&changes[count++], fd, EVFILT_READ, EV_DELETE, 0, 0, NULL);
+
+  if (interest & kIPCReactorWrite)
+    EV_SET (&changes[count++], fd, EVFILT_WRITE, EV_ADD | EV_CLEAR, 0, 0,
+	    NULL);
+  else if (!adding)
+    EV_SET (&changes[count++], fd, EVFILT_WRITE, EV_DELETE, 0, 0, NULL);
+
+  // 逐个提交，删除不存在的过滤器（ENOENT）不算错误
+  for (int i = 0; i < count; i++)
+    {
+      if (kevent (reactor->backend_fd, &changes[i], 1, NULL, 0, NULL) < 0
+	  && !((changes[i].flags & EV_DELETE) && errno == ENOENT))
+	return -1;
+    }
+  return 0;
+}
+#else
+static int
+epoll_apply (IPCReactor *reactor, int fd, uint32_t interest, int op)
+{
+  struct epoll_event ev;
+  memset (&ev, 0, sizeof (ev));
+  ev.events = EPOLLET | EPOLLRDHUP;
+  if (interest & kIPCReactorRead)
+    ev.events |= EPOLLIN;
+  if (interest & kIPCReactorWrite)
+    ev.events |= EPOLLOUT;
+  ev.data.u64 = IPC_REACTOR_MAKE_DATA (IPC_REACTOR_TAG_FD, fd);
+  return epoll_ctl (reactor->backend_fd, op, fd, &ev);
+}
+#endif
+
+int
+ipc_reactor_add (IPCReactor *reactor, int fd, uint32_t interest)
+{
+  if (reactor == NULL || fd < 0)
+    return -1;
+
+#ifdef IPC_REACTOR_KQUEUE
+  return kqueue_apply (reactor, fd, interest, true);
+#else
+  return epoll_apply (reactor, fd, interest, EPOLL_CTL_ADD);
+#endif
+}
+
+int
+ipc_reactor_modify (IPCReactor *reactor, int fd, uint32_t interest)
+{
+  if (reactor == NULL || fd < 0)
+    return -1;
+
+#ifdef IPC_REACTOR_KQUEUE
+  return kqueue_apply (reactor, fd, interest, false);
+#else
+  return epoll_apply (reactor, fd, interest, EPOLL_CTL_MOD);
+#endif
+}
+
+void
+ipc_reactor_remove (IPCReactor *reactor, int fd)
+{
+  if (reactor == NULL || fd < 0)
+    return;
+
+#ifdef IPC_REACTOR_KQUEUE
+  kqueue_apply (reactor, fd, 0, false);
+#else
+  epoll_ctl (reactor->backend_fd, EPOLL_CTL_DEL, fd, NULL);
+#endif
+}
+
+int
+ipc_reactor_add_timer (IPCReactor *reactor, uint32_t timer_id,
+		       uint32_t interval_ms)
+{
+  if (reactor == NULL || interval_ms == 0
+      || find_timer (reactor, timer_id) != NULL)
+    return -1;
+
+  IPCReactorTimerEntry *entry = NULL;
+  for (int i = 0; i < IPC_REACTOR_MAX_TIMERS; i++)
+    {
+      if (!reactor->timers[i].in_use)
+	{
+	  entry = &reactor->timers[i];
+	  break;
+	}
+    }
+  if (entry == NULL)
+    return -1;
+
+#ifdef IPC_REACTOR_KQUEUE
+  // EVFILT_TIMER 默认以毫秒为单位，ident 与 fd 处于不同命名空间
+  struct kevent ev;
+  EV_SET (&ev, timer_id, EVFILT_TIMER, EV_ADD | EV_ENABLE, 0, interval_ms,
+	  NULL);
+  if (kevent (reactor->backend_fd, &ev, 1, NULL, 0, NULL) < 0)
+    return -1;
+  entry->fd = -1;
+#else
+  int tfd = timerfd_create (CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  if (tfd < 0)
+    return -1;
+
+  struct itimerspec spec;
+  spec.it_interval.tv_sec = interval_ms / 1000;
+  spec.it_interval.tv_nsec = (long) (interval_ms % 1000) * 1000000L;
+  spec.it_value = spec.it_interval;
+  if (timerfd_settime (tfd, 0, &spec, NULL) < 0)
+    {
+      close (tfd);
+      return -1;
+    }
+
+  struct epoll_event ev;
+  memset (&ev, 0, sizeof (ev));
+  ev.events = EPOLLIN | EPOLLET;
+  ev.data.u64 = IPC_REACTOR_MAKE_DATA (IPC_REACTOR_TAG_TIMER, timer_id);
+  if (epoll_ctl (reactor->backend_fd, EPOLL_CTL_ADD, tfd, &ev) < 0)
+    {
+      close (tfd);
+      return -1;
+    }
+  entry->fd = tfd;
+#endif
+
+  entry->id = timer_id;
+  entry->in_use = true;
+  return 0;
+}
+
+void
+ipc_reactor_remove_timer (IPCReactor *reactor, uint32_t timer_id)
+{
+  if (reactor == NULL)
+    return;
+
+  IPCReactorTimerEntry *entry = find_timer (reactor, timer_id);
+  if (entry == NULL)
+    return;
+
+#ifdef IPC_REACTOR_KQUEUE
+  struct kevent ev;
+  EV_SET (&ev, timer_id, EVFILT_TIMER, EV_DELETE, 0, 0, NULL);
+  kevent (reactor->backend_fd, &ev, 1, NULL, 0, NULL);
+#else
+  epoll_ctl (reactor->backend_fd, EPOLL_CTL_DEL, entry->fd, NULL);
+  close (entry->fd);
+#endif
+
+  entry->fd = -1;
+  entry->in_use = false;
+}
+
+void
+ipc_reactor_wakeup (IPCReactor *reactor)
+{
+  if (reactor != NULL && reactor->wake_fds[1] >= 0)
+    {
+      uint8_t byte = 1;
+      (void) write (reactor->wake_fds[1], &byte, 1);
+    }
+}
+
+int
+ipc_reactor_wait (IPCReactor *reactor, IPCReactorEvent *events,
+		  int max_events, int timeout_ms)
+{
+  if (reactor == NULL || events == NULL || max_events <= 0)
+    return -1;
+
+  enum
+  {
+    kBatch = 64
+  };
+  if (max_events > kBatch)
+    max_events = kBatch;
+
+  int count = 0;
+
+#ifdef IPC_REACTOR_KQUEUE
+  struct kevent ready[kBatch];
+  struct timespec timeout;
+  struct timespec *timeout_ptr = NULL;
+  if (timeout_ms >= 0)
+    {
+      timeout.tv_sec = timeout_ms / 1000;
+      timeout.tv_nsec = (long) (timeout_ms % 1000) * 1000000L;
+      timeout_ptr = &timeout;
+    }
+
+  int nfds
+    = kevent (reactor->backend_fd, NULL, 0, ready, max_events, timeout_ptr);
+  if (nfds < 0)
+    return errno == EINTR ? 0 : -1;
+
+  for (int i = 0; i < nfds; i++)
+    {
+      IPCReactorEvent *out = &events[count];
+      out->fd = -1;
+      out->timer_id = 0;
+      out->events = 0;
+
+      if (ready[i].filter == EVFILT_TIMER)
+	{
+	  out->timer_id = (uint32_t) ready[i].ident;
+	  out->events = kIPCReactorTimer;
+	}
+      else if ((int) ready[i].ident == reactor->wake_fds[0])
+	{
+	  drain_wake_pipe (reactor);
+	  out->events = kIPCReactorWakeup;
+	}
+      else
+	{
+	  out->fd = (int) ready[i].ident;
+	  out->events = ready[i].filter == EVFILT_WRITE ? kIPCReactorWrite
+							: kIPCReactorRead;
+	  if (ready[i].flags & (EV_EOF | EV_ERROR))
+	    out->events |= kIPCReactorHangup;
+	}
+      count++;
+    }
+#else
+  struct epoll_event ready[kBatch];
+  int nfds = epoll_wait (reactor->backend_fd, ready, max_events, timeout_ms);
+  if (nfds < 0)
+    return errno == EINTR ? 0 : -1;
+
+  for (int i = 0; i < nfds; i++)
+    {
+      IPCReactorEvent *out = &events[count];
+      uint64_t tag = ready[i].data.u64 >> 32;
+      uint32_t value = (uint32_t) ready[i].data.u64;
+      out->fd = -1;
+      out->timer_id = 0;
+      out->events = 0;
+
+      if (tag == IPC_REACTOR_TAG_TIMER)
+	{
+	  // 读取到期次数以重新武装边沿触发
+	  IPCReactorTimerEntry *entry = find_timer (reactor, value);
+	  uint64_t expirations;
+	  if (entry == NULL
+	      || read (entry->fd, &expirations, sizeof (expirations)) < 0)
+	    continue;
+	  out->timer_id = value;
+	  out->events = kIPCReactorTimer;
+	}
+      else if (tag == IPC_REACTOR_TAG_WAKEUP)
+	{
+	  drain_wake_pipe (reactor);
+	  out->events = kIPCReactorWakeup;
+	}
+      else
+	{
+	  out->fd = (int) value;
+	  if (ready[i].events & EPOLLIN)
+	    out->events |= kIPCReactorRead;
+	  if (ready[i].events & EPOLLOUT)
+	    out->events |= kIPCReactorWrite;
+	  if (ready[i].events & (EPOLLHUP | EPOLLERR | EPOLLRDHUP))
+	    out->events |= kIPCReactorHangup | kIPCReactorRead;
+	}
+      count++;
+    }
+#endif
+
+  return count;
+}
+
+const char *
+ipc_reactor_backend_name (void)
+{
+#ifdef IPC_REACTOR_KQUEUE
+  return "kqueue";
+#else
+  return "epoll";
+#endif
+}
@@ -4,26 +4,93 @@
 
 #include "ipc/ipc_server.h"
 #include "ipc/ipc_protocol.h"
+#include "ipc/ipc_reactor.h"
 
 #include <errno.h>
 #include <fcntl.h>
 #include <limits.h>
 #include <pthread.h>
 #include <signal.h>
+#include <stdatomic.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <sys/event.h>
 #include <sys/socket.h>
 #include <sys/time.h>
 #include <sys/un.h>
+#include <time.h>
 #include <unistd.h>
 
+// 单条消息最大长度（消息头 + 最大负载）
+#define IPC_SERVER_FRAME_MAX (sizeof (IPCMessageHeader) + IPC_MAX_PAYLOAD_SIZE)
+// 单连接待发送数据上限，超过说明对端长期不读取，断开该连接
+#define IPC_SERVER_SEND_BUFFER_MAX (256 * 1024)
+// 每次等待最多处理的就绪事件数
+#define IPC_SERVER_MAX_EVENTS 64
+// 音量事件合并窗口：窗口内同一 PID 的多次变更只推送最后一次
+#define IPC_SERVER_EVENT_COALESCE_MS 5
+// 待推送音量事件的 PID 上限，超出时立即推送
+#define IPC_SERVER_MAX_DIRTY_PIDS 64
+
+// 统计槽位：每个已知指令一个，最后一个槽位记录未知指令
+static const uint16_t kStatsCommands[] = {
+  kIPCCommandRegister,	  kIPCCommandUnregister, kIPCCommandGetVolume,
+  kIPCCommandSetVolume,	  kIPCCommandGetMute,	 kIPCCommandSetMute,
+  kIPCCommandListClients, kIPCCommandPing,	 kIPCCommandGetStats,
+  kIPCCommandSubscribe,	  kIPCCommandPublishRouterStats,
+  kIPCCommandGetRouterStats, kIPCCommandGetEqualizer, kIPCCommandSetEqualizer,
+  kIPCCommandPublishLoudness, kIPCCommandGetLoudness, kIPCCommandGetNormalizer,
+  kIPCCommandSetNormalizer, kIPCCommandGetDucking, kIPCCommandSetDucking,
+  kIPCCommandGetChannelMix, kIPCCommandSetChannelMix, kIPCCommandGetConvolver,
+  kIPCCommandSetConvolver, kIPCCommandGetCrossfeed, kIPCCommandSetCrossfeed,
+  kIPCCommandGetSpectrum, kIPCCommandSetSpectrum, kIPCCommandPublishSpectrum,
+  kIPCCommandGetRecording, kIPCCommandSetRecording,
+  kIPCCommandPublishRecording, kIPCCommandGetStream, kIPCCommandSetStream,
+};
+#define IPC_SERVER_STATS_SLOTS                                                 \
+  (sizeof (kStatsCommands) / sizeof (kStatsCommands[0]) + 1)
+
+_Static_assert (IPC_SERVER_STATS_SLOTS <= IPC_STATS_MAX_COMMANDS,
+		"stats slots must fit the client-side command array");
+_Static_assert (IPC_STATS_PAGE_ENTRIES >= 16,
+		"stats page must hold the common commands");
+_Static_assert (sizeof (IPCResponse)
+		    + IPC_ROUTER_STATS_HISTORY * sizeof (IPCRouterStatsSnapshot)
+		  <= IPC_MAX_PAYLOAD_SIZE,
+		"router stats response must fit in a single frame");
+_Static_assert (sizeof (IPCResponse) + sizeof (IPCLoudnessReport)
+		    + IPC_LOUDNESS_MAX_ENTRIES * sizeof (IPCLoudnessEntry)
+		  <= IPC_MAX_PAYLOAD_SIZE,
+		"loudness response must fit in a single frame");
+
+// 定时器ID
+enum
+{
+  kIPCServerTimerEventFlush = 1, // 推送合并后的音量事件
+};
+
+#ifdef MSG_NOSIGNAL
+#define IPC_SERVER_SEND_FLAGS MSG_NOSIGNAL
+#else
+#define IPC_SERVER_SEND_FLAGS 0
+#endif
+
 // 客户端连接结构
+// 接收缓冲区只由事件循环线程访问；发送缓冲区和订阅掩码受
+// g_connections_mutex 保护（广播可能来自其他线程）
 typedef struct ClientConnection
 {
   int fd;
   pid_t pid;
+  uint32_t subscriptions; // 订阅的事件主题掩码
+  bool want_write;	  // 是否已注册可写兴趣
+  bool broken;		  // 发送失败，等待事件循环关闭
+  size_t recv_len;	  // 已接收字节数
+  uint8_t recv_buf[IPC_SERVER_FRAME_MAX];
+  uint8_t *send_buf; // 待发送数据
+  size_t send_len;   // 待发送字节数
+  size_t send_cap;   // 发送缓冲区容量
   struct ClientConnection *next;
 } ClientConnection;
 
@@ -32,13 +99,92 @@ static IPCServerContext *g_server_ctx = NULL;
 // Add mutex to protect connection list
 static pthread_mutex_t g_connections_mutex = PTHREAD_MUTEX_INITIALIZER;
 
+// 单个指令的计数器
+// 只由事件循环线程写入，但统计查询和广播可能来自其他线程，
+// 因此全部使用 relaxed 原子操作，不需要加锁
+typedef struct
+{
+  _Atomic uint64_t requests;
+  _Atomic uint64_t bytes_in;
+  _Atomic uint64_t bytes_out;
+  _Atomic uint64_t total_ns;
+  _Atomic uint64_t max_ns;
+  _Atomic uint32_t status_counts[IPC_STATS_STATUS_COUNT];
+  _Atomic uint32_t histogram[IPC_STATS_HISTOGRAM_BUCKETS];
+} CommandCounters;
+
+// 服务端整体计数器
+typedef struct
+{
+  _Atomic uint64_t started_ms;
+  _Atomic uint32_t connections;
+  _Atomic uint32_t peak_connections;
+  _Atomic uint64_t total_connections;
+  _Atomic uint64_t events_sent;
+  _Atomic uint64_t event_bytes_out;
+  _Atomic uint64_t loop_iterations;
+  _Atomic uint64_t loop_total_ns;
+  _Atomic uint64_t loop_max_ns;
+  _Atomic uint32_t loop_histogram[IPC_STATS_HISTOGRAM_BUCKETS];
+  CommandCounters commands[IPC_SERVER_STATS_SLOTS];
+} ServerCounters;
+
+static ServerCounters g_stats;
+
+// 最近的 Router 快照（环形，仅事件循环线程访问）
+static IPCRouterStatsSnapshot g_router_stats[IPC_ROUTER_STATS_HISTORY];
+static uint32_t g_router_stats_next = 0;  // 下一个写入位置
+static uint32_t g_router_stats_count = 0; // 有效快照数
+
+// 当前均衡器配置（仅事件循环线程访问；初始为关闭、无段）
+static IPCEqualizerConfig g_equalizer;
+
+// 当前响度均衡配置（仅事件循环线程访问；初始化时填入默认值）
+static IPCNormalizerConfig g_normalizer;
+
+// 当前闪避规则（仅事件循环线程访问；初始化时填入默认规则）
+static IPCDuckingConfig g_ducking;
+
+// 当前声道混合规则（仅事件循环线程访问；初始为空）
+static IPCChannelMixConfig g_channel_mix;
+
+// 当前卷积器配置（仅事件循环线程访问；初始为关闭、无 IR）
+static IPCConvolverConfig g_convolver;
+
+// 当前交叉馈送配置（仅事件循环线程访问；初始化时填入默认配置）
+static IPCCrossfeedConfig g_crossfeed;
+
+// 当前频谱分析配置（仅事件循环线程访问；初始化时填入默认配置）
+static IPCSpectrumConfig g_spectrum;
+
+// 当前录音请求和 Router 最近上报的状态（仅事件循环线程访问；初始为停止）
+static IPCRecordReport g_record;
+
+// 当前网络推流配置（仅事件循环线程访问；初始化时填入默认配置）
+static IPCStreamConfig g_stream;
+
+// 最新的响度读数（仅事件循环线程访问）：主输出由 Router 上报，
+// 应用读数由驱动整体上报替换，超过 IPC_LOUDNESS_STALE_MS 未更新即视为失效
+static IPCLoudnessEntry g_loudness_master;
+static bool g_loudness_master_valid = false;
+static IPCLoudnessEntry g_loudness_apps[IPC_LOUDNESS_MAX_ENTRIES];
+static uint32_t g_loudness_app_count = 0;
+static uint64_t g_loudness_apps_ms = 0; // 应用读数的上报时间（单调时钟）
+
+// 待推送音量事件的 PID（仅事件循环线程访问）
+static pid_t g_dirty_pids[IPC_SERVER_MAX_DIRTY_PIDS];
+static uint32_t g_dirty_count = 0;
+static bool g_flush_timer_armed = false;
+
 // Signal handling
+// 只使用原子存储和 write()，满足异步信号安全
 static void
 signal_handler (int sig)
 {
   if ((sig == SIGTERM || sig == SIGINT) && g_server_ctx != NULL)
     {
-      g_server_ctx->running = false;
+      atomic_store (&g_server_ctx->running, false);
+      ipc_reactor_wakeup (&g_server_ctx->reactor);
     }
 }
 
@@ -51,6 +197,107 @@ get_timestamp_ms (void)
   return (uint64_t) tv.tv_sec * 1000 + tv.tv_usec / 1000;
 }
 
+// 获取单调时钟（纳秒），用于耗时统计
+static uint64_t
+get_monotonic_ns (void)
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+// ============================================================================
+// 统计
+// ============================================================================
+
+#define STATS_ADD(field, value)                                                \
+  atomic_fetch_add_explicit (&(field), (value), memory_order_relaxed)
+#define STATS_LOAD(field) atomic_load_explicit (&(field), memory_order_relaxed)
+
+static void
+stats_update_max (_Atomic uint64_t *max, uint64_t value)
+{
+  uint64_t current = atomic_load_explicit (max, memory_order_relaxed);
+  while (value > current
+	 && !atomic_compare_exchange_weak_explicit (max, &current, value,
+						    memory_order_relaxed,
+						    memory_order_relaxed))
+    {
+    }
+}
+
+static void
+stats_reset (void)
+{
+  // 只在服务端启动前调用，此时没有并发访问
+  memset (&g_stats, 0, sizeof (g_stats));
+  atomic_store (&g_stats.started_ms, get_timestamp_ms ());
+}
+
+// 指令对应的统计槽位
+static CommandCounters *
+stats_command_slot (uint16_t command)
+{
+  size_t known = IPC_SERVER_STATS_SLOTS - 1;
+  for (size_t i = 0; i < known; i++)
+    {
+      if (kStatsCommands[i] == command)
+	return &g_stats.commands[i];
+    }
+  return &g_stats.commands[known];
+}
+
+// 记录一次请求的处理结果
+static void
+stats_record_request (uint16_t command, int32_t status, uint64_t bytes_in,
+		      uint64_t bytes_out, uint64_t elapsed_ns)
+{
+  CommandCounters *slot = stats_command_slot (command);
+  STATS_ADD (slot->requests, 1);
+  STATS_ADD (slot->bytes_in, bytes_in);
+  STATS_ADD (slot->bytes_out, bytes_out);
+  STATS_ADD (slot->total_ns, elapsed_ns);
+  stats_update_max (&slot->max_ns, elapsed_ns);
+
+  // 未定义的状态码计入内部错误
+  int32_t index = -status;
+  if (index < 0 || index >= IPC_STATS_STATUS_COUNT)
+    index = -kIPCStatusInternalError;
+  STATS_ADD (slot->status_counts[index], 1);
+  STATS_ADD (slot->histogram[ipc_stats_bucket_for_ns (elapsed_ns)], 1);
+}
+
+// 记录一次事件循环迭代的处理耗时
+static void
+stats_record_loop (uint64_t elapsed_ns)
+{
+  STATS_ADD (g_stats.loop_iterations, 1);
+  STATS_ADD (g_stats.loop_total_ns, elapsed_ns);
+  stats_update_max (&g_stats.loop_max_ns, elapsed_ns);
+  STATS_ADD (g_stats.loop_histogram[ipc_stats_bucket_for_ns (elapsed_ns)], 1);
+}
+
+static void
+stats_connection_opened (void)
+{
+  STATS_ADD (g_stats.total_connections, 1);
+  uint32_t now = STATS_ADD (g_stats.connections, 1) + 1;
+  uint32_t peak = STATS_LOAD (g_stats.peak_connections);
+  while (now > peak
+	 && !atomic_compare_exchange_weak_explicit (&g_stats.peak_connections,
+						    &peak, now,
+						    memory_order_relaxed,
+						    memory_order_relaxed))
+    {
+    }
+}
+
+static void
+stats_connection_closed (void)
+{
+  atomic_fetch_sub_explicit (&g_stats.connections, 1, memory_order_relaxed);
+}
+
 // 设置 socket 为非阻塞
 static int
 set_nonblocking (int fd)
@@ -62,12 +309,12 @@ set_nonblocking (int fd)
 }
 
 // 添加客户端连接
-static int
+static ClientConnection *
 add_connection (int fd, pid_t pid)
 {
-  ClientConnection *conn = malloc (sizeof (ClientConnection));
+  ClientConnection *conn = calloc (1, sizeof (ClientConnection));
   if (conn == NULL)
-    return -1;
+    return NULL;
 
   conn->fd = fd;
   conn->pid = pid;
@@ -78,37 +325,138 @@ add_connection (int fd, pid_t pid)
   g_connections = conn;
   pthread_mutex_unlock (&g_connections_mutex);
 
-  return 0;
+  stats_connection_opened ();
+  return conn;
+}
+
+// 根据 fd 查找连接
+// 链表只在事件循环线程中修改，因此事件循环线程可以不加锁遍历
+static ClientConnection *
+find_connection (int fd)
+{
+  for (ClientConnection *conn = g_connections; conn != NULL; conn = conn->next)
+    {
+      if (conn->fd == fd)
+	return conn;
+    }
+  return NULL;
 }
 
 // Remove client connection
 static void
-remove_connection (int fd)
+remove_connection (IPCServerContext *ctx, ClientConnection *conn)
 {
   // Use mutex to protect list operations
   pthread_mutex_lock (&g_connections_mutex);
   ClientConnection **current = &g_connections;
+  while (*current != NULL && *current != conn)
+    {
+      current = &(*current)->next;
+    }
+  if (*current != NULL)
+    *current = conn->next;
+  pthread_mutex_unlock (&g_connections_mutex); // 解锁后再关闭 fd
+
+  ipc_reactor_remove (&ctx->reactor, conn->fd);
+  close (conn->fd);
+  free (conn->send_buf);
+  free (conn);
+  stats_connection_closed ();
+}
 
-  // Prevent infinite loop from corrupted list, set max iterations
-  int max_iterations = 10000;
-  int iterations = 0;
+// 更新连接的事件订阅
+static void
+set_connection_subscriptions (ClientConnection *conn, uint32_t topics)
+{
+  pthread_mutex_lock (&g_connections_mutex);
+  conn->subscriptions = topics;
+  pthread_mutex_unlock (&g_connections_mutex);
+}
 
-  while (*current != NULL && iterations < max_iterations)
+// 订阅了指定主题的连接数
+static uint32_t
+count_subscribers (uint32_t topic)
+{
+  uint32_t count = 0;
+  pthread_mutex_lock (&g_connections_mutex);
+  for (ClientConnection *conn = g_connections; conn != NULL; conn = conn->next)
     {
-      iterations++;
-      if ((*current)->fd == fd)
+      if ((conn->subscriptions & topic) != 0 && !conn->broken)
+	count++;
+    }
+  pthread_mutex_unlock (&g_connections_mutex);
+  return count;
+}
+
+// 追加数据到发送缓冲区（调用者持有 g_connections_mutex）
+static int
+queue_send_locked (ClientConnection *conn, const void *data, size_t len)
+{
+  if (conn->broken)
+    return -1;
+
+  if (conn->send_len + len > conn->send_cap)
+    {
+      size_t new_cap = conn->send_cap > 0 ? conn->send_cap : 4096;
+      while (new_cap < conn->send_len + len)
+	new_cap *= 2;
+      if (new_cap > IPC_SERVER_SEND_BUFFER_MAX)
 	{
-	  ClientConnection *to_remove = *current;
-	  *current = (*current)->next;
-	  pthread_mutex_unlock (&g_connections_mutex); // 解锁后再关闭 fd
-	  close (to_remove->fd);
-	  free (to_remove);
-	  return;
+	  conn->broken = true;
+	  return -1;
 	}
-      current = &(*current)->next;
+
+      uint8_t *new_buf = realloc (conn->send_buf, new_cap);
+      if (new_buf == NULL)
+	{
+	  conn->broken = true;
+	  return -1;
+	}
+      conn->send_buf = new_buf;
+      conn->send_cap = new_cap;
     }
 
-  pthread_mutex_unlock (&g_connections_mutex);
+  memcpy (conn->send_buf + conn->send_len, data, len);
+  conn->send_len += len;
+  return 0;
+}
+
+// 尽量发送缓冲区中的数据，未发完时注册可写兴趣
+// 调用者持有 g_connections_mutex
+static void
+flush_send_locked (IPCServerContext *ctx, ClientConnection *conn)
+{
+  size_t offset = 0;
+  while (offset < conn->send_len && !conn->broken)
+    {
+      ssize_t sent = send (conn->fd, conn->send_buf + offset,
+			   conn->send_len - offset, IPC_SERVER_SEND_FLAGS);
+      if (sent > 0)
+	{
+	  offset += (size_t) sent;
+	  continue;
+	}
+      if (sent < 0 && errno == EINTR)
+	continue;
+      if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+	break;
+      conn->broken = true;
+    }
+
+  if (offset > 0)
+    {
+      memmove (conn->send_buf, conn->send_buf + offset,
+	       conn->send_len - offset);
+      conn->send_len -= offset;
+    }
+
+  bool want_write = conn->send_len > 0 && !conn->broken;
+  if (want_write != conn->want_write)
+    {
+      uint32_t interest = kIPCReactorRead | (want_write ? kIPCReactorWrite : 0);
+      if (ipc_reactor_modify (&ctx->reactor, conn->fd, interest) == 0)
+	conn->want_write = want_write;
+    }
 }
 
 // 根据 PID 查找客户端条目
@@ -273,10 +621,24 @@ ipc_server_init (IPCServerContext *ctx)
     return -1;
 
   memset (ctx, 0, sizeof (IPCServerContext));
+  ctx->listen_fd = -1;
+  ctx->reactor.backend_fd = -1;
+  ctx->reactor.wake_fds[0] = -1;
+  ctx->reactor.wake_fds[1] = -1;
+  atomic_init (&ctx->running, false);
+  ipc_normalizer_config_init (&g_normalizer);
+  ipc_ducking_config_init (&g_ducking);
+  ipc_channel_mix_config_init (&g_channel_mix);
+  ipc_crossfeed_config_init (&g_crossfeed);
+  ipc_spectrum_config_init (&g_spectrum);
+  memset (&g_record, 0, sizeof (g_record));
+  ipc_stream_config_init (&g_stream);
 
   // 设置信号处理
   signal (SIGTERM, signal_handler);
   signal (SIGINT, signal_handler);
+  // 客户端断开后推送事件不应终止服务进程
+  signal (SIGPIPE, SIG_IGN);
 
   // 获取 socket 路径
   char socket_path[PATH_MAX];
@@ -327,161 +689,504 @@ ipc_server_init (IPCServerContext *ctx)
       return -1;
     }
 
-  // 创建 kqueue
-  ctx->epoll_fd = kqueue ();
-  if (ctx->epoll_fd < 0)
+  // 创建事件循环
+  if (ipc_reactor_init (&ctx->reactor) != 0)
     {
-      perror ("kqueue");
+      perror ("ipc_reactor_init");
       close (ctx->listen_fd);
       unlink (socket_path);
       return -1;
     }
 
-  // 注册监听 socket 到 kqueue
-  struct kevent ev;
-  EV_SET (&ev, ctx->listen_fd, EVFILT_READ, EV_ADD, 0, 0, NULL);
-  if (kevent (ctx->epoll_fd, &ev, 1, NULL, 0, NULL) < 0)
+  // 注册监听 socket
+  if (ipc_reactor_add (&ctx->reactor, ctx->listen_fd, kIPCReactorRead) < 0)
     {
-      perror ("kevent");
-      close (ctx->epoll_fd);
+      perror ("ipc_reactor_add");
+      ipc_reactor_cleanup (&ctx->reactor);
       close (ctx->listen_fd);
       unlink (socket_path);
       return -1;
     }
 
-  ctx->running = true;
+  atomic_store (&ctx->running, true);
   g_server_ctx = ctx;
+  stats_reset ();
 
   printf ("IPC 服务端已启动，监听: %s\n", socket_path);
   return 0;
 }
 
-// 处理新连接
+// 处理新连接（边沿触发：一直 accept 到 EAGAIN）
 static void
-handle_new_connection (IPCServerContext *ctx)
+handle_new_connections (IPCServerContext *ctx)
 {
-  struct sockaddr_un addr;
-  socklen_t addr_len = sizeof (addr);
-
-  int client_fd = accept (ctx->listen_fd, (struct sockaddr *) &addr, &addr_len);
-  if (client_fd < 0)
+  for (;;)
     {
-      if (errno != EAGAIN && errno != EWOULDBLOCK)
+      struct sockaddr_un addr;
+      socklen_t addr_len = sizeof (addr);
+
+      int client_fd
+	= accept (ctx->listen_fd, (struct sockaddr *) &addr, &addr_len);
+      if (client_fd < 0)
 	{
-	  perror ("accept");
+	  if (errno == EINTR)
+	    continue;
+	  if (errno != EAGAIN && errno != EWOULDBLOCK)
+	    {
+	      perror ("accept");
+	    }
+	  return;
 	}
-      return;
-    }
 
-  // 设置非阻塞
-  if (set_nonblocking (client_fd) < 0)
-    {
-      close (client_fd);
-      return;
-    }
+      // 设置非阻塞
+      if (set_nonblocking (client_fd) < 0)
+	{
+	  close (client_fd);
+	  continue;
+	}
 
-  // 注册到 kqueue
-  struct kevent ev;
-  EV_SET (&ev, client_fd, EVFILT_READ, EV_ADD, 0, 0, NULL);
-  if (kevent (ctx->epoll_fd, &ev, 1, NULL, 0, NULL) < 0)
-    {
-      perror ("kevent");
-      close (client_fd);
-      return;
-    }
+#ifdef SO_NOSIGPIPE
+      int on = 1;
+      setsockopt (client_fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof (on));
+#endif
+
+      // PID 会在注册时更新
+      ClientConnection *conn = add_connection (client_fd, 0);
+      if (conn == NULL)
+	{
+	  close (client_fd);
+	  continue;
+	}
 
-  add_connection (client_fd, 0); // PID 会在注册时更新
-  printf ("新客户端连接: fd=%d\n", client_fd);
+      // 注册到事件循环
+      if (ipc_reactor_add (&ctx->reactor, client_fd, kIPCReactorRead) < 0)
+	{
+	  perror ("ipc_reactor_add");
+	  remove_connection (ctx, conn);
+	  continue;
+	}
+
+      printf ("新客户端连接: fd=%d\n", client_fd);
+    }
 }
 
-// 发送响应
+// 把响应追加到连接的发送缓冲区
+// 同一批请求的响应在读完后统一发送，减少系统调用次数
 static int
-send_response (int fd, uint32_t request_id, int32_t status, const void *data,
-	       uint32_t data_len)
+send_response (ClientConnection *conn, uint32_t request_id, int32_t status,
+	       const void *data, uint32_t data_len)
 {
-  uint32_t total_len
-    = sizeof (IPCMessageHeader) + sizeof (IPCResponse) + data_len;
-  uint8_t *buffer = malloc (total_len);
-  if (buffer == NULL)
-    return -1;
+  uint8_t prefix[sizeof (IPCMessageHeader) + sizeof (IPCResponse)];
 
-  IPCMessageHeader *header = (IPCMessageHeader *) buffer;
+  IPCMessageHeader *header = (IPCMessageHeader *) prefix;
   ipc_init_header (header, kIPCCommandResponse, sizeof (IPCResponse) + data_len,
 		   request_id);
 
-  IPCResponse *resp = (IPCResponse *) (buffer + sizeof (IPCMessageHeader));
+  IPCResponse *resp = (IPCResponse *) (prefix + sizeof (IPCMessageHeader));
   resp->status = status;
   resp->data_len = data_len;
 
+  pthread_mutex_lock (&g_connections_mutex);
+  int result = queue_send_locked (conn, prefix, sizeof (prefix));
+  if (result == 0 && data_len > 0 && data != NULL)
+    result = queue_send_locked (conn, data, data_len);
+  pthread_mutex_unlock (&g_connections_mutex);
+
+  return result;
+}
+
+// 广播事件给所有订阅了该主题的连接
+int
+ipc_server_broadcast_event (IPCServerContext *ctx, uint32_t topic,
+			    const void *data, uint32_t data_len)
+{
+  if (ctx == NULL
+      || sizeof (IPCEventHeader) + data_len > IPC_MAX_PAYLOAD_SIZE)
+    return -1;
+
+  uint32_t payload_len = (uint32_t) sizeof (IPCEventHeader) + data_len;
+  uint32_t total_len = (uint32_t) sizeof (IPCMessageHeader) + payload_len;
+  uint8_t buffer[sizeof (IPCMessageHeader) + IPC_MAX_PAYLOAD_SIZE];
+
+  IPCMessageHeader *header = (IPCMessageHeader *) buffer;
+  ipc_init_header (header, kIPCCommandEvent, payload_len, 0);
+
+  IPCEventHeader *event
+    = (IPCEventHeader *) (buffer + sizeof (IPCMessageHeader));
+  event->topic = topic;
+  event->data_len = data_len;
   if (data_len > 0 && data != NULL)
     {
-      memcpy (buffer + sizeof (IPCMessageHeader) + sizeof (IPCResponse), data,
-	      data_len);
+      memcpy (buffer + sizeof (IPCMessageHeader) + sizeof (IPCEventHeader),
+	      data, data_len);
     }
 
-  ssize_t sent = send (fd, buffer, total_len, 0);
-  free (buffer);
+  int delivered = 0;
+  bool any_broken = false;
+  pthread_mutex_lock (&g_connections_mutex);
+  for (ClientConnection *conn = g_connections; conn != NULL; conn = conn->next)
+    {
+      if ((conn->subscriptions & topic) == 0)
+	continue;
+
+      // 写入发送缓冲区后立即尝试发送，对端不读取时由缓冲区上限兜底
+      if (queue_send_locked (conn, buffer, total_len) == 0)
+	{
+	  flush_send_locked (ctx, conn);
+	  delivered++;
+	}
+      any_broken = any_broken || conn->broken;
+    }
+  pthread_mutex_unlock (&g_connections_mutex);
+
+  if (delivered > 0)
+    {
+      STATS_ADD (g_stats.events_sent, (uint64_t) delivered);
+      STATS_ADD (g_stats.event_bytes_out, (uint64_t) delivered * total_len);
+    }
+
+  // 断开的连接由事件循环线程关闭
+  if (any_broken)
+    ipc_reactor_wakeup (&ctx->reactor);
 
-  return (sent == (ssize_t) total_len) ? 0 : -1;
+  return delivered;
 }
 
-// 处理客户端消息
+// 推送所有待发送的音量事件
 static void
-handle_client_message (IPCServerContext *ctx, int client_fd)
+flush_volume_events (IPCServerContext *ctx)
 {
-  IPCMessageHeader header;
-  ssize_t received = recv (client_fd, &header, sizeof (header), 0);
+  for (uint32_t i = 0; i < g_dirty_count; i++)
+    {
+      float volume = 0.0f;
+      bool muted = false;
+      if (ipc_server_get_volume (ctx, g_dirty_pids[i], &volume, &muted) != 0)
+	continue;
+
+      IPCVolumeEvent event = {0};
+      event.pid = g_dirty_pids[i];
+      event.volume = volume;
+      event.muted = muted;
+      ipc_server_broadcast_event (ctx, kIPCEventTopicVolume, &event,
+				  sizeof (event));
+    }
+  g_dirty_count = 0;
 
-  if (received <= 0)
+  if (g_flush_timer_armed)
     {
-      // 连接关闭或错误
-      remove_connection (client_fd);
-      struct kevent ev;
-      EV_SET (&ev, client_fd, EVFILT_READ, EV_DELETE, 0, 0, NULL);
-      kevent (ctx->epoll_fd, &ev, 1, NULL, 0, NULL);
-      return;
+      ipc_reactor_remove_timer (&ctx->reactor, kIPCServerTimerEventFlush);
+      g_flush_timer_armed = false;
     }
+}
 
-  if (received != sizeof (header) || !ipc_validate_header (&header))
+// 记录音量变更，合并窗口结束后统一推送
+static void
+broadcast_volume_event (IPCServerContext *ctx, pid_t pid)
+{
+  for (uint32_t i = 0; i < g_dirty_count; i++)
     {
-      // 无效消息头
-      send_response (client_fd, 0, kIPCStatusInvalidHeader, NULL, 0);
-      return;
+      if (g_dirty_pids[i] == pid)
+	return;
     }
 
-  // 读取负载
-  uint8_t *payload = NULL;
-  if (header.payload_len > 0)
+  if (g_dirty_count >= IPC_SERVER_MAX_DIRTY_PIDS)
+    flush_volume_events (ctx);
+  g_dirty_pids[g_dirty_count++] = pid;
+
+  if (!g_flush_timer_armed)
     {
-      payload = malloc (header.payload_len);
-      if (payload == NULL)
+      if (ipc_reactor_add_timer (&ctx->reactor, kIPCServerTimerEventFlush,
+				 IPC_SERVER_EVENT_COALESCE_MS)
+	  == 0)
+	g_flush_timer_armed = true;
+      else
+	flush_volume_events (ctx); // 无法创建定时器时退化为立即推送
+    }
+}
+
+// 保存上报的响度读数：主输出条目更新主输出，不只含主输出的上报
+// （包括空列表）整体替换应用读数
+static int32_t
+store_loudness (const uint8_t *payload, uint32_t payload_len)
+{
+  IPCLoudnessReport report;
+  if (payload == NULL || payload_len < sizeof (report))
+    return kIPCStatusInvalidHeader;
+  memcpy (&report, payload, sizeof (report));
+  if (report.count > IPC_LOUDNESS_MAX_ENTRIES
+      || payload_len
+	   < sizeof (report) + report.count * sizeof (IPCLoudnessEntry))
+    return kIPCStatusInvalidHeader;
+
+  IPCLoudnessEntry apps[IPC_LOUDNESS_MAX_ENTRIES];
+  uint32_t app_count = 0;
+  for (uint32_t i = 0; i < report.count; i++)
+    {
+      IPCLoudnessEntry entry;
+      memcpy (&entry, payload + sizeof (report) + i * sizeof (entry),
+	      sizeof (entry));
+      memset (entry.name, 0, sizeof (entry.name));
+      if (entry.pid == IPC_LOUDNESS_MASTER_PID)
 	{
-	  send_response (client_fd, header.request_id, kIPCStatusInternalError,
-			 NULL, 0);
-	  return;
+	  g_loudness_master = entry;
+	  g_loudness_master_valid = true;
 	}
+      else
+	apps[app_count++] = entry;
+    }
+
+  if (app_count > 0 || report.count == 0)
+    {
+      memcpy (g_loudness_apps, apps, app_count * sizeof (IPCLoudnessEntry));
+      g_loudness_app_count = app_count;
+      g_loudness_apps_ms = get_monotonic_ns () / 1000000;
+    }
+  return kIPCStatusOK;
+}
 
-      received = recv (client_fd, payload, header.payload_len, 0);
-      if (received != (ssize_t) header.payload_len)
+// 生成响度查询响应（主输出在前），应用名称取自注册信息
+static uint32_t
+build_loudness_response (IPCServerContext *ctx, uint8_t *buffer)
+{
+  IPCLoudnessReport report = {0};
+  IPCLoudnessEntry *entries
+    = (IPCLoudnessEntry *) (buffer + sizeof (IPCLoudnessReport));
+
+  if (g_loudness_master_valid)
+    memcpy (&entries[report.count++], &g_loudness_master,
+	    sizeof (IPCLoudnessEntry));
+
+  if (get_monotonic_ns () / 1000000 - g_loudness_apps_ms
+      <= IPC_LOUDNESS_STALE_MS)
+    {
+      for (uint32_t i = 0; i < g_loudness_app_count; i++)
 	{
-	  free (payload);
-	  send_response (client_fd, header.request_id,
-			 kIPCStatusPayloadTooLarge, NULL, 0);
-	  return;
+	  IPCLoudnessEntry entry = g_loudness_apps[i];
+	  const IPCClientEntry *client
+	    = ipc_server_find_client (ctx, entry.pid);
+	  if (client != NULL)
+	    {
+	      strncpy (entry.name, client->app_name, sizeof (entry.name) - 1);
+	      entry.name[sizeof (entry.name) - 1] = '\0';
+	    }
+	  memcpy (&entries[report.count++], &entry, sizeof (entry));
 	}
     }
 
+  memcpy (buffer, &report, sizeof (report));
+  return (uint32_t) (sizeof (report)
+		     + report.count * sizeof (IPCLoudnessEntry));
+}
+
+// ============================================================================
+// 配置
+// ============================================================================
+
+// Set 负载的暂存区，容纳任意一种整体替换的配置
+typedef union
+{
+  IPCEqualizerConfig equalizer;
+  IPCNormalizerConfig normalizer;
+  IPCDuckingConfig ducking;
+  IPCConvolverConfig convolver;
+  IPCCrossfeedConfig crossfeed;
+  IPCSpectrumConfig spectrum;
+  IPCRecordConfig record;
+  IPCStreamConfig stream;
+} ConfigBuffer;
+
+static bool
+accept_equalizer (ConfigBuffer *config)
+{
+  return ipc_equalizer_config_is_valid (&config->equalizer);
+}
+
+static bool
+accept_normalizer (ConfigBuffer *config)
+{
+  return ipc_normalizer_config_is_valid (&config->normalizer);
+}
+
+static bool
+accept_ducking (ConfigBuffer *config)
+{
+  return ipc_ducking_config_is_valid (&config->ducking);
+}
+
+static bool
+accept_convolver (ConfigBuffer *config)
+{
+  return ipc_convolver_config_is_valid (&config->convolver);
+}
+
+static bool
+accept_crossfeed (ConfigBuffer *config)
+{
+  return ipc_crossfeed_config_is_valid (&config->crossfeed);
+}
+
+static bool
+accept_spectrum (ConfigBuffer *config)
+{
+  if (!ipc_spectrum_config_is_valid (&config->spectrum))
+    return false;
+  memset (config->spectrum.reserved, 0, sizeof (config->spectrum.reserved));
+  return true;
+}
+
+// 每次设置都是新请求（重复开始即换文件），响应带回序号
+static bool
+accept_record (ConfigBuffer *config)
+{
+  if (!ipc_record_config_is_valid (&config->record))
+    return false;
+  memset (config->record.reserved, 0, sizeof (config->record.reserved));
+  config->record.generation = g_record.config.generation + 1;
+  if (config->record.generation == 0)
+    config->record.generation = 1;
+  return true;
+}
+
+static bool
+accept_stream (ConfigBuffer *config)
+{
+  return ipc_stream_config_is_valid (&config->stream);
+}
+
+// 声道混合按批增量更新：负载只需携带 count 条规则，整批生效后保存
+static int32_t
+merge_channel_mix (const uint8_t *payload, uint32_t payload_len)
+{
+  const IPCChannelMixConfig *batch = (const IPCChannelMixConfig *) payload;
+  size_t rules_offset = offsetof (IPCChannelMixConfig, rules);
+  if (payload == NULL || payload_len < rules_offset
+      || batch->count > IPC_CHANNEL_MIX_MAX_APPS
+      || payload_len < rules_offset + batch->count * sizeof (IPCChannelMixRule))
+    return kIPCStatusInvalidHeader;
+
+  IPCChannelMixConfig update;
+  ipc_channel_mix_config_init (&update);
+  memcpy (&update, payload,
+	  rules_offset + batch->count * sizeof (IPCChannelMixRule));
+  return ipc_channel_mix_config_merge (&g_channel_mix, &update) == 0
+	   ? kIPCStatusOK
+	   : kIPCStatusInvalidParameter;
+}
+
+// 由客户端读写的配置：Get 返回 report，Set 校验后写入 storage 并把完整
+// 配置推送给订阅者（均衡器、卷积器等由 Router 收到推送后平滑切换；
+// 卷积器 IR 和推流主机名同样由 Router 加载和解析）
+typedef struct
+{
+  uint32_t get_command;
+  uint32_t set_command;
+  uint32_t topic;	// 修改后推送的主题
+  void *storage;	// 当前配置
+  uint32_t size;	// 配置大小（整体替换时也是 Set 负载的下限）
+  void *report;		// Get 的响应
+  uint32_t report_size;
+  // 整体替换：校验负载副本，可以在保存前规整字段
+  bool (*accept) (ConfigBuffer *config);
+  // 增量更新：直接处理原始负载并返回状态（不为 NULL 时代替 accept）
+  int32_t (*merge) (const uint8_t *payload, uint32_t payload_len);
+  bool echo; // Set 成功时是否带回保存后的配置
+} ConfigEntry;
+
+#define CONFIG_STORAGE(var) &(var), sizeof (var)
+
+static const ConfigEntry kConfigEntries[] = {
+  {kIPCCommandGetEqualizer, kIPCCommandSetEqualizer, kIPCEventTopicEqualizer,
+   CONFIG_STORAGE (g_equalizer), CONFIG_STORAGE (g_equalizer),
+   accept_equalizer, NULL, false},
+  {kIPCCommandGetNormalizer, kIPCCommandSetNormalizer,
+   kIPCEventTopicNormalizer, CONFIG_STORAGE (g_normalizer),
+   CONFIG_STORAGE (g_normalizer), accept_normalizer, NULL, false},
+  {kIPCCommandGetDucking, kIPCCommandSetDucking, kIPCEventTopicDucking,
+   CONFIG_STORAGE (g_ducking), CONFIG_STORAGE (g_ducking), accept_ducking,
+   NULL, false},
+  {kIPCCommandGetChannelMix, kIPCCommandSetChannelMix,
+   kIPCEventTopicChannelMix, CONFIG_STORAGE (g_channel_mix),
+   CONFIG_STORAGE (g_channel_mix), NULL, merge_channel_mix, true},
+  {kIPCCommandGetConvolver, kIPCCommandSetConvolver, kIPCEventTopicConvolver,
+   CONFIG_STORAGE (g_convolver), CONFIG_STORAGE (g_convolver),
+   accept_convolver, NULL, false},
+  {kIPCCommandGetCrossfeed, kIPCCommandSetCrossfeed, kIPCEventTopicCrossfeed,
+   CONFIG_STORAGE (g_crossfeed), CONFIG_STORAGE (g_crossfeed),
+   accept_crossfeed, NULL, false},
+  {kIPCCommandGetSpectrum, kIPCCommandSetSpectrum, kIPCEventTopicSpectrum,
+   CONFIG_STORAGE (g_spectrum), CONFIG_STORAGE (g_spectrum), accept_spectrum,
+   NULL, false},
+  {kIPCCommandGetRecording, kIPCCommandSetRecording, kIPCEventTopicRecording,
+   CONFIG_STORAGE (g_record.config), CONFIG_STORAGE (g_record), accept_record,
+   NULL, true},
+  {kIPCCommandGetStream, kIPCCommandSetStream, kIPCEventTopicStream,
+   CONFIG_STORAGE (g_stream), CONFIG_STORAGE (g_stream), accept_stream, NULL,
+   false},
+};
+
+static const ConfigEntry *
+find_config (uint32_t command)
+{
+  for (size_t i = 0; i < sizeof (kConfigEntries) / sizeof (kConfigEntries[0]);
+       i++)
+    if (kConfigEntries[i].get_command == command
+	|| kConfigEntries[i].set_command == command)
+      return &kConfigEntries[i];
+  return NULL;
+}
+
+// 处理 Set：保存成功后推送完整配置
+static int32_t
+set_config (IPCServerContext *ctx, const ConfigEntry *entry,
+	    const uint8_t *payload, uint32_t payload_len)
+{
+  if (entry->merge != NULL)
+    {
+      int32_t status = entry->merge (payload, payload_len);
+      if (status != kIPCStatusOK)
+	return status;
+    }
+  else
+    {
+      if (payload == NULL || payload_len < entry->size)
+	return kIPCStatusInvalidHeader;
+      ConfigBuffer config;
+      memcpy (&config, payload, entry->size);
+      if (!entry->accept (&config))
+	return kIPCStatusInvalidParameter;
+      memcpy (entry->storage, &config, entry->size);
+    }
+
+  ipc_server_broadcast_event (ctx, entry->topic, entry->storage, entry->size);
+  return kIPCStatusOK;
+}
+
+// 处理一条完整消息，响应写入连接的发送缓冲区
+static void
+process_message (IPCServerContext *ctx, ClientConnection *conn,
+		 const IPCMessageHeader *header, const uint8_t *payload)
+{
+  uint64_t start_ns = get_monotonic_ns ();
+  if (header->payload_len == 0)
+    payload = NULL;
+
   // 处理指令
   int32_t status = kIPCStatusOK;
   void *response_data = NULL;
   bool response_needs_free = false;
   uint32_t response_len = 0;
   IPCVolumeResponse vol_resp = {0}; // 提升作用域以修复 line 503
-
-  switch (header.command)
+  uint8_t stats_buf[sizeof (IPCServerStats)
+		    + IPC_STATS_PAGE_ENTRIES * sizeof (IPCCommandStats)];
+  IPCRouterStatsSnapshot router_buf[IPC_ROUTER_STATS_HISTORY];
+  uint8_t loudness_buf[sizeof (IPCLoudnessReport)
+		       + IPC_LOUDNESS_MAX_ENTRIES * sizeof (IPCLoudnessEntry)];
+  uint32_t spectrum_listeners = 0;
+
+  switch (header->command)
     {
       case kIPCCommandRegister: {
-	if (header.payload_len >= sizeof (IPCRegisterRequest)
+	if (header->payload_len >= sizeof (IPCRegisterRequest)
 	    && payload != NULL)
 	  {
 	    const IPCRegisterRequest *req
@@ -500,7 +1205,7 @@ handle_client_message (IPCServerContext *ctx, int client_fd)
       }
 
       case kIPCCommandUnregister: {
-	if (header.payload_len >= sizeof (pid_t) && payload != NULL)
+	if (header->payload_len >= sizeof (pid_t) && payload != NULL)
 	  {
 	    const pid_t *pid = (const pid_t *) payload;
 	    status = ipc_server_unregister_client (ctx, *pid);
@@ -515,7 +1220,7 @@ handle_client_message (IPCServerContext *ctx, int client_fd)
       }
 
       case kIPCCommandGetVolume: {
-	if (header.payload_len >= sizeof (pid_t) && payload != NULL)
+	if (header->payload_len >= sizeof (pid_t) && payload != NULL)
 	  {
 	    const pid_t *pid = (const pid_t *) payload;
 	    float volume = 0.0f;
@@ -543,7 +1248,7 @@ handle_client_message (IPCServerContext *ctx, int client_fd)
       }
 
       case kIPCCommandSetVolume: {
-	if (header.payload_len >= sizeof (IPCSetVolumeRequest)
+	if (header->payload_len >= sizeof (IPCSetVolumeRequest)
 	    && payload != NULL)
 	  {
 	    const IPCSetVolumeRequest *req
@@ -551,6 +1256,8 @@ handle_client_message (IPCServerContext *ctx, int client_fd)
 	    status = ipc_server_set_volume (ctx, req->pid, req->volume);
 	    if (status != 0)
 	      status = kIPCStatusClientNotFound;
+	    else
+	      broadcast_volume_event (ctx, req->pid);
 	  }
 	else
 	  {
@@ -560,12 +1267,15 @@ handle_client_message (IPCServerContext *ctx, int client_fd)
       }
 
       case kIPCCommandSetMute: {
-	if (header.payload_len >= sizeof (IPCSetMuteRequest) && payload != NULL)
+	if (header->payload_len >= sizeof (IPCSetMuteRequest)
+	    && payload != NULL)
 	  {
 	    const IPCSetMuteRequest *req = (const IPCSetMuteRequest *) payload;
 	    status = ipc_server_set_mute (ctx, req->pid, req->muted);
 	    if (status != 0)
 	      status = kIPCStatusClientNotFound;
+	    else
+	      broadcast_volume_event (ctx, req->pid);
 	  }
 	else
 	  {
@@ -579,6 +1289,134 @@ handle_client_message (IPCServerContext *ctx, int client_fd)
 	break;
       }
 
+      case kIPCCommandGetStats: {
+	IPCServerStats *stats = (IPCServerStats *) stats_buf;
+	IPCCommandStats *commands
+	  = (IPCCommandStats *) (stats_buf + sizeof (IPCServerStats));
+	IPCStatsRequest req = {0};
+	if (header->payload_len >= sizeof (req) && payload != NULL)
+	  memcpy (&req, payload, sizeof (req));
+	ipc_server_get_stats (ctx, stats, req.first, commands,
+			      IPC_STATS_PAGE_ENTRIES);
+	response_data = stats_buf;
+	response_len = (uint32_t) (sizeof (IPCServerStats)
+				   + stats->command_count
+				       * sizeof (IPCCommandStats));
+	status = kIPCStatusOK;
+	break;
+      }
+
+      case kIPCCommandPublishRouterStats: {
+	if (header->payload_len >= sizeof (IPCRouterStatsSnapshot)
+	    && payload != NULL)
+	  {
+	    memcpy (&g_router_stats[g_router_stats_next], payload,
+		    sizeof (IPCRouterStatsSnapshot));
+	    g_router_stats_next
+	      = (g_router_stats_next + 1) % IPC_ROUTER_STATS_HISTORY;
+	    if (g_router_stats_count < IPC_ROUTER_STATS_HISTORY)
+	      g_router_stats_count++;
+	    status = kIPCStatusOK;
+	  }
+	else
+	  {
+	    status = kIPCStatusInvalidHeader;
+	  }
+	break;
+      }
+
+      case kIPCCommandGetRouterStats: {
+	// 按时间顺序返回（最旧在前）
+	uint32_t first = (g_router_stats_next + IPC_ROUTER_STATS_HISTORY
+			  - g_router_stats_count)
+			 % IPC_ROUTER_STATS_HISTORY;
+	for (uint32_t i = 0; i < g_router_stats_count; i++)
+	  router_buf[i]
+	    = g_router_stats[(first + i) % IPC_ROUTER_STATS_HISTORY];
+	response_data = router_buf;
+	response_len = g_router_stats_count * sizeof (IPCRouterStatsSnapshot);
+	status = kIPCStatusOK;
+	break;
+      }
+
+      case kIPCCommandPublishSpectrum: {
+	// 服务端不保存频谱帧，只转发给当前订阅者；响应为订阅者数，
+	// Router 据此在无人订阅时停止分析
+	if (payload != NULL
+	    && ipc_spectrum_frame_is_valid ((const IPCSpectrumFrame *) payload,
+					    header->payload_len))
+	  {
+	    const IPCSpectrumFrame *frame = (const IPCSpectrumFrame *) payload;
+	    if (frame->band_count > 0)
+	      ipc_server_broadcast_event (ctx, kIPCEventTopicSpectrumFrame,
+					  payload, header->payload_len);
+	    spectrum_listeners = count_subscribers (kIPCEventTopicSpectrumFrame);
+	    response_data = &spectrum_listeners;
+	    response_len = sizeof (spectrum_listeners);
+	    status = kIPCStatusOK;
+	  }
+	else
+	  {
+	    status = kIPCStatusInvalidParameter;
+	  }
+	break;
+      }
+
+      case kIPCCommandPublishRecording: {
+	if (header->payload_len >= sizeof (IPCRecordStatus)
+	    && payload != NULL)
+	  {
+	    IPCRecordStatus report;
+	    memcpy (&report, payload, sizeof (report));
+	    if (ipc_record_status_is_valid (&report))
+	      {
+		g_record.status = report;
+		g_record.status_valid = 1;
+		ipc_server_broadcast_event (ctx, kIPCEventTopicRecordingStatus,
+					    &g_record.status,
+					    sizeof (g_record.status));
+		status = kIPCStatusOK;
+	      }
+	    else
+	      {
+		status = kIPCStatusInvalidParameter;
+	      }
+	  }
+	else
+	  {
+	    status = kIPCStatusInvalidHeader;
+	  }
+	break;
+      }
+
+      case kIPCCommandPublishLoudness: {
+	status = store_loudness (payload, header->payload_len);
+	break;
+      }
+
+      case kIPCCommandGetLoudness: {
+	response_len = build_loudness_response (ctx, loudness_buf);
+	response_data = loudness_buf;
+	status = kIPCStatusOK;
+	break;
+      }
+
+      case kIPCCommandSubscribe: {
+	if (header->payload_len >= sizeof (IPCSubscribeRequest)
+	    && payload != NULL)
+	  {
+	    const IPCSubscribeRequest *req
+	      = (const IPCSubscribeRequest *) payload;
+	    set_connection_subscriptions (conn, req->topics);
+	    status = kIPCStatusOK;
+	  }
+	else
+	  {
+	    status = kIPCStatusInvalidHeader;
+	  }
+	break;
+      }
+
       case kIPCCommandListClients: {
 	uint32_t client_count = 0;
 	IPCClientEntry *clients = ipc_server_list_clients (ctx, &client_count);
@@ -634,66 +1472,263 @@ handle_client_message (IPCServerContext *ctx, int client_fd)
 	break;
       }
 
-    default:
-      status = kIPCStatusUnknownCommand;
-      break;
+    default: {
+	const ConfigEntry *config = find_config (header->command);
+	if (config == NULL)
+	  status = kIPCStatusUnknownCommand;
+	else if (header->command == config->get_command)
+	  {
+	    response_data = config->report;
+	    response_len = config->report_size;
+	    status = kIPCStatusOK;
+	  }
+	else
+	  {
+	    status = set_config (ctx, config, payload, header->payload_len);
+	    if (status == kIPCStatusOK && config->echo)
+	      {
+		response_data = config->storage;
+		response_len = config->size;
+	      }
+	  }
+	break;
+      }
     }
 
-  send_response (client_fd, header.request_id, status, response_data,
+  send_response (conn, header->request_id, status, response_data,
 		 response_len);
   if (response_needs_free)
     free (response_data);
-  free (payload);
+
+  stats_record_request (header->command, status,
+			sizeof (IPCMessageHeader) + header->payload_len,
+			sizeof (IPCMessageHeader) + sizeof (IPCResponse)
+			  + response_len,
+			get_monotonic_ns () - start_ns);
+}
+
+// 读取所有可用数据并处理完整消息（边沿触发：一直读到 EAGAIN）
+// 返回 0 表示连接保持，-1 表示连接已关闭
+static int
+handle_client_readable (IPCServerContext *ctx, ClientConnection *conn)
+{
+  bool closed = false;
+
+  for (;;)
+    {
+      ssize_t received = recv (conn->fd, conn->recv_buf + conn->recv_len,
+			       sizeof (conn->recv_buf) - conn->recv_len, 0);
+      if (received == 0)
+	{
+	  // 连接关闭
+	  closed = true;
+	  break;
+	}
+      if (received < 0)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  if (errno != EAGAIN && errno != EWOULDBLOCK)
+	    closed = true;
+	  break;
+	}
+      conn->recv_len += (size_t) received;
+
+      // 解析缓冲区中所有完整消息
+      size_t offset = 0;
+      while (conn->recv_len - offset >= sizeof (IPCMessageHeader))
+	{
+	  IPCMessageHeader header;
+	  memcpy (&header, conn->recv_buf + offset, sizeof (header));
+	  if (!ipc_validate_header (&header))
+	    {
+	      // 无效消息头：字节流无法再同步，回复后断开
+	      send_response (conn, header.request_id, kIPCStatusInvalidHeader,
+			     NULL, 0);
+	      stats_record_request (0, kIPCStatusInvalidHeader,
+				    sizeof (IPCMessageHeader),
+				    sizeof (IPCMessageHeader)
+				      + sizeof (IPCResponse),
+				    0);
+	      closed = true;
+	      break;
+	    }
+
+	  size_t frame_len = sizeof (header) + header.payload_len;
+	  if (conn->recv_len - offset < frame_len)
+	    break;
+
+	  process_message (ctx, conn, &header,
+			   conn->recv_buf + offset + sizeof (header));
+	  offset += frame_len;
+	}
+
+      if (closed)
+	break;
+
+      if (offset > 0)
+	{
+	  memmove (conn->recv_buf, conn->recv_buf + offset,
+		   conn->recv_len - offset);
+	  conn->recv_len -= offset;
+	}
+    }
+
+  pthread_mutex_lock (&g_connections_mutex);
+  flush_send_locked (ctx, conn);
+  closed = closed || conn->broken;
+  pthread_mutex_unlock (&g_connections_mutex);
+
+  if (closed)
+    {
+      remove_connection (ctx, conn);
+      return -1;
+    }
+  return 0;
+}
+
+// 关闭所有发送失败的连接
+static void
+close_broken_connections (IPCServerContext *ctx)
+{
+  ClientConnection *conn = g_connections;
+  while (conn != NULL)
+    {
+      ClientConnection *next = conn->next;
+      if (conn->broken)
+	remove_connection (ctx, conn);
+      conn = next;
+    }
 }
 
 // 运行服务端主循环
 void
 ipc_server_run (IPCServerContext *ctx)
 {
-  if (ctx == NULL || ctx->epoll_fd < 0)
+  if (ctx == NULL || ctx->listen_fd < 0)
     return;
 
-  struct kevent events[32];
-  struct timespec timeout;
+  IPCReactorEvent events[IPC_SERVER_MAX_EVENTS];
 
-  while (ctx->running)
+  // 没有固定超时：停止请求通过唤醒事件立即生效
+  while (atomic_load (&ctx->running))
     {
-      timeout.tv_sec = 1;
-      timeout.tv_nsec = 0;
-
-      int nfds = kevent (ctx->epoll_fd, NULL, 0, events, 32, &timeout);
-
+      int nfds = ipc_reactor_wait (&ctx->reactor, events,
+				   IPC_SERVER_MAX_EVENTS, -1);
       if (nfds < 0)
 	{
-	  if (errno == EINTR)
-	    continue;
-	  perror ("kevent");
+	  perror ("ipc_reactor_wait");
 	  break;
 	}
+      if (nfds == 0)
+	continue;
+
+      uint64_t iteration_start = get_monotonic_ns ();
 
       for (int i = 0; i < nfds; i++)
 	{
-	  int fd = (int) events[i].ident;
+	  const IPCReactorEvent *ev = &events[i];
+
+	  if (ev->events & kIPCReactorWakeup)
+	    {
+	      close_broken_connections (ctx);
+	      continue;
+	    }
 
-	  if (fd == ctx->listen_fd)
+	  if (ev->events & kIPCReactorTimer)
 	    {
-	      handle_new_connection (ctx);
+	      if (ev->timer_id == kIPCServerTimerEventFlush)
+		flush_volume_events (ctx);
+	      continue;
 	    }
-	  else if (events[i].filter == EVFILT_READ)
+
+	  if (ev->fd == ctx->listen_fd)
+	    {
+	      handle_new_connections (ctx);
+	      continue;
+	    }
+
+	  // 同一批事件中连接可能已被关闭
+	  ClientConnection *conn = find_connection (ev->fd);
+	  if (conn == NULL)
+	    continue;
+
+	  if (ev->events & kIPCReactorWrite)
 	    {
-	      handle_client_message (ctx, fd);
+	      pthread_mutex_lock (&g_connections_mutex);
+	      flush_send_locked (ctx, conn);
+	      pthread_mutex_unlock (&g_connections_mutex);
 	    }
+
+	  if (ev->events & (kIPCReactorRead | kIPCReactorHangup))
+	    handle_client_readable (ctx, conn);
+	  else if (conn->broken)
+	    remove_connection (ctx, conn);
 	}
+
+      stats_record_loop (get_monotonic_ns () - iteration_start);
     }
 }
 
-// 停止服务端
+// 获取服务端统计快照
+uint32_t
+ipc_server_get_stats (IPCServerContext *ctx, IPCServerStats *stats,
+		      uint32_t first, IPCCommandStats *commands,
+		      uint32_t max_commands)
+{
+  (void) ctx;
+  if (stats == NULL)
+    return 0;
+
+  memset (stats, 0, sizeof (*stats));
+  stats->uptime_ms = get_timestamp_ms () - STATS_LOAD (g_stats.started_ms);
+  stats->connections = STATS_LOAD (g_stats.connections);
+  stats->peak_connections = STATS_LOAD (g_stats.peak_connections);
+  stats->total_connections = STATS_LOAD (g_stats.total_connections);
+  stats->events_sent = STATS_LOAD (g_stats.events_sent);
+  stats->event_bytes_out = STATS_LOAD (g_stats.event_bytes_out);
+  stats->loop_iterations = STATS_LOAD (g_stats.loop_iterations);
+  stats->loop_total_ns = STATS_LOAD (g_stats.loop_total_ns);
+  stats->loop_max_ns = STATS_LOAD (g_stats.loop_max_ns);
+  for (uint32_t b = 0; b < IPC_STATS_HISTOGRAM_BUCKETS; b++)
+    stats->loop_histogram[b] = STATS_LOAD (g_stats.loop_histogram[b]);
+
+  uint32_t count = 0;
+  uint32_t active = 0;
+  for (uint32_t i = 0; i < IPC_SERVER_STATS_SLOTS; i++)
+    {
+      CommandCounters *slot = &g_stats.commands[i];
+      uint64_t requests = STATS_LOAD (slot->requests);
+      if (requests == 0)
+	continue;
+      if (active++ < first || commands == NULL || count >= max_commands)
+	continue;
+      IPCCommandStats *out = &commands[count++];
+      memset (out, 0, sizeof (*out));
+      out->command = i < IPC_SERVER_STATS_SLOTS - 1 ? kStatsCommands[i] : 0;
+      out->requests = requests;
+      out->bytes_in = STATS_LOAD (slot->bytes_in);
+      out->bytes_out = STATS_LOAD (slot->bytes_out);
+      out->total_ns = STATS_LOAD (slot->total_ns);
+      out->max_ns = STATS_LOAD (slot->max_ns);
+      for (uint32_t s = 0; s < IPC_STATS_STATUS_COUNT; s++)
+	out->status_counts[s] = STATS_LOAD (slot->status_counts[s]);
+      for (uint32_t b = 0; b < IPC_STATS_HISTOGRAM_BUCKETS; b++)
+	out->histogram[b] = STATS_LOAD (slot->histogram[b]);
+    }
+  stats->total_commands = active;
+  stats->command_count = count;
+  return count;
+}
+
+// 停止服务端（可在其他线程或信号处理函数中调用）
 void
 ipc_server_stop (IPCServerContext *ctx)
 {
   if (ctx != NULL)
     {
-      ctx->running = false;
+      atomic_store (&ctx->running, false);
+      ipc_reactor_wakeup (&ctx->reactor);
     }
 }
 
@@ -712,6 +1747,7 @@ ipc_server_cleanup (IPCServerContext *ctx)
       ClientConnection *to_remove = g_connections;
       g_connections = g_connections->next;
       close (to_remove->fd);
+      free (to_remove->send_buf);
       free (to_remove);
     }
   pthread_mutex_unlock (&g_connections_mutex);
@@ -725,12 +1761,26 @@ ipc_server_cleanup (IPCServerContext *ctx)
     }
   ctx->client_count = 0;
 
-  // 关闭 kqueue
-  if (ctx->epoll_fd >= 0)
-    {
-      close (ctx->epoll_fd);
-      ctx->epoll_fd = -1;
-    }
+  g_dirty_count = 0;
+  g_flush_timer_armed = false;
+  g_router_stats_next = 0;
+  g_router_stats_count = 0;
+  memset (&g_equalizer, 0, sizeof (g_equalizer));
+  memset (&g_convolver, 0, sizeof (g_convolver));
+  ipc_normalizer_config_init (&g_normalizer);
+  ipc_ducking_config_init (&g_ducking);
+  ipc_channel_mix_config_init (&g_channel_mix);
+  ipc_crossfeed_config_init (&g_crossfeed);
+  ipc_spectrum_config_init (&g_spectrum);
+  memset (&g_record, 0, sizeof (g_record));
+  ipc_stream_config_init (&g_stream);
+  g_loudness_master_valid = false;
+  g_loudness_app_count = 0;
+  g_loudness_apps_ms = 0;
+  atomic_store (&g_stats.connections, 0);
+
+  // 关闭事件循环
+  ipc_reactor_cleanup (&ctx->reactor);
 
   // 关闭监听 socket
   if (ctx->listen_fd >= 0)
@@ -195,9 +195,77 @@ printUsage ()
   printf (" app-mute [应用]          - 静音应用\n");
   printf (" app-unmute [应用]        - 取消静音应用\n\n");
 
+  printf ("========== 均衡器 ==========\n");
+  printf (" eq                       - 显示均衡器配置\n");
+  printf (" eq on/off                - 启用/关闭均衡器\n");
+  printf (" eq preamp [dB]           - 设置前级增益\n");
+  printf (" eq band [序号] [类型] [频率] [增益] [Q] - 设置某一段\n");
+  printf (" eq band [序号] off       - 关闭某一段\n");
+  printf (" eq reset                 - 清除所有段\n\n");
+
+  printf ("========== 响度均衡 ==========\n");
+  printf (" normalize                - 显示响度均衡配置\n");
+  printf (" normalize on/off         - 启用/关闭各应用响度自动均衡\n");
+  printf (" normalize target [LUFS]  - 设置目标响度\n");
+  printf (" normalize boost/cut [dB] - 设置最大提升/衰减\n");
+  printf (" normalize speed [起音] [释放] - 设置增益变化速率 (dB/s)\n");
+  printf (" normalize reset          - 恢复默认参数\n\n");
+
+  printf ("========== 闪避 ==========\n");
+  printf (" duck                     - 显示闪避配置\n");
+  printf (" duck on/off              - 人声应用发声时自动压低媒体应用\n");
+  printf (" duck depth [dB]          - 设置衰减深度\n");
+  printf (" duck threshold [LUFS]    - 设置人声活动门限\n");
+  printf (" duck times [起音] [保持] [释放] - 设置时间 (ms)\n");
+  printf (" duck voice/media add/remove [应用] - 编辑应用列表\n");
+  printf (" duck reset               - 恢复默认参数和应用列表\n\n");
+
+  printf ("========== 声道混合 ==========\n");
+  printf (" mix                      - 显示各应用的声道混合规则\n");
+  printf (" mix [应用] balance [值]  - 设置平衡 (-100 左 ~ 100 右)\n");
+  printf (" mix [应用] pan [值]      - 设置声像 (-100 左 ~ 100 右)\n");
+  printf (" mix [应用] mono on/off   - 左右混合为单声道\n");
+  printf (" mix [应用] swap on/off   - 左右互换\n");
+  printf (" mix [应用] reset         - 删除该应用的规则（mix reset 删除全部）\n\n");
+
+  printf ("========== 卷积 ==========\n");
+  printf (" convolve                 - 显示卷积器配置\n");
+  printf (" convolve load [文件.wav] - 读取房间校正/耳机冲激响应并启用\n");
+  printf (" convolve on/off          - 启用/关闭卷积\n");
+  printf (" convolve gain [dB]       - 设置输出增益\n");
+  printf (" convolve reset           - 关闭并清除冲激响应\n\n");
+
+  printf ("========== 交叉馈送 ==========\n");
+  printf (" crossfeed                - 显示耳机交叉馈送配置\n");
+  printf (" crossfeed on/off/auto    - 开启/关闭/输出为耳机时自动开启\n");
+  printf (" crossfeed light/medium/strong - 选择强度\n");
+  printf (" crossfeed reset          - 恢复默认（关闭、medium）\n\n");
+
+  printf ("========== 频谱分析 ==========\n");
+  printf (" spectrum                 - 显示频谱分析配置\n");
+  printf (" spectrum size/bands/fps/decimate [值] - 变换长度/频带数/帧率/抽取倍数\n");
+  printf (" spectrum reset           - 恢复默认配置\n");
+  printf (" spectrum watch [秒]      - 在终端显示实时频谱\n\n");
+
+  printf ("========== 录音 ==========\n");
+  printf (" record                   - 显示录音状态\n");
+  printf (" record start [目录] [wav|caf] - 录制输出信号（默认 ~/Music/audioctl）\n");
+  printf (" record rotate            - 换新文件继续录音\n");
+  printf (" record stop              - 停止录音\n\n");
+
+  printf ("========== 网络推流 ==========\n");
+  printf (" stream                   - 显示网络推流配置\n");
+  printf (" stream to <主机>[:端口]  - 把输出以 RTP 推送到另一台机器\n");
+  printf (" stream ptime <毫秒>      - 设置包时长 (1-10)\n");
+  printf (" stream off               - 停止推流\n");
+  printf (" receive [端口] [latency 毫秒] - 接收并播放推流\n\n");
+
   printf ("========== 系统命令 ==========\n");
   printf (" --version, -v            - 显示版本信息\n");
-  printf (" --service-status         - 查看服务状态\n\n");
+  printf (" --service-status         - 查看服务状态\n");
+  printf (" ipc-stats                - 查看 IPC 服务端统计\n");
+  printf (" router-stats [数量]      - 查看 Router 最近的性能快照\n");
+  printf (" loudness                 - 查看主输出和各应用的响度 (EBU R128)\n\n");
 
   printf ("========== 使用示例 ==========\n");
   printf (" audioctl list\n");
@@ -213,7 +281,8 @@ printUsage ()
   printf (" audioctl app-volumes\n");
   printf (" audioctl app-volume Safari 50\n");
   printf (" audioctl app-mute Chrome\n");
-  printf (" audioctl app-unmute Chrome\n\n");
+  printf (" audioctl app-unmute Chrome\n");
+  printf (" audioctl eq band 1 peak 120 -4 2\n\n");
 
   printf ("========== 选项 ==========\n");
   printf (" -a, --active             - 只列出使用中的设备\n");
@@ -1177,6 +1246,35 @@ main (const int argc, char *argv[])
   if (strncmp (cmd, "app-", 4) == 0)
     return handleAppVolumeCommands (argc, argv);
 
+  if (strcmp (cmd, "ipc-stats") == 0)
+    return print_ipc_stats ();
+  if (strcmp (cmd, "router-stats") == 0)
+    return print_router_stats (argc > 2 ? (uint32_t) atoi (argv[2]) : 0);
+  if (strcmp (cmd, "loudness") == 0)
+    return print_loudness ();
+  if (strcmp (cmd, "eq") == 0)
+    return equalizer_command (argc, argv);
+  if (strcmp (cmd, "normalize") == 0)
+    return normalizer_command (argc, argv);
+  if (strcmp (cmd, "duck") == 0)
+    return ducking_command (argc, argv);
+  if (strcmp (cmd, "mix") == 0)
+    return channel_mix_command (argc, argv);
+  if (strcmp (cmd, "convolve") == 0)
+    return convolver_command (argc, argv);
+  if (strcmp (cmd, "crossfeed") == 0)
+    return crossfeed_command (argc, argv);
+  if (strcmp (cmd, "spectrum") == 0)
+    return spectrum_command (argc, argv);
+  if (strcmp (cmd, "record") == 0)
+    return record_command (argc, argv);
+
+  if (strcmp (cmd, "stream") == 0)
+    return stream_command (argc, argv);
+
+  if (strcmp (cmd, "receive") == 0)
+    return receive_command (argc, argv);
+
   if (strcmp (cmd, "virtual-status") == 0 || strcmp (cmd, "use-virtual") == 0
       || strcmp (cmd, "use-physical") == 0)
     {
@@ -1186,13 +1284,76 @@ main (const int argc, char *argv[])
   if (strcmp (cmd, "internal-route") == 0)
     {
       // 解析 --router-target 参数（仅后台启动时使用）
+      // --monitor-interval=毫秒 设置监控周期
+      // --trace=文件 把 IOProc 回调和 xrun 时间线写成 Chrome trace JSON
+      // --load-threshold=百分比 回调耗时超过 IO 周期该比例时计为负载超时
+      // --idle-timeout=毫秒 输入连续静音超过该时长进入空闲模式（0 关闭）
+      // --limiter=预读ms,释放ms,上限dBTP 设置输出限制器
+      // --output-format=float|integer 物理格式为整数时是否直接输出整数
+      // --dither=off|tpdf|shaped 整数输出的抖动模式
       char target_uid[256] = {0};
       for (int i = 2; i < argc; i++)
 	{
 	  if (strncmp (argv[i], "--router-target=", 16) == 0)
+	    strncpy (target_uid, argv[i] + 16, sizeof (target_uid) - 1);
+	  else if (strncmp (argv[i], "--monitor-interval=", 19) == 0)
+	    audio_router_set_monitor_interval (
+	      (uint32_t) strtoul (argv[i] + 19, NULL, 10));
+	  else if (strncmp (argv[i], "--trace=", 8) == 0)
+	    audio_router_set_trace_file (argv[i] + 8);
+	  else if (strncmp (argv[i], "--load-threshold=", 17) == 0)
+	    audio_router_set_load_threshold (
+	      (uint32_t) strtoul (argv[i] + 17, NULL, 10));
+	  else if (strncmp (argv[i], "--idle-timeout=", 15) == 0)
+	    audio_router_set_idle_timeout (
+	      (uint32_t) strtoul (argv[i] + 15, NULL, 10));
+	  else if (strncmp (argv[i], "--limiter=", 10) == 0)
+	    {
+	      float lookahead_ms = 0.0f;
+	      float release_ms = 0.0f;
+	      float ceiling_db = 0.0f;
+	      if (sscanf (argv[i] + 10, "%f,%f,%f", &lookahead_ms, &release_ms,
+			  &ceiling_db)
+		    != 3
+		  || audio_router_set_limiter (lookahead_ms, release_ms,
+					       ceiling_db)
+		       != 0)
+		{
+		  fprintf (stderr,
+			   "❌ 无效的限制器参数: %s（预读 1-5ms，释放 "
+			   "1-5000ms，上限 -24-0 dBTP）\n",
+			   argv[i] + 10);
+		  return 1;
+		}
+	    }
+	  else if (strncmp (argv[i], "--output-format=", 16) == 0)
 	    {
-	      strncpy (target_uid, argv[i] + 16, sizeof (target_uid) - 1);
-	      break;
+	      const char *value = argv[i] + 16;
+	      if (strcmp (value, "float") != 0 && strcmp (value, "integer") != 0)
+		{
+		  fprintf (stderr,
+			   "❌ 无效的输出格式: %s（float 或 integer）\n", value);
+		  return 1;
+		}
+	      audio_router_set_integer_output (strcmp (value, "integer") == 0);
+	    }
+	  else if (strncmp (argv[i], "--dither=", 9) == 0)
+	    {
+	      const char *value = argv[i] + 9;
+	      RouterDitherMode mode = kRouterDitherModeCount;
+	      if (strcmp (value, "off") == 0)
+		mode = kRouterDitherOff;
+	      else if (strcmp (value, "tpdf") == 0)
+		mode = kRouterDitherTpdf;
+	      else if (strcmp (value, "shaped") == 0)
+		mode = kRouterDitherShaped;
+	      if (audio_router_set_dither (mode) != 0)
+		{
+		  fprintf (stderr,
+			   "❌ 无效的抖动模式: %s（off、tpdf 或 shaped）\n",
+			   value);
+		  return 1;
+		}
 	    }
 	}
 
@@ -0,0 +1,183 @@
+//
+// 跨应用响度均衡（自动增益）
+//
+// 每块：
+//   期望增益 g* = clamp(目标响度 - 短期响度, -最大衰减, +最大提升)
+//   g += clamp(g* - g, -起音速率 × 块时长, +释放速率 × 块时长)
+//   输出 = 输入 × 音量 × 线性插值(上一块终点增益 -> 本块终点增益)
+// 短期响度已经是 3s 平均，速率限制再把增益变化限制在每秒几 dB，
+// 语音的停顿和音乐的强弱变化不会被压平，只校正应用之间的整体差异
+//
+
+#include "router/router_agc.h"
+#include <math.h>
+#include <stddef.h>
+
+// ====== 参数 ======
+
+void
+router_agc_control_init (RouterAgcControl *control)
+{
+  atomic_init (&control->enabled, false);
+  atomic_init (&control->target_lufs, ROUTER_AGC_DEFAULT_TARGET_LUFS);
+  atomic_init (&control->max_boost_db, ROUTER_AGC_DEFAULT_MAX_BOOST_DB);
+  atomic_init (&control->max_cut_db, ROUTER_AGC_DEFAULT_MAX_CUT_DB);
+  atomic_init (&control->attack_db_per_s, ROUTER_AGC_DEFAULT_ATTACK_DB);
+  atomic_init (&control->release_db_per_s, ROUTER_AGC_DEFAULT_RELEASE_DB);
+}
+
+bool
+router_agc_params_are_valid (const RouterAgcParams *params)
+{
+  // 比较均写成“在范围内”的形式，NaN 不满足任何一项
+  return params != NULL && params->target_lufs >= ROUTER_AGC_MIN_TARGET_LUFS
+	 && params->target_lufs <= ROUTER_AGC_MAX_TARGET_LUFS
+	 && params->max_boost_db >= 0.0f
+	 && params->max_boost_db <= ROUTER_AGC_MAX_BOOST_DB
+	 && params->max_cut_db >= 0.0f
+	 && params->max_cut_db <= ROUTER_AGC_MAX_CUT_DB
+	 && params->attack_db_per_s >= ROUTER_AGC_MIN_RATE_DB
+	 && params->attack_db_per_s <= ROUTER_AGC_MAX_RATE_DB
+	 && params->release_db_per_s >= ROUTER_AGC_MIN_RATE_DB
+	 && params->release_db_per_s <= ROUTER_AGC_MAX_RATE_DB;
+}
+
+int
+router_agc_set_params (RouterAgcControl *control,
+		       const RouterAgcParams *params)
+{
+  if (!router_agc_params_are_valid (params))
+    return -1;
+  atomic_store (&control->target_lufs, params->target_lufs);
+  atomic_store (&control->max_boost_db, params->max_boost_db);
+  atomic_store (&control->max_cut_db, params->max_cut_db);
+  atomic_store (&control->attack_db_per_s, params->attack_db_per_s);
+  atomic_store (&control->release_db_per_s, params->release_db_per_s);
+  atomic_store (&control->enabled, params->enabled);
+  return 0;
+}
+
+void
+router_agc_get_params (RouterAgcControl *control, RouterAgcParams *params)
+{
+  params->enabled = atomic_load (&control->enabled);
+  params->target_lufs = atomic_load (&control->target_lufs);
+  params->max_boost_db = atomic_load (&control->max_boost_db);
+  params->max_cut_db = atomic_load (&control->max_cut_db);
+  params->attack_db_per_s = atomic_load (&control->attack_db_per_s);
+  params->release_db_per_s = atomic_load (&control->release_db_per_s);
+}
+
+// ====== 增益 ======
+
+void
+router_agc_init (RouterAgc *agc)
+{
+  agc->gain_db = 0.0f;
+  agc->from = 1.0f;
+  agc->to = 1.0f;
+  atomic_init (&agc->published_db, 0.0f);
+  atomic_init (&agc->reset_pending, false);
+}
+
+void
+router_agc_reset (RouterAgc *agc)
+{
+  atomic_store_explicit (&agc->published_db, 0.0f, memory_order_relaxed);
+  atomic_store_explicit (&agc->reset_pending, true, memory_order_release);
+}
+
+void
+router_agc_update (RouterAgc *agc, const RouterAgcParams *params,
+		   float loudness_lufs, float offset_db, uint32_t frames,
+		   uint32_t sample_rate)
+{
+  if (atomic_load_explicit (&agc->reset_pending, memory_order_relaxed)
+      && atomic_exchange_explicit (&agc->reset_pending, false,
+				   memory_order_acquire))
+    {
+      agc->gain_db = 0.0f;
+      agc->to = 1.0f;
+    }
+
+  agc->from = agc->to;
+  if (frames == 0 || sample_rate == 0)
+    return;
+
+  // 关闭时回到 0 dB；低于门限时保持当前增益（参数变化后仍受新范围约束）
+  float desired = 0.0f;
+  if (params->enabled)
+    {
+      desired = loudness_lufs >= ROUTER_AGC_GATE_LUFS
+		  ? params->target_lufs - loudness_lufs
+		  : agc->gain_db;
+      desired = fminf (fmaxf (desired, -params->max_cut_db),
+		       params->max_boost_db);
+    }
+
+  float seconds = (float) frames / (float) sample_rate;
+  float delta = desired - agc->gain_db;
+  float max_down = params->attack_db_per_s * seconds;
+  float max_up = params->release_db_per_s * seconds;
+  if (delta < -max_down)
+    agc->gain_db -= max_down;
+  else if (delta > max_up)
+    agc->gain_db += max_up;
+  else
+    agc->gain_db = desired; // 到达目标时精确落在期望值（关闭后回到 1.0）
+
+  float total_db = agc->gain_db + offset_db;
+  agc->to = total_db == 0.0f ? 1.0f : powf (10.0f, total_db / 20.0f);
+  atomic_store_explicit (&agc->published_db, total_db, memory_order_relaxed);
+}
+
+bool
+router_agc_is_active (const RouterAgc *agc)
+{
+  return agc->from != 1.0f || agc->to != 1.0f;
+}
+
+void
+router_agc_apply (const RouterAgc *agc, float *buffer, uint32_t frames,
+		  uint32_t channels, float volume)
+{
+  if (frames == 0)
+    return;
+
+  float from = agc->from * volume;
+  float to = agc->to * volume;
+  if (from == to)
+    {
+      if (to == 1.0f)
+	return;
+      uint32_t total = frames * channels;
+      for (uint32_t i = 0; i < total; i++)
+	buffer[i] *= to;
+      return;
+    }
+
+  // 第 f 帧的增益为 from + step × (f + 1)，本块最后一帧恰好到达终点
+  float step = (to - from) / (float) frames;
+  if (channels == 2)
+    {
+      for (uint32_t f = 0; f < frames; f++)
+	{
+	  float gain = from + step * (float) (f + 1);
+	  buffer[2 * f] *= gain;
+	  buffer[2 * f + 1] *= gain;
+	}
+      return;
+    }
+  for (uint32_t f = 0; f < frames; f++)
+    {
+      float gain = from + step * (float) (f + 1);
+      for (uint32_t c = 0; c < channels; c++)
+	buffer[f * channels + c] *= gain;
+    }
+}
+
+float
+router_agc_read_gain_db (RouterAgc *agc)
+{
+  return atomic_load_explicit (&agc->published_db, memory_order_relaxed);
+}
@@ -0,0 +1,627 @@
+//
+// Router 源/汇后端与离线管线
+//
+
+#include "router/router_backend.h"
+#include "router/router_pipeline.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// ============================================================================
+// WAV 格式常量
+// ============================================================================
+
+#define WAV_FORMAT_PCM 0x0001
+#define WAV_FORMAT_IEEE_FLOAT 0x0003
+#define WAV_FORMAT_EXTENSIBLE 0xFFFE
+
+#define WAV_READ_CHUNK_FRAMES 1024 // 源每次从文件读取的帧数上限
+
+#define SYNTHETIC_TWO_PI 6.283185307179586
+
+// ============================================================================
+// 小端读写辅助
+// ============================================================================
+
+static uint16_t
+read_le16 (const uint8_t *p)
+{
+  return (uint16_t) (p[0] | (p[1] << 8));
+}
+
+static uint32_t
+read_le32 (const uint8_t *p)
+{
+  return (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16)
+	 | ((uint32_t) p[3] << 24);
+}
+
+static void
+write_le16 (uint8_t *p, uint16_t v)
+{
+  p[0] = (uint8_t) v;
+  p[1] = (uint8_t) (v >> 8);
+}
+
+static void
+write_le32 (uint8_t *p, uint32_t v)
+{
+  p[0] = (uint8_t) v;
+  p[1] = (uint8_t) (v >> 8);
+  p[2] = (uint8_t) (v >> 16);
+  p[3] = (uint8_t) (v >> 24);
+}
+
+// ============================================================================
+// WAV 源
+// ============================================================================
+
+typedef struct
+{
+  FILE *fp;
+  uint16_t format;	     // WAV_FORMAT_PCM 或 WAV_FORMAT_IEEE_FLOAT
+  uint16_t bits;	     // 每采样位数
+  uint32_t block_align;	     // 每帧字节数
+  uint64_t frames_left;	     // 剩余帧数
+  uint8_t *raw;		     // 文件读取缓冲区
+} WavSourceState;
+
+// 把一个采样转换为 float
+static float
+wav_decode_sample (const uint8_t *p, uint16_t format, uint16_t bits)
+{
+  if (format == WAV_FORMAT_IEEE_FLOAT)
+    {
+      uint32_t u = read_le32 (p);
+      float f;
+      memcpy (&f, &u, sizeof (f));
+      return f;
+    }
+
+  switch (bits)
+    {
+    case 16:
+      return (float) (int16_t) read_le16 (p) / 32768.0f;
+    case 24:
+      {
+	int32_t v = (int32_t) ((uint32_t) p[0] << 8 | (uint32_t) p[1] << 16
+			       | (uint32_t) p[2] << 24);
+	return (float) (v >> 8) / 8388608.0f;
+      }
+    case 32:
+      return (float) ((double) (int32_t) read_le32 (p) / 2147483648.0);
+    default:
+      return 0.0f;
+    }
+}
+
+static uint32_t
+wav_source_read (RouterSource *source, float *dst, uint32_t frames)
+{
+  WavSourceState *st = source->state;
+  uint32_t total = 0;
+
+  while (total < frames && st->frames_left > 0)
+    {
+      uint32_t want = frames - total;
+      if (want > WAV_READ_CHUNK_FRAMES)
+	want = WAV_READ_CHUNK_FRAMES;
+      if (want > st->frames_left)
+	want = (uint32_t) st->frames_left;
+
+      size_t got = fread (st->raw, st->block_align, want, st->fp);
+      if (got == 0)
+	{
+	  st->frames_left = 0; // 文件比 data 块声明的短
+	  break;
+	}
+
+      uint32_t bytes_per_sample = st->bits / 8;
+      for (size_t f = 0; f < got; f++)
+	{
+	  const uint8_t *frame = st->raw + f * st->block_align;
+	  for (uint32_t c = 0; c < source->channels; c++)
+	    dst[(total + f) * source->channels + c]
+	      = wav_decode_sample (frame + c * bytes_per_sample, st->format,
+				   st->bits);
+	}
+      total += (uint32_t) got;
+      st->frames_left -= got;
+    }
+  return total;
+}
+
+static void
+wav_source_close (RouterSource *source)
+{
+  WavSourceState *st = source->state;
+  if (st == NULL)
+    return;
+  if (st->fp != NULL)
+    fclose (st->fp);
+  free (st->raw);
+  free (st);
+  source->state = NULL;
+}
+
+int
+router_source_open_wav (RouterSource *source, const char *path)
+{
+  if (source == NULL || path == NULL)
+    return -1;
+  memset (source, 0, sizeof (*source));
+
+  FILE *fp = fopen (path, "rb");
+  if (fp == NULL)
+    return -1;
+
+  uint8_t header[12];
+  if (fread (header, 1, sizeof (header), fp) != sizeof (header)
+      || memcmp (header, "RIFF", 4) != 0 || memcmp (header + 8, "WAVE", 4) != 0)
+    {
+      fclose (fp);
+      return -1;
+    }
+
+  // 遍历块，找到 fmt 和 data
+  uint16_t format = 0;
+  uint16_t channels = 0;
+  uint32_t sample_rate = 0;
+  uint16_t block_align = 0;
+  uint16_t bits = 0;
+  bool have_fmt = false;
+  uint32_t data_size = 0;
+  bool have_data = false;
+
+  while (!have_data)
+    {
+      uint8_t chunk[8];
+      if (fread (chunk, 1, sizeof (chunk), fp) != sizeof (chunk))
+	break;
+      uint32_t size = read_le32 (chunk + 4);
+
+      if (memcmp (chunk, "fmt ", 4) == 0 && size >= 16 && size <= 64)
+	{
+	  uint8_t fmt[64];
+	  if (fread (fmt, 1, size, fp) != size)
+	    break;
+	  format = read_le16 (fmt);
+	  channels = read_le16 (fmt + 2);
+	  sample_rate = read_le32 (fmt + 4);
+	  block_align = read_le16 (fmt + 12);
+	  bits = read_le16 (fmt + 14);
+	  // WAVE_FORMAT_EXTENSIBLE：子格式 GUID 的前两个字节即格式码
+	  if (format == WAV_FORMAT_EXTENSIBLE && size >= 40)
+	    format = read_le16 (fmt + 24);
+	  have_fmt = true;
+	  if (size & 1u)
+	    fseek (fp, 1, SEEK_CUR);
+	}
+      else if (memcmp (chunk, "data", 4) == 0)
+	{
+	  data_size = size;
+	  have_data = true;
+	}
+      else if (fseek (fp, (long) size + (size & 1u), SEEK_CUR) != 0)
+	break;
+    }
+
+  bool supported
+    = have_fmt && have_data && channels >= 1
+      && channels <= ROUTER_MAX_CHANNELS && sample_rate > 0
+      && ((format == WAV_FORMAT_PCM
+	   && (bits == 16 || bits == 24 || bits == 32))
+	  || (format == WAV_FORMAT_IEEE_FLOAT && bits == 32))
+      && block_align == channels * (bits / 8);
+  if (!supported)
+    {
+      fclose (fp);
+      return -1;
+    }
+
+  WavSourceState *st = calloc (1, sizeof (*st));
+  if (st != NULL)
+    st->raw = malloc ((size_t) WAV_READ_CHUNK_FRAMES * block_align);
+  if (st == NULL || st->raw == NULL)
+    {
+      free (st);
+      fclose (fp);
+      return -1;
+    }
+
+  st->fp = fp;
+  st->format = format;
+  st->bits = bits;
+  st->block_align = block_align;
+  st->frames_left = data_size / block_align;
+
+  source->sample_rate = sample_rate;
+  source->channels = channels;
+  source->read = wav_source_read;
+  source->close = wav_source_close;
+  source->state = st;
+  return 0;
+}
+
+// ============================================================================
+// 合成源
+// ============================================================================
+
+typedef struct
+{
+  uint64_t position;    // 已生成帧数
+  uint64_t total;	// 总帧数
+} SyntheticSourceState;
+
+static uint32_t
+synthetic_source_read (RouterSource *source, float *dst, uint32_t frames)
+{
+  SyntheticSourceState *st = source->state;
+  uint64_t left = st->total - st->position;
+  if (frames > left)
+    frames = (uint32_t) left;
+
+  // 相位由帧序号直接计算，结果与块大小无关
+  for (uint32_t f = 0; f < frames; f++)
+    {
+      double t = (double) (st->position + f) / source->sample_rate;
+      for (uint32_t c = 0; c < source->channels; c++)
+	dst[f * source->channels + c]
+	  = (float) (0.5 * sin (SYNTHETIC_TWO_PI * 440.0 * (c + 1) * t));
+    }
+  st->position += frames;
+  return frames;
+}
+
+static void
+synthetic_source_close (RouterSource *source)
+{
+  free (source->state);
+  source->state = NULL;
+}
+
+int
+router_source_open_synthetic (RouterSource *source, uint32_t sample_rate,
+			      uint32_t channels, uint64_t frames)
+{
+  if (source == NULL || sample_rate == 0 || channels == 0
+      || channels > ROUTER_MAX_CHANNELS)
+    return -1;
+  memset (source, 0, sizeof (*source));
+
+  SyntheticSourceState *st = calloc (1, sizeof (*st));
+  if (st == NULL)
+    return -1;
+  st->total = frames;
+
+  source->sample_rate = sample_rate;
+  source->channels = channels;
+  source->read = synthetic_source_read;
+  source->close = synthetic_source_close;
+  source->state = st;
+  return 0;
+}
+
+void
+router_source_close (RouterSource *source)
+{
+  if (source != NULL && source->close != NULL)
+    source->close (source);
+}
+
+// ============================================================================
+// WAV 汇
+// ============================================================================
+
+typedef struct
+{
+  FILE *fp;
+  uint64_t frames; // 已写入帧数
+  bool failed;	   // 写入是否出错
+} WavSinkState;
+
+// 生成 32 位 float WAV 文件头
+void
+router_wav_build_float_header (uint8_t *h, uint32_t sample_rate,
+			       uint32_t channels, uint64_t frames)
+{
+  uint32_t block_align = channels * (uint32_t) sizeof (float);
+  uint32_t data_size = (uint32_t) (frames * block_align);
+
+  memcpy (h, "RIFF", 4);
+  write_le32 (h + 4, ROUTER_WAV_FLOAT_HEADER_SIZE - 8 + data_size);
+  memcpy (h + 8, "WAVE", 4);
+
+  memcpy (h + 12, "fmt ", 4);
+  write_le32 (h + 16, 18);
+  write_le16 (h + 20, WAV_FORMAT_IEEE_FLOAT);
+  write_le16 (h + 22, (uint16_t) channels);
+  write_le32 (h + 24, sample_rate);
+  write_le32 (h + 28, sample_rate * block_align);
+  write_le16 (h + 32, (uint16_t) block_align);
+  write_le16 (h + 34, 32);
+  write_le16 (h + 36, 0); // cbSize
+
+  // 非 PCM 格式按规范需要 fact 块
+  memcpy (h + 38, "fact", 4);
+  write_le32 (h + 42, 4);
+  write_le32 (h + 46, (uint32_t) frames);
+
+  memcpy (h + 50, "data", 4);
+  write_le32 (h + 54, data_size);
+}
+
+static int
+wav_sink_write (RouterSink *sink, const float *src, uint32_t frames)
+{
+  WavSinkState *st = sink->state;
+  uint32_t count = frames * sink->channels;
+  uint8_t buf[4 * 256];
+
+  // 按小端逐段转换，不依赖主机字节序
+  for (uint32_t i = 0; i < count;)
+    {
+      uint32_t n = count - i;
+      if (n > 256)
+	n = 256;
+      for (uint32_t j = 0; j < n; j++)
+	{
+	  uint32_t u;
+	  memcpy (&u, &src[i + j], sizeof (u));
+	  write_le32 (buf + j * 4, u);
+	}
+      if (fwrite (buf, 4, n, st->fp) != n)
+	{
+	  st->failed = true;
+	  return -1;
+	}
+      i += n;
+    }
+  st->frames += frames;
+  return 0;
+}
+
+static int
+wav_sink_close (RouterSink *sink)
+{
+  WavSinkState *st = sink->state;
+  if (st == NULL)
+    return -1;
+
+  // 回填长度
+  uint8_t header[ROUTER_WAV_FLOAT_HEADER_SIZE];
+  router_wav_build_float_header (header, sink->sample_rate, sink->channels,
+			  st->frames);
+  bool ok = !st->failed && fseek (st->fp, 0, SEEK_SET) == 0
+	    && fwrite (header, 1, sizeof (header), st->fp) == sizeof (header);
+  if (fclose (st->fp) != 0)
+    ok = false;
+
+  free (st);
+  sink->state = NULL;
+  return ok ? 0 : -1;
+}
+
+int
+router_sink_open_wav (RouterSink *sink, const char *path, uint32_t sample_rate,
+		      uint32_t channels)
+{
+  if (sink == NULL || path == NULL || sample_rate == 0 || channels == 0
+      || channels > ROUTER_MAX_CHANNELS)
+    return -1;
+  memset (sink, 0, sizeof (*sink));
+
+  WavSinkState *st = calloc (1, sizeof (*st));
+  if (st == NULL)
+    return -1;
+  st->fp = fopen (path, "wb");
+  if (st->fp == NULL)
+    {
+      free (st);
+      return -1;
+    }
+
+  // 先写占位文件头，关闭时回填
+  uint8_t header[ROUTER_WAV_FLOAT_HEADER_SIZE];
+  router_wav_build_float_header (header, sample_rate, channels, 0);
+  if (fwrite (header, 1, sizeof (header), st->fp) != sizeof (header))
+    {
+      fclose (st->fp);
+      free (st);
+      return -1;
+    }
+
+  sink->sample_rate = sample_rate;
+  sink->channels = channels;
+  sink->write = wav_sink_write;
+  sink->close = wav_sink_close;
+  sink->state = st;
+  return 0;
+}
+
+// ============================================================================
+// 空汇
+// ============================================================================
+
+typedef struct
+{
+  uint64_t frames;
+  uint64_t checksum;
+} NullSinkState;
+
+uint64_t
+router_checksum_update (uint64_t hash, const float *samples, uint32_t count)
+{
+  for (uint32_t i = 0; i < count; i++)
+    {
+      uint32_t u;
+      memcpy (&u, &samples[i], sizeof (u));
+      for (int b = 0; b < 4; b++)
+	{
+	  hash ^= (u >> (b * 8)) & 0xFFu;
+	  hash *= 0x100000001b3ULL;
+	}
+    }
+  return hash;
+}
+
+static int
+null_sink_write (RouterSink *sink, const float *src, uint32_t frames)
+{
+  NullSinkState *st = sink->state;
+  st->checksum
+    = router_checksum_update (st->checksum, src, frames * sink->channels);
+  st->frames += frames;
+  return 0;
+}
+
+static int
+null_sink_close (RouterSink *sink)
+{
+  free (sink->state);
+  sink->state = NULL;
+  return 0;
+}
+
+int
+router_sink_open_null (RouterSink *sink, uint32_t sample_rate,
+		       uint32_t channels)
+{
+  if (sink == NULL || sample_rate == 0 || channels == 0
+      || channels > ROUTER_MAX_CHANNELS)
+    return -1;
+  memset (sink, 0, sizeof (*sink));
+
+  NullSinkState *st = calloc (1, sizeof (*st));
+  if (st == NULL)
+    return -1;
+  st->checksum = ROUTER_CHECKSUM_INIT;
+
+  sink->sample_rate = sample_rate;
+  sink->channels = channels;
+  sink->write = null_sink_write;
+  sink->close = null_sink_close;
+  sink->state = st;
+  return 0;
+}
+
+uint64_t
+router_sink_null_checksum (const RouterSink *sink)
+{
+  if (sink == NULL || sink->write != null_sink_write || sink->state == NULL)
+    return 0;
+  return ((const NullSinkState *) sink->state)->checksum;
+}
+
+int
+router_sink_close (RouterSink *sink)
+{
+  if (sink == NULL || sink->close == NULL)
+    return -1;
+  return sink->close (sink);
+}
+
+// ============================================================================
+// 离线管线
+// ============================================================================
+
+static uint64_t
+monotonic_ns (void)
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+int
+router_offline_run (RouterSource *source, RouterSink *sink,
+		    const RouterOfflineConfig *config,
+		    RouterOfflineStats *stats)
+{
+  RouterOfflineConfig defaults
+    = {.block_frames = ROUTER_OFFLINE_DEFAULT_BLOCK_FRAMES, .gain = 1.0f};
+  if (config == NULL)
+    config = &defaults;
+
+  if (source == NULL || sink == NULL || source->read == NULL
+      || sink->write == NULL || source->channels != sink->channels
+      || source->sample_rate != sink->sample_rate
+      || source->channels > ROUTER_MAX_CHANNELS || config->block_frames == 0
+      || config->block_frames > ROUTER_OFFLINE_MAX_BLOCK_FRAMES)
+    return -1;
+
+  uint32_t channels = source->channels;
+  uint32_t block = config->block_frames;
+  float *storage = malloc (ROUTER_BUFFER_SAMPLES * sizeof (float));
+  float *in = malloc ((size_t) block * channels * sizeof (float));
+  float *out = malloc ((size_t) block * channels * sizeof (float));
+  float *scratch = malloc ((size_t) block * channels * sizeof (float));
+  RouterDspFormat format = {source->sample_rate, block, channels, scratch};
+  if (storage == NULL || in == NULL || out == NULL || scratch == NULL
+      || (config->dsp != NULL
+	  && router_dsp_host_configure (config->dsp, &format) != 0))
+    {
+      free (storage);
+      free (in);
+      free (out);
+      free (scratch);
+      return -1;
+    }
+
+  RouterRingBuffer ring;
+  router_ring_init (&ring, storage);
+
+  RouterOfflineStats local = {0};
+  int result = 0;
+  uint64_t start = monotonic_ns ();
+
+  // 输入块和输出块大小一致，相当于两个 IOProc 严格同步；
+  // 源结束后继续按块输出，直到环形缓冲区排空
+  for (;;)
+    {
+      uint32_t got = source->read (source, in, block);
+      if (got > 0)
+	{
+	  bool written;
+	  if (router_buffer_is_silent (in, got * channels))
+	    {
+	      written = router_ring_write_silence (&ring, got, channels);
+	      local.silent_frames += got;
+	    }
+	  else
+	    written = router_ring_write (&ring, in, got, channels);
+	  if (!written)
+	    local.overruns++;
+	  local.frames_in += got;
+	}
+
+      uint32_t buffered = router_ring_buffered_samples (&ring) / channels;
+      if (got == 0 && buffered == 0)
+	break;
+
+      uint32_t frames = got > 0 ? got : (buffered < block ? buffered : block);
+      if (!router_render_output (&ring, out, frames, channels, config->gain,
+				 config->dsp, NULL))
+	local.underruns++;
+      if (sink->write (sink, out, frames) != 0)
+	{
+	  result = -1;
+	  break;
+	}
+      local.frames_out += frames;
+    }
+
+  local.elapsed_ns = monotonic_ns () - start;
+  router_ring_detach (&ring);
+  free (storage);
+  free (in);
+  free (out);
+  free (scratch);
+
+  if (stats != NULL)
+    *stats = local;
+  return result;
+}
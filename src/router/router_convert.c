@@ -0,0 +1,263 @@
+//
+// Router 输出格式转换
+//
+
+#include "router/router_convert.h"
+#include <math.h>
+#include <string.h>
+
+#define CONVERT_CHUNK_SAMPLES 512 // 每段量化的采样数（栈上 int32 暂存）
+#define CONVERT_INT32_MAX_FLOAT 2147483520.0f // 小于 2^31 的最大 float
+
+// 噪声传递函数 1 - 1.5 z^-1 + 0.6 z^-2：直流附近压低约 20 dB，奈奎斯特
+// 频率处抬高约 10 dB，零点在单位圆内
+#define CONVERT_SHAPE_A1 1.5f
+#define CONVERT_SHAPE_A2 -0.6f
+#define CONVERT_SHAPE_MAX_ERROR 4.0f // 削波时的大误差不再反馈 (LSB)
+
+// 量化参数
+typedef struct
+{
+  float scale; // 满刻度对应的整数
+  float low;   // 最小值
+  float high;  // 最大值
+  bool dither; // 是否加抖动
+} QuantizeParams;
+
+// ====== 格式 ======
+
+int
+router_sample_format_from_pcm (bool is_float, bool is_signed_integer,
+			       bool is_aligned_high, uint32_t bits,
+			       uint32_t bytes, RouterSampleFormat *format)
+{
+  if (is_float)
+    {
+      if (bits != 32 || bytes != 4)
+	return -1;
+      *format = kRouterSampleFloat32;
+      return 0;
+    }
+  if (!is_signed_integer)
+    return -1;
+  if (bits == 16 && bytes == 2)
+    *format = kRouterSampleInt16;
+  else if (bits == 24 && bytes == 3)
+    *format = kRouterSampleInt24;
+  else if (bits == 24 && bytes == 4)
+    *format = is_aligned_high ? kRouterSampleInt24High : kRouterSampleInt24Low;
+  else if (bits == 32 && bytes == 4)
+    *format = kRouterSampleInt32;
+  else
+    return -1;
+  return 0;
+}
+
+uint32_t
+router_sample_format_bytes (RouterSampleFormat format)
+{
+  switch (format)
+    {
+    case kRouterSampleInt16:
+      return 2;
+    case kRouterSampleInt24:
+      return 3;
+    default:
+      return 4;
+    }
+}
+
+uint32_t
+router_sample_format_bits (RouterSampleFormat format)
+{
+  switch (format)
+    {
+    case kRouterSampleInt16:
+      return 16;
+    case kRouterSampleInt24:
+    case kRouterSampleInt24High:
+    case kRouterSampleInt24Low:
+      return 24;
+    default:
+      return 32;
+    }
+}
+
+const char *
+router_sample_format_name (RouterSampleFormat format)
+{
+  switch (format)
+    {
+    case kRouterSampleFloat32:
+      return "Float32";
+    case kRouterSampleInt16:
+      return "Int16";
+    case kRouterSampleInt24:
+      return "Int24 (packed)";
+    case kRouterSampleInt24High:
+      return "Int24 in 32 (high)";
+    case kRouterSampleInt24Low:
+      return "Int24 in 32 (low)";
+    case kRouterSampleInt32:
+      return "Int32";
+    default:
+      return "unknown";
+    }
+}
+
+// ====== 抖动 ======
+
+void
+router_dither_init (RouterDither *dither, RouterDitherMode mode)
+{
+  memset (dither, 0, sizeof (*dither));
+  dither->mode = mode < kRouterDitherModeCount ? mode : kRouterDitherTpdf;
+}
+
+// 计数器哈希 (lowbias32)：第 n 个抖动值只取决于 n，循环内没有依赖
+static inline uint32_t
+hash32 (uint32_t x)
+{
+  x ^= x >> 16;
+  x *= 0x7FEB352Du;
+  x ^= x >> 15;
+  x *= 0x846CA68Bu;
+  x ^= x >> 16;
+  return x;
+}
+
+// 三角分布抖动 (LSB)：两个 16 位均匀分布之差，范围 (-1, 1)
+static inline float
+tpdf (uint32_t n)
+{
+  uint32_t h = hash32 (n);
+  return ((float) (h & 0xFFFFu) - (float) (h >> 16)) * (1.0f / 65536.0f);
+}
+
+// ====== 量化 ======
+
+// 不整形：每个采样独立计算
+static void
+quantize_block (const float *restrict src, int32_t *restrict dst,
+		uint32_t count, const QuantizeParams *params, uint32_t counter)
+{
+  const float scale = params->scale;
+  const float low = params->low;
+  const float high = params->high;
+  if (params->dither)
+    for (uint32_t i = 0; i < count; i++)
+      {
+	float y = src[i] * scale + tpdf (counter + i);
+	y = y == y ? y : 0.0f;
+	dst[i] = (int32_t) rintf (fminf (fmaxf (y, low), high));
+      }
+  else
+    for (uint32_t i = 0; i < count; i++)
+      {
+	float y = src[i] * scale;
+	y = y == y ? y : 0.0f;
+	dst[i] = (int32_t) rintf (fminf (fmaxf (y, low), high));
+      }
+}
+
+// 噪声整形：误差经二阶滤波后反馈，逐声道逐采样计算
+static void
+quantize_block_shaped (RouterDither *dither, const float *src, int32_t *dst,
+		       uint32_t frames, uint32_t channels,
+		       const QuantizeParams *params, uint32_t counter)
+{
+  for (uint32_t f = 0; f < frames; f++)
+    for (uint32_t c = 0; c < channels; c++)
+      {
+	float *error = dither->error[c];
+	float u = src[f * channels + c] * params->scale;
+	u = u == u ? u : 0.0f;
+	u -= CONVERT_SHAPE_A1 * error[0] + CONVERT_SHAPE_A2 * error[1];
+	float q = rintf (fminf (fmaxf (u + tpdf (counter++), params->low),
+				params->high));
+	float e = q - u;
+	if (!(fabsf (e) <= CONVERT_SHAPE_MAX_ERROR))
+	  e = 0.0f;
+	error[1] = error[0];
+	error[0] = e;
+	dst[f * channels + c] = (int32_t) q;
+      }
+}
+
+// ====== 写出 ======
+
+static void
+store_block (RouterSampleFormat format, const int32_t *restrict src,
+	     uint8_t *restrict dst, uint32_t count)
+{
+  switch (format)
+    {
+    case kRouterSampleInt16: {
+      int16_t *out = (int16_t *) (void *) dst;
+      for (uint32_t i = 0; i < count; i++)
+	out[i] = (int16_t) src[i];
+      break;
+    }
+    case kRouterSampleInt24:
+      // 小端字节序
+      for (uint32_t i = 0; i < count; i++)
+	{
+	  dst[3 * i] = (uint8_t) src[i];
+	  dst[3 * i + 1] = (uint8_t) (src[i] >> 8);
+	  dst[3 * i + 2] = (uint8_t) (src[i] >> 16);
+	}
+      break;
+    case kRouterSampleInt24High: {
+      int32_t *out = (int32_t *) (void *) dst;
+      for (uint32_t i = 0; i < count; i++)
+	out[i] = (int32_t) ((uint32_t) src[i] << 8);
+      break;
+    }
+    default:
+      memcpy (dst, src, (size_t) count * sizeof (int32_t));
+      break;
+    }
+}
+
+void
+router_convert_from_float (RouterDither *dither, RouterSampleFormat format,
+			   const float *src, void *dst, uint32_t frames,
+			   uint32_t channels)
+{
+  if (channels == 0 || channels > CONVERT_CHUNK_SAMPLES)
+    return;
+  if (format == kRouterSampleFloat32 || format >= kRouterSampleFormatCount)
+    {
+      memcpy (dst, src, (size_t) frames * channels * sizeof (float));
+      return;
+    }
+
+  uint32_t bits = router_sample_format_bits (format);
+  QuantizeParams params;
+  params.scale = ldexpf (1.0f, (int) bits - 1);
+  params.low = -params.scale;
+  params.high = bits < 32 ? params.scale - 1.0f : CONVERT_INT32_MAX_FLOAT;
+  params.dither = bits < 32 && dither->mode != kRouterDitherOff;
+  bool shaped = params.dither && dither->mode == kRouterDitherShaped
+		&& channels <= ROUTER_MAX_CHANNELS;
+
+  const uint32_t bytes = router_sample_format_bytes (format);
+  const uint32_t chunk_frames = CONVERT_CHUNK_SAMPLES / channels;
+  int32_t chunk[CONVERT_CHUNK_SAMPLES];
+  uint8_t *out = dst;
+  while (frames > 0)
+    {
+      uint32_t n = frames < chunk_frames ? frames : chunk_frames;
+      uint32_t count = n * channels;
+      if (shaped)
+	quantize_block_shaped (dither, src, chunk, n, channels, &params,
+			       dither->counter);
+      else
+	quantize_block (src, chunk, count, &params, dither->counter);
+      store_block (format, chunk, out, count);
+      dither->counter += count;
+      src += count;
+      out += (size_t) count * bytes;
+      frames -= n;
+    }
+}
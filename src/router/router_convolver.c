@@ -0,0 +1,405 @@
+//
+// Router 分块卷积器
+//
+// 均匀分块重叠保留法（块长 B，FFT 长度 2B）：
+//   IR 第 p 块 h[pB .. pB+B-1] 补零到 2B 后变换得 H_p（控制线程预先计算）
+//   每凑满 B 帧输入，对 [上一块 | 当前块] 做 FFT 得 X_n，写入频域延迟线
+//   Y_n = Σ_p X_(n-p) × H_p，逆变换后后 B 个采样即本块的线性卷积结果
+// 输出比输入晚一块：当前调用输出的是上一块凑满时算好的结果
+//
+
+#include "router/router_convolver.h"
+#include "router/router_backend.h"
+#include "router/router_memory.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define CONVOLVER_FFT_SIZE (2 * ROUTER_CONVOLVER_BLOCK)
+#define CONVOLVER_READ_FRAMES 4096	    // 读取 WAV 时每次读取的帧数
+#define CONVOLVER_RETIRE_POLL_NS 100000	    // 等待实时线程离开旧 IR 的轮询间隔
+
+_Static_assert (ROUTER_CONVOLVER_MAX_IR_FRAMES % ROUTER_CONVOLVER_BLOCK == 0,
+		"IR length limit must be a whole number of partitions");
+
+static int convolver_prepare (RouterDspProcessor *processor,
+			      const RouterDspFormat *format);
+static void convolver_process (RouterDspProcessor *processor, float *buffer,
+			       uint32_t frames);
+
+// ====== 冲激响应 ======
+
+RouterConvolverIr *
+router_convolver_ir_create (const float *samples, uint32_t frames,
+			    uint32_t channels, uint32_t sample_rate, float gain)
+{
+  if (samples == NULL || frames == 0
+      || frames > ROUTER_CONVOLVER_MAX_IR_FRAMES || channels == 0
+      || channels > ROUTER_CONVOLVER_MAX_CHANNELS || sample_rate == 0
+      || !isfinite (gain))
+    return NULL;
+
+  const uint32_t partitions
+    = (frames + ROUTER_CONVOLVER_BLOCK - 1) / ROUTER_CONVOLVER_BLOCK;
+  const size_t bins = (size_t) channels * partitions
+		      * ROUTER_CONVOLVER_BIN_STRIDE;
+
+  RouterConvolverIr *ir = calloc (1, sizeof (*ir));
+  float *time = malloc (CONVOLVER_FFT_SIZE * sizeof (float));
+  RouterFft fft;
+  int fft_result = router_fft_init (&fft, CONVOLVER_FFT_SIZE);
+  if (ir != NULL)
+    {
+      // IR 频谱同样由实时线程逐块读取
+      ir->re = router_locked_alloc (bins * sizeof (float));
+      ir->im = router_locked_alloc (bins * sizeof (float));
+    }
+  if (ir == NULL || ir->re == NULL || ir->im == NULL || time == NULL
+      || fft_result != 0)
+    {
+      router_convolver_ir_destroy (ir);
+      router_fft_destroy (&fft);
+      free (time);
+      return NULL;
+    }
+
+  ir->sample_rate = sample_rate;
+  ir->channels = channels;
+  ir->frames = frames;
+  ir->partitions = partitions;
+
+  // 每块放在前半段、后半段补零，与实时线程的 [上一块 | 当前块] 对应
+  for (uint32_t c = 0; c < channels; c++)
+    {
+      for (uint32_t p = 0; p < partitions; p++)
+	{
+	  memset (time, 0, CONVOLVER_FFT_SIZE * sizeof (float));
+	  uint32_t start = p * ROUTER_CONVOLVER_BLOCK;
+	  for (uint32_t n = 0; n < ROUTER_CONVOLVER_BLOCK && start + n < frames;
+	       n++)
+	    time[n] = samples[(size_t) (start + n) * channels + c] * gain;
+	  size_t offset
+	    = ((size_t) c * partitions + p) * ROUTER_CONVOLVER_BIN_STRIDE;
+	  router_fft_forward (&fft, time, ir->re + offset, ir->im + offset);
+	}
+    }
+
+  router_fft_destroy (&fft);
+  free (time);
+  return ir;
+}
+
+RouterConvolverIr *
+router_convolver_ir_load_wav (const char *path, float gain)
+{
+  RouterSource source;
+  if (router_source_open_wav (&source, path) != 0)
+    return NULL;
+
+  // 多读一帧用于判断是否超过长度上限
+  const size_t capacity = (size_t) ROUTER_CONVOLVER_MAX_IR_FRAMES + 1;
+  float *samples = malloc (capacity * source.channels * sizeof (float));
+  uint32_t frames = 0;
+  while (samples != NULL && frames < capacity)
+    {
+      uint32_t want = (uint32_t) (capacity - frames);
+      if (want > CONVOLVER_READ_FRAMES)
+	want = CONVOLVER_READ_FRAMES;
+      uint32_t got = source.read (&source,
+				  samples + (size_t) frames * source.channels,
+				  want);
+      if (got == 0)
+	break;
+      frames += got;
+    }
+
+  RouterConvolverIr *ir = NULL;
+  if (samples != NULL && frames <= ROUTER_CONVOLVER_MAX_IR_FRAMES)
+    ir = router_convolver_ir_create (samples, frames, source.channels,
+				     source.sample_rate, gain);
+  free (samples);
+  source.close (&source);
+  return ir;
+}
+
+void
+router_convolver_ir_destroy (RouterConvolverIr *ir)
+{
+  if (ir == NULL)
+    return;
+  router_locked_free (ir->re);
+  router_locked_free (ir->im);
+  free (ir);
+}
+
+// ====== 控制线程 ======
+
+static void
+convolver_free_buffers (RouterConvolver *convolver)
+{
+  router_fft_destroy (&convolver->fft);
+  router_locked_free (convolver->input);
+  router_locked_free (convolver->output);
+  router_locked_free (convolver->fdl_re);
+  router_locked_free (convolver->fdl_im);
+  router_locked_free (convolver->acc_re);
+  router_locked_free (convolver->acc_im);
+  router_locked_free (convolver->time);
+  convolver->input = NULL;
+  convolver->output = NULL;
+  convolver->fdl_re = NULL;
+  convolver->fdl_im = NULL;
+  convolver->acc_re = NULL;
+  convolver->acc_im = NULL;
+  convolver->time = NULL;
+}
+
+// 实时线程每块都会访问的缓冲区：清零、预缺页并锁定，运行中不会缺页
+// 或被换出（延迟线按 MAX_PARTITIONS 分配，2 声道约 3 MB）
+static float *
+alloc_locked (size_t count)
+{
+  return router_locked_alloc (count * sizeof (float));
+}
+
+void
+router_convolver_init (RouterConvolver *convolver)
+{
+  memset (convolver, 0, sizeof (*convolver));
+  convolver->processor.name = "convolver";
+  convolver->processor.prepare = convolver_prepare;
+  convolver->processor.process = convolver_process;
+  convolver->processor.state = convolver;
+  atomic_init (&convolver->active, NULL);
+  atomic_init (&convolver->in_use, NULL);
+}
+
+void
+router_convolver_destroy (RouterConvolver *convolver)
+{
+  router_convolver_ir_destroy (atomic_exchange (&convolver->active, NULL));
+  convolver_free_buffers (convolver);
+}
+
+void
+router_convolver_set_ir (RouterConvolver *convolver, RouterConvolverIr *ir)
+{
+  RouterConvolverIr *old = atomic_exchange (&convolver->active, ir);
+  if (old == NULL)
+    return;
+
+  // 实时线程一次处理的时长内必然离开旧 IR
+  struct timespec poll = {0, CONVOLVER_RETIRE_POLL_NS};
+  while (atomic_load (&convolver->in_use) == old)
+    nanosleep (&poll, NULL);
+  router_convolver_ir_destroy (old);
+}
+
+static bool
+ir_matches (const RouterConvolver *convolver, const RouterConvolverIr *ir)
+{
+  return ir != NULL && convolver->fdl_re != NULL
+	 && ir->sample_rate == convolver->sample_rate
+	 && (ir->channels == 1 || ir->channels == convolver->channels);
+}
+
+bool
+router_convolver_is_active (RouterConvolver *convolver)
+{
+  return ir_matches (convolver, atomic_load (&convolver->active));
+}
+
+static int
+convolver_prepare (RouterDspProcessor *processor, const RouterDspFormat *format)
+{
+  RouterConvolver *convolver = processor->state;
+  if (format->channels == 0
+      || format->channels > ROUTER_CONVOLVER_MAX_CHANNELS
+      || format->sample_rate == 0)
+    return -1;
+
+  convolver_free_buffers (convolver);
+  const uint32_t channels = format->channels;
+  const size_t fdl = (size_t) channels * ROUTER_CONVOLVER_MAX_PARTITIONS
+		     * ROUTER_CONVOLVER_BIN_STRIDE;
+  int result = router_fft_init (&convolver->fft, CONVOLVER_FFT_SIZE);
+  convolver->input
+    = alloc_locked ((size_t) channels * 2 * ROUTER_CONVOLVER_BLOCK);
+  convolver->output
+    = alloc_locked ((size_t) channels * ROUTER_CONVOLVER_BLOCK);
+  convolver->fdl_re = alloc_locked (fdl);
+  convolver->fdl_im = alloc_locked (fdl);
+  convolver->acc_re = alloc_locked (ROUTER_CONVOLVER_BIN_STRIDE);
+  convolver->acc_im = alloc_locked (ROUTER_CONVOLVER_BIN_STRIDE);
+  convolver->time = alloc_locked (CONVOLVER_FFT_SIZE);
+  if (result != 0 || convolver->input == NULL || convolver->output == NULL
+      || convolver->fdl_re == NULL || convolver->fdl_im == NULL
+      || convolver->acc_re == NULL || convolver->acc_im == NULL
+      || convolver->time == NULL)
+    {
+      convolver_free_buffers (convolver);
+      return -1;
+    }
+
+  convolver->channels = channels;
+  convolver->sample_rate = format->sample_rate;
+  convolver->fill = 0;
+  convolver->head = 0;
+  convolver->history = 0;
+  convolver->running = false;
+  // 按最长 IR 估计尾音，IR 随时可能替换
+  processor->tail_frames
+    = ROUTER_CONVOLVER_MAX_IR_FRAMES + ROUTER_CONVOLVER_BLOCK;
+  return 0;
+}
+
+// ====== 实时线程 ======
+
+// 登记并返回当前 IR：登记后复核 active，保证控制线程看到登记时 IR 尚未被替换
+static inline RouterConvolverIr *
+ir_acquire (RouterConvolver *convolver)
+{
+  RouterConvolverIr *ir = atomic_load (&convolver->active);
+  for (;;)
+    {
+      atomic_store (&convolver->in_use, ir);
+      RouterConvolverIr *check = atomic_load (&convolver->active);
+      if (check == ir)
+	return ir;
+      ir = check;
+    }
+}
+
+static inline void
+ir_release (RouterConvolver *convolver)
+{
+  atomic_store_explicit (&convolver->in_use, NULL, memory_order_release);
+}
+
+// 复数乘加 acc += x × h，频点补齐到 BIN_STRIDE，整段按向量处理
+static void
+mac_spectrum (float *restrict acc_re, float *restrict acc_im,
+	      const float *restrict x_re, const float *restrict x_im,
+	      const float *restrict h_re, const float *restrict h_im)
+{
+  for (uint32_t k = 0; k < ROUTER_CONVOLVER_BIN_STRIDE; k++)
+    {
+      acc_re[k] += x_re[k] * h_re[k] - x_im[k] * h_im[k];
+      acc_im[k] += x_re[k] * h_im[k] + x_im[k] * h_re[k];
+    }
+}
+
+// 从直通切换到卷积：延迟线中的旧块不再参与乘加，清空上一块输入和待输出块
+static void
+convolver_reset (RouterConvolver *convolver)
+{
+  convolver->history = 0;
+  convolver->fill = 0;
+  memset (convolver->input, 0,
+	  (size_t) convolver->channels * 2 * ROUTER_CONVOLVER_BLOCK
+	    * sizeof (float));
+  memset (convolver->output, 0,
+	  (size_t) convolver->channels * ROUTER_CONVOLVER_BLOCK
+	    * sizeof (float));
+}
+
+// 凑满一块后：变换输入、写入延迟线，按 IR 分块乘加并逆变换
+static void
+convolver_run_block (RouterConvolver *convolver, const RouterConvolverIr *ir)
+{
+  const uint32_t block = ROUTER_CONVOLVER_BLOCK;
+  const size_t stride = ROUTER_CONVOLVER_BIN_STRIDE;
+  const uint32_t capacity = ROUTER_CONVOLVER_MAX_PARTITIONS;
+  if (convolver->history < capacity)
+    convolver->history++;
+  const uint32_t parts = ir->partitions < convolver->history
+			   ? ir->partitions
+			   : convolver->history;
+
+  for (uint32_t c = 0; c < convolver->channels; c++)
+    {
+      float *input = convolver->input + (size_t) c * 2 * block;
+      float *fdl_re = convolver->fdl_re + (size_t) c * capacity * stride;
+      float *fdl_im = convolver->fdl_im + (size_t) c * capacity * stride;
+      router_fft_forward (&convolver->fft, input,
+			  fdl_re + convolver->head * stride,
+			  fdl_im + convolver->head * stride);
+      memcpy (input, input + block, block * sizeof (float));
+
+      const uint32_t path = ir->channels == 1 ? 0 : c;
+      const float *h_re = ir->re + (size_t) path * ir->partitions * stride;
+      const float *h_im = ir->im + (size_t) path * ir->partitions * stride;
+      memset (convolver->acc_re, 0, stride * sizeof (float));
+      memset (convolver->acc_im, 0, stride * sizeof (float));
+      uint32_t slot = convolver->head;
+      for (uint32_t p = 0; p < parts; p++)
+	{
+	  mac_spectrum (convolver->acc_re, convolver->acc_im,
+			fdl_re + slot * stride, fdl_im + slot * stride,
+			h_re + p * stride, h_im + p * stride);
+	  slot = slot == 0 ? capacity - 1 : slot - 1;
+	}
+
+      router_fft_inverse (&convolver->fft, convolver->acc_re,
+			  convolver->acc_im, convolver->time);
+      memcpy (convolver->output + (size_t) c * block, convolver->time + block,
+	      block * sizeof (float));
+    }
+
+  convolver->head = convolver->head + 1 == capacity ? 0 : convolver->head + 1;
+}
+
+static void
+convolver_process (RouterDspProcessor *processor, float *buffer,
+		   uint32_t frames)
+{
+  RouterConvolver *convolver = processor->state;
+  const RouterConvolverIr *ir = ir_acquire (convolver);
+  if (!ir_matches (convolver, ir))
+    {
+      convolver->running = false;
+      ir_release (convolver);
+      return;
+    }
+  if (!convolver->running)
+    {
+      convolver_reset (convolver);
+      convolver->running = true;
+    }
+
+  const uint32_t block = ROUTER_CONVOLVER_BLOCK;
+  const uint32_t channels = convolver->channels;
+  uint32_t done = 0;
+  while (done < frames)
+    {
+      uint32_t count = block - convolver->fill;
+      if (count > frames - done)
+	count = frames - done;
+
+      // 输入写入当前块，同一位置换出上一块算好的输出
+      for (uint32_t c = 0; c < channels; c++)
+	{
+	  float *input = convolver->input + (size_t) c * 2 * block + block
+			 + convolver->fill;
+	  const float *output
+	    = convolver->output + (size_t) c * block + convolver->fill;
+	  float *x = buffer + (size_t) done * channels + c;
+	  for (uint32_t f = 0; f < count; f++)
+	    {
+	      input[f] = x[(size_t) f * channels];
+	      x[(size_t) f * channels] = output[f];
+	    }
+	}
+
+      convolver->fill += count;
+      done += count;
+      if (convolver->fill == block)
+	{
+	  convolver_run_block (convolver, ir);
+	  convolver->fill = 0;
+	}
+    }
+
+  ir_release (convolver);
+}
@@ -0,0 +1,239 @@
+//
+// Router 耳机交叉馈送
+//
+// 信号流（左声道，右声道对称）：
+//   lo_L = 一阶低通(L)                    低频处增益 G_lo
+//   hi_L = 一阶高架(L)                    低频处增益 1 - G_hi，高频处约 1
+//   L'   = gain × (hi_L + 延迟(lo_R))
+// 交叉量 feed（dB）给出 G_lo = 10^((-5/6·feed - 3)/20)、
+// G_hi = 1 - 10^((feed/6 - 3)/20)，低频处对侧比本侧低 feed dB；
+// gain = 1 / (1 - G_hi + G_lo) 使单声道内容的低频保持 0 dB
+//
+
+#include "router/router_crossfeed.h"
+#include <math.h>
+#include <string.h>
+
+#define CROSSFEED_TWO_PI 6.283185307179586
+
+// 滤波器状态低于该值时清零，避免衰减尾音进入非规格化数拖慢处理
+#define CROSSFEED_DENORMAL_FLOOR 1e-20f
+
+#define CROSSFEED_DELAY_MASK (ROUTER_CROSSFEED_DELAY_CAP - 1)
+
+_Static_assert ((ROUTER_CROSSFEED_DELAY_CAP & CROSSFEED_DELAY_MASK) == 0,
+		"delay capacity must be a power of two");
+
+// 各预设的低通截止频率和交叉量
+static const struct
+{
+  double cutoff_hz;
+  double feed_db;
+} kPresets[kRouterCrossfeedPresetCount] = {
+  [kRouterCrossfeedLight] = {650.0, 9.5},
+  [kRouterCrossfeedMedium] = {700.0, 6.0},
+  [kRouterCrossfeedStrong] = {700.0, 4.5},
+};
+
+static int crossfeed_prepare (RouterDspProcessor *processor,
+			      const RouterDspFormat *format);
+static void crossfeed_process (RouterDspProcessor *processor, float *buffer,
+			       uint32_t frames);
+
+// ====== 参数 ======
+
+int
+router_crossfeed_design (RouterCrossfeedPreset preset, uint32_t sample_rate,
+			 RouterCrossfeedCoeffs *coeffs)
+{
+  if ((unsigned) preset >= kRouterCrossfeedPresetCount || sample_rate == 0)
+    return -1;
+
+  const double fc_lo = kPresets[preset].cutoff_hz;
+  const double feed = kPresets[preset].feed_db;
+  const double gb_lo = feed * -5.0 / 6.0 - 3.0;
+  const double gb_hi = feed / 6.0 - 3.0;
+  const double g_lo = pow (10.0, gb_lo / 20.0);
+  const double g_hi = 1.0 - pow (10.0, gb_hi / 20.0);
+  // 高架的转折频率取在其衰减量与低通增益对称的位置，合成后过渡平滑
+  const double fc_hi
+    = fc_lo * pow (2.0, (gb_lo - 20.0 * log10 (g_hi)) / 12.0);
+
+  double x = exp (-CROSSFEED_TWO_PI * fc_lo / sample_rate);
+  coeffs->lo_b1 = (float) x;
+  coeffs->lo_a0 = (float) (g_lo * (1.0 - x));
+
+  x = exp (-CROSSFEED_TWO_PI * fc_hi / sample_rate);
+  coeffs->hi_b1 = (float) x;
+  coeffs->hi_a0 = (float) (1.0 - g_hi * (1.0 - x));
+  coeffs->hi_a1 = (float) -x;
+
+  coeffs->gain = (float) (1.0 / (1.0 - g_hi + g_lo));
+  return 0;
+}
+
+void
+router_crossfeed_init (RouterCrossfeed *crossfeed)
+{
+  memset (crossfeed, 0, sizeof (*crossfeed));
+  crossfeed->processor.name = "crossfeed";
+  crossfeed->processor.prepare = crossfeed_prepare;
+  crossfeed->processor.process = crossfeed_process;
+  crossfeed->processor.state = crossfeed;
+  atomic_init (&crossfeed->target, 0);
+}
+
+int
+router_crossfeed_set (RouterCrossfeed *crossfeed, bool enabled,
+		      RouterCrossfeedPreset preset)
+{
+  if (!enabled)
+    {
+      atomic_store (&crossfeed->target, 0);
+      return 0;
+    }
+  if ((unsigned) preset >= kRouterCrossfeedPresetCount)
+    return -1;
+  atomic_store (&crossfeed->target, (uint32_t) preset + 1);
+  return 0;
+}
+
+bool
+router_crossfeed_get (RouterCrossfeed *crossfeed,
+		      RouterCrossfeedPreset *preset)
+{
+  uint32_t target = atomic_load (&crossfeed->target);
+  if (target == 0)
+    return false;
+  if (preset != NULL)
+    *preset = (RouterCrossfeedPreset) (target - 1);
+  return true;
+}
+
+// 不在运行中的链里，可以直接重置实时线程一侧的状态
+static int
+crossfeed_prepare (RouterDspProcessor *processor,
+		   const RouterDspFormat *format)
+{
+  RouterCrossfeed *crossfeed = processor->state;
+  if (format->sample_rate == 0)
+    return -1;
+
+  crossfeed->channels = format->channels;
+  crossfeed->sample_rate = format->sample_rate;
+  uint32_t delay = (uint32_t) lround ((double) format->sample_rate
+				      * ROUTER_CROSSFEED_DELAY_US / 1e6);
+  if (delay < 1)
+    delay = 1;
+  if (delay > CROSSFEED_DELAY_MASK)
+    delay = CROSSFEED_DELAY_MASK;
+  crossfeed->delay = delay;
+  uint32_t ramp_frames
+    = format->sample_rate * ROUTER_CROSSFEED_RAMP_MS / 1000;
+  crossfeed->wet_step = 1.0f / (float) (ramp_frames > 0 ? ramp_frames : 1);
+  processor->tail_frames
+    = format->sample_rate * ROUTER_CROSSFEED_TAIL_MS / 1000;
+
+  // 从直通开始，首块按目标淡入
+  crossfeed->current = 0;
+  crossfeed->wet = 0.0f;
+  return 0;
+}
+
+// ====== 实时线程 ======
+
+// 换系数并清零历史（只在完全直通时调用）
+static void
+crossfeed_switch (RouterCrossfeed *crossfeed, uint32_t target)
+{
+  crossfeed->current = target;
+  if (target == 0)
+    return;
+  router_crossfeed_design ((RouterCrossfeedPreset) (target - 1),
+			   crossfeed->sample_rate, &crossfeed->coeffs);
+  memset (crossfeed->lo, 0, sizeof (crossfeed->lo));
+  memset (crossfeed->hi, 0, sizeof (crossfeed->hi));
+  memset (crossfeed->x1, 0, sizeof (crossfeed->x1));
+  memset (crossfeed->delay_line, 0, sizeof (crossfeed->delay_line));
+  crossfeed->delay_pos = 0;
+}
+
+// 按 wet 在输入和处理结果之间混合；wet_target 与 wet 不同时逐帧过渡
+static void
+crossfeed_run (RouterCrossfeed *crossfeed, float *buffer, uint32_t frames,
+	       float wet_target)
+{
+  const RouterCrossfeedCoeffs k = crossfeed->coeffs;
+  const uint32_t delay = crossfeed->delay;
+  float lo_l = crossfeed->lo[0], lo_r = crossfeed->lo[1];
+  float hi_l = crossfeed->hi[0], hi_r = crossfeed->hi[1];
+  float x1_l = crossfeed->x1[0], x1_r = crossfeed->x1[1];
+  float *line_l = crossfeed->delay_line[0];
+  float *line_r = crossfeed->delay_line[1];
+  uint32_t pos = crossfeed->delay_pos;
+  float wet = crossfeed->wet;
+  const float step = wet_target > wet ? crossfeed->wet_step
+				      : -crossfeed->wet_step;
+
+  for (uint32_t f = 0; f < frames; f++)
+    {
+      float *frame = buffer + (size_t) f * 2;
+      const float l = frame[0];
+      const float r = frame[1];
+
+      lo_l = k.lo_a0 * l + k.lo_b1 * lo_l;
+      lo_r = k.lo_a0 * r + k.lo_b1 * lo_r;
+      hi_l = k.hi_a0 * l + k.hi_a1 * x1_l + k.hi_b1 * hi_l;
+      hi_r = k.hi_a0 * r + k.hi_a1 * x1_r + k.hi_b1 * hi_r;
+      x1_l = l;
+      x1_r = r;
+
+      line_l[pos] = lo_l;
+      line_r[pos] = lo_r;
+      const uint32_t tap = (pos - delay) & CROSSFEED_DELAY_MASK;
+      const float out_l = k.gain * (hi_l + line_r[tap]);
+      const float out_r = k.gain * (hi_r + line_l[tap]);
+      pos = (pos + 1) & CROSSFEED_DELAY_MASK;
+
+      if (wet != wet_target)
+	{
+	  wet += step;
+	  if ((step > 0.0f && wet > wet_target)
+	      || (step < 0.0f && wet < wet_target))
+	    wet = wet_target;
+	}
+      frame[0] = l + wet * (out_l - l);
+      frame[1] = r + wet * (out_r - r);
+    }
+
+  crossfeed->lo[0] = fabsf (lo_l) < CROSSFEED_DENORMAL_FLOOR ? 0.0f : lo_l;
+  crossfeed->lo[1] = fabsf (lo_r) < CROSSFEED_DENORMAL_FLOOR ? 0.0f : lo_r;
+  crossfeed->hi[0] = fabsf (hi_l) < CROSSFEED_DENORMAL_FLOOR ? 0.0f : hi_l;
+  crossfeed->hi[1] = fabsf (hi_r) < CROSSFEED_DENORMAL_FLOOR ? 0.0f : hi_r;
+  crossfeed->x1[0] = x1_l;
+  crossfeed->x1[1] = x1_r;
+  crossfeed->delay_pos = pos;
+  crossfeed->wet = wet;
+}
+
+static void
+crossfeed_process (RouterDspProcessor *processor, float *buffer,
+		   uint32_t frames)
+{
+  RouterCrossfeed *crossfeed = processor->state;
+  if (crossfeed->channels != 2)
+    return;
+
+  uint32_t target
+    = atomic_load_explicit (&crossfeed->target, memory_order_relaxed);
+
+  // 完全直通时才换系数；目标仍是直通则什么都不做
+  if (crossfeed->wet == 0.0f && target != crossfeed->current)
+    crossfeed_switch (crossfeed, target);
+  if (crossfeed->current == 0)
+    return;
+
+  // 目标与当前系数一致时淡入（或保持），否则先淡出，下一块再切换
+  crossfeed_run (crossfeed, buffer, frames,
+		 target == crossfeed->current ? 1.0f : 0.0f);
+}
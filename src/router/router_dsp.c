@@ -0,0 +1,323 @@
+//
+// Router DSP 链
+//
+
+#include "router/router_dsp.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// 等待实时线程离开旧链时的轮询间隔
+#define DSP_RETIRE_POLL_NS 100000
+
+static inline uint64_t
+monotonic_ns (void)
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+// ====== 控制线程 ======
+
+void
+router_dsp_host_init (RouterDspHost *host)
+{
+  atomic_init (&host->active, NULL);
+  atomic_init (&host->in_use, NULL);
+  pthread_mutex_init (&host->control_mutex, NULL);
+  memset (&host->format, 0, sizeof (host->format));
+  host->configured = false;
+  host->silent_frames = 0;
+}
+
+// 等待实时线程不再使用 chain（实时线程一次处理的时长内必然结束）
+static void
+chain_wait_retired (RouterDspHost *host, const RouterDspChain *chain)
+{
+  struct timespec poll = {0, DSP_RETIRE_POLL_NS};
+  while (atomic_load (&host->in_use) == chain)
+    nanosleep (&poll, NULL);
+}
+
+void
+router_dsp_host_destroy (RouterDspHost *host)
+{
+  free (atomic_exchange (&host->active, NULL));
+  pthread_mutex_destroy (&host->control_mutex);
+}
+
+static void
+chain_update_tail (RouterDspChain *chain)
+{
+  chain->tail_frames = 0;
+  for (uint32_t i = 0; i < chain->count; i++)
+    {
+      uint32_t tail = chain->stages[i].processor->tail_frames;
+      if (tail > chain->tail_frames)
+	chain->tail_frames = tail;
+    }
+}
+
+int
+router_dsp_host_configure (RouterDspHost *host, const RouterDspFormat *format)
+{
+  if (format == NULL || format->sample_rate == 0 || format->max_frames == 0
+      || format->channels == 0 || format->scratch == NULL)
+    return -1;
+
+  pthread_mutex_lock (&host->control_mutex);
+  host->format = *format;
+  host->configured = true;
+  host->silent_frames = 0;
+
+  // 没有实时线程在处理，可以直接修改当前链
+  int result = 0;
+  RouterDspChain *chain = atomic_load (&host->active);
+  for (uint32_t i = 0; chain != NULL && i < chain->count; i++)
+    {
+      RouterDspProcessor *processor = chain->stages[i].processor;
+      if (processor->prepare != NULL
+	  && processor->prepare (processor, &host->format) != 0)
+	result = -1;
+    }
+  if (chain != NULL)
+    chain_update_tail (chain);
+  if (result != 0)
+    free (atomic_exchange (&host->active, NULL));
+
+  pthread_mutex_unlock (&host->control_mutex);
+  return result;
+}
+
+// 查找处理器在链中的级序号，不存在返回 -1
+static int
+chain_find (const RouterDspChain *chain, const RouterDspProcessor *processor)
+{
+  for (uint32_t i = 0; chain != NULL && i < chain->count; i++)
+    {
+      if (chain->stages[i].processor == processor)
+	return (int) i;
+    }
+  return -1;
+}
+
+// 把旧链中同一处理器本周期的统计并入新链（旧链已退役，只剩控制线程访问；
+// 新链可能已被实时线程更新，所以累加而不是覆盖）
+static void
+stage_carry_stats (RouterDspStage *stage, RouterDspStage *old)
+{
+  atomic_fetch_add (&stage->busy_ns, atomic_load (&old->busy_ns));
+  atomic_fetch_add (&stage->frames, atomic_load (&old->frames));
+  atomic_fetch_add (&stage->calls, atomic_load (&old->calls));
+  uint32_t peak = atomic_load (&old->peak_permille);
+  uint32_t current = atomic_load (&stage->peak_permille);
+  while (peak > current
+	 && !atomic_compare_exchange_weak (&stage->peak_permille, &current,
+					   peak))
+    ;
+}
+
+int
+router_dsp_host_set_chain (RouterDspHost *host,
+			   RouterDspProcessor *const *processors,
+			   uint32_t count)
+{
+  if (count > ROUTER_DSP_MAX_STAGES || (count > 0 && processors == NULL))
+    return -1;
+  for (uint32_t i = 0; i < count; i++)
+    {
+      if (processors[i] == NULL || processors[i]->process == NULL)
+	return -1;
+    }
+
+  RouterDspChain *chain = calloc (1, sizeof (RouterDspChain));
+  if (chain == NULL)
+    return -1;
+
+  pthread_mutex_lock (&host->control_mutex);
+  RouterDspChain *old = atomic_load (&host->active);
+
+  int result = 0;
+  chain->count = count;
+  for (uint32_t i = 0; i < count; i++)
+    {
+      RouterDspStage *stage = &chain->stages[i];
+      stage->processor = processors[i];
+      int existing = chain_find (old, processors[i]);
+      if (existing >= 0)
+	{
+	  // 保留旁路标志；统计等旧链退役后再并入（见 stage_carry_stats）
+	  atomic_init (&stage->bypass,
+		       atomic_load (&old->stages[existing].bypass));
+	}
+      else if (host->configured && processors[i]->prepare != NULL
+	       && processors[i]->prepare (processors[i], &host->format) != 0)
+	{
+	  result = -1;
+	  break;
+	}
+    }
+
+  if (result != 0)
+    {
+      pthread_mutex_unlock (&host->control_mutex);
+      free (chain);
+      return -1;
+    }
+
+  chain_update_tail (chain);
+  old = atomic_exchange (&host->active, count > 0 ? chain : NULL);
+  if (count == 0)
+    free (chain);
+  if (old != NULL)
+    {
+      chain_wait_retired (host, old);
+      for (uint32_t i = 0; i < count; i++)
+	{
+	  int existing = chain_find (old, processors[i]);
+	  if (existing >= 0)
+	    stage_carry_stats (&chain->stages[i], &old->stages[existing]);
+	}
+      free (old);
+    }
+
+  pthread_mutex_unlock (&host->control_mutex);
+  return 0;
+}
+
+int
+router_dsp_host_set_bypass (RouterDspHost *host, uint32_t index, bool bypass)
+{
+  pthread_mutex_lock (&host->control_mutex);
+  RouterDspChain *chain = atomic_load (&host->active);
+  int result = -1;
+  if (chain != NULL && index < chain->count)
+    {
+      atomic_store (&chain->stages[index].bypass, bypass);
+      result = 0;
+    }
+  pthread_mutex_unlock (&host->control_mutex);
+  return result;
+}
+
+uint32_t
+router_dsp_host_collect_stats (RouterDspHost *host, RouterDspStageStats *stats,
+			       uint32_t max_stats)
+{
+  pthread_mutex_lock (&host->control_mutex);
+  RouterDspChain *chain = atomic_load (&host->active);
+  uint32_t sample_rate = host->format.sample_rate;
+  uint32_t count = 0;
+  for (; chain != NULL && count < chain->count && count < max_stats; count++)
+    {
+      RouterDspStage *stage = &chain->stages[count];
+      RouterDspStageStats *out = &stats[count];
+      const char *name = stage->processor->name;
+      strncpy (out->name, name != NULL ? name : "?", sizeof (out->name) - 1);
+      out->name[sizeof (out->name) - 1] = '\0';
+      out->bypass = atomic_load (&stage->bypass);
+      out->calls = atomic_exchange (&stage->calls, 0);
+      out->frames = atomic_exchange (&stage->frames, 0);
+      uint64_t busy_ns = atomic_exchange (&stage->busy_ns, 0);
+      uint32_t peak = atomic_exchange (&stage->peak_permille, 0);
+      // 平均负载 = 耗时 / 音频时长 = busy_ns × rate / (frames × 1e9)
+      uint64_t avg = out->frames > 0 && sample_rate > 0
+		       ? busy_ns * sample_rate / 1000000ULL / out->frames
+		       : 0;
+      out->avg_permille = (uint16_t) (avg > UINT16_MAX ? UINT16_MAX : avg);
+      out->peak_permille = (uint16_t) (peak > UINT16_MAX ? UINT16_MAX : peak);
+    }
+  pthread_mutex_unlock (&host->control_mutex);
+  return count;
+}
+
+// ====== 实时线程 ======
+
+// 登记并返回当前链：登记后复核 active，保证控制线程看到登记时链尚未被替换
+static inline RouterDspChain *
+chain_acquire (RouterDspHost *host)
+{
+  RouterDspChain *chain = atomic_load (&host->active);
+  for (;;)
+    {
+      atomic_store (&host->in_use, chain);
+      RouterDspChain *check = atomic_load (&host->active);
+      if (check == chain)
+	return chain;
+      chain = check;
+    }
+}
+
+static inline void
+chain_release (RouterDspHost *host)
+{
+  atomic_store_explicit (&host->in_use, NULL, memory_order_release);
+}
+
+static inline void
+stage_account (RouterDspStage *stage, uint64_t duration_ns, uint32_t frames,
+	       uint32_t sample_rate)
+{
+  atomic_fetch_add_explicit (&stage->busy_ns, duration_ns,
+			     memory_order_relaxed);
+  atomic_fetch_add_explicit (&stage->frames, frames, memory_order_relaxed);
+  atomic_fetch_add_explicit (&stage->calls, 1, memory_order_relaxed);
+
+  uint64_t permille = duration_ns * sample_rate / 1000000ULL / frames;
+  uint32_t clamped = permille > UINT32_MAX ? UINT32_MAX : (uint32_t) permille;
+  if (clamped > atomic_load_explicit (&stage->peak_permille,
+				      memory_order_relaxed))
+    atomic_store_explicit (&stage->peak_permille, clamped,
+			   memory_order_relaxed);
+}
+
+bool
+router_dsp_host_process (RouterDspHost *host, float *buffer, uint32_t frames,
+			 bool silent)
+{
+  if (host == NULL || !host->configured || frames == 0)
+    return false;
+
+  RouterDspChain *chain = chain_acquire (host);
+  if (chain == NULL)
+    {
+      chain_release (host);
+      return false;
+    }
+
+  // 静音输入：尾音输出完之后各级的输出也是静音，整块跳过
+  if (silent)
+    {
+      if (host->silent_frames >= chain->tail_frames)
+	{
+	  chain_release (host);
+	  return false;
+	}
+      host->silent_frames += frames;
+    }
+  else
+    host->silent_frames = 0;
+
+  uint32_t max_frames = host->format.max_frames;
+  uint32_t channels = host->format.channels;
+  uint32_t sample_rate = host->format.sample_rate;
+  for (uint32_t offset = 0; offset < frames; offset += max_frames)
+    {
+      uint32_t chunk = frames - offset < max_frames ? frames - offset
+						     : max_frames;
+      float *chunk_buffer = buffer + (size_t) offset * channels;
+      for (uint32_t i = 0; i < chain->count; i++)
+	{
+	  RouterDspStage *stage = &chain->stages[i];
+	  if (atomic_load_explicit (&stage->bypass, memory_order_relaxed))
+	    continue;
+	  uint64_t start = monotonic_ns ();
+	  stage->processor->process (stage->processor, chunk_buffer, chunk);
+	  stage_account (stage, monotonic_ns () - start, chunk, sample_rate);
+	}
+    }
+
+  chain_release (host);
+  return true;
+}
@@ -0,0 +1,127 @@
+//
+// 自动闪避（ducking）
+//
+// 人声通道：瞬时响度 >= 门限 -> 记录时刻 t
+// 媒体通道（每块）：
+//   闪避 = 启用 且 现在 - t <= 保持时间
+//   目标 = 闪避 ? -深度 : 0
+//   增益按 深度/起音时间（下降）或 深度/释放时间（上升）的速率向目标移动
+// 每块只做几次原子读取和一次比较，不逐采样计算
+//
+
+#include "router/router_duck.h"
+#include <math.h>
+#include <stddef.h>
+
+// ====== 参数 ======
+
+void
+router_duck_control_init (RouterDuckControl *control)
+{
+  atomic_init (&control->enabled, false);
+  atomic_init (&control->depth_db, ROUTER_DUCK_DEFAULT_DEPTH_DB);
+  atomic_init (&control->threshold_lufs, ROUTER_DUCK_DEFAULT_THRESHOLD_LUFS);
+  atomic_init (&control->attack_ms, ROUTER_DUCK_DEFAULT_ATTACK_MS);
+  atomic_init (&control->hold_ms, ROUTER_DUCK_DEFAULT_HOLD_MS);
+  atomic_init (&control->release_ms, ROUTER_DUCK_DEFAULT_RELEASE_MS);
+  atomic_init (&control->voice_ns, 0);
+}
+
+bool
+router_duck_params_are_valid (const RouterDuckParams *params)
+{
+  // 比较均写成“在范围内”的形式，NaN 不满足任何一项
+  return params != NULL && params->depth_db >= 0.0f
+	 && params->depth_db <= ROUTER_DUCK_MAX_DEPTH_DB
+	 && params->threshold_lufs >= ROUTER_DUCK_MIN_THRESHOLD_LUFS
+	 && params->threshold_lufs <= ROUTER_DUCK_MAX_THRESHOLD_LUFS
+	 && params->attack_ms >= ROUTER_DUCK_MIN_RAMP_MS
+	 && params->attack_ms <= ROUTER_DUCK_MAX_TIME_MS
+	 && params->hold_ms >= 0.0f && params->hold_ms <= ROUTER_DUCK_MAX_TIME_MS
+	 && params->release_ms >= ROUTER_DUCK_MIN_RAMP_MS
+	 && params->release_ms <= ROUTER_DUCK_MAX_TIME_MS;
+}
+
+int
+router_duck_set_params (RouterDuckControl *control,
+			const RouterDuckParams *params)
+{
+  if (!router_duck_params_are_valid (params))
+    return -1;
+  atomic_store (&control->depth_db, params->depth_db);
+  atomic_store (&control->threshold_lufs, params->threshold_lufs);
+  atomic_store (&control->attack_ms, params->attack_ms);
+  atomic_store (&control->hold_ms, params->hold_ms);
+  atomic_store (&control->release_ms, params->release_ms);
+  atomic_store (&control->enabled, params->enabled);
+  return 0;
+}
+
+void
+router_duck_get_params (RouterDuckControl *control, RouterDuckParams *params)
+{
+  params->enabled = atomic_load (&control->enabled);
+  params->depth_db = atomic_load (&control->depth_db);
+  params->threshold_lufs = atomic_load (&control->threshold_lufs);
+  params->attack_ms = atomic_load (&control->attack_ms);
+  params->hold_ms = atomic_load (&control->hold_ms);
+  params->release_ms = atomic_load (&control->release_ms);
+}
+
+// ====== 人声活动 ======
+
+void
+router_duck_report_voice (RouterDuckControl *control,
+			  const RouterDuckParams *params, float loudness_lufs,
+			  uint64_t now_ns)
+{
+  if (params->enabled && loudness_lufs >= params->threshold_lufs)
+    atomic_store_explicit (&control->voice_ns, now_ns, memory_order_relaxed);
+}
+
+bool
+router_duck_is_engaged (RouterDuckControl *control,
+			const RouterDuckParams *params, uint64_t now_ns)
+{
+  if (!params->enabled)
+    return false;
+
+  // 其他通道可能刚写入稍晚的时刻，此时差值按 0 计
+  uint64_t voice_ns
+    = atomic_load_explicit (&control->voice_ns, memory_order_relaxed);
+  if (voice_ns == 0)
+    return false;
+  uint64_t elapsed = now_ns > voice_ns ? now_ns - voice_ns : 0;
+  return (double) elapsed <= (double) params->hold_ms * 1e6;
+}
+
+// ====== 通道增益 ======
+
+void
+router_duck_init (RouterDuck *duck)
+{
+  duck->gain_db = 0.0f;
+}
+
+float
+router_duck_update (RouterDuck *duck, const RouterDuckParams *params,
+		    bool engaged, uint32_t frames, uint32_t sample_rate)
+{
+  if (frames == 0 || sample_rate == 0)
+    return duck->gain_db;
+
+  // 深度在闪避期间被调小（或关闭）时，按当前衰减量计算恢复速率
+  float target = engaged ? -params->depth_db : 0.0f;
+  float span = fmaxf (params->depth_db, -duck->gain_db);
+  float ms = (float) frames * 1000.0f / (float) sample_rate;
+  float delta = target - duck->gain_db;
+  float max_down = span * ms / params->attack_ms;
+  float max_up = span * ms / params->release_ms;
+  if (delta < -max_down)
+    duck->gain_db -= max_down;
+  else if (delta > max_up)
+    duck->gain_db += max_up;
+  else
+    duck->gain_db = target; // 到达目标时精确落在 0 dB 或深度上
+  return duck->gain_db;
+}
@@ -0,0 +1,369 @@
+//
+// Router 参数均衡器
+//
+
+#include "router/router_eq.h"
+#include <math.h>
+#include <string.h>
+
+// 三缓冲中间槽位的编码：低位为槽位序号，EQ_SLOT_DIRTY 表示实时线程尚未取走
+#define EQ_SLOT_MASK 0x3u
+#define EQ_SLOT_DIRTY 0x4u
+
+// 滤波器状态低于该值时清零，避免衰减尾音进入非规格化数拖慢处理
+#define EQ_DENORMAL_FLOOR 1e-20f
+
+#define EQ_TWO_PI 6.283185307179586
+
+static const RouterEqBiquad kIdentity = {1.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+
+// ====== 系数设计 ======
+
+bool
+router_eq_band_is_valid (const RouterEqBand *band)
+{
+  // 比较均写成“在范围内”的形式，NaN 不满足任何一项
+  return band != NULL && (unsigned) band->type < kRouterEqTypeCount
+	 && band->frequency >= ROUTER_EQ_MIN_FREQ
+	 && band->frequency <= ROUTER_EQ_MAX_FREQ
+	 && fabsf (band->gain_db) <= ROUTER_EQ_MAX_GAIN_DB
+	 && band->q >= ROUTER_EQ_MIN_Q && band->q <= ROUTER_EQ_MAX_Q;
+}
+
+void
+router_eq_design (const RouterEqBand *band, uint32_t sample_rate,
+		  RouterEqBiquad *out)
+{
+  if (!band->enabled || sample_rate == 0)
+    {
+      *out = kIdentity;
+      return;
+    }
+
+  double fs = sample_rate;
+  double freq = band->frequency < 0.45 * fs ? band->frequency : 0.45 * fs;
+  double w0 = EQ_TWO_PI * freq / fs;
+  double cosw = cos (w0);
+  double alpha = sin (w0) / (2.0 * band->q);
+  double a = pow (10.0, band->gain_db / 40.0);
+  double sqrt_a2 = 2.0 * sqrt (a) * alpha;
+  double b0, b1, b2, a0, a1, a2;
+
+  switch (band->type)
+    {
+    case kRouterEqLowShelf:
+      b0 = a * ((a + 1.0) - (a - 1.0) * cosw + sqrt_a2);
+      b1 = 2.0 * a * ((a - 1.0) - (a + 1.0) * cosw);
+      b2 = a * ((a + 1.0) - (a - 1.0) * cosw - sqrt_a2);
+      a0 = (a + 1.0) + (a - 1.0) * cosw + sqrt_a2;
+      a1 = -2.0 * ((a - 1.0) + (a + 1.0) * cosw);
+      a2 = (a + 1.0) + (a - 1.0) * cosw - sqrt_a2;
+      break;
+    case kRouterEqHighShelf:
+      b0 = a * ((a + 1.0) + (a - 1.0) * cosw + sqrt_a2);
+      b1 = -2.0 * a * ((a - 1.0) + (a + 1.0) * cosw);
+      b2 = a * ((a + 1.0) + (a - 1.0) * cosw - sqrt_a2);
+      a0 = (a + 1.0) - (a - 1.0) * cosw + sqrt_a2;
+      a1 = 2.0 * ((a - 1.0) - (a + 1.0) * cosw);
+      a2 = (a + 1.0) - (a - 1.0) * cosw - sqrt_a2;
+      break;
+    case kRouterEqHighPass:
+      b0 = (1.0 + cosw) / 2.0;
+      b1 = -(1.0 + cosw);
+      b2 = (1.0 + cosw) / 2.0;
+      a0 = 1.0 + alpha;
+      a1 = -2.0 * cosw;
+      a2 = 1.0 - alpha;
+      break;
+    case kRouterEqLowPass:
+      b0 = (1.0 - cosw) / 2.0;
+      b1 = 1.0 - cosw;
+      b2 = (1.0 - cosw) / 2.0;
+      a0 = 1.0 + alpha;
+      a1 = -2.0 * cosw;
+      a2 = 1.0 - alpha;
+      break;
+    case kRouterEqPeaking:
+    default:
+      b0 = 1.0 + alpha * a;
+      b1 = -2.0 * cosw;
+      b2 = 1.0 - alpha * a;
+      a0 = 1.0 + alpha / a;
+      a1 = -2.0 * cosw;
+      a2 = 1.0 - alpha / a;
+      break;
+    }
+
+  out->b0 = (float) (b0 / a0);
+  out->b1 = (float) (b1 / a0);
+  out->b2 = (float) (b2 / a0);
+  out->a1 = (float) (a1 / a0);
+  out->a2 = (float) (a2 / a0);
+}
+
+double
+router_eq_response_db (const RouterEqBiquad *coeffs, double frequency,
+		       uint32_t sample_rate)
+{
+  // H(e^jw) = (b0 + b1 e^-jw + b2 e^-2jw) / (1 + a1 e^-jw + a2 e^-2jw)
+  double w = EQ_TWO_PI * frequency / sample_rate;
+  double c1 = cos (w), s1 = sin (w);
+  double c2 = cos (2.0 * w), s2 = sin (2.0 * w);
+  double num_re = coeffs->b0 + coeffs->b1 * c1 + coeffs->b2 * c2;
+  double num_im = -coeffs->b1 * s1 - coeffs->b2 * s2;
+  double den_re = 1.0 + coeffs->a1 * c1 + coeffs->a2 * c2;
+  double den_im = -coeffs->a1 * s1 - coeffs->a2 * s2;
+  double num = num_re * num_re + num_im * num_im;
+  double den = den_re * den_re + den_im * den_im;
+  return 10.0 * log10 (num / den);
+}
+
+// 由当前参数计算整组系数（调用者持有 mutex）
+static void
+eq_compute (const RouterEq *eq, RouterEqCoeffs *out)
+{
+  out->preamp = eq->enabled ? powf (10.0f, eq->preamp_db / 20.0f) : 1.0f;
+  out->band_count = 0;
+  for (uint32_t i = 0; i < ROUTER_EQ_MAX_BANDS; i++)
+    {
+      if (eq->enabled && i < eq->band_count && eq->bands[i].enabled)
+	{
+	  router_eq_design (&eq->bands[i], eq->sample_rate, &out->bands[i]);
+	  out->band_count = i + 1;
+	}
+      else
+	out->bands[i] = kIdentity;
+    }
+}
+
+// ====== 控制线程 ======
+
+static int eq_prepare (RouterDspProcessor *processor,
+		       const RouterDspFormat *format);
+static void eq_process (RouterDspProcessor *processor, float *buffer,
+			uint32_t frames);
+
+void
+router_eq_init (RouterEq *eq)
+{
+  memset (eq, 0, sizeof (*eq));
+  pthread_mutex_init (&eq->mutex, NULL);
+  eq->processor.name = "eq";
+  eq->processor.prepare = eq_prepare;
+  eq->processor.process = eq_process;
+  eq->processor.state = eq;
+  eq_compute (eq, &eq->current);
+  eq->back = 1;
+  atomic_init (&eq->middle, 2);
+}
+
+void
+router_eq_destroy (RouterEq *eq)
+{
+  pthread_mutex_destroy (&eq->mutex);
+}
+
+int
+router_eq_set_config (RouterEq *eq, bool enabled, float preamp_db,
+		      const RouterEqBand *bands, uint32_t band_count)
+{
+  if (band_count > ROUTER_EQ_MAX_BANDS || (band_count > 0 && bands == NULL)
+      || !(fabsf (preamp_db) <= ROUTER_EQ_MAX_GAIN_DB))
+    return -1;
+  for (uint32_t i = 0; i < band_count; i++)
+    {
+      if (!router_eq_band_is_valid (&bands[i]))
+	return -1;
+    }
+
+  pthread_mutex_lock (&eq->mutex);
+  eq->enabled = enabled;
+  eq->preamp_db = preamp_db;
+  eq->band_count = band_count;
+  if (band_count > 0)
+    memcpy (eq->bands, bands, band_count * sizeof (RouterEqBand));
+
+  // 未 prepare 时只保存参数，prepare 时按采样率计算
+  if (eq->sample_rate != 0)
+    {
+      eq_compute (eq, &eq->slots[eq->back]);
+      eq->back = atomic_exchange_explicit (&eq->middle,
+					   eq->back | EQ_SLOT_DIRTY,
+					   memory_order_acq_rel)
+		 & EQ_SLOT_MASK;
+    }
+  pthread_mutex_unlock (&eq->mutex);
+  return 0;
+}
+
+// 不在运行中的链里，可以直接重置实时线程一侧的状态
+static int
+eq_prepare (RouterDspProcessor *processor, const RouterDspFormat *format)
+{
+  RouterEq *eq = processor->state;
+  if (format->channels > ROUTER_EQ_MAX_CHANNELS)
+    return -1;
+
+  pthread_mutex_lock (&eq->mutex);
+  eq->sample_rate = format->sample_rate;
+  eq->channels = format->channels;
+  eq->ramp_frames = format->sample_rate * ROUTER_EQ_RAMP_MS / 1000;
+  if (eq->ramp_frames == 0)
+    eq->ramp_frames = 1;
+  processor->tail_frames = format->sample_rate * ROUTER_EQ_TAIL_MS / 1000;
+
+  eq_compute (eq, &eq->current);
+  eq->active_bands = eq->current.band_count;
+  eq->ramp_left = 0;
+  eq->front = 0;
+  eq->back = 1;
+  eq->slots[0] = eq->current;
+  atomic_store (&eq->middle, 2);
+  memset (eq->z1, 0, sizeof (eq->z1));
+  memset (eq->z2, 0, sizeof (eq->z2));
+  pthread_mutex_unlock (&eq->mutex);
+  return 0;
+}
+
+// ====== 实时线程 ======
+
+// 从当前系数开始向新目标过渡（过渡中途收到新目标时从中途开始）
+static void
+eq_start_ramp (RouterEq *eq, const RouterEqCoeffs *target)
+{
+  float inv = 1.0f / (float) eq->ramp_frames;
+  eq->step.preamp = (target->preamp - eq->current.preamp) * inv;
+  uint32_t bands = eq->current.band_count > target->band_count
+		     ? eq->current.band_count
+		     : target->band_count;
+  for (uint32_t i = 0; i < bands; i++)
+    {
+      const RouterEqBiquad *to = &target->bands[i];
+      const RouterEqBiquad *from = &eq->current.bands[i];
+      RouterEqBiquad *step = &eq->step.bands[i];
+      step->b0 = (to->b0 - from->b0) * inv;
+      step->b1 = (to->b1 - from->b1) * inv;
+      step->b2 = (to->b2 - from->b2) * inv;
+      step->a1 = (to->a1 - from->a1) * inv;
+      step->a2 = (to->a2 - from->a2) * inv;
+    }
+  eq->current.band_count = bands;
+  eq->active_bands = bands;
+  eq->ramp_left = eq->ramp_frames;
+}
+
+// 过渡结束：直接采用目标系数消除累加误差，清零不再处理的段的状态
+static void
+eq_finish_ramp (RouterEq *eq)
+{
+  eq->current = eq->slots[eq->front];
+  for (uint32_t i = eq->current.band_count; i < eq->active_bands; i++)
+    {
+      memset (eq->z1[i], 0, sizeof (eq->z1[i]));
+      memset (eq->z2[i], 0, sizeof (eq->z2[i]));
+    }
+  eq->active_bands = eq->current.band_count;
+}
+
+// 处理 frames 帧；ramp 为 true 时每帧先把系数推进一步
+// channels 在常用路径上是编译期常量，声道循环可展开为向量运算
+static inline void
+eq_run (RouterEq *eq, float *buffer, uint32_t frames, uint32_t channels,
+	bool ramp)
+{
+  uint32_t bands = eq->active_bands;
+  RouterEqCoeffs *cur = &eq->current;
+  const RouterEqCoeffs *step = &eq->step;
+
+  for (uint32_t f = 0; f < frames; f++)
+    {
+      float *frame = buffer + (size_t) f * channels;
+      if (ramp)
+	{
+	  cur->preamp += step->preamp;
+	  for (uint32_t b = 0; b < bands; b++)
+	    {
+	      cur->bands[b].b0 += step->bands[b].b0;
+	      cur->bands[b].b1 += step->bands[b].b1;
+	      cur->bands[b].b2 += step->bands[b].b2;
+	      cur->bands[b].a1 += step->bands[b].a1;
+	      cur->bands[b].a2 += step->bands[b].a2;
+	    }
+	}
+
+      float x[ROUTER_EQ_MAX_CHANNELS];
+      for (uint32_t c = 0; c < channels; c++)
+	x[c] = frame[c] * cur->preamp;
+
+      for (uint32_t b = 0; b < bands; b++)
+	{
+	  const RouterEqBiquad k = cur->bands[b];
+	  float *z1 = eq->z1[b];
+	  float *z2 = eq->z2[b];
+	  for (uint32_t c = 0; c < channels; c++)
+	    {
+	      float y = k.b0 * x[c] + z1[c];
+	      z1[c] = k.b1 * x[c] - k.a1 * y + z2[c];
+	      z2[c] = k.b2 * x[c] - k.a2 * y;
+	      x[c] = y;
+	    }
+	}
+
+      for (uint32_t c = 0; c < channels; c++)
+	frame[c] = x[c];
+    }
+}
+
+static inline void
+eq_run_dispatch (RouterEq *eq, float *buffer, uint32_t frames, bool ramp)
+{
+  if (eq->channels == 2)
+    eq_run (eq, buffer, frames, 2, ramp);
+  else
+    eq_run (eq, buffer, frames, eq->channels, ramp);
+}
+
+static void
+eq_process (RouterDspProcessor *processor, float *buffer, uint32_t frames)
+{
+  RouterEq *eq = processor->state;
+
+  // 取走控制线程发布的新目标（三缓冲交换，不等待）
+  if (atomic_load_explicit (&eq->middle, memory_order_relaxed) & EQ_SLOT_DIRTY)
+    {
+      eq->front = atomic_exchange_explicit (&eq->middle, eq->front,
+					    memory_order_acq_rel)
+		  & EQ_SLOT_MASK;
+      eq_start_ramp (eq, &eq->slots[eq->front]);
+    }
+
+  // 直通且不在过渡中
+  if (eq->ramp_left == 0 && eq->active_bands == 0
+      && eq->current.preamp == 1.0f)
+    return;
+
+  uint32_t done = 0;
+  if (eq->ramp_left > 0)
+    {
+      uint32_t n = frames < eq->ramp_left ? frames : eq->ramp_left;
+      eq_run_dispatch (eq, buffer, n, true);
+      eq->ramp_left -= n;
+      done = n;
+      if (eq->ramp_left == 0)
+	eq_finish_ramp (eq);
+    }
+  if (done < frames)
+    eq_run_dispatch (eq, buffer + (size_t) done * eq->channels,
+		     frames - done, false);
+
+  for (uint32_t b = 0; b < eq->active_bands; b++)
+    {
+      for (uint32_t c = 0; c < eq->channels; c++)
+	{
+	  if (fabsf (eq->z1[b][c]) < EQ_DENORMAL_FLOOR)
+	    eq->z1[b][c] = 0.0f;
+	  if (fabsf (eq->z2[b][c]) < EQ_DENORMAL_FLOOR)
+	    eq->z2[b][c] = 0.0f;
+	}
+    }
+}
@@ -0,0 +1,188 @@
+//
+// 实数 FFT
+//
+// 长度 N 的实数序列 x 看作长度 M = N/2 的复数序列 z[n] = x[2n] + i·x[2n+1]，
+// 做一次复数 FFT 得到 Z，再由
+//   偶数点频谱 E[k] = (Z[k] + conj(Z[M-k])) / 2
+//   奇数点频谱 O[k] = (Z[k] - conj(Z[M-k])) / 2i
+//   X[k] = E[k] + W^k·O[k]，W = e^(-2πi/N)
+// 得到 X[0 ~ M]。逆变换按相反顺序由 X 恢复 Z，再做复数逆变换
+//
+
+#include "router/router_fft.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FFT_TWO_PI 6.283185307179586
+
+// ====== 计划 ======
+
+static uint32_t
+reverse_bits (uint32_t value, uint32_t bits)
+{
+  uint32_t result = 0;
+  for (uint32_t b = 0; b < bits; b++)
+    {
+      result = (result << 1) | (value & 1u);
+      value >>= 1;
+    }
+  return result;
+}
+
+int
+router_fft_init (RouterFft *fft, uint32_t size)
+{
+  memset (fft, 0, sizeof (*fft));
+  if (size < ROUTER_FFT_MIN_SIZE || size > ROUTER_FFT_MAX_SIZE
+      || (size & (size - 1)) != 0)
+    return -1;
+
+  const uint32_t half = size / 2;
+  fft->size = size;
+  fft->half = half;
+  fft->bitrev = malloc (half * sizeof (uint32_t));
+  fft->twiddle_re = malloc (half / 2 * sizeof (float));
+  fft->twiddle_im = malloc (half / 2 * sizeof (float));
+  fft->split_re = malloc (half * sizeof (float));
+  fft->split_im = malloc (half * sizeof (float));
+  fft->work_re = malloc (half * sizeof (float));
+  fft->work_im = malloc (half * sizeof (float));
+  if (fft->bitrev == NULL || fft->twiddle_re == NULL
+      || fft->twiddle_im == NULL || fft->split_re == NULL
+      || fft->split_im == NULL || fft->work_re == NULL
+      || fft->work_im == NULL)
+    {
+      router_fft_destroy (fft);
+      return -1;
+    }
+
+  uint32_t bits = 0;
+  while ((1u << bits) < half)
+    bits++;
+  for (uint32_t n = 0; n < half; n++)
+    fft->bitrev[n] = reverse_bits (n, bits);
+
+  // 旋转因子按双精度计算后再截断，避免递推累积误差
+  for (uint32_t k = 0; k < half / 2; k++)
+    {
+      double phase = FFT_TWO_PI * k / half;
+      fft->twiddle_re[k] = (float) cos (phase);
+      fft->twiddle_im[k] = (float) -sin (phase);
+    }
+  for (uint32_t k = 0; k < half; k++)
+    {
+      double phase = FFT_TWO_PI * k / size;
+      fft->split_re[k] = (float) cos (phase);
+      fft->split_im[k] = (float) -sin (phase);
+    }
+  return 0;
+}
+
+void
+router_fft_destroy (RouterFft *fft)
+{
+  free (fft->bitrev);
+  free (fft->twiddle_re);
+  free (fft->twiddle_im);
+  free (fft->split_re);
+  free (fft->split_im);
+  free (fft->work_re);
+  free (fft->work_im);
+  memset (fft, 0, sizeof (*fft));
+}
+
+// ====== 变换 ======
+
+// 基 2 时间抽取蝶形运算，输入已按位反转顺序放入工作区
+static void
+fft_butterflies (RouterFft *fft)
+{
+  float *re = fft->work_re;
+  float *im = fft->work_im;
+  const uint32_t m = fft->half;
+  for (uint32_t len = 2; len <= m; len <<= 1)
+    {
+      const uint32_t span = len / 2;
+      const uint32_t step = m / len;
+      for (uint32_t start = 0; start < m; start += len)
+	{
+	  for (uint32_t j = 0; j < span; j++)
+	    {
+	      const float wr = fft->twiddle_re[j * step];
+	      const float wi = fft->twiddle_im[j * step];
+	      const uint32_t a = start + j;
+	      const uint32_t b = a + span;
+	      const float tr = re[b] * wr - im[b] * wi;
+	      const float ti = re[b] * wi + im[b] * wr;
+	      re[b] = re[a] - tr;
+	      im[b] = im[a] - ti;
+	      re[a] += tr;
+	      im[a] += ti;
+	    }
+	}
+    }
+}
+
+void
+router_fft_forward (RouterFft *fft, const float *input, float *re, float *im)
+{
+  const uint32_t m = fft->half;
+  for (uint32_t n = 0; n < m; n++)
+    {
+      fft->work_re[fft->bitrev[n]] = input[2 * n];
+      fft->work_im[fft->bitrev[n]] = input[2 * n + 1];
+    }
+  fft_butterflies (fft);
+
+  const float *zr = fft->work_re;
+  const float *zi = fft->work_im;
+  re[0] = zr[0] + zi[0];
+  im[0] = 0.0f;
+  re[m] = zr[0] - zi[0];
+  im[m] = 0.0f;
+  for (uint32_t k = 1; k < m; k++)
+    {
+      // E = (Z[k] + conj(Z[M-k])) / 2，D = (Z[k] - conj(Z[M-k])) / 2，O = D / i
+      const float er = 0.5f * (zr[k] + zr[m - k]);
+      const float ei = 0.5f * (zi[k] - zi[m - k]);
+      const float or_ = 0.5f * (zi[k] + zi[m - k]);
+      const float oi = -0.5f * (zr[k] - zr[m - k]);
+      const float wr = fft->split_re[k];
+      const float wi = fft->split_im[k];
+      re[k] = er + wr * or_ - wi * oi;
+      im[k] = ei + wr * oi + wi * or_;
+    }
+}
+
+void
+router_fft_inverse (RouterFft *fft, const float *re, const float *im,
+		    float *output)
+{
+  const uint32_t m = fft->half;
+  for (uint32_t k = 0; k < m; k++)
+    {
+      // E = (X[k] + conj(X[M-k])) / 2，O = (X[k] - conj(X[M-k])) / 2 × conj(W^k)
+      // Z[k] = E + i·O；按共轭写入，用正变换完成逆变换
+      const float im_k = k == 0 ? 0.0f : im[k];
+      const float im_mk = k == 0 ? 0.0f : im[m - k];
+      const float er = 0.5f * (re[k] + re[m - k]);
+      const float ei = 0.5f * (im_k - im_mk);
+      const float dr = 0.5f * (re[k] - re[m - k]);
+      const float di = 0.5f * (im_k + im_mk);
+      const float wr = fft->split_re[k];
+      const float wi = -fft->split_im[k];
+      const float or_ = dr * wr - di * wi;
+      const float oi = dr * wi + di * wr;
+      fft->work_re[fft->bitrev[k]] = er - oi;
+      fft->work_im[fft->bitrev[k]] = -(ei + or_);
+    }
+  fft_butterflies (fft);
+
+  const float scale = 1.0f / (float) m;
+  for (uint32_t n = 0; n < m; n++)
+    {
+      output[2 * n] = fft->work_re[n] * scale;
+      output[2 * n + 1] = -fft->work_im[n] * scale;
+    }
+}
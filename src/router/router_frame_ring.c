@@ -0,0 +1,89 @@
+//
+// Router 帧环
+//
+
+#include "router/router_frame_ring.h"
+#include <string.h>
+
+int
+router_frame_ring_init (RouterFrameRing *ring, float *storage,
+			uint32_t capacity, uint32_t channels)
+{
+  memset (ring, 0, sizeof (*ring));
+  if (storage == NULL || channels == 0 || capacity == 0
+      || (capacity & (capacity - 1)) != 0)
+    return -1;
+
+  ring->storage = storage;
+  ring->capacity = capacity;
+  ring->channels = channels;
+  atomic_init (&ring->write_pos, 0);
+  atomic_init (&ring->read_pos, 0);
+  atomic_init (&ring->dropped_blocks, 0);
+  atomic_init (&ring->dropped_frames, 0);
+  return 0;
+}
+
+bool
+router_frame_ring_push (RouterFrameRing *ring, const float *buffer,
+			uint32_t frames)
+{
+  uint64_t write
+    = atomic_load_explicit (&ring->write_pos, memory_order_relaxed);
+  uint64_t read = atomic_load_explicit (&ring->read_pos, memory_order_acquire);
+  if (frames > ring->capacity - (write - read))
+    {
+      // 消费者跟不上：丢弃整块，不等待
+      atomic_fetch_add_explicit (&ring->dropped_blocks, 1,
+				 memory_order_relaxed);
+      atomic_fetch_add_explicit (&ring->dropped_frames, frames,
+				 memory_order_release);
+      return false;
+    }
+
+  const uint32_t channels = ring->channels;
+  uint32_t start = (uint32_t) (write & (ring->capacity - 1));
+  uint32_t first = ring->capacity - start;
+  if (first > frames)
+    first = frames;
+  memcpy (ring->storage + (size_t) start * channels, buffer,
+	  (size_t) first * channels * sizeof (float));
+  memcpy (ring->storage, buffer + (size_t) first * channels,
+	  (size_t) (frames - first) * channels * sizeof (float));
+  atomic_store_explicit (&ring->write_pos, write + frames,
+			 memory_order_release);
+  return true;
+}
+
+uint64_t
+router_frame_ring_available (RouterFrameRing *ring)
+{
+  return atomic_load_explicit (&ring->write_pos, memory_order_acquire)
+	 - atomic_load_explicit (&ring->read_pos, memory_order_relaxed);
+}
+
+void
+router_frame_ring_read (RouterFrameRing *ring, float *buffer, uint32_t frames)
+{
+  const uint32_t channels = ring->channels;
+  uint64_t read = atomic_load_explicit (&ring->read_pos, memory_order_relaxed);
+  uint32_t start = (uint32_t) (read & (ring->capacity - 1));
+  uint32_t first = ring->capacity - start;
+  if (first > frames)
+    first = frames;
+  memcpy (buffer, ring->storage + (size_t) start * channels,
+	  (size_t) first * channels * sizeof (float));
+  memcpy (buffer + (size_t) first * channels, ring->storage,
+	  (size_t) (frames - first) * channels * sizeof (float));
+  atomic_store_explicit (&ring->read_pos, read + frames,
+			 memory_order_release);
+}
+
+void
+router_frame_ring_discard (RouterFrameRing *ring)
+{
+  atomic_store_explicit (&ring->read_pos,
+			 atomic_load_explicit (&ring->write_pos,
+					       memory_order_acquire),
+			 memory_order_release);
+}
@@ -0,0 +1,383 @@
+//
+// Router 预读砖墙限制器
+//
+// 信号流（每帧）：
+//   输入 -> 插值历史 -> 真峰值 p -> 所需增益 r = min(1, 上限 / p)
+//   r -> 窗口最小值（单调队列，窗口 = 预读 + 1 帧）-> 释放平滑 -> 箱式平均
+//   输入 -> 延迟线（预读 + 插值群延迟）-> × 增益 -> 输出
+// 箱式平均与窗口最小值长度相同，保证每个采样到达输出时的增益不大于
+// 它自己的所需增益，同时把衰减分摊到峰值之前的整个预读窗口
+//
+
+#include "router/router_limiter.h"
+#include <math.h>
+#include <string.h>
+
+#define LIMITER_PI 3.141592653589793
+
+// 插值群延迟：帧 n 到达时得到的是帧 n - LIMITER_TP_DELAY 的真峰值
+#define LIMITER_TP_DELAY (ROUTER_LIMITER_TP_TAPS / 2)
+
+// 释放过程中距目标小于该值时直接到达，使增益能精确回到 1
+#define LIMITER_RELEASE_SNAP 1e-6f
+
+#define LIMITER_QUEUE_MASK (ROUTER_LIMITER_WINDOW_CAP - 1)
+
+_Static_assert ((ROUTER_LIMITER_WINDOW_CAP & LIMITER_QUEUE_MASK) == 0,
+		"window capacity must be a power of two");
+_Static_assert (ROUTER_LIMITER_MAX_LOOKAHEAD_FRAMES + 1
+		  <= ROUTER_LIMITER_WINDOW_CAP,
+		"window capacity must hold the longest look-ahead");
+
+static int limiter_prepare (RouterDspProcessor *processor,
+			    const RouterDspFormat *format);
+static void limiter_process (RouterDspProcessor *processor, float *buffer,
+			     uint32_t frames);
+
+// ====== 参数 ======
+
+// 窗函数 sinc 插值系数：第 p 个相位位于历史中第 TAPS/2 - 1 与 TAPS/2 个
+// 采样之间的 (p + 1) / 4 处，每个相位按直流增益归一化
+float
+router_limiter_design_true_peak (
+  float coeffs[ROUTER_LIMITER_TP_TAPS][ROUTER_LIMITER_TP_LANES])
+{
+  const double half = ROUTER_LIMITER_TP_TAPS / 2;
+  float bound_max = 1.0f;
+  memset (coeffs, 0,
+	  sizeof (float) * ROUTER_LIMITER_TP_TAPS * ROUTER_LIMITER_TP_LANES);
+  for (uint32_t p = 0; p < ROUTER_LIMITER_TP_PHASES; p++)
+    {
+      double position = half - 1 + (p + 1) / 4.0;
+      double taps[ROUTER_LIMITER_TP_TAPS];
+      double sum = 0.0;
+      for (uint32_t j = 0; j < ROUTER_LIMITER_TP_TAPS; j++)
+	{
+	  double u = position - j;
+	  double sinc = sin (LIMITER_PI * u) / (LIMITER_PI * u);
+	  double window = 0.5 * (1.0 + cos (LIMITER_PI * u / half));
+	  taps[j] = sinc * window;
+	  sum += taps[j];
+	}
+      double bound = 0.0;
+      for (uint32_t j = 0; j < ROUTER_LIMITER_TP_TAPS; j++)
+	{
+	  coeffs[j][p] = (float) (taps[j] / sum);
+	  bound += fabs (taps[j] / sum);
+	}
+      if (bound > bound_max)
+	bound_max = (float) bound;
+    }
+  return bound_max;
+}
+
+void
+router_limiter_init (RouterLimiter *limiter)
+{
+  memset (limiter, 0, sizeof (*limiter));
+  limiter->processor.name = "limiter";
+  limiter->processor.prepare = limiter_prepare;
+  limiter->processor.process = limiter_process;
+  limiter->processor.state = limiter;
+  atomic_init (&limiter->lookahead_ms, ROUTER_LIMITER_DEFAULT_LOOKAHEAD_MS);
+  atomic_init (&limiter->release_ms, ROUTER_LIMITER_DEFAULT_RELEASE_MS);
+  atomic_init (&limiter->ceiling_db, ROUTER_LIMITER_DEFAULT_CEILING_DB);
+  atomic_init (&limiter->gr_peak_cdb, 0);
+  limiter->tp_bound = router_limiter_design_true_peak (limiter->tp_coeffs);
+}
+
+bool
+router_limiter_params_are_valid (const RouterLimiterParams *params)
+{
+  // 比较均写成“在范围内”的形式，NaN 不满足任何一项
+  return params != NULL
+	 && params->lookahead_ms >= ROUTER_LIMITER_MIN_LOOKAHEAD_MS
+	 && params->lookahead_ms <= ROUTER_LIMITER_MAX_LOOKAHEAD_MS
+	 && params->release_ms >= ROUTER_LIMITER_MIN_RELEASE_MS
+	 && params->release_ms <= ROUTER_LIMITER_MAX_RELEASE_MS
+	 && params->ceiling_db >= ROUTER_LIMITER_MIN_CEILING_DB
+	 && params->ceiling_db <= ROUTER_LIMITER_MAX_CEILING_DB;
+}
+
+int
+router_limiter_set_params (RouterLimiter *limiter,
+			   const RouterLimiterParams *params)
+{
+  if (!router_limiter_params_are_valid (params))
+    return -1;
+  atomic_store (&limiter->lookahead_ms, params->lookahead_ms);
+  atomic_store (&limiter->release_ms, params->release_ms);
+  atomic_store (&limiter->ceiling_db, params->ceiling_db);
+  return 0;
+}
+
+void
+router_limiter_get_params (RouterLimiter *limiter, RouterLimiterParams *params)
+{
+  params->lookahead_ms = atomic_load (&limiter->lookahead_ms);
+  params->release_ms = atomic_load (&limiter->release_ms);
+  params->ceiling_db = atomic_load (&limiter->ceiling_db);
+}
+
+uint32_t
+router_limiter_collect (RouterLimiter *limiter)
+{
+  return atomic_exchange_explicit (&limiter->gr_peak_cdb, 0,
+				   memory_order_relaxed);
+}
+
+static int
+limiter_prepare (RouterDspProcessor *processor, const RouterDspFormat *format)
+{
+  RouterLimiter *limiter = processor->state;
+  if (format->channels == 0 || format->channels > ROUTER_LIMITER_MAX_CHANNELS
+      || format->sample_rate == 0)
+    return -1;
+
+  // 超过 ROUTER_LIMITER_MAX_SAMPLE_RATE 时预读帧数截断到缓冲容量
+  double lookahead = atomic_load (&limiter->lookahead_ms)
+		     * (double) format->sample_rate / 1000.0;
+  uint32_t lookahead_frames = (uint32_t) lround (lookahead);
+  if (lookahead_frames < 1)
+    lookahead_frames = 1;
+  if (lookahead_frames > ROUTER_LIMITER_MAX_LOOKAHEAD_FRAMES)
+    lookahead_frames = ROUTER_LIMITER_MAX_LOOKAHEAD_FRAMES;
+
+  limiter->channels = format->channels;
+  limiter->sample_rate = format->sample_rate;
+  limiter->window = lookahead_frames + 1;
+  limiter->delay = lookahead_frames + LIMITER_TP_DELAY;
+  processor->tail_frames = limiter->delay;
+
+  limiter->delay_pos = 0;
+  limiter->tp_pos = 0;
+  limiter->frame_index = 0;
+  limiter->release_ms_cached = 0.0f; // 首块重新计算释放系数
+  limiter->hold_peak = 0.0f;
+  limiter->last_between = 0.0f;
+  limiter->gain = 1.0f;
+  limiter->box_pos = 0;
+  limiter->box_sum = limiter->window;
+  for (uint32_t i = 0; i < limiter->window; i++)
+    limiter->box[i] = 1.0f;
+  limiter->queue_head = 0;
+  limiter->queue_tail = 0;
+  memset (limiter->tp_history, 0, sizeof (limiter->tp_history));
+  memset (limiter->delay_line, 0,
+	  (size_t) limiter->delay * limiter->channels * sizeof (float));
+  atomic_store (&limiter->gr_peak_cdb, 0);
+  return 0;
+}
+
+// ====== 实时线程 ======
+
+// 帧 n 写入插值历史后，返回帧 n - LIMITER_TP_DELAY 与下一个采样之间三个
+// 插值点的峰值（所有声道）。每个相位一个累加器，按 4 路向量计算；声道
+// 成对处理，两条累加链交错推进，不必串行等待加法延迟
+static inline float
+limiter_intersample_peak (const RouterLimiter *limiter, uint32_t channels,
+			  uint32_t pos)
+{
+  float peak = 0.0f;
+  for (uint32_t c = 0; c < channels; c += 2)
+    {
+      // 声道数为奇数时最后一对重复同一声道
+      uint32_t d = c + 1 < channels ? c + 1 : c;
+      const float *a = &limiter->tp_history[c][pos];
+      const float *b = &limiter->tp_history[d][pos];
+      float ya[ROUTER_LIMITER_TP_LANES] = {0};
+      float yb[ROUTER_LIMITER_TP_LANES] = {0};
+      for (uint32_t j = 0; j < ROUTER_LIMITER_TP_TAPS; j++)
+	{
+	  const float *k = limiter->tp_coeffs[j];
+	  for (uint32_t p = 0; p < ROUTER_LIMITER_TP_LANES; p++)
+	    {
+	      ya[p] += a[j] * k[p];
+	      yb[p] += b[j] * k[p];
+	    }
+	}
+      for (uint32_t p = 0; p < ROUTER_LIMITER_TP_PHASES; p++)
+	{
+	  if (fabsf (ya[p]) > peak)
+	    peak = fabsf (ya[p]);
+	  if (fabsf (yb[p]) > peak)
+	    peak = fabsf (yb[p]);
+	}
+    }
+  return peak;
+}
+
+// 处理 frames 帧，返回块内输出增益的最小值
+// channels 在常用路径上是编译期常量；interpolate 为 false 时输入峰值
+// 即使经插值放大也不会超过上限，所需增益恒为 1，只维护历史。
+// 逐帧更新的状态放在局部变量里：输出写入 float 缓冲区，编译器无法排除
+// 它与结构体中 float 成员的别名，直接读写成员会每帧重新加载。
+// 强制内联，保证双声道路径上 channels 是常量
+static inline __attribute__ ((always_inline)) float
+limiter_run (RouterLimiter *limiter, float *buffer, uint32_t frames,
+	     uint32_t channels, bool interpolate)
+{
+  const float ceiling = limiter->ceiling;
+  const float release = limiter->release_coeff;
+  const uint32_t window = limiter->window;
+  const uint32_t delay = limiter->delay;
+  const double inv_window = 1.0 / window;
+  float *queue_gain = limiter->queue_gain;
+  uint32_t *queue_frame = limiter->queue_frame;
+  float *box = limiter->box;
+  float *delay_line = limiter->delay_line;
+
+  uint32_t tp_pos = limiter->tp_pos;
+  uint32_t index = limiter->frame_index;
+  uint32_t head = limiter->queue_head;
+  uint32_t tail = limiter->queue_tail;
+  uint32_t box_pos = limiter->box_pos;
+  uint32_t delay_pos = limiter->delay_pos;
+  double box_sum = limiter->box_sum;
+  float gain = limiter->gain;
+  float min_gain = 1.0f;
+  // 上一帧计算的插值峰值位于当前中心采样之前，两边都计入中心采样的峰值
+  float last_between = interpolate ? limiter->last_between : 0.0f;
+
+  for (uint32_t f = 0; f < frames; f++)
+    {
+      float *frame = buffer + (size_t) f * channels;
+
+      // 1. 插值历史与真峰值
+      for (uint32_t c = 0; c < channels; c++)
+	{
+	  limiter->tp_history[c][tp_pos] = frame[c];
+	  limiter->tp_history[c][tp_pos + ROUTER_LIMITER_TP_TAPS] = frame[c];
+	}
+      tp_pos = tp_pos + 1 == ROUTER_LIMITER_TP_TAPS ? 0 : tp_pos + 1;
+
+      float need = 1.0f;
+      if (interpolate)
+	{
+	  float center = 0.0f;
+	  for (uint32_t c = 0; c < channels; c++)
+	    {
+	      float sample
+		= fabsf (limiter->tp_history[c][tp_pos + LIMITER_TP_DELAY - 1]);
+	      if (sample > center)
+		center = sample;
+	    }
+	  float between = limiter_intersample_peak (limiter, channels, tp_pos);
+	  float peak = center;
+	  if (between > peak)
+	    peak = between;
+	  if (last_between > peak)
+	    peak = last_between;
+	  last_between = between;
+	  if (peak > ceiling)
+	    need = ceiling / peak;
+	}
+
+      // 2. 窗口最小值：队列从头到尾单调递增，尾部弹出不小于新值的元素，
+      //    头部弹出滑出窗口的元素
+      while (tail != head && queue_gain[(tail - 1) & LIMITER_QUEUE_MASK] >= need)
+	tail--;
+      queue_gain[tail & LIMITER_QUEUE_MASK] = need;
+      queue_frame[tail & LIMITER_QUEUE_MASK] = index;
+      tail++;
+      while (index - queue_frame[head & LIMITER_QUEUE_MASK] >= window)
+	head++;
+      index++;
+      float hold = queue_gain[head & LIMITER_QUEUE_MASK];
+
+      // 3. 立即下降，指数恢复（恢复中的增益始终不大于窗口最小值）
+      if (hold <= gain)
+	gain = hold;
+      else
+	{
+	  gain = hold - (hold - gain) * release;
+	  if (hold - gain < LIMITER_RELEASE_SNAP)
+	    gain = hold;
+	}
+
+      // 4. 箱式平均
+      box_sum += gain - box[box_pos];
+      box[box_pos] = gain;
+      box_pos = box_pos + 1 == window ? 0 : box_pos + 1;
+      float out_gain = (float) (box_sum * inv_window);
+      if (out_gain > 1.0f)
+	out_gain = 1.0f;
+      if (out_gain < min_gain)
+	min_gain = out_gain;
+
+      // 5. 延迟线
+      float *delayed = delay_line + (size_t) delay_pos * channels;
+      for (uint32_t c = 0; c < channels; c++)
+	{
+	  float out = delayed[c];
+	  delayed[c] = frame[c];
+	  frame[c] = out * out_gain;
+	}
+      delay_pos = delay_pos + 1 == delay ? 0 : delay_pos + 1;
+    }
+
+  limiter->tp_pos = tp_pos;
+  limiter->frame_index = index;
+  limiter->queue_head = head;
+  limiter->queue_tail = tail;
+  limiter->box_pos = box_pos;
+  limiter->delay_pos = delay_pos;
+  limiter->box_sum = box_sum;
+  limiter->gain = gain;
+  limiter->last_between = last_between;
+  return min_gain;
+}
+
+static void
+limiter_process (RouterDspProcessor *processor, float *buffer, uint32_t frames)
+{
+  RouterLimiter *limiter = processor->state;
+  uint32_t channels = limiter->channels;
+
+  // 参数变化时才重新计算系数
+  float release_ms
+    = atomic_load_explicit (&limiter->release_ms, memory_order_relaxed);
+  if (release_ms != limiter->release_ms_cached)
+    {
+      limiter->release_ms_cached = release_ms;
+      limiter->release_coeff = (float) exp (
+	-1000.0 / (release_ms * (double) limiter->sample_rate));
+    }
+  float ceiling_db
+    = atomic_load_explicit (&limiter->ceiling_db, memory_order_relaxed);
+  limiter->ceiling = powf (10.0f, ceiling_db / 20.0f);
+
+  // 本块及上一块输入的采样峰值乘以插值放大上界仍不超过上限时跳过插值
+  // （插值窗口会跨到上一块；上一块太短时一并保留更早的峰值）
+  float block_peak = 0.0f;
+  for (uint32_t i = 0; i < frames * channels; i++)
+    {
+      float v = fabsf (buffer[i]);
+      if (v > block_peak)
+	block_peak = v;
+    }
+  float recent_peak
+    = block_peak > limiter->hold_peak ? block_peak : limiter->hold_peak;
+  limiter->hold_peak
+    = frames >= ROUTER_LIMITER_TP_TAPS ? block_peak : recent_peak;
+  bool interpolate = recent_peak * limiter->tp_bound > limiter->ceiling;
+
+  float min_gain;
+  if (channels == 2)
+    min_gain = limiter_run (limiter, buffer, frames, 2, interpolate);
+  else
+    min_gain = limiter_run (limiter, buffer, frames, channels, interpolate);
+
+  // 统计周期内最大增益衰减（只有实时线程写入，收集方只做交换）
+  if (min_gain < 1.0f)
+    {
+      uint32_t cdb = (uint32_t) lroundf (-2000.0f * log10f (min_gain));
+      uint32_t cur
+	= atomic_load_explicit (&limiter->gr_peak_cdb, memory_order_relaxed);
+      while (cdb > cur
+	     && !atomic_compare_exchange_weak_explicit (
+	       &limiter->gr_peak_cdb, &cur, cdb, memory_order_relaxed,
+	       memory_order_relaxed))
+	;
+    }
+}
@@ -0,0 +1,97 @@
+//
+// Router 回环缓冲区
+//
+
+#include "router/router_loopback.h"
+#include "router/router_pipeline.h"
+#include <string.h>
+
+void
+router_loopback_reset (RouterLoopback *loopback)
+{
+  memset (loopback->buffer, 0, sizeof (loopback->buffer));
+  atomic_store_explicit (&loopback->write_pos, 0, memory_order_relaxed);
+  atomic_store_explicit (&loopback->read_pos, 0, memory_order_relaxed);
+  atomic_store_explicit (&loopback->silence, 0, memory_order_relaxed);
+  loopback->zero_fill = ROUTER_LOOPBACK_SAMPLES;
+}
+
+void
+router_loopback_write (RouterLoopback *loopback, const float *samples,
+		       uint32_t count)
+{
+  uint32_t start = atomic_load (&loopback->write_pos);
+  uint32_t end = (start + count) % ROUTER_LOOPBACK_SAMPLES;
+  bool silent = router_buffer_is_silent (samples, count);
+
+  if (!silent)
+    {
+      // 先撤销静音标记再发布写位置：否则写位置回绕到旧标记的位置时
+      // （有声数据累计为缓冲区大小的整数倍），读者会把有声块当成静音
+      atomic_store (&loopback->silence, 0);
+      loopback->zero_fill = 0;
+    }
+
+  if (!silent || loopback->zero_fill < ROUTER_LOOPBACK_SAMPLES)
+    {
+      uint32_t first = ROUTER_LOOPBACK_SAMPLES - start;
+      if (first > count)
+	first = count;
+      memcpy (loopback->buffer + start, samples, first * sizeof (float));
+      memcpy (loopback->buffer, samples + first,
+	      (count - first) * sizeof (float));
+      if (silent)
+	loopback->zero_fill
+	  = ROUTER_LOOPBACK_SAMPLES - loopback->zero_fill > count
+	      ? loopback->zero_fill + count
+	      : ROUTER_LOOPBACK_SAMPLES;
+    }
+
+  // 先发布写位置再更新静音标记：读者看到的标记与写位置一致时，
+  // 标记描述的一定是该位置之前的数据
+  atomic_store (&loopback->write_pos, end);
+  if (silent)
+    {
+      uint64_t prev = atomic_load (&loopback->silence);
+      uint32_t run = (uint32_t) (prev >> 32) == start ? (uint32_t) prev : 0;
+      run = ROUTER_LOOPBACK_SAMPLES - run > count ? run + count
+						  : ROUTER_LOOPBACK_SAMPLES;
+      atomic_store (&loopback->silence, ((uint64_t) end << 32) | run);
+    }
+}
+
+bool
+router_loopback_read (RouterLoopback *loopback, float *samples,
+		      uint32_t count)
+{
+  uint32_t read = atomic_load (&loopback->read_pos);
+  uint32_t write = atomic_load (&loopback->write_pos);
+  uint32_t available = write >= read
+			 ? write - read
+			 : ROUTER_LOOPBACK_SAMPLES - read + write;
+
+  if (available < count)
+    {
+      // 数据不足，输出静音
+      memset (samples, 0, count * sizeof (float));
+      return false;
+    }
+
+  // 待读数据全部位于静音区：直接输出静音，不拷贝
+  uint64_t silence = atomic_load (&loopback->silence);
+  if (silence != 0 && (uint32_t) (silence >> 32) == write
+      && (uint32_t) silence >= available)
+    memset (samples, 0, count * sizeof (float));
+  else
+    {
+      uint32_t first = ROUTER_LOOPBACK_SAMPLES - read;
+      if (first > count)
+	first = count;
+      memcpy (samples, loopback->buffer + read, first * sizeof (float));
+      memcpy (samples + first, loopback->buffer,
+	      (count - first) * sizeof (float));
+    }
+
+  atomic_store (&loopback->read_pos, (read + count) % ROUTER_LOOPBACK_SAMPLES);
+  return true;
+}
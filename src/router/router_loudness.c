@@ -0,0 +1,428 @@
+//
+// Router 响度计（ITU-R BS.1770 / EBU R128）
+//
+// 信号流（每声道）：
+//   输入 -> 高架（头部声学效应）-> 高通（RLB 加权）-> 平方 × 声道权重
+//   -> 100ms 子块能量 -> 瞬时 / 短期窗口、400ms 门限块直方图
+//   输入 -> 插值历史 -> 真峰值
+// 响度 L = -0.691 + 10·log10(加权均方能量)
+//
+
+#include "router/router_loudness.h"
+#include <math.h>
+#include <pthread.h>
+#include <string.h>
+
+#define LOUDNESS_PI 3.141592653589793
+
+// 能量与响度的换算偏移（K 加权在 1kHz 的增益补偿）
+#define LOUDNESS_OFFSET -0.691
+
+// 直方图每桶宽度 (LU)
+#define LOUDNESS_BIN_LU 0.1
+
+// 双二阶状态低于该值时清零，避免长时间静音后出现非规格化数
+#define LOUDNESS_DENORMAL 1e-30
+
+_Static_assert (ROUTER_LOUDNESS_MOMENTARY_BLOCKS
+		  <= ROUTER_LOUDNESS_SHORT_TERM_BLOCKS,
+		"short-term window must contain the momentary window");
+
+// 各桶中心响度对应的能量（所有响度计共用，首次 prepare 时计算）
+static double g_bin_energy[ROUTER_LOUDNESS_HISTOGRAM_BINS];
+static pthread_once_t g_bin_energy_once = PTHREAD_ONCE_INIT;
+
+static void
+loudness_init_bins (void)
+{
+  for (uint32_t i = 0; i < ROUTER_LOUDNESS_HISTOGRAM_BINS; i++)
+    {
+      double lufs
+	= ROUTER_LOUDNESS_ABSOLUTE_GATE_LUFS + (i + 0.5) * LOUDNESS_BIN_LU;
+      g_bin_energy[i] = pow (10.0, (lufs - LOUDNESS_OFFSET) / 10.0);
+    }
+}
+
+static float
+loudness_lufs (double energy)
+{
+  if (!(energy > 0.0))
+    return ROUTER_LOUDNESS_MIN_LUFS;
+  double lufs = LOUDNESS_OFFSET + 10.0 * log10 (energy);
+  return lufs > ROUTER_LOUDNESS_MIN_LUFS ? (float) lufs
+					 : ROUTER_LOUDNESS_MIN_LUFS;
+}
+
+// ====== 参数 ======
+
+void
+router_loudness_init (RouterLoudness *meter)
+{
+  memset (meter, 0, sizeof (*meter));
+  atomic_init (&meter->momentary_lufs, ROUTER_LOUDNESS_MIN_LUFS);
+  atomic_init (&meter->short_term_lufs, ROUTER_LOUDNESS_MIN_LUFS);
+  atomic_init (&meter->integrated_lufs, ROUTER_LOUDNESS_MIN_LUFS);
+  atomic_init (&meter->true_peak, 0.0f);
+  atomic_init (&meter->reset_pending, false);
+  meter->tp_bound = router_limiter_design_true_peak (meter->tp_coeffs);
+}
+
+// 清零测量状态并发布下限读数（实时线程或 prepare）
+static void
+loudness_clear (RouterLoudness *meter)
+{
+  meter->block_pos = 0;
+  meter->block_sum = 0.0;
+  meter->block_next = 0;
+  meter->block_count = 0;
+  meter->peak = 0.0f;
+  meter->hold_peak = 0.0f;
+  meter->tp_pos = 0;
+  memset (meter->histogram, 0, sizeof (meter->histogram));
+  memset (meter->z, 0, sizeof (meter->z));
+  memset (meter->tp_history, 0, sizeof (meter->tp_history));
+  atomic_store_explicit (&meter->momentary_lufs, ROUTER_LOUDNESS_MIN_LUFS,
+			 memory_order_relaxed);
+  atomic_store_explicit (&meter->short_term_lufs, ROUTER_LOUDNESS_MIN_LUFS,
+			 memory_order_relaxed);
+  atomic_store_explicit (&meter->integrated_lufs, ROUTER_LOUDNESS_MIN_LUFS,
+			 memory_order_relaxed);
+  atomic_store_explicit (&meter->true_peak, 0.0f, memory_order_relaxed);
+}
+
+int
+router_loudness_prepare (RouterLoudness *meter, uint32_t sample_rate,
+			 uint32_t channels)
+{
+  if (sample_rate == 0 || channels == 0
+      || channels > ROUTER_LOUDNESS_MAX_CHANNELS)
+    return -1;
+
+  pthread_once (&g_bin_energy_once, loudness_init_bins);
+
+  // K 加权系数按 BS.1770 给出的 48kHz 滤波器反推的模拟原型在当前采样率
+  // 下重新设计（与 libebur128 相同的参数）
+  double k = tan (LOUDNESS_PI * 1681.974450955533 / sample_rate);
+  double q = 0.7071752369554196;
+  double vh = pow (10.0, 3.999843853973347 / 20.0);
+  double vb = pow (vh, 0.4996667741545416);
+  double a0 = 1.0 + k / q + k * k;
+  meter->shelf_b[0] = (vh + vb * k / q + k * k) / a0;
+  meter->shelf_b[1] = 2.0 * (k * k - vh) / a0;
+  meter->shelf_b[2] = (vh - vb * k / q + k * k) / a0;
+  meter->shelf_a[0] = 2.0 * (k * k - 1.0) / a0;
+  meter->shelf_a[1] = (1.0 - k / q + k * k) / a0;
+
+  k = tan (LOUDNESS_PI * 38.13547087602444 / sample_rate);
+  q = 0.5003270373238773;
+  a0 = 1.0 + k / q + k * k;
+  meter->highpass_a[0] = 2.0 * (k * k - 1.0) / a0;
+  meter->highpass_a[1] = (1.0 - k / q + k * k) / a0;
+
+  for (uint32_t c = 0; c < ROUTER_LOUDNESS_MAX_CHANNELS; c++)
+    {
+      double weight = 1.0;
+      if (channels >= 6 && c == 3)
+	weight = 0.0; // LFE
+      else if (channels >= 6 && c >= 4)
+	weight = 1.41; // 环绕声道
+      meter->weights[c] = weight;
+    }
+
+  meter->sample_rate = sample_rate;
+  meter->channels = channels;
+  meter->block_frames
+    = (uint32_t) lround (sample_rate * (ROUTER_LOUDNESS_BLOCK_MS / 1000.0));
+  if (meter->block_frames == 0)
+    meter->block_frames = 1;
+  atomic_store (&meter->reset_pending, false);
+  loudness_clear (meter);
+  return 0;
+}
+
+void
+router_loudness_reset (RouterLoudness *meter)
+{
+  atomic_store_explicit (&meter->reset_pending, true, memory_order_release);
+}
+
+void
+router_loudness_read (RouterLoudness *meter, RouterLoudnessReading *reading)
+{
+  reading->momentary_lufs
+    = atomic_load_explicit (&meter->momentary_lufs, memory_order_relaxed);
+  reading->short_term_lufs
+    = atomic_load_explicit (&meter->short_term_lufs, memory_order_relaxed);
+  reading->integrated_lufs
+    = atomic_load_explicit (&meter->integrated_lufs, memory_order_relaxed);
+  float peak = atomic_load_explicit (&meter->true_peak, memory_order_relaxed);
+  float dbtp = peak > 0.0f ? 20.0f * log10f (peak) : ROUTER_LOUDNESS_MIN_LUFS;
+  reading->true_peak_dbtp
+    = dbtp > ROUTER_LOUDNESS_MIN_LUFS ? dbtp : ROUTER_LOUDNESS_MIN_LUFS;
+}
+
+// ====== 实时线程 ======
+
+// 积分响度：绝对门限以上的门限块平均响度减 10 LU 作为相对门限，
+// 再对相对门限以上的块求平均（按桶中心能量计算）
+static float
+loudness_integrated (const RouterLoudness *meter)
+{
+  double sum = 0.0;
+  uint64_t count = 0;
+  for (uint32_t i = 0; i < ROUTER_LOUDNESS_HISTOGRAM_BINS; i++)
+    {
+      sum += meter->histogram[i] * g_bin_energy[i];
+      count += meter->histogram[i];
+    }
+  if (count == 0)
+    return ROUTER_LOUDNESS_MIN_LUFS;
+
+  double relative
+    = loudness_lufs (sum / count) + ROUTER_LOUDNESS_RELATIVE_GATE_LU;
+  double first = ceil ((relative - ROUTER_LOUDNESS_ABSOLUTE_GATE_LUFS)
+			 / LOUDNESS_BIN_LU
+		       - 0.5);
+  uint32_t start = first > 0.0 ? (uint32_t) first : 0;
+  sum = 0.0;
+  count = 0;
+  for (uint32_t i = start; i < ROUTER_LOUDNESS_HISTOGRAM_BINS; i++)
+    {
+      sum += meter->histogram[i] * g_bin_energy[i];
+      count += meter->histogram[i];
+    }
+  return count > 0 ? loudness_lufs (sum / count) : ROUTER_LOUDNESS_MIN_LUFS;
+}
+
+// 子块结束：更新窗口，满 400ms 后每个子块产生一个门限块，然后发布读数
+static void
+loudness_finish_block (RouterLoudness *meter)
+{
+  meter->blocks[meter->block_next] = meter->block_sum / meter->block_frames;
+  meter->block_next
+    = (meter->block_next + 1) % ROUTER_LOUDNESS_SHORT_TERM_BLOCKS;
+  if (meter->block_count < ROUTER_LOUDNESS_SHORT_TERM_BLOCKS)
+    meter->block_count++;
+  meter->block_sum = 0.0;
+  meter->block_pos = 0;
+
+  // 从最新的子块往回累加，窗口未满时按已有子块平均
+  double momentary = 0.0;
+  double short_term = 0.0;
+  for (uint32_t i = 0; i < meter->block_count; i++)
+    {
+      uint32_t index = (meter->block_next + ROUTER_LOUDNESS_SHORT_TERM_BLOCKS
+			- 1 - i)
+		       % ROUTER_LOUDNESS_SHORT_TERM_BLOCKS;
+      short_term += meter->blocks[index];
+      if (i < ROUTER_LOUDNESS_MOMENTARY_BLOCKS)
+	momentary += meter->blocks[index];
+    }
+  uint32_t momentary_blocks
+    = meter->block_count < ROUTER_LOUDNESS_MOMENTARY_BLOCKS
+	? meter->block_count
+	: ROUTER_LOUDNESS_MOMENTARY_BLOCKS;
+  momentary /= momentary_blocks;
+  short_term /= meter->block_count;
+
+  if (meter->block_count >= ROUTER_LOUDNESS_MOMENTARY_BLOCKS)
+    {
+      double lufs = LOUDNESS_OFFSET + 10.0 * log10 (momentary);
+      if (momentary > 0.0 && lufs > ROUTER_LOUDNESS_ABSOLUTE_GATE_LUFS)
+	{
+	  double bin = (lufs - ROUTER_LOUDNESS_ABSOLUTE_GATE_LUFS)
+		       / LOUDNESS_BIN_LU;
+	  uint32_t index = bin < ROUTER_LOUDNESS_HISTOGRAM_BINS - 1
+			     ? (uint32_t) bin
+			     : ROUTER_LOUDNESS_HISTOGRAM_BINS - 1;
+	  // 计数饱和前积分响度早已稳定，饱和后不再增加
+	  if (meter->histogram[index] < UINT32_MAX)
+	    meter->histogram[index]++;
+	  atomic_store_explicit (&meter->integrated_lufs,
+				 loudness_integrated (meter),
+				 memory_order_relaxed);
+	}
+    }
+
+  atomic_store_explicit (&meter->momentary_lufs, loudness_lufs (momentary),
+			 memory_order_relaxed);
+  atomic_store_explicit (&meter->short_term_lufs, loudness_lufs (short_term),
+			 memory_order_relaxed);
+}
+
+// 单声道 K 加权，返回 n 帧的平方和
+static inline double
+loudness_kweight (RouterLoudness *meter, uint32_t channel, const float *input,
+		  uint32_t frames, uint32_t stride)
+{
+  const double b0 = meter->shelf_b[0];
+  const double b1 = meter->shelf_b[1];
+  const double b2 = meter->shelf_b[2];
+  const double a1 = meter->shelf_a[0];
+  const double a2 = meter->shelf_a[1];
+  const double h1 = meter->highpass_a[0];
+  const double h2 = meter->highpass_a[1];
+  double *z = meter->z[channel];
+  double z0 = z[0], z1 = z[1], z2 = z[2], z3 = z[3];
+  double sum = 0.0;
+
+  for (uint32_t f = 0; f < frames; f++)
+    {
+      double x = input[(size_t) f * stride];
+      double y = b0 * x + z0;
+      z0 = b1 * x - a1 * y + z1;
+      z1 = b2 * x - a2 * y;
+      double w = y + z2;
+      z2 = -2.0 * y - h1 * w + z3;
+      z3 = y - h2 * w;
+      sum += w * w;
+    }
+
+  z[0] = fabs (z0) < LOUDNESS_DENORMAL ? 0.0 : z0;
+  z[1] = fabs (z1) < LOUDNESS_DENORMAL ? 0.0 : z1;
+  z[2] = fabs (z2) < LOUDNESS_DENORMAL ? 0.0 : z2;
+  z[3] = fabs (z3) < LOUDNESS_DENORMAL ? 0.0 : z3;
+  return sum;
+}
+
+// 写入插值历史；interpolate 时返回块内各插值点的最大绝对值
+// channels 在常用路径上是编译期常量
+static inline __attribute__ ((always_inline)) float
+loudness_true_peak (RouterLoudness *meter, const float *buffer,
+		    uint32_t frames, uint32_t channels, bool interpolate)
+{
+  float peak = 0.0f;
+  uint32_t pos = meter->tp_pos;
+  for (uint32_t c = 0; c < channels; c++)
+    {
+      float *history = meter->tp_history[c];
+      pos = meter->tp_pos;
+      for (uint32_t f = 0; f < frames; f++)
+	{
+	  float x = buffer[(size_t) f * channels + c];
+	  history[pos] = x;
+	  history[pos + ROUTER_LIMITER_TP_TAPS] = x;
+	  pos = pos + 1 == ROUTER_LIMITER_TP_TAPS ? 0 : pos + 1;
+	  if (!interpolate)
+	    continue;
+
+	  const float *window = &history[pos];
+	  float y[ROUTER_LIMITER_TP_LANES] = {0};
+	  for (uint32_t j = 0; j < ROUTER_LIMITER_TP_TAPS; j++)
+	    {
+	      const float *k = meter->tp_coeffs[j];
+	      for (uint32_t p = 0; p < ROUTER_LIMITER_TP_LANES; p++)
+		y[p] += window[j] * k[p];
+	    }
+	  for (uint32_t p = 0; p < ROUTER_LIMITER_TP_PHASES; p++)
+	    {
+	      if (fabsf (y[p]) > peak)
+		peak = fabsf (y[p]);
+	    }
+	}
+    }
+  meter->tp_pos = pos;
+  return peak;
+}
+
+// 按子块边界切分，逐声道 K 加权并累计能量
+static void
+loudness_accumulate (RouterLoudness *meter, const float *buffer,
+		     uint32_t frames)
+{
+  const uint32_t channels = meter->channels;
+  uint32_t done = 0;
+  while (done < frames)
+    {
+      uint32_t n = meter->block_frames - meter->block_pos;
+      if (n > frames - done)
+	n = frames - done;
+
+      const float *segment = buffer + (size_t) done * channels;
+      double sum = 0.0;
+      for (uint32_t c = 0; c < channels; c++)
+	{
+	  double energy = loudness_kweight (meter, c, segment + c, n, channels);
+	  sum += meter->weights[c] * energy;
+	}
+      meter->block_sum += sum;
+      meter->block_pos += n;
+      done += n;
+
+      if (meter->block_pos == meter->block_frames)
+	loudness_finish_block (meter);
+    }
+}
+
+static void
+loudness_check_reset (RouterLoudness *meter)
+{
+  if (atomic_load_explicit (&meter->reset_pending, memory_order_relaxed)
+      && atomic_exchange_explicit (&meter->reset_pending, false,
+				   memory_order_acquire))
+    loudness_clear (meter);
+}
+
+void
+router_loudness_process (RouterLoudness *meter, const float *buffer,
+			 uint32_t frames)
+{
+  if (meter->sample_rate == 0 || frames == 0)
+    return;
+  loudness_check_reset (meter);
+
+  const uint32_t channels = meter->channels;
+
+  // 本块及上一块的采样峰值乘以插值放大上界仍不超过已记录的真峰值时
+  // 跳过插值（插值窗口会跨到上一块），只维护历史
+  float block_peak = 0.0f;
+  for (uint32_t i = 0; i < frames * channels; i++)
+    {
+      float v = fabsf (buffer[i]);
+      if (v > block_peak)
+	block_peak = v;
+    }
+  float recent_peak
+    = block_peak > meter->hold_peak ? block_peak : meter->hold_peak;
+  meter->hold_peak
+    = frames >= ROUTER_LIMITER_TP_TAPS ? block_peak : recent_peak;
+  bool interpolate = recent_peak * meter->tp_bound > meter->peak;
+
+  float between;
+  if (channels == 2)
+    between = loudness_true_peak (meter, buffer, frames, 2, interpolate);
+  else
+    between = loudness_true_peak (meter, buffer, frames, channels, interpolate);
+  float peak = between > block_peak ? between : block_peak;
+  if (peak > meter->peak)
+    {
+      meter->peak = peak;
+      atomic_store_explicit (&meter->true_peak, peak, memory_order_relaxed);
+    }
+
+  loudness_accumulate (meter, buffer, frames);
+}
+
+void
+router_loudness_add_silence (RouterLoudness *meter, uint32_t frames)
+{
+  if (meter->sample_rate == 0 || frames == 0)
+    return;
+  loudness_check_reset (meter);
+
+  // 滤波器和插值历史直接清零（调用方只在上游余响结束后才跳过处理）
+  memset (meter->z, 0, sizeof (meter->z));
+  memset (meter->tp_history, 0, sizeof (meter->tp_history));
+  meter->hold_peak = 0.0f;
+
+  while (frames > 0)
+    {
+      uint32_t n = meter->block_frames - meter->block_pos;
+      if (n > frames)
+	n = frames;
+      meter->block_pos += n;
+      frames -= n;
+      if (meter->block_pos == meter->block_frames)
+	loudness_finish_block (meter);
+    }
+}
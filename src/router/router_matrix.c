@@ -0,0 +1,303 @@
+//
+// 声道矩阵
+//
+// 立体声 2×2 矩阵按两帧一组处理：
+//   x = [L0 R0 L1 R1]，s = [R0 L0 R1 L1]
+//   y = x × [LL RR LL RR] + s × [LR RL LR RL]
+// 四路乘加互不依赖，编译器可直接生成向量指令；奇数帧的最后一帧单独处理
+//
+
+#include "router/router_matrix.h"
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+
+// ====== 设置 ======
+
+static bool
+channels_are_valid (uint32_t inputs, uint32_t outputs)
+{
+  return inputs >= 1 && inputs <= ROUTER_MATRIX_MAX_CHANNELS && outputs >= 1
+	 && outputs <= ROUTER_MATRIX_MAX_CHANNELS;
+}
+
+static RouterMatrixKind
+matrix_classify (const RouterMatrix *matrix)
+{
+  if (matrix->inputs != matrix->outputs)
+    return kRouterMatrixFull;
+
+  bool unity = true;
+  for (uint32_t o = 0; o < matrix->outputs; o++)
+    {
+      for (uint32_t i = 0; i < matrix->inputs; i++)
+	{
+	  float gain = matrix->gains[o][i];
+	  if (i != o && gain != 0.0f)
+	    return kRouterMatrixFull;
+	  if (i == o && gain != 1.0f)
+	    unity = false;
+	}
+    }
+  return unity ? kRouterMatrixIdentity : kRouterMatrixDiagonal;
+}
+
+int
+router_matrix_init (RouterMatrix *matrix, uint32_t inputs, uint32_t outputs)
+{
+  if (!channels_are_valid (inputs, outputs))
+    return -1;
+
+  memset (matrix, 0, sizeof (*matrix));
+  matrix->inputs = inputs;
+  matrix->outputs = outputs;
+  for (uint32_t o = 0; o < outputs && o < inputs; o++)
+    matrix->gains[o][o] = 1.0f;
+  matrix->kind = matrix_classify (matrix);
+  return 0;
+}
+
+int
+router_matrix_set (RouterMatrix *matrix, uint32_t inputs, uint32_t outputs,
+		   const float *gains)
+{
+  if (!channels_are_valid (inputs, outputs) || gains == NULL)
+    return -1;
+
+  // “在范围内”的比较对 NaN 不成立
+  for (uint32_t n = 0; n < inputs * outputs; n++)
+    {
+      if (!(fabsf (gains[n]) <= ROUTER_MATRIX_MAX_GAIN))
+	return -1;
+    }
+
+  memset (matrix, 0, sizeof (*matrix));
+  matrix->inputs = inputs;
+  matrix->outputs = outputs;
+  for (uint32_t o = 0; o < outputs; o++)
+    {
+      for (uint32_t i = 0; i < inputs; i++)
+	matrix->gains[o][i] = gains[o * inputs + i];
+    }
+  matrix->kind = matrix_classify (matrix);
+  return 0;
+}
+
+bool
+router_stereo_mix_is_valid (const RouterStereoMix *mix)
+{
+  return mix != NULL && mix->balance >= -1.0f && mix->balance <= 1.0f
+	 && mix->pan >= -1.0f && mix->pan <= 1.0f;
+}
+
+// c = a × b（2×2）
+static void
+multiply_2x2 (float c[2][2], const float a[2][2], const float b[2][2])
+{
+  float r[2][2];
+  for (int o = 0; o < 2; o++)
+    {
+      for (int i = 0; i < 2; i++)
+	r[o][i] = a[o][0] * b[0][i] + a[o][1] * b[1][i];
+    }
+  memcpy (c, r, sizeof (r));
+}
+
+int
+router_matrix_from_stereo (RouterMatrix *matrix, const RouterStereoMix *mix)
+{
+  if (!router_stereo_mix_is_valid (mix))
+    return -1;
+
+  float m[2][2] = {{1.0f, 0.0f}, {0.0f, 1.0f}};
+  if (mix->swap)
+    {
+      const float swap[2][2] = {{0.0f, 1.0f}, {1.0f, 0.0f}};
+      multiply_2x2 (m, swap, m);
+    }
+  if (mix->mono)
+    {
+      const float mono[2][2] = {{0.5f, 0.5f}, {0.5f, 0.5f}};
+      multiply_2x2 (m, mono, m);
+    }
+
+  // 声像：把远离一侧的声道按比例移到另一侧，总幅度不变；
+  // 声像到最右时左声道完全并入右声道
+  if (mix->pan > 0.0f)
+    {
+      const float pan[2][2] = {{1.0f - mix->pan, 0.0f}, {mix->pan, 1.0f}};
+      multiply_2x2 (m, pan, m);
+    }
+  else if (mix->pan < 0.0f)
+    {
+      float p = -mix->pan;
+      const float pan[2][2] = {{1.0f, p}, {0.0f, 1.0f - p}};
+      multiply_2x2 (m, pan, m);
+    }
+
+  // 平衡：只衰减另一侧，居中时两侧都不变
+  const float left = mix->balance > 0.0f ? 1.0f - mix->balance : 1.0f;
+  const float right = mix->balance < 0.0f ? 1.0f + mix->balance : 1.0f;
+  const float balance[2][2] = {{left, 0.0f}, {0.0f, right}};
+  multiply_2x2 (m, balance, m);
+
+  return router_matrix_set (matrix, 2, 2, &m[0][0]);
+}
+
+// ====== 实时线程 ======
+
+// 双声道对角矩阵：两帧四路逐路缩放
+static void
+matrix_run_stereo_diagonal (const RouterMatrix *matrix, float *buffer,
+			    uint32_t frames)
+{
+  const float ll = matrix->gains[0][0];
+  const float rr = matrix->gains[1][1];
+  const float direct[4] = {ll, rr, ll, rr};
+  uint32_t pairs = frames / 2;
+  for (uint32_t n = 0; n < pairs; n++)
+    {
+      float *x = buffer + 4 * (size_t) n;
+      for (uint32_t p = 0; p < 4; p++)
+	x[p] *= direct[p];
+    }
+  if (frames & 1)
+    {
+      float *x = buffer + 4 * (size_t) pairs;
+      x[0] *= ll;
+      x[1] *= rr;
+    }
+}
+
+// 双声道一般矩阵：直通项与交叉项各一组四路乘法
+static void
+matrix_run_stereo_full (const RouterMatrix *matrix, float *buffer,
+			uint32_t frames)
+{
+  const float ll = matrix->gains[0][0];
+  const float lr = matrix->gains[0][1];
+  const float rl = matrix->gains[1][0];
+  const float rr = matrix->gains[1][1];
+  const float direct[4] = {ll, rr, ll, rr};
+  const float cross[4] = {lr, rl, lr, rl};
+  uint32_t pairs = frames / 2;
+  for (uint32_t n = 0; n < pairs; n++)
+    {
+      float *x = buffer + 4 * (size_t) n;
+      const float d[4] = {x[0], x[1], x[2], x[3]};
+      const float s[4] = {x[1], x[0], x[3], x[2]};
+      for (uint32_t p = 0; p < 4; p++)
+	x[p] = d[p] * direct[p] + s[p] * cross[p];
+    }
+  if (frames & 1)
+    {
+      float *x = buffer + 4 * (size_t) pairs;
+      float l = x[0];
+      float r = x[1];
+      x[0] = ll * l + lr * r;
+      x[1] = rl * l + rr * r;
+    }
+}
+
+// 通用路径：逐帧先复制输入，输入输出可以是同一缓冲区
+static void
+matrix_run_generic (const RouterMatrix *matrix, const float *input,
+		    float *output, uint32_t frames)
+{
+  const uint32_t inputs = matrix->inputs;
+  const uint32_t outputs = matrix->outputs;
+  for (uint32_t f = 0; f < frames; f++)
+    {
+      float x[ROUTER_MATRIX_MAX_CHANNELS];
+      memcpy (x, input + (size_t) f * inputs, inputs * sizeof (float));
+      float *y = output + (size_t) f * outputs;
+      for (uint32_t o = 0; o < outputs; o++)
+	{
+	  float acc = 0.0f;
+	  for (uint32_t i = 0; i < inputs; i++)
+	    acc += matrix->gains[o][i] * x[i];
+	  y[o] = acc;
+	}
+    }
+}
+
+void
+router_matrix_apply (const RouterMatrix *matrix, float *buffer,
+		     uint32_t frames)
+{
+  if (frames == 0 || matrix->kind == kRouterMatrixIdentity
+      || matrix->inputs != matrix->outputs)
+    return;
+
+  const uint32_t channels = matrix->inputs;
+  if (channels == 2)
+    {
+      if (matrix->kind == kRouterMatrixDiagonal)
+	matrix_run_stereo_diagonal (matrix, buffer, frames);
+      else
+	matrix_run_stereo_full (matrix, buffer, frames);
+      return;
+    }
+
+  if (matrix->kind == kRouterMatrixDiagonal)
+    {
+      for (uint32_t f = 0; f < frames; f++)
+	{
+	  float *x = buffer + (size_t) f * channels;
+	  for (uint32_t c = 0; c < channels; c++)
+	    x[c] *= matrix->gains[c][c];
+	}
+      return;
+    }
+  matrix_run_generic (matrix, buffer, buffer, frames);
+}
+
+void
+router_matrix_process (const RouterMatrix *matrix, const float *input,
+		       float *output, uint32_t frames)
+{
+  if (frames == 0)
+    return;
+
+  // 声道数相同时复制后走原地路径，享用相同的快速路径
+  if (matrix->inputs == matrix->outputs)
+    {
+      memcpy (output, input, (size_t) frames * matrix->inputs * sizeof (float));
+      router_matrix_apply (matrix, output, frames);
+      return;
+    }
+  matrix_run_generic (matrix, input, output, frames);
+}
+
+void
+router_matrix_apply_ramp (const RouterMatrix *from, const RouterMatrix *to,
+			  float *buffer, uint32_t frames)
+{
+  if (frames == 0 || from->inputs != to->inputs
+      || from->outputs != to->outputs || to->inputs != to->outputs)
+    return;
+
+  // 第 f 帧的增益为 from + step × (f + 1)，本块最后一帧恰好到达终点
+  RouterMatrix step = *to;
+  RouterMatrix current = *to;
+  current.kind = kRouterMatrixFull;
+  const float scale = 1.0f / (float) frames;
+  for (uint32_t o = 0; o < to->outputs; o++)
+    {
+      for (uint32_t i = 0; i < to->inputs; i++)
+	step.gains[o][i] = (to->gains[o][i] - from->gains[o][i]) * scale;
+    }
+
+  const uint32_t channels = to->inputs;
+  for (uint32_t f = 0; f < frames; f++)
+    {
+      float t = (float) (f + 1);
+      for (uint32_t o = 0; o < channels; o++)
+	{
+	  for (uint32_t i = 0; i < channels; i++)
+	    current.gains[o][i] = from->gains[o][i] + step.gains[o][i] * t;
+	}
+      matrix_run_generic (&current, buffer + (size_t) f * channels,
+			  buffer + (size_t) f * channels, 1);
+    }
+}
@@ -0,0 +1,67 @@
+//
+// Router 实时内存
+//
+
+#include "router/router_memory.h"
+#include <stdint.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#define MEMORY_HEADER_BYTES 64 // 头部记录映射长度，同时保持 64 字节对齐
+
+// 位于返回地址之前的头部
+typedef struct
+{
+  size_t mapped; // 映射的总字节数（页对齐，含头部）
+  bool locked;	 // mlock 是否成功
+} MemoryHeader;
+
+_Static_assert (sizeof (MemoryHeader) <= MEMORY_HEADER_BYTES,
+		"header must fit before the aligned block");
+
+static MemoryHeader *
+header_of (const void *ptr)
+{
+  return (MemoryHeader *) ((uintptr_t) ptr - MEMORY_HEADER_BYTES);
+}
+
+void *
+router_locked_alloc (size_t bytes)
+{
+  if (bytes == 0 || bytes > SIZE_MAX / 2)
+    return NULL;
+
+  size_t page = (size_t) sysconf (_SC_PAGESIZE);
+  size_t size = (bytes + MEMORY_HEADER_BYTES + page - 1) / page * page;
+  void *base = mmap (NULL, size, PROT_READ | PROT_WRITE,
+		     MAP_PRIVATE | MAP_ANON, -1, 0);
+  if (base == MAP_FAILED)
+    return NULL;
+
+  for (size_t offset = 0; offset < size; offset += page)
+    ((volatile uint8_t *) base)[offset] = 0;
+
+  MemoryHeader *header = base;
+  header->mapped = size;
+  header->locked = mlock (base, size) == 0;
+  return (uint8_t *) base + MEMORY_HEADER_BYTES;
+}
+
+void
+router_locked_free (void *ptr)
+{
+  if (ptr == NULL)
+    return;
+
+  MemoryHeader *header = header_of (ptr);
+  size_t size = header->mapped;
+  if (header->locked)
+    munlock (header, size);
+  munmap (header, size);
+}
+
+bool
+router_locked_is_locked (const void *ptr)
+{
+  return ptr != NULL && header_of (ptr)->locked;
+}
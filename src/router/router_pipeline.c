@@ -0,0 +1,301 @@
+//
+// Router 信号通路（与 CoreAudio 无关的部分）
+//
+
+#include "router/router_pipeline.h"
+#include <stddef.h>
+#include <string.h>
+
+// ====== 环形缓冲区实现 (Lock-Free + Bitmask优化) ======
+
+void
+router_ring_init (RouterRingBuffer *rb, float *storage)
+{
+  // 使用固定大小，必须是2的幂次方以便位掩码
+  rb->capacity = ROUTER_BUFFER_SAMPLES;
+  rb->buffer = storage;
+  // 清零缓冲区
+  memset (rb->buffer, 0, rb->capacity * sizeof (float));
+  atomic_init (&rb->write_pos, 0);
+  atomic_init (&rb->read_pos, 0);
+  atomic_init (&rb->peak_usage, 0);
+  atomic_init (&rb->current_usage, 0);
+  atomic_init (&rb->samples_buffered, 0);
+  atomic_init (&rb->interval_peak, 0);
+  atomic_init (&rb->silence_mark, 0);
+  rb->zero_fill = rb->capacity;
+}
+
+void
+router_ring_detach (RouterRingBuffer *rb)
+{
+  rb->buffer = NULL;
+  rb->capacity = 0;
+}
+
+// 更新性能统计
+static inline void
+ring_update_stats (RouterRingBuffer *rb, uint32_t buffered_samples)
+{
+  // 计算当前使用率 (0-100%)
+  uint32_t usage_percent = (buffered_samples * 100) / rb->capacity;
+  atomic_store_explicit (&rb->current_usage, usage_percent,
+			 memory_order_relaxed);
+  atomic_store_explicit (&rb->samples_buffered, buffered_samples,
+			 memory_order_relaxed);
+  // 更新峰值
+  uint32_t peak = atomic_load_explicit (&rb->peak_usage, memory_order_relaxed);
+  if (usage_percent > peak)
+    {
+      atomic_store_explicit (&rb->peak_usage, usage_percent,
+			     memory_order_relaxed);
+    }
+  // 周期峰值由监控线程读取并清零，偶尔丢失一次更新不影响统计
+  uint32_t interval_peak
+    = atomic_load_explicit (&rb->interval_peak, memory_order_relaxed);
+  if (usage_percent > interval_peak)
+    {
+      atomic_store_explicit (&rb->interval_peak, usage_percent,
+			     memory_order_relaxed);
+    }
+}
+
+// 已用采样数
+// 位置计数器只增不减，无符号差值在计数器回绕（约 12 小时 @ 48kHz 双声道）
+// 后依然正确
+static inline uint32_t
+ring_used (uint32_t write_pos, uint32_t read_pos)
+{
+  return write_pos - read_pos;
+}
+
+// Write data (called by input callback - Producer)
+// 使用位掩码替代取模运算，速度提升10-20倍
+bool
+router_ring_write (RouterRingBuffer *rb, const float *data,
+		   uint32_t frame_count, uint32_t channels)
+{
+  // Check if buffer is valid and initialized
+  if (rb == NULL || rb->buffer == NULL || data == NULL)
+    {
+      return false;
+    }
+
+  uint32_t sample_count = frame_count * channels;
+  uint32_t current_write
+    = atomic_load_explicit (&rb->write_pos, memory_order_relaxed);
+  uint32_t current_read
+    = atomic_load_explicit (&rb->read_pos, memory_order_acquire);
+
+  // 计算已用空间和空闲空间
+  uint32_t size = ring_used (current_write, current_read);
+
+  // capacity - 1 是为了区分满和空
+  uint32_t free_space = rb->capacity - 1 - size;
+
+  if (free_space < sample_count)
+    {
+      // 策略：丢弃新数据以保持同步
+      return false;
+    }
+
+  // 先撤销静音标记再发布写指针：读者看到新数据时一定看到撤销
+  rb->zero_fill = 0;
+  atomic_store_explicit (&rb->silence_mark, 0, memory_order_relaxed);
+
+  // 使用位掩码替代取模运算 - 关键优化！
+  for (uint32_t i = 0; i < sample_count; i++)
+    {
+      rb->buffer[current_write & ROUTER_BUFFER_MASK] = data[i];
+      current_write++;
+    }
+
+  atomic_store_explicit (&rb->write_pos, current_write, memory_order_release);
+
+  // 更新性能统计
+  ring_update_stats (rb, size + sample_count);
+  return true;
+}
+
+// 写入静音（生产者）：不拷贝采样，只推进写指针并维护静音标记
+bool
+router_ring_write_silence (RouterRingBuffer *rb, uint32_t frame_count,
+			   uint32_t channels)
+{
+  if (rb == NULL || rb->buffer == NULL)
+    {
+      return false;
+    }
+
+  uint32_t sample_count = frame_count * channels;
+  uint32_t current_write
+    = atomic_load_explicit (&rb->write_pos, memory_order_relaxed);
+  uint32_t current_read
+    = atomic_load_explicit (&rb->read_pos, memory_order_acquire);
+  uint32_t size = ring_used (current_write, current_read);
+  uint32_t free_space = rb->capacity - 1 - size;
+
+  if (free_space < sample_count)
+    {
+      return false;
+    }
+
+  // 存储中可能还留有旧数据：清零即将覆盖的槽位，保证读者跨越静音区
+  // 边界时按普通路径拷贝也能得到零；静音持续一整圈后就不再需要
+  if (rb->zero_fill < rb->capacity)
+    {
+      uint32_t start = current_write & ROUTER_BUFFER_MASK;
+      uint32_t first = rb->capacity - start;
+      if (first > sample_count)
+	first = sample_count;
+      memset (rb->buffer + start, 0, first * sizeof (float));
+      memset (rb->buffer, 0, (sample_count - first) * sizeof (float));
+      rb->zero_fill = rb->capacity - rb->zero_fill > sample_count
+			? rb->zero_fill + sample_count
+			: rb->capacity;
+    }
+
+  // 静音区起点：新静音区从当前写指针开始；持续过久时前移到
+  // 写指针 - capacity（缓冲区最多容纳 capacity 个采样，起点依然不晚于读指针），
+  // 避免读者计算的有符号距离溢出
+  uint64_t mark
+    = atomic_load_explicit (&rb->silence_mark, memory_order_relaxed);
+  uint32_t since = (uint32_t) (mark >> 32);
+  if (mark == 0)
+    since = current_write;
+  else if (current_write - since > 2 * rb->capacity)
+    since = current_write - rb->capacity;
+  atomic_store_explicit (&rb->silence_mark, ((uint64_t) since << 32) | 1,
+			 memory_order_relaxed);
+
+  current_write += sample_count;
+  atomic_store_explicit (&rb->write_pos, current_write, memory_order_release);
+
+  ring_update_stats (rb, size + sample_count);
+  return true;
+}
+
+// 读取（消费者），silent 返回本块是否整块静音（含欠载）
+static bool
+ring_read (RouterRingBuffer *rb, float *data, uint32_t frame_count,
+	   uint32_t channels, bool *silent)
+{
+  *silent = false;
+
+  // Check if buffer is valid and initialized
+  if (rb == NULL || rb->buffer == NULL || data == NULL)
+    {
+      return false;
+    }
+
+  uint32_t sample_count = frame_count * channels;
+  uint32_t current_read
+    = atomic_load_explicit (&rb->read_pos, memory_order_relaxed);
+  uint32_t current_write
+    = atomic_load_explicit (&rb->write_pos, memory_order_acquire);
+
+  // 计算可用数据量
+  uint32_t available = ring_used (current_write, current_read);
+
+  if (available < sample_count)
+    {
+      // 数据不足，输出静音
+      memset (data, 0, sample_count * sizeof (float));
+      *silent = true;
+
+      // 更新统计
+      ring_update_stats (rb, available);
+      return false;
+    }
+
+  // 读指针已进入静音区：起点之后全是静音，直接清零输出
+  // （写指针的 acquire 保证这里看到的标记不早于对应的写入）
+  uint64_t mark
+    = atomic_load_explicit (&rb->silence_mark, memory_order_relaxed);
+  if (mark != 0 && (int32_t) (current_read - (uint32_t) (mark >> 32)) >= 0)
+    {
+      memset (data, 0, sample_count * sizeof (float));
+      current_read += sample_count;
+      *silent = true;
+    }
+  else
+    {
+      // 使用位掩码替代取模运算 - 关键优化！
+      for (uint32_t i = 0; i < sample_count; i++)
+	{
+	  data[i] = rb->buffer[current_read & ROUTER_BUFFER_MASK];
+	  current_read++;
+	}
+    }
+
+  atomic_store_explicit (&rb->read_pos, current_read, memory_order_release);
+
+  // 更新性能统计
+  ring_update_stats (rb, available - sample_count);
+  return true;
+}
+
+// Read data (called by output callback - Consumer)
+bool
+router_ring_read (RouterRingBuffer *rb, float *data, uint32_t frame_count,
+		  uint32_t channels)
+{
+  bool silent;
+  return ring_read (rb, data, frame_count, channels, &silent);
+}
+
+uint32_t
+router_ring_buffered_samples (RouterRingBuffer *rb)
+{
+  if (rb == NULL || rb->buffer == NULL)
+    return 0;
+  return ring_used (atomic_load_explicit (&rb->write_pos, memory_order_acquire),
+		    atomic_load_explicit (&rb->read_pos, memory_order_acquire));
+}
+
+// ====== 静音检测 ======
+
+bool
+router_buffer_is_silent (const float *samples, uint32_t count)
+{
+  uint32_t i = 0;
+  while (i < count)
+    {
+      uint32_t end = count - i > 64 ? i + 64 : count;
+      int nonzero = 0;
+      for (; i < end; i++)
+	nonzero |= samples[i] != 0.0f;
+      if (nonzero)
+	return false;
+    }
+  return true;
+}
+
+// ====== 输出块处理 ======
+
+bool
+router_render_output (RouterRingBuffer *rb, float *dst, uint32_t frames,
+		      uint32_t channels, float gain, RouterDspHost *dsp,
+		      bool *silent)
+{
+  bool is_silent;
+  bool ok = ring_read (rb, dst, frames, channels, &is_silent);
+
+  // 【增益补偿】应用固定增益，防止AGC导致的音量突增
+  // 增益值由启动时传入的物理设备音量决定；静音块（含欠载）已清零，跳过
+  if (!is_silent && gain < 1.0f && gain > 0.0f)
+    {
+      for (uint32_t i = 0; i < frames * channels; i++)
+	{
+	  dst[i] *= gain;
+	}
+    }
+
+  // DSP 链：处理过的静音块可能带有尾音，不再视为静音
+  if (dsp != NULL && router_dsp_host_process (dsp, dst, frames, is_silent))
+    is_silent = false;
+
+  if (silent != NULL)
+    *silent = is_silent;
+  return ok;
+}
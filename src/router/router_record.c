@@ -0,0 +1,628 @@
+//
+// Router 录音
+//
+// 环中的读写计数单位是帧。写盘线程是唯一的消费者，也是文件描述符的唯一
+// 持有者；控制函数只登记请求并等待写盘线程处理完，文件 IO 不在持锁时进行
+//
+
+#include "router/router_record.h"
+#include "router/router_backend.h"
+#include "router/router_memory.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// CAF 文件头：文件头(8) + desc 块(12+32) + data 块头(12) + 编辑计数(4)
+#define RECORD_CAF_HEADER_SIZE 68
+#define RECORD_CAF_DATA_SIZE_OFFSET 56
+
+// WAV 数据长度是 32 位，RIFF 长度还要再加上文件头
+#define RECORD_WAV_MAX_DATA_BYTES                                              \
+  (UINT32_MAX - (ROUTER_WAV_FLOAT_HEADER_SIZE - 8))
+
+// 写盘线程的请求
+enum
+{
+  kRecordRequestNone = 0,
+  kRecordRequestStart,
+  kRecordRequestRotate,
+  kRecordRequestStop,
+  kRecordRequestFlush,
+};
+
+static void *recorder_thread (void *arg);
+
+// ====== 辅助 ======
+
+static uint64_t
+monotonic_ms (void)
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000 + (uint64_t) ts.tv_nsec / 1000000;
+}
+
+static void
+write_be32 (uint8_t *p, uint32_t v)
+{
+  p[0] = (uint8_t) (v >> 24);
+  p[1] = (uint8_t) (v >> 16);
+  p[2] = (uint8_t) (v >> 8);
+  p[3] = (uint8_t) v;
+}
+
+static void
+write_be64 (uint8_t *p, uint64_t v)
+{
+  write_be32 (p, (uint32_t) (v >> 32));
+  write_be32 (p + 4, (uint32_t) v);
+}
+
+// 写满 len 字节（处理被信号打断和短写）
+static int
+write_all (int fd, const void *data, size_t len)
+{
+  const uint8_t *p = data;
+  while (len > 0)
+    {
+      ssize_t n = write (fd, p, len);
+      if (n < 0 && errno == EINTR)
+	continue;
+      if (n <= 0)
+	return -1;
+      p += n;
+      len -= (size_t) n;
+    }
+  return 0;
+}
+
+static int
+pwrite_all (int fd, const void *data, size_t len, off_t offset)
+{
+  return pwrite (fd, data, len, offset) == (ssize_t) len ? 0 : -1;
+}
+
+// 生成 CAF 文件头；data_size 为 -1 表示数据块延伸到文件末尾
+static void
+caf_build_header (uint8_t *h, uint32_t sample_rate, uint32_t channels,
+		  int64_t data_size)
+{
+  memcpy (h, "caff", 4);
+  h[4] = 0; // mFileVersion = 1，mFileFlags = 0
+  h[5] = 1;
+  h[6] = 0;
+  h[7] = 0;
+
+  memcpy (h + 8, "desc", 4);
+  write_be64 (h + 12, 32);
+  double rate = sample_rate;
+  uint64_t rate_bits;
+  memcpy (&rate_bits, &rate, sizeof (rate_bits));
+  write_be64 (h + 20, rate_bits);
+  memcpy (h + 28, "lpcm", 4);
+  write_be32 (h + 32, 1u | 2u); // kCAFLinearPCMFormatFlagIsFloat | IsLittleEndian
+  write_be32 (h + 36, channels * (uint32_t) sizeof (float));
+  write_be32 (h + 40, 1);
+  write_be32 (h + 44, channels);
+  write_be32 (h + 48, 32);
+
+  memcpy (h + 52, "data", 4);
+  write_be64 (h + RECORD_CAF_DATA_SIZE_OFFSET, (uint64_t) data_size);
+  write_be32 (h + 64, 0); // mEditCount
+}
+
+// 在目录中创建 audioctl-年月日-时分秒.<扩展名>，重名时追加序号
+static int
+create_file (const char *dir, RouterRecordFormat format, char *path,
+	     size_t size)
+{
+  time_t now = time (NULL);
+  struct tm tm;
+  localtime_r (&now, &tm);
+  char stamp[32];
+  strftime (stamp, sizeof (stamp), "%Y%m%d-%H%M%S", &tm);
+  const char *ext = format == kRouterRecordCaf ? "caf" : "wav";
+
+  for (int n = 1; n < 1000; n++)
+    {
+      int len = n == 1 ? snprintf (path, size, "%s/audioctl-%s.%s", dir,
+				   stamp, ext)
+		       : snprintf (path, size, "%s/audioctl-%s-%d.%s", dir,
+				   stamp, n, ext);
+      if (len < 0 || (size_t) len >= size)
+	{
+	  errno = ENAMETOOLONG;
+	  return -1;
+	}
+      int fd = open (path, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+      if (fd >= 0 || errno != EEXIST)
+	return fd;
+    }
+  errno = EEXIST;
+  return -1;
+}
+
+// ====== 写盘线程：文件 ======
+
+static uint32_t
+block_align (const RouterRecorder *recorder)
+{
+  return recorder->channels * (uint32_t) sizeof (float);
+}
+
+static uint32_t
+header_size (RouterRecordFormat format)
+{
+  return format == kRouterRecordCaf ? RECORD_CAF_HEADER_SIZE
+				    : ROUTER_WAV_FLOAT_HEADER_SIZE;
+}
+
+// 预分配文件空间到 end 之后（尽力而为，不改变文件长度，失败时照常写入）
+static void
+reserve_space (RouterRecorder *recorder, uint64_t end)
+{
+  if (end <= recorder->reserved_bytes)
+    return;
+  uint64_t target = recorder->reserved_bytes;
+  while (target < end)
+    target += ROUTER_RECORD_PREALLOC_BYTES;
+#ifdef F_PREALLOCATE
+  fstore_t store = {F_ALLOCATECONTIG, F_PEOFPOSMODE, 0,
+		    (off_t) (target - recorder->reserved_bytes), 0};
+  if (fcntl (recorder->fd, F_PREALLOCATE, &store) == -1)
+    {
+      store.fst_flags = F_ALLOCATEALL;
+      fcntl (recorder->fd, F_PREALLOCATE, &store);
+    }
+#endif
+  recorder->reserved_bytes = target;
+}
+
+// 回填文件头。WAV 每次都写入当前长度；CAF 只在关闭时写入数据块长度
+static int
+write_header (RouterRecorder *recorder, bool final)
+{
+  const RouterRecordStatus *status = &recorder->status;
+  uint64_t data_bytes = status->frames * block_align (recorder);
+  if (status->format == kRouterRecordWav)
+    {
+      uint8_t header[ROUTER_WAV_FLOAT_HEADER_SIZE];
+      router_wav_build_float_header (header, recorder->sample_rate,
+				     recorder->channels, status->frames);
+      return pwrite_all (recorder->fd, header, sizeof (header), 0);
+    }
+  if (!final)
+    return 0;
+  uint8_t size[8];
+  write_be64 (size, data_bytes + 4);
+  return pwrite_all (recorder->fd, size, sizeof (size),
+		     RECORD_CAF_DATA_SIZE_OFFSET);
+}
+
+// 记录失败并停止录音（写盘线程）
+static void
+fail (RouterRecorder *recorder, int error)
+{
+  atomic_store (&recorder->enabled, false);
+  if (recorder->fd >= 0)
+    {
+      close (recorder->fd);
+      recorder->fd = -1;
+    }
+  pthread_mutex_lock (&recorder->mutex);
+  recorder->status.recording = false;
+  recorder->status.error = error;
+  pthread_mutex_unlock (&recorder->mutex);
+}
+
+// 回填最终长度并关闭当前文件
+static int
+close_file (RouterRecorder *recorder)
+{
+  if (recorder->fd < 0)
+    return 0;
+  int result = write_header (recorder, true);
+  int error = errno;
+  if (close (recorder->fd) != 0 && result == 0)
+    {
+      result = -1;
+      error = errno;
+    }
+  recorder->fd = -1;
+  pthread_mutex_lock (&recorder->mutex);
+  recorder->status.recording = false;
+  if (result != 0)
+    recorder->status.error = error;
+  pthread_mutex_unlock (&recorder->mutex);
+  return result;
+}
+
+// 在 dir 中创建新文件并写入文件头（当前文件须已关闭）
+static int
+open_file (RouterRecorder *recorder, const char *dir,
+	   RouterRecordFormat format, uint32_t sample_rate)
+{
+  char path[PATH_MAX];
+  int fd = create_file (dir, format, path, sizeof (path));
+  if (fd < 0)
+    {
+      fail (recorder, errno);
+      return -1;
+    }
+
+  uint8_t header[RECORD_CAF_HEADER_SIZE];
+  if (format == kRouterRecordCaf)
+    caf_build_header (header, sample_rate, recorder->channels, -1);
+  else
+    router_wav_build_float_header (header, sample_rate, recorder->channels,
+				   0);
+  if (write_all (fd, header, header_size (format)) != 0)
+    {
+      int error = errno;
+      close (fd);
+      unlink (path);
+      fail (recorder, error);
+      return -1;
+    }
+
+  recorder->fd = fd;
+  recorder->sample_rate = sample_rate;
+  recorder->reserved_bytes = 0;
+  recorder->header_ms = monotonic_ms ();
+  snprintf (recorder->dir, sizeof (recorder->dir), "%s", dir);
+  reserve_space (recorder, ROUTER_RECORD_PREALLOC_BYTES);
+
+  pthread_mutex_lock (&recorder->mutex);
+  recorder->status.recording = true;
+  recorder->status.format = format;
+  recorder->status.frames = 0;
+  recorder->status.files++;
+  recorder->status.error = 0;
+  snprintf (recorder->status.path, sizeof (recorder->status.path), "%s",
+	    path);
+  pthread_mutex_unlock (&recorder->mutex);
+  return 0;
+}
+
+// 把环中的采样写入当前文件：all 为 false 时只写满批，不足一批留到下次
+static int
+drain (RouterRecorder *recorder, bool all)
+{
+  for (;;)
+    {
+      uint64_t available = router_frame_ring_available (&recorder->ring);
+      if (available == 0 || (!all && available < ROUTER_RECORD_BATCH_FRAMES))
+	return 0;
+      if (recorder->fd < 0)
+	{
+	  // 停止后实时线程还可能写入最后一块，直接丢弃
+	  router_frame_ring_discard (&recorder->ring);
+	  return 0;
+	}
+
+      uint32_t count = available < ROUTER_RECORD_BATCH_FRAMES
+			 ? (uint32_t) available
+			 : ROUTER_RECORD_BATCH_FRAMES;
+      // WAV 到达 4 GB 上限时换文件继续
+      if (recorder->status.format == kRouterRecordWav)
+	{
+	  uint64_t room = RECORD_WAV_MAX_DATA_BYTES / block_align (recorder)
+			  - recorder->status.frames;
+	  if (room == 0)
+	    {
+	      if (close_file (recorder) != 0
+		  || open_file (recorder, recorder->dir, kRouterRecordWav,
+				 recorder->sample_rate)
+		       != 0)
+		return -1;
+	      continue;
+	    }
+	  if (count > room)
+	    count = (uint32_t) room;
+	}
+
+      router_frame_ring_read (&recorder->ring, recorder->batch, count);
+
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+      // 两种格式都按小端存放 float
+      for (uint32_t i = 0; i < count * recorder->channels; i++)
+	{
+	  uint32_t u;
+	  memcpy (&u, &recorder->batch[i], sizeof (u));
+	  u = __builtin_bswap32 (u);
+	  memcpy (&recorder->batch[i], &u, sizeof (u));
+	}
+#endif
+      size_t bytes = (size_t) count * block_align (recorder);
+      reserve_space (recorder,
+		     header_size (recorder->status.format)
+		       + (recorder->status.frames + count)
+			   * block_align (recorder));
+      if (write_all (recorder->fd, recorder->batch, bytes) != 0)
+	{
+	  fail (recorder, errno);
+	  return -1;
+	}
+
+      pthread_mutex_lock (&recorder->mutex);
+      recorder->status.frames += count;
+      recorder->status.total_frames += count;
+      pthread_mutex_unlock (&recorder->mutex);
+    }
+}
+
+// 写完剩余采样并回填文件头
+static int
+sync_file (RouterRecorder *recorder)
+{
+  if (recorder->fd < 0)
+    return 0;
+  if (drain (recorder, true) != 0)
+    return -1;
+  recorder->header_ms = monotonic_ms ();
+  if (write_header (recorder, false) != 0)
+    {
+      fail (recorder, errno);
+      return -1;
+    }
+  return 0;
+}
+
+// ====== 写盘线程 ======
+
+static int
+handle_request (RouterRecorder *recorder, uint32_t request, const char *dir,
+		RouterRecordFormat format, uint32_t sample_rate)
+{
+  switch (request)
+    {
+    case kRecordRequestStart:
+    case kRecordRequestRotate:
+      {
+	if (request == kRecordRequestRotate && recorder->fd < 0)
+	  return -1;
+	// 已在录音时写完当前文件再换，实时线程一直写入，接缝处不丢采样
+	bool continuing = recorder->fd >= 0;
+	if (continuing
+	    && (drain (recorder, true) != 0 || close_file (recorder) != 0))
+	  return -1;
+	if (!continuing)
+	  {
+	    // 丢弃上次停止时残留的采样后再开始写入
+	    router_frame_ring_discard (&recorder->ring);
+	  }
+	if (open_file (recorder, dir, format, sample_rate) != 0)
+	  return -1;
+	atomic_store (&recorder->enabled, true);
+	return 0;
+      }
+
+    case kRecordRequestStop:
+      atomic_store (&recorder->enabled, false);
+      if (drain (recorder, true) != 0)
+	return -1;
+      return close_file (recorder);
+
+    case kRecordRequestFlush:
+      return sync_file (recorder);
+
+    default:
+      return 0;
+    }
+}
+
+static void *
+recorder_thread (void *arg)
+{
+  RouterRecorder *recorder = arg;
+
+  pthread_mutex_lock (&recorder->mutex);
+  for (;;)
+    {
+      if (recorder->running && recorder->applied_seq == recorder->request_seq)
+	{
+	  struct timespec deadline;
+	  clock_gettime (CLOCK_REALTIME, &deadline);
+	  deadline.tv_nsec += ROUTER_RECORD_POLL_MS * 1000000L;
+	  if (deadline.tv_nsec >= 1000000000L)
+	    {
+	      deadline.tv_sec++;
+	      deadline.tv_nsec -= 1000000000L;
+	    }
+	  pthread_cond_timedwait (&recorder->cond, &recorder->mutex,
+				  &deadline);
+	}
+
+      bool quit = !recorder->running;
+      uint32_t seq = recorder->request_seq;
+      uint32_t request = recorder->applied_seq != seq ? recorder->request
+						      : kRecordRequestNone;
+      char dir[PATH_MAX];
+      snprintf (dir, sizeof (dir), "%s",
+		request == kRecordRequestRotate ? recorder->dir
+						: recorder->request_dir);
+      RouterRecordFormat format = request == kRecordRequestRotate
+				    ? recorder->status.format
+				    : recorder->request_format;
+      uint32_t sample_rate = request == kRecordRequestRotate
+			       ? recorder->sample_rate
+			       : recorder->request_rate;
+      pthread_mutex_unlock (&recorder->mutex);
+
+      int result = 0;
+      if (request != kRecordRequestNone)
+	result = handle_request (recorder, request, dir, format, sample_rate);
+      else if (recorder->fd >= 0)
+	{
+	  // 平时只写满批；到了回填周期把零头也写掉
+	  if (monotonic_ms () - recorder->header_ms
+	      >= ROUTER_RECORD_HEADER_INTERVAL_MS)
+	    sync_file (recorder);
+	  else
+	    drain (recorder, false);
+	}
+      if (quit)
+	handle_request (recorder, kRecordRequestStop, NULL, 0, 0);
+
+      pthread_mutex_lock (&recorder->mutex);
+      if (request != kRecordRequestNone)
+	{
+	  recorder->request_result = result;
+	  recorder->applied_seq = seq;
+	  pthread_cond_broadcast (&recorder->done);
+	}
+      if (quit)
+	break;
+    }
+  pthread_mutex_unlock (&recorder->mutex);
+  return NULL;
+}
+
+// 登记请求并等待写盘线程处理完（请求之间串行）
+static int
+submit (RouterRecorder *recorder, uint32_t request, const char *dir,
+	RouterRecordFormat format, uint32_t sample_rate)
+{
+  pthread_mutex_lock (&recorder->mutex);
+  while (recorder->applied_seq != recorder->request_seq)
+    pthread_cond_wait (&recorder->done, &recorder->mutex);
+  if (dir != NULL)
+    {
+      snprintf (recorder->request_dir, sizeof (recorder->request_dir), "%s",
+		dir);
+      recorder->request_format = format;
+      recorder->request_rate = sample_rate;
+    }
+  recorder->request = request;
+  uint32_t seq = ++recorder->request_seq;
+  pthread_cond_signal (&recorder->cond);
+  while (recorder->applied_seq != seq)
+    pthread_cond_wait (&recorder->done, &recorder->mutex);
+  int result = recorder->request_result;
+  pthread_mutex_unlock (&recorder->mutex);
+  return result;
+}
+
+// ====== API ======
+
+int
+router_recorder_init (RouterRecorder *recorder, uint32_t capacity_frames,
+		      uint32_t channels)
+{
+  memset (recorder, 0, sizeof (*recorder));
+  recorder->fd = -1;
+  if (channels == 0 || capacity_frames < ROUTER_RECORD_BATCH_FRAMES
+      || (capacity_frames & (capacity_frames - 1)) != 0)
+    return -1;
+
+  recorder->channels = channels;
+  // 环形缓冲区由实时线程写入，暂存区与它同一生命周期：都清零、预缺页并
+  // 锁定，录音过程中不会因缺页或换出阻塞回调
+  float *storage = router_locked_alloc ((size_t) capacity_frames * channels
+					* sizeof (float));
+  recorder->batch = router_locked_alloc ((size_t) ROUTER_RECORD_BATCH_FRAMES
+					 * channels * sizeof (float));
+  if (router_frame_ring_init (&recorder->ring, storage, capacity_frames,
+			      channels)
+	!= 0
+      || recorder->batch == NULL)
+    {
+      router_locked_free (storage);
+      router_locked_free (recorder->batch);
+      recorder->ring.storage = NULL;
+      recorder->batch = NULL;
+      return -1;
+    }
+
+  atomic_init (&recorder->enabled, false);
+  pthread_mutex_init (&recorder->mutex, NULL);
+  pthread_cond_init (&recorder->cond, NULL);
+  pthread_cond_init (&recorder->done, NULL);
+  recorder->running = true;
+  if (pthread_create (&recorder->thread, NULL, recorder_thread, recorder)
+      != 0)
+    {
+      pthread_cond_destroy (&recorder->done);
+      pthread_cond_destroy (&recorder->cond);
+      pthread_mutex_destroy (&recorder->mutex);
+      router_locked_free (recorder->ring.storage);
+      router_locked_free (recorder->batch);
+      recorder->ring.storage = NULL;
+      recorder->batch = NULL;
+      return -1;
+    }
+  return 0;
+}
+
+void
+router_recorder_destroy (RouterRecorder *recorder)
+{
+  if (recorder->ring.storage == NULL)
+    return;
+
+  pthread_mutex_lock (&recorder->mutex);
+  recorder->running = false;
+  pthread_cond_signal (&recorder->cond);
+  pthread_mutex_unlock (&recorder->mutex);
+  pthread_join (recorder->thread, NULL);
+
+  pthread_cond_destroy (&recorder->done);
+  pthread_cond_destroy (&recorder->cond);
+  pthread_mutex_destroy (&recorder->mutex);
+  router_locked_free (recorder->ring.storage);
+  router_locked_free (recorder->batch);
+  recorder->ring.storage = NULL;
+  recorder->batch = NULL;
+}
+
+int
+router_recorder_start (RouterRecorder *recorder, const char *dir,
+		       RouterRecordFormat format, uint32_t sample_rate)
+{
+  if (dir == NULL || dir[0] != '/' || strlen (dir) >= PATH_MAX
+      || (unsigned) format >= kRouterRecordFormatCount || sample_rate == 0)
+    return -1;
+  return submit (recorder, kRecordRequestStart, dir, format, sample_rate);
+}
+
+int
+router_recorder_rotate (RouterRecorder *recorder)
+{
+  return submit (recorder, kRecordRequestRotate, NULL, 0, 0);
+}
+
+void
+router_recorder_stop (RouterRecorder *recorder)
+{
+  submit (recorder, kRecordRequestStop, NULL, 0, 0);
+}
+
+void
+router_recorder_flush (RouterRecorder *recorder)
+{
+  submit (recorder, kRecordRequestFlush, NULL, 0, 0);
+}
+
+void
+router_recorder_push (RouterRecorder *recorder, const float *buffer,
+		      uint32_t frames)
+{
+  if (!atomic_load_explicit (&recorder->enabled, memory_order_acquire))
+    return;
+
+  router_frame_ring_push (&recorder->ring, buffer, frames);
+}
+
+void
+router_recorder_get_status (RouterRecorder *recorder,
+			    RouterRecordStatus *status)
+{
+  pthread_mutex_lock (&recorder->mutex);
+  *status = recorder->status;
+  pthread_mutex_unlock (&recorder->mutex);
+  status->dropped_blocks = atomic_load (&recorder->ring.dropped_blocks);
+  status->dropped_frames = atomic_load (&recorder->ring.dropped_frames);
+}
@@ -0,0 +1,894 @@
+//
+// Router 网络推流（RTP/UDP）
+//
+
+#if defined(__linux__)
+#define _GNU_SOURCE // sendmmsg / recvmmsg
+#endif
+
+#include "router/router_rtp.h"
+#include "router/router_memory.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+
+#define RTP_PACKET_BYTES (ROUTER_RTP_HEADER_SIZE + ROUTER_RTP_MAX_PAYLOAD)
+#define RTP_FRAME_BYTES (ROUTER_MAX_CHANNELS * 3)
+#define RTP_QUEUE_MASK (ROUTER_RTP_QUEUE_PACKETS - 1)
+#define RTP_JITTER_MASK (ROUTER_RTP_JITTER_FRAMES - 1)
+#define RTP_L24_SCALE 8388607.0f
+#define RTP_SOCKET_BUFFER (1 << 20)
+#define RTP_DSCP_EF 0xB8 // 加急转发，局域网交换机按低延迟队列处理
+
+// 漂移校正：缓冲深度先做约 1 秒的平滑，再用 PI 控制调整重采样比例
+// （误差单位为毫秒；闭环时间常数约 10 秒，几百 ppm 的校正听不出音高变化）
+#define RTP_FILL_TIME_CONSTANT_S 1.0
+#define RTP_DRIFT_KP 140.0 // ppm / ms
+#define RTP_DRIFT_KI 10.0  // ppm / (ms·s)
+
+_Static_assert ((ROUTER_RTP_QUEUE_PACKETS & RTP_QUEUE_MASK) == 0,
+		"packet queue size must be a power of two");
+_Static_assert ((ROUTER_RTP_JITTER_FRAMES & RTP_JITTER_MASK) == 0,
+		"jitter buffer size must be a power of two");
+_Static_assert (ROUTER_RTP_QUEUE_PACKETS >= ROUTER_RTP_BATCH,
+		"packet queue must hold one batch");
+_Static_assert ((uint64_t) ROUTER_RTP_MAX_LATENCY_MS * 96000 / 1000
+		    + ROUTER_RTP_MAX_PACKET_FRAMES * 2
+		  < ROUTER_RTP_JITTER_FRAMES / 2,
+		"jitter buffer must hold the largest target latency");
+
+// 动态负载类型与采样率的对应关系（下标 + ROUTER_RTP_BASE_PAYLOAD_TYPE）
+static const uint32_t kPayloadRates[] = {48000, 44100, 96000, 88200, 32000};
+#define RTP_PAYLOAD_TYPE_COUNT                                                 \
+  (sizeof (kPayloadRates) / sizeof (kPayloadRates[0]))
+
+// 批量收发用的消息头（非 Linux 平台没有 mmsghdr，用同样布局的结构逐包收发）
+#if defined(__linux__)
+typedef struct mmsghdr RtpMessage;
+#else
+typedef struct
+{
+  struct msghdr msg_hdr;
+  unsigned int msg_len;
+} RtpMessage;
+#endif
+
+struct RouterRtpPool
+{
+  uint32_t count;
+  uint8_t *packets; // count 个，每个 RTP_PACKET_BYTES 字节
+  struct iovec *iov;
+  RtpMessage *msgs;
+};
+
+// ====== 辅助 ======
+
+static RouterRtpPool *
+pool_create (uint32_t count)
+{
+  RouterRtpPool *pool = calloc (1, sizeof (*pool));
+  if (pool == NULL)
+    return NULL;
+  pool->count = count;
+  pool->packets = calloc (count, RTP_PACKET_BYTES);
+  pool->iov = calloc (count, sizeof (struct iovec));
+  pool->msgs = calloc (count, sizeof (RtpMessage));
+  if (pool->packets == NULL || pool->iov == NULL || pool->msgs == NULL)
+    {
+      free (pool->packets);
+      free (pool->iov);
+      free (pool->msgs);
+      free (pool);
+      return NULL;
+    }
+  for (uint32_t i = 0; i < count; i++)
+    {
+      pool->iov[i].iov_base = pool->packets + (size_t) i * RTP_PACKET_BYTES;
+      pool->iov[i].iov_len = RTP_PACKET_BYTES;
+      pool->msgs[i].msg_hdr.msg_iov = &pool->iov[i];
+      pool->msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+  return pool;
+}
+
+static void
+pool_destroy (RouterRtpPool *pool)
+{
+  if (pool == NULL)
+    return;
+  free (pool->packets);
+  free (pool->iov);
+  free (pool->msgs);
+  free (pool);
+}
+
+static uint8_t *
+pool_packet (RouterRtpPool *pool, uint32_t index)
+{
+  return pool->packets + (size_t) index * RTP_PACKET_BYTES;
+}
+
+static int
+set_nonblocking (int fd)
+{
+  int flags = fcntl (fd, F_GETFL, 0);
+  if (flags < 0 || fcntl (fd, F_SETFL, flags | O_NONBLOCK) < 0)
+    return -1;
+  return fcntl (fd, F_SETFD, FD_CLOEXEC);
+}
+
+// 非密码学用途的随机数（SSRC、起始序号和时间戳）
+static uint32_t
+random_u32 (const void *salt)
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_REALTIME, &ts);
+  uint64_t x = (uint64_t) ts.tv_sec * 1000000000ull + (uint64_t) ts.tv_nsec;
+  x ^= (uint64_t) getpid () << 32 ^ (uint64_t) (uintptr_t) salt;
+  // splitmix64
+  x += 0x9E3779B97F4A7C15ull;
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+  return (uint32_t) (x ^ (x >> 31));
+}
+
+static void
+write_be16 (uint8_t *p, uint16_t v)
+{
+  p[0] = (uint8_t) (v >> 8);
+  p[1] = (uint8_t) v;
+}
+
+static void
+write_be32 (uint8_t *p, uint32_t v)
+{
+  p[0] = (uint8_t) (v >> 24);
+  p[1] = (uint8_t) (v >> 16);
+  p[2] = (uint8_t) (v >> 8);
+  p[3] = (uint8_t) v;
+}
+
+static uint16_t
+read_be16 (const uint8_t *p)
+{
+  return (uint16_t) (p[0] << 8 | p[1]);
+}
+
+static uint32_t
+read_be32 (const uint8_t *p)
+{
+  return (uint32_t) p[0] << 24 | (uint32_t) p[1] << 16 | (uint32_t) p[2] << 8
+	 | p[3];
+}
+
+// float 转 24 位大端整数（超出 [-1, 1] 的值削波，NaN 记为 0）
+static inline void
+encode_l24 (uint8_t *p, float x)
+{
+  if (!(x >= -1.0f && x <= 1.0f))
+    x = x > 1.0f ? 1.0f : x < -1.0f ? -1.0f : 0.0f;
+  int32_t v = (int32_t) lrintf (x * RTP_L24_SCALE);
+  p[0] = (uint8_t) (v >> 16);
+  p[1] = (uint8_t) (v >> 8);
+  p[2] = (uint8_t) v;
+}
+
+static inline float
+decode_l24 (const uint8_t *p)
+{
+  int32_t v = (int32_t) ((uint32_t) p[0] << 24 | (uint32_t) p[1] << 16
+			 | (uint32_t) p[2] << 8)
+	      >> 8;
+  return (float) v / RTP_L24_SCALE;
+}
+
+// 批量发送，返回发出的包数（内核缓冲区满或出错时其余的包丢弃）
+static uint32_t
+send_batch (int fd, RtpMessage *msgs, uint32_t count)
+{
+  uint32_t sent = 0;
+#if defined(__linux__)
+  while (sent < count)
+    {
+      int n = sendmmsg (fd, msgs + sent, count - sent, MSG_DONTWAIT);
+      if (n < 0 && errno == EINTR)
+	continue;
+      if (n <= 0)
+	break;
+      sent += (uint32_t) n;
+    }
+#else
+  while (sent < count)
+    {
+      if (sendmsg (fd, &msgs[sent].msg_hdr, MSG_DONTWAIT) < 0)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  break;
+	}
+      sent++;
+    }
+#endif
+  return sent;
+}
+
+// 批量接收，返回收到的包数；没有数据返回 0，套接字出错返回 -1
+static int
+recv_batch (int fd, RtpMessage *msgs, uint32_t count)
+{
+#if defined(__linux__)
+  int n;
+  do
+    n = recvmmsg (fd, msgs, count, MSG_DONTWAIT, NULL);
+  while (n < 0 && errno == EINTR);
+  if (n < 0)
+    return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+  return n;
+#else
+  uint32_t n = 0;
+  while (n < count)
+    {
+      ssize_t len = recvmsg (fd, &msgs[n].msg_hdr, MSG_DONTWAIT);
+      if (len < 0)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  if (n == 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+	    return -1;
+	  break;
+	}
+      msgs[n].msg_len = (unsigned int) len;
+      n++;
+    }
+  return (int) n;
+#endif
+}
+
+// ====== 负载类型 ======
+
+int
+router_rtp_payload_type (uint32_t sample_rate)
+{
+  for (uint32_t i = 0; i < RTP_PAYLOAD_TYPE_COUNT; i++)
+    if (kPayloadRates[i] == sample_rate)
+      return ROUTER_RTP_BASE_PAYLOAD_TYPE + (int) i;
+  return -1;
+}
+
+uint32_t
+router_rtp_payload_rate (uint8_t payload_type)
+{
+  if (payload_type < ROUTER_RTP_BASE_PAYLOAD_TYPE
+      || payload_type >= ROUTER_RTP_BASE_PAYLOAD_TYPE + RTP_PAYLOAD_TYPE_COUNT)
+    return 0;
+  return kPayloadRates[payload_type - ROUTER_RTP_BASE_PAYLOAD_TYPE];
+}
+
+// ====== 发送端 ======
+
+int
+router_rtp_sender_init (RouterRtpSender *sender, uint32_t channels)
+{
+  memset (sender, 0, sizeof (*sender));
+  sender->fd = -1;
+  if (channels == 0 || channels > ROUTER_MAX_CHANNELS)
+    return -1;
+  sender->channels = channels;
+  atomic_init (&sender->enabled, false);
+  atomic_init (&sender->packets, 0);
+  atomic_init (&sender->bytes, 0);
+  atomic_init (&sender->send_errors, 0);
+  float *storage = router_locked_alloc ((size_t) ROUTER_RTP_SEND_RING_FRAMES
+					* channels * sizeof (float));
+  sender->pool = pool_create (ROUTER_RTP_BATCH);
+  if (router_frame_ring_init (&sender->ring, storage,
+			      ROUTER_RTP_SEND_RING_FRAMES, channels)
+	!= 0
+      || sender->pool == NULL)
+    {
+      router_locked_free (storage);
+      pool_destroy (sender->pool);
+      sender->ring.storage = NULL;
+      sender->pool = NULL;
+      return -1;
+    }
+  return 0;
+}
+
+void
+router_rtp_sender_destroy (RouterRtpSender *sender)
+{
+  router_rtp_sender_close (sender);
+  pool_destroy (sender->pool);
+  router_locked_free (sender->ring.storage);
+  sender->pool = NULL;
+  sender->ring.storage = NULL;
+}
+
+int
+router_rtp_sender_open (RouterRtpSender *sender, const char *host,
+			uint16_t port, uint32_t sample_rate, uint32_t ptime_ms)
+{
+  router_rtp_sender_close (sender);
+  int payload_type = router_rtp_payload_type (sample_rate);
+  if (sender->pool == NULL || host == NULL || port == 0 || payload_type < 0
+      || ptime_ms < ROUTER_RTP_MIN_PTIME_MS
+      || ptime_ms > ROUTER_RTP_MAX_PTIME_MS)
+    return -1;
+
+  struct addrinfo hints;
+  memset (&hints, 0, sizeof (hints));
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_DGRAM;
+  char service[8];
+  snprintf (service, sizeof (service), "%u", port);
+  struct addrinfo *result = NULL;
+  if (getaddrinfo (host, service, &hints, &result) != 0 || result == NULL)
+    return -1;
+
+  int fd = socket (AF_INET, SOCK_DGRAM, 0);
+  if (fd < 0)
+    {
+      freeaddrinfo (result);
+      return -1;
+    }
+  // 已连接的 UDP 套接字发送时不必再带地址；TOS 和缓冲区大小尽力而为
+  int connected = connect (fd, result->ai_addr, result->ai_addrlen);
+  freeaddrinfo (result);
+  int tos = RTP_DSCP_EF;
+  int buffer = RTP_SOCKET_BUFFER;
+  setsockopt (fd, IPPROTO_IP, IP_TOS, &tos, sizeof (tos));
+  setsockopt (fd, SOL_SOCKET, SO_SNDBUF, &buffer, sizeof (buffer));
+  if (connected != 0 || set_nonblocking (fd) != 0)
+    {
+      close (fd);
+      return -1;
+    }
+
+  sender->fd = fd;
+  sender->sample_rate = sample_rate;
+  sender->packet_frames = sample_rate * ptime_ms / 1000;
+  sender->payload_type = (uint8_t) payload_type;
+  sender->marker = true;
+  sender->ssrc = random_u32 (sender);
+  sender->sequence = (uint16_t) random_u32 (&sender->sequence);
+  sender->timestamp = random_u32 (&sender->timestamp);
+  sender->fill = 0;
+  sender->dropped_seen = atomic_load (&sender->ring.dropped_frames);
+
+  // 丢弃上次关闭时残留的采样后再开始写入
+  router_frame_ring_discard (&sender->ring);
+  atomic_store (&sender->enabled, true);
+  return 0;
+}
+
+void
+router_rtp_sender_close (RouterRtpSender *sender)
+{
+  atomic_store (&sender->enabled, false);
+  if (sender->fd >= 0)
+    {
+      close (sender->fd);
+      sender->fd = -1;
+    }
+}
+
+void
+router_rtp_sender_push (RouterRtpSender *sender, const float *buffer,
+			uint32_t frames)
+{
+  if (!atomic_load_explicit (&sender->enabled, memory_order_acquire))
+    return;
+
+  router_frame_ring_push (&sender->ring, buffer, frames);
+}
+
+// 填写第 index 个包的 RTP 头并把它加入本批
+static void
+sender_finish_packet (RouterRtpSender *sender, uint32_t index)
+{
+  uint8_t *packet = pool_packet (sender->pool, index);
+  packet[0] = 0x80; // V=2，无填充、扩展和 CSRC
+  packet[1] = (uint8_t) ((sender->marker ? 0x80 : 0) | sender->payload_type);
+  write_be16 (packet + 2, sender->sequence);
+  write_be32 (packet + 4, sender->timestamp);
+  write_be32 (packet + 8, sender->ssrc);
+  sender->pool->iov[index].iov_len
+    = ROUTER_RTP_HEADER_SIZE + (size_t) sender->packet_frames * RTP_FRAME_BYTES;
+  sender->marker = false;
+  sender->sequence++;
+  sender->timestamp += sender->packet_frames;
+}
+
+uint32_t
+router_rtp_sender_pump (RouterRtpSender *sender)
+{
+  if (sender->fd < 0)
+    return 0;
+
+  // 实时线程丢过块：未凑满的包作废，时间戳跳过丢弃的采样，接收端补静音
+  uint64_t dropped = atomic_load_explicit (&sender->ring.dropped_frames,
+					   memory_order_acquire);
+  if (dropped != sender->dropped_seen)
+    {
+      sender->timestamp
+	+= sender->fill + (uint32_t) (dropped - sender->dropped_seen);
+      sender->dropped_seen = dropped;
+      sender->fill = 0;
+      sender->marker = true;
+    }
+
+  const uint32_t channels = sender->channels;
+  float frames[ROUTER_RTP_MAX_PACKET_FRAMES * ROUTER_MAX_CHANNELS];
+  uint32_t total = 0;
+  uint32_t batch;
+  do
+    {
+      uint64_t available = router_frame_ring_available (&sender->ring);
+
+      // 未凑满的包总在第 0 个位置
+      batch = 0;
+      while (available > 0 && batch < ROUTER_RTP_BATCH)
+	{
+	  uint8_t *payload = pool_packet (sender->pool, batch)
+			     + ROUTER_RTP_HEADER_SIZE
+			     + (size_t) sender->fill * RTP_FRAME_BYTES;
+	  uint32_t take = sender->packet_frames - sender->fill;
+	  if (take > available)
+	    take = (uint32_t) available;
+	  router_frame_ring_read (&sender->ring, frames, take);
+	  for (uint32_t f = 0; f < take; f++)
+	    {
+	      const float *frame = frames + (size_t) f * channels;
+	      for (uint32_t c = 0; c < ROUTER_MAX_CHANNELS; c++)
+		encode_l24 (payload + c * 3, frame[c < channels ? c : 0]);
+	      payload += RTP_FRAME_BYTES;
+	    }
+	  sender->fill += take;
+	  available -= take;
+	  if (sender->fill == sender->packet_frames)
+	    {
+	      sender_finish_packet (sender, batch);
+	      sender->fill = 0;
+	      batch++;
+	    }
+	}
+      if (batch == 0)
+	break;
+
+      uint32_t sent = send_batch (sender->fd, sender->pool->msgs, batch);
+      atomic_fetch_add_explicit (&sender->packets, sent, memory_order_relaxed);
+      atomic_fetch_add_explicit (&sender->bytes,
+				 (uint64_t) sent
+				   * sender->pool->iov[0].iov_len,
+				 memory_order_relaxed);
+      if (sent < batch)
+	atomic_fetch_add_explicit (&sender->send_errors, batch - sent,
+				   memory_order_relaxed);
+      total += sent;
+
+      // 把未凑满的包移回第 0 个位置
+      if (sender->fill > 0 && batch < ROUTER_RTP_BATCH)
+	memmove (pool_packet (sender->pool, 0) + ROUTER_RTP_HEADER_SIZE,
+		 pool_packet (sender->pool, batch) + ROUTER_RTP_HEADER_SIZE,
+		 (size_t) sender->fill * RTP_FRAME_BYTES);
+    }
+  while (batch == ROUTER_RTP_BATCH);
+  return total;
+}
+
+void
+router_rtp_sender_get_stats (RouterRtpSender *sender,
+			     RouterRtpSenderStats *stats)
+{
+  stats->packets = atomic_load (&sender->packets);
+  stats->bytes = atomic_load (&sender->bytes);
+  stats->send_errors = atomic_load (&sender->send_errors);
+  stats->dropped_blocks = atomic_load (&sender->ring.dropped_blocks);
+}
+
+// ====== 接收端 ======
+
+int
+router_rtp_receiver_init (RouterRtpReceiver *receiver, uint16_t port,
+			  uint32_t output_rate, uint32_t channels,
+			  uint32_t latency_ms)
+{
+  memset (receiver, 0, sizeof (*receiver));
+  receiver->fd = -1;
+  if (output_rate == 0 || channels == 0 || channels > ROUTER_MAX_CHANNELS
+      || latency_ms < 1 || latency_ms > ROUTER_RTP_MAX_LATENCY_MS)
+    return -1;
+
+  receiver->channels = channels;
+  receiver->output_rate = output_rate;
+  receiver->latency_ms = latency_ms;
+  atomic_init (&receiver->queue_write, 0);
+  atomic_init (&receiver->queue_read, 0);
+  atomic_init (&receiver->stat_packets, 0);
+  atomic_init (&receiver->stat_lost, 0);
+  atomic_init (&receiver->stat_late, 0);
+  atomic_init (&receiver->stat_invalid, 0);
+  atomic_init (&receiver->stat_resets, 0);
+  atomic_init (&receiver->stat_underruns, 0);
+  atomic_init (&receiver->stat_rate, 0);
+  atomic_init (&receiver->stat_playing, false);
+  atomic_init (&receiver->stat_fill_ms, 0.0f);
+  atomic_init (&receiver->stat_drift_ppm, 0.0f);
+
+  receiver->pool = pool_create (ROUTER_RTP_QUEUE_PACKETS);
+  receiver->jitter
+    = calloc ((size_t) ROUTER_RTP_JITTER_FRAMES * channels, sizeof (float));
+  if (receiver->pool == NULL || receiver->jitter == NULL)
+    {
+      router_rtp_receiver_destroy (receiver);
+      return -1;
+    }
+
+  struct sockaddr_in addr;
+  memset (&addr, 0, sizeof (addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl (INADDR_ANY);
+  addr.sin_port = htons (port);
+  socklen_t addr_len = sizeof (addr);
+  receiver->fd = socket (AF_INET, SOCK_DGRAM, 0);
+  int buffer = RTP_SOCKET_BUFFER;
+  if (receiver->fd < 0
+      || bind (receiver->fd, (struct sockaddr *) &addr, sizeof (addr)) != 0
+      || getsockname (receiver->fd, (struct sockaddr *) &addr, &addr_len) != 0
+      || set_nonblocking (receiver->fd) != 0)
+    {
+      router_rtp_receiver_destroy (receiver);
+      return -1;
+    }
+  setsockopt (receiver->fd, SOL_SOCKET, SO_RCVBUF, &buffer, sizeof (buffer));
+  receiver->port = ntohs (addr.sin_port);
+  return 0;
+}
+
+void
+router_rtp_receiver_destroy (RouterRtpReceiver *receiver)
+{
+  if (receiver->fd >= 0)
+    close (receiver->fd);
+  receiver->fd = -1;
+  pool_destroy (receiver->pool);
+  free (receiver->jitter);
+  receiver->pool = NULL;
+  receiver->jitter = NULL;
+}
+
+int
+router_rtp_receiver_poll (RouterRtpReceiver *receiver, int timeout_ms)
+{
+  struct pollfd pfd = {receiver->fd, POLLIN, 0};
+  int ready = poll (&pfd, 1, timeout_ms);
+  if (ready < 0)
+    return errno == EINTR ? 0 : -1;
+  if (ready == 0)
+    return 0;
+
+  // 直接收进队列中的空闲位置，队列满时留在内核缓冲区
+  uint32_t write
+    = atomic_load_explicit (&receiver->queue_write, memory_order_relaxed);
+  int total = 0;
+  for (;;)
+    {
+      uint32_t read
+	= atomic_load_explicit (&receiver->queue_read, memory_order_acquire);
+      uint32_t free_slots = ROUTER_RTP_QUEUE_PACKETS - (write - read);
+      uint32_t start = write & RTP_QUEUE_MASK;
+      uint32_t count = ROUTER_RTP_QUEUE_PACKETS - start;
+      if (count > free_slots)
+	count = free_slots;
+      if (count > ROUTER_RTP_BATCH)
+	count = ROUTER_RTP_BATCH;
+      if (count == 0)
+	break;
+      int n = recv_batch (receiver->fd, receiver->pool->msgs + start, count);
+      if (n < 0)
+	return total > 0 ? total : -1;
+      write += (uint32_t) n;
+      atomic_store_explicit (&receiver->queue_write, write,
+			     memory_order_release);
+      total += n;
+      if ((uint32_t) n < count)
+	break;
+    }
+  return total;
+}
+
+// 以第一个包锁定发送端，从空缓冲开始重新缓冲
+static void
+receiver_lock (RouterRtpReceiver *receiver, uint32_t ssrc,
+	       uint8_t payload_type, uint32_t stream_rate, uint16_t sequence,
+	       uint32_t timestamp)
+{
+  receiver->locked = true;
+  receiver->playing = false;
+  receiver->ssrc = ssrc;
+  receiver->payload_type = payload_type;
+  receiver->stream_rate = stream_rate;
+  uint32_t target = (uint32_t) ((uint64_t) receiver->latency_ms * stream_rate
+				/ 1000);
+  receiver->target_frames = target > 0 ? target : 1;
+  receiver->next_sequence = sequence;
+  receiver->ref_timestamp = timestamp;
+  receiver->ref_position = 0;
+  receiver->write_head = 0;
+  receiver->start_position = 0;
+  receiver->read_position = 0.0;
+  receiver->fill_average = receiver->target_frames;
+  receiver->drift_integral = 0.0;
+  atomic_store_explicit (&receiver->stat_rate, stream_rate,
+			 memory_order_relaxed);
+}
+
+// 把一个包写入抖动缓冲（音频线程）
+static void
+receiver_process_packet (RouterRtpReceiver *receiver, const uint8_t *data,
+			 uint32_t length)
+{
+  // RTP 头：版本 2；跳过 CSRC 列表、头扩展和填充
+  uint32_t header = ROUTER_RTP_HEADER_SIZE;
+  if (length >= header)
+    header += (data[0] & 0x0F) * 4u;
+  if (length >= header + 4 && (data[0] & 0x10) != 0)
+    header += 4 + read_be16 (data + header + 2) * 4u;
+  if (length > header && (data[0] & 0x20) != 0)
+    length = data[length - 1] <= length - header ? length - data[length - 1]
+						 : 0;
+  uint8_t payload_type = data[1] & 0x7F;
+  uint32_t stream_rate = length >= ROUTER_RTP_HEADER_SIZE
+			   ? router_rtp_payload_rate (payload_type)
+			   : 0;
+  if (length <= header || (data[0] & 0xC0) != 0x80 || stream_rate == 0
+      || (length - header) % RTP_FRAME_BYTES != 0
+      || (length - header) / RTP_FRAME_BYTES > ROUTER_RTP_MAX_PACKET_FRAMES)
+    {
+      atomic_fetch_add_explicit (&receiver->stat_invalid, 1,
+				 memory_order_relaxed);
+      return;
+    }
+
+  const uint8_t *payload = data + header;
+  uint32_t frames = (length - header) / RTP_FRAME_BYTES;
+  uint16_t sequence = read_be16 (data + 2);
+  uint32_t timestamp = read_be32 (data + 4);
+  uint32_t ssrc = read_be32 (data + 8);
+
+  // 新的发送端（或发送端换了采样率）：重新锁定
+  if (!receiver->locked || ssrc != receiver->ssrc
+      || payload_type != receiver->payload_type)
+    {
+      if (receiver->locked)
+	atomic_fetch_add_explicit (&receiver->stat_resets, 1,
+				   memory_order_relaxed);
+      receiver_lock (receiver, ssrc, payload_type, stream_rate, sequence,
+		     timestamp);
+    }
+
+  // 时间戳按相对最新包的差值展开成 64 位位置
+  int64_t position
+    = receiver->ref_position + (int32_t) (timestamp - receiver->ref_timestamp);
+  int64_t floor_read = (int64_t) floor (receiver->read_position);
+  if (position + frames - floor_read > ROUTER_RTP_JITTER_FRAMES / 2
+      || floor_read - position > ROUTER_RTP_JITTER_FRAMES / 2)
+    {
+      // 长时间中断或时间戳跳变，缓冲放不下：从这个包重新开始
+      atomic_fetch_add_explicit (&receiver->stat_resets, 1,
+				 memory_order_relaxed);
+      receiver_lock (receiver, ssrc, payload_type, stream_rate, sequence,
+		     timestamp);
+      position = 0;
+      floor_read = 0;
+    }
+
+  // 序号：前进时把跳过的记为丢失，迟到的包到达时再扣回
+  int16_t gap = (int16_t) (sequence - receiver->next_sequence);
+  if (gap >= 0)
+    {
+      if (gap > 0)
+	atomic_fetch_add_explicit (&receiver->stat_lost, (uint32_t) gap,
+				   memory_order_relaxed);
+      receiver->next_sequence = (uint16_t) (sequence + 1);
+    }
+  else if (atomic_load_explicit (&receiver->stat_lost, memory_order_relaxed)
+	   > 0)
+    atomic_fetch_sub_explicit (&receiver->stat_lost, 1, memory_order_relaxed);
+
+  // 已经播放过（插值还要用到播放位置之后的两帧）
+  if (position < receiver->start_position
+      || (receiver->playing && position < floor_read + 3))
+    {
+      atomic_fetch_add_explicit (&receiver->stat_late, 1, memory_order_relaxed);
+      return;
+    }
+
+  // 缺口先补静音，之后到达的包会覆盖
+  const uint32_t channels = receiver->channels;
+  for (int64_t p = receiver->write_head; p < position; p++)
+    memset (receiver->jitter + (size_t) (p & RTP_JITTER_MASK) * channels, 0,
+	    channels * sizeof (float));
+
+  for (uint32_t f = 0; f < frames; f++)
+    {
+      float *dst = receiver->jitter
+		   + (size_t) ((position + f) & RTP_JITTER_MASK) * channels;
+      const uint8_t *src = payload + (size_t) f * RTP_FRAME_BYTES;
+      if (channels == ROUTER_MAX_CHANNELS)
+	for (uint32_t c = 0; c < channels; c++)
+	  dst[c] = decode_l24 (src + c * 3);
+      else
+	{
+	  float sum = 0.0f;
+	  for (uint32_t c = 0; c < ROUTER_MAX_CHANNELS; c++)
+	    sum += decode_l24 (src + c * 3);
+	  dst[0] = sum / ROUTER_MAX_CHANNELS;
+	}
+    }
+  if (position + frames > receiver->write_head)
+    receiver->write_head = position + frames;
+  if (position >= receiver->ref_position)
+    {
+      receiver->ref_position = position;
+      receiver->ref_timestamp = timestamp;
+    }
+  atomic_fetch_add_explicit (&receiver->stat_packets, 1, memory_order_relaxed);
+}
+
+static void
+receiver_publish_stats (RouterRtpReceiver *receiver)
+{
+  double fill = receiver->playing
+		  ? receiver->write_head - receiver->read_position
+		  : (double) (receiver->write_head - receiver->start_position);
+  float fill_ms = receiver->locked ? (float) (fill * 1000.0
+					      / receiver->stream_rate)
+				   : 0.0f;
+  atomic_store_explicit (&receiver->stat_fill_ms, fill_ms,
+			 memory_order_relaxed);
+  atomic_store_explicit (&receiver->stat_playing, receiver->playing,
+			 memory_order_relaxed);
+}
+
+// 从播放位置 position 附近的四个点做三次 Hermite 插值
+static inline float
+hermite (float y0, float y1, float y2, float y3, float t)
+{
+  float c1 = 0.5f * (y2 - y0);
+  float c2 = y0 - 2.5f * y1 + 2.0f * y2 - 0.5f * y3;
+  float c3 = 0.5f * (y3 - y0) + 1.5f * (y1 - y2);
+  return ((c3 * t + c2) * t + c1) * t + y1;
+}
+
+void
+router_rtp_receiver_read (RouterRtpReceiver *receiver, float *dst,
+			  uint32_t frames)
+{
+  const uint32_t channels = receiver->channels;
+
+  // 取出网络线程收到的包
+  uint32_t read
+    = atomic_load_explicit (&receiver->queue_read, memory_order_relaxed);
+  uint32_t write
+    = atomic_load_explicit (&receiver->queue_write, memory_order_acquire);
+  for (; read != write; read++)
+    {
+      uint32_t slot = read & RTP_QUEUE_MASK;
+      receiver_process_packet (receiver, pool_packet (receiver->pool, slot),
+			       receiver->pool->msgs[slot].msg_len);
+    }
+  atomic_store_explicit (&receiver->queue_read, read, memory_order_release);
+
+  // 缓冲达到目标深度才开始播放
+  if (receiver->locked && !receiver->playing
+      && receiver->write_head - receiver->start_position
+	   >= receiver->target_frames)
+    {
+      receiver->playing = true;
+      receiver->read_position
+	= (double) (receiver->write_head - receiver->target_frames);
+      receiver->fill_average = receiver->target_frames;
+    }
+  if (!receiver->playing)
+    {
+      memset (dst, 0, (size_t) frames * channels * sizeof (float));
+      receiver_publish_stats (receiver);
+      return;
+    }
+
+  // 漂移校正：缓冲比目标深说明发送端偏快，读得快一点
+  const double stream_rate = receiver->stream_rate;
+  const double target = receiver->target_frames;
+  double fill = receiver->write_head - receiver->read_position;
+  double alpha = frames / (receiver->output_rate * RTP_FILL_TIME_CONSTANT_S);
+  receiver->fill_average += (fill - receiver->fill_average)
+			    * (alpha < 1.0 ? alpha : 1.0);
+  double error_ms = (receiver->fill_average - target) * 1000.0 / stream_rate;
+  receiver->drift_integral
+    += RTP_DRIFT_KI * error_ms * frames / receiver->output_rate;
+  if (receiver->drift_integral > ROUTER_RTP_MAX_DRIFT_PPM)
+    receiver->drift_integral = ROUTER_RTP_MAX_DRIFT_PPM;
+  if (receiver->drift_integral < -ROUTER_RTP_MAX_DRIFT_PPM)
+    receiver->drift_integral = -ROUTER_RTP_MAX_DRIFT_PPM;
+  double ppm = RTP_DRIFT_KP * error_ms + receiver->drift_integral;
+  if (ppm > ROUTER_RTP_MAX_DRIFT_PPM)
+    ppm = ROUTER_RTP_MAX_DRIFT_PPM;
+  if (ppm < -ROUTER_RTP_MAX_DRIFT_PPM)
+    ppm = -ROUTER_RTP_MAX_DRIFT_PPM;
+  double step = stream_rate / receiver->output_rate * (1.0 + ppm * 1e-6);
+  atomic_store_explicit (&receiver->stat_drift_ppm, (float) ppm,
+			 memory_order_relaxed);
+
+  // 缓冲过深（发送端突发或接收端停顿过）：跳回目标深度
+  if (fill > 2.0 * target + ROUTER_RTP_MAX_PACKET_FRAMES)
+    {
+      atomic_fetch_add_explicit (&receiver->stat_resets, 1,
+				 memory_order_relaxed);
+      receiver->read_position = (double) (receiver->write_head - target);
+      receiver->fill_average = target;
+    }
+
+  // 缓冲耗尽：输出静音并重新缓冲
+  if (receiver->read_position + step * frames + 2.0
+      >= (double) receiver->write_head)
+    {
+      atomic_fetch_add_explicit (&receiver->stat_underruns, 1,
+				 memory_order_relaxed);
+      receiver->playing = false;
+      receiver->start_position = receiver->write_head;
+      receiver->read_position = (double) receiver->write_head;
+      memset (dst, 0, (size_t) frames * channels * sizeof (float));
+      receiver_publish_stats (receiver);
+      return;
+    }
+
+  receiver_publish_stats (receiver);
+  double position = receiver->read_position;
+  for (uint32_t f = 0; f < frames; f++)
+    {
+      int64_t index = (int64_t) position;
+      float t = (float) (position - index);
+      const float *p0
+	= receiver->jitter + (size_t) ((index - 1) & RTP_JITTER_MASK) * channels;
+      const float *p1
+	= receiver->jitter + (size_t) (index & RTP_JITTER_MASK) * channels;
+      const float *p2
+	= receiver->jitter + (size_t) ((index + 1) & RTP_JITTER_MASK) * channels;
+      const float *p3
+	= receiver->jitter + (size_t) ((index + 2) & RTP_JITTER_MASK) * channels;
+      for (uint32_t c = 0; c < channels; c++)
+	dst[(size_t) f * channels + c]
+	  = t == 0.0f ? p1[c] : hermite (p0[c], p1[c], p2[c], p3[c], t);
+      position += step;
+    }
+  receiver->read_position = position;
+}
+
+void
+router_rtp_receiver_get_stats (RouterRtpReceiver *receiver,
+			       RouterRtpReceiverStats *stats)
+{
+  stats->packets = atomic_load (&receiver->stat_packets);
+  stats->lost = atomic_load (&receiver->stat_lost);
+  stats->late = atomic_load (&receiver->stat_late);
+  stats->invalid = atomic_load (&receiver->stat_invalid);
+  stats->resets = atomic_load (&receiver->stat_resets);
+  stats->underruns = atomic_load (&receiver->stat_underruns);
+  stats->sample_rate = atomic_load (&receiver->stat_rate);
+  stats->playing = atomic_load (&receiver->stat_playing);
+  stats->fill_ms = atomic_load (&receiver->stat_fill_ms);
+  stats->drift_ppm = atomic_load (&receiver->stat_drift_ppm);
+}
@@ -0,0 +1,280 @@
+//
+// Router 频谱分析
+//
+
+#include "router/router_spectrum.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SPECTRUM_RING_MASK (ROUTER_SPECTRUM_RING_SIZE - 1)
+#define SPECTRUM_TWO_PI 6.283185307179586
+
+// 抗混叠低通：截止频率为抽取后采样率的 0.4 倍，按名义采样率设计（系数只
+// 取决于频率比）。8 阶 Butterworth 在折叠后落入 0 ~ 0.75 倍奈奎斯特频率
+// 的分量上衰减 30 dB 以上，低频处超过 60 dB
+#define SPECTRUM_AA_CUTOFF 0.4
+#define SPECTRUM_AA_DESIGN_RATE 48000
+#define SPECTRUM_DENORMAL_FLOOR 1e-20f
+
+// 功率下限，对应 ROUTER_SPECTRUM_FLOOR_DB
+#define SPECTRUM_POWER_FLOOR 1e-12f
+
+_Static_assert ((ROUTER_SPECTRUM_RING_SIZE & SPECTRUM_RING_MASK) == 0,
+		"analysis ring size must be a power of two");
+_Static_assert (ROUTER_SPECTRUM_MAX_SIZE * 2 <= ROUTER_SPECTRUM_RING_SIZE,
+		"analysis ring must hold two windows");
+
+// ====== 分析抽头 ======
+
+void
+router_spectrum_tap_init (RouterSpectrumTap *tap)
+{
+  memset (tap, 0, sizeof (*tap));
+  atomic_init (&tap->decimation, 0);
+  atomic_init (&tap->write_pos, 0);
+  atomic_init (&tap->read_pos, 0);
+  atomic_init (&tap->dropped, 0);
+
+  // 2N 阶 Butterworth 分解为 N 个二阶节，第 k 节的 Q = 1 / (2 cos θk)
+  const uint32_t order = 2 * ROUTER_SPECTRUM_AA_SECTIONS;
+  for (uint32_t d = 2; d <= ROUTER_SPECTRUM_MAX_DECIMATION; d++)
+    for (uint32_t k = 0; k < ROUTER_SPECTRUM_AA_SECTIONS; k++)
+      {
+	double theta = (2.0 * k + 1.0) * SPECTRUM_TWO_PI / (4.0 * order);
+	RouterEqBand band = {
+	  .type = kRouterEqLowPass,
+	  .enabled = true,
+	  .frequency
+	  = (float) (SPECTRUM_AA_CUTOFF * SPECTRUM_AA_DESIGN_RATE / d),
+	  .gain_db = 0.0f,
+	  .q = (float) (0.5 / cos (theta)),
+	};
+	router_eq_design (&band, SPECTRUM_AA_DESIGN_RATE, &tap->aa[d][k]);
+      }
+}
+
+int
+router_spectrum_tap_set_decimation (RouterSpectrumTap *tap,
+				    uint32_t decimation)
+{
+  if (decimation > ROUTER_SPECTRUM_MAX_DECIMATION)
+    return -1;
+  atomic_store (&tap->decimation, decimation);
+  return 0;
+}
+
+void
+router_spectrum_tap_push (RouterSpectrumTap *tap, const float *buffer,
+			  uint32_t frames, uint32_t channels)
+{
+  uint32_t decimation
+    = atomic_load_explicit (&tap->decimation, memory_order_relaxed);
+  if (decimation == 0 || channels == 0)
+    {
+      tap->active = 0;
+      return;
+    }
+  if (decimation != tap->active)
+    {
+      tap->active = decimation;
+      tap->phase = 0;
+      memset (tap->z1, 0, sizeof (tap->z1));
+      memset (tap->z2, 0, sizeof (tap->z2));
+    }
+
+  uint32_t write = atomic_load_explicit (&tap->write_pos, memory_order_relaxed);
+  uint32_t read = atomic_load_explicit (&tap->read_pos, memory_order_acquire);
+  uint32_t count = (tap->phase + frames) / decimation;
+  if (count > ROUTER_SPECTRUM_RING_SIZE - (write - read))
+    {
+      // 分析线程跟不上：丢弃整块，下一块从新的输出相位开始
+      atomic_fetch_add_explicit (&tap->dropped, 1, memory_order_relaxed);
+      tap->phase = 0;
+      return;
+    }
+
+  const float gain = 1.0f / (float) channels;
+  const RouterEqBiquad *aa = tap->aa[decimation];
+  const uint32_t sections = decimation > 1 ? ROUTER_SPECTRUM_AA_SECTIONS : 0;
+  float z1[ROUTER_SPECTRUM_AA_SECTIONS], z2[ROUTER_SPECTRUM_AA_SECTIONS];
+  memcpy (z1, tap->z1, sizeof (z1));
+  memcpy (z2, tap->z2, sizeof (z2));
+  uint32_t phase = tap->phase;
+  for (uint32_t f = 0; f < frames; f++)
+    {
+      const float *frame = buffer + (size_t) f * channels;
+      float x = 0.0f;
+      for (uint32_t c = 0; c < channels; c++)
+	x += frame[c];
+      x *= gain;
+      // 每个输入采样都要经过滤波，抽取只决定哪些输出写入环
+      for (uint32_t k = 0; k < sections; k++)
+	{
+	  float y = aa[k].b0 * x + z1[k];
+	  z1[k] = aa[k].b1 * x - aa[k].a1 * y + z2[k];
+	  z2[k] = aa[k].b2 * x - aa[k].a2 * y;
+	  x = y;
+	}
+      if (++phase == decimation)
+	{
+	  tap->ring[write & SPECTRUM_RING_MASK] = x;
+	  write++;
+	  phase = 0;
+	}
+    }
+  tap->phase = phase;
+  for (uint32_t k = 0; k < sections; k++)
+    {
+      tap->z1[k] = fabsf (z1[k]) < SPECTRUM_DENORMAL_FLOOR ? 0.0f : z1[k];
+      tap->z2[k] = fabsf (z2[k]) < SPECTRUM_DENORMAL_FLOOR ? 0.0f : z2[k];
+    }
+  atomic_store_explicit (&tap->write_pos, write, memory_order_release);
+}
+
+uint32_t
+router_spectrum_tap_read (RouterSpectrumTap *tap, float *samples,
+			  uint32_t max_samples)
+{
+  uint32_t read = atomic_load_explicit (&tap->read_pos, memory_order_relaxed);
+  uint32_t write
+    = atomic_load_explicit (&tap->write_pos, memory_order_acquire);
+  uint32_t count = write - read;
+  if (count > max_samples)
+    count = max_samples;
+  for (uint32_t i = 0; i < count; i++)
+    samples[i] = tap->ring[(read + i) & SPECTRUM_RING_MASK];
+  atomic_store_explicit (&tap->read_pos, read + count, memory_order_release);
+  return count;
+}
+
+uint32_t
+router_spectrum_tap_collect_dropped (RouterSpectrumTap *tap)
+{
+  return atomic_exchange_explicit (&tap->dropped, 0, memory_order_relaxed);
+}
+
+// ====== 分析器 ======
+
+int
+router_spectrum_analyzer_init (RouterSpectrumAnalyzer *analyzer, uint32_t size,
+			       uint32_t band_count, uint32_t sample_rate)
+{
+  memset (analyzer, 0, sizeof (*analyzer));
+  if (size < ROUTER_SPECTRUM_MIN_SIZE || size > ROUTER_SPECTRUM_MAX_SIZE
+      || band_count == 0 || band_count > ROUTER_SPECTRUM_MAX_BANDS
+      || !(sample_rate / 2.0f > ROUTER_SPECTRUM_MIN_FREQ))
+    return -1;
+  if (router_fft_init (&analyzer->fft, size) != 0)
+    return -1;
+
+  analyzer->size = size;
+  analyzer->band_count = band_count;
+  analyzer->sample_rate = sample_rate;
+  analyzer->max_freq = sample_rate / 2.0f;
+  analyzer->window = malloc (size * sizeof (float));
+  analyzer->history = calloc (size, sizeof (float));
+  analyzer->frame = malloc (size * sizeof (float));
+  analyzer->re = malloc ((size / 2 + 1) * sizeof (float));
+  analyzer->im = malloc ((size / 2 + 1) * sizeof (float));
+  if (analyzer->window == NULL || analyzer->history == NULL
+      || analyzer->frame == NULL || analyzer->re == NULL
+      || analyzer->im == NULL)
+    {
+      router_spectrum_analyzer_destroy (analyzer);
+      return -1;
+    }
+
+  // 周期 Hann 窗；满幅正弦所在频点的幅度为 窗函数之和 / 2
+  double window_sum = 0.0;
+  for (uint32_t n = 0; n < size; n++)
+    {
+      double w = 0.5 - 0.5 * cos (SPECTRUM_TWO_PI * n / size);
+      analyzer->window[n] = (float) w;
+      window_sum += w;
+    }
+  analyzer->scale = (float) (2.0 / window_sum);
+
+  // 频带边界按对数等分 [MIN_FREQ, 奈奎斯特]，低频处频点不够时相邻频带
+  // 共用同一个频点
+  const double bin_hz = (double) sample_rate / size;
+  const double ratio = analyzer->max_freq / ROUTER_SPECTRUM_MIN_FREQ;
+  const uint32_t last_bin = size / 2;
+  for (uint32_t b = 0; b < band_count; b++)
+    {
+      double lo = ROUTER_SPECTRUM_MIN_FREQ * pow (ratio, (double) b / band_count);
+      double hi
+	= ROUTER_SPECTRUM_MIN_FREQ * pow (ratio, (double) (b + 1) / band_count);
+      uint32_t first = (uint32_t) lround (lo / bin_hz);
+      uint32_t end = (uint32_t) lround (hi / bin_hz);
+      if (first < 1)
+	first = 1;
+      if (first > last_bin)
+	first = last_bin;
+      if (end <= first)
+	end = first + 1;
+      if (end > last_bin + 1 || b + 1 == band_count)
+	end = last_bin + 1;
+      analyzer->band_lo[b] = first;
+      analyzer->band_hi[b] = end;
+    }
+  return 0;
+}
+
+void
+router_spectrum_analyzer_destroy (RouterSpectrumAnalyzer *analyzer)
+{
+  router_fft_destroy (&analyzer->fft);
+  free (analyzer->window);
+  free (analyzer->history);
+  free (analyzer->frame);
+  free (analyzer->re);
+  free (analyzer->im);
+  memset (analyzer, 0, sizeof (*analyzer));
+}
+
+void
+router_spectrum_analyzer_push (RouterSpectrumAnalyzer *analyzer,
+			       const float *samples, uint32_t count)
+{
+  const uint32_t size = analyzer->size;
+  if (count > size)
+    {
+      samples += count - size;
+      count = size;
+    }
+  uint32_t pos = analyzer->history_pos;
+  uint32_t first = size - pos < count ? size - pos : count;
+  memcpy (analyzer->history + pos, samples, first * sizeof (float));
+  memcpy (analyzer->history, samples + first, (count - first) * sizeof (float));
+  analyzer->history_pos = (pos + count) & (size - 1);
+}
+
+void
+router_spectrum_analyzer_compute (RouterSpectrumAnalyzer *analyzer,
+				  float *bands_db)
+{
+  // 历史按时间顺序展开并加窗（最旧的采样在写位置）
+  const uint32_t size = analyzer->size;
+  const uint32_t pos = analyzer->history_pos;
+  for (uint32_t n = 0; n < size; n++)
+    analyzer->frame[n]
+      = analyzer->history[(pos + n) & (size - 1)] * analyzer->window[n];
+  router_fft_forward (&analyzer->fft, analyzer->frame, analyzer->re,
+		      analyzer->im);
+
+  const float scale2 = analyzer->scale * analyzer->scale;
+  for (uint32_t b = 0; b < analyzer->band_count; b++)
+    {
+      float peak = SPECTRUM_POWER_FLOOR;
+      for (uint32_t k = analyzer->band_lo[b]; k < analyzer->band_hi[b]; k++)
+	{
+	  float power = (analyzer->re[k] * analyzer->re[k]
+			 + analyzer->im[k] * analyzer->im[k])
+			* scale2;
+	  if (power > peak)
+	    peak = power;
+	}
+      bands_db[b] = 10.0f * log10f (peak);
+    }
+}
@@ -5,12 +5,20 @@
 
 #include "service_manager.h"
 #include "constants.h"
+#include "ipc/ipc_async_client.h"
+#include "ipc/ipc_client.h"
 #include "ipc/ipc_protocol.h"
+#include "router/router_convolver.h"
+#include "router/router_rtp.h"
+#include "stream_receiver.h"
 
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/sysctl.h>
+#include <math.h>
 #include <pwd.h>
+#include <stdatomic.h>
+#include <strings.h>
 
 // 获取当前用户名
 static const char *
@@ -394,3 +402,1869 @@ print_service_status (void)
       printf ("● IPC 服务：无法获取 Socket 路径\n");
     }
 }
+
+// 格式化字节数
+static void
+format_bytes (uint64_t bytes, char *buf, size_t size)
+{
+  if (bytes >= 1024ULL * 1024ULL)
+    snprintf (buf, size, "%.1fM", (double) bytes / (1024.0 * 1024.0));
+  else if (bytes >= 1024ULL)
+    snprintf (buf, size, "%.1fK", (double) bytes / 1024.0);
+  else
+    snprintf (buf, size, "%lluB", (unsigned long long) bytes);
+}
+
+int
+print_ipc_stats (void)
+{
+  IPCClientContext ctx;
+  if (ipc_client_init (&ctx) != 0)
+    {
+      printf ("❌ 初始化 IPC 客户端失败\n");
+      return 1;
+    }
+
+  if (ipc_client_connect (&ctx) != 0)
+    {
+      printf ("⚠️  IPC 服务未运行，请使用: audioctl --start-service 启动服务\n");
+      ipc_client_cleanup (&ctx);
+      return 1;
+    }
+
+  IPCServerStats stats;
+  IPCCommandStats commands[IPC_STATS_MAX_COMMANDS];
+  uint32_t count = 0;
+  int result = ipc_client_get_stats (&ctx, &stats, commands,
+				     IPC_STATS_MAX_COMMANDS, &count);
+  ipc_client_disconnect (&ctx);
+  ipc_client_cleanup (&ctx);
+
+  if (result != 0)
+    {
+      printf ("❌ 获取 IPC 统计失败（服务端版本过旧？）\n");
+      return 1;
+    }
+
+  uint64_t uptime_sec = stats.uptime_ms / 1000;
+  printf ("📊 IPC 服务端统计\n");
+  printf ("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━\n");
+  printf ("运行时间：%lluh %02llum %02llus\n",
+	  (unsigned long long) (uptime_sec / 3600),
+	  (unsigned long long) (uptime_sec / 60 % 60),
+	  (unsigned long long) (uptime_sec % 60));
+  printf ("连接：当前 %u / 峰值 %u / 累计 %llu\n", stats.connections,
+	  stats.peak_connections, (unsigned long long) stats.total_connections);
+
+  char bytes_str[32];
+  format_bytes (stats.event_bytes_out, bytes_str, sizeof (bytes_str));
+  printf ("事件推送：%llu 条 (%s)\n", (unsigned long long) stats.events_sent,
+	  bytes_str);
+
+  // 打包结构体的数组成员可能未对齐，先复制再取地址
+  uint32_t histogram[IPC_STATS_HISTOGRAM_BUCKETS];
+  memcpy (histogram, stats.loop_histogram, sizeof (histogram));
+  double loop_avg_us
+    = stats.loop_iterations > 0
+	? (double) stats.loop_total_ns / (double) stats.loop_iterations / 1000.0
+	: 0.0;
+  printf ("事件循环：%llu 次迭代，平均 %.1f us，p99 <= %llu us，最大 %.1f us\n",
+	  (unsigned long long) stats.loop_iterations, loop_avg_us,
+	  (unsigned long long) ipc_stats_histogram_quantile_us (histogram,
+								 0.99),
+	  (double) stats.loop_max_ns / 1000.0);
+
+  // 延迟分位数由对数直方图估算，表示所在桶的上界
+  // 中文表头按显示宽度手工对齐
+  printf ("\n指令                请求    错误     接收     发送"
+	  "  平均(us)   p50(us)   p99(us)   最大(us)\n");
+  bool any_errors = false;
+  for (uint32_t i = 0; i < count; i++)
+    {
+      const IPCCommandStats *cmd = &commands[i];
+      if (cmd->requests == 0)
+	continue;
+
+      uint64_t errors = cmd->requests - cmd->status_counts[0];
+      any_errors = any_errors || errors > 0;
+
+      memcpy (histogram, cmd->histogram, sizeof (histogram));
+      char in_str[32];
+      char out_str[32];
+      format_bytes (cmd->bytes_in, in_str, sizeof (in_str));
+      format_bytes (cmd->bytes_out, out_str, sizeof (out_str));
+      printf ("%-14s %9llu %7llu %8s %8s %9.1f %9llu %9llu %10.1f\n",
+	      ipc_command_to_string (cmd->command),
+	      (unsigned long long) cmd->requests, (unsigned long long) errors,
+	      in_str, out_str,
+	      (double) cmd->total_ns / (double) cmd->requests / 1000.0,
+	      (unsigned long long) ipc_stats_histogram_quantile_us (histogram,
+								   0.50),
+	      (unsigned long long) ipc_stats_histogram_quantile_us (histogram,
+								   0.99),
+	      (double) cmd->max_ns / 1000.0);
+    }
+
+  if (any_errors)
+    {
+      printf ("\n错误明细：\n");
+      for (uint32_t i = 0; i < count; i++)
+	{
+	  for (int32_t s = 1; s < IPC_STATS_STATUS_COUNT; s++)
+	    {
+	      if (commands[i].status_counts[s] == 0)
+		continue;
+	      printf ("  %-14s %-24s %u\n",
+		      ipc_command_to_string (commands[i].command),
+		      ipc_status_to_string (-s), commands[i].status_counts[s]);
+	    }
+	}
+    }
+
+  printf ("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━\n");
+  return 0;
+}
+
+int
+print_router_stats (uint32_t limit)
+{
+  IPCClientContext ctx;
+  if (ipc_client_init (&ctx) != 0)
+    {
+      printf ("❌ 初始化 IPC 客户端失败\n");
+      return 1;
+    }
+
+  if (ipc_client_connect (&ctx) != 0)
+    {
+      printf ("⚠️  IPC 服务未运行，请使用: audioctl --start-service 启动服务\n");
+      ipc_client_cleanup (&ctx);
+      return 1;
+    }
+
+  IPCRouterStatsSnapshot snapshots[IPC_ROUTER_STATS_HISTORY];
+  uint32_t count = 0;
+  uint32_t max = (limit > 0 && limit < IPC_ROUTER_STATS_HISTORY)
+		   ? limit
+		   : IPC_ROUTER_STATS_HISTORY;
+  int result = ipc_client_get_router_stats (&ctx, snapshots, max, &count);
+  ipc_client_disconnect (&ctx);
+  ipc_client_cleanup (&ctx);
+
+  if (result != 0)
+    {
+      printf ("❌ 获取 Router 统计失败\n");
+      return 1;
+    }
+  if (count == 0)
+    {
+      printf ("暂无 Router 快照（Router 未运行或尚未完成第一个监控周期）\n");
+      return 0;
+    }
+
+  printf ("📊 Router 性能快照 (最近 %u 个周期)\n", count);
+  printf ("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━\n");
+  printf ("时间         运行 延迟(ms) 缓冲%% 峰值%% 欠载 过载    平均     P99    最大 负载%% 超时 压限dB\n");
+  uint64_t load_sum[2] = {0, 0};
+  uint16_t load_peak[2] = {0, 0};
+  uint32_t load_overruns = 0;
+  uint64_t silent_sum = 0;
+  uint32_t idle_count = 0;
+  uint16_t limiter_gr_max = 0;
+  uint32_t limited_count = 0;
+  for (uint32_t i = 0; i < count; i++)
+    {
+      const IPCRouterStatsSnapshot *snap = &snapshots[i];
+      time_t ts = (time_t) (snap->timestamp_ms / 1000);
+      struct tm tm_info;
+      localtime_r (&ts, &tm_info);
+      char time_str[16];
+      strftime (time_str, sizeof (time_str), "%H:%M:%S", &tm_info);
+
+      // 端到端延迟：本周期没有样本时显示 "-"
+      char e2e_str[32] = "      -       -       -";
+      if (snap->e2e_samples > 0)
+	snprintf (e2e_str, sizeof (e2e_str), "%7.1f %7.1f %7.1f",
+		  snap->e2e_avg_us / 1000.0, snap->e2e_p99_us / 1000.0,
+		  snap->e2e_max_us / 1000.0);
+
+      // 负载列取两个 IOProc 中较高的周期峰值
+      uint16_t peak = snap->input_load_peak > snap->output_load_peak
+			? snap->input_load_peak
+			: snap->output_load_peak;
+      load_sum[0] += snap->input_load_avg;
+      load_sum[1] += snap->output_load_avg;
+      if (snap->input_load_peak > load_peak[0])
+	load_peak[0] = snap->input_load_peak;
+      if (snap->output_load_peak > load_peak[1])
+	load_peak[1] = snap->output_load_peak;
+      load_overruns += snap->load_overruns;
+      silent_sum += snap->silent_permille;
+      if (snap->limiter_gr_cdb > 0)
+	limited_count++;
+      if (snap->limiter_gr_cdb > limiter_gr_max)
+	limiter_gr_max = snap->limiter_gr_cdb;
+      bool idle = (snap->flags & IPC_ROUTER_FLAG_IDLE) != 0;
+      if (idle)
+	idle_count++;
+      const char *marker = "";
+      if (snap->underruns > 0 || snap->overruns > 0
+	  || snap->load_overruns > 0)
+	marker = "  ⚠️";
+      else if (idle)
+	marker = "  💤";
+
+      printf ("%-10s %3u:%02u %8u %5u %5u %4u %4u %s %5.1f %4u %6.2f%s\n",
+	      time_str, snap->uptime_sec / 60, snap->uptime_sec % 60,
+	      snap->latency_ms, snap->fill_percent, snap->peak_percent,
+	      snap->underruns, snap->overruns, e2e_str, peak / 10.0,
+	      snap->load_overruns, snap->limiter_gr_cdb / 100.0, marker);
+    }
+  printf ("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━\n");
+  const IPCRouterStatsSnapshot *last = &snapshots[count - 1];
+  printf ("周期: %u ms，采样率: %u Hz，累计传输: %llu 帧\n",
+	  last->interval_ms, last->sample_rate,
+	  (unsigned long long) last->frames_total);
+  printf ("平均/P99/最大: 端到端延迟 (ms)，含设备延迟与安全偏移 %.1f ms\n",
+	  last->device_latency_us / 1000.0);
+  printf ("回调负载: 输入 平均 %.1f%% 峰值 %.1f%%，输出 平均 %.1f%% 峰值 "
+	  "%.1f%%，超过 %.0f%% 周期的回调 %u 次\n",
+	  load_sum[0] / 10.0 / count, load_peak[0] / 10.0,
+	  load_sum[1] / 10.0 / count, load_peak[1] / 10.0,
+	  last->load_threshold / 10.0, load_overruns);
+  printf ("静音输入: 平均 %.1f%%，空闲模式周期 %u 个 (💤)\n",
+	  silent_sum / 10.0 / count, idle_count);
+  printf ("输出限制器: 最大增益衰减 %.2f dB，发生压限的周期 %u 个\n",
+	  limiter_gr_max / 100.0, limited_count);
+  return 0;
+}
+
+// ====== 响度计量 ======
+
+// 格式化一项读数，低于下限（无信号）时显示 "-"
+static void
+format_loudness (float value, char *buf, size_t size)
+{
+  if (value <= IPC_LOUDNESS_MIN_LUFS)
+    snprintf (buf, size, "%7s", "-");
+  else
+    snprintf (buf, size, "%7.1f", value);
+}
+
+static void
+print_loudness_entry (const IPCLoudnessEntry *entry)
+{
+  char m[16], st[16], i[16], tp[16];
+  format_loudness (entry->momentary_lufs, m, sizeof (m));
+  format_loudness (entry->short_term_lufs, st, sizeof (st));
+  format_loudness (entry->integrated_lufs, i, sizeof (i));
+  format_loudness (entry->true_peak_dbtp, tp, sizeof (tp));
+
+  // 中文名称按显示宽度手工对齐；主输出不参与响度均衡和闪避
+  char source[64];
+  char gain[16];
+  if (entry->pid == IPC_LOUDNESS_MASTER_PID)
+    {
+      snprintf (source, sizeof (source), "主输出 (Router)        ");
+      snprintf (gain, sizeof (gain), "%7s", "-");
+    }
+  else
+    {
+      snprintf (source, sizeof (source), "%-16.16s %6d",
+		entry->name[0] ? entry->name : "?", (int) entry->pid);
+      snprintf (gain, sizeof (gain), "%+7.1f", entry->agc_gain_db);
+    }
+  printf ("%s %s %s %s %s %s\n", source, m, st, i, tp, gain);
+}
+
+int
+print_loudness (void)
+{
+  IPCClientContext ctx;
+  if (ipc_client_init (&ctx) != 0)
+    {
+      printf ("❌ 初始化 IPC 客户端失败\n");
+      return 1;
+    }
+
+  if (ipc_client_connect (&ctx) != 0)
+    {
+      printf ("⚠️  IPC 服务未运行，请使用: audioctl --start-service 启动服务\n");
+      ipc_client_cleanup (&ctx);
+      return 1;
+    }
+
+  IPCLoudnessEntry entries[IPC_LOUDNESS_MAX_ENTRIES];
+  uint32_t count = 0;
+  int result = ipc_client_get_loudness (&ctx, entries,
+					IPC_LOUDNESS_MAX_ENTRIES, &count);
+  ipc_client_disconnect (&ctx);
+  ipc_client_cleanup (&ctx);
+
+  if (result != 0)
+    {
+      printf ("❌ 获取响度读数失败\n");
+      return 1;
+    }
+  if (count == 0)
+    {
+      printf ("暂无响度读数（Router 和虚拟设备驱动尚未上报）\n");
+      return 0;
+    }
+
+  printf ("📈 响度计量 (EBU R128)\n");
+  printf ("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━\n");
+  printf ("来源                PID    瞬时    短期    积分  真峰值    自动\n");
+  for (uint32_t i = 0; i < count; i++)
+    print_loudness_entry (&entries[i]);
+  printf ("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━\n");
+  printf ("瞬时 400ms / 短期 3s / 积分（门限后）: LUFS，真峰值: dBTP，"
+	  "\"-\" 表示无信号\n");
+  printf ("应用读数为音量调节之前的原始输出，"
+	  "自动: 响度均衡与闪避的当前增益 (dB)\n");
+  return 0;
+}
+
+// ====== 均衡器 ======
+
+static const struct
+{
+  const char *name;  // 命令行名称
+  const char *label; // 显示名称
+  float default_q;   // 未指定 Q 时的默认值
+} kEqualizerTypes[kIPCEqualizerTypeCount] = {
+  [kIPCEqualizerPeaking] = {"peak", "峰值", 1.0f},
+  [kIPCEqualizerLowShelf] = {"lowshelf", "低架", 0.707f},
+  [kIPCEqualizerHighShelf] = {"highshelf", "高架", 0.707f},
+  [kIPCEqualizerHighPass] = {"highpass", "高通", 0.707f},
+  [kIPCEqualizerLowPass] = {"lowpass", "低通", 0.707f},
+};
+
+static void
+print_equalizer_usage (void)
+{
+  printf ("用法:\n");
+  printf ("  audioctl eq                       显示当前配置\n");
+  printf ("  audioctl eq on|off                启用/关闭均衡器\n");
+  printf ("  audioctl eq preamp <dB>           设置前级增益\n");
+  printf ("  audioctl eq band <1-%d> <类型> <频率Hz> [增益dB] [Q]\n",
+	  IPC_EQ_MAX_BANDS);
+  printf ("  audioctl eq band <1-%d> off       关闭某一段\n",
+	  IPC_EQ_MAX_BANDS);
+  printf ("  audioctl eq reset                 清除所有段\n");
+  printf ("类型: peak lowshelf highshelf highpass lowpass\n");
+  printf ("范围: 频率 %.0f-%.0f Hz，增益 ±%.0f dB，Q %.1f-%.0f\n",
+	  IPC_EQ_MIN_FREQ, IPC_EQ_MAX_FREQ, IPC_EQ_MAX_GAIN_DB, IPC_EQ_MIN_Q,
+	  IPC_EQ_MAX_Q);
+}
+
+static void
+print_equalizer_config (const IPCEqualizerConfig *config)
+{
+  printf ("🎚️  均衡器: %s | 前级 %+.1f dB\n",
+	  config->enabled ? "已启用" : "已关闭", config->preamp_db);
+  if (config->band_count == 0)
+    {
+      printf ("   (无频段)\n");
+      return;
+    }
+  printf (" #  类型       频率(Hz)  增益(dB)      Q\n");
+  for (uint32_t i = 0; i < config->band_count; i++)
+    {
+      const IPCEqualizerBand *band = &config->bands[i];
+      const char *label = band->type < kIPCEqualizerTypeCount
+			    ? kEqualizerTypes[band->type].label
+			    : "?";
+      printf ("%2u  %-8s %10.1f %+9.1f %6.2f%s\n", i + 1, label,
+	      band->frequency, band->gain_db, band->q,
+	      band->enabled ? "" : "  (直通)");
+    }
+}
+
+// 按命令行参数修改配置，参数错误返回 -1
+static int
+parse_equalizer_args (IPCEqualizerConfig *config, int argc, char *argv[])
+{
+  const char *sub = argv[2];
+  if (strcmp (sub, "on") == 0 || strcmp (sub, "off") == 0)
+    {
+      config->enabled = strcmp (sub, "on") == 0;
+      return 0;
+    }
+  if (strcmp (sub, "reset") == 0)
+    {
+      memset (config, 0, sizeof (*config));
+      return 0;
+    }
+  if (strcmp (sub, "preamp") == 0 && argc >= 4)
+    {
+      config->preamp_db = strtof (argv[3], NULL);
+      return 0;
+    }
+  if (strcmp (sub, "band") != 0 || argc < 5)
+    return -1;
+
+  int index = atoi (argv[3]) - 1;
+  if (index < 0 || index >= IPC_EQ_MAX_BANDS)
+    return -1;
+
+  // 跳过的段先以直通补齐
+  for (int i = config->band_count; i <= index; i++)
+    {
+      IPCEqualizerBand *band = &config->bands[i];
+      memset (band, 0, sizeof (*band));
+      band->type = kIPCEqualizerPeaking;
+      band->frequency = 1000.0f;
+      band->q = 1.0f;
+    }
+  if (config->band_count <= index)
+    config->band_count = (uint8_t) (index + 1);
+
+  IPCEqualizerBand *band = &config->bands[index];
+  if (strcmp (argv[4], "off") == 0)
+    {
+      band->enabled = 0;
+      return 0;
+    }
+  if (argc < 6)
+    return -1;
+
+  int type = -1;
+  for (int t = 0; t < kIPCEqualizerTypeCount; t++)
+    {
+      if (strcmp (argv[4], kEqualizerTypes[t].name) == 0)
+	type = t;
+    }
+  if (type < 0)
+    return -1;
+
+  band->type = (uint8_t) type;
+  band->enabled = 1;
+  band->frequency = strtof (argv[5], NULL);
+  band->gain_db = argc >= 7 ? strtof (argv[6], NULL) : 0.0f;
+  band->q
+    = argc >= 8 ? strtof (argv[7], NULL) : kEqualizerTypes[type].default_q;
+  return 0;
+}
+
+int
+equalizer_command (int argc, char *argv[])
+{
+  IPCClientContext ctx;
+  if (ipc_client_init (&ctx) != 0)
+    {
+      printf ("❌ 初始化 IPC 客户端失败\n");
+      return 1;
+    }
+
+  if (ipc_client_connect (&ctx) != 0)
+    {
+      printf ("⚠️  IPC 服务未运行，请使用: audioctl --start-service 启动服务\n");
+      ipc_client_cleanup (&ctx);
+      return 1;
+    }
+
+  IPCEqualizerConfig config;
+  int result = 0;
+  if (ipc_client_get_equalizer (&ctx, &config) != 0)
+    {
+      printf ("❌ 获取均衡器配置失败\n");
+      result = 1;
+    }
+  else if (argc >= 3)
+    {
+      if (parse_equalizer_args (&config, argc, argv) != 0)
+	{
+	  print_equalizer_usage ();
+	  result = 1;
+	}
+      else if (!ipc_equalizer_config_is_valid (&config))
+	{
+	  printf ("❌ 参数超出范围\n");
+	  print_equalizer_usage ();
+	  result = 1;
+	}
+      else if (ipc_client_set_equalizer (&ctx, &config) != 0)
+	{
+	  printf ("❌ 设置均衡器失败\n");
+	  result = 1;
+	}
+    }
+
+  ipc_client_disconnect (&ctx);
+  ipc_client_cleanup (&ctx);
+
+  if (result == 0)
+    {
+      print_equalizer_config (&config);
+      if (!config.enabled && config.band_count > 0)
+	printf ("提示: 均衡器未启用，运行 audioctl eq on 生效\n");
+    }
+  return result;
+}
+
+// ====== 响度均衡 ======
+
+static void
+print_normalizer_usage (void)
+{
+  printf ("用法:\n");
+  printf ("  audioctl normalize                显示当前配置\n");
+  printf ("  audioctl normalize on|off         启用/关闭响度均衡\n");
+  printf ("  audioctl normalize target <LUFS>  设置目标响度\n");
+  printf ("  audioctl normalize boost <dB>     设置最大提升\n");
+  printf ("  audioctl normalize cut <dB>       设置最大衰减\n");
+  printf ("  audioctl normalize speed <起音dB/s> <释放dB/s>\n");
+  printf ("  audioctl normalize reset          恢复默认参数\n");
+  printf ("范围: 目标 %.0f 至 %.0f LUFS，提升 0-%.0f dB，衰减 0-%.0f dB，"
+	  "速率 %.1f-%.0f dB/s\n",
+	  IPC_NORMALIZER_MIN_TARGET_LUFS, IPC_NORMALIZER_MAX_TARGET_LUFS,
+	  IPC_NORMALIZER_MAX_BOOST_DB, IPC_NORMALIZER_MAX_CUT_DB,
+	  IPC_NORMALIZER_MIN_RATE_DB, IPC_NORMALIZER_MAX_RATE_DB);
+}
+
+static void
+print_normalizer_config (const IPCNormalizerConfig *config)
+{
+  printf ("🔊 响度均衡: %s | 目标 %.1f LUFS\n",
+	  config->enabled ? "已启用" : "已关闭", config->target_lufs);
+  printf ("   最大提升 %.1f dB，最大衰减 %.1f dB\n", config->max_boost_db,
+	  config->max_cut_db);
+  printf ("   变响时衰减 %.1f dB/s，变轻时提升 %.1f dB/s\n",
+	  config->attack_db_per_s, config->release_db_per_s);
+}
+
+// 按命令行参数修改配置，参数错误返回 -1
+static int
+parse_normalizer_args (IPCNormalizerConfig *config, int argc, char *argv[])
+{
+  const char *sub = argv[2];
+  if (strcmp (sub, "on") == 0 || strcmp (sub, "off") == 0)
+    {
+      config->enabled = strcmp (sub, "on") == 0;
+      return 0;
+    }
+  if (strcmp (sub, "reset") == 0)
+    {
+      // 保留启用状态，只恢复参数
+      uint8_t enabled = config->enabled;
+      ipc_normalizer_config_init (config);
+      config->enabled = enabled;
+      return 0;
+    }
+  if (argc < 4)
+    return -1;
+
+  float value = strtof (argv[3], NULL);
+  if (strcmp (sub, "target") == 0)
+    config->target_lufs = value;
+  else if (strcmp (sub, "boost") == 0)
+    config->max_boost_db = value;
+  else if (strcmp (sub, "cut") == 0)
+    config->max_cut_db = value;
+  else if (strcmp (sub, "speed") == 0 && argc >= 5)
+    {
+      config->attack_db_per_s = value;
+      config->release_db_per_s = strtof (argv[4], NULL);
+    }
+  else
+    return -1;
+  return 0;
+}
+
+int
+normalizer_command (int argc, char *argv[])
+{
+  IPCClientContext ctx;
+  if (ipc_client_init (&ctx) != 0)
+    {
+      printf ("❌ 初始化 IPC 客户端失败\n");
+      return 1;
+    }
+
+  if (ipc_client_connect (&ctx) != 0)
+    {
+      printf ("⚠️  IPC 服务未运行，请使用: audioctl --start-service 启动服务\n");
+      ipc_client_cleanup (&ctx);
+      return 1;
+    }
+
+  IPCNormalizerConfig config;
+  int result = 0;
+  if (ipc_client_get_normalizer (&ctx, &config) != 0)
+    {
+      printf ("❌ 获取响度均衡配置失败\n");
+      result = 1;
+    }
+  else if (argc >= 3)
+    {
+      if (parse_normalizer_args (&config, argc, argv) != 0)
+	{
+	  print_normalizer_usage ();
+	  result = 1;
+	}
+      else if (!ipc_normalizer_config_is_valid (&config))
+	{
+	  printf ("❌ 参数超出范围\n");
+	  print_normalizer_usage ();
+	  result = 1;
+	}
+      else if (ipc_client_set_normalizer (&ctx, &config) != 0)
+	{
+	  printf ("❌ 设置响度均衡失败\n");
+	  result = 1;
+	}
+    }
+
+  ipc_client_disconnect (&ctx);
+  ipc_client_cleanup (&ctx);
+
+  if (result == 0)
+    {
+      print_normalizer_config (&config);
+      if (!config.enabled)
+	printf ("提示: 响度均衡未启用，运行 audioctl normalize on 生效\n");
+    }
+  return result;
+}
+
+// ====== 闪避 ======
+
+static void
+print_ducking_usage (void)
+{
+  printf ("用法:\n");
+  printf ("  audioctl duck                     显示当前配置\n");
+  printf ("  audioctl duck on|off              启用/关闭自动闪避\n");
+  printf ("  audioctl duck depth <dB>          设置衰减深度\n");
+  printf ("  audioctl duck threshold <LUFS>    设置人声活动门限\n");
+  printf ("  audioctl duck times <起音ms> <保持ms> <释放ms>\n");
+  printf ("  audioctl duck voice add|remove <Bundle ID 或名称>\n");
+  printf ("  audioctl duck media add|remove <Bundle ID 或名称>\n");
+  printf ("  audioctl duck reset               恢复默认参数和应用列表\n");
+  printf ("范围: 深度 0-%.0f dB，门限 %.0f 至 %.0f LUFS，时间 0-%.0f ms，"
+	  "每个列表最多 %d 个应用\n",
+	  IPC_DUCKING_MAX_DEPTH_DB, IPC_DUCKING_MIN_THRESHOLD_LUFS,
+	  IPC_DUCKING_MAX_THRESHOLD_LUFS, IPC_DUCKING_MAX_TIME_MS,
+	  IPC_DUCKING_MAX_APPS);
+}
+
+static void
+print_ducking_list (const char *label, char list[][IPC_DUCKING_ID_MAX],
+		    uint8_t count)
+{
+  printf ("   %s:", label);
+  if (count == 0)
+    printf (" (无)");
+  for (uint8_t i = 0; i < count; i++)
+    printf (" %s", list[i]);
+  printf ("\n");
+}
+
+static void
+print_ducking_config (IPCDuckingConfig *config)
+{
+  printf ("🔉 自动闪避: %s | 深度 %.1f dB，门限 %.1f LUFS\n",
+	  config->enabled ? "已启用" : "已关闭", config->depth_db,
+	  config->threshold_lufs);
+  printf ("   起音 %.0f ms，保持 %.0f ms，释放 %.0f ms\n", config->attack_ms,
+	  config->hold_ms, config->release_ms);
+  print_ducking_list ("人声", config->voice, config->voice_count);
+  print_ducking_list ("媒体", config->media, config->media_count);
+}
+
+// 在列表中添加或移除一项（不区分大小写），参数错误返回 -1
+static int
+edit_ducking_list (char list[][IPC_DUCKING_ID_MAX], uint8_t *count,
+		   const char *action, const char *id)
+{
+  if (id[0] == '\0' || strlen (id) >= IPC_DUCKING_ID_MAX)
+    return -1;
+
+  int found = -1;
+  for (int i = 0; i < *count; i++)
+    {
+      if (strcasecmp (list[i], id) == 0)
+	found = i;
+    }
+
+  if (strcmp (action, "add") == 0)
+    {
+      if (found >= 0)
+	return 0;
+      if (*count >= IPC_DUCKING_MAX_APPS)
+	return -1;
+      snprintf (list[*count], IPC_DUCKING_ID_MAX, "%s", id);
+      (*count)++;
+      return 0;
+    }
+  if (strcmp (action, "remove") == 0)
+    {
+      if (found < 0)
+	return -1;
+      for (int i = found; i + 1 < *count; i++)
+	memcpy (list[i], list[i + 1], IPC_DUCKING_ID_MAX);
+      (*count)--;
+      memset (list[*count], 0, IPC_DUCKING_ID_MAX);
+      return 0;
+    }
+  return -1;
+}
+
+// 按命令行参数修改配置，参数错误返回 -1
+static int
+parse_ducking_args (IPCDuckingConfig *config, int argc, char *argv[])
+{
+  const char *sub = argv[2];
+  if (strcmp (sub, "on") == 0 || strcmp (sub, "off") == 0)
+    {
+      config->enabled = strcmp (sub, "on") == 0;
+      return 0;
+    }
+  if (strcmp (sub, "reset") == 0)
+    {
+      // 保留启用状态，只恢复参数和列表
+      uint8_t enabled = config->enabled;
+      ipc_ducking_config_init (config);
+      config->enabled = enabled;
+      return 0;
+    }
+  if (argc < 4)
+    return -1;
+
+  if (strcmp (sub, "voice") == 0 && argc >= 5)
+    return edit_ducking_list (config->voice, &config->voice_count, argv[3],
+			      argv[4]);
+  if (strcmp (sub, "media") == 0 && argc >= 5)
+    return edit_ducking_list (config->media, &config->media_count, argv[3],
+			      argv[4]);
+
+  float value = strtof (argv[3], NULL);
+  if (strcmp (sub, "depth") == 0)
+    config->depth_db = value;
+  else if (strcmp (sub, "threshold") == 0)
+    config->threshold_lufs = value;
+  else if (strcmp (sub, "times") == 0 && argc >= 6)
+    {
+      config->attack_ms = value;
+      config->hold_ms = strtof (argv[4], NULL);
+      config->release_ms = strtof (argv[5], NULL);
+    }
+  else
+    return -1;
+  return 0;
+}
+
+int
+ducking_command (int argc, char *argv[])
+{
+  IPCClientContext ctx;
+  if (ipc_client_init (&ctx) != 0)
+    {
+      printf ("❌ 初始化 IPC 客户端失败\n");
+      return 1;
+    }
+
+  if (ipc_client_connect (&ctx) != 0)
+    {
+      printf ("⚠️  IPC 服务未运行，请使用: audioctl --start-service 启动服务\n");
+      ipc_client_cleanup (&ctx);
+      return 1;
+    }
+
+  IPCDuckingConfig config;
+  int result = 0;
+  if (ipc_client_get_ducking (&ctx, &config) != 0)
+    {
+      printf ("❌ 获取闪避配置失败\n");
+      result = 1;
+    }
+  else if (argc >= 3)
+    {
+      if (parse_ducking_args (&config, argc, argv) != 0)
+	{
+	  print_ducking_usage ();
+	  result = 1;
+	}
+      else if (!ipc_ducking_config_is_valid (&config))
+	{
+	  printf ("❌ 参数超出范围\n");
+	  print_ducking_usage ();
+	  result = 1;
+	}
+      else if (ipc_client_set_ducking (&ctx, &config) != 0)
+	{
+	  printf ("❌ 设置闪避失败\n");
+	  result = 1;
+	}
+    }
+
+  ipc_client_disconnect (&ctx);
+  ipc_client_cleanup (&ctx);
+
+  if (result == 0)
+    {
+      print_ducking_config (&config);
+      if (!config.enabled)
+	printf ("提示: 自动闪避未启用，运行 audioctl duck on 生效\n");
+    }
+  return result;
+}
+
+// ====== 声道混合 ======
+
+static void
+print_channel_mix_usage (void)
+{
+  printf ("用法:\n");
+  printf ("  audioctl mix                      显示各应用的规则\n");
+  printf ("  audioctl mix <应用> [balance <值>] [pan <值>] [mono on|off] "
+	  "[swap on|off]\n");
+  printf ("  audioctl mix <应用> reset         删除该应用的规则\n");
+  printf ("  audioctl mix reset                删除所有规则\n");
+  printf ("应用: Bundle ID 或应用名称，多个应用用逗号分隔（同一批生效）\n");
+  printf ("范围: 平衡、声像 -100（左）至 100（右），最多 %d 条规则\n",
+	  IPC_CHANNEL_MIX_MAX_APPS);
+}
+
+static void
+print_channel_mix_config (const IPCChannelMixConfig *config)
+{
+  printf ("🎛️  声道混合: %u 条规则\n", config->count);
+  if (config->count == 0)
+    {
+      printf ("   (无规则，所有应用保持原声道)\n");
+      return;
+    }
+  printf (" 应用                              平衡  声像  单声道  互换\n");
+  for (uint32_t i = 0; i < config->count; i++)
+    {
+      const IPCChannelMixRule *rule = &config->rules[i];
+      // 中文按显示宽度手工对齐
+      printf (" %-32.32s %5.0f %5.0f  %s  %s\n", rule->app,
+	      rule->balance * 100.0f, rule->pan * 100.0f,
+	      (rule->flags & kIPCChannelMixMono) ? "  开  " : "  -   ",
+	      (rule->flags & kIPCChannelMixSwap) ? " 开" : " -");
+    }
+}
+
+// 解析 on/off，参数错误返回 -1
+static int
+parse_switch (const char *value, uint8_t *flags, uint8_t flag)
+{
+  if (strcmp (value, "on") == 0)
+    *flags |= flag;
+  else if (strcmp (value, "off") == 0)
+    *flags &= (uint8_t) ~flag;
+  else
+    return -1;
+  return 0;
+}
+
+// 按命令行参数修改一条规则（rule 已是该应用的当前规则），参数错误返回 -1
+static int
+parse_channel_mix_rule (IPCChannelMixRule *rule, int argc, char *argv[])
+{
+  if (argc == 4 && strcmp (argv[3], "reset") == 0)
+    {
+      rule->balance = 0.0f;
+      rule->pan = 0.0f;
+      rule->flags = 0;
+      return 0;
+    }
+  if (argc < 5 || (argc - 3) % 2 != 0)
+    return -1;
+
+  for (int i = 3; i + 1 < argc; i += 2)
+    {
+      const char *key = argv[i];
+      const char *value = argv[i + 1];
+      if (strcmp (key, "balance") == 0)
+	rule->balance = strtof (value, NULL) / 100.0f;
+      else if (strcmp (key, "pan") == 0)
+	rule->pan = strtof (value, NULL) / 100.0f;
+      else if (strcmp (key, "mono") == 0)
+	{
+	  if (parse_switch (value, &rule->flags, kIPCChannelMixMono) != 0)
+	    return -1;
+	}
+      else if (strcmp (key, "swap") == 0)
+	{
+	  if (parse_switch (value, &rule->flags, kIPCChannelMixSwap) != 0)
+	    return -1;
+	}
+      else
+	return -1;
+    }
+  return 0;
+}
+
+// 按命令行参数生成批量更新，参数错误返回 -1
+static int
+build_channel_mix_update (const IPCChannelMixConfig *config,
+			  IPCChannelMixConfig *update, int argc, char *argv[])
+{
+  ipc_channel_mix_config_init (update);
+
+  // 删除所有规则：每个应用一条中性规则
+  if (argc == 3 && strcmp (argv[2], "reset") == 0)
+    {
+      for (uint32_t i = 0; i < config->count; i++)
+	{
+	  IPCChannelMixRule *rule = &update->rules[update->count++];
+	  memcpy (rule->app, config->rules[i].app, sizeof (rule->app));
+	}
+      return 0;
+    }
+
+  char apps[256];
+  snprintf (apps, sizeof (apps), "%s", argv[2]);
+  char *save = NULL;
+  for (char *app = strtok_r (apps, ",", &save); app != NULL;
+       app = strtok_r (NULL, ",", &save))
+    {
+      if (update->count >= IPC_CHANNEL_MIX_MAX_APPS
+	  || strlen (app) >= IPC_CHANNEL_MIX_ID_MAX)
+	return -1;
+
+      // 从该应用的当前规则出发，只修改命令行给出的项
+      IPCChannelMixRule *rule = &update->rules[update->count++];
+      const IPCChannelMixRule *current
+	= ipc_channel_mix_config_find (config, app, NULL);
+      if (current != NULL)
+	*rule = *current;
+      snprintf (rule->app, sizeof (rule->app), "%s", app);
+      if (parse_channel_mix_rule (rule, argc, argv) != 0)
+	return -1;
+    }
+  return update->count > 0 ? 0 : -1;
+}
+
+int
+channel_mix_command (int argc, char *argv[])
+{
+  IPCClientContext ctx;
+  if (ipc_client_init (&ctx) != 0)
+    {
+      printf ("❌ 初始化 IPC 客户端失败\n");
+      return 1;
+    }
+
+  if (ipc_client_connect (&ctx) != 0)
+    {
+      printf ("⚠️  IPC 服务未运行，请使用: audioctl --start-service 启动服务\n");
+      ipc_client_cleanup (&ctx);
+      return 1;
+    }
+
+  IPCChannelMixConfig config;
+  IPCChannelMixConfig update;
+  int result = 0;
+  if (ipc_client_get_channel_mix (&ctx, &config) != 0)
+    {
+      printf ("❌ 获取声道混合规则失败\n");
+      result = 1;
+    }
+  else if (argc >= 3)
+    {
+      if (build_channel_mix_update (&config, &update, argc, argv) != 0)
+	{
+	  print_channel_mix_usage ();
+	  result = 1;
+	}
+      else if (!ipc_channel_mix_config_is_valid (&update))
+	{
+	  printf ("❌ 参数超出范围\n");
+	  print_channel_mix_usage ();
+	  result = 1;
+	}
+      else if (ipc_client_update_channel_mix (&ctx, &update, &config) != 0)
+	{
+	  printf ("❌ 设置声道混合失败（规则数已满？）\n");
+	  result = 1;
+	}
+    }
+
+  ipc_client_disconnect (&ctx);
+  ipc_client_cleanup (&ctx);
+
+  if (result == 0)
+    print_channel_mix_config (&config);
+  return result;
+}
+
+// ====== 卷积 ======
+
+static void
+print_convolver_usage (void)
+{
+  printf ("用法:\n");
+  printf ("  audioctl convolve                 显示当前配置\n");
+  printf ("  audioctl convolve load <文件.wav> 读取冲激响应并启用\n");
+  printf ("  audioctl convolve on|off          启用/关闭卷积\n");
+  printf ("  audioctl convolve gain <dB>       设置输出增益\n");
+  printf ("  audioctl convolve reset           关闭并清除冲激响应\n");
+  printf ("IR: WAV 单声道或立体声，16/24/32 位整数或 32 位浮点，采样率须与输出"
+	  "设备一致，最长 %u 帧\n",
+	  ROUTER_CONVOLVER_MAX_IR_FRAMES);
+  printf ("范围: 增益 %.0f 至 %.0f dB\n", IPC_CONVOLVER_MIN_GAIN_DB,
+	  IPC_CONVOLVER_MAX_GAIN_DB);
+}
+
+static void
+print_convolver_config (const IPCConvolverConfig *config)
+{
+  printf ("🎛️  卷积: %s | 输出增益 %+.1f dB\n",
+	  config->enabled ? "已启用" : "已关闭", config->gain_db);
+  printf ("   IR: %s\n", config->path[0] != '\0' ? config->path : "(未设置)");
+  printf ("   延迟: %u 帧\n", ROUTER_CONVOLVER_BLOCK);
+}
+
+// 在本地读取一次 IR，提前报告格式错误（Router 收到推送后会再读取一次）
+static int
+check_convolver_ir (const char *path)
+{
+  RouterConvolverIr *ir = router_convolver_ir_load_wav (path, 1.0f);
+  if (ir == NULL)
+    {
+      printf ("❌ 无法读取冲激响应: %s\n", path);
+      printf ("   需要 WAV 单声道或立体声，最长 %u 帧\n",
+	      ROUTER_CONVOLVER_MAX_IR_FRAMES);
+      return -1;
+    }
+  printf ("📄 %s: %.2f 秒，%u 声道，%u Hz，%u 块\n", path,
+	  (double) ir->frames / ir->sample_rate, ir->channels, ir->sample_rate,
+	  ir->partitions);
+  router_convolver_ir_destroy (ir);
+  return 0;
+}
+
+// 按命令行参数修改配置，参数错误返回 -1
+static int
+parse_convolver_args (IPCConvolverConfig *config, int argc, char *argv[])
+{
+  const char *sub = argv[2];
+  if (strcmp (sub, "on") == 0 || strcmp (sub, "off") == 0)
+    {
+      config->enabled = strcmp (sub, "on") == 0;
+      return 0;
+    }
+  if (strcmp (sub, "reset") == 0)
+    {
+      memset (config, 0, sizeof (*config));
+      return 0;
+    }
+  if (argc < 4)
+    return -1;
+
+  if (strcmp (sub, "gain") == 0)
+    {
+      config->gain_db = strtof (argv[3], NULL);
+      return 0;
+    }
+  if (strcmp (sub, "load") == 0)
+    {
+      // Router 在另一个进程中读取文件，统一转换为绝对路径
+      char resolved[PATH_MAX];
+      if (realpath (argv[3], resolved) == NULL
+	  || strlen (resolved) >= sizeof (config->path))
+	{
+	  printf ("❌ 找不到文件: %s\n", argv[3]);
+	  return -1;
+	}
+      if (check_convolver_ir (resolved) != 0)
+	return -1;
+      strcpy (config->path, resolved);
+      config->enabled = 1;
+      return 0;
+    }
+  return -1;
+}
+
+int
+convolver_command (int argc, char *argv[])
+{
+  IPCClientContext ctx;
+  if (ipc_client_init (&ctx) != 0)
+    {
+      printf ("❌ 初始化 IPC 客户端失败\n");
+      return 1;
+    }
+
+  if (ipc_client_connect (&ctx) != 0)
+    {
+      printf ("⚠️  IPC 服务未运行，请使用: audioctl --start-service 启动服务\n");
+      ipc_client_cleanup (&ctx);
+      return 1;
+    }
+
+  IPCConvolverConfig config;
+  int result = 0;
+  if (ipc_client_get_convolver (&ctx, &config) != 0)
+    {
+      printf ("❌ 获取卷积器配置失败\n");
+      result = 1;
+    }
+  else if (argc >= 3)
+    {
+      if (parse_convolver_args (&config, argc, argv) != 0)
+	{
+	  print_convolver_usage ();
+	  result = 1;
+	}
+      else if (!ipc_convolver_config_is_valid (&config))
+	{
+	  printf ("❌ 参数超出范围或尚未 load 冲激响应\n");
+	  print_convolver_usage ();
+	  result = 1;
+	}
+      else if (ipc_client_set_convolver (&ctx, &config) != 0)
+	{
+	  printf ("❌ 设置卷积器失败\n");
+	  result = 1;
+	}
+    }
+
+  ipc_client_disconnect (&ctx);
+  ipc_client_cleanup (&ctx);
+
+  if (result == 0)
+    print_convolver_config (&config);
+  return result;
+}
+
+// ====== 交叉馈送 ======
+
+static const char *const kCrossfeedModeNames[kIPCCrossfeedModeCount]
+  = {"off", "on", "auto"};
+static const char *const kCrossfeedPresetNames[kIPCCrossfeedPresetCount]
+  = {"light", "medium", "strong"};
+
+static void
+print_crossfeed_usage (void)
+{
+  printf ("用法:\n");
+  printf ("  audioctl crossfeed                     显示当前配置\n");
+  printf ("  audioctl crossfeed on|off|auto         开启/关闭/按输出设备自动\n");
+  printf ("  audioctl crossfeed light|medium|strong 选择强度\n");
+  printf ("  audioctl crossfeed reset               恢复默认（关闭、medium）\n");
+  printf ("可组合使用，例如: audioctl crossfeed on strong\n");
+  printf ("自动: 输出设备报告当前端口为耳机时开启（蓝牙/USB 耳机请用 on）\n");
+}
+
+static void
+print_crossfeed_config (const IPCCrossfeedConfig *config)
+{
+  static const char *const kModeLabels[kIPCCrossfeedModeCount]
+    = {"已关闭", "已开启", "自动"};
+  static const char *const kPresetLabels[kIPCCrossfeedPresetCount]
+    = {"650 Hz / 9.5 dB", "700 Hz / 6.0 dB", "700 Hz / 4.5 dB"};
+  printf ("🎧 交叉馈送: %s | 强度 %s (%s)\n", kModeLabels[config->mode],
+	  kCrossfeedPresetNames[config->preset],
+	  kPresetLabels[config->preset]);
+}
+
+// 按命令行参数修改配置，参数错误返回 -1
+static int
+parse_crossfeed_args (IPCCrossfeedConfig *config, int argc, char *argv[])
+{
+  for (int i = 2; i < argc; i++)
+    {
+      if (strcmp (argv[i], "reset") == 0)
+	{
+	  ipc_crossfeed_config_init (config);
+	  continue;
+	}
+      bool matched = false;
+      for (uint8_t m = 0; m < kIPCCrossfeedModeCount && !matched; m++)
+	if (strcmp (argv[i], kCrossfeedModeNames[m]) == 0)
+	  {
+	    config->mode = m;
+	    matched = true;
+	  }
+      for (uint8_t p = 0; p < kIPCCrossfeedPresetCount && !matched; p++)
+	if (strcmp (argv[i], kCrossfeedPresetNames[p]) == 0)
+	  {
+	    config->preset = p;
+	    matched = true;
+	  }
+      if (!matched)
+	return -1;
+    }
+  return 0;
+}
+
+int
+crossfeed_command (int argc, char *argv[])
+{
+  IPCClientContext ctx;
+  if (ipc_client_init (&ctx) != 0)
+    {
+      printf ("❌ 初始化 IPC 客户端失败\n");
+      return 1;
+    }
+
+  if (ipc_client_connect (&ctx) != 0)
+    {
+      printf ("⚠️  IPC 服务未运行，请使用: audioctl --start-service 启动服务\n");
+      ipc_client_cleanup (&ctx);
+      return 1;
+    }
+
+  IPCCrossfeedConfig config;
+  int result = 0;
+  if (ipc_client_get_crossfeed (&ctx, &config) != 0
+      || !ipc_crossfeed_config_is_valid (&config))
+    {
+      printf ("❌ 获取交叉馈送配置失败\n");
+      result = 1;
+    }
+  else if (argc >= 3)
+    {
+      if (parse_crossfeed_args (&config, argc, argv) != 0)
+	{
+	  print_crossfeed_usage ();
+	  result = 1;
+	}
+      else if (ipc_client_set_crossfeed (&ctx, &config) != 0)
+	{
+	  printf ("❌ 设置交叉馈送失败\n");
+	  result = 1;
+	}
+    }
+
+  ipc_client_disconnect (&ctx);
+  ipc_client_cleanup (&ctx);
+
+  if (result == 0)
+    print_crossfeed_config (&config);
+  return result;
+}
+
+// ====== 频谱分析 ======
+
+// watch 显示的电平范围 (dBFS)，低于下限显示为空白
+#define SPECTRUM_WATCH_FLOOR_DB -90.0f
+
+static void
+print_spectrum_usage (void)
+{
+  printf ("用法:\n");
+  printf ("  audioctl spectrum                  显示当前配置\n");
+  printf ("  audioctl spectrum size <点数>      变换长度 (%d-%d，2 的幂)\n",
+	  IPC_SPECTRUM_MIN_SIZE, IPC_SPECTRUM_MAX_SIZE);
+  printf ("  audioctl spectrum bands <数量>     对数频带数 (1-%d)\n",
+	  IPC_SPECTRUM_MAX_BANDS);
+  printf ("  audioctl spectrum fps <帧率>       帧率上限 (1-%d)\n",
+	  IPC_SPECTRUM_MAX_FPS);
+  printf ("  audioctl spectrum decimate <倍数>  分析前抽取 (1/2/4/8)\n");
+  printf ("  audioctl spectrum reset            恢复默认 (2048 点、64 频带、"
+	  "30 帧/秒、不抽取)\n");
+  printf ("  audioctl spectrum watch [秒]       在终端显示实时频谱\n");
+  printf ("可组合使用，例如: audioctl spectrum size 4096 decimate 4\n");
+  printf ("抽取降低分析采样率，同样的点数下低频分辨率更高、最高频率更低\n");
+}
+
+static void
+print_spectrum_config (const IPCSpectrumConfig *config)
+{
+  printf ("📈 频谱分析: %u 点 | %u 频带 | 最多 %u 帧/秒 | 抽取 %u 倍\n",
+	  config->fft_size, config->band_count, config->fps,
+	  config->decimation);
+  printf ("   有订阅者时 Router 才会分析，运行 audioctl spectrum watch 查看\n");
+}
+
+// 按命令行参数修改配置，参数错误返回 -1（数值范围由调用者检查）
+static int
+parse_spectrum_args (IPCSpectrumConfig *config, int argc, char *argv[])
+{
+  for (int i = 2; i < argc; i++)
+    {
+      if (strcmp (argv[i], "reset") == 0)
+	{
+	  ipc_spectrum_config_init (config);
+	  continue;
+	}
+      if (i + 1 >= argc)
+	return -1;
+      char *end = NULL;
+      long value = strtol (argv[i + 1], &end, 10);
+      if (end == argv[i + 1] || *end != '\0')
+	return -1;
+      // 超出字段宽度的值记为 0，由有效性检查拒绝
+      if (strcmp (argv[i], "size") == 0)
+	config->fft_size = value > 0 && value <= UINT16_MAX ? value : 0;
+      else if (strcmp (argv[i], "bands") == 0)
+	config->band_count = value > 0 && value <= UINT8_MAX ? value : 0;
+      else if (strcmp (argv[i], "fps") == 0)
+	config->fps = value > 0 && value <= UINT8_MAX ? value : 0;
+      else if (strcmp (argv[i], "decimate") == 0)
+	config->decimation = value > 0 && value <= UINT8_MAX ? value : 0;
+      else
+	return -1;
+      i++;
+    }
+  return 0;
+}
+
+// watch 收到的帧数（事件回调在客户端 IO 线程）
+static atomic_uint g_spectrum_watch_frames;
+static volatile sig_atomic_t g_spectrum_watch_stop = 0;
+
+static void
+spectrum_watch_signal (int sig)
+{
+  (void) sig;
+  g_spectrum_watch_stop = 1;
+}
+
+// 把一帧画成一行：每个频带一个字符，按电平选八级方块之一
+static void
+spectrum_watch_event (void *user_data, uint32_t topic, const void *data,
+		      uint32_t data_len)
+{
+  (void) user_data;
+  static const char *const kLevels[]
+    = {" ", "▁", "▂", "▃", "▄", "▅", "▆", "▇", "█"};
+  const IPCSpectrumFrame *frame = data;
+  if (topic != kIPCEventTopicSpectrumFrame
+      || !ipc_spectrum_frame_is_valid (frame, data_len)
+      || frame->band_count == 0)
+    return;
+
+  float bands[IPC_SPECTRUM_MAX_BANDS];
+  memcpy (bands, frame->bands, frame->band_count * sizeof (float));
+  char line[IPC_SPECTRUM_MAX_BANDS * 3 + 1];
+  size_t pos = 0;
+  uint32_t peak = 0;
+  for (uint32_t b = 0; b < frame->band_count; b++)
+    {
+      float level = (bands[b] - SPECTRUM_WATCH_FLOOR_DB)
+		    / -SPECTRUM_WATCH_FLOOR_DB * 8.0f;
+      int index = level >= 8.0f ? 8 : level > 0.0f ? (int) ceilf (level) : 0;
+      size_t len = strlen (kLevels[index]);
+      memcpy (line + pos, kLevels[index], len);
+      pos += len;
+      if (bands[b] > bands[peak])
+	peak = b;
+    }
+  line[pos] = '\0';
+
+  // 峰值频带的几何中心频率
+  float ratio = frame->max_freq / frame->min_freq;
+  float center = frame->min_freq
+		 * powf (ratio, (peak + 0.5f) / frame->band_count);
+  printf ("\r%s │ 峰值 %6.1f dB @ %5.0f Hz", line, bands[peak], center);
+  fflush (stdout);
+  atomic_fetch_add (&g_spectrum_watch_frames, 1);
+}
+
+// 订阅频谱帧并逐帧刷新同一行，seconds 为 0 时直到 Ctrl+C
+static int
+spectrum_watch (uint32_t seconds)
+{
+  IPCAsyncClient client;
+  if (ipc_async_client_init (&client, spectrum_watch_event, NULL) != 0)
+    {
+      printf ("❌ 初始化 IPC 客户端失败\n");
+      return 1;
+    }
+  if (ipc_async_client_connect (&client) != 0)
+    {
+      printf ("⚠️  IPC 服务未运行，请使用: audioctl --start-service 启动服务\n");
+      ipc_async_client_cleanup (&client);
+      return 1;
+    }
+
+  atomic_store (&g_spectrum_watch_frames, 0);
+  g_spectrum_watch_stop = 0;
+  void (*previous) (int) = signal (SIGINT, spectrum_watch_signal);
+  ipc_async_client_subscribe (&client, kIPCEventTopicSpectrumFrame, NULL,
+			      NULL);
+  printf ("📈 实时频谱 (%.0f ~ 0 dBFS)，按 Ctrl+C 退出\n",
+	  SPECTRUM_WATCH_FLOOR_DB);
+
+  // Router 每秒询问一次订阅者，首帧最多晚到约 1 秒
+  const struct timespec tick = {0, 100000000L};
+  bool warned = false;
+  for (uint32_t elapsed_ms = 0;
+       !g_spectrum_watch_stop && (seconds == 0 || elapsed_ms < seconds * 1000);
+       elapsed_ms += 100)
+    {
+      nanosleep (&tick, NULL);
+      if (!warned && elapsed_ms >= 3000
+	  && atomic_load (&g_spectrum_watch_frames) == 0)
+	{
+	  printf ("⚠️  尚未收到频谱帧，请确认 Router 正在运行\n");
+	  fflush (stdout);
+	  warned = true;
+	}
+      if (!ipc_async_client_is_connected (&client))
+	break;
+    }
+
+  signal (SIGINT, previous);
+  ipc_async_client_cleanup (&client);
+  printf ("\n共收到 %u 帧\n", atomic_load (&g_spectrum_watch_frames));
+  return 0;
+}
+
+int
+spectrum_command (int argc, char *argv[])
+{
+  if (argc >= 3 && strcmp (argv[2], "watch") == 0)
+    {
+      long seconds = argc >= 4 ? strtol (argv[3], NULL, 10) : 0;
+      if (argc > 4 || seconds < 0 || seconds > 86400)
+	{
+	  print_spectrum_usage ();
+	  return 1;
+	}
+      return spectrum_watch ((uint32_t) seconds);
+    }
+
+  IPCClientContext ctx;
+  if (ipc_client_init (&ctx) != 0)
+    {
+      printf ("❌ 初始化 IPC 客户端失败\n");
+      return 1;
+    }
+
+  if (ipc_client_connect (&ctx) != 0)
+    {
+      printf ("⚠️  IPC 服务未运行，请使用: audioctl --start-service 启动服务\n");
+      ipc_client_cleanup (&ctx);
+      return 1;
+    }
+
+  IPCSpectrumConfig config;
+  int result = 0;
+  if (ipc_client_get_spectrum (&ctx, &config) != 0
+      || !ipc_spectrum_config_is_valid (&config))
+    {
+      printf ("❌ 获取频谱分析配置失败\n");
+      result = 1;
+    }
+  else if (argc >= 3)
+    {
+      if (parse_spectrum_args (&config, argc, argv) != 0)
+	{
+	  print_spectrum_usage ();
+	  result = 1;
+	}
+      else if (!ipc_spectrum_config_is_valid (&config))
+	{
+	  printf ("❌ 参数超出范围\n");
+	  print_spectrum_usage ();
+	  result = 1;
+	}
+      else if (ipc_client_set_spectrum (&ctx, &config) != 0)
+	{
+	  printf ("❌ 设置频谱分析失败\n");
+	  result = 1;
+	}
+    }
+
+  ipc_client_disconnect (&ctx);
+  ipc_client_cleanup (&ctx);
+
+  if (result == 0)
+    print_spectrum_config (&config);
+  return result;
+}
+
+// ====== 录音 ======
+
+// 默认录音目录（相对主目录）
+#define RECORD_DEFAULT_DIR "Music/audioctl"
+// 等待 Router 处理请求的时间
+#define RECORD_WAIT_MS 2000
+
+static const char *const kRecordFormatNames[kIPCRecordFormatCount]
+  = {"wav", "caf"};
+
+static void
+print_record_usage (void)
+{
+  printf ("用法:\n");
+  printf ("  audioctl record                         显示录音状态\n");
+  printf ("  audioctl record start [目录] [wav|caf]  开始录音（默认 ~/%s、"
+	  "wav）\n",
+	  RECORD_DEFAULT_DIR);
+  printf ("  audioctl record rotate                  换新文件继续录音\n");
+  printf ("  audioctl record stop                    停止录音\n");
+  printf ("录音内容为 Router 送往输出设备的信号（DSP 链之后），32 位 float；\n");
+  printf ("WAV 单个文件到 4 GB 时自动换文件，意外退出时已写入的部分仍可播放\n");
+}
+
+static void
+print_record_status (const IPCRecordReport *report)
+{
+  const IPCRecordStatus *status = &report->status;
+  if (!report->status_valid)
+    {
+      printf ("⏹️  录音: %s（Router 尚未上报状态）\n",
+	      report->config.recording ? "已请求开始" : "未在录音");
+      return;
+    }
+  if (status->recording)
+    {
+      double seconds = status->sample_rate > 0
+			 ? (double) status->frames / status->sample_rate
+			 : 0.0;
+      printf ("⏺️  录音中: %s\n", status->path);
+      printf ("   %s | %u Hz %u 声道 | 已录 %.1f 秒 | 本次启动共 %u 个文件\n",
+	      status->format == kIPCRecordCaf ? "CAF" : "WAV",
+	      status->sample_rate, status->channels, seconds, status->files);
+    }
+  else
+    {
+      printf ("⏹️  未在录音\n");
+      if (status->path[0] != '\0')
+	printf ("   最近的文件: %s\n", status->path);
+    }
+  if (status->error != 0)
+    printf ("   ⚠️  最近一次失败: %s\n", strerror (status->error));
+  if (status->dropped_blocks > 0)
+    printf ("   ⚠️  写盘跟不上，已丢弃 %u 块（%.2f 秒）\n",
+	    status->dropped_blocks,
+	    status->sample_rate > 0
+	      ? (double) status->dropped_frames / status->sample_rate
+	      : 0.0);
+}
+
+// 解析 start 的参数（目录和格式，顺序不限），参数错误返回 -1
+static int
+parse_record_start (IPCRecordConfig *config, int argc, char *argv[])
+{
+  const char *dir = NULL;
+  config->format = kIPCRecordWav;
+  for (int i = 3; i < argc; i++)
+    {
+      bool matched = false;
+      for (uint8_t f = 0; f < kIPCRecordFormatCount && !matched; f++)
+	if (strcasecmp (argv[i], kRecordFormatNames[f]) == 0)
+	  {
+	    config->format = f;
+	    matched = true;
+	  }
+      if (!matched)
+	{
+	  if (dir != NULL)
+	    return -1;
+	  dir = argv[i];
+	}
+    }
+
+  char fallback[PATH_MAX];
+  if (dir == NULL)
+    {
+      const char *home = getenv ("HOME");
+      if (home == NULL || home[0] != '/')
+	{
+	  printf ("❌ 无法确定主目录，请指定录音目录\n");
+	  return -1;
+	}
+      // 逐级创建 ~/Music/audioctl
+      snprintf (fallback, sizeof (fallback), "%s/Music", home);
+      mkdir (fallback, 0755);
+      snprintf (fallback, sizeof (fallback), "%s/%s", home,
+		RECORD_DEFAULT_DIR);
+      mkdir (fallback, 0755);
+      dir = fallback;
+    }
+
+  // Router 在另一个进程中创建文件，统一转换为绝对路径
+  char resolved[PATH_MAX];
+  struct stat st;
+  if (realpath (dir, resolved) == NULL || stat (resolved, &st) != 0
+      || !S_ISDIR (st.st_mode)
+      || strlen (resolved) >= sizeof (config->directory))
+    {
+      printf ("❌ 目录不存在: %s\n", dir);
+      return -1;
+    }
+  strcpy (config->directory, resolved);
+  config->recording = 1;
+  return 0;
+}
+
+// 等待 Router 上报处理完 generation 号请求后的状态
+static bool
+wait_record_applied (IPCClientContext *ctx, uint32_t generation,
+		     IPCRecordReport *report)
+{
+  for (int waited = 0; waited <= RECORD_WAIT_MS; waited += 50)
+    {
+      if (ipc_client_get_recording (ctx, report) == 0 && report->status_valid
+	  && report->status.generation == generation)
+	return true;
+      struct timespec ts = {0, 50 * 1000000L};
+      nanosleep (&ts, NULL);
+    }
+  return false;
+}
+
+int
+record_command (int argc, char *argv[])
+{
+  const char *sub = argc >= 3 ? argv[2] : NULL;
+  if (sub != NULL && strcmp (sub, "start") != 0 && strcmp (sub, "stop") != 0
+      && strcmp (sub, "rotate") != 0)
+    {
+      print_record_usage ();
+      return 1;
+    }
+  if (sub != NULL && strcmp (sub, "start") != 0 && argc > 3)
+    {
+      print_record_usage ();
+      return 1;
+    }
+
+  IPCClientContext ctx;
+  if (ipc_client_init (&ctx) != 0)
+    {
+      printf ("❌ 初始化 IPC 客户端失败\n");
+      return 1;
+    }
+
+  if (ipc_client_connect (&ctx) != 0)
+    {
+      printf ("⚠️  IPC 服务未运行，请使用: audioctl --start-service 启动服务\n");
+      ipc_client_cleanup (&ctx);
+      return 1;
+    }
+
+  IPCRecordReport report;
+  int result = 0;
+  if (ipc_client_get_recording (&ctx, &report) != 0
+      || !ipc_record_config_is_valid (&report.config))
+    {
+      printf ("❌ 获取录音状态失败\n");
+      result = 1;
+    }
+  else if (sub != NULL)
+    {
+      IPCRecordConfig config = report.config;
+      uint32_t generation = 0;
+      if (strcmp (sub, "start") == 0)
+	{
+	  if (parse_record_start (&config, argc, argv) != 0)
+	    result = 1;
+	}
+      else if (strcmp (sub, "stop") == 0)
+	config.recording = 0;
+      else if (!config.recording)
+	{
+	  // 换文件就是用同一目录再开始一次
+	  printf ("❌ 未在录音\n");
+	  result = 1;
+	}
+
+      if (result == 0 && ipc_client_set_recording (&ctx, &config, &generation) != 0)
+	{
+	  printf ("❌ 发送录音请求失败\n");
+	  result = 1;
+	}
+      else if (result == 0 && !wait_record_applied (&ctx, generation, &report))
+	{
+	  printf ("⚠️  Router 未响应，请求已保存，Router 启动后生效\n");
+	  result = 1;
+	}
+      else if (result == 0 && config.recording && !report.status.recording)
+	{
+	  printf ("❌ 无法开始录音: %s\n", strerror (report.status.error));
+	  result = 1;
+	}
+    }
+
+  ipc_client_disconnect (&ctx);
+  ipc_client_cleanup (&ctx);
+
+  if (result == 0)
+    print_record_status (&report);
+  return result;
+}
+
+// ====== 网络推流 ======
+
+static void
+print_stream_usage (void)
+{
+  printf ("用法:\n");
+  printf ("  audioctl stream                        显示当前配置\n");
+  printf ("  audioctl stream to <主机>[:端口]       开始推流（默认端口 %d）\n",
+	  IPC_STREAM_DEFAULT_PORT);
+  printf ("  audioctl stream ptime <毫秒>           包时长 (%d-%d)\n",
+	  IPC_STREAM_MIN_PTIME_MS, IPC_STREAM_MAX_PTIME_MS);
+  printf ("  audioctl stream off                    停止推流\n");
+  printf ("可组合使用，例如: audioctl stream to 192.168.1.20 ptime 1\n");
+  printf ("在接收端运行 audioctl receive 播放\n");
+}
+
+static void
+print_stream_config (const IPCStreamConfig *config)
+{
+  if (config->enabled)
+    printf ("📡 网络推流: RTP -> %s:%u | 包时长 %u ms\n", config->host,
+	    config->port, config->ptime_ms);
+  else
+    printf ("📡 网络推流: 已关闭 | 包时长 %u ms\n", config->ptime_ms);
+}
+
+// 解析 <主机>[:端口]，参数错误返回 -1
+static int
+parse_stream_target (IPCStreamConfig *config, const char *target)
+{
+  const char *colon = strrchr (target, ':');
+  size_t host_len = colon != NULL ? (size_t) (colon - target) : strlen (target);
+  if (host_len == 0 || host_len >= sizeof (config->host))
+    return -1;
+  config->port = IPC_STREAM_DEFAULT_PORT;
+  if (colon != NULL)
+    {
+      char *end = NULL;
+      long port = strtol (colon + 1, &end, 10);
+      if (end == colon + 1 || *end != '\0' || port <= 0 || port > UINT16_MAX)
+	return -1;
+      config->port = (uint16_t) port;
+    }
+  memcpy (config->host, target, host_len);
+  config->host[host_len] = '\0';
+  return 0;
+}
+
+// 按命令行参数修改配置，参数错误返回 -1（数值范围由调用者检查）
+static int
+parse_stream_args (IPCStreamConfig *config, int argc, char *argv[])
+{
+  for (int i = 2; i < argc; i++)
+    {
+      if (strcmp (argv[i], "off") == 0)
+	{
+	  config->enabled = 0;
+	  continue;
+	}
+      if (i + 1 >= argc)
+	return -1;
+      if (strcmp (argv[i], "to") == 0)
+	{
+	  if (parse_stream_target (config, argv[i + 1]) != 0)
+	    return -1;
+	  config->enabled = 1;
+	}
+      else if (strcmp (argv[i], "ptime") == 0)
+	{
+	  char *end = NULL;
+	  long value = strtol (argv[i + 1], &end, 10);
+	  if (end == argv[i + 1] || *end != '\0')
+	    return -1;
+	  config->ptime_ms = value > 0 && value <= UINT8_MAX ? value : 0;
+	}
+      else
+	return -1;
+      i++;
+    }
+  return 0;
+}
+
+int
+stream_command (int argc, char *argv[])
+{
+  IPCClientContext ctx;
+  if (ipc_client_init (&ctx) != 0)
+    {
+      printf ("❌ 初始化 IPC 客户端失败\n");
+      return 1;
+    }
+
+  if (ipc_client_connect (&ctx) != 0)
+    {
+      printf ("⚠️  IPC 服务未运行，请使用: audioctl --start-service 启动服务\n");
+      ipc_client_cleanup (&ctx);
+      return 1;
+    }
+
+  IPCStreamConfig config;
+  int result = 0;
+  if (ipc_client_get_stream (&ctx, &config) != 0
+      || !ipc_stream_config_is_valid (&config))
+    {
+      printf ("❌ 获取网络推流配置失败\n");
+      result = 1;
+    }
+  else if (argc >= 3)
+    {
+      if (parse_stream_args (&config, argc, argv) != 0
+	  || !ipc_stream_config_is_valid (&config))
+	{
+	  print_stream_usage ();
+	  result = 1;
+	}
+      else if (ipc_client_set_stream (&ctx, &config) != 0)
+	{
+	  printf ("❌ 设置网络推流失败\n");
+	  result = 1;
+	}
+    }
+
+  ipc_client_disconnect (&ctx);
+  ipc_client_cleanup (&ctx);
+
+  if (result == 0)
+    print_stream_config (&config);
+  return result;
+}
+
+static void
+print_receive_usage (void)
+{
+  printf ("用法:\n");
+  printf ("  audioctl receive [端口] [latency <毫秒>] [秒]\n");
+  printf ("在默认输出设备上播放 audioctl stream 推送的音频（默认端口 %d、"
+	  "目标延迟 %d ms，秒数省略时直到 Ctrl+C）\n",
+	  IPC_STREAM_DEFAULT_PORT, ROUTER_RTP_DEFAULT_LATENCY_MS);
+  printf ("有线局域网一般 10-20 ms 即可，Wi-Fi 建议 40 ms 以上\n");
+}
+
+// 整个字符串都是十进制整数时返回 true
+static bool
+parse_receive_number (const char *text, long *value)
+{
+  char *end = NULL;
+  *value = strtol (text, &end, 10);
+  return end != text && *end == '\0';
+}
+
+int
+receive_command (int argc, char *argv[])
+{
+  long port = IPC_STREAM_DEFAULT_PORT;
+  long latency_ms = ROUTER_RTP_DEFAULT_LATENCY_MS;
+  long seconds = 0;
+  int positional = 0;
+  bool ok = true;
+  for (int i = 2; i < argc && ok; i++)
+    {
+      if (strcmp (argv[i], "latency") == 0)
+	ok = i + 1 < argc && parse_receive_number (argv[++i], &latency_ms);
+      else if (positional == 0)
+	ok = parse_receive_number (argv[i], &port) && ++positional;
+      else if (positional == 1)
+	ok = parse_receive_number (argv[i], &seconds) && ++positional;
+      else
+	ok = false;
+    }
+  if (!ok || port <= 0 || port > UINT16_MAX || latency_ms < 1
+      || latency_ms > ROUTER_RTP_MAX_LATENCY_MS || seconds < 0
+      || seconds > UINT32_MAX)
+    {
+      print_receive_usage ();
+      return 1;
+    }
+  return stream_receiver_run ((uint16_t) port, (uint32_t) latency_ms,
+			      (uint32_t) seconds)
+	     == 0
+	   ? 0
+	   : 1;
+}
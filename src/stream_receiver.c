@@ -0,0 +1,199 @@
+//
+// 网络推流接收端
+//
+
+#include "stream_receiver.h"
+#include "router/router_rtp.h"
+#include <CoreAudio/CoreAudio.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define RECEIVER_POLL_TIMEOUT_MS 100 // 网络线程检查退出标志的间隔
+#define RECEIVER_CHUNK_FRAMES 1024   // IOProc 每次从接收端读取的帧数上限
+
+static RouterRtpReceiver g_receiver;
+static _Atomic bool g_receiver_running = false;
+static volatile sig_atomic_t g_receiver_stop = 0;
+
+static void
+receiver_signal (int sig)
+{
+  (void) sig;
+  g_receiver_stop = 1;
+}
+
+// 网络线程：批量收包放进接收端的包队列
+static void *
+receiver_network_thread (void *arg)
+{
+  (void) arg;
+  while (atomic_load (&g_receiver_running))
+    if (router_rtp_receiver_poll (&g_receiver, RECEIVER_POLL_TIMEOUT_MS) < 0)
+      {
+	struct timespec ts = {0, RECEIVER_POLL_TIMEOUT_MS * 1000000L};
+	nanosleep (&ts, NULL);
+      }
+  return NULL;
+}
+
+// 输出 IOProc：接收端输出立体声，按设备声道数展开（多出的声道填 0，
+// 单声道设备取平均）
+static OSStatus
+receiver_output_callback (AudioObjectID inDevice, const AudioTimeStamp *inNow,
+			  const AudioBufferList *inInputData,
+			  const AudioTimeStamp *inInputTime,
+			  AudioBufferList *outOutputData,
+			  const AudioTimeStamp *inOutputTime,
+			  void *inClientData)
+{
+  (void) inDevice;
+  (void) inNow;
+  (void) inInputData;
+  (void) inInputTime;
+  (void) inOutputTime;
+  (void) inClientData;
+
+  if (outOutputData->mNumberBuffers == 0)
+    return noErr;
+  AudioBuffer *buffer = &outOutputData->mBuffers[0];
+  uint32_t channels = buffer->mNumberChannels;
+  if (buffer->mData == NULL || channels == 0)
+    return noErr;
+  float *dst = (float *) buffer->mData;
+  uint32_t frames = buffer->mDataByteSize / (channels * sizeof (float));
+
+  float chunk[RECEIVER_CHUNK_FRAMES * ROUTER_MAX_CHANNELS];
+  while (frames > 0)
+    {
+      uint32_t n = frames < RECEIVER_CHUNK_FRAMES ? frames
+						  : RECEIVER_CHUNK_FRAMES;
+      router_rtp_receiver_read (&g_receiver, chunk, n);
+      for (uint32_t f = 0; f < n; f++)
+	{
+	  const float *src = chunk + (size_t) f * ROUTER_MAX_CHANNELS;
+	  if (channels == 1)
+	    dst[f] = 0.5f * (src[0] + src[1]);
+	  else
+	    for (uint32_t c = 0; c < channels; c++)
+	      dst[(size_t) f * channels + c] = c < ROUTER_MAX_CHANNELS ? src[c]
+								     : 0.0f;
+	}
+      dst += (size_t) n * channels;
+      frames -= n;
+    }
+  return noErr;
+}
+
+static AudioDeviceID
+get_default_output_device (void)
+{
+  AudioObjectPropertyAddress addr
+    = {kAudioHardwarePropertyDefaultOutputDevice,
+       kAudioObjectPropertyScopeGlobal, kAudioObjectPropertyElementMain};
+  AudioDeviceID device = kAudioObjectUnknown;
+  UInt32 size = sizeof (device);
+  if (AudioObjectGetPropertyData (kAudioObjectSystemObject, &addr, 0, NULL,
+				  &size, &device)
+      != noErr)
+    return kAudioObjectUnknown;
+  return device;
+}
+
+static uint32_t
+get_device_sample_rate (AudioDeviceID device)
+{
+  AudioObjectPropertyAddress addr
+    = {kAudioDevicePropertyNominalSampleRate, kAudioObjectPropertyScopeGlobal,
+       kAudioObjectPropertyElementMain};
+  Float64 rate = 0;
+  UInt32 size = sizeof (rate);
+  if (AudioObjectGetPropertyData (device, &addr, 0, NULL, &size, &rate)
+      != noErr)
+    return 0;
+  return (uint32_t) rate;
+}
+
+int
+stream_receiver_run (uint16_t port, uint32_t latency_ms, uint32_t seconds)
+{
+  AudioDeviceID device = get_default_output_device ();
+  uint32_t output_rate = get_device_sample_rate (device);
+  if (device == kAudioObjectUnknown || output_rate == 0)
+    {
+      printf ("❌ 无法获取默认输出设备\n");
+      return -1;
+    }
+  if (router_rtp_receiver_init (&g_receiver, port, output_rate,
+				ROUTER_MAX_CHANNELS, latency_ms)
+      != 0)
+    {
+      printf ("❌ 无法监听 UDP 端口 %u\n", port);
+      return -1;
+    }
+
+  AudioDeviceIOProcID proc_id = NULL;
+  pthread_t network_thread;
+  atomic_store (&g_receiver_running, true);
+  if (pthread_create (&network_thread, NULL, receiver_network_thread, NULL)
+      != 0)
+    {
+      printf ("❌ 无法创建网络线程\n");
+      router_rtp_receiver_destroy (&g_receiver);
+      return -1;
+    }
+  OSStatus status = AudioDeviceCreateIOProcID (
+    device, receiver_output_callback, NULL, &proc_id);
+  if (status == noErr)
+    status = AudioDeviceStart (device, proc_id);
+  if (status != noErr)
+    {
+      printf ("❌ 无法启动输出设备: %d\n", status);
+      if (proc_id != NULL)
+	AudioDeviceDestroyIOProcID (device, proc_id);
+      atomic_store (&g_receiver_running, false);
+      pthread_join (network_thread, NULL);
+      router_rtp_receiver_destroy (&g_receiver);
+      return -1;
+    }
+
+  printf ("📡 正在 UDP %u 端口接收 | 目标延迟 %u ms | 输出 %u Hz\n",
+	  g_receiver.port, latency_ms, output_rate);
+  printf ("   在发送端运行: audioctl stream to <本机地址>:%u\n",
+	  g_receiver.port);
+  printf ("   按 Ctrl+C 停止\n");
+
+  g_receiver_stop = 0;
+  signal (SIGINT, receiver_signal);
+  signal (SIGTERM, receiver_signal);
+  for (uint32_t elapsed = 0;
+       !g_receiver_stop && (seconds == 0 || elapsed < seconds); elapsed++)
+    {
+      struct timespec ts = {1, 0};
+      nanosleep (&ts, NULL);
+      RouterRtpReceiverStats stats;
+      router_rtp_receiver_get_stats (&g_receiver, &stats);
+      if (stats.sample_rate == 0)
+	printf ("\r⏳ 等待数据...");
+      else
+	printf ("\r%s %u Hz | 缓冲 %5.1f ms | 漂移 %+7.1f ppm | 包 %llu | "
+		"丢失 %u | 迟到 %u | 欠载 %u | 重新同步 %u   ",
+		stats.playing ? "▶️ " : "⏳", stats.sample_rate, stats.fill_ms,
+		stats.drift_ppm, (unsigned long long) stats.packets, stats.lost,
+		stats.late, stats.underruns, stats.resets);
+      fflush (stdout);
+    }
+  printf ("\n");
+  signal (SIGINT, SIG_DFL);
+  signal (SIGTERM, SIG_DFL);
+
+  AudioDeviceStop (device, proc_id);
+  AudioDeviceDestroyIOProcID (device, proc_id);
+  atomic_store (&g_receiver_running, false);
+  pthread_join (network_thread, NULL);
+  router_rtp_receiver_destroy (&g_receiver);
+  return 0;
+}
@@ -0,0 +1,141 @@
+//
+// 驱动端应用音量管理测试
+//
+
+#include "driver/app_volume_driver.h"
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+static uint64_t
+now_ms (void)
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000 + (uint64_t) ts.tv_nsec / 1000000;
+}
+
+static int
+test_driver_client_table (void)
+{
+  printf ("  Testing driver client table...\n");
+
+  app_volume_driver_init ();
+  pid_t pid = getpid ();
+
+  if (app_volume_driver_add_client (101, pid, "com.test.driver", NULL)
+	!= noErr
+      || app_volume_driver_add_client (102, pid, "com.test.driver", NULL)
+	   != noErr)
+    {
+      printf ("    ❌ FAIL: add_client failed\n");
+      app_volume_driver_cleanup ();
+      return 1;
+    }
+
+  if (app_volume_driver_get_pid (101) != pid
+      || app_volume_driver_get_pid (102) != pid)
+    {
+      printf ("    ❌ FAIL: get_pid returned wrong PID\n");
+      app_volume_driver_cleanup ();
+      return 1;
+    }
+
+  app_volume_driver_remove_client (101);
+  if (app_volume_driver_get_pid (101) != -1
+      || app_volume_driver_get_pid (102) != pid)
+    {
+      printf ("    ❌ FAIL: remove_client affected the wrong slot\n");
+      app_volume_driver_cleanup ();
+      return 1;
+    }
+
+  if (app_volume_driver_remove_client (101) == noErr)
+    {
+      printf ("    ❌ FAIL: Removing twice should fail\n");
+      app_volume_driver_cleanup ();
+      return 1;
+    }
+
+  app_volume_driver_remove_client (102);
+  app_volume_driver_cleanup ();
+  printf ("    ✅ PASS: Client table correct\n");
+  return 0;
+}
+
+static int
+test_driver_unknown_client_volume (void)
+{
+  printf ("  Testing get_volume for unknown client...\n");
+
+  app_volume_driver_init ();
+
+  bool muted = true;
+  Float32 volume = app_volume_driver_get_volume (9999, &muted);
+  app_volume_driver_cleanup ();
+
+  if (volume != 1.0f || muted)
+    {
+      printf ("    ❌ FAIL: Unknown client should use unity gain\n");
+      return 1;
+    }
+
+  printf ("    ✅ PASS: Unknown client uses unity gain\n");
+  return 0;
+}
+
+static int
+test_driver_cleanup_latency (void)
+{
+  printf ("  Testing connection manager shutdown latency...\n");
+
+  app_volume_driver_init ();
+  usleep (300 * 1000); // 让连接管理线程进入等待或退避
+
+  uint64_t start = now_ms ();
+  app_volume_driver_cleanup ();
+  uint64_t elapsed = now_ms () - start;
+
+  if (elapsed > 200)
+    {
+      printf ("    ❌ FAIL: Cleanup took %llu ms\n",
+	      (unsigned long long) elapsed);
+      return 1;
+    }
+
+  if (app_volume_driver_is_connected ())
+    {
+      printf ("    ❌ FAIL: Should report disconnected after cleanup\n");
+      return 1;
+    }
+
+  printf ("    ✅ PASS: Cleanup returned in %llu ms\n",
+	  (unsigned long long) elapsed);
+  return 0;
+}
+
+int
+run_app_volume_driver_tests (void)
+{
+  printf ("\n----------------------------------------\n");
+  printf ("App Volume Driver Tests\n");
+  printf ("----------------------------------------\n");
+
+  int failed = 0;
+  failed += test_driver_client_table ();
+  failed += test_driver_unknown_client_volume ();
+  failed += test_driver_cleanup_latency ();
+
+  printf ("----------------------------------------\n");
+  if (failed == 0)
+    {
+      printf ("App Volume Driver Tests: PASSED ✅\n");
+    }
+  else
+    {
+      printf ("App Volume Driver Tests: %d FAILED ❌\n", failed);
+    }
+  printf ("----------------------------------------\n");
+
+  return failed;
+}
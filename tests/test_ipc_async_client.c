@@ -0,0 +1,636 @@
+//
+// 异步 IPC 客户端测试
+//
+
+#include "ipc/ipc_async_client.h"
+#include "ipc/ipc_server.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+static int
+test_ipc_async_client_init (void)
+{
+  printf ("  Testing ipc_async_client_init...\n");
+
+  IPCAsyncClient client;
+  if (ipc_async_client_init (&client, NULL, NULL) != 0)
+    {
+      printf ("    ❌ FAIL: ipc_async_client_init failed\n");
+      return 1;
+    }
+
+  if (client.fd != -1 || ipc_async_client_is_connected (&client))
+    {
+      printf ("    ❌ FAIL: Should not be connected initially\n");
+      ipc_async_client_cleanup (&client);
+      return 1;
+    }
+
+  if (client.pending_count != 0 || client.next_request_id == 0)
+    {
+      printf ("    ❌ FAIL: Pending table not reset\n");
+      ipc_async_client_cleanup (&client);
+      return 1;
+    }
+
+  ipc_async_client_cleanup (&client);
+  printf ("    ✅ PASS: Async client initialization correct\n");
+  return 0;
+}
+
+static int
+test_ipc_async_request_disconnected (void)
+{
+  printf ("  Testing ipc_async_client_request when disconnected...\n");
+
+  IPCAsyncClient client;
+  ipc_async_client_init (&client, NULL, NULL);
+
+  uint32_t request_id = 0;
+  int result = ipc_async_client_request (&client, kIPCCommandPing, NULL, 0,
+					 NULL, NULL, &request_id);
+  if (result == 0)
+    {
+      printf ("    ❌ FAIL: Request should fail when disconnected\n");
+      ipc_async_client_cleanup (&client);
+      return 1;
+    }
+
+  if (client.pending_count != 0)
+    {
+      printf ("    ❌ FAIL: Failed request must not occupy a pending slot\n");
+      ipc_async_client_cleanup (&client);
+      return 1;
+    }
+
+  ipc_async_client_cleanup (&client);
+  printf ("    ✅ PASS: Disconnected request rejected\n");
+  return 0;
+}
+
+static int
+test_ipc_async_future_timeout (void)
+{
+  printf ("  Testing ipc_async_future_wait timeout...\n");
+
+  IPCAsyncFuture future;
+  ipc_async_future_init (&future);
+
+  if (ipc_async_future_wait (&future, 10))
+    {
+      printf ("    ❌ FAIL: Unresolved future should time out\n");
+      ipc_async_future_destroy (&future);
+      return 1;
+    }
+
+  ipc_async_future_destroy (&future);
+  printf ("    ✅ PASS: Future wait times out\n");
+  return 0;
+}
+
+// ====== 进程内对端 ======
+
+static uint64_t
+now_ms (void)
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000 + (uint64_t) ts.tv_nsec / 1000000;
+}
+
+// 测试期间把客户端指向临时 socket
+typedef struct
+{
+  char path[128];
+  char saved[1024];
+  bool had_saved;
+} SocketEnv;
+
+static void
+socket_env_enter (SocketEnv *env, const char *tag)
+{
+  snprintf (env->path, sizeof (env->path), "/tmp/audioctl_async_%s_%d.sock",
+	    tag, (int) getpid ());
+  const char *saved = getenv (IPC_SOCKET_PATH_ENV);
+  env->had_saved = saved != NULL;
+  if (saved != NULL)
+    snprintf (env->saved, sizeof (env->saved), "%s", saved);
+  setenv (IPC_SOCKET_PATH_ENV, env->path, 1);
+}
+
+static void
+socket_env_leave (SocketEnv *env)
+{
+  unlink (env->path);
+  if (env->had_saved)
+    setenv (IPC_SOCKET_PATH_ENV, env->saved, 1);
+  else
+    unsetenv (IPC_SOCKET_PATH_ENV);
+}
+
+// 由测试脚本控制的对端：监听临时 socket，客户端连接后接受连接
+// （Unix socket 的 connect 在 accept 之前就会完成，不需要额外线程）
+typedef struct
+{
+  int listen_fd;
+  int fd;
+} ScriptedPeer;
+
+static int
+peer_listen (ScriptedPeer *peer, const char *path)
+{
+  peer->fd = -1;
+  peer->listen_fd = socket (AF_UNIX, SOCK_STREAM, 0);
+  struct sockaddr_un addr;
+  memset (&addr, 0, sizeof (addr));
+  addr.sun_family = AF_UNIX;
+  strncpy (addr.sun_path, path, sizeof (addr.sun_path) - 1);
+  unlink (path);
+  if (peer->listen_fd < 0
+      || bind (peer->listen_fd, (struct sockaddr *) &addr, sizeof (addr)) != 0
+      || listen (peer->listen_fd, 4) != 0)
+    return -1;
+  return 0;
+}
+
+static int
+peer_accept (ScriptedPeer *peer)
+{
+  peer->fd = accept (peer->listen_fd, NULL, NULL);
+  if (peer->fd < 0)
+    return -1;
+  struct timeval timeout = {2, 0};
+  setsockopt (peer->fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof (timeout));
+  return 0;
+}
+
+static void
+peer_close (ScriptedPeer *peer)
+{
+  if (peer->fd >= 0)
+    close (peer->fd);
+  if (peer->listen_fd >= 0)
+    close (peer->listen_fd);
+  peer->fd = -1;
+  peer->listen_fd = -1;
+}
+
+// 读取一条无负载请求的消息头
+static bool
+peer_read_request (ScriptedPeer *peer, IPCMessageHeader *header)
+{
+  size_t got = 0;
+  while (got < sizeof (*header))
+    {
+      ssize_t n = recv (peer->fd, (uint8_t *) header + got,
+			sizeof (*header) - got, 0);
+      if (n <= 0)
+	return false;
+      got += (size_t) n;
+    }
+  return ipc_validate_header (header) && header->payload_len == 0;
+}
+
+// 以附加数据 value 响应指定请求
+static bool
+peer_respond (ScriptedPeer *peer, uint32_t request_id, uint32_t value)
+{
+  uint8_t frame[sizeof (IPCMessageHeader) + sizeof (IPCResponse)
+		+ sizeof (uint32_t)];
+  IPCMessageHeader header;
+  ipc_init_header (&header, kIPCCommandResponse,
+		   sizeof (IPCResponse) + sizeof (uint32_t), request_id);
+  IPCResponse resp = {kIPCStatusOK, sizeof (uint32_t)};
+  memcpy (frame, &header, sizeof (header));
+  memcpy (frame + sizeof (header), &resp, sizeof (resp));
+  memcpy (frame + sizeof (header) + sizeof (resp), &value, sizeof (value));
+  return send (peer->fd, frame, sizeof (frame), 0) == (ssize_t) sizeof (frame);
+}
+
+// 记录回调顺序和结果
+typedef struct
+{
+  pthread_mutex_t mutex;
+  int count;
+  int order[8];	   // 按完成顺序记录的请求序号
+  int32_t status[8]; // 按请求序号记录的状态
+  uint32_t value[8]; // 按请求序号记录的附加数据
+  int calls[8];	   // 按请求序号记录的回调次数
+} CompletionLog;
+
+typedef struct
+{
+  CompletionLog *log;
+  int index;
+} CompletionTag;
+
+static void
+on_completion (void *user_data, int32_t status, const void *data,
+	       uint32_t data_len)
+{
+  CompletionTag *tag = (CompletionTag *) user_data;
+  CompletionLog *log = tag->log;
+  pthread_mutex_lock (&log->mutex);
+  if (log->count < 8)
+    log->order[log->count] = tag->index;
+  log->count++;
+  log->status[tag->index] = status;
+  log->calls[tag->index]++;
+  if (data != NULL && data_len == sizeof (uint32_t))
+    memcpy (&log->value[tag->index], data, sizeof (uint32_t));
+  pthread_mutex_unlock (&log->mutex);
+}
+
+static int
+completion_count (CompletionLog *log)
+{
+  pthread_mutex_lock (&log->mutex);
+  int count = log->count;
+  pthread_mutex_unlock (&log->mutex);
+  return count;
+}
+
+static bool
+wait_completions (CompletionLog *log, int expected, uint32_t timeout_ms)
+{
+  uint64_t deadline = now_ms () + timeout_ms;
+  while (completion_count (log) < expected)
+    {
+      if (now_ms () > deadline)
+	return false;
+      usleep (2 * 1000);
+    }
+  return true;
+}
+
+// 连接脚本对端并提交 count 个 Ping
+static int
+start_scripted (SocketEnv *env, const char *tag, ScriptedPeer *peer,
+		IPCAsyncClient *client, CompletionLog *log,
+		CompletionTag *tags, int count, uint32_t *ids)
+{
+  socket_env_enter (env, tag);
+  memset (log, 0, sizeof (*log));
+  pthread_mutex_init (&log->mutex, NULL);
+  ipc_async_client_init (client, NULL, NULL);
+  if (peer_listen (peer, env->path) != 0
+      || ipc_async_client_connect (client) != 0 || peer_accept (peer) != 0)
+    return -1;
+  for (int i = 0; i < count; i++)
+    {
+      tags[i].log = log;
+      tags[i].index = i;
+      if (ipc_async_client_request (client, kIPCCommandPing, NULL, 0,
+				    on_completion, &tags[i], &ids[i])
+	  != 0)
+	return -1;
+    }
+  return 0;
+}
+
+static void
+finish_scripted (SocketEnv *env, ScriptedPeer *peer, IPCAsyncClient *client,
+		 CompletionLog *log)
+{
+  ipc_async_client_cleanup (client);
+  peer_close (peer);
+  pthread_mutex_destroy (&log->mutex);
+  socket_env_leave (env);
+}
+
+// ====== 测试 ======
+
+static int
+test_ipc_async_out_of_order (void)
+{
+  printf ("  Testing out-of-order completion...\n");
+
+  SocketEnv env;
+  ScriptedPeer peer;
+  IPCAsyncClient client;
+  CompletionLog log;
+  CompletionTag tags[4];
+  uint32_t ids[4];
+  int failed = 0;
+  if (start_scripted (&env, "order", &peer, &client, &log, tags, 4, ids)
+      != 0)
+    {
+      printf ("    ❌ FAIL: Setup failed\n");
+      failed = 1;
+    }
+
+  // 对端收齐 4 个请求后倒序响应，附加数据为请求序号
+  IPCMessageHeader header;
+  for (int i = 0; failed == 0 && i < 4; i++)
+    if (!peer_read_request (&peer, &header) || header.request_id != ids[i])
+      {
+	printf ("    ❌ FAIL: Request %d not received in order\n", i);
+	failed = 1;
+      }
+  for (int i = 3; failed == 0 && i >= 0; i--)
+    peer_respond (&peer, ids[i], (uint32_t) i);
+
+  if (failed == 0 && !wait_completions (&log, 4, 1000))
+    {
+      printf ("    ❌ FAIL: Only %d of 4 completions\n",
+	      completion_count (&log));
+      failed = 1;
+    }
+  for (int i = 0; failed == 0 && i < 4; i++)
+    if (log.order[i] != 3 - i || log.status[i] != kIPCStatusOK
+	|| log.value[i] != (uint32_t) i || log.calls[i] != 1)
+      {
+	printf ("    ❌ FAIL: Completion %d: request %d, value %u\n", i,
+		log.order[i], log.value[i]);
+	failed = 1;
+      }
+  if (failed == 0 && client.pending_count != 0)
+    {
+      printf ("    ❌ FAIL: %u slots still pending\n", client.pending_count);
+      failed = 1;
+    }
+
+  finish_scripted (&env, &peer, &client, &log);
+  if (failed == 0)
+    printf ("    ✅ PASS: Responses matched by request id in reverse order\n");
+  return failed;
+}
+
+static int
+test_ipc_async_timeout (void)
+{
+  printf ("  Testing request timeout...\n");
+
+  SocketEnv env;
+  ScriptedPeer peer;
+  IPCAsyncClient client;
+  CompletionLog log;
+  CompletionTag tags[1];
+  uint32_t ids[1];
+  int failed = 0;
+  uint64_t start = now_ms ();
+  if (start_scripted (&env, "timeout", &peer, &client, &log, tags, 0, ids)
+      != 0)
+    failed = 1;
+  ipc_async_client_set_timeout (&client, 100);
+  tags[0].log = &log;
+  tags[0].index = 0;
+  if (failed == 0
+      && ipc_async_client_request (&client, kIPCCommandPing, NULL, 0,
+				   on_completion, &tags[0], &ids[0])
+	   != 0)
+    failed = 1;
+  if (failed != 0)
+    printf ("    ❌ FAIL: Setup failed\n");
+
+  // 对端收到请求但不响应
+  IPCMessageHeader header;
+  if (failed == 0 && !peer_read_request (&peer, &header))
+    {
+      printf ("    ❌ FAIL: Request not received\n");
+      failed = 1;
+    }
+  if (failed == 0 && !wait_completions (&log, 1, 1000))
+    {
+      printf ("    ❌ FAIL: Request never timed out\n");
+      failed = 1;
+    }
+  uint64_t elapsed = now_ms () - start;
+  if (failed == 0
+      && (log.status[0] != kIPCStatusServiceUnavailable || elapsed < 100))
+    {
+      printf ("    ❌ FAIL: status %d after %llu ms\n", log.status[0],
+	      (unsigned long long) elapsed);
+      failed = 1;
+    }
+
+  // 超时后到达的响应直接丢弃，回调不会再次调用
+  if (failed == 0)
+    {
+      peer_respond (&peer, ids[0], 7);
+      usleep (50 * 1000);
+      if (completion_count (&log) != 1 || !ipc_async_client_is_connected (&client))
+	{
+	  printf ("    ❌ FAIL: Late response completed the request again\n");
+	  failed = 1;
+	}
+    }
+
+  finish_scripted (&env, &peer, &client, &log);
+  if (failed == 0)
+    printf ("    ✅ PASS: Timed out after %llu ms, late response ignored\n",
+	    (unsigned long long) elapsed);
+  return failed;
+}
+
+static int
+test_ipc_async_disconnect_fails_pending (void)
+{
+  printf ("  Testing peer disconnect fails all pending requests...\n");
+
+  SocketEnv env;
+  ScriptedPeer peer;
+  IPCAsyncClient client;
+  CompletionLog log;
+  CompletionTag tags[3];
+  uint32_t ids[3];
+  int failed = 0;
+  if (start_scripted (&env, "hangup", &peer, &client, &log, tags, 3, ids)
+      != 0)
+    {
+      printf ("    ❌ FAIL: Setup failed\n");
+      failed = 1;
+    }
+
+  // 对端不响应直接关闭连接
+  close (peer.fd);
+  peer.fd = -1;
+  if (failed == 0 && !wait_completions (&log, 3, 1000))
+    {
+      printf ("    ❌ FAIL: Only %d of 3 requests failed\n",
+	      completion_count (&log));
+      failed = 1;
+    }
+  for (int i = 0; failed == 0 && i < 3; i++)
+    if (log.status[i] != kIPCStatusServiceUnavailable || log.calls[i] != 1)
+      {
+	printf ("    ❌ FAIL: Request %d: status %d, %d calls\n", i,
+		log.status[i], log.calls[i]);
+	failed = 1;
+      }
+  usleep (20 * 1000);
+  if (failed == 0
+      && (ipc_async_client_is_connected (&client) || client.pending_count != 0))
+    {
+      printf ("    ❌ FAIL: Client still connected or pending\n");
+      failed = 1;
+    }
+
+  finish_scripted (&env, &peer, &client, &log);
+  if (failed == 0 && completion_count (&log) != 3)
+    {
+      printf ("    ❌ FAIL: Cleanup completed requests again\n");
+      failed = 1;
+    }
+  if (failed == 0)
+    printf ("    ✅ PASS: All pending requests failed exactly once\n");
+  return failed;
+}
+
+static int
+test_ipc_async_send_failure (void)
+{
+  printf ("  Testing send failure does not register the request...\n");
+
+  SocketEnv env;
+  ScriptedPeer peer;
+  IPCAsyncClient client;
+  CompletionLog log;
+  CompletionTag tags[1];
+  uint32_t ids[1];
+  int failed = 0;
+  if (start_scripted (&env, "sendfail", &peer, &client, &log, tags, 0, ids)
+      != 0)
+    {
+      printf ("    ❌ FAIL: Setup failed\n");
+      failed = 1;
+    }
+
+  // 关闭客户端的写方向：连接仍标记为已连接，但发送会失败
+  shutdown (client.fd, SHUT_WR);
+  tags[0].log = &log;
+  tags[0].index = 0;
+  if (failed == 0
+      && ipc_async_client_request (&client, kIPCCommandPing, NULL, 0,
+				   on_completion, &tags[0], &ids[0])
+	   == 0)
+    {
+      printf ("    ❌ FAIL: Request on a broken socket succeeded\n");
+      failed = 1;
+    }
+  if (failed == 0 && client.pending_count != 0)
+    {
+      printf ("    ❌ FAIL: Failed request left a pending slot\n");
+      failed = 1;
+    }
+
+  // 断开时也不能再调用失败请求的回调
+  finish_scripted (&env, &peer, &client, &log);
+  if (failed == 0 && completion_count (&log) != 0)
+    {
+      printf ("    ❌ FAIL: Callback ran for a request reported as failed\n");
+      failed = 1;
+    }
+  if (failed == 0)
+    printf ("    ✅ PASS: Failed send reported only by return value\n");
+  return failed;
+}
+
+static void *
+server_thread_func (void *arg)
+{
+  ipc_server_run ((IPCServerContext *) arg);
+  return NULL;
+}
+
+// 对进程内服务端流水线提交请求
+static int
+test_ipc_async_pipelined_server (void)
+{
+  printf ("  Testing pipelined requests against in-process server...\n");
+
+  SocketEnv env;
+  socket_env_enter (&env, "server");
+  IPCServerContext server;
+  pthread_t thread;
+  if (ipc_server_init (&server) != 0
+      || pthread_create (&thread, NULL, server_thread_func, &server) != 0)
+    {
+      printf ("    ❌ FAIL: Server start failed\n");
+      socket_env_leave (&env);
+      return 1;
+    }
+
+  IPCAsyncClient client;
+  ipc_async_client_init (&client, NULL, NULL);
+  int failed = 0;
+  if (ipc_async_client_connect (&client) != 0)
+    {
+      printf ("    ❌ FAIL: Connect failed\n");
+      failed = 1;
+    }
+
+  // 同时提交多个请求，不等待前一个完成
+  IPCAsyncFuture futures[8];
+  for (int i = 0; i < 8; i++)
+    {
+      ipc_async_future_init (&futures[i]);
+      if (failed == 0
+	  && ipc_async_client_request_future (&client, kIPCCommandPing, NULL, 0,
+					      &futures[i])
+	       != 0)
+	{
+	  printf ("    ❌ FAIL: Request %d could not be queued\n", i);
+	  failed = 1;
+	}
+    }
+  for (int i = 0; failed == 0 && i < 8; i++)
+    {
+      if (!ipc_async_future_wait (&futures[i], 1000)
+	  || futures[i].status != kIPCStatusOK)
+	{
+	  printf ("    ❌ FAIL: Pipelined ping %d did not complete\n", i);
+	  failed = 1;
+	}
+    }
+
+  ipc_async_client_cleanup (&client);
+  for (int i = 0; i < 8; i++)
+    ipc_async_future_destroy (&futures[i]);
+  ipc_server_stop (&server);
+  pthread_join (thread, NULL);
+  ipc_server_cleanup (&server);
+  socket_env_leave (&env);
+
+  if (failed == 0)
+    printf ("    ✅ PASS: Pipelined requests completed\n");
+  return failed;
+}
+
+int
+run_ipc_async_client_tests (void)
+{
+  printf ("\n----------------------------------------\n");
+  printf ("IPC Async Client Tests\n");
+  printf ("----------------------------------------\n");
+
+  int failed = 0;
+  failed += test_ipc_async_client_init ();
+  failed += test_ipc_async_request_disconnected ();
+  failed += test_ipc_async_future_timeout ();
+  failed += test_ipc_async_out_of_order ();
+  failed += test_ipc_async_timeout ();
+  failed += test_ipc_async_disconnect_fails_pending ();
+  failed += test_ipc_async_send_failure ();
+  failed += test_ipc_async_pipelined_server ();
+
+  printf ("----------------------------------------\n");
+  if (failed == 0)
+    {
+      printf ("IPC Async Client Tests: PASSED ✅\n");
+    }
+  else
+    {
+      printf ("IPC Async Client Tests: %d FAILED ❌\n", failed);
+    }
+  printf ("----------------------------------------\n");
+
+  return failed;
+}
@@ -3,6 +3,7 @@
 //
 
 #include "ipc/ipc_protocol.h"
+#include <math.h>
 #include <stdio.h>
 #include <string.h>
 #include <assert.h>
@@ -161,7 +162,12 @@ test_ipc_socket_path (void)
     }
 
   // 验证路径包含预期的组件
-  if (strstr (path, "Application Support/audioctl/daemon.sock") == NULL)
+#ifdef __APPLE__
+  const char *expected = "Application Support/audioctl/daemon.sock";
+#else
+  const char *expected = ".audioctl/daemon.sock";
+#endif
+  if (strstr (path, expected) == NULL)
     {
       printf ("    ❌ FAIL: Path doesn't contain expected components: %s\n",
 	      path);
@@ -247,6 +253,485 @@ test_ipc_struct_sizes (void)
   return failed;
 }
 
+static int
+test_ipc_stats_histogram (void)
+{
+  printf ("  Testing stats histogram buckets...\n");
+
+  // 桶 0 为 < 1us，桶 i 为 [2^(i-1), 2^i) us
+  struct
+  {
+    uint64_t ns;
+    uint32_t bucket;
+  } cases[] = {
+    {0, 0},	{999, 0},   {1000, 1},	       {1999, 1},
+    {2000, 2},	{3999, 2},  {4000, 3},	       {1000000, 10},
+    {16383000, 14}, {16384000, 15}, {UINT64_MAX, 15},
+  };
+  for (size_t i = 0; i < sizeof (cases) / sizeof (cases[0]); i++)
+    {
+      uint32_t bucket = ipc_stats_bucket_for_ns (cases[i].ns);
+      if (bucket != cases[i].bucket)
+	{
+	  printf ("    ❌ FAIL: %llu ns -> bucket %u (expected %u)\n",
+		  (unsigned long long) cases[i].ns, bucket, cases[i].bucket);
+	  return 1;
+	}
+    }
+
+  // 98 个样本 < 1us，2 个样本在 [8, 16) us
+  uint32_t histogram[IPC_STATS_HISTOGRAM_BUCKETS] = {0};
+  histogram[0] = 98;
+  histogram[4] = 2;
+  if (ipc_stats_histogram_quantile_us (histogram, 0.50) != 1
+      || ipc_stats_histogram_quantile_us (histogram, 0.99) != 16
+      || ipc_stats_histogram_quantile_us (histogram, 1.0) != 16)
+    {
+      printf ("    ❌ FAIL: Histogram quantile estimate wrong\n");
+      return 1;
+    }
+
+  uint32_t empty[IPC_STATS_HISTOGRAM_BUCKETS] = {0};
+  if (ipc_stats_histogram_quantile_us (empty, 0.99) != 0)
+    {
+      printf ("    ❌ FAIL: Empty histogram should report 0\n");
+      return 1;
+    }
+
+  printf ("    ✅ PASS: Histogram buckets and quantiles correct\n");
+  return 0;
+}
+
+static int
+test_ipc_equalizer_validation (void)
+{
+  printf ("  Testing equalizer config validation...\n");
+
+  IPCEqualizerConfig config = {0};
+  config.enabled = 1;
+  config.band_count = 2;
+  config.preamp_db = -3.0f;
+  config.bands[0]
+    = (IPCEqualizerBand) {kIPCEqualizerPeaking, 1, 0, 1000.0f, 6.0f, 1.0f};
+  config.bands[1]
+    = (IPCEqualizerBand) {kIPCEqualizerHighPass, 1, 0, 30.0f, 0.0f, 0.7f};
+  if (!ipc_equalizer_config_is_valid (&config))
+    {
+      printf ("    ❌ FAIL: Valid config rejected\n");
+      return 1;
+    }
+
+  // 逐项破坏：段数、类型、频率、增益（含 NaN）、Q、前级增益
+  IPCEqualizerConfig bad[7];
+  for (int i = 0; i < 7; i++)
+    bad[i] = config;
+  bad[0].band_count = IPC_EQ_MAX_BANDS + 1;
+  bad[1].bands[1].type = kIPCEqualizerTypeCount;
+  bad[2].bands[0].frequency = 1.0f;
+  bad[3].bands[0].gain_db = 40.0f;
+  bad[4].bands[1].gain_db = NAN;
+  bad[5].bands[1].q = 0.0f;
+  bad[6].preamp_db = -30.0f;
+  for (int i = 0; i < 7; i++)
+    {
+      if (ipc_equalizer_config_is_valid (&bad[i]))
+	{
+	  printf ("    ❌ FAIL: Invalid config %d accepted\n", i);
+	  return 1;
+	}
+    }
+
+  // 超出 band_count 的段不检查；整个配置须能作为一条事件推送
+  config.bands[5].type = 0xff;
+  if (!ipc_equalizer_config_is_valid (&config)
+      || ipc_equalizer_config_is_valid (NULL)
+      || sizeof (IPCEventHeader) + sizeof (IPCEqualizerConfig)
+	   > IPC_MAX_PAYLOAD_SIZE)
+    {
+      printf ("    ❌ FAIL: Unused bands or NULL handled wrong\n");
+      return 1;
+    }
+
+  printf ("    ✅ PASS: Equalizer config ranges enforced\n");
+  return 0;
+}
+
+static int
+test_ipc_normalizer_validation (void)
+{
+  printf ("  Testing normalizer config validation...\n");
+
+  IPCNormalizerConfig config;
+  ipc_normalizer_config_init (&config);
+  if (!ipc_normalizer_config_is_valid (&config) || config.enabled)
+    {
+      printf ("    ❌ FAIL: Default config rejected or enabled\n");
+      return 1;
+    }
+
+  // 逐项破坏：目标响度（含 NaN）、提升、衰减、起音、释放
+  IPCNormalizerConfig bad[6];
+  for (int i = 0; i < 6; i++)
+    bad[i] = config;
+  bad[0].target_lufs = 0.0f;
+  bad[1].target_lufs = NAN;
+  bad[2].max_boost_db = IPC_NORMALIZER_MAX_BOOST_DB + 1.0f;
+  bad[3].max_cut_db = -1.0f;
+  bad[4].attack_db_per_s = 0.0f;
+  bad[5].release_db_per_s = IPC_NORMALIZER_MAX_RATE_DB * 2.0f;
+  for (int i = 0; i < 6; i++)
+    {
+      if (ipc_normalizer_config_is_valid (&bad[i]))
+	{
+	  printf ("    ❌ FAIL: Invalid config %d accepted\n", i);
+	  return 1;
+	}
+    }
+
+  if (ipc_normalizer_config_is_valid (NULL))
+    {
+      printf ("    ❌ FAIL: NULL config accepted\n");
+      return 1;
+    }
+
+  printf ("    ✅ PASS: Normalizer config ranges enforced\n");
+  return 0;
+}
+
+static int
+test_ipc_ducking_rules (void)
+{
+  printf ("  Testing ducking rules...\n");
+
+  IPCDuckingConfig config;
+  ipc_ducking_config_init (&config);
+  if (!ipc_ducking_config_is_valid (&config) || config.enabled
+      || sizeof (IPCEventHeader) + sizeof (IPCDuckingConfig)
+	   > IPC_MAX_PAYLOAD_SIZE)
+    {
+      printf ("    ❌ FAIL: Default rules rejected, enabled or too large\n");
+      return 1;
+    }
+
+  // 按 Bundle ID 或名称匹配（不区分大小写），人声优先
+  snprintf (config.media[config.media_count++], IPC_DUCKING_ID_MAX, "Zoom");
+  IPCDuckingRole zoom = ipc_ducking_config_role (&config, "US.ZOOM.XOS", NULL);
+  IPCDuckingRole by_name = ipc_ducking_config_role (&config, NULL, "zoom");
+  IPCDuckingRole spotify
+    = ipc_ducking_config_role (&config, "com.spotify.client", "Spotify");
+  IPCDuckingRole other = ipc_ducking_config_role (&config, "com.example", NULL);
+  if (zoom != kIPCDuckingRoleVoice || by_name != kIPCDuckingRoleMedia
+      || spotify != kIPCDuckingRoleMedia || other != kIPCDuckingRoleNone)
+    {
+      printf ("    ❌ FAIL: Roles %d/%d/%d/%d\n", zoom, by_name, spotify, other);
+      return 1;
+    }
+
+  // 逐项破坏：列表长度、空 ID、未结尾的 ID、深度（含 NaN）、门限、时间
+  IPCDuckingConfig bad[7];
+  for (int i = 0; i < 7; i++)
+    bad[i] = config;
+  bad[0].voice_count = IPC_DUCKING_MAX_APPS + 1;
+  bad[1].media[0][0] = '\0';
+  memset (bad[2].voice[0], 'a', IPC_DUCKING_ID_MAX);
+  bad[3].depth_db = NAN;
+  bad[4].threshold_lufs = 0.0f;
+  bad[5].attack_ms = 0.0f;
+  bad[6].hold_ms = -1.0f;
+  for (int i = 0; i < 7; i++)
+    {
+      if (ipc_ducking_config_is_valid (&bad[i]))
+	{
+	  printf ("    ❌ FAIL: Invalid rules %d accepted\n", i);
+	  return 1;
+	}
+    }
+
+  printf ("    ✅ PASS: Ducking roles matched and ranges enforced\n");
+  return 0;
+}
+
+static IPCChannelMixRule
+mix_rule (const char *app, float balance, float pan, uint8_t flags)
+{
+  IPCChannelMixRule rule;
+  memset (&rule, 0, sizeof (rule));
+  snprintf (rule.app, sizeof (rule.app), "%s", app);
+  rule.balance = balance;
+  rule.pan = pan;
+  rule.flags = flags;
+  return rule;
+}
+
+static int
+test_ipc_channel_mix_merge (void)
+{
+  printf ("  Testing channel mix batch merge...\n");
+
+  IPCChannelMixConfig config;
+  ipc_channel_mix_config_init (&config);
+
+  // 一批新增三个应用
+  IPCChannelMixConfig batch;
+  ipc_channel_mix_config_init (&batch);
+  batch.rules[batch.count++] = mix_rule ("com.apple.Safari", 0, 0, 1);
+  batch.rules[batch.count++] = mix_rule ("Spotify", -0.5f, 0, 0);
+  batch.rules[batch.count++] = mix_rule ("us.zoom.xos", 0, 0.25f, 2);
+  int added = ipc_channel_mix_config_merge (&config, &batch);
+
+  // 一批中同时替换（不区分大小写）、删除和忽略不存在的删除
+  ipc_channel_mix_config_init (&batch);
+  batch.rules[batch.count++] = mix_rule ("SPOTIFY", 0.5f, 0, 1);
+  batch.rules[batch.count++] = mix_rule ("com.apple.Safari", 0, 0, 0);
+  batch.rules[batch.count++] = mix_rule ("com.example", 0, 0, 0);
+  int merged = ipc_channel_mix_config_merge (&config, &batch);
+
+  const IPCChannelMixRule *spotify
+    = ipc_channel_mix_config_find (&config, "com.spotify.client", "spotify");
+  const IPCChannelMixRule *zoom
+    = ipc_channel_mix_config_find (&config, "US.ZOOM.XOS", NULL);
+  if (added != 0 || merged != 0 || config.count != 2 || spotify == NULL
+      || spotify->balance != 0.5f || spotify->flags != kIPCChannelMixMono
+      || zoom == NULL || zoom->pan != 0.25f
+      || ipc_channel_mix_config_find (&config, "com.apple.Safari", NULL)
+	   != NULL
+      || !ipc_channel_mix_config_is_valid (&config))
+    {
+      printf ("    ❌ FAIL: added=%d merged=%d count=%u\n", added, merged,
+	      config.count);
+      return 1;
+    }
+
+  // 无效的批次整体不生效：重复应用、NaN、未知标志、超出规则数
+  IPCChannelMixConfig before = config;
+  IPCChannelMixConfig bad[4];
+  for (int i = 0; i < 4; i++)
+    ipc_channel_mix_config_init (&bad[i]);
+  bad[0].rules[bad[0].count++] = mix_rule ("a", 0.1f, 0, 0);
+  bad[0].rules[bad[0].count++] = mix_rule ("A", 0.2f, 0, 0);
+  bad[1].rules[bad[1].count++] = mix_rule ("a", NAN, 0, 0);
+  bad[2].rules[bad[2].count++] = mix_rule ("a", 0, 0, 0x80);
+  for (int i = 0; i < IPC_CHANNEL_MIX_MAX_APPS; i++)
+    {
+      char app[16];
+      snprintf (app, sizeof (app), "app%d", i);
+      bad[3].rules[bad[3].count++] = mix_rule (app, 0, 0, 1);
+    }
+  for (int i = 0; i < 4; i++)
+    {
+      if (ipc_channel_mix_config_merge (&config, &bad[i]) == 0
+	  || memcmp (&config, &before, sizeof (config)) != 0)
+	{
+	  printf ("    ❌ FAIL: Invalid batch %d applied\n", i);
+	  return 1;
+	}
+    }
+
+  printf ("    ✅ PASS: Batches add, replace and remove atomically\n");
+  return 0;
+}
+
+static int
+test_ipc_convolver_validation (void)
+{
+  printf ("  Testing convolver config validation...\n");
+
+  IPCConvolverConfig config;
+  memset (&config, 0, sizeof (config));
+  IPCConvolverConfig loaded = config;
+  loaded.enabled = 1;
+  loaded.gain_db = IPC_CONVOLVER_MIN_GAIN_DB;
+  strcpy (loaded.path, "/Users/me/room.wav");
+  if (!ipc_convolver_config_is_valid (&config)
+      || !ipc_convolver_config_is_valid (&loaded))
+    {
+      printf ("    ❌ FAIL: Valid config rejected\n");
+      return 1;
+    }
+
+  // 启用但无路径、相对路径、增益越界（含 NaN）、路径未以 0 结尾
+  IPCConvolverConfig bad[5];
+  for (int i = 0; i < 5; i++)
+    bad[i] = loaded;
+  bad[0].path[0] = '\0';
+  strcpy (bad[1].path, "room.wav");
+  bad[2].gain_db = IPC_CONVOLVER_MAX_GAIN_DB + 1.0f;
+  bad[3].gain_db = NAN;
+  memset (bad[4].path, '/', sizeof (bad[4].path));
+  for (int i = 0; i < 5; i++)
+    {
+      if (ipc_convolver_config_is_valid (&bad[i]))
+	{
+	  printf ("    ❌ FAIL: Invalid config %d accepted\n", i);
+	  return 1;
+	}
+    }
+
+  printf ("    ✅ PASS: Convolver path and gain enforced\n");
+  return 0;
+}
+
+static int
+test_ipc_crossfeed_validation (void)
+{
+  printf ("  Testing crossfeed config validation...\n");
+
+  IPCCrossfeedConfig config;
+  ipc_crossfeed_config_init (&config);
+  if (!ipc_crossfeed_config_is_valid (&config)
+      || config.mode != kIPCCrossfeedOff
+      || config.preset != kIPCCrossfeedMedium)
+    {
+      printf ("    ❌ FAIL: Default config is not off/medium\n");
+      return 1;
+    }
+
+  IPCCrossfeedConfig bad_mode = config;
+  IPCCrossfeedConfig bad_preset = config;
+  bad_mode.mode = kIPCCrossfeedModeCount;
+  bad_preset.preset = kIPCCrossfeedPresetCount;
+  if (ipc_crossfeed_config_is_valid (&bad_mode)
+      || ipc_crossfeed_config_is_valid (&bad_preset))
+    {
+      printf ("    ❌ FAIL: Out-of-range mode or preset accepted\n");
+      return 1;
+    }
+
+  printf ("    ✅ PASS: Crossfeed defaults and ranges enforced\n");
+  return 0;
+}
+
+static int
+test_ipc_spectrum_validation (void)
+{
+  printf ("  Testing spectrum config and frame validation...\n");
+
+  IPCSpectrumConfig config;
+  ipc_spectrum_config_init (&config);
+  IPCSpectrumConfig bad_size = config;
+  IPCSpectrumConfig bad_decimation = config;
+  IPCSpectrumConfig bad_fps = config;
+  bad_size.fft_size = 3000;
+  bad_decimation.decimation = 3;
+  bad_fps.fps = IPC_SPECTRUM_MAX_FPS + 1;
+  if (!ipc_spectrum_config_is_valid (&config)
+      || ipc_spectrum_config_is_valid (&bad_size)
+      || ipc_spectrum_config_is_valid (&bad_decimation)
+      || ipc_spectrum_config_is_valid (&bad_fps))
+    {
+      printf ("    ❌ FAIL: Spectrum config ranges not enforced\n");
+      return 1;
+    }
+
+  // 负载长度必须与频带数一致；空帧只用于询问订阅者数
+  IPCSpectrumFrame frame;
+  memset (&frame, 0, sizeof (frame));
+  bool probe_ok
+    = ipc_spectrum_frame_is_valid (&frame, IPC_SPECTRUM_FRAME_HEADER_SIZE);
+  frame.sample_rate = 48000;
+  frame.fft_size = 2048;
+  frame.band_count = 64;
+  uint32_t length = IPC_SPECTRUM_FRAME_HEADER_SIZE + 64 * sizeof (float);
+  bool frame_ok = ipc_spectrum_frame_is_valid (&frame, length)
+		  && !ipc_spectrum_frame_is_valid (&frame, length - 4)
+		  && !ipc_spectrum_frame_is_valid (&frame, sizeof (frame));
+  frame.band_count = IPC_SPECTRUM_MAX_BANDS + 1;
+  frame_ok = frame_ok && !ipc_spectrum_frame_is_valid (&frame, length);
+  if (!probe_ok || !frame_ok
+      || sizeof (IPCSpectrumFrame) + sizeof (IPCEventHeader)
+	   > IPC_MAX_PAYLOAD_SIZE)
+    {
+      printf ("    ❌ FAIL: Probe %d, frame length checks %d\n", probe_ok,
+	      frame_ok);
+      return 1;
+    }
+
+  printf ("    ✅ PASS: Spectrum ranges and frame lengths enforced\n");
+  return 0;
+}
+
+static int
+test_ipc_record_validation (void)
+{
+  printf ("  Testing recording request and status validation...\n");
+
+  // 停止请求可以不带目录，开始时必须是绝对路径
+  IPCRecordConfig config;
+  memset (&config, 0, sizeof (config));
+  bool stop_ok = ipc_record_config_is_valid (&config);
+  config.recording = 1;
+  bool empty_rejected = !ipc_record_config_is_valid (&config);
+  strcpy (config.directory, "Music");
+  bool relative_rejected = !ipc_record_config_is_valid (&config);
+  strcpy (config.directory, "/tmp");
+  bool start_ok = ipc_record_config_is_valid (&config);
+  config.format = kIPCRecordFormatCount;
+  bool format_rejected = !ipc_record_config_is_valid (&config);
+  config.format = kIPCRecordCaf;
+  memset (config.directory, 'a', sizeof (config.directory));
+  config.directory[0] = '/';
+  bool unterminated_rejected = !ipc_record_config_is_valid (&config);
+
+  IPCRecordStatus status;
+  memset (&status, 0, sizeof (status));
+  bool status_ok = ipc_record_status_is_valid (&status);
+  memset (status.path, 'a', sizeof (status.path));
+  status_ok = status_ok && !ipc_record_status_is_valid (&status);
+
+  if (!stop_ok || !empty_rejected || !relative_rejected || !start_ok
+      || !format_rejected || !unterminated_rejected || !status_ok
+      || sizeof (IPCRecordReport) + sizeof (IPCResponse) > IPC_MAX_PAYLOAD_SIZE)
+    {
+      printf ("    ❌ FAIL: stop %d, empty %d, relative %d, start %d, "
+	      "format %d, unterminated %d, status %d\n",
+	      stop_ok, empty_rejected, relative_rejected, start_ok,
+	      format_rejected, unterminated_rejected, status_ok);
+      return 1;
+    }
+
+  printf ("    ✅ PASS: Recording directories and formats validated\n");
+  return 0;
+}
+
+static int
+test_ipc_stream_validation (void)
+{
+  printf ("  Testing stream config validation...\n");
+
+  // 默认配置关闭，可以不带主机；开启时主机不能为空
+  IPCStreamConfig config;
+  ipc_stream_config_init (&config);
+  bool default_ok = ipc_stream_config_is_valid (&config) && !config.enabled
+		    && config.port == IPC_STREAM_DEFAULT_PORT;
+  config.enabled = 1;
+  bool empty_rejected = !ipc_stream_config_is_valid (&config);
+  strcpy (config.host, "192.168.1.20");
+  bool enabled_ok = ipc_stream_config_is_valid (&config);
+  config.ptime_ms = IPC_STREAM_MAX_PTIME_MS + 1;
+  bool ptime_rejected = !ipc_stream_config_is_valid (&config);
+  config.ptime_ms = 0;
+  ptime_rejected = ptime_rejected && !ipc_stream_config_is_valid (&config);
+  config.ptime_ms = IPC_STREAM_MIN_PTIME_MS;
+  config.port = 0;
+  bool port_rejected = !ipc_stream_config_is_valid (&config);
+  config.port = IPC_STREAM_DEFAULT_PORT;
+  memset (config.host, 'a', sizeof (config.host));
+  bool unterminated_rejected = !ipc_stream_config_is_valid (&config);
+
+  if (!default_ok || !empty_rejected || !enabled_ok || !ptime_rejected
+      || !port_rejected || !unterminated_rejected)
+    {
+      printf ("    ❌ FAIL: default %d, empty %d, enabled %d, ptime %d, "
+	      "port %d, unterminated %d\n",
+	      default_ok, empty_rejected, enabled_ok, ptime_rejected,
+	      port_rejected, unterminated_rejected);
+      return 1;
+    }
+
+  printf ("    ✅ PASS: Stream host, port and packet time validated\n");
+  return 0;
+}
+
 int
 run_ipc_protocol_tests (void)
 {
@@ -260,6 +745,16 @@ run_ipc_protocol_tests (void)
   failed += test_ipc_socket_path ();
   failed += test_ipc_status_strings ();
   failed += test_ipc_struct_sizes ();
+  failed += test_ipc_stats_histogram ();
+  failed += test_ipc_equalizer_validation ();
+  failed += test_ipc_normalizer_validation ();
+  failed += test_ipc_ducking_rules ();
+  failed += test_ipc_channel_mix_merge ();
+  failed += test_ipc_convolver_validation ();
+  failed += test_ipc_crossfeed_validation ();
+  failed += test_ipc_spectrum_validation ();
+  failed += test_ipc_record_validation ();
+  failed += test_ipc_stream_validation ();
 
   printf ("----------------------------------------\n");
   if (failed == 0)
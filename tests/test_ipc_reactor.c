@@ -0,0 +1,750 @@
+//
+// IPC 事件循环 (Reactor) 与服务端事件循环测试
+//
+
+#include "ipc/ipc_async_client.h"
+#include "ipc/ipc_client.h"
+#include "ipc/ipc_reactor.h"
+#include "ipc/ipc_server.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+static uint64_t
+now_ms (void)
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000 + (uint64_t) ts.tv_nsec / 1000000;
+}
+
+static int
+test_reactor_edge_triggered_read (void)
+{
+  printf ("  Testing reactor edge-triggered read (%s)...\n",
+	  ipc_reactor_backend_name ());
+
+  IPCReactor reactor;
+  int fds[2];
+  if (ipc_reactor_init (&reactor) != 0 || pipe (fds) != 0)
+    {
+      printf ("    ❌ FAIL: Setup failed\n");
+      return 1;
+    }
+
+  int failed = 0;
+  IPCReactorEvent events[4];
+  ipc_reactor_add (&reactor, fds[0], kIPCReactorRead);
+
+  (void) write (fds[1], "x", 1);
+  int n = ipc_reactor_wait (&reactor, events, 4, 100);
+  if (n != 1 || events[0].fd != fds[0]
+      || !(events[0].events & kIPCReactorRead))
+    {
+      printf ("    ❌ FAIL: Expected one read event, got %d\n", n);
+      failed = 1;
+    }
+
+  // 未读出数据也不会再次触发（边沿触发）
+  n = ipc_reactor_wait (&reactor, events, 4, 20);
+  if (failed == 0 && n != 0)
+    {
+      printf ("    ❌ FAIL: Edge-triggered event fired again\n");
+      failed = 1;
+    }
+
+  // 新数据到达时再次触发
+  (void) write (fds[1], "y", 1);
+  n = ipc_reactor_wait (&reactor, events, 4, 100);
+  if (failed == 0 && n != 1)
+    {
+      printf ("    ❌ FAIL: New data did not re-arm the event\n");
+      failed = 1;
+    }
+
+  ipc_reactor_remove (&reactor, fds[0]);
+  close (fds[0]);
+  close (fds[1]);
+  ipc_reactor_cleanup (&reactor);
+
+  if (failed == 0)
+    printf ("    ✅ PASS: Edge-triggered read semantics correct\n");
+  return failed;
+}
+
+static int
+test_reactor_timer (void)
+{
+  printf ("  Testing reactor periodic timer...\n");
+
+  IPCReactor reactor;
+  if (ipc_reactor_init (&reactor) != 0)
+    {
+      printf ("    ❌ FAIL: ipc_reactor_init failed\n");
+      return 1;
+    }
+
+  int failed = 0;
+  if (ipc_reactor_add_timer (&reactor, 7, 10) != 0
+      || ipc_reactor_add_timer (&reactor, 7, 10) == 0)
+    {
+      printf ("    ❌ FAIL: Timer add / duplicate check failed\n");
+      failed = 1;
+    }
+
+  int fired = 0;
+  uint64_t deadline = now_ms () + 500;
+  while (failed == 0 && fired < 3 && now_ms () < deadline)
+    {
+      IPCReactorEvent events[4];
+      int n = ipc_reactor_wait (&reactor, events, 4, 100);
+      for (int i = 0; i < n; i++)
+	{
+	  if ((events[i].events & kIPCReactorTimer) && events[i].timer_id == 7)
+	    fired++;
+	}
+    }
+
+  if (failed == 0 && fired < 3)
+    {
+      printf ("    ❌ FAIL: Timer fired %d times, expected 3\n", fired);
+      failed = 1;
+    }
+
+  ipc_reactor_remove_timer (&reactor, 7);
+  ipc_reactor_cleanup (&reactor);
+
+  if (failed == 0)
+    printf ("    ✅ PASS: Periodic timer fires\n");
+  return failed;
+}
+
+static void *
+wakeup_thread_func (void *arg)
+{
+  usleep (20 * 1000);
+  ipc_reactor_wakeup ((IPCReactor *) arg);
+  return NULL;
+}
+
+static int
+test_reactor_wakeup (void)
+{
+  printf ("  Testing reactor cross-thread wakeup...\n");
+
+  IPCReactor reactor;
+  if (ipc_reactor_init (&reactor) != 0)
+    {
+      printf ("    ❌ FAIL: ipc_reactor_init failed\n");
+      return 1;
+    }
+
+  pthread_t thread;
+  pthread_create (&thread, NULL, wakeup_thread_func, &reactor);
+
+  IPCReactorEvent events[4];
+  uint64_t start = now_ms ();
+  int n = ipc_reactor_wait (&reactor, events, 4, 5000);
+  uint64_t elapsed = now_ms () - start;
+  pthread_join (thread, NULL);
+  ipc_reactor_cleanup (&reactor);
+
+  if (n != 1 || !(events[0].events & kIPCReactorWakeup) || elapsed > 1000)
+    {
+      printf ("    ❌ FAIL: Wakeup not delivered (n=%d, %llu ms)\n", n,
+	      (unsigned long long) elapsed);
+      return 1;
+    }
+
+  printf ("    ✅ PASS: Wakeup delivered in %llu ms\n",
+	  (unsigned long long) elapsed);
+  return 0;
+}
+
+static void *
+server_thread_func (void *arg)
+{
+  ipc_server_run ((IPCServerContext *) arg);
+  return NULL;
+}
+
+typedef struct
+{
+  pthread_mutex_t mutex;
+  int events;
+  float last_volume;
+} VolumeEventSink;
+
+static void
+on_volume_event (void *user_data, uint32_t topic, const void *data,
+		 uint32_t data_len)
+{
+  VolumeEventSink *sink = (VolumeEventSink *) user_data;
+  if (topic != kIPCEventTopicVolume || data_len < sizeof (IPCVolumeEvent))
+    return;
+
+  IPCVolumeEvent event;
+  memcpy (&event, data, sizeof (event));
+  pthread_mutex_lock (&sink->mutex);
+  sink->events++;
+  sink->last_volume = event.volume;
+  pthread_mutex_unlock (&sink->mutex);
+}
+
+static void
+restore_socket_env (const char *saved_path)
+{
+  if (saved_path != NULL)
+    setenv (IPC_SOCKET_PATH_ENV, saved_path, 1);
+  else
+    unsetenv (IPC_SOCKET_PATH_ENV);
+}
+
+// 在临时 socket 上启动进程内服务端，验证请求、事件合并和停止延迟
+static int
+test_server_event_loop (void)
+{
+  printf ("  Testing IPC server event loop...\n");
+
+  char socket_path[128];
+  snprintf (socket_path, sizeof (socket_path), "/tmp/audioctl_test_%d.sock",
+	    (int) getpid ());
+
+  const char *saved = getenv (IPC_SOCKET_PATH_ENV);
+  char saved_path[1024] = {0};
+  if (saved != NULL)
+    snprintf (saved_path, sizeof (saved_path), "%s", saved);
+  setenv (IPC_SOCKET_PATH_ENV, socket_path, 1);
+
+  int failed = 0;
+  IPCServerContext server;
+  pthread_t thread;
+  if (ipc_server_init (&server) != 0
+      || pthread_create (&thread, NULL, server_thread_func, &server) != 0)
+    {
+      printf ("    ❌ FAIL: Server start failed\n");
+      restore_socket_env (saved != NULL ? saved_path : NULL);
+      return 1;
+    }
+
+  IPCClientContext client;
+  ipc_client_init (&client);
+  VolumeEventSink sink = {PTHREAD_MUTEX_INITIALIZER, 0, 0.0f};
+  IPCAsyncClient listener;
+  ipc_async_client_init (&listener, on_volume_event, &sink);
+
+  float volume = 0.0f;
+  bool muted = true;
+  if (ipc_client_connect (&client) != 0
+      || ipc_async_client_connect (&listener) != 0
+      || ipc_client_register_app (&client, 4242, "test.app", 0.5f, false) != 0
+      || ipc_client_get_app_volume (&client, 4242, &volume, &muted) != 0
+      || volume != 0.5f || muted)
+    {
+      printf ("    ❌ FAIL: Register/get round-trip failed\n");
+      failed = 1;
+    }
+
+  // 订阅后快速连续设置音量，合并窗口内只推送最终值
+  IPCAsyncFuture future;
+  ipc_async_future_init (&future);
+  IPCSubscribeRequest sub = {kIPCEventTopicVolume};
+  if (failed == 0
+      && (ipc_async_client_request_future (&listener, kIPCCommandSubscribe,
+					   &sub, sizeof (sub), &future)
+	    != 0
+	  || !ipc_async_future_wait (&future, 1000)))
+    {
+      printf ("    ❌ FAIL: Subscribe failed\n");
+      failed = 1;
+    }
+
+  for (int i = 1; failed == 0 && i <= 10; i++)
+    {
+      if (ipc_client_set_app_volume (&client, 4242, i / 10.0f) != 0)
+	{
+	  printf ("    ❌ FAIL: set_app_volume failed\n");
+	  failed = 1;
+	}
+    }
+
+  uint64_t deadline = now_ms () + 1000;
+  int events = 0;
+  float last_volume = 0.0f;
+  while (failed == 0 && now_ms () < deadline)
+    {
+      pthread_mutex_lock (&sink.mutex);
+      events = sink.events;
+      last_volume = sink.last_volume;
+      pthread_mutex_unlock (&sink.mutex);
+      if (events > 0 && last_volume == 1.0f)
+	break;
+      usleep (5 * 1000);
+    }
+
+  if (failed == 0 && (events == 0 || events > 10 || last_volume != 1.0f))
+    {
+      printf ("    ❌ FAIL: Volume events wrong (%d events, last=%.2f)\n",
+	      events, last_volume);
+      failed = 1;
+    }
+
+  ipc_async_client_cleanup (&listener);
+  ipc_async_future_destroy (&future);
+  ipc_client_cleanup (&client);
+
+  // 停止请求应立即唤醒事件循环，而不是等待轮询超时
+  uint64_t start = now_ms ();
+  ipc_server_stop (&server);
+  pthread_join (thread, NULL);
+  uint64_t elapsed = now_ms () - start;
+  ipc_server_cleanup (&server);
+
+  if (failed == 0 && elapsed > 200)
+    {
+      printf ("    ❌ FAIL: Server stop took %llu ms\n",
+	      (unsigned long long) elapsed);
+      failed = 1;
+    }
+
+  if (failed == 0)
+    printf ("    ✅ PASS: Server loop correct (%d coalesced events, stop in "
+	    "%llu ms)\n",
+	    events, (unsigned long long) elapsed);
+
+  restore_socket_env (saved != NULL ? saved_path : NULL);
+  return failed;
+}
+
+// 服务端统计：请求数、按状态码的错误、字节数和连接数
+static int
+test_server_stats (void)
+{
+  printf ("  Testing IPC server stats...\n");
+
+  char socket_path[128];
+  snprintf (socket_path, sizeof (socket_path),
+	    "/tmp/audioctl_test_stats_%d.sock", (int) getpid ());
+
+  const char *saved = getenv (IPC_SOCKET_PATH_ENV);
+  char saved_path[1024] = {0};
+  if (saved != NULL)
+    snprintf (saved_path, sizeof (saved_path), "%s", saved);
+  setenv (IPC_SOCKET_PATH_ENV, socket_path, 1);
+
+  IPCServerContext server;
+  pthread_t thread;
+  if (ipc_server_init (&server) != 0
+      || pthread_create (&thread, NULL, server_thread_func, &server) != 0)
+    {
+      printf ("    ❌ FAIL: Server start failed\n");
+      restore_socket_env (saved != NULL ? saved_path : NULL);
+      return 1;
+    }
+
+  int failed = 0;
+  IPCClientContext client;
+  ipc_client_init (&client);
+  float volume = 0.0f;
+  bool muted = false;
+  if (ipc_client_connect (&client) != 0)
+    {
+      printf ("    ❌ FAIL: Connect failed\n");
+      failed = 1;
+    }
+  for (int i = 0; failed == 0 && i < 5; i++)
+    ipc_client_ping (&client);
+  // 未注册的 PID：kIPCStatusClientNotFound
+  if (failed == 0
+      && ipc_client_get_app_volume (&client, 777, &volume, &muted) == 0)
+    {
+      printf ("    ❌ FAIL: Unknown PID should fail\n");
+      failed = 1;
+    }
+
+  IPCServerStats stats;
+  IPCCommandStats commands[IPC_STATS_MAX_COMMANDS];
+  uint32_t count = 0;
+  if (failed == 0
+      && ipc_client_get_stats (&client, &stats, commands,
+			       IPC_STATS_MAX_COMMANDS, &count) != 0)
+    {
+      printf ("    ❌ FAIL: get_stats failed\n");
+      failed = 1;
+    }
+
+  const IPCCommandStats *ping = NULL;
+  const IPCCommandStats *get_volume = NULL;
+  for (uint32_t i = 0; failed == 0 && i < count; i++)
+    {
+      if (commands[i].command == kIPCCommandPing)
+	ping = &commands[i];
+      else if (commands[i].command == kIPCCommandGetVolume)
+	get_volume = &commands[i];
+    }
+
+  if (failed == 0
+      && (ping == NULL || get_volume == NULL || ping->requests != 5
+	  || ping->status_counts[0] != 5
+	  || ping->bytes_in != 5 * sizeof (IPCMessageHeader)
+	  || ping->bytes_out
+	       != 5 * (sizeof (IPCMessageHeader) + sizeof (IPCResponse))
+	  || get_volume->requests != 1
+	  || get_volume->status_counts[-kIPCStatusClientNotFound] != 1))
+    {
+      printf ("    ❌ FAIL: Command counters wrong\n");
+      failed = 1;
+    }
+
+  uint32_t histogram_total = 0;
+  for (uint32_t b = 0; ping != NULL && b < IPC_STATS_HISTOGRAM_BUCKETS; b++)
+    histogram_total += ping->histogram[b];
+  if (failed == 0
+      && (histogram_total != 5 || stats.connections != 1
+	  || stats.peak_connections < 1 || stats.loop_iterations == 0))
+    {
+      printf ("    ❌ FAIL: Histogram/connection stats wrong "
+	      "(hist=%u conn=%u peak=%u loops=%llu)\n",
+	      histogram_total, stats.connections, stats.peak_connections,
+	      (unsigned long long) stats.loop_iterations);
+      failed = 1;
+    }
+
+  // 每个已知指令和一个未知指令各请求一次（负载为空，多数返回参数错误），
+  // 条目数超过单帧容量时客户端应分页取回全部，未知指令槽位不能丢失
+  IPCAsyncClient prober;
+  ipc_async_client_init (&prober, NULL, NULL);
+  uint32_t probed = 1; // GetStats 本身
+  if (failed == 0 && ipc_async_client_connect (&prober) != 0)
+    {
+      printf ("    ❌ FAIL: Async connect failed\n");
+      failed = 1;
+    }
+  for (uint32_t command = 0x0100; failed == 0 && command <= 0x0FFF + 1;
+       command++)
+    {
+      bool unknown = command == 0x0FFF + 1;
+      if (command == kIPCCommandGetStats
+	  || (!unknown
+	      && strcmp (ipc_command_to_string ((uint16_t) command), "unknown")
+		   == 0))
+	continue;
+      IPCAsyncFuture future;
+      ipc_async_future_init (&future);
+      if (ipc_async_client_request_future (&prober, (uint16_t) command, NULL,
+					   0, &future)
+	    != 0
+	  || !ipc_async_future_wait (&future, 1000))
+	{
+	  printf ("    ❌ FAIL: Probe 0x%04x failed\n", command);
+	  failed = 1;
+	}
+      else if (!unknown)
+	probed++;
+      ipc_async_future_destroy (&future);
+    }
+  ipc_async_client_cleanup (&prober);
+
+  if (failed == 0
+      && ipc_client_get_stats (&client, &stats, commands,
+			       IPC_STATS_MAX_COMMANDS, &count)
+	   != 0)
+    {
+      printf ("    ❌ FAIL: Paged get_stats failed\n");
+      failed = 1;
+    }
+  bool has_unknown = false;
+  for (uint32_t i = 0; failed == 0 && i < count; i++)
+    has_unknown = has_unknown || commands[i].command == 0;
+  if (failed == 0
+      && (count != probed + 1 || count <= IPC_STATS_PAGE_ENTRIES
+	  || stats.total_commands != count || !has_unknown))
+    {
+      printf ("    ❌ FAIL: Paged stats returned %u of %u entries "
+	      "(unknown slot %s)\n",
+	      count, probed + 1, has_unknown ? "present" : "missing");
+      failed = 1;
+    }
+
+  ipc_client_cleanup (&client);
+  ipc_server_stop (&server);
+  pthread_join (thread, NULL);
+  ipc_server_cleanup (&server);
+
+  if (failed == 0)
+    printf ("    ✅ PASS: Server stats correct (%u command slots, paged)\n",
+	    count);
+
+  restore_socket_env (saved != NULL ? saved_path : NULL);
+  return failed;
+}
+
+// Router 快照：上报超过容量后只保留最新的 IPC_ROUTER_STATS_HISTORY 个
+static int
+test_server_router_stats (void)
+{
+  printf ("  Testing router stats history...\n");
+
+  char socket_path[128];
+  snprintf (socket_path, sizeof (socket_path),
+	    "/tmp/audioctl_test_router_%d.sock", (int) getpid ());
+
+  const char *saved = getenv (IPC_SOCKET_PATH_ENV);
+  char saved_path[1024] = {0};
+  if (saved != NULL)
+    snprintf (saved_path, sizeof (saved_path), "%s", saved);
+  setenv (IPC_SOCKET_PATH_ENV, socket_path, 1);
+
+  IPCServerContext server;
+  pthread_t thread;
+  if (ipc_server_init (&server) != 0
+      || pthread_create (&thread, NULL, server_thread_func, &server) != 0)
+    {
+      printf ("    ❌ FAIL: Server start failed\n");
+      restore_socket_env (saved != NULL ? saved_path : NULL);
+      return 1;
+    }
+
+  int failed = 0;
+  IPCAsyncClient publisher;
+  ipc_async_client_init (&publisher, NULL, NULL);
+  if (ipc_async_client_connect (&publisher) != 0)
+    {
+      printf ("    ❌ FAIL: Publisher connect failed\n");
+      failed = 1;
+    }
+
+  // 与 Router 相同：不等待响应上报
+  uint32_t total = IPC_ROUTER_STATS_HISTORY + 6;
+  for (uint32_t i = 0; failed == 0 && i < total; i++)
+    {
+      IPCRouterStatsSnapshot snapshot = {0};
+      snapshot.uptime_sec = i;
+      snapshot.frames = 512;
+      // 未完成请求表满时等待响应释放槽位
+      int result = -1;
+      for (int attempt = 0; result != 0 && attempt < 1000; attempt++)
+	{
+	  result = ipc_async_client_request (&publisher,
+					     kIPCCommandPublishRouterStats,
+					     &snapshot, sizeof (snapshot), NULL,
+					     NULL, NULL);
+	  if (result != 0)
+	    usleep (1000);
+	}
+      if (result != 0)
+	{
+	  printf ("    ❌ FAIL: Publish failed\n");
+	  failed = 1;
+	}
+    }
+
+  // 同一连接上的请求按顺序处理，ping 完成即表示全部上报已处理
+  IPCAsyncFuture future;
+  ipc_async_future_init (&future);
+  if (failed == 0
+      && (ipc_async_client_request_future (&publisher, kIPCCommandPing, NULL,
+					   0, &future)
+	    != 0
+	  || !ipc_async_future_wait (&future, 1000)))
+    {
+      printf ("    ❌ FAIL: Ping after publish failed\n");
+      failed = 1;
+    }
+
+  IPCClientContext client;
+  ipc_client_init (&client);
+  IPCRouterStatsSnapshot snapshots[IPC_ROUTER_STATS_HISTORY];
+  uint32_t count = 0;
+  if (failed == 0
+      && (ipc_client_connect (&client) != 0
+	  || ipc_client_get_router_stats (&client, snapshots,
+					  IPC_ROUTER_STATS_HISTORY, &count)
+	       != 0))
+    {
+      printf ("    ❌ FAIL: get_router_stats failed\n");
+      failed = 1;
+    }
+
+  uint32_t first = total - IPC_ROUTER_STATS_HISTORY;
+  for (uint32_t i = 0; failed == 0 && i < count; i++)
+    {
+      if (snapshots[i].uptime_sec != first + i || snapshots[i].frames != 512)
+	{
+	  printf ("    ❌ FAIL: Snapshot %u out of order (uptime=%u)\n", i,
+		  snapshots[i].uptime_sec);
+	  failed = 1;
+	}
+    }
+  if (failed == 0 && count != IPC_ROUTER_STATS_HISTORY)
+    {
+      printf ("    ❌ FAIL: Expected %d snapshots, got %u\n",
+	      IPC_ROUTER_STATS_HISTORY, count);
+      failed = 1;
+    }
+
+  // 容量不足时返回最新的快照
+  IPCRouterStatsSnapshot latest[4];
+  if (failed == 0
+      && (ipc_client_get_router_stats (&client, latest, 4, &count) != 0
+	  || count != 4 || latest[3].uptime_sec != total - 1))
+    {
+      printf ("    ❌ FAIL: Truncated read should keep newest snapshots\n");
+      failed = 1;
+    }
+
+  ipc_client_cleanup (&client);
+  ipc_async_client_cleanup (&publisher);
+  ipc_async_future_destroy (&future);
+  ipc_server_stop (&server);
+  pthread_join (thread, NULL);
+  ipc_server_cleanup (&server);
+
+  if (failed == 0)
+    printf ("    ✅ PASS: Router stats ring keeps newest %d snapshots\n",
+	    IPC_ROUTER_STATS_HISTORY);
+
+  restore_socket_env (saved != NULL ? saved_path : NULL);
+  return failed;
+}
+
+static int
+test_server_config (void)
+{
+  printf ("  Testing config get/set table...\n");
+
+  char socket_path[128];
+  snprintf (socket_path, sizeof (socket_path),
+	    "/tmp/audioctl_test_config_%d.sock", (int) getpid ());
+
+  const char *saved = getenv (IPC_SOCKET_PATH_ENV);
+  char saved_path[1024] = {0};
+  if (saved != NULL)
+    snprintf (saved_path, sizeof (saved_path), "%s", saved);
+  setenv (IPC_SOCKET_PATH_ENV, socket_path, 1);
+
+  IPCServerContext server;
+  pthread_t thread;
+  if (ipc_server_init (&server) != 0
+      || pthread_create (&thread, NULL, server_thread_func, &server) != 0)
+    {
+      printf ("    ❌ FAIL: Server start failed\n");
+      restore_socket_env (saved != NULL ? saved_path : NULL);
+      return 1;
+    }
+
+  int failed = 0;
+  IPCClientContext client;
+  ipc_client_init (&client);
+  if (ipc_client_connect (&client) != 0)
+    {
+      printf ("    ❌ FAIL: Client connect failed\n");
+      failed = 1;
+    }
+
+  // 整体替换：有效配置保存后读回一致，无效配置不改变已保存的值
+  IPCEqualizerConfig eq;
+  memset (&eq, 0, sizeof (eq));
+  eq.enabled = 1;
+  eq.band_count = 1;
+  eq.preamp_db = -3.0f;
+  eq.bands[0].type = kIPCEqualizerPeaking;
+  eq.bands[0].frequency = 1000.0f;
+  eq.bands[0].gain_db = 4.0f;
+  eq.bands[0].q = 1.0f;
+  IPCEqualizerConfig bad = eq;
+  bad.band_count = IPC_EQ_MAX_BANDS + 1;
+  IPCEqualizerConfig read_back;
+  if (failed == 0
+      && (ipc_client_set_equalizer (&client, &eq) != 0
+	  || ipc_client_set_equalizer (&client, &bad) == 0
+	  || ipc_client_get_equalizer (&client, &read_back) != 0
+	  || memcmp (&read_back, &eq, sizeof (eq)) != 0))
+    {
+      printf ("    ❌ FAIL: Equalizer round trip or rejection\n");
+      failed = 1;
+    }
+
+  // 规整后保存并带回：录音序号由服务端递增，保留字段清零
+  IPCRecordConfig record;
+  memset (&record, 0, sizeof (record));
+  record.recording = 1;
+  record.reserved[0] = 0xAA;
+  record.generation = 77;
+  snprintf (record.directory, sizeof (record.directory), "/tmp");
+  uint32_t first = 0, second = 0;
+  IPCRecordReport report;
+  if (failed == 0
+      && (ipc_client_set_recording (&client, &record, &first) != 0
+	  || ipc_client_set_recording (&client, &record, &second) != 0
+	  || ipc_client_get_recording (&client, &report) != 0
+	  || first != 1 || second != 2 || report.config.generation != 2
+	  || report.config.reserved[0] != 0))
+    {
+      printf ("    ❌ FAIL: Recording generation %u/%u\n", first, second);
+      failed = 1;
+    }
+
+  // 负载短于配置大小
+  IPCAsyncClient async;
+  IPCAsyncFuture future;
+  ipc_async_client_init (&async, NULL, NULL);
+  ipc_async_future_init (&future);
+  if (failed == 0
+      && (ipc_async_client_connect (&async) != 0
+	  || ipc_async_client_request_future (&async, kIPCCommandSetStream,
+					      &eq, 4, &future)
+	       != 0
+	  || !ipc_async_future_wait (&future, 1000)
+	  || future.status != kIPCStatusInvalidHeader))
+    {
+      printf ("    ❌ FAIL: Short payload not rejected\n");
+      failed = 1;
+    }
+
+  ipc_async_client_cleanup (&async);
+  ipc_async_future_destroy (&future);
+  ipc_client_cleanup (&client);
+  ipc_server_stop (&server);
+  pthread_join (thread, NULL);
+  ipc_server_cleanup (&server);
+
+  if (failed == 0)
+    printf ("    ✅ PASS: Config replace, normalize/echo and validation\n");
+
+  restore_socket_env (saved != NULL ? saved_path : NULL);
+  return failed;
+}
+
+int
+run_ipc_reactor_tests (void)
+{
+  printf ("\n----------------------------------------\n");
+  printf ("IPC Reactor Tests\n");
+  printf ("----------------------------------------\n");
+
+  int failed = 0;
+  failed += test_reactor_edge_triggered_read ();
+  failed += test_reactor_timer ();
+  failed += test_reactor_wakeup ();
+  failed += test_server_event_loop ();
+  failed += test_server_stats ();
+  failed += test_server_router_stats ();
+  failed += test_server_config ();
+
+  printf ("----------------------------------------\n");
+  if (failed == 0)
+    {
+      printf ("IPC Reactor Tests: PASSED ✅\n");
+    }
+  else
+    {
+      printf ("IPC Reactor Tests: %d FAILED ❌\n", failed);
+    }
+  printf ("----------------------------------------\n");
+
+  return failed;
+}
@@ -4,6 +4,8 @@
 
 #include <stdio.h>
 
+// CoreAudio 相关测试只在 macOS 上构建
+#ifdef __APPLE__
 extern int
 run_basic_device_tests (void);
 extern int
@@ -21,9 +23,48 @@ run_app_volume_control_tests (void);
 extern int
 run_virtual_device_manager_tests (void);
 extern int
+run_app_volume_driver_tests (void);
+#endif
+
+// 可移植的 IPC 测试
+extern int
 run_ipc_protocol_tests (void);
 extern int
 run_ipc_client_tests (void);
+extern int
+run_ipc_async_client_tests (void);
+extern int
+run_ipc_reactor_tests (void);
+
+// 可移植的 Router 信号通路测试
+extern int
+run_router_pipeline_tests (void);
+extern int
+run_router_dsp_tests (void);
+extern int
+run_router_eq_tests (void);
+extern int
+run_router_limiter_tests (void);
+extern int
+run_router_loudness_tests (void);
+extern int
+run_router_agc_tests (void);
+extern int
+run_router_duck_tests (void);
+extern int
+run_router_matrix_tests (void);
+extern int
+run_router_convolver_tests (void);
+extern int
+run_router_crossfeed_tests (void);
+extern int
+run_router_spectrum_tests (void);
+extern int
+run_router_record_tests (void);
+extern int
+run_router_rtp_tests (void);
+extern int
+run_router_convert_tests (void);
 
 int
 main ()
@@ -33,6 +74,7 @@ main ()
   printf ("========================================\n");
   int failed = 0;
 
+#ifdef __APPLE__
   // 原有测试
   failed += run_basic_device_tests ();
   failed += run_device_control_tests ();
@@ -43,8 +85,27 @@ main ()
   // 新增测试
   failed += run_app_volume_control_tests ();
   failed += run_virtual_device_manager_tests ();
+  failed += run_app_volume_driver_tests ();
+#endif
+
   failed += run_ipc_protocol_tests ();
   failed += run_ipc_client_tests ();
+  failed += run_ipc_async_client_tests ();
+  failed += run_ipc_reactor_tests ();
+  failed += run_router_pipeline_tests ();
+  failed += run_router_dsp_tests ();
+  failed += run_router_eq_tests ();
+  failed += run_router_limiter_tests ();
+  failed += run_router_loudness_tests ();
+  failed += run_router_agc_tests ();
+  failed += run_router_duck_tests ();
+  failed += run_router_matrix_tests ();
+  failed += run_router_convolver_tests ();
+  failed += run_router_crossfeed_tests ();
+  failed += run_router_spectrum_tests ();
+  failed += run_router_record_tests ();
+  failed += run_router_rtp_tests ();
+  failed += run_router_convert_tests ();
 
   printf ("\n========================================\n");
   printf ("Test summary: ");
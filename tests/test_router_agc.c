@@ -0,0 +1,312 @@
+//
+// 跨应用响度均衡测试（可移植，不依赖音频硬件）
+//
+
+#include "router/router_agc.h"
+#include "router/router_loudness.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_RATE 48000
+#define TEST_CHANNELS 2
+#define TEST_BLOCK 480 // 10ms
+#define TEST_TWO_PI 6.283185307179586
+
+static RouterAgcParams
+default_params (void)
+{
+  RouterAgcControl control;
+  router_agc_control_init (&control);
+  RouterAgcParams params;
+  router_agc_get_params (&control, &params);
+  params.enabled = true;
+  return params;
+}
+
+// 以固定的响度读数运行 seconds 秒
+static void
+run_constant (RouterAgc *agc, const RouterAgcParams *params, float lufs,
+	      double seconds)
+{
+  uint32_t blocks = (uint32_t) lround (seconds * TEST_RATE / TEST_BLOCK);
+  for (uint32_t i = 0; i < blocks; i++)
+    router_agc_update (agc, params, lufs, 0.0f, TEST_BLOCK, TEST_RATE);
+}
+
+static bool
+near (float value, float expected, float tolerance)
+{
+  return fabsf (value - expected) <= tolerance;
+}
+
+static int
+test_rate_limits (void)
+{
+  printf ("  Testing AGC attack/release rate limits...\n");
+
+  // 默认：目标 -18 LUFS，最大提升 12 dB，起音 6 dB/s，释放 1.5 dB/s
+  RouterAgcParams params = default_params ();
+  RouterAgc agc;
+
+  // -30 LUFS 需要 +12 dB：1 秒后只提升了 1.5 dB，之后停在最大提升量
+  router_agc_init (&agc);
+  run_constant (&agc, &params, -30.0f, 1.0);
+  float up_1s = router_agc_read_gain_db (&agc);
+  run_constant (&agc, &params, -30.0f, 10.0);
+  float up_final = agc.gain_db;
+  run_constant (&agc, &params, -40.0f, 5.0);
+  float capped = agc.gain_db;
+
+  // 复位后从 0 dB 开始：-6 LUFS 需要 -12 dB，1 秒后衰减 6 dB，2 秒后到达
+  router_agc_reset (&agc);
+  run_constant (&agc, &params, -6.0f, 1.0);
+  float down_1s = agc.gain_db;
+  run_constant (&agc, &params, -6.0f, 1.0);
+  float down_final = agc.gain_db;
+
+  if (!near (up_1s, 1.5f, 0.01f) || up_final != 12.0f || capped != 12.0f
+      || !near (down_1s, -6.0f, 0.01f) || down_final != -12.0f)
+    {
+      printf ("    ❌ FAIL: up %.2f -> %.2f (capped %.2f), down %.2f -> %.2f\n",
+	      up_1s, up_final, capped, down_1s, down_final);
+      return 1;
+    }
+
+  printf ("    ✅ PASS: +%.2f dB/s up, %.2f dB/s down, capped at +%.0f dB\n",
+	  up_1s, down_1s, up_final);
+  return 0;
+}
+
+static int
+test_gate_and_disable (void)
+{
+  printf ("  Testing AGC gate hold and disable...\n");
+
+  RouterAgcParams params = default_params ();
+  RouterAgc agc;
+  router_agc_init (&agc);
+  bool idle_active = router_agc_is_active (&agc);
+
+  // 提升到 +6 dB 后进入静音：低于门限时保持增益，不去放大底噪
+  run_constant (&agc, &params, -24.0f, 5.0);
+  float boosted = agc.gain_db;
+  run_constant (&agc, &params, ROUTER_LOUDNESS_MIN_LUFS, 5.0);
+  float held = agc.gain_db;
+
+  // 关闭后按起音速率回到 0 dB，到达后不再施加增益
+  params.enabled = false;
+  run_constant (&agc, &params, -24.0f, 0.5);
+  bool active = router_agc_is_active (&agc);
+  run_constant (&agc, &params, -24.0f, 1.0);
+  float disabled = agc.gain_db;
+  bool still_active = router_agc_is_active (&agc);
+
+  if (idle_active || boosted != 6.0f || held != boosted || disabled != 0.0f
+      || !active || still_active)
+    {
+      printf ("    ❌ FAIL: boosted %.2f held %.2f disabled %.2f "
+	      "(active %d/%d/%d)\n",
+	      boosted, held, disabled, idle_active, active, still_active);
+      return 1;
+    }
+
+  printf ("    ✅ PASS: Gain held through silence, back to unity when off\n");
+  return 0;
+}
+
+static int
+test_ramp (void)
+{
+  printf ("  Testing AGC per-sample gain interpolation...\n");
+
+  static float buffer[2 * TEST_BLOCK * TEST_CHANNELS];
+  for (uint32_t i = 0; i < 2 * TEST_BLOCK * TEST_CHANNELS; i++)
+    buffer[i] = 1.0f;
+
+  // 两块连续处理：增益块内线性变化，块间连续，音量按比例叠加
+  RouterAgcParams params = default_params ();
+  params.release_db_per_s = ROUTER_AGC_MAX_RATE_DB;
+  RouterAgc agc;
+  router_agc_init (&agc);
+  const float volume = 0.5f;
+  float *blocks[2] = {buffer, buffer + TEST_BLOCK * TEST_CHANNELS};
+  float ends[2];
+  for (uint32_t b = 0; b < 2; b++)
+    {
+      router_agc_update (&agc, &params, -30.0f, 0.0f, TEST_BLOCK, TEST_RATE);
+      router_agc_apply (&agc, blocks[b], TEST_BLOCK, TEST_CHANNELS, volume);
+      ends[b] = agc.to * volume;
+    }
+
+  float max_step = 0.0f;
+  bool monotonic = true;
+  for (uint32_t f = 1; f < 2 * TEST_BLOCK; f++)
+    {
+      float step = buffer[f * TEST_CHANNELS] - buffer[(f - 1) * TEST_CHANNELS];
+      monotonic &= step >= 0.0f
+		   && buffer[f * TEST_CHANNELS + 1] == buffer[f * TEST_CHANNELS];
+      max_step = fmaxf (max_step, step);
+    }
+  float last0 = buffer[(TEST_BLOCK - 1) * TEST_CHANNELS];
+  float last1 = buffer[(2 * TEST_BLOCK - 1) * TEST_CHANNELS];
+
+  // 0.6 dB 分到 480 帧：相邻采样之差远小于整块变化量
+  if (!monotonic || !near (last0, ends[0], 1e-5f)
+      || !near (last1, ends[1], 1e-5f) || !(max_step < 1e-4f)
+      || !near (buffer[0], volume, 1e-3f))
+    {
+      printf ("    ❌ FAIL: ends %.5f/%.5f (expected %.5f/%.5f), "
+	      "max step %.6f\n",
+	      last0, last1, ends[0], ends[1], max_step);
+      return 1;
+    }
+
+  printf ("    ✅ PASS: %.4f -> %.4f over two blocks, max step %.6f\n",
+	  buffer[0], last1, max_step);
+  return 0;
+}
+
+// 一个“应用”：K 加权测量输入 -> 自动增益 -> 测量输出
+typedef struct
+{
+  RouterLoudness in;
+  RouterLoudness out;
+  RouterAgc agc;
+  double amplitude;
+  double phase;
+} TestApp;
+
+static int
+test_cross_app (void)
+{
+  printf ("  Testing AGC cross-app convergence...\n");
+
+  // 1kHz 正弦的响度约等于其 dBFS 电平：-28 与 -8 LUFS 两个应用，
+  // 30 秒后输出都应接近 -18 LUFS 的目标
+  RouterAgcParams params = default_params ();
+  TestApp *apps = malloc (2 * sizeof (TestApp));
+  const double levels[2] = {-28.0, -8.0};
+  for (uint32_t a = 0; a < 2; a++)
+    {
+      router_loudness_init (&apps[a].in);
+      router_loudness_prepare (&apps[a].in, TEST_RATE, TEST_CHANNELS);
+      router_loudness_init (&apps[a].out);
+      router_loudness_prepare (&apps[a].out, TEST_RATE, TEST_CHANNELS);
+      router_agc_init (&apps[a].agc);
+      apps[a].amplitude = pow (10.0, levels[a] / 20.0);
+      apps[a].phase = 0.0;
+    }
+
+  static float buffer[TEST_BLOCK * TEST_CHANNELS];
+  for (uint32_t block = 0; block < 30 * TEST_RATE / TEST_BLOCK; block++)
+    {
+      for (uint32_t a = 0; a < 2; a++)
+	{
+	  TestApp *app = &apps[a];
+	  for (uint32_t f = 0; f < TEST_BLOCK; f++)
+	    {
+	      float v = (float) (app->amplitude * sin (app->phase));
+	      app->phase += TEST_TWO_PI * 1000.0 / TEST_RATE;
+	      buffer[f * TEST_CHANNELS] = v;
+	      buffer[f * TEST_CHANNELS + 1] = v;
+	    }
+	  router_loudness_process (&app->in, buffer, TEST_BLOCK);
+	  RouterLoudnessReading reading;
+	  router_loudness_read (&app->in, &reading);
+	  router_agc_update (&app->agc, &params, reading.short_term_lufs, 0.0f,
+			     TEST_BLOCK, TEST_RATE);
+	  router_agc_apply (&app->agc, buffer, TEST_BLOCK, TEST_CHANNELS, 1.0f);
+	  router_loudness_process (&app->out, buffer, TEST_BLOCK);
+	}
+    }
+
+  RouterLoudnessReading out[2];
+  router_loudness_read (&apps[0].out, &out[0]);
+  router_loudness_read (&apps[1].out, &out[1]);
+  float gains[2] = {apps[0].agc.gain_db, apps[1].agc.gain_db};
+  free (apps);
+
+  if (!near (out[0].short_term_lufs, params.target_lufs, 0.3f)
+      || !near (out[1].short_term_lufs, params.target_lufs, 0.3f))
+    {
+      printf ("    ❌ FAIL: outputs %.2f / %.2f LUFS (gains %+.2f / %+.2f)\n",
+	      out[0].short_term_lufs, out[1].short_term_lufs, gains[0],
+	      gains[1]);
+      return 1;
+    }
+
+  printf ("    ✅ PASS: %.0f / %.0f LUFS -> %.2f / %.2f LUFS (%+.1f / %+.1f "
+	  "dB)\n",
+	  levels[0], levels[1], out[0].short_term_lufs,
+	  out[1].short_term_lufs, gains[0], gains[1]);
+  return 0;
+}
+
+static int
+test_params (void)
+{
+  printf ("  Testing AGC parameter validation...\n");
+
+  RouterAgcControl control;
+  router_agc_control_init (&control);
+  RouterAgcParams good = default_params ();
+  good.target_lufs = -23.0f;
+  int ok = router_agc_set_params (&control, &good);
+
+  int bad = 0;
+  RouterAgcParams p = good;
+  p.target_lufs = NAN;
+  bad += router_agc_set_params (&control, &p);
+  p = good;
+  p.max_boost_db = ROUTER_AGC_MAX_BOOST_DB + 1.0f;
+  bad += router_agc_set_params (&control, &p);
+  p = good;
+  p.max_cut_db = -1.0f;
+  bad += router_agc_set_params (&control, &p);
+  p = good;
+  p.attack_db_per_s = 0.0f;
+  bad += router_agc_set_params (&control, &p);
+
+  RouterAgcParams current;
+  router_agc_get_params (&control, &current);
+  if (ok != 0 || bad != -4 || current.target_lufs != -23.0f
+      || !current.enabled)
+    {
+      printf ("    ❌ FAIL: ok=%d bad=%d target=%.1f\n", ok, bad,
+	      current.target_lufs);
+      return 1;
+    }
+
+  printf ("    ✅ PASS: Out-of-range and NaN parameters rejected\n");
+  return 0;
+}
+
+int
+run_router_agc_tests (void)
+{
+  printf ("\n----------------------------------------\n");
+  printf ("Router AGC Tests\n");
+  printf ("----------------------------------------\n");
+
+  int failed = 0;
+  failed += test_rate_limits ();
+  failed += test_gate_and_disable ();
+  failed += test_ramp ();
+  failed += test_cross_app ();
+  failed += test_params ();
+
+  printf ("----------------------------------------\n");
+  if (failed == 0)
+    {
+      printf ("Router AGC Tests: PASSED ✅\n");
+    }
+  else
+    {
+      printf ("Router AGC Tests: %d FAILED ❌\n", failed);
+    }
+  printf ("----------------------------------------\n");
+
+  return failed;
+}
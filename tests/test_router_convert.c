@@ -0,0 +1,250 @@
+//
+// 输出格式转换测试
+//
+
+#include "router/router_convert.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#define TEST_FRAMES 48000
+#define TEST_SMOOTH 8 // 低频误差的平滑长度（约 0 ~ 3 kHz @ 48 kHz）
+
+static float g_input[TEST_FRAMES * 2];
+static int16_t g_output[TEST_FRAMES * 2];
+static double g_error[TEST_FRAMES];
+
+static int
+test_format_mapping (void)
+{
+  printf ("  Test: sample format mapping...\n");
+
+  RouterSampleFormat format;
+  struct
+  {
+    bool is_float, is_signed, high;
+    uint32_t bits, bytes;
+    int result;
+    RouterSampleFormat expected;
+  } cases[] = {
+    {true, false, false, 32, 4, 0, kRouterSampleFloat32},
+    {false, true, false, 16, 2, 0, kRouterSampleInt16},
+    {false, true, false, 24, 3, 0, kRouterSampleInt24},
+    {false, true, true, 24, 4, 0, kRouterSampleInt24High},
+    {false, true, false, 24, 4, 0, kRouterSampleInt24Low},
+    {false, true, false, 32, 4, 0, kRouterSampleInt32},
+    {true, false, false, 64, 8, -1, kRouterSampleFloat32},
+    {false, false, false, 16, 2, -1, kRouterSampleFloat32},
+    {false, true, false, 8, 1, -1, kRouterSampleFloat32},
+    {false, true, false, 20, 4, -1, kRouterSampleFloat32},
+  };
+  for (size_t i = 0; i < sizeof (cases) / sizeof (cases[0]); i++)
+    {
+      format = kRouterSampleFloat32;
+      int result = router_sample_format_from_pcm (cases[i].is_float,
+						  cases[i].is_signed,
+						  cases[i].high, cases[i].bits,
+						  cases[i].bytes, &format);
+      if (result != cases[i].result
+	  || (result == 0 && format != cases[i].expected))
+	{
+	  printf ("    ❌ FAIL: case %zu returned %d (%s)\n", i, result,
+		  router_sample_format_name (format));
+	  return 1;
+	}
+      if (result == 0
+	  && (router_sample_format_bytes (format) != cases[i].bytes
+	      || router_sample_format_bits (format) != cases[i].bits))
+	{
+	  printf ("    ❌ FAIL: case %zu size %u/%u\n", i,
+		  router_sample_format_bytes (format),
+		  router_sample_format_bits (format));
+	  return 1;
+	}
+    }
+
+  printf ("    ✅ PASS: float, 16/24/32-bit and 24-in-32 mapped\n");
+  return 0;
+}
+
+static int
+test_exact_conversion (void)
+{
+  printf ("  Test: undithered conversion and clipping...\n");
+
+  RouterDither dither;
+  router_dither_init (&dither, kRouterDitherOff);
+  const float src[6] = {0.5f, -0.5f, 1.0f, -1.0f, 2.0f, NAN};
+
+  int16_t out16[6];
+  router_convert_from_float (&dither, kRouterSampleInt16, src, out16, 3, 2);
+  const int16_t want16[6] = {16384, -16384, 32767, -32768, 32767, 0};
+  if (memcmp (out16, want16, sizeof (want16)) != 0)
+    {
+      printf ("    ❌ FAIL: int16 %d %d %d %d %d %d\n", out16[0], out16[1],
+	      out16[2], out16[3], out16[4], out16[5]);
+      return 1;
+    }
+
+  uint8_t out24[6 * 3];
+  router_convert_from_float (&dither, kRouterSampleInt24, src, out24, 3, 2);
+  const uint8_t want24[6 * 3] = {0x00, 0x00, 0x40, 0x00, 0x00, 0xC0,
+				 0xFF, 0xFF, 0x7F, 0x00, 0x00, 0x80,
+				 0xFF, 0xFF, 0x7F, 0x00, 0x00, 0x00};
+  if (memcmp (out24, want24, sizeof (want24)) != 0)
+    {
+      printf ("    ❌ FAIL: packed int24 bytes\n");
+      return 1;
+    }
+
+  int32_t high[6], low[6], out32[6];
+  router_convert_from_float (&dither, kRouterSampleInt24High, src, high, 3,
+			     2);
+  router_convert_from_float (&dither, kRouterSampleInt24Low, src, low, 3, 2);
+  router_convert_from_float (&dither, kRouterSampleInt32, src, out32, 3, 2);
+  const int32_t want_low[6] = {4194304, -4194304, 8388607, -8388608,
+			       8388607, 0};
+  for (int i = 0; i < 6; i++)
+    if (low[i] != want_low[i] || high[i] != (int32_t) ((uint32_t) low[i] << 8))
+      {
+	printf ("    ❌ FAIL: 24-in-32 sample %d: high %d low %d\n", i, high[i],
+		low[i]);
+	return 1;
+      }
+  if (out32[0] != 1073741824 || out32[1] != -1073741824
+      || out32[2] != 2147483520 || out32[3] != INT32_MIN || out32[5] != 0)
+    {
+      printf ("    ❌ FAIL: int32 %d %d %d %d\n", out32[0], out32[1],
+	      out32[2], out32[3]);
+      return 1;
+    }
+
+  printf ("    ✅ PASS: exact values, clipping and NaN in all formats\n");
+  return 0;
+}
+
+static int
+test_tpdf_dither (void)
+{
+  printf ("  Test: TPDF dither error statistics...\n");
+
+  // 非整数的直流电平：不加抖动时误差恒为 -0.3 LSB
+  const float level = 1000.3f;
+  for (uint32_t i = 0; i < TEST_FRAMES * 2; i++)
+    g_input[i] = level / 32768.0f;
+
+  RouterDither dither;
+  router_dither_init (&dither, kRouterDitherTpdf);
+  // 分多次调用，抖动序列应当连续
+  for (uint32_t done = 0; done < TEST_FRAMES; done += 1000)
+    router_convert_from_float (&dither, kRouterSampleInt16,
+			       g_input + done * 2, g_output + done * 2, 1000,
+			       2);
+
+  double sum = 0.0, sum_sq = 0.0, max_error = 0.0;
+  for (uint32_t i = 0; i < TEST_FRAMES * 2; i++)
+    {
+      double e = (double) g_output[i] - level;
+      sum += e;
+      sum_sq += e * e;
+      if (fabs (e) > max_error)
+	max_error = fabs (e);
+    }
+  double mean = sum / (TEST_FRAMES * 2);
+  double variance = sum_sq / (TEST_FRAMES * 2) - mean * mean;
+
+  // TPDF 抖动后误差在 ±1.5 LSB 内，均值为 0，方差约 1/12 + 1/6 = 0.25
+  if (max_error > 1.5 || fabs (mean) > 0.01 || variance < 0.2
+      || variance > 0.3)
+    {
+      printf ("    ❌ FAIL: mean %.4f, variance %.4f, max %.2f LSB\n", mean,
+	      variance, max_error);
+      return 1;
+    }
+
+  printf ("    ✅ PASS: mean %.4f LSB, variance %.3f LSB², max %.2f LSB\n",
+	  mean, variance, max_error);
+  return 0;
+}
+
+// 两级 8 点滑动平均（三角窗，旁瓣约 -26 dB）后的误差功率，近似低频段的噪声
+static double
+low_band_error (RouterDitherMode mode)
+{
+  for (uint32_t f = 0; f < TEST_FRAMES; f++)
+    {
+      g_input[2 * f] = 0.003f * sinf (2.0f * (float) M_PI * 997.0f * f
+				      / 48000.0f);
+      g_input[2 * f + 1] = -0.5f * g_input[2 * f];
+    }
+  RouterDither dither;
+  router_dither_init (&dither, mode);
+  router_convert_from_float (&dither, kRouterSampleInt16, g_input, g_output,
+			     TEST_FRAMES, 2);
+
+  double power = 0.0;
+  uint32_t count = 0;
+  for (uint32_t c = 0; c < 2; c++)
+    {
+      for (uint32_t f = 0; f < TEST_FRAMES; f++)
+	g_error[f] = g_output[2 * f + c] - g_input[2 * f + c] * 32768.0;
+      for (int pass = 0; pass < 2; pass++)
+	for (uint32_t f = TEST_FRAMES - 1; f >= TEST_SMOOTH; f--)
+	  {
+	    double sum = 0.0;
+	    for (uint32_t k = 0; k < TEST_SMOOTH; k++)
+	      sum += g_error[f - k];
+	    g_error[f] = sum / TEST_SMOOTH;
+	  }
+      for (uint32_t f = 2 * TEST_SMOOTH; f < TEST_FRAMES; f++, count++)
+	power += g_error[f] * g_error[f];
+    }
+  return power / count;
+}
+
+static int
+test_noise_shaping (void)
+{
+  printf ("  Test: noise shaping moves error out of the low band...\n");
+
+  double flat = low_band_error (kRouterDitherTpdf);
+  double shaped = low_band_error (kRouterDitherShaped);
+  double gain_db = 10.0 * log10 (shaped / flat);
+
+  if (!(gain_db < -10.0))
+    {
+      printf ("    ❌ FAIL: low-band error %.5f -> %.5f (%.1f dB)\n", flat,
+	      shaped, gain_db);
+      return 1;
+    }
+
+  printf ("    ✅ PASS: low-band error %.1f dB vs. flat TPDF\n", gain_db);
+  return 0;
+}
+
+int
+run_router_convert_tests (void)
+{
+  printf ("\n----------------------------------------\n");
+  printf ("Router Convert Tests\n");
+  printf ("----------------------------------------\n");
+
+  int failed = 0;
+  failed += test_format_mapping ();
+  failed += test_exact_conversion ();
+  failed += test_tpdf_dither ();
+  failed += test_noise_shaping ();
+
+  printf ("----------------------------------------\n");
+  if (failed == 0)
+    {
+      printf ("Router Convert Tests: PASSED ✅\n");
+    }
+  else
+    {
+      printf ("Router Convert Tests: %d FAILED ❌\n", failed);
+    }
+  printf ("----------------------------------------\n");
+
+  return failed;
+}
@@ -0,0 +1,376 @@
+//
+// FFT 与分块卷积器测试（可移植，不依赖音频硬件）
+//
+
+#include "router/router_backend.h"
+#include "router/router_convolver.h"
+#include "router/router_fft.h"
+#include "router/router_memory.h"
+#include <stdint.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define TEST_RATE 48000
+#define TEST_IR_FRAMES 1000 // 4 个分块，最后一块不满
+#define TEST_FRAMES 4000
+#define TEST_PI 3.141592653589793
+
+// 确定性伪随机数 (-1, 1)
+static float
+next_random (uint32_t *seed)
+{
+  *seed = *seed * 1664525u + 1013904223u;
+  return (float) ((double) (*seed >> 8) / 8388608.0 - 1.0);
+}
+
+static int
+test_fft (void)
+{
+  printf ("  Testing real FFT against direct DFT...\n");
+
+  static const uint32_t kSizes[] = {4, 16, 512};
+  for (size_t s = 0; s < sizeof (kSizes) / sizeof (kSizes[0]); s++)
+    {
+      const uint32_t n = kSizes[s];
+      RouterFft fft;
+      float input[512];
+      float re[257];
+      float im[257];
+      float output[512];
+      uint32_t seed = n;
+      for (uint32_t i = 0; i < n; i++)
+	input[i] = next_random (&seed);
+      if (router_fft_init (&fft, n) != 0)
+	{
+	  printf ("    ❌ FAIL: Could not plan size %u\n", n);
+	  return 1;
+	}
+      router_fft_forward (&fft, input, re, im);
+      router_fft_inverse (&fft, re, im, output);
+      router_fft_destroy (&fft);
+
+      double bin_error = 0.0;
+      for (uint32_t k = 0; k <= n / 2; k++)
+	{
+	  double dr = 0.0;
+	  double di = 0.0;
+	  for (uint32_t i = 0; i < n; i++)
+	    {
+	      double phase = 2.0 * TEST_PI * k * i / n;
+	      dr += input[i] * cos (phase);
+	      di -= input[i] * sin (phase);
+	    }
+	  bin_error = fmax (bin_error, fabs (re[k] - dr) + fabs (im[k] - di));
+	}
+      double round_trip = 0.0;
+      for (uint32_t i = 0; i < n; i++)
+	round_trip = fmax (round_trip, fabs (output[i] - input[i]));
+
+      if (bin_error > 1e-4 * n || round_trip > 1e-5)
+	{
+	  printf ("    ❌ FAIL: Size %u bin error %.2e, round trip %.2e\n", n,
+		  bin_error, round_trip);
+	  return 1;
+	}
+    }
+
+  RouterFft fft;
+  if (router_fft_init (&fft, 48) == 0 || router_fft_init (&fft, 2) == 0)
+    {
+      printf ("    ❌ FAIL: Invalid sizes accepted\n");
+      return 1;
+    }
+
+  printf ("    ✅ PASS: Sizes 4/16/512 match the DFT and invert exactly\n");
+  return 0;
+}
+
+// 按 chunk 帧一次交给卷积器处理整个信号
+static void
+run_convolver (RouterConvolver *convolver, float *buffer, uint32_t frames,
+	       uint32_t channels)
+{
+  // 不规则的块大小，覆盖跨分块边界和一次跨越多个分块的情况
+  static const uint32_t kChunks[] = {100, 333, 7, 600, 256, 1};
+  uint32_t done = 0;
+  for (uint32_t i = 0; done < frames; i++)
+    {
+      uint32_t chunk = kChunks[i % (sizeof (kChunks) / sizeof (kChunks[0]))];
+      if (chunk > frames - done)
+	chunk = frames - done;
+      convolver->processor.process (&convolver->processor,
+				    buffer + (size_t) done * channels, chunk);
+      done += chunk;
+    }
+}
+
+static int
+prepare (RouterConvolver *convolver, uint32_t channels)
+{
+  static float scratch[1024 * 2];
+  RouterDspFormat format = {TEST_RATE, 1024, channels, scratch};
+  router_convolver_init (convolver);
+  return convolver->processor.prepare (&convolver->processor, &format);
+}
+
+static int
+test_against_direct (void)
+{
+  printf ("  Testing partitioned convolution against direct convolution...\n");
+
+  static float ir[TEST_IR_FRAMES * 2];
+  static float input[TEST_FRAMES * 2];
+  static float buffer[TEST_FRAMES * 2];
+  uint32_t seed = 7;
+  for (uint32_t i = 0; i < TEST_IR_FRAMES * 2; i++)
+    ir[i] = next_random (&seed) * expf (-(float) (i / 2) / 300.0f);
+  for (uint32_t i = 0; i < TEST_FRAMES * 2; i++)
+    input[i] = next_random (&seed) * 0.5f;
+
+  RouterConvolver convolver;
+  RouterConvolverIr *stereo
+    = router_convolver_ir_create (ir, TEST_IR_FRAMES, 2, TEST_RATE, 0.5f);
+  if (prepare (&convolver, 2) != 0 || stereo == NULL
+      || stereo->partitions != 4)
+    {
+      printf ("    ❌ FAIL: Setup\n");
+      return 1;
+    }
+  router_convolver_set_ir (&convolver, stereo);
+  memcpy (buffer, input, sizeof (input));
+  run_convolver (&convolver, buffer, TEST_FRAMES, 2);
+  router_convolver_destroy (&convolver);
+
+  // 输出比输入晚一个分块
+  double max_error = 0.0;
+  for (uint32_t f = 0; f < TEST_FRAMES; f++)
+    {
+      for (uint32_t c = 0; c < 2; c++)
+	{
+	  double expected = 0.0;
+	  if (f >= ROUTER_CONVOLVER_BLOCK)
+	    {
+	      uint32_t t = f - ROUTER_CONVOLVER_BLOCK;
+	      for (uint32_t j = 0; j < TEST_IR_FRAMES && j <= t; j++)
+		expected += 0.5 * ir[j * 2 + c] * input[(t - j) * 2 + c];
+	    }
+	  max_error = fmax (max_error, fabs (buffer[f * 2 + c] - expected));
+	}
+    }
+
+  if (max_error > 1e-4)
+    {
+      printf ("    ❌ FAIL: Max error %.2e\n", max_error);
+      return 1;
+    }
+
+  printf ("    ✅ PASS: Stereo IR over irregular chunks, max error %.1e\n",
+	  max_error);
+  return 0;
+}
+
+static int
+test_latency_and_switching (void)
+{
+  printf ("  Testing latency, shared mono IR and IR switching...\n");
+
+  static float buffer[1024 * 2];
+  const float delta = 1.0f;
+  const float delayed[ROUTER_CONVOLVER_BLOCK + 1]
+    = {[ROUTER_CONVOLVER_BLOCK] = 1.0f};
+  RouterConvolver convolver;
+  if (prepare (&convolver, 2) != 0)
+    {
+      printf ("    ❌ FAIL: Prepare\n");
+      return 1;
+    }
+
+  // 未设置 IR：直通，没有延迟
+  for (uint32_t i = 0; i < 1024 * 2; i++)
+    buffer[i] = (float) i;
+  run_convolver (&convolver, buffer, 1024, 2);
+  bool passthrough = buffer[5] == 5.0f && !router_convolver_is_active (&convolver);
+
+  // 单位冲激 IR：输出等于输入延迟一个分块，两个声道共用
+  router_convolver_set_ir (
+    &convolver, router_convolver_ir_create (&delta, 1, 1, TEST_RATE, 1.0f));
+  memset (buffer, 0, sizeof (buffer));
+  buffer[0] = 1.0f;
+  buffer[1] = -1.0f;
+  run_convolver (&convolver, buffer, 1024, 2);
+  uint32_t peak_l = 0;
+  uint32_t peak_r = 0;
+  for (uint32_t f = 0; f < 1024; f++)
+    {
+      if (fabsf (buffer[f * 2]) > 0.5f)
+	peak_l = f;
+      if (fabsf (buffer[f * 2 + 1]) > 0.5f)
+	peak_r = f;
+    }
+  bool latency = peak_l == ROUTER_CONVOLVER_BLOCK
+		 && peak_r == ROUTER_CONVOLVER_BLOCK
+		 && fabsf (buffer[peak_r * 2 + 1] + 1.0f) < 1e-5f;
+
+  // 切换为纯延迟 IR：冲激再多延迟一个分块
+  router_convolver_set_ir (&convolver,
+			   router_convolver_ir_create (delayed,
+						       ROUTER_CONVOLVER_BLOCK
+							 + 1,
+						       1, TEST_RATE, 1.0f));
+  memset (buffer, 0, sizeof (buffer));
+  buffer[0] = 1.0f;
+  run_convolver (&convolver, buffer, 1024, 2);
+  bool switched = fabsf (buffer[2 * ROUTER_CONVOLVER_BLOCK * 2] - 1.0f) < 1e-5f;
+
+  // 采样率不一致：直通
+  router_convolver_set_ir (
+    &convolver, router_convolver_ir_create (&delta, 1, 1, 44100, 1.0f));
+  buffer[3] = 0.25f;
+  run_convolver (&convolver, buffer, 1024, 2);
+  bool mismatch
+    = buffer[3] == 0.25f && !router_convolver_is_active (&convolver);
+  router_convolver_destroy (&convolver);
+
+  if (!passthrough || !latency || !switched || !mismatch)
+    {
+      printf ("    ❌ FAIL: passthrough %d, latency %d (L %u R %u), switched "
+	      "%d, mismatch %d\n",
+	      passthrough, latency, peak_l, peak_r, switched, mismatch);
+      return 1;
+    }
+
+  printf ("    ✅ PASS: %d-frame latency, IR swap and rate mismatch\n",
+	  ROUTER_CONVOLVER_BLOCK);
+  return 0;
+}
+
+static int
+test_wav_and_limits (void)
+{
+  printf ("  Testing WAV IR loading and limits...\n");
+
+  char path[64];
+  snprintf (path, sizeof (path), "/tmp/audioctl_test_ir_%d.wav",
+	    (int) getpid ());
+  // 2 秒立体声 IR：左声道为冲激，右声道为 -6 dB 的冲激
+  const uint32_t frames = 2 * TEST_RATE;
+  float *samples = calloc ((size_t) frames * 2, sizeof (float));
+  RouterSink sink;
+  int written = -1;
+  if (samples != NULL)
+    {
+      samples[0] = 1.0f;
+      samples[1] = 0.5f;
+      if (router_sink_open_wav (&sink, path, TEST_RATE, 2) == 0)
+	{
+	  written = sink.write (&sink, samples, frames);
+	  if (router_sink_close (&sink) != 0)
+	    written = -1;
+	}
+    }
+
+  RouterConvolverIr *ir = router_convolver_ir_load_wav (path, 1.0f);
+  unlink (path);
+  bool loaded = written == 0 && ir != NULL && ir->channels == 2
+		&& ir->frames == frames && ir->sample_rate == TEST_RATE
+		&& ir->partitions == frames / ROUTER_CONVOLVER_BLOCK;
+
+  // 2 秒 IR 在 48 kHz 下的完整处理
+  static float buffer[1024 * 2];
+  RouterConvolver convolver;
+  bool convolved = false;
+  if (loaded && prepare (&convolver, 2) == 0)
+    {
+      router_convolver_set_ir (&convolver, ir);
+      ir = NULL;
+      memset (buffer, 0, sizeof (buffer));
+      buffer[0] = 1.0f;
+      buffer[1] = 1.0f;
+      run_convolver (&convolver, buffer, 1024, 2);
+      const float *out = buffer + ROUTER_CONVOLVER_BLOCK * 2;
+      convolved = fabsf (out[0] - 1.0f) < 1e-5f && fabsf (out[1] - 0.5f) < 1e-5f;
+      router_convolver_destroy (&convolver);
+    }
+  router_convolver_ir_destroy (ir);
+
+  // 过长、声道数无效、缺失的文件都被拒绝
+  bool rejected
+    = router_convolver_ir_create (samples, ROUTER_CONVOLVER_MAX_IR_FRAMES + 1,
+				  1, TEST_RATE, 1.0f)
+	== NULL
+      && router_convolver_ir_create (samples, 16, 0, TEST_RATE, 1.0f) == NULL
+      && router_convolver_ir_create (samples, 16, 1, TEST_RATE, NAN) == NULL
+      && router_convolver_ir_load_wav (path, 1.0f) == NULL;
+  free (samples);
+
+  if (!loaded || !convolved || !rejected)
+    {
+      printf ("    ❌ FAIL: loaded %d, convolved %d, rejected %d\n", loaded,
+	      convolved, rejected);
+      return 1;
+    }
+
+  printf ("    ✅ PASS: 2 s stereo WAV IR loaded (%u partitions) and applied\n",
+	  frames / ROUTER_CONVOLVER_BLOCK);
+  return 0;
+}
+
+static int
+test_locked_memory (void)
+{
+  printf ("  Testing locked real-time allocations...\n");
+
+  // 延迟线规模的分配：清零、对齐、整段可写
+  const size_t count = (size_t) 2 * ROUTER_CONVOLVER_MAX_PARTITIONS
+		       * ROUTER_CONVOLVER_BIN_STRIDE;
+  float *buffer = router_locked_alloc (count * sizeof (float));
+  bool zeroed = buffer != NULL && ((uintptr_t) buffer % 64) == 0;
+  for (size_t i = 0; zeroed && i < count; i++)
+    zeroed = buffer[i] == 0.0f;
+  if (buffer != NULL)
+    memset (buffer, 0xFF, count * sizeof (float));
+  bool locked = router_locked_is_locked (buffer);
+  router_locked_free (buffer);
+
+  if (!zeroed || router_locked_alloc (0) != NULL)
+    {
+      printf ("    ❌ FAIL: allocation not zeroed/aligned or size 0 accepted\n");
+      return 1;
+    }
+
+  // mlock 受 RLIMIT_MEMLOCK 限制，未锁定时只提示
+  printf ("    ✅ PASS: %zu KB zeroed and aligned (%s)\n",
+	  count * sizeof (float) / 1024, locked ? "locked" : "not locked");
+  return 0;
+}
+
+int
+run_router_convolver_tests (void)
+{
+  printf ("\n----------------------------------------\n");
+  printf ("Router Convolver Tests\n");
+  printf ("----------------------------------------\n");
+
+  int failed = 0;
+  failed += test_fft ();
+  failed += test_against_direct ();
+  failed += test_latency_and_switching ();
+  failed += test_wav_and_limits ();
+  failed += test_locked_memory ();
+
+  printf ("----------------------------------------\n");
+  if (failed == 0)
+    {
+      printf ("Router Convolver Tests: PASSED ✅\n");
+    }
+  else
+    {
+      printf ("Router Convolver Tests: %d FAILED ❌\n", failed);
+    }
+  printf ("----------------------------------------\n");
+
+  return failed;
+}
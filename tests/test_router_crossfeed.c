@@ -0,0 +1,256 @@
+//
+// 耳机交叉馈送测试（可移植，不依赖音频硬件）
+//
+
+#include "router/router_crossfeed.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#define TEST_RATE 48000
+#define TEST_BLOCK 512
+#define TEST_PI 3.141592653589793
+
+static void
+prepare (RouterCrossfeed *crossfeed, uint32_t channels)
+{
+  RouterDspFormat format = {TEST_RATE, TEST_BLOCK, channels, NULL};
+  router_crossfeed_init (crossfeed);
+  crossfeed->processor.prepare (&crossfeed->processor, &format);
+}
+
+// 生成 frames 帧立体声正弦（左右幅度分别为 left、right），从 phase 帧开始
+static void
+fill_sine (float *buffer, uint32_t frames, uint32_t phase, double freq,
+	   float left, float right)
+{
+  for (uint32_t f = 0; f < frames; f++)
+    {
+      float s = (float) sin (2.0 * TEST_PI * freq * (phase + f) / TEST_RATE);
+      buffer[2 * f] = left * s;
+      buffer[2 * f + 1] = right * s;
+    }
+}
+
+// 稳态下左右声道的有效值 (dB)：先跑 0.5 秒让滤波器和淡入稳定
+static void
+measure (RouterCrossfeed *crossfeed, double freq, float left, float right,
+	 double *left_db, double *right_db)
+{
+  float buffer[TEST_BLOCK * 2];
+  double sum[2] = {0.0, 0.0};
+  uint32_t phase = 0;
+  for (uint32_t b = 0; b < 100; b++)
+    {
+      fill_sine (buffer, TEST_BLOCK, phase, freq, left, right);
+      crossfeed->processor.process (&crossfeed->processor, buffer, TEST_BLOCK);
+      phase += TEST_BLOCK;
+      if (b < 50)
+	continue;
+      for (uint32_t f = 0; f < TEST_BLOCK; f++)
+	{
+	  sum[0] += (double) buffer[2 * f] * buffer[2 * f];
+	  sum[1] += (double) buffer[2 * f + 1] * buffer[2 * f + 1];
+	}
+    }
+  *left_db = 10.0 * log10 (sum[0] / (50.0 * TEST_BLOCK) + 1e-30);
+  *right_db = 10.0 * log10 (sum[1] / (50.0 * TEST_BLOCK) + 1e-30);
+}
+
+static int
+test_bypass (void)
+{
+  printf ("  Testing crossfeed bypass fast path...\n");
+
+  RouterCrossfeed crossfeed;
+  prepare (&crossfeed, 2);
+  float input[TEST_BLOCK * 2];
+  float buffer[TEST_BLOCK * 2];
+  fill_sine (input, TEST_BLOCK, 0, 1000.0, 0.8f, -0.3f);
+
+  memcpy (buffer, input, sizeof (buffer));
+  crossfeed.processor.process (&crossfeed.processor, buffer, TEST_BLOCK);
+  if (memcmp (buffer, input, sizeof (buffer)) != 0)
+    {
+      printf ("    ❌ FAIL: Disabled crossfeed changed the signal\n");
+      return 1;
+    }
+
+  // 启用后再关闭：淡出完成后恢复逐位直通
+  router_crossfeed_set (&crossfeed, true, kRouterCrossfeedMedium);
+  for (uint32_t b = 0; b < 4; b++)
+    {
+      memcpy (buffer, input, sizeof (buffer));
+      crossfeed.processor.process (&crossfeed.processor, buffer, TEST_BLOCK);
+    }
+  if (memcmp (buffer, input, sizeof (buffer)) == 0)
+    {
+      printf ("    ❌ FAIL: Enabled crossfeed left the signal unchanged\n");
+      return 1;
+    }
+  router_crossfeed_set (&crossfeed, false, kRouterCrossfeedMedium);
+  for (uint32_t b = 0; b < 3; b++)
+    {
+      memcpy (buffer, input, sizeof (buffer));
+      crossfeed.processor.process (&crossfeed.processor, buffer, TEST_BLOCK);
+    }
+  if (memcmp (buffer, input, sizeof (buffer)) != 0 || crossfeed.current != 0)
+    {
+      printf ("    ❌ FAIL: Signal not bit-exact after fading out\n");
+      return 1;
+    }
+
+  // 非立体声始终直通；无效预设被拒绝且不改变设置
+  RouterCrossfeed mono;
+  prepare (&mono, 1);
+  router_crossfeed_set (&mono, true, kRouterCrossfeedStrong);
+  memcpy (buffer, input, sizeof (buffer));
+  mono.processor.process (&mono.processor, buffer, TEST_BLOCK);
+  RouterCrossfeedPreset preset = kRouterCrossfeedLight;
+  if (memcmp (buffer, input, sizeof (buffer)) != 0
+      || router_crossfeed_set (&mono, true, kRouterCrossfeedPresetCount) == 0
+      || !router_crossfeed_get (&mono, &preset)
+      || preset != kRouterCrossfeedStrong)
+    {
+      printf ("    ❌ FAIL: Mono pass-through or preset validation broken\n");
+      return 1;
+    }
+
+  printf ("    ✅ PASS: Bit-exact when disabled, mono untouched\n");
+  return 0;
+}
+
+static int
+test_response (void)
+{
+  printf ("  Testing crossfeed levels per preset...\n");
+
+  static const double kFeedDb[kRouterCrossfeedPresetCount] = {9.5, 6.0, 4.5};
+  for (uint32_t p = 0; p < kRouterCrossfeedPresetCount; p++)
+    {
+      RouterCrossfeed crossfeed;
+      double l_db, r_db;
+
+      // 只有左声道：低频处右声道比左声道低约 feed dB
+      prepare (&crossfeed, 2);
+      router_crossfeed_set (&crossfeed, true, (RouterCrossfeedPreset) p);
+      measure (&crossfeed, 60.0, 0.5f, 0.0f, &l_db, &r_db);
+      double low_feed = l_db - r_db;
+
+      // 高频几乎不交叉
+      prepare (&crossfeed, 2);
+      router_crossfeed_set (&crossfeed, true, (RouterCrossfeedPreset) p);
+      measure (&crossfeed, 10000.0, 0.5f, 0.0f, &l_db, &r_db);
+      double high_feed = l_db - r_db;
+
+      // 单声道内容低频电平不变（-9.03 dB 为 0.5 幅度正弦的有效值）
+      prepare (&crossfeed, 2);
+      router_crossfeed_set (&crossfeed, true, (RouterCrossfeedPreset) p);
+      measure (&crossfeed, 60.0, 0.5f, 0.5f, &l_db, &r_db);
+      double mono_db = l_db - 20.0 * log10 (0.5 / sqrt (2.0));
+
+      if (fabs (low_feed - kFeedDb[p]) > 0.5 || high_feed < 20.0
+	  || fabs (mono_db) > 0.2 || fabs (l_db - r_db) > 1e-3)
+	{
+	  printf ("    ❌ FAIL: Preset %u low %.2f dB, high %.2f dB, "
+		  "mono %.2f dB\n",
+		  p, low_feed, high_feed, mono_db);
+	  return 1;
+	}
+    }
+
+  printf ("    ✅ PASS: Low-frequency feed matches presets, highs stay "
+	  "separated\n");
+  return 0;
+}
+
+static int
+test_delay_and_ramp (void)
+{
+  printf ("  Testing cross-path delay and click-free switching...\n");
+
+  // 淡入完成后送入左声道单位脉冲：右声道在延迟之前保持为 0
+  RouterCrossfeed crossfeed;
+  float buffer[TEST_BLOCK * 2];
+  prepare (&crossfeed, 2);
+  router_crossfeed_set (&crossfeed, true, kRouterCrossfeedStrong);
+  for (uint32_t b = 0; b < 4; b++)
+    {
+      memset (buffer, 0, sizeof (buffer));
+      crossfeed.processor.process (&crossfeed.processor, buffer, TEST_BLOCK);
+    }
+  memset (buffer, 0, sizeof (buffer));
+  buffer[0] = 1.0f;
+  crossfeed.processor.process (&crossfeed.processor, buffer, TEST_BLOCK);
+  uint32_t first = TEST_BLOCK;
+  for (uint32_t f = 0; f < TEST_BLOCK && first == TEST_BLOCK; f++)
+    if (buffer[2 * f + 1] != 0.0f)
+      first = f;
+  if (first != crossfeed.delay || crossfeed.delay < 1)
+    {
+      printf ("    ❌ FAIL: Cross path starts at frame %u, expected %u\n",
+	      first, crossfeed.delay);
+      return 1;
+    }
+
+  // 直流硬声像下开启、切换强度、关闭：相邻采样的跳变都很小
+  prepare (&crossfeed, 2);
+  float jump = 0.0f;
+  float last[2] = {0.5f, 0.0f};
+  for (uint32_t b = 0; b < 24; b++)
+    {
+      if (b == 2)
+	router_crossfeed_set (&crossfeed, true, kRouterCrossfeedLight);
+      else if (b == 10)
+	router_crossfeed_set (&crossfeed, true, kRouterCrossfeedStrong);
+      else if (b == 18)
+	router_crossfeed_set (&crossfeed, false, kRouterCrossfeedLight);
+      for (uint32_t f = 0; f < TEST_BLOCK; f++)
+	{
+	  buffer[2 * f] = 0.5f;
+	  buffer[2 * f + 1] = 0.0f;
+	}
+      crossfeed.processor.process (&crossfeed.processor, buffer, TEST_BLOCK);
+      for (uint32_t f = 0; f < TEST_BLOCK; f++)
+	for (uint32_t c = 0; c < 2; c++)
+	  {
+	    jump = fmaxf (jump, fabsf (buffer[2 * f + c] - last[c]));
+	    last[c] = buffer[2 * f + c];
+	  }
+    }
+  if (jump > 0.005f || last[0] != 0.5f || last[1] != 0.0f)
+    {
+      printf ("    ❌ FAIL: Largest step %.4f during switching\n", jump);
+      return 1;
+    }
+
+  printf ("    ✅ PASS: Cross path delayed %u frames, largest step %.4f\n",
+	  crossfeed.delay, jump);
+  return 0;
+}
+
+int
+run_router_crossfeed_tests (void)
+{
+  printf ("\n----------------------------------------\n");
+  printf ("Router Crossfeed Tests\n");
+  printf ("----------------------------------------\n");
+
+  int failed = 0;
+  failed += test_bypass ();
+  failed += test_response ();
+  failed += test_delay_and_ramp ();
+
+  printf ("----------------------------------------\n");
+  if (failed == 0)
+    {
+      printf ("Router Crossfeed Tests: PASSED ✅\n");
+    }
+  else
+    {
+      printf ("Router Crossfeed Tests: %d FAILED ❌\n", failed);
+    }
+  printf ("----------------------------------------\n");
+
+  return failed;
+}
@@ -0,0 +1,320 @@
+//
+// Router DSP 链测试（可移植，不依赖音频硬件）
+//
+
+#include "router/router_backend.h"
+#include "router/router_dsp.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_CHANNELS 2
+#define TEST_MAX_FRAMES 256
+
+// 测试处理器：out = in × scale + offset，记录调用情况
+typedef struct
+{
+  float scale;
+  float offset;
+  uint32_t prepares;
+  uint32_t max_chunk;
+  uint32_t channels;
+  _Atomic bool destroyed;
+} AffineState;
+
+static int
+affine_prepare (RouterDspProcessor *processor, const RouterDspFormat *format)
+{
+  AffineState *st = processor->state;
+  st->prepares++;
+  st->channels = format->channels;
+  return 0;
+}
+
+static void
+affine_process (RouterDspProcessor *processor, float *buffer, uint32_t frames)
+{
+  AffineState *st = processor->state;
+  if (atomic_load (&st->destroyed))
+    abort (); // 链替换后仍在使用已销毁的处理器
+  if (frames > st->max_chunk)
+    st->max_chunk = frames;
+  for (uint32_t i = 0; i < frames * st->channels; i++)
+    buffer[i] = buffer[i] * st->scale + st->offset;
+}
+
+static void
+affine_open (RouterDspProcessor *processor, AffineState *st, const char *name,
+	     float scale, float offset)
+{
+  memset (st, 0, sizeof (*st));
+  st->scale = scale;
+  st->offset = offset;
+  processor->name = name;
+  processor->prepare = affine_prepare;
+  processor->process = affine_process;
+  processor->tail_frames = 0;
+  processor->state = st;
+}
+
+static float g_scratch[TEST_MAX_FRAMES * TEST_CHANNELS];
+
+static void
+host_open (RouterDspHost *host)
+{
+  router_dsp_host_init (host);
+  RouterDspFormat format = {48000, TEST_MAX_FRAMES, TEST_CHANNELS, g_scratch};
+  router_dsp_host_configure (host, &format);
+}
+
+static int
+test_chain_order_and_bypass (void)
+{
+  printf ("  Testing DSP chain order, bypass and stats...\n");
+
+  RouterDspHost host;
+  host_open (&host);
+  RouterDspProcessor doubler;
+  RouterDspProcessor adder;
+  AffineState doubler_state;
+  AffineState adder_state;
+  affine_open (&doubler, &doubler_state, "double", 2.0f, 0.0f);
+  affine_open (&adder, &adder_state, "add", 1.0f, 1.0f);
+
+  RouterDspProcessor *chain[] = {&doubler, &adder};
+  float buffer[1000 * TEST_CHANNELS];
+  for (int i = 0; i < 1000 * TEST_CHANNELS; i++)
+    buffer[i] = 1.0f;
+
+  // (1 × 2) + 1 = 3；1000 帧按 256 帧拆分
+  if (router_dsp_host_set_chain (&host, chain, 2) != 0
+      || !router_dsp_host_process (&host, buffer, 1000, false)
+      || buffer[0] != 3.0f || buffer[1999] != 3.0f
+      || doubler_state.prepares != 1 || doubler_state.max_chunk != 256)
+    {
+      printf ("    ❌ FAIL: Chain output %f, max chunk %u\n", buffer[0],
+	      doubler_state.max_chunk);
+      router_dsp_host_destroy (&host);
+      return 1;
+    }
+
+  // 旁路第一级：3 + 1 = 4
+  router_dsp_host_set_bypass (&host, 0, true);
+  router_dsp_host_process (&host, buffer, 1000, false);
+  RouterDspStageStats stats[ROUTER_DSP_MAX_STAGES];
+  uint32_t count
+    = router_dsp_host_collect_stats (&host, stats, ROUTER_DSP_MAX_STAGES);
+  if (buffer[0] != 4.0f || count != 2 || !stats[0].bypass
+      || stats[0].calls != 4 || stats[1].calls != 8
+      || stats[1].frames != 2000 || strcmp (stats[1].name, "add") != 0
+      || router_dsp_host_set_bypass (&host, 2, true) != -1)
+    {
+      printf ("    ❌ FAIL: Bypass/stats wrong (out %f, calls %u/%u)\n",
+	      buffer[0], stats[0].calls, stats[1].calls);
+      router_dsp_host_destroy (&host);
+      return 1;
+    }
+
+  // 替换为保留旧处理器的新链：不重新 prepare，旁路标志和统计保留
+  float before[TEST_CHANNELS] = {0};
+  router_dsp_host_process (&host, before, 1, false);
+  RouterDspProcessor *reordered[] = {&adder, &doubler};
+  router_dsp_host_set_chain (&host, reordered, 2);
+  router_dsp_host_process (&host, buffer, 1, false);
+  count = router_dsp_host_collect_stats (&host, stats, ROUTER_DSP_MAX_STAGES);
+  if (doubler_state.prepares != 1 || buffer[0] != 5.0f || count != 2
+      || !stats[1].bypass || stats[0].calls != 2 || stats[0].frames != 2)
+    {
+      printf ("    ❌ FAIL: Reused processors lost state (out %f)\n",
+	      buffer[0]);
+      router_dsp_host_destroy (&host);
+      return 1;
+    }
+
+  router_dsp_host_destroy (&host);
+  printf ("    ✅ PASS: Stages run in order, bypass and stats per stage\n");
+  return 0;
+}
+
+static int
+test_silence_tail (void)
+{
+  printf ("  Testing DSP chain silence tail...\n");
+
+  RouterDspHost host;
+  host_open (&host);
+  RouterDspProcessor adder;
+  AffineState adder_state;
+  affine_open (&adder, &adder_state, "add", 1.0f, 1.0f);
+  adder.tail_frames = 300;
+  RouterDspProcessor *chain[] = {&adder};
+  router_dsp_host_set_chain (&host, chain, 1);
+
+  // 有声块之后的静音块在 300 帧尾音内照常处理，之后跳过
+  float buffer[128 * TEST_CHANNELS] = {0};
+  bool processed[5];
+  processed[0] = router_dsp_host_process (&host, buffer, 128, false);
+  for (int i = 1; i < 5; i++)
+    processed[i] = router_dsp_host_process (&host, buffer, 128, true);
+  router_dsp_host_destroy (&host);
+
+  if (!processed[0] || !processed[1] || !processed[2] || !processed[3]
+      || processed[4])
+    {
+      printf ("    ❌ FAIL: Tail handling wrong\n");
+      return 1;
+    }
+
+  printf ("    ✅ PASS: Silent blocks skipped after the chain tail\n");
+  return 0;
+}
+
+// 模拟输出 IOProc：不停处理，检查每块输出来自同一条完整的链
+typedef struct
+{
+  RouterDspHost *host;
+  _Atomic bool running;
+  _Atomic uint32_t blocks;
+  _Atomic uint32_t torn;
+} RealtimeThreadState;
+
+static void *
+realtime_thread (void *arg)
+{
+  RealtimeThreadState *st = arg;
+  float buffer[64 * TEST_CHANNELS];
+  while (atomic_load (&st->running))
+    {
+      memset (buffer, 0, sizeof (buffer));
+      router_dsp_host_process (st->host, buffer, 64, false);
+      for (int i = 1; i < 64 * TEST_CHANNELS; i++)
+	{
+	  if (buffer[i] != buffer[0])
+	    {
+	      atomic_fetch_add (&st->torn, 1);
+	      break;
+	    }
+	}
+      atomic_fetch_add (&st->blocks, 1);
+    }
+  return NULL;
+}
+
+static int
+test_lock_free_swap (void)
+{
+  printf ("  Testing DSP chain swap under concurrent processing...\n");
+
+  RouterDspHost host;
+  host_open (&host);
+  RealtimeThreadState rt = {&host, true, 0, 0};
+  pthread_t thread;
+  pthread_create (&thread, NULL, realtime_thread, &rt);
+
+  // 每次都用新处理器替换整条链，替换返回后立即销毁旧处理器；
+  // 每次替换前等实时线程至少处理一块，保证两边真正交错
+  RouterDspProcessor processors[2];
+  AffineState states[2];
+  int swaps = 0;
+  for (int i = 0; i < 200; i++)
+    {
+      uint32_t seen = atomic_load (&rt.blocks);
+      while (atomic_load (&rt.blocks) == seen)
+	sched_yield ();
+      int slot = i % 2;
+      affine_open (&processors[slot], &states[slot], "swap", 1.0f,
+		   (float) (slot + 1));
+      RouterDspProcessor *chain[] = {&processors[slot]};
+      if (router_dsp_host_set_chain (&host, chain, 1) == 0)
+	swaps++;
+      atomic_store (&states[1 - slot].destroyed, true);
+    }
+  router_dsp_host_set_chain (&host, NULL, 0);
+
+  atomic_store (&rt.running, false);
+  pthread_join (thread, NULL);
+  router_dsp_host_destroy (&host);
+
+  if (swaps != 200 || atomic_load (&rt.torn) != 0
+      || atomic_load (&rt.blocks) == 0)
+    {
+      printf ("    ❌ FAIL: swaps=%d torn=%u blocks=%u\n", swaps,
+	      atomic_load (&rt.torn), atomic_load (&rt.blocks));
+      return 1;
+    }
+
+  printf ("    ✅ PASS: %d swaps while processing %u blocks\n", swaps,
+	  atomic_load (&rt.blocks));
+  return 0;
+}
+
+static int
+test_offline_chain (void)
+{
+  printf ("  Testing DSP chain in the offline pipeline...\n");
+
+  RouterDspHost host;
+  router_dsp_host_init (&host);
+  RouterDspProcessor halver;
+  AffineState halver_state;
+  affine_open (&halver, &halver_state, "half", 0.5f, 0.0f);
+  RouterDspProcessor *chain[] = {&halver};
+  router_dsp_host_set_chain (&host, chain, 1);
+
+  RouterSource source;
+  RouterSink sink;
+  router_source_open_synthetic (&source, 48000, 2, 10000);
+  router_sink_open_null (&sink, 48000, 2);
+  RouterOfflineConfig config
+    = {.block_frames = 300, .gain = 1.0f, .dsp = &host};
+  RouterOfflineStats offline_stats;
+  int result = router_offline_run (&source, &sink, &config, &offline_stats);
+  router_sink_close (&sink);
+  router_source_close (&source);
+
+  RouterDspStageStats stats;
+  uint32_t count = router_dsp_host_collect_stats (&host, &stats, 1);
+  router_dsp_host_destroy (&host);
+
+  // 离线管线按源格式和块大小配置链，所有输出帧都经过处理器
+  if (result != 0 || halver_state.prepares != 1 || count != 1
+      || stats.frames != 10000 || halver_state.max_chunk != 300)
+    {
+      printf ("    ❌ FAIL: result=%d prepares=%u frames=%llu\n", result,
+	      halver_state.prepares, (unsigned long long) stats.frames);
+      return 1;
+    }
+
+  printf ("    ✅ PASS: Offline run prepares and runs the chain\n");
+  return 0;
+}
+
+int
+run_router_dsp_tests (void)
+{
+  printf ("\n----------------------------------------\n");
+  printf ("Router DSP Chain Tests\n");
+  printf ("----------------------------------------\n");
+
+  int failed = 0;
+  failed += test_chain_order_and_bypass ();
+  failed += test_silence_tail ();
+  failed += test_lock_free_swap ();
+  failed += test_offline_chain ();
+
+  printf ("----------------------------------------\n");
+  if (failed == 0)
+    {
+      printf ("Router DSP Chain Tests: PASSED ✅\n");
+    }
+  else
+    {
+      printf ("Router DSP Chain Tests: %d FAILED ❌\n", failed);
+    }
+  printf ("----------------------------------------\n");
+
+  return failed;
+}
@@ -0,0 +1,228 @@
+//
+// 自动闪避测试（可移植，不依赖音频硬件）
+//
+
+#include "router/router_agc.h"
+#include "router/router_duck.h"
+#include <math.h>
+#include <stdio.h>
+
+#define TEST_RATE 48000
+#define TEST_BLOCK 480		  // 10ms
+#define TEST_BLOCK_NS 10000000ULL // 10ms
+
+static RouterDuckParams
+enabled_params (RouterDuckControl *control)
+{
+  router_duck_control_init (control);
+  RouterDuckParams params;
+  router_duck_get_params (control, &params);
+  params.enabled = true;
+  router_duck_set_params (control, &params);
+  return params;
+}
+
+// 运行 blocks 块：人声通道以 voice_lufs 上报，媒体通道更新增益
+// 返回最后一块的媒体增益
+static float
+run_blocks (RouterDuckControl *control, const RouterDuckParams *params,
+	    RouterDuck *media, uint64_t *now_ns, uint32_t blocks,
+	    float voice_lufs)
+{
+  float gain = media->gain_db;
+  for (uint32_t i = 0; i < blocks; i++)
+    {
+      *now_ns += TEST_BLOCK_NS;
+      router_duck_report_voice (control, params, voice_lufs, *now_ns);
+      bool engaged = router_duck_is_engaged (control, params, *now_ns);
+      gain = router_duck_update (media, params, engaged, TEST_BLOCK, TEST_RATE);
+    }
+  return gain;
+}
+
+static bool
+near (float value, float expected, float tolerance)
+{
+  return fabsf (value - expected) <= tolerance;
+}
+
+static int
+test_attack_hold_release (void)
+{
+  printf ("  Testing ducking attack/hold/release timing...\n");
+
+  // 默认：深度 12 dB，起音 150ms，保持 1000ms，释放 1500ms
+  RouterDuckControl control;
+  RouterDuckParams params = enabled_params (&control);
+  RouterDuck media;
+  router_duck_init (&media);
+  uint64_t now = 1;
+  const float silent = -120.0f;
+
+  float before = run_blocks (&control, &params, &media, &now, 10, silent);
+  float half_attack = run_blocks (&control, &params, &media, &now, 7, -20.0f);
+  float ducked = run_blocks (&control, &params, &media, &now, 93, -20.0f);
+  // 人声停止：保持期内不恢复
+  float held = run_blocks (&control, &params, &media, &now, 99, silent);
+  // 保持结束后 750ms 恢复一半，1500ms 完全恢复
+  float half_release = run_blocks (&control, &params, &media, &now, 76, silent);
+  float released = run_blocks (&control, &params, &media, &now, 80, silent);
+
+  if (before != 0.0f || !near (half_attack, -5.6f, 0.01f) || ducked != -12.0f
+      || held != -12.0f || !near (half_release, -6.0f, 0.1f)
+      || released != 0.0f)
+    {
+      printf ("    ❌ FAIL: %.2f -> %.2f -> %.2f, held %.2f, release %.2f -> "
+	      "%.2f\n",
+	      before, half_attack, ducked, held, half_release, released);
+      return 1;
+    }
+
+  printf ("    ✅ PASS: 0 -> %.1f dB in 150ms, held 1s, %.1f dB at half "
+	  "release\n",
+	  ducked, half_release);
+  return 0;
+}
+
+static int
+test_threshold_and_disable (void)
+{
+  printf ("  Testing ducking threshold and disable...\n");
+
+  RouterDuckControl control;
+  RouterDuckParams params = enabled_params (&control);
+  RouterDuck media;
+  router_duck_init (&media);
+  uint64_t now = 1;
+
+  // 低于门限的人声（底噪、回声）不触发闪避
+  float quiet = run_blocks (&control, &params, &media, &now, 50, -50.0f);
+
+  // 闪避中关闭：不再判定为闪避，按释放时间恢复
+  run_blocks (&control, &params, &media, &now, 50, -20.0f);
+  params.enabled = false;
+  bool engaged = router_duck_is_engaged (&control, &params, now);
+  float releasing
+    = run_blocks (&control, &params, &media, &now, 75, -20.0f);
+  float released = run_blocks (&control, &params, &media, &now, 76, -20.0f);
+
+  // 关闭时上报的人声不记录：重新启用后不会立即闪避
+  params.enabled = true;
+  bool stale = router_duck_is_engaged (&control, &params, now);
+
+  if (quiet != 0.0f || engaged || !near (releasing, -6.0f, 0.1f)
+      || released != 0.0f || stale)
+    {
+      printf ("    ❌ FAIL: quiet %.2f, engaged %d, releasing %.2f, "
+	      "released %.2f, stale %d\n",
+	      quiet, engaged, releasing, released, stale);
+      return 1;
+    }
+
+  printf ("    ✅ PASS: Below-threshold voice ignored, disable releases\n");
+  return 0;
+}
+
+static int
+test_agc_ramp (void)
+{
+  printf ("  Testing ducking through the per-client gain ramp...\n");
+
+  // 均衡关闭时闪避增益仍经由增益斜坡施加，块内逐采样插值
+  RouterAgcControl control;
+  router_agc_control_init (&control);
+  RouterAgcParams params;
+  router_agc_get_params (&control, &params);
+  RouterAgc agc;
+  router_agc_init (&agc);
+
+  static float buffer[TEST_BLOCK * 2];
+  for (uint32_t i = 0; i < TEST_BLOCK * 2; i++)
+    buffer[i] = 1.0f;
+  router_agc_update (&agc, &params, -20.0f, -12.0f, TEST_BLOCK, TEST_RATE);
+  bool active = router_agc_is_active (&agc);
+  router_agc_apply (&agc, buffer, TEST_BLOCK, 2, 1.0f);
+  float end = buffer[(TEST_BLOCK - 1) * 2];
+  float mid = buffer[(TEST_BLOCK / 2 - 1) * 2];
+
+  router_agc_update (&agc, &params, -20.0f, 0.0f, TEST_BLOCK, TEST_RATE);
+  router_agc_update (&agc, &params, -20.0f, 0.0f, TEST_BLOCK, TEST_RATE);
+  bool idle = !router_agc_is_active (&agc);
+
+  const float expected = 0.2512f; // -12 dB
+  if (!active || !near (end, expected, 1e-3f)
+      || !near (mid, (1.0f + expected) / 2.0f, 1e-3f) || !idle
+      || router_agc_read_gain_db (&agc) != 0.0f)
+    {
+      printf ("    ❌ FAIL: active %d, mid %.4f, end %.4f, idle %d\n", active,
+	      mid, end, idle);
+      return 1;
+    }
+
+  printf ("    ✅ PASS: 1.0 -> %.4f (-12 dB) ramped within one block\n", end);
+  return 0;
+}
+
+static int
+test_params (void)
+{
+  printf ("  Testing ducking parameter validation...\n");
+
+  RouterDuckControl control;
+  RouterDuckParams good = enabled_params (&control);
+  good.hold_ms = 0.0f;
+  int ok = router_duck_set_params (&control, &good);
+
+  int bad = 0;
+  RouterDuckParams p = good;
+  p.depth_db = NAN;
+  bad += router_duck_set_params (&control, &p);
+  p = good;
+  p.threshold_lufs = 0.0f;
+  bad += router_duck_set_params (&control, &p);
+  p = good;
+  p.attack_ms = 0.0f;
+  bad += router_duck_set_params (&control, &p);
+  p = good;
+  p.release_ms = ROUTER_DUCK_MAX_TIME_MS * 2.0f;
+  bad += router_duck_set_params (&control, &p);
+
+  RouterDuckParams current;
+  router_duck_get_params (&control, &current);
+  if (ok != 0 || bad != -4 || current.hold_ms != 0.0f || !current.enabled)
+    {
+      printf ("    ❌ FAIL: ok=%d bad=%d hold=%.1f\n", ok, bad,
+	      current.hold_ms);
+      return 1;
+    }
+
+  printf ("    ✅ PASS: Out-of-range and NaN parameters rejected\n");
+  return 0;
+}
+
+int
+run_router_duck_tests (void)
+{
+  printf ("\n----------------------------------------\n");
+  printf ("Router Ducking Tests\n");
+  printf ("----------------------------------------\n");
+
+  int failed = 0;
+  failed += test_attack_hold_release ();
+  failed += test_threshold_and_disable ();
+  failed += test_agc_ramp ();
+  failed += test_params ();
+
+  printf ("----------------------------------------\n");
+  if (failed == 0)
+    {
+      printf ("Router Ducking Tests: PASSED ✅\n");
+    }
+  else
+    {
+      printf ("Router Ducking Tests: %d FAILED ❌\n", failed);
+    }
+  printf ("----------------------------------------\n");
+
+  return failed;
+}
@@ -0,0 +1,395 @@
+//
+// Router 参数均衡器测试（可移植，不依赖音频硬件）
+//
+
+#include "router/router_eq.h"
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_RATE 48000
+#define TEST_MAX_FRAMES 256
+#define TEST_TWO_PI 6.283185307179586
+
+static float g_scratch[TEST_MAX_FRAMES * ROUTER_EQ_MAX_CHANNELS];
+
+static void
+eq_open (RouterEq *eq, uint32_t channels)
+{
+  router_eq_init (eq);
+  RouterDspFormat format = {TEST_RATE, TEST_MAX_FRAMES, channels, g_scratch};
+  eq->processor.prepare (&eq->processor, &format);
+}
+
+// 生成交错正弦块，所有声道相同；phase 跨块连续
+static void
+fill_sine (float *buffer, uint32_t frames, uint32_t channels, double freq,
+	   double *phase)
+{
+  for (uint32_t f = 0; f < frames; f++)
+    {
+      float v = (float) (0.25 * sin (*phase));
+      for (uint32_t c = 0; c < channels; c++)
+	buffer[f * channels + c] = v;
+      *phase += TEST_TWO_PI * freq / TEST_RATE;
+    }
+}
+
+static int
+test_design_response (void)
+{
+  printf ("  Testing EQ filter design response...\n");
+
+  struct
+  {
+    RouterEqBand band;
+    double freq;
+    double min_db;
+    double max_db;
+  } cases[] = {
+    {{kRouterEqPeaking, true, 1000.0f, 6.0f, 1.0f}, 1000.0, 5.99, 6.01},
+    {{kRouterEqPeaking, true, 1000.0f, 6.0f, 1.0f}, 20.0, -0.05, 0.05},
+    {{kRouterEqLowShelf, true, 100.0f, -6.0f, 0.707f}, 20.0, -6.1, -5.5},
+    {{kRouterEqLowShelf, true, 100.0f, -6.0f, 0.707f}, 10000.0, -0.05, 0.05},
+    {{kRouterEqHighShelf, true, 8000.0f, 4.0f, 0.707f}, 20000.0, 3.5, 4.1},
+    {{kRouterEqHighPass, true, 100.0f, 0.0f, 0.707f}, 100.0, -3.1, -2.9},
+    {{kRouterEqHighPass, true, 100.0f, 0.0f, 0.707f}, 20.0, -100.0, -25.0},
+    {{kRouterEqLowPass, true, 1000.0f, 0.0f, 0.707f}, 10000.0, -100.0, -35.0},
+    {{kRouterEqLowPass, true, 1000.0f, 0.0f, 0.707f}, 50.0, -0.05, 0.05},
+    {{kRouterEqPeaking, false, 1000.0f, 6.0f, 1.0f}, 1000.0, -0.001, 0.001},
+  };
+  for (size_t i = 0; i < sizeof (cases) / sizeof (cases[0]); i++)
+    {
+      RouterEqBiquad coeffs;
+      router_eq_design (&cases[i].band, TEST_RATE, &coeffs);
+      double db = router_eq_response_db (&coeffs, cases[i].freq, TEST_RATE);
+      if (!(db >= cases[i].min_db && db <= cases[i].max_db))
+	{
+	  printf ("    ❌ FAIL: Case %zu: %.3f dB at %.0f Hz\n", i, db,
+		  cases[i].freq);
+	  return 1;
+	}
+    }
+
+  printf ("    ✅ PASS: Peaking, shelf, HPF and LPF responses match\n");
+  return 0;
+}
+
+static int
+test_config_validation (void)
+{
+  printf ("  Testing EQ parameter validation...\n");
+
+  RouterEq eq;
+  router_eq_init (&eq);
+  RouterEqBand good = {kRouterEqPeaking, true, 1000.0f, 3.0f, 1.0f};
+  RouterEqBand bad[] = {
+    {kRouterEqPeaking, true, 5.0f, 3.0f, 1.0f},
+    {kRouterEqPeaking, true, 1000.0f, 30.0f, 1.0f},
+    {kRouterEqPeaking, true, 1000.0f, NAN, 1.0f},
+    {kRouterEqPeaking, true, 1000.0f, 3.0f, 0.0f},
+    {kRouterEqTypeCount, true, 1000.0f, 3.0f, 1.0f},
+  };
+  RouterEqBand many[ROUTER_EQ_MAX_BANDS + 1];
+  for (int i = 0; i <= ROUTER_EQ_MAX_BANDS; i++)
+    many[i] = good;
+
+  int failed = router_eq_set_config (&eq, true, 0.0f, &good, 1) != 0;
+  for (size_t i = 0; i < sizeof (bad) / sizeof (bad[0]); i++)
+    failed += router_eq_set_config (&eq, true, 0.0f, &bad[i], 1) != -1;
+  failed += router_eq_set_config (&eq, true, 0.0f, many,
+				  ROUTER_EQ_MAX_BANDS + 1)
+	    != -1;
+  failed += router_eq_set_config (&eq, true, NAN, &good, 1) != -1;
+  // 被拒绝的设置不改变已保存的参数
+  failed += eq.band_count != 1 || eq.bands[0].gain_db != 3.0f;
+  router_eq_destroy (&eq);
+
+  if (failed != 0)
+    {
+      printf ("    ❌ FAIL: %d validation checks wrong\n", failed);
+      return 1;
+    }
+
+  printf ("    ✅ PASS: Out-of-range parameters rejected\n");
+  return 0;
+}
+
+// 稳态增益：处理 0.5 秒正弦，取后半段峰值与输入峰值之比
+static double
+measure_gain (RouterEq *eq, uint32_t channels, double freq, bool *mismatch)
+{
+  float buffer[TEST_MAX_FRAMES * ROUTER_EQ_MAX_CHANNELS];
+  double phase = 0.0;
+  float peak = 0.0f;
+  *mismatch = false;
+  for (int block = 0; block < TEST_RATE / 2 / TEST_MAX_FRAMES; block++)
+    {
+      fill_sine (buffer, TEST_MAX_FRAMES, channels, freq, &phase);
+      eq->processor.process (&eq->processor, buffer, TEST_MAX_FRAMES);
+      for (uint32_t i = 0; i < TEST_MAX_FRAMES * channels; i++)
+	{
+	  if (block > TEST_RATE / 4 / TEST_MAX_FRAMES)
+	    peak = fmaxf (peak, fabsf (buffer[i]));
+	  if (buffer[i] != buffer[i - i % channels])
+	    *mismatch = true;
+	}
+    }
+  return peak / 0.25;
+}
+
+static int
+test_process_gain (void)
+{
+  printf ("  Testing EQ processing gain per channel count...\n");
+
+  // 立体声走展开路径，3 声道走通用路径，结果应一致
+  RouterEqBand bands[] = {
+    {kRouterEqPeaking, true, 1000.0f, 6.0f, 1.0f},
+    {kRouterEqHighPass, true, 30.0f, 0.0f, 0.707f},
+  };
+  uint32_t channel_counts[] = {2, 3, 1};
+  for (int i = 0; i < 3; i++)
+    {
+      RouterEq eq;
+      router_eq_init (&eq);
+      router_eq_set_config (&eq, true, -2.0f, bands, 2);
+      RouterDspFormat format
+	= {TEST_RATE, TEST_MAX_FRAMES, channel_counts[i], g_scratch};
+      eq.processor.prepare (&eq.processor, &format);
+      bool mismatch;
+      double gain = measure_gain (&eq, channel_counts[i], 1000.0, &mismatch);
+      router_eq_destroy (&eq);
+
+      // +6 dB 峰值与 -2 dB 前级叠加为 +4 dB（约 1.585 倍）
+      if (fabs (gain - 1.585) > 0.02 || mismatch
+	  || eq.processor.tail_frames != TEST_RATE * ROUTER_EQ_TAIL_MS / 1000)
+	{
+	  printf ("    ❌ FAIL: %u ch gain %.4f mismatch=%d\n",
+		  channel_counts[i], gain, mismatch);
+	  return 1;
+	}
+    }
+
+  // 关闭时直通，输出逐位不变
+  RouterEq eq;
+  eq_open (&eq, 2);
+  float buffer[TEST_MAX_FRAMES * 2];
+  float original[TEST_MAX_FRAMES * 2];
+  double phase = 0.0;
+  fill_sine (buffer, TEST_MAX_FRAMES, 2, 440.0, &phase);
+  memcpy (original, buffer, sizeof (buffer));
+  eq.processor.process (&eq.processor, buffer, TEST_MAX_FRAMES);
+  router_eq_destroy (&eq);
+  if (memcmp (buffer, original, sizeof (buffer)) != 0)
+    {
+      printf ("    ❌ FAIL: Disabled EQ altered the signal\n");
+      return 1;
+    }
+
+  printf ("    ✅ PASS: Gain matches design, channels identical, flat is "
+	  "bit-exact\n");
+  return 0;
+}
+
+#define RAMP_TEST_BLOCKS 400
+static float g_ramp_output[RAMP_TEST_BLOCKS * TEST_MAX_FRAMES];
+
+// 对 1 kHz 正弦依次改变参数，记录左声道；返回相邻采样差与局部包络所允许
+// 上限（2π f / fs × 前后一个周期内的峰值）之比的最大值
+static double
+run_ramp_sequence (RouterEq *eq)
+{
+  RouterEqBand boost = {kRouterEqPeaking, true, 1000.0f, 12.0f, 1.0f};
+  RouterEqBand cut = {kRouterEqLowShelf, true, 2000.0f, -12.0f, 0.707f};
+  float buffer[TEST_MAX_FRAMES * 2];
+  double phase = 0.0;
+  for (int block = 0; block < RAMP_TEST_BLOCKS; block++)
+    {
+      if (block == 50)
+	router_eq_set_config (eq, true, 0.0f, &boost, 1);
+      else if (block == 150)
+	router_eq_set_config (eq, true, 0.0f, &cut, 1);
+      else if (block == 151)
+	router_eq_set_config (eq, true, 6.0f, &boost, 1); // 过渡途中改目标
+      else if (block == 250)
+	router_eq_set_config (eq, false, 0.0f, NULL, 0);
+
+      fill_sine (buffer, TEST_MAX_FRAMES, 2, 1000.0, &phase);
+      eq->processor.process (&eq->processor, buffer, TEST_MAX_FRAMES);
+      for (uint32_t f = 0; f < TEST_MAX_FRAMES; f++)
+	g_ramp_output[block * TEST_MAX_FRAMES + f] = buffer[f * 2];
+    }
+
+  const double slope = TEST_TWO_PI * 1000.0 / TEST_RATE;
+  const int period = TEST_RATE / 1000;
+  const int total = RAMP_TEST_BLOCKS * TEST_MAX_FRAMES;
+  double worst = 0.0;
+  for (int n = period; n < total - period; n++)
+    {
+      float envelope = 0.0f;
+      for (int k = n - period; k <= n + period; k++)
+	envelope = fmaxf (envelope, fabsf (g_ramp_output[k]));
+      double ratio
+	= fabs (g_ramp_output[n] - g_ramp_output[n - 1]) / (slope * envelope);
+      if (ratio > worst)
+	worst = ratio;
+    }
+  return worst;
+}
+
+// 区间内的输出峰值与输入幅度之比
+static double
+ramp_output_gain (int first_block, int last_block)
+{
+  float peak = 0.0f;
+  for (int n = first_block * TEST_MAX_FRAMES; n < last_block * TEST_MAX_FRAMES;
+       n++)
+    peak = fmaxf (peak, fabsf (g_ramp_output[n]));
+  return peak / 0.25;
+}
+
+static int
+test_click_free_ramp (void)
+{
+  printf ("  Testing EQ coefficient ramp is click-free...\n");
+
+  // 对照：把过渡缩短为 1 帧（系数突变）
+  RouterEq eq;
+  eq_open (&eq, 2);
+  eq.ramp_frames = 1;
+  double abrupt = run_ramp_sequence (&eq);
+  router_eq_destroy (&eq);
+
+  eq_open (&eq, 2);
+  double smooth = run_ramp_sequence (&eq);
+  router_eq_destroy (&eq);
+
+  // 第二次改目标后稳定在 +18 dB（约 7.94 倍）；关闭后回到直通
+  double boosted = ramp_output_gain (200, 250);
+  double flat = ramp_output_gain (300, RAMP_TEST_BLOCKS);
+  if (smooth > 1.25 || abrupt < 2.0 || fabs (boosted - 7.94) > 0.1
+      || fabs (flat - 1.0) > 0.001)
+    {
+      printf ("    ❌ FAIL: step ratio %.3f (abrupt %.3f), gain %.3f/%.3f\n",
+	      smooth, abrupt, boosted, flat);
+      return 1;
+    }
+
+  printf ("    ✅ PASS: Parameter changes ramp without discontinuities "
+	  "(step ratio %.2f, abrupt %.2f)\n",
+	  smooth, abrupt);
+  return 0;
+}
+
+// 实时线程不停处理，控制线程并发修改参数
+typedef struct
+{
+  RouterEq *eq;
+  _Atomic bool running;
+  _Atomic uint32_t blocks;
+  _Atomic uint32_t invalid;
+} RealtimeThreadState;
+
+static void *
+realtime_thread (void *arg)
+{
+  RealtimeThreadState *st = arg;
+  float buffer[64 * 2];
+  double phase = 0.0;
+  while (atomic_load (&st->running))
+    {
+      fill_sine (buffer, 64, 2, 200.0, &phase);
+      st->eq->processor.process (&st->eq->processor, buffer, 64);
+      for (int i = 0; i < 64 * 2; i++)
+	{
+	  if (!isfinite (buffer[i]) || fabsf (buffer[i]) > 10.0f)
+	    {
+	      atomic_fetch_add (&st->invalid, 1);
+	      break;
+	    }
+	}
+      atomic_fetch_add (&st->blocks, 1);
+    }
+  return NULL;
+}
+
+static int
+test_concurrent_updates (void)
+{
+  printf ("  Testing EQ updates during concurrent processing...\n");
+
+  RouterEq eq;
+  eq_open (&eq, 2);
+  RealtimeThreadState rt = {&eq, true, 0, 0};
+  pthread_t thread;
+  pthread_create (&thread, NULL, realtime_thread, &rt);
+
+  RouterEqBand bands[ROUTER_EQ_MAX_BANDS];
+  for (int i = 0; i < 500; i++)
+    {
+      uint32_t count = 1 + (uint32_t) i % ROUTER_EQ_MAX_BANDS;
+      for (uint32_t b = 0; b < count; b++)
+	{
+	  bands[b].type = (RouterEqBandType) ((i + b) % kRouterEqTypeCount);
+	  bands[b].enabled = true;
+	  bands[b].frequency = 50.0f + 400.0f * (float) b;
+	  bands[b].gain_db = (float) ((i * 7 + b) % 13) - 6.0f;
+	  bands[b].q = 0.5f + 0.25f * (float) b;
+	}
+      router_eq_set_config (&eq, i % 5 != 0, -3.0f, bands, count);
+      if (i % 50 == 0)
+	{
+	  uint32_t seen = atomic_load (&rt.blocks);
+	  while (atomic_load (&rt.blocks) == seen)
+	    sched_yield ();
+	}
+    }
+
+  atomic_store (&rt.running, false);
+  pthread_join (thread, NULL);
+  router_eq_destroy (&eq);
+
+  if (atomic_load (&rt.invalid) != 0 || atomic_load (&rt.blocks) == 0)
+    {
+      printf ("    ❌ FAIL: invalid=%u blocks=%u\n", atomic_load (&rt.invalid),
+	      atomic_load (&rt.blocks));
+      return 1;
+    }
+
+  printf ("    ✅ PASS: 500 updates over %u blocks, output stays finite\n",
+	  atomic_load (&rt.blocks));
+  return 0;
+}
+
+int
+run_router_eq_tests (void)
+{
+  printf ("\n----------------------------------------\n");
+  printf ("Router Equalizer Tests\n");
+  printf ("----------------------------------------\n");
+
+  int failed = 0;
+  failed += test_design_response ();
+  failed += test_config_validation ();
+  failed += test_process_gain ();
+  failed += test_click_free_ramp ();
+  failed += test_concurrent_updates ();
+
+  printf ("----------------------------------------\n");
+  if (failed == 0)
+    {
+      printf ("Router Equalizer Tests: PASSED ✅\n");
+    }
+  else
+    {
+      printf ("Router Equalizer Tests: %d FAILED ❌\n", failed);
+    }
+  printf ("----------------------------------------\n");
+
+  return failed;
+}
@@ -0,0 +1,283 @@
+//
+// Router 预读限制器测试（可移植，不依赖音频硬件）
+//
+
+#include "router/router_limiter.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_RATE 48000
+#define TEST_CHANNELS 2
+#define TEST_MAX_FRAMES 512
+#define TEST_TWO_PI 6.283185307179586
+#define TEST_FRAMES 24000 // 0.5 秒
+
+static float g_scratch[TEST_MAX_FRAMES * TEST_CHANNELS];
+
+static void
+limiter_open (RouterLimiter *limiter, float lookahead_ms, float release_ms,
+	      float ceiling_db)
+{
+  router_limiter_init (limiter);
+  RouterLimiterParams params = {lookahead_ms, release_ms, ceiling_db};
+  router_limiter_set_params (limiter, &params);
+  RouterDspFormat format
+    = {TEST_RATE, TEST_MAX_FRAMES, TEST_CHANNELS, g_scratch};
+  limiter->processor.prepare (&limiter->processor, &format);
+}
+
+// 按 block 帧一块处理整个缓冲区
+static void
+limiter_run_blocks (RouterLimiter *limiter, float *buffer, uint32_t frames,
+		    uint32_t block)
+{
+  for (uint32_t done = 0; done < frames; done += block)
+    {
+      uint32_t n = frames - done < block ? frames - done : block;
+      limiter->processor.process (&limiter->processor,
+				  buffer + (size_t) done * TEST_CHANNELS, n);
+    }
+}
+
+// 交错正弦，所有声道相同
+static void
+fill_sine (float *buffer, uint32_t frames, double amplitude, double freq,
+	   double phase)
+{
+  for (uint32_t f = 0; f < frames; f++)
+    {
+      float v = (float) (amplitude * sin (TEST_TWO_PI * freq * f / TEST_RATE
+					  + phase));
+      for (uint32_t c = 0; c < TEST_CHANNELS; c++)
+	buffer[f * TEST_CHANNELS + c] = v;
+    }
+}
+
+static float
+sample_peak (const float *buffer, uint32_t frames)
+{
+  float peak = 0.0f;
+  for (uint32_t i = 0; i < frames * TEST_CHANNELS; i++)
+    {
+      if (fabsf (buffer[i]) > peak)
+	peak = fabsf (buffer[i]);
+    }
+  return peak;
+}
+
+static int
+test_transparent_below_ceiling (void)
+{
+  printf ("  Testing limiter transparency below the ceiling...\n");
+
+  static float input[TEST_FRAMES * TEST_CHANNELS];
+  static float output[TEST_FRAMES * TEST_CHANNELS];
+  fill_sine (input, TEST_FRAMES, 0.5, 997.0, 0.3);
+  memcpy (output, input, sizeof (input));
+
+  RouterLimiter *limiter = malloc (sizeof (RouterLimiter));
+  limiter_open (limiter, 2.0f, 50.0f, -1.0f);
+  limiter_run_blocks (limiter, output, TEST_FRAMES, 256);
+  uint32_t delay = limiter->processor.tail_frames;
+  uint32_t gr = router_limiter_collect (limiter);
+  free (limiter);
+
+  // 输出是逐位相同的延迟输入
+  bool exact = delay == 96 + ROUTER_LIMITER_TP_TAPS / 2;
+  for (uint32_t i = 0; exact && i < delay * TEST_CHANNELS; i++)
+    exact = output[i] == 0.0f;
+  for (uint32_t i = delay * TEST_CHANNELS;
+       exact && i < TEST_FRAMES * TEST_CHANNELS; i++)
+    exact = output[i] == input[i - delay * TEST_CHANNELS];
+  if (!exact || gr != 0)
+    {
+      printf ("    ❌ FAIL: Output not a pure delay (delay=%u gr=%u)\n", delay,
+	      gr);
+      return 1;
+    }
+
+  printf ("    ✅ PASS: Bit-exact %u-frame delay, no gain reduction\n",
+	  delay);
+  return 0;
+}
+
+static int
+test_ceiling_and_lookahead (void)
+{
+  printf ("  Testing limiter ceiling, look-ahead and release...\n");
+
+  // 0.1 秒安静，0.2 秒超过上限 7 dB，再 0.2 秒安静
+  static float buffer[TEST_FRAMES * TEST_CHANNELS];
+  fill_sine (buffer, TEST_FRAMES, 0.2, 440.0, 0.0);
+  fill_sine (buffer + 4800 * TEST_CHANNELS, 9600, 2.0, 440.0, 0.0);
+  RouterLimiter *limiter = malloc (sizeof (RouterLimiter));
+  limiter_open (limiter, 2.0f, 20.0f, -1.0f);
+  limiter_run_blocks (limiter, buffer, TEST_FRAMES, 128);
+  uint32_t delay = limiter->processor.tail_frames;
+  uint32_t gr = router_limiter_collect (limiter);
+  uint32_t gr_after = router_limiter_collect (limiter);
+  free (limiter);
+
+  const float ceiling = powf (10.0f, -1.0f / 20.0f);
+  float peak = sample_peak (buffer, TEST_FRAMES);
+
+  // 突发开始前的预读窗口内增益已经下降：输出中对应输入第 4790 帧
+  // （突发前 10 帧）的采样被衰减
+  double t = 4790.0;
+  float dry = (float) (0.2 * sin (TEST_TWO_PI * 440.0 * t / TEST_RATE));
+  float wet = buffer[(4790 + delay) * TEST_CHANNELS];
+  bool early = fabsf (wet) < fabsf (dry) * 0.9f;
+
+  // 突发结束 0.15 秒（7.5 个释放时间常数）后增益恢复
+  double late_t = 14400.0 + 7200.0;
+  float late_dry
+    = (float) (0.2 * sin (TEST_TWO_PI * 440.0 * late_t / TEST_RATE));
+  float late_wet = buffer[(14400 + 7200 + delay) * TEST_CHANNELS];
+  bool released = fabsf (late_wet - late_dry) < 1e-3f;
+
+  // 理论最大衰减 20·log10(2 / 0.891) ≈ 7.02 dB（真峰值略高于采样峰值）
+  if (peak > ceiling * 1.0001f || !early || !released || gr < 690
+      || gr > 740 || gr_after != 0)
+    {
+      printf ("    ❌ FAIL: peak=%f early=%d released=%d gr=%u/%u\n", peak,
+	      early, released, gr, gr_after);
+      return 1;
+    }
+
+  printf ("    ✅ PASS: Peak %.4f <= %.4f, max GR %.2f dB, "
+	  "attack before the burst\n",
+	  peak, ceiling, gr / 100.0);
+  return 0;
+}
+
+static int
+test_true_peak (void)
+{
+  printf ("  Testing limiter true-peak detection...\n");
+
+  // fs/4 正弦相位 45°：采样峰值只有 0.707，但波形真峰值为 1.0
+  static float buffer[TEST_FRAMES * TEST_CHANNELS];
+  fill_sine (buffer, TEST_FRAMES, 1.0, TEST_RATE / 4.0, TEST_TWO_PI / 8.0);
+  float input_peak = sample_peak (buffer, TEST_FRAMES);
+
+  RouterLimiter *limiter = malloc (sizeof (RouterLimiter));
+  limiter_open (limiter, 1.0f, 50.0f, -1.0f);
+  limiter_run_blocks (limiter, buffer, TEST_FRAMES, 480);
+  free (limiter);
+
+  // 稳态部分的真峰值约等于 采样峰值 × √2，应被压到上限以下
+  const float ceiling = powf (10.0f, -1.0f / 20.0f);
+  float peak = sample_peak (buffer + 2400 * TEST_CHANNELS, TEST_FRAMES - 2400);
+  float true_peak = peak * (float) sqrt (2.0);
+  if (input_peak > ceiling || true_peak > ceiling * 1.02f
+      || true_peak < ceiling * 0.9f)
+    {
+      printf ("    ❌ FAIL: sample peak %f in, estimated true peak %f out\n",
+	      input_peak, true_peak);
+      return 1;
+    }
+
+  printf ("    ✅ PASS: Inter-sample peak limited (true peak %.3f)\n",
+	  true_peak);
+  return 0;
+}
+
+static int
+test_block_size_invariance (void)
+{
+  printf ("  Testing limiter block size invariance...\n");
+
+  // 随机幅度的噪声突发：1 帧一块和 512 帧一块处理的结果逐位相同
+  static float a[TEST_FRAMES * TEST_CHANNELS];
+  static float b[TEST_FRAMES * TEST_CHANNELS];
+  srand (7);
+  for (uint32_t f = 0; f < TEST_FRAMES; f++)
+    {
+      float level = (f / 1000) % 3 == 0 ? 3.0f : 0.3f;
+      for (uint32_t c = 0; c < TEST_CHANNELS; c++)
+	a[f * TEST_CHANNELS + c]
+	  = level * ((float) rand () / RAND_MAX * 2.0f - 1.0f);
+    }
+  memcpy (b, a, sizeof (a));
+
+  RouterLimiter *limiter = malloc (sizeof (RouterLimiter));
+  limiter_open (limiter, 5.0f, 10.0f, -3.0f);
+  limiter_run_blocks (limiter, a, TEST_FRAMES, 1);
+  limiter_open (limiter, 5.0f, 10.0f, -3.0f);
+  limiter_run_blocks (limiter, b, TEST_FRAMES, 512);
+  free (limiter);
+
+  const float ceiling = powf (10.0f, -3.0f / 20.0f);
+  if (memcmp (a, b, sizeof (a)) != 0
+      || sample_peak (a, TEST_FRAMES) > ceiling * 1.0001f)
+    {
+      printf ("    ❌ FAIL: Block size changed the output (peak %f)\n",
+	      sample_peak (a, TEST_FRAMES));
+      return 1;
+    }
+
+  printf ("    ✅ PASS: Identical output for 1- and 512-frame blocks\n");
+  return 0;
+}
+
+static int
+test_params_validation (void)
+{
+  printf ("  Testing limiter parameter validation...\n");
+
+  RouterLimiter *limiter = malloc (sizeof (RouterLimiter));
+  router_limiter_init (limiter);
+  RouterLimiterParams bad[] = {
+    {0.5f, 50.0f, -1.0f}, {6.0f, 50.0f, -1.0f}, {2.0f, 0.0f, -1.0f},
+    {2.0f, 50.0f, 0.5f},  {2.0f, 50.0f, -30.0f}, {NAN, 50.0f, -1.0f},
+  };
+  int accepted = 0;
+  for (size_t i = 0; i < sizeof (bad) / sizeof (bad[0]); i++)
+    accepted += router_limiter_set_params (limiter, &bad[i]) == 0;
+
+  RouterLimiterParams good = {5.0f, 500.0f, -0.1f};
+  RouterLimiterParams read;
+  int result = router_limiter_set_params (limiter, &good);
+  router_limiter_get_params (limiter, &read);
+  free (limiter);
+
+  if (accepted != 0 || result != 0 || read.lookahead_ms != 5.0f
+      || read.release_ms != 500.0f || read.ceiling_db != -0.1f)
+    {
+      printf ("    ❌ FAIL: accepted %d invalid sets\n", accepted);
+      return 1;
+    }
+
+  printf ("    ✅ PASS: Out-of-range and NaN parameters rejected\n");
+  return 0;
+}
+
+int
+run_router_limiter_tests (void)
+{
+  printf ("\n----------------------------------------\n");
+  printf ("Router Limiter Tests\n");
+  printf ("----------------------------------------\n");
+
+  int failed = 0;
+  failed += test_transparent_below_ceiling ();
+  failed += test_ceiling_and_lookahead ();
+  failed += test_true_peak ();
+  failed += test_block_size_invariance ();
+  failed += test_params_validation ();
+
+  printf ("----------------------------------------\n");
+  if (failed == 0)
+    {
+      printf ("Router Limiter Tests: PASSED ✅\n");
+    }
+  else
+    {
+      printf ("Router Limiter Tests: %d FAILED ❌\n", failed);
+    }
+  printf ("----------------------------------------\n");
+
+  return failed;
+}
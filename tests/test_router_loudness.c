@@ -0,0 +1,266 @@
+//
+// Router 响度计测试（可移植，不依赖音频硬件）
+// 参考电平取自 EBU Tech 3341 最小要求测试信号
+//
+
+#include "router/router_loudness.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_RATE 48000
+#define TEST_CHANNELS 2
+#define TEST_BLOCK 512
+#define TEST_TWO_PI 6.283185307179586
+
+// 1kHz 立体声正弦（两声道相同），从 *phase 接续，持续 seconds 秒
+static void
+feed_sine (RouterLoudness *meter, double level_db, double seconds,
+	   uint32_t block, double *phase)
+{
+  static float buffer[TEST_RATE * TEST_CHANNELS];
+  double amplitude = pow (10.0, level_db / 20.0);
+  uint32_t frames = (uint32_t) lround (seconds * TEST_RATE);
+  for (uint32_t done = 0; done < frames; done += block)
+    {
+      uint32_t n = frames - done < block ? frames - done : block;
+      for (uint32_t f = 0; f < n; f++)
+	{
+	  float v = (float) (amplitude * sin (*phase));
+	  *phase += TEST_TWO_PI * 1000.0 / TEST_RATE;
+	  buffer[f * TEST_CHANNELS] = v;
+	  buffer[f * TEST_CHANNELS + 1] = v;
+	}
+      router_loudness_process (meter, buffer, n);
+    }
+}
+
+static RouterLoudness *
+meter_open (void)
+{
+  RouterLoudness *meter = malloc (sizeof (RouterLoudness));
+  router_loudness_init (meter);
+  router_loudness_prepare (meter, TEST_RATE, TEST_CHANNELS);
+  return meter;
+}
+
+static bool
+near (float value, float expected, float tolerance)
+{
+  return fabsf (value - expected) <= tolerance;
+}
+
+static int
+test_calibration (void)
+{
+  printf ("  Testing loudness calibration (1 kHz at -23 dBFS)...\n");
+
+  // Tech 3341 测试 1：立体声 1kHz -23 dBFS，M/S/I 均为 -23.0 ± 0.1 LUFS
+  RouterLoudness *meter = meter_open ();
+  double phase = 0.0;
+  feed_sine (meter, -23.0, 20.0, TEST_BLOCK, &phase);
+  RouterLoudnessReading r;
+  router_loudness_read (meter, &r);
+  free (meter);
+
+  if (!near (r.momentary_lufs, -23.0f, 0.1f)
+      || !near (r.short_term_lufs, -23.0f, 0.1f)
+      || !near (r.integrated_lufs, -23.0f, 0.1f)
+      || !near (r.true_peak_dbtp, -23.0f, 0.2f))
+    {
+      printf ("    ❌ FAIL: M=%.2f S=%.2f I=%.2f TP=%.2f\n", r.momentary_lufs,
+	      r.short_term_lufs, r.integrated_lufs, r.true_peak_dbtp);
+      return 1;
+    }
+
+  printf ("    ✅ PASS: M=%.2f S=%.2f I=%.2f LUFS, TP=%.2f dBTP\n",
+	  r.momentary_lufs, r.short_term_lufs, r.integrated_lufs,
+	  r.true_peak_dbtp);
+  return 0;
+}
+
+static int
+test_relative_gate (void)
+{
+  printf ("  Testing integrated loudness gating...\n");
+
+  // Tech 3341 测试 3：-36 / -23 / -36 dBFS 各 10 / 60 / 10 秒，
+  // -36 段低于相对门限，积分响度为 -23.0 ± 0.1 LUFS
+  RouterLoudness *meter = meter_open ();
+  double phase = 0.0;
+  feed_sine (meter, -36.0, 10.0, TEST_BLOCK, &phase);
+  feed_sine (meter, -23.0, 60.0, TEST_BLOCK, &phase);
+  feed_sine (meter, -36.0, 10.0, TEST_BLOCK, &phase);
+  RouterLoudnessReading r;
+  router_loudness_read (meter, &r);
+
+  // 之后的静音低于绝对门限，不改变积分响度，瞬时/短期响度降到下限
+  router_loudness_add_silence (meter, TEST_RATE * 4);
+  RouterLoudnessReading quiet;
+  router_loudness_read (meter, &quiet);
+  free (meter);
+
+  if (!near (r.integrated_lufs, -23.0f, 0.1f)
+      || !near (r.momentary_lufs, -36.0f, 0.1f)
+      || quiet.integrated_lufs != r.integrated_lufs
+      || quiet.momentary_lufs != ROUTER_LOUDNESS_MIN_LUFS
+      || quiet.short_term_lufs != ROUTER_LOUDNESS_MIN_LUFS)
+    {
+      printf ("    ❌ FAIL: I=%.2f M=%.2f, after silence I=%.2f M=%.2f S=%.2f\n",
+	      r.integrated_lufs, r.momentary_lufs, quiet.integrated_lufs,
+	      quiet.momentary_lufs, quiet.short_term_lufs);
+      return 1;
+    }
+
+  printf ("    ✅ PASS: I=%.2f LUFS, quiet sections and silence gated out\n",
+	  r.integrated_lufs);
+  return 0;
+}
+
+static int
+test_true_peak (void)
+{
+  printf ("  Testing loudness meter true peak...\n");
+
+  // fs/4 正弦相位 45°：采样峰值 -3.01 dBFS，波形真峰值 0 dBTP
+  RouterLoudness *meter = meter_open ();
+  static float buffer[TEST_RATE * TEST_CHANNELS];
+  for (uint32_t f = 0; f < TEST_RATE; f++)
+    {
+      float v = (float) (0.5 * sin (TEST_TWO_PI * f / 4.0 + TEST_TWO_PI / 8.0));
+      buffer[f * TEST_CHANNELS] = v;
+      buffer[f * TEST_CHANNELS + 1] = v;
+    }
+  router_loudness_process (meter, buffer, TEST_RATE);
+  RouterLoudnessReading r;
+  router_loudness_read (meter, &r);
+
+  // 请求重置后下一块开始时清零
+  router_loudness_reset (meter);
+  RouterLoudnessReading before;
+  router_loudness_read (meter, &before);
+  router_loudness_add_silence (meter, 1);
+  RouterLoudnessReading after;
+  router_loudness_read (meter, &after);
+  free (meter);
+
+  const float expected = -6.02f; // 20·log10(0.5)
+  if (!near (r.true_peak_dbtp, expected, 0.2f)
+      || before.true_peak_dbtp != r.true_peak_dbtp
+      || after.true_peak_dbtp != ROUTER_LOUDNESS_MIN_LUFS
+      || after.integrated_lufs != ROUTER_LOUDNESS_MIN_LUFS)
+    {
+      printf ("    ❌ FAIL: TP=%.2f (expected %.2f), after reset %.2f\n",
+	      r.true_peak_dbtp, expected, after.true_peak_dbtp);
+      return 1;
+    }
+
+  printf ("    ✅ PASS: Inter-sample peak %.2f dBTP (sample peak %.2f dBFS)\n",
+	  r.true_peak_dbtp, expected - 3.01f);
+  return 0;
+}
+
+static int
+test_block_size_invariance (void)
+{
+  printf ("  Testing loudness meter block size invariance...\n");
+
+  // 1 帧一块与 4096 帧一块（跨越子块边界）的读数一致
+  RouterLoudness *a = meter_open ();
+  RouterLoudness *b = meter_open ();
+  double phase_a = 0.0;
+  double phase_b = 0.0;
+  feed_sine (a, -18.25, 2.05, 1, &phase_a);
+  feed_sine (b, -18.25, 2.05, 4096, &phase_b);
+  RouterLoudnessReading ra;
+  RouterLoudnessReading rb;
+  router_loudness_read (a, &ra);
+  router_loudness_read (b, &rb);
+  free (a);
+  free (b);
+
+  if (!near (ra.momentary_lufs, rb.momentary_lufs, 1e-4f)
+      || !near (ra.short_term_lufs, rb.short_term_lufs, 1e-4f)
+      || ra.integrated_lufs != rb.integrated_lufs
+      || ra.true_peak_dbtp != rb.true_peak_dbtp)
+    {
+      printf ("    ❌ FAIL: M %.4f/%.4f S %.4f/%.4f I %.4f/%.4f\n",
+	      ra.momentary_lufs, rb.momentary_lufs, ra.short_term_lufs,
+	      rb.short_term_lufs, ra.integrated_lufs, rb.integrated_lufs);
+      return 1;
+    }
+
+  printf ("    ✅ PASS: Same readings for 1- and 4096-frame blocks\n");
+  return 0;
+}
+
+static int
+test_surround_weights (void)
+{
+  printf ("  Testing loudness channel weighting...\n");
+
+  // 5.1：LFE 不计入，环绕声道权重 1.41（+1.5 dB）
+  static float buffer[TEST_RATE * 6];
+  RouterLoudness *meter = malloc (sizeof (RouterLoudness));
+  router_loudness_init (meter);
+  int bad = router_loudness_prepare (meter, TEST_RATE, 0)
+	    + router_loudness_prepare (meter, 0, 2)
+	    + router_loudness_prepare (meter, TEST_RATE, 9);
+
+  float levels[3];
+  const uint32_t channel[3] = {0, 3, 4};
+  for (uint32_t t = 0; t < 3; t++)
+    {
+      router_loudness_prepare (meter, TEST_RATE, 6);
+      memset (buffer, 0, sizeof (buffer));
+      for (uint32_t f = 0; f < TEST_RATE; f++)
+	buffer[f * 6 + channel[t]]
+	  = (float) (0.1 * sin (TEST_TWO_PI * 1000.0 * f / TEST_RATE));
+      router_loudness_process (meter, buffer, TEST_RATE);
+      RouterLoudnessReading r;
+      router_loudness_read (meter, &r);
+      levels[t] = r.short_term_lufs;
+    }
+  free (meter);
+
+  if (bad != -3 || levels[1] != ROUTER_LOUDNESS_MIN_LUFS
+      || !near (levels[2] - levels[0], 1.49f, 0.02f))
+    {
+      printf ("    ❌ FAIL: L=%.2f LFE=%.2f Ls=%.2f (invalid formats %d)\n",
+	      levels[0], levels[1], levels[2], bad);
+      return 1;
+    }
+
+  printf ("    ✅ PASS: LFE ignored, surround +%.2f dB\n",
+	  levels[2] - levels[0]);
+  return 0;
+}
+
+int
+run_router_loudness_tests (void)
+{
+  printf ("\n----------------------------------------\n");
+  printf ("Router Loudness Tests\n");
+  printf ("----------------------------------------\n");
+
+  int failed = 0;
+  failed += test_calibration ();
+  failed += test_relative_gate ();
+  failed += test_true_peak ();
+  failed += test_block_size_invariance ();
+  failed += test_surround_weights ();
+
+  printf ("----------------------------------------\n");
+  if (failed == 0)
+    {
+      printf ("Router Loudness Tests: PASSED ✅\n");
+    }
+  else
+    {
+      printf ("Router Loudness Tests: %d FAILED ❌\n", failed);
+    }
+  printf ("----------------------------------------\n");
+
+  return failed;
+}
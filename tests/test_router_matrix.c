@@ -0,0 +1,320 @@
+//
+// 声道矩阵测试（可移植，不依赖音频硬件）
+//
+
+#include "router/router_matrix.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#define TEST_FRAMES 481 // 奇数帧，覆盖两帧一组之后剩余的一帧
+
+static bool
+near (float value, float expected)
+{
+  return fabsf (value - expected) <= 1e-5f;
+}
+
+// 逐帧逐项计算的参考实现
+static void
+reference_process (const RouterMatrix *matrix, const float *input,
+		   float *output, uint32_t frames)
+{
+  for (uint32_t f = 0; f < frames; f++)
+    {
+      for (uint32_t o = 0; o < matrix->outputs; o++)
+	{
+	  double acc = 0.0;
+	  for (uint32_t i = 0; i < matrix->inputs; i++)
+	    acc += (double) matrix->gains[o][i]
+		   * input[(size_t) f * matrix->inputs + i];
+	  output[(size_t) f * matrix->outputs + o] = (float) acc;
+	}
+    }
+}
+
+static void
+fill_signal (float *buffer, uint32_t samples)
+{
+  for (uint32_t n = 0; n < samples; n++)
+    buffer[n] = sinf ((float) n * 0.37f) * 0.8f;
+}
+
+static int
+test_stereo_mix (void)
+{
+  printf ("  Testing stereo balance/pan/mono/swap...\n");
+
+  static const struct
+  {
+    RouterStereoMix mix;
+    float expected[2][2]; // [输出][输入]
+    RouterMatrixKind kind;
+  } kCases[] = {
+    {{0.0f, 0.0f, false, false}, {{1, 0}, {0, 1}}, kRouterMatrixIdentity},
+    {{0.5f, 0.0f, false, false}, {{0.5f, 0}, {0, 1}}, kRouterMatrixDiagonal},
+    {{-1.0f, 0.0f, false, false}, {{1, 0}, {0, 0}}, kRouterMatrixDiagonal},
+    {{0.0f, 1.0f, false, false}, {{0, 0}, {1, 1}}, kRouterMatrixFull},
+    {{0.0f, -0.25f, false, false}, {{1, 0.25f}, {0, 0.75f}}, kRouterMatrixFull},
+    {{0.0f, 0.0f, true, false}, {{0.5f, 0.5f}, {0.5f, 0.5f}}, kRouterMatrixFull},
+    {{0.0f, 0.0f, false, true}, {{0, 1}, {1, 0}}, kRouterMatrixFull},
+    // 互换后平衡到最左：只剩原右声道，从左声道输出
+    {{-1.0f, 0.0f, false, true}, {{0, 1}, {0, 0}}, kRouterMatrixFull},
+    // 单声道后平衡到偏右：左侧衰减
+    {{0.5f, 0.0f, true, false}, {{0.25f, 0.25f}, {0.5f, 0.5f}},
+     kRouterMatrixFull},
+  };
+
+  for (size_t n = 0; n < sizeof (kCases) / sizeof (kCases[0]); n++)
+    {
+      RouterMatrix matrix;
+      if (router_matrix_from_stereo (&matrix, &kCases[n].mix) != 0
+	  || matrix.kind != kCases[n].kind)
+	{
+	  printf ("    ❌ FAIL: Case %zu rejected or kind %d\n", n, matrix.kind);
+	  return 1;
+	}
+      for (int o = 0; o < 2; o++)
+	{
+	  for (int i = 0; i < 2; i++)
+	    {
+	      if (!near (matrix.gains[o][i], kCases[n].expected[o][i]))
+		{
+		  printf ("    ❌ FAIL: Case %zu gain[%d][%d] = %.3f\n", n, o, i,
+			  matrix.gains[o][i]);
+		  return 1;
+		}
+	    }
+	}
+    }
+
+  RouterMatrix matrix;
+  RouterStereoMix bad = {NAN, 0.0f, false, false};
+  RouterStereoMix wide = {0.0f, 1.5f, false, false};
+  if (router_matrix_from_stereo (&matrix, &bad) == 0
+      || router_matrix_from_stereo (&matrix, &wide) == 0)
+    {
+      printf ("    ❌ FAIL: Out-of-range stereo mix accepted\n");
+      return 1;
+    }
+
+  printf ("    ✅ PASS: %zu stereo mixes produce the expected 2x2 matrices\n",
+	  sizeof (kCases) / sizeof (kCases[0]));
+  return 0;
+}
+
+static int
+test_kernels (void)
+{
+  printf ("  Testing identity/diagonal/full kernels against reference...\n");
+
+  static float input[TEST_FRAMES * 6];
+  static float output[TEST_FRAMES * 6];
+  static float expected[TEST_FRAMES * 6];
+  fill_signal (input, TEST_FRAMES * 6);
+
+  // 单位矩阵：缓冲区逐位不变
+  RouterMatrix matrix;
+  router_matrix_init (&matrix, 2, 2);
+  memcpy (output, input, TEST_FRAMES * 2 * sizeof (float));
+  router_matrix_apply (&matrix, output, TEST_FRAMES);
+  if (matrix.kind != kRouterMatrixIdentity
+      || memcmp (output, input, TEST_FRAMES * 2 * sizeof (float)) != 0)
+    {
+      printf ("    ❌ FAIL: Identity matrix modified the buffer\n");
+      return 1;
+    }
+
+  // 双声道对角、双声道一般、六声道对角、六声道一般
+  static const float kStereoDiagonal[] = {0.7f, 0.0f, 0.0f, -1.3f};
+  static const float kStereoFull[] = {0.6f, -0.4f, 0.25f, 1.1f};
+  float diagonal6[36] = {0};
+  float full6[36];
+  for (int n = 0; n < 6; n++)
+    diagonal6[n * 6 + n] = 0.1f * (float) (n + 1);
+  for (int n = 0; n < 36; n++)
+    full6[n] = 0.05f * (float) ((n * 7) % 11) - 0.2f;
+
+  const struct
+  {
+    uint32_t channels;
+    const float *gains;
+    RouterMatrixKind kind;
+  } kCases[] = {
+    {2, kStereoDiagonal, kRouterMatrixDiagonal},
+    {2, kStereoFull, kRouterMatrixFull},
+    {6, diagonal6, kRouterMatrixDiagonal},
+    {6, full6, kRouterMatrixFull},
+  };
+
+  for (size_t n = 0; n < sizeof (kCases) / sizeof (kCases[0]); n++)
+    {
+      uint32_t channels = kCases[n].channels;
+      router_matrix_set (&matrix, channels, channels, kCases[n].gains);
+      reference_process (&matrix, input, expected, TEST_FRAMES);
+      memcpy (output, input, TEST_FRAMES * channels * sizeof (float));
+      router_matrix_apply (&matrix, output, TEST_FRAMES);
+      if (matrix.kind != kCases[n].kind)
+	{
+	  printf ("    ❌ FAIL: Case %zu classified as %d\n", n, matrix.kind);
+	  return 1;
+	}
+      for (uint32_t s = 0; s < TEST_FRAMES * channels; s++)
+	{
+	  if (!near (output[s], expected[s]))
+	    {
+	      printf ("    ❌ FAIL: Case %zu sample %u: %.6f vs %.6f\n", n, s,
+		      output[s], expected[s]);
+	      return 1;
+	    }
+	}
+    }
+
+  printf ("    ✅ PASS: Fast paths match the reference over %d frames\n",
+	  TEST_FRAMES);
+  return 0;
+}
+
+static int
+test_up_down_mix (void)
+{
+  printf ("  Testing N x M up/down mixing...\n");
+
+  static float input[TEST_FRAMES * 6];
+  static float output[TEST_FRAMES * 6];
+  static float expected[TEST_FRAMES * 6];
+  fill_signal (input, TEST_FRAMES * 6);
+
+  // 5.1 -> 立体声（L R C LFE Ls Rs，中置和环绕按 -3 dB 并入）
+  static const float kDownmix[] = {
+    1.0f, 0.0f, 0.7071f, 0.0f, 0.7071f, 0.0f,
+    0.0f, 1.0f, 0.7071f, 0.0f, 0.0f,	0.7071f,
+  };
+  // 单声道 -> 立体声
+  static const float kUpmix[] = {1.0f, 1.0f};
+
+  RouterMatrix down;
+  RouterMatrix up;
+  RouterMatrix narrow;
+  if (router_matrix_set (&down, 6, 2, kDownmix) != 0
+      || router_matrix_set (&up, 1, 2, kUpmix) != 0
+      || router_matrix_init (&narrow, 2, 1) != 0
+      || down.kind != kRouterMatrixFull || narrow.kind != kRouterMatrixFull)
+    {
+      printf ("    ❌ FAIL: Matrix setup\n");
+      return 1;
+    }
+
+  const RouterMatrix *kCases[] = {&down, &up, &narrow};
+  for (size_t n = 0; n < 3; n++)
+    {
+      const RouterMatrix *matrix = kCases[n];
+      reference_process (matrix, input, expected, TEST_FRAMES);
+      router_matrix_process (matrix, input, output, TEST_FRAMES);
+      for (uint32_t s = 0; s < TEST_FRAMES * matrix->outputs; s++)
+	{
+	  if (!near (output[s], expected[s]))
+	    {
+	      printf ("    ❌ FAIL: Case %zu sample %u: %.6f vs %.6f\n", n, s,
+		      output[s], expected[s]);
+	      return 1;
+	    }
+	}
+    }
+
+  // 2 -> 1 的单位矩阵只保留第一个声道
+  if (output[0] != input[0] || output[1] != input[2])
+    {
+      printf ("    ❌ FAIL: 2 -> 1 identity did not keep channel 0\n");
+      return 1;
+    }
+
+  printf ("    ✅ PASS: 6->2, 1->2 and 2->1 match the reference\n");
+  return 0;
+}
+
+static int
+test_ramp (void)
+{
+  printf ("  Testing matrix ramp...\n");
+
+  // 从直通过渡到左右互换：第 f 帧权重 (f + 1) / 4
+  RouterMatrix from;
+  RouterMatrix to;
+  RouterStereoMix swap = {0.0f, 0.0f, false, true};
+  router_matrix_init (&from, 2, 2);
+  router_matrix_from_stereo (&to, &swap);
+
+  float buffer[8] = {1, 0, 1, 0, 1, 0, 1, 0};
+  router_matrix_apply_ramp (&from, &to, buffer, 4);
+  const float expected[8] = {0.75f, 0.25f, 0.5f, 0.5f, 0.25f, 0.75f, 0, 1};
+  for (int n = 0; n < 8; n++)
+    {
+      if (!near (buffer[n], expected[n]))
+	{
+	  printf ("    ❌ FAIL: Sample %d = %.3f (expected %.3f)\n", n,
+		  buffer[n], expected[n]);
+	  return 1;
+	}
+    }
+
+  printf ("    ✅ PASS: Gains interpolated per frame, last frame exact\n");
+  return 0;
+}
+
+static int
+test_validation (void)
+{
+  printf ("  Testing matrix validation...\n");
+
+  RouterMatrix matrix;
+  router_matrix_init (&matrix, 2, 2);
+  const float too_loud[] = {5.0f, 0.0f, 0.0f, 1.0f};
+  const float not_finite[] = {1.0f, NAN, 0.0f, 1.0f};
+  const float ok[] = {ROUTER_MATRIX_MAX_GAIN, 0.0f, 0.0f, 1.0f};
+
+  int bad = 0;
+  bad += router_matrix_set (&matrix, 2, 2, too_loud);
+  bad += router_matrix_set (&matrix, 2, 2, not_finite);
+  bad += router_matrix_set (&matrix, 0, 2, ok);
+  bad += router_matrix_set (&matrix, 2, ROUTER_MATRIX_MAX_CHANNELS + 1, ok);
+  bad += router_matrix_init (&matrix, ROUTER_MATRIX_MAX_CHANNELS + 1, 2);
+  bool unchanged = matrix.kind == kRouterMatrixIdentity;
+
+  if (bad != -5 || !unchanged || router_matrix_set (&matrix, 2, 2, ok) != 0)
+    {
+      printf ("    ❌ FAIL: bad=%d unchanged=%d\n", bad, unchanged);
+      return 1;
+    }
+
+  printf ("    ✅ PASS: Invalid gains and channel counts rejected\n");
+  return 0;
+}
+
+int
+run_router_matrix_tests (void)
+{
+  printf ("\n----------------------------------------\n");
+  printf ("Router Matrix Tests\n");
+  printf ("----------------------------------------\n");
+
+  int failed = 0;
+  failed += test_stereo_mix ();
+  failed += test_kernels ();
+  failed += test_up_down_mix ();
+  failed += test_ramp ();
+  failed += test_validation ();
+
+  printf ("----------------------------------------\n");
+  if (failed == 0)
+    {
+      printf ("Router Matrix Tests: PASSED ✅\n");
+    }
+  else
+    {
+      printf ("Router Matrix Tests: %d FAILED ❌\n", failed);
+    }
+  printf ("----------------------------------------\n");
+
+  return failed;
+}
@@ -0,0 +1,610 @@
+//
+// Router 信号通路与离线管线测试（可移植，不依赖音频硬件）
+//
+
+#include "router/router_backend.h"
+#include "router/router_frame_ring.h"
+#include "router/router_loopback.h"
+#include "router/router_pipeline.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static void
+put_le16 (uint8_t *p, uint16_t v)
+{
+  p[0] = (uint8_t) v;
+  p[1] = (uint8_t) (v >> 8);
+}
+
+static void
+put_le32 (uint8_t *p, uint32_t v)
+{
+  put_le16 (p, (uint16_t) v);
+  put_le16 (p + 2, (uint16_t) (v >> 16));
+}
+
+// 直接读取整个源并计算校验和（作为离线管线的参照）
+static uint64_t
+source_checksum (RouterSource *source, uint64_t *frames)
+{
+  float block[1000 * ROUTER_MAX_CHANNELS];
+  uint64_t hash = ROUTER_CHECKSUM_INIT;
+  uint32_t got;
+  *frames = 0;
+  while ((got = source->read (source, block, 1000)) > 0)
+    {
+      hash = router_checksum_update (hash, block, got * source->channels);
+      *frames += got;
+    }
+  return hash;
+}
+
+static int
+test_ring_roundtrip (void)
+{
+  printf ("  Testing router ring buffer...\n");
+
+  static float storage[ROUTER_BUFFER_SAMPLES];
+  RouterRingBuffer rb;
+  router_ring_init (&rb, storage);
+
+  float in[512 * 2];
+  float out[512 * 2];
+  for (int i = 0; i < 512 * 2; i++)
+    in[i] = (float) i * 0.001f - 0.5f;
+
+  if (!router_ring_write (&rb, in, 512, 2)
+      || router_ring_buffered_samples (&rb) != 1024
+      || !router_ring_read (&rb, out, 512, 2)
+      || memcmp (in, out, sizeof (in)) != 0)
+    {
+      printf ("    ❌ FAIL: Round trip is not bit-exact\n");
+      return 1;
+    }
+
+  // 数据不足：输出静音并报告欠载
+  out[0] = 1.0f;
+  if (router_ring_read (&rb, out, 1, 2) || out[0] != 0.0f)
+    {
+      printf ("    ❌ FAIL: Underrun not reported or not silent\n");
+      return 1;
+    }
+
+  // 写满后整块丢弃并报告过载
+  uint32_t writes = 0;
+  while (router_ring_write (&rb, in, 512, 2))
+    writes++;
+  if (writes != ROUTER_BUFFER_FRAME_COUNT / 512 - 1)
+    {
+      printf ("    ❌ FAIL: Expected %d writes before overrun, got %u\n",
+	      ROUTER_BUFFER_FRAME_COUNT / 512 - 1, writes);
+      return 1;
+    }
+
+  // 位置计数器回绕后缓存量和数据依然正确
+  router_ring_init (&rb, storage);
+  atomic_store (&rb.write_pos, UINT32_MAX - 100);
+  atomic_store (&rb.read_pos, UINT32_MAX - 100);
+  if (!router_ring_write (&rb, in, 512, 2)
+      || router_ring_buffered_samples (&rb) != 1024
+      || !router_ring_read (&rb, out, 512, 2)
+      || memcmp (in, out, sizeof (in)) != 0)
+    {
+      printf ("    ❌ FAIL: Position counter wrap-around broke the ring\n");
+      return 1;
+    }
+
+  router_ring_detach (&rb);
+  printf ("    ✅ PASS: Ring buffer round trip, xruns and wrap-around\n");
+  return 0;
+}
+
+static int
+test_frame_ring (void)
+{
+  printf ("  Testing router frame ring...\n");
+
+  static float storage[64 * 2];
+  RouterFrameRing ring;
+  if (router_frame_ring_init (&ring, storage, 48, 2) == 0
+      || router_frame_ring_init (&ring, storage, 64, 2) != 0)
+    {
+      printf ("    ❌ FAIL: Non power-of-two capacity accepted\n");
+      return 1;
+    }
+
+  float in[40 * 2];
+  float out[40 * 2];
+  for (int i = 0; i < 40 * 2; i++)
+    in[i] = (float) i;
+
+  // 第二块跨越环尾，读出时拆成两段拷贝
+  bool ok = router_frame_ring_push (&ring, in, 40);
+  router_frame_ring_read (&ring, out, 40);
+  ok = ok && router_frame_ring_push (&ring, in, 40)
+       && router_frame_ring_available (&ring) == 40;
+  router_frame_ring_read (&ring, out, 40);
+  if (!ok || memcmp (in, out, sizeof (in)) != 0)
+    {
+      printf ("    ❌ FAIL: Wrapped block is not bit-exact\n");
+      return 1;
+    }
+
+  // 空间不足：整块丢弃并计数，已有数据不受影响
+  router_frame_ring_push (&ring, in, 40);
+  if (router_frame_ring_push (&ring, in, 30)
+      || atomic_load (&ring.dropped_blocks) != 1
+      || atomic_load (&ring.dropped_frames) != 30
+      || router_frame_ring_available (&ring) != 40)
+    {
+      printf ("    ❌ FAIL: Overrun not counted as a whole block\n");
+      return 1;
+    }
+
+  router_frame_ring_discard (&ring);
+  if (router_frame_ring_available (&ring) != 0)
+    {
+      printf ("    ❌ FAIL: Discard left frames behind\n");
+      return 1;
+    }
+
+  printf ("    ✅ PASS: Frame ring wrap-around, whole-block drops and discard\n");
+  return 0;
+}
+
+static int
+test_render_gain (void)
+{
+  printf ("  Testing router_render_output gain...\n");
+
+  static float storage[ROUTER_BUFFER_SAMPLES];
+  RouterRingBuffer rb;
+  router_ring_init (&rb, storage);
+
+  float in[4] = {0.5f, -0.5f, 1.0f, -1.0f};
+  float out[4];
+  const float gains[] = {0.5f, 1.0f, 0.0f};
+  const float expected_first[] = {0.25f, 0.5f, 0.5f};
+
+  for (size_t g = 0; g < sizeof (gains) / sizeof (gains[0]); g++)
+    {
+      router_ring_write (&rb, in, 2, 2);
+      if (!router_render_output (&rb, out, 2, 2, gains[g], NULL, NULL)
+	  || out[0] != expected_first[g])
+	{
+	  printf ("    ❌ FAIL: gain %.1f produced %f (expected %f)\n",
+		  gains[g], out[0], expected_first[g]);
+	  return 1;
+	}
+    }
+
+  router_ring_detach (&rb);
+  printf ("    ✅ PASS: Gain applied only for 0 < gain < 1\n");
+  return 0;
+}
+
+static int
+test_silence_detect (void)
+{
+  printf ("  Testing router_buffer_is_silent...\n");
+
+  float block[130] = {0};
+  if (!router_buffer_is_silent (block, 0)
+      || !router_buffer_is_silent (block, 130))
+    {
+      printf ("    ❌ FAIL: Zero block not detected as silent\n");
+      return 1;
+    }
+
+  block[5] = -0.0f;
+  block[129] = 1e-30f; // 跨越 64 采样分组的最后一个采样
+  if (router_buffer_is_silent (block, 130)
+      || !router_buffer_is_silent (block, 129))
+    {
+      printf ("    ❌ FAIL: Tail sample or negative zero misclassified\n");
+      return 1;
+    }
+
+  block[129] = 0.0f;
+  block[64] = NAN;
+  if (router_buffer_is_silent (block, 130))
+    {
+      printf ("    ❌ FAIL: NaN treated as silence\n");
+      return 1;
+    }
+
+  printf ("    ✅ PASS: Silence detection covers tails, -0.0 and NaN\n");
+  return 0;
+}
+
+static int
+test_ring_silence (void)
+{
+  printf ("  Testing ring buffer silence fast path...\n");
+
+  static float storage[ROUTER_BUFFER_SAMPLES];
+  RouterRingBuffer rb;
+  router_ring_init (&rb, storage);
+
+  float sound[512 * 2];
+  float out[1024 * 2];
+  for (int i = 0; i < 512 * 2; i++)
+    sound[i] = (float) (i + 1) * 0.001f;
+
+  // 有声块之后的静音块：有声部分逐位读出，静音部分整块跳过
+  bool silent = true;
+  router_ring_write (&rb, sound, 512, 2);
+  router_ring_write_silence (&rb, 512, 2);
+  if (!router_render_output (&rb, out, 512, 2, 1.0f, NULL, &silent)
+      || silent
+      || memcmp (out, sound, sizeof (sound)) != 0)
+    {
+      printf ("    ❌ FAIL: Sound before silence not read back\n");
+      return 1;
+    }
+  out[0] = 1.0f;
+  if (!router_render_output (&rb, out, 512, 2, 0.5f, NULL, &silent)
+      || !silent
+      || out[0] != 0.0f)
+    {
+      printf ("    ❌ FAIL: Silent block not tagged\n");
+      return 1;
+    }
+
+  // 弄脏所有槽位后，跨越 有声 -> 静音 边界的读取必须读到零
+  for (int i = 0; i < 8; i++)
+    {
+      router_ring_write (&rb, sound, 512, 2);
+      router_ring_read (&rb, out, 512, 2);
+    }
+  router_ring_write (&rb, sound, 256, 2);
+  router_ring_write_silence (&rb, 256, 2);
+  if (!router_render_output (&rb, out, 512, 2, 1.0f, NULL, &silent)
+      || silent
+      || memcmp (out, sound, 256 * 2 * sizeof (float)) != 0
+      || !router_buffer_is_silent (out + 256 * 2, 256 * 2))
+    {
+      printf ("    ❌ FAIL: Stale data leaked into silence\n");
+      return 1;
+    }
+
+  // 长时间静音（只推进指针）之后恢复有声，跨越 静音 -> 有声 边界
+  for (int i = 0; i < 20; i++)
+    {
+      router_ring_write_silence (&rb, 512, 2);
+      if (!router_render_output (&rb, out, 512, 2, 1.0f, NULL, &silent)
+	  || !silent)
+	{
+	  printf ("    ❌ FAIL: Long silence left the fast path\n");
+	  return 1;
+	}
+    }
+  router_ring_write_silence (&rb, 256, 2);
+  router_ring_write (&rb, sound, 256, 2);
+  if (!router_render_output (&rb, out, 512, 2, 1.0f, NULL, &silent)
+      || silent
+      || !router_buffer_is_silent (out, 256 * 2)
+      || memcmp (out + 256 * 2, sound, 256 * 2 * sizeof (float)) != 0)
+    {
+      printf ("    ❌ FAIL: Sound after long silence corrupted\n");
+      return 1;
+    }
+
+  router_ring_detach (&rb);
+  printf ("    ✅ PASS: Silent blocks tagged, boundaries bit-exact\n");
+  return 0;
+}
+
+static int
+test_loopback_silence (void)
+{
+  printf ("  Testing loopback buffer silence mark...\n");
+
+  static RouterLoopback loopback = ROUTER_LOOPBACK_INIT;
+  float sound[1024];
+  float out[1024];
+  for (int i = 0; i < 1024; i++)
+    sound[i] = (float) (i + 1) * 0.001f;
+
+  // 静音块留下标记
+  memset (out, 0, sizeof (out));
+  router_loopback_write (&loopback, out, 1024);
+  out[0] = 1.0f;
+  if (!router_loopback_read (&loopback, out, 1024)
+      || !router_buffer_is_silent (out, 1024))
+    {
+      printf ("    ❌ FAIL: Silent block not read back as silence\n");
+      return 1;
+    }
+
+  // 有声数据累计满一整圈，写位置回到标记处：必须读到有声数据
+  for (uint32_t written = 0; written < ROUTER_LOOPBACK_SAMPLES;
+       written += 1024)
+    {
+      sound[0] = (float) written;
+      router_loopback_write (&loopback, sound, 1024);
+      if (!router_loopback_read (&loopback, out, 1024)
+	  || memcmp (out, sound, sizeof (sound)) != 0)
+	{
+	  printf ("    ❌ FAIL: Sound at %u read back as silence\n",
+		  (unsigned) written);
+	  return 1;
+	}
+    }
+
+  // 有声之后的静音依然逐位读出零
+  memset (sound, 0, sizeof (sound));
+  router_loopback_write (&loopback, sound, 1024);
+  if (!router_loopback_read (&loopback, out, 1024)
+      || !router_buffer_is_silent (out, 1024)
+      || router_loopback_read (&loopback, out, 1024))
+    {
+      printf ("    ❌ FAIL: Silence after sound corrupted\n");
+      return 1;
+    }
+
+  router_loopback_reset (&loopback);
+  printf ("    ✅ PASS: Stale silence mark never hides sound\n");
+  return 0;
+}
+
+// 间歇有声的测试源：每 1000 帧交替 合成正弦 / 全零
+typedef struct
+{
+  RouterSource inner;
+  uint64_t position;
+} GatedSourceState;
+
+static uint32_t
+gated_source_read (RouterSource *source, float *dst, uint32_t frames)
+{
+  GatedSourceState *st = source->state;
+  uint32_t got = st->inner.read (&st->inner, dst, frames);
+  for (uint32_t f = 0; f < got; f++)
+    {
+      if ((st->position + f) / 1000 % 2 == 1)
+	{
+	  for (uint32_t c = 0; c < source->channels; c++)
+	    dst[f * source->channels + c] = 0.0f;
+	}
+    }
+  st->position += got;
+  return got;
+}
+
+static void
+gated_source_open (RouterSource *source, GatedSourceState *st,
+		   uint64_t frames)
+{
+  router_source_open_synthetic (&st->inner, 48000, 2, frames);
+  st->position = 0;
+  source->sample_rate = 48000;
+  source->channels = 2;
+  source->read = gated_source_read;
+  source->close = NULL;
+  source->state = st;
+}
+
+static int
+test_offline_silence (void)
+{
+  printf ("  Testing offline pipeline with silent gaps...\n");
+
+  const uint64_t total = 20000;
+  RouterSource source;
+  GatedSourceState state;
+  gated_source_open (&source, &state, total);
+  uint64_t reference_frames = 0;
+  uint64_t reference = source_checksum (&source, &reference_frames);
+  router_source_close (&state.inner);
+
+  RouterSink sink;
+  gated_source_open (&source, &state, total);
+  router_sink_open_null (&sink, 48000, 2);
+  RouterOfflineConfig config = {.block_frames = 250, .gain = 1.0f};
+  RouterOfflineStats stats;
+  int result = router_offline_run (&source, &sink, &config, &stats);
+  uint64_t checksum = router_sink_null_checksum (&sink);
+  router_sink_close (&sink);
+  router_source_close (&state.inner);
+
+  // 块大小整除 1000，静音块恰好是一半
+  if (result != 0 || stats.frames_out != total || stats.underruns != 0
+      || stats.silent_frames != total / 2 || checksum != reference)
+    {
+      printf ("    ❌ FAIL: silent=%llu checksum %016llx != %016llx\n",
+	      (unsigned long long) stats.silent_frames,
+	      (unsigned long long) checksum, (unsigned long long) reference);
+      return 1;
+    }
+
+  printf ("    ✅ PASS: Silent blocks skipped, output still bit-exact\n");
+  return 0;
+}
+
+static int
+test_offline_bit_exact (void)
+{
+  printf ("  Testing offline pipeline bit-exactness...\n");
+
+  const uint64_t total = 48000 + 123; // 不是块大小的整数倍
+  RouterSource source;
+  router_source_open_synthetic (&source, 48000, 2, total);
+  uint64_t reference_frames = 0;
+  uint64_t reference = source_checksum (&source, &reference_frames);
+  router_source_close (&source);
+
+  const uint32_t blocks[] = {64, 333, ROUTER_OFFLINE_MAX_BLOCK_FRAMES};
+  for (size_t b = 0; b < sizeof (blocks) / sizeof (blocks[0]); b++)
+    {
+      RouterSink sink;
+      router_source_open_synthetic (&source, 48000, 2, total);
+      router_sink_open_null (&sink, 48000, 2);
+
+      RouterOfflineConfig config = {.block_frames = blocks[b], .gain = 1.0f};
+      RouterOfflineStats stats;
+      int result = router_offline_run (&source, &sink, &config, &stats);
+      uint64_t checksum = router_sink_null_checksum (&sink);
+      router_sink_close (&sink);
+      router_source_close (&source);
+
+      if (result != 0 || stats.frames_in != total || stats.frames_out != total
+	  || stats.overruns != 0 || stats.underruns != 0
+	  || checksum != reference)
+	{
+	  printf ("    ❌ FAIL: block %u: result=%d in=%llu out=%llu "
+		  "xruns=%u/%u checksum %016llx != %016llx\n",
+		  blocks[b], result, (unsigned long long) stats.frames_in,
+		  (unsigned long long) stats.frames_out, stats.overruns,
+		  stats.underruns, (unsigned long long) checksum,
+		  (unsigned long long) reference);
+	  return 1;
+	}
+    }
+
+  // 块大小超过环形缓冲区一半时拒绝运行
+  RouterSink sink;
+  router_source_open_synthetic (&source, 48000, 2, 16);
+  router_sink_open_null (&sink, 48000, 2);
+  RouterOfflineConfig too_big
+    = {.block_frames = ROUTER_OFFLINE_MAX_BLOCK_FRAMES + 1, .gain = 1.0f};
+  int result = router_offline_run (&source, &sink, &too_big, NULL);
+  router_sink_close (&sink);
+  router_source_close (&source);
+  if (result != -1)
+    {
+      printf ("    ❌ FAIL: Oversized block accepted\n");
+      return 1;
+    }
+
+  printf ("    ✅ PASS: Output matches source bit for bit at any block size\n");
+  return 0;
+}
+
+static int
+test_wav_roundtrip (void)
+{
+  printf ("  Testing WAV source/sink round trip...\n");
+
+  char float_path[64];
+  char pcm_path[64];
+  snprintf (float_path, sizeof (float_path), "/tmp/audioctl_test_%d.wav",
+	    (int) getpid ());
+  snprintf (pcm_path, sizeof (pcm_path), "/tmp/audioctl_test_%d_pcm.wav",
+	    (int) getpid ());
+
+  // 合成源 -> WAV 汇
+  RouterSource source;
+  RouterSink sink;
+  router_source_open_synthetic (&source, 44100, 2, 10000);
+  uint64_t frames = 0;
+  uint64_t reference = source_checksum (&source, &frames);
+  router_source_close (&source);
+
+  router_source_open_synthetic (&source, 44100, 2, 10000);
+  if (router_sink_open_wav (&sink, float_path, 44100, 2) != 0
+      || router_offline_run (&source, &sink, NULL, NULL) != 0
+      || router_sink_close (&sink) != 0)
+    {
+      router_source_close (&source);
+      printf ("    ❌ FAIL: Could not write %s\n", float_path);
+      return 1;
+    }
+  router_source_close (&source);
+
+  // WAV 源读回后校验和一致
+  uint64_t read_frames = 0;
+  uint64_t checksum = 0;
+  if (router_source_open_wav (&source, float_path) == 0)
+    {
+      checksum = source_checksum (&source, &read_frames);
+      router_source_close (&source);
+    }
+  unlink (float_path);
+  if (source.sample_rate != 44100 || read_frames != frames
+      || checksum != reference)
+    {
+      printf ("    ❌ FAIL: Float WAV did not round-trip (%llu frames)\n",
+	      (unsigned long long) read_frames);
+      return 1;
+    }
+
+  // 16 位 PCM 单声道：手工构造文件头
+  const int16_t pcm[4] = {0, 16384, -32768, 32767};
+  uint8_t header[44] = {0};
+  memcpy (header, "RIFF", 4);
+  put_le32 (header + 4, 36 + sizeof (pcm));
+  memcpy (header + 8, "WAVEfmt ", 8);
+  put_le32 (header + 16, 16);	 // fmt 块大小
+  put_le16 (header + 20, 1);	 // PCM
+  put_le16 (header + 22, 1);	 // 单声道
+  put_le32 (header + 24, 48000); // 采样率
+  put_le32 (header + 28, 96000); // 字节率
+  put_le16 (header + 32, 2);	 // 块对齐
+  put_le16 (header + 34, 16);	 // 位深
+  memcpy (header + 36, "data", 4);
+  put_le32 (header + 40, sizeof (pcm));
+  FILE *fp = fopen (pcm_path, "wb");
+  if (fp == NULL)
+    {
+      printf ("    ❌ FAIL: Could not create %s\n", pcm_path);
+      return 1;
+    }
+  fwrite (header, 1, sizeof (header), fp);
+  fwrite (pcm, 1, sizeof (pcm), fp); // 测试平台均为小端
+  fclose (fp);
+
+  float decoded[8] = {0};
+  uint32_t got = 0;
+  if (router_source_open_wav (&source, pcm_path) == 0)
+    {
+      got = source.read (&source, decoded, 8);
+      router_source_close (&source);
+    }
+  unlink (pcm_path);
+  if (got != 4 || decoded[0] != 0.0f || decoded[1] != 0.5f
+      || decoded[2] != -1.0f || decoded[3] != 32767.0f / 32768.0f)
+    {
+      printf ("    ❌ FAIL: PCM16 decode wrong (got %u frames)\n", got);
+      return 1;
+    }
+
+  printf ("    ✅ PASS: Float WAV round trip and PCM16 decode\n");
+  return 0;
+}
+
+int
+run_router_pipeline_tests (void)
+{
+  printf ("\n----------------------------------------\n");
+  printf ("Router Pipeline Tests\n");
+  printf ("----------------------------------------\n");
+
+  int failed = 0;
+  failed += test_ring_roundtrip ();
+  failed += test_frame_ring ();
+  failed += test_render_gain ();
+  failed += test_silence_detect ();
+  failed += test_ring_silence ();
+  failed += test_loopback_silence ();
+  failed += test_offline_silence ();
+  failed += test_offline_bit_exact ();
+  failed += test_wav_roundtrip ();
+
+  printf ("----------------------------------------\n");
+  if (failed == 0)
+    {
+      printf ("Router Pipeline Tests: PASSED ✅\n");
+    }
+  else
+    {
+      printf ("Router Pipeline Tests: %d FAILED ❌\n", failed);
+    }
+  printf ("----------------------------------------\n");
+
+  return failed;
+}
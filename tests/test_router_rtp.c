@@ -0,0 +1,416 @@
+//
+// 网络推流测试（本机回环，不依赖音频硬件）
+//
+
+#include "router/router_rtp.h"
+#include <arpa/inet.h>
+#include <math.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#define TEST_RATE 48000
+#define TEST_TICK 240 // 5 ms
+
+static float
+test_value (uint32_t frame, uint32_t channel)
+{
+  float x = (float) (frame % 4096) / 4096.0f - 0.5f;
+  return channel == 0 ? x : -x;
+}
+
+// L24 量化后的值（与发送端的编码一致）
+static float
+quantize (float x)
+{
+  return (float) (int32_t) lrintf (x * 8388607.0f) / 8388607.0f;
+}
+
+static int
+bind_loopback (uint16_t *port)
+{
+  int fd = socket (AF_INET, SOCK_DGRAM, 0);
+  struct sockaddr_in addr;
+  memset (&addr, 0, sizeof (addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+  socklen_t len = sizeof (addr);
+  if (fd < 0 || bind (fd, (struct sockaddr *) &addr, sizeof (addr)) != 0
+      || getsockname (fd, (struct sockaddr *) &addr, &len) != 0)
+    {
+      if (fd >= 0)
+	close (fd);
+      return -1;
+    }
+  struct timeval timeout = {1, 0};
+  setsockopt (fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof (timeout));
+  *port = ntohs (addr.sin_port);
+  return fd;
+}
+
+static void
+push_frames (RouterRtpSender *sender, uint32_t first, uint32_t frames)
+{
+  float block[2 * 1024];
+  while (frames > 0)
+    {
+      uint32_t n = frames < 1024 ? frames : 1024;
+      for (uint32_t f = 0; f < n; f++)
+	for (uint32_t c = 0; c < 2; c++)
+	  block[2 * f + c] = test_value (first + f, c);
+      router_rtp_sender_push (sender, block, n);
+      first += n;
+      frames -= n;
+    }
+}
+
+// 等待 expected 个包都进入接收端队列
+static bool
+receive_all (RouterRtpReceiver *receiver, uint64_t *queued, uint64_t expected)
+{
+  for (int tries = 0; *queued < expected && tries < 100; tries++)
+    {
+      int n = router_rtp_receiver_poll (receiver, 10);
+      if (n < 0)
+	return false;
+      *queued += (uint64_t) n;
+    }
+  return *queued == expected;
+}
+
+static int
+test_packet_header (void)
+{
+  printf ("  Testing RTP header fields on the wire...\n");
+
+  uint16_t port;
+  int fd = bind_loopback (&port);
+  static RouterRtpSender sender;
+  if (fd < 0 || router_rtp_sender_init (&sender, 2) != 0)
+    {
+      printf ("    ❌ FAIL: Could not set up loopback\n");
+      if (fd >= 0)
+	close (fd);
+      return 1;
+    }
+  bool rejects
+    = router_rtp_sender_open (&sender, "127.0.0.1", port, 22050, 1) != 0
+      && router_rtp_sender_open (&sender, "127.0.0.1", port, TEST_RATE, 11)
+	   != 0
+      && router_rtp_sender_open (&sender, "127.0.0.1", port, TEST_RATE, 0)
+	   != 0;
+
+  // 1 ms @ 48 kHz = 48 帧；4.5 个包的采样只发出 4 个
+  int open = router_rtp_sender_open (&sender, "127.0.0.1", port, TEST_RATE, 1);
+  push_frames (&sender, 0, 48 * 4 + 24);
+  uint32_t sent = router_rtp_sender_pump (&sender);
+
+  bool ok = rejects && open == 0 && sent == 4;
+  uint8_t packet[2048];
+  uint32_t ssrc = 0;
+  uint16_t sequence = 0;
+  uint32_t timestamp = 0;
+  for (uint32_t i = 0; ok && i < 4; i++)
+    {
+      ssize_t len = recv (fd, packet, sizeof (packet), 0);
+      uint32_t p_ts = (uint32_t) packet[4] << 24 | (uint32_t) packet[5] << 16
+		      | (uint32_t) packet[6] << 8 | packet[7];
+      uint32_t p_ssrc = (uint32_t) packet[8] << 24 | (uint32_t) packet[9] << 16
+			| (uint32_t) packet[10] << 8 | packet[11];
+      uint16_t p_seq = (uint16_t) (packet[2] << 8 | packet[3]);
+      // 每包第一帧左声道的 L24 值
+      int32_t sample = (int32_t) ((uint32_t) packet[12] << 24
+				  | (uint32_t) packet[13] << 16
+				  | (uint32_t) packet[14] << 8)
+		       >> 8;
+      ok = len == 12 + 48 * 6 && packet[0] == 0x80
+	   && packet[1] == (i == 0 ? 0x80 : 0) + 96
+	   && (i == 0
+	       || (p_ssrc == ssrc && p_seq == (uint16_t) (sequence + 1)
+		   && p_ts == timestamp + 48))
+	   && sample == lrintf (test_value (i * 48, 0) * 8388607.0f);
+      ssrc = p_ssrc;
+      sequence = p_seq;
+      timestamp = p_ts;
+    }
+  RouterRtpSenderStats stats;
+  router_rtp_sender_get_stats (&sender, &stats);
+  router_rtp_sender_destroy (&sender);
+  close (fd);
+
+  if (!ok || stats.packets != 4 || stats.bytes != 4 * (12 + 48 * 6)
+      || stats.send_errors != 0)
+    {
+      printf ("    ❌ FAIL: rejects %d, open %d, sent %u, packets %llu\n",
+	      rejects, open, sent, (unsigned long long) stats.packets);
+      return 1;
+    }
+
+  printf ("    ✅ PASS: V=2, PT 96, marker on first packet, seq/ts advance "
+	  "by one packet\n");
+  return 0;
+}
+
+static int
+test_loopback_exact (void)
+{
+  printf ("  Testing sender to receiver over loopback...\n");
+
+  static RouterRtpSender sender;
+  static RouterRtpReceiver receiver;
+  if (router_rtp_receiver_init (&receiver, 0, TEST_RATE, 2, 10) != 0
+      || router_rtp_sender_init (&sender, 2) != 0
+      || router_rtp_sender_open (&sender, "127.0.0.1", receiver.port,
+				 TEST_RATE, 1)
+	   != 0)
+    {
+      printf ("    ❌ FAIL: Could not set up loopback\n");
+      router_rtp_receiver_destroy (&receiver);
+      router_rtp_sender_destroy (&sender);
+      return 1;
+    }
+
+  // 时钟一致时不做重采样：延迟 10 ms 之后输出与量化后的输入逐帧相同
+  uint64_t sent = 0;
+  uint64_t queued = 0;
+  uint32_t mismatches = 0;
+  bool delivered = true;
+  float out[2 * TEST_TICK];
+  const uint32_t ticks = 200;
+  for (uint32_t tick = 0; tick < ticks && delivered; tick++)
+    {
+      push_frames (&sender, tick * TEST_TICK, TEST_TICK);
+      sent += router_rtp_sender_pump (&sender);
+      delivered = receive_all (&receiver, &queued, sent);
+      router_rtp_receiver_read (&receiver, out, TEST_TICK);
+      for (uint32_t f = 0; f < TEST_TICK; f++)
+	for (uint32_t c = 0; c < 2; c++)
+	  {
+	    float expected
+	      = tick < 1 ? 0.0f
+			 : quantize (test_value ((tick - 1) * TEST_TICK + f, c));
+	    if (out[2 * f + c] != expected)
+	      mismatches++;
+	  }
+    }
+  RouterRtpReceiverStats stats;
+  router_rtp_receiver_get_stats (&receiver, &stats);
+  router_rtp_sender_destroy (&sender);
+  router_rtp_receiver_destroy (&receiver);
+
+  if (!delivered || mismatches != 0 || stats.packets != sent
+      || stats.lost != 0 || stats.late != 0 || stats.underruns != 0
+      || stats.resets != 0 || !stats.playing || stats.sample_rate != TEST_RATE
+      || stats.fill_ms != 10.0f || stats.drift_ppm != 0.0f)
+    {
+      printf ("    ❌ FAIL: delivered %d, mismatches %u, packets %llu/%llu, "
+	      "lost %u, late %u, underruns %u, fill %.2f ms\n",
+	      delivered, mismatches, (unsigned long long) stats.packets,
+	      (unsigned long long) sent, stats.lost, stats.late,
+	      stats.underruns, stats.fill_ms);
+      return 1;
+    }
+
+  printf ("    ✅ PASS: %llu packets, output bit-exact after 10 ms\n",
+	  (unsigned long long) sent);
+  return 0;
+}
+
+// 手工构造一个 48 帧的包（第 n 个包，测试值从 n * 48 开始）
+static size_t
+build_packet (uint8_t *packet, uint32_t ssrc, uint16_t n)
+{
+  uint32_t timestamp = 1000u + n * 48u;
+  packet[0] = 0x80;
+  packet[1] = 96;
+  packet[2] = (uint8_t) (n >> 8);
+  packet[3] = (uint8_t) n;
+  for (int i = 0; i < 4; i++)
+    {
+      packet[4 + i] = (uint8_t) (timestamp >> (24 - 8 * i));
+      packet[8 + i] = (uint8_t) (ssrc >> (24 - 8 * i));
+    }
+  for (uint32_t f = 0; f < 48; f++)
+    for (uint32_t c = 0; c < 2; c++)
+      {
+	int32_t v = (int32_t) lrintf (test_value (n * 48u + f, c) * 8388607.0f);
+	uint8_t *p = packet + 12 + f * 6 + c * 3;
+	p[0] = (uint8_t) (v >> 16);
+	p[1] = (uint8_t) (v >> 8);
+	p[2] = (uint8_t) v;
+      }
+  return 12 + 48 * 6;
+}
+
+static int
+test_loss_and_reorder (void)
+{
+  printf ("  Testing loss, late packets and sender change...\n");
+
+  static RouterRtpReceiver receiver;
+  uint16_t unused;
+  int fd = bind_loopback (&unused);
+  if (fd < 0 || router_rtp_receiver_init (&receiver, 0, TEST_RATE, 2, 2) != 0)
+    {
+      printf ("    ❌ FAIL: Could not set up loopback\n");
+      if (fd >= 0)
+	close (fd);
+      return 1;
+    }
+  struct sockaddr_in to;
+  memset (&to, 0, sizeof (to));
+  to.sin_family = AF_INET;
+  to.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+  to.sin_port = htons (receiver.port);
+
+  uint8_t packet[512];
+  uint64_t queued = 0;
+  uint64_t expected = 0;
+#define SEND(len)                                                              \
+  (sendto (fd, packet, (len), 0, (struct sockaddr *) &to, sizeof (to)),        \
+   expected++)
+
+  // 包 0、1、3 到达，包 2 丢失；目标延迟 2 ms = 96 帧
+  SEND (build_packet (packet, 0x1234, 0));
+  SEND (build_packet (packet, 0x1234, 1));
+  SEND (build_packet (packet, 0x1234, 3));
+  packet[0] = 0x40; // 版本 1
+  SEND (12 + 48 * 6);
+  bool ok = receive_all (&receiver, &queued, expected);
+
+  // 播放位置 96：丢失的包 2 补为静音
+  float out[2 * 48];
+  router_rtp_receiver_read (&receiver, out, 48);
+  uint32_t bad_silence = 0;
+  for (uint32_t i = 0; i < 2 * 48; i++)
+    bad_silence += out[i] != 0.0f;
+  RouterRtpReceiverStats first;
+  router_rtp_receiver_get_stats (&receiver, &first);
+
+  // 包 2 到达时已经播放过
+  SEND (build_packet (packet, 0x1234, 2));
+  SEND (build_packet (packet, 0x1234, 4));
+  ok = ok && receive_all (&receiver, &queued, expected);
+  router_rtp_receiver_read (&receiver, out, 48);
+  uint32_t bad_audio = 0;
+  for (uint32_t f = 0; f < 48; f++)
+    for (uint32_t c = 0; c < 2; c++)
+      bad_audio += out[2 * f + c] != quantize (test_value (144 + f, c));
+  RouterRtpReceiverStats second;
+  router_rtp_receiver_get_stats (&receiver, &second);
+
+  // 换了发送端：重新锁定并重新缓冲
+  SEND (build_packet (packet, 0x5678, 7));
+  ok = ok && receive_all (&receiver, &queued, expected);
+  router_rtp_receiver_read (&receiver, out, 48);
+  RouterRtpReceiverStats third;
+  router_rtp_receiver_get_stats (&receiver, &third);
+#undef SEND
+  router_rtp_receiver_destroy (&receiver);
+  close (fd);
+
+  if (!ok || bad_silence != 0 || bad_audio != 0 || first.lost != 1
+      || first.invalid != 1 || !first.playing || first.packets != 3 || second.packets != 4
+      || second.late != 1 || second.lost != 0 || second.underruns != 0
+      || third.resets != 1 || third.playing)
+    {
+      printf ("    ❌ FAIL: received %d, silence %u, audio %u, lost %u/%u, "
+	      "late %u, invalid %u, resets %u\n",
+	      ok, bad_silence, bad_audio, first.lost, second.lost, second.late,
+	      first.invalid, third.resets);
+      return 1;
+    }
+
+  printf ("    ✅ PASS: gap filled with silence, late and invalid packets "
+	  "counted, resync on new SSRC\n");
+  return 0;
+}
+
+static int
+test_drift_correction (void)
+{
+  printf ("  Testing clock drift correction...\n");
+
+  static RouterRtpSender sender;
+  static RouterRtpReceiver receiver;
+  if (router_rtp_receiver_init (&receiver, 0, TEST_RATE, 2, 20) != 0
+      || router_rtp_sender_init (&sender, 2) != 0
+      || router_rtp_sender_open (&sender, "127.0.0.1", receiver.port,
+				 TEST_RATE, 2)
+	   != 0)
+    {
+      printf ("    ❌ FAIL: Could not set up loopback\n");
+      router_rtp_receiver_destroy (&receiver);
+      router_rtp_sender_destroy (&sender);
+      return 1;
+    }
+
+  // 发送端时钟比接收端快 500 ppm：模拟 90 秒
+  const double drift = 500e-6;
+  const uint32_t ticks = 90 * TEST_RATE / TEST_TICK;
+  double produced = 0.0;
+  uint32_t frame = 0;
+  uint64_t sent = 0;
+  uint64_t queued = 0;
+  bool delivered = true;
+  float out[2 * TEST_TICK];
+  for (uint32_t tick = 0; tick < ticks && delivered; tick++)
+    {
+      produced += TEST_TICK * (1.0 + drift);
+      uint32_t frames = (uint32_t) produced - frame;
+      push_frames (&sender, frame, frames);
+      frame += frames;
+      sent += router_rtp_sender_pump (&sender);
+      delivered = receive_all (&receiver, &queued, sent);
+      router_rtp_receiver_read (&receiver, out, TEST_TICK);
+    }
+  RouterRtpReceiverStats stats;
+  router_rtp_receiver_get_stats (&receiver, &stats);
+  router_rtp_sender_destroy (&sender);
+  router_rtp_receiver_destroy (&receiver);
+
+  if (!delivered || stats.underruns != 0 || stats.resets != 0
+      || !(fabsf (stats.drift_ppm - 500.0f) < 50.0f)
+      || !(fabsf (stats.fill_ms - 20.0f) < 3.0f))
+    {
+      printf ("    ❌ FAIL: delivered %d, drift %.1f ppm, fill %.2f ms, "
+	      "underruns %u, resets %u\n",
+	      delivered, stats.drift_ppm, stats.fill_ms, stats.underruns,
+	      stats.resets);
+      return 1;
+    }
+
+  printf ("    ✅ PASS: converged to %.1f ppm, buffer held at %.1f ms\n",
+	  stats.drift_ppm, stats.fill_ms);
+  return 0;
+}
+
+int
+run_router_rtp_tests (void)
+{
+  printf ("\n----------------------------------------\n");
+  printf ("Router RTP Tests\n");
+  printf ("----------------------------------------\n");
+
+  int failed = 0;
+  failed += test_packet_header ();
+  failed += test_loopback_exact ();
+  failed += test_loss_and_reorder ();
+  failed += test_drift_correction ();
+
+  printf ("----------------------------------------\n");
+  if (failed == 0)
+    {
+      printf ("Router RTP Tests: PASSED ✅\n");
+    }
+  else
+    {
+      printf ("Router RTP Tests: %d FAILED ❌\n", failed);
+    }
+  printf ("----------------------------------------\n");
+
+  return failed;
+}
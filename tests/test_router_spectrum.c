@@ -0,0 +1,296 @@
+//
+// 频谱分析抽头与分析器测试（可移植，不依赖音频硬件）
+//
+
+#include "router/router_spectrum.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#define TEST_RATE 48000
+#define TEST_PI 3.141592653589793
+
+// 频率所在的频带
+static uint32_t
+band_of (const RouterSpectrumAnalyzer *analyzer, double freq)
+{
+  uint32_t bin = (uint32_t) lround (freq * analyzer->size
+				    / analyzer->sample_rate);
+  for (uint32_t b = 0; b < analyzer->band_count; b++)
+    if (bin >= analyzer->band_lo[b] && bin < analyzer->band_hi[b])
+      return b;
+  return analyzer->band_count;
+}
+
+static int
+test_tap (void)
+{
+  printf ("  Testing analysis tap decimation and overflow...\n");
+
+  static RouterSpectrumTap tap;
+  router_spectrum_tap_init (&tap);
+  float block[2 * 301];
+  for (uint32_t f = 0; f < 301; f++)
+    {
+      block[2 * f] = 1.0f;
+      block[2 * f + 1] = 3.0f;
+    }
+  float out[ROUTER_SPECTRUM_RING_SIZE];
+
+  // 关闭时不写入
+  router_spectrum_tap_push (&tap, block, 301, 2);
+  if (router_spectrum_tap_read (&tap, out, 16) != 0)
+    {
+      printf ("    ❌ FAIL: Disabled tap produced samples\n");
+      return 1;
+    }
+
+  // 2 倍抽取：奇数帧的块之间延续相位，单声道为左右平均；抗混叠低通的
+  // 直流增益为 1，建立过程之后读数稳定在平均值
+  if (router_spectrum_tap_set_decimation (&tap, 2) != 0
+      || router_spectrum_tap_set_decimation (
+	   &tap, ROUTER_SPECTRUM_MAX_DECIMATION + 1)
+	   == 0)
+    {
+      printf ("    ❌ FAIL: Decimation range not enforced\n");
+      return 1;
+    }
+  router_spectrum_tap_push (&tap, block, 301, 2);
+  router_spectrum_tap_push (&tap, block, 301, 2);
+  uint32_t count = router_spectrum_tap_read (&tap, out, 1000);
+  bool values_ok = true;
+  for (uint32_t i = 100; i < count; i++)
+    values_ok = values_ok && fabsf (out[i] - 2.0f) < 1e-4f;
+  if (count != 301 || !values_ok)
+    {
+      printf ("    ❌ FAIL: Read %u samples, expected 301 settling at 2.0\n",
+	      count);
+      return 1;
+    }
+
+  // 环满时丢弃整块并计数，已写入的采样不受影响
+  router_spectrum_tap_set_decimation (&tap, 1);
+  uint32_t pushed = 0;
+  while (pushed + 301 <= ROUTER_SPECTRUM_RING_SIZE)
+    {
+      router_spectrum_tap_push (&tap, block, 301, 2);
+      pushed += 301;
+    }
+  router_spectrum_tap_push (&tap, block, 301, 2);
+  uint32_t dropped = router_spectrum_tap_collect_dropped (&tap);
+  count = router_spectrum_tap_read (&tap, out, ROUTER_SPECTRUM_RING_SIZE);
+  if (dropped != 1 || count != pushed
+      || router_spectrum_tap_collect_dropped (&tap) != 0)
+    {
+      printf ("    ❌ FAIL: Overflow dropped %u blocks, read %u of %u\n",
+	      dropped, count, pushed);
+      return 1;
+    }
+
+  printf ("    ✅ PASS: Mono decimation carries across blocks, overflow "
+	  "drops whole blocks\n");
+  return 0;
+}
+
+static int
+test_analyzer (void)
+{
+  printf ("  Testing windowed FFT and log-frequency bands...\n");
+
+  RouterSpectrumAnalyzer analyzer;
+  if (router_spectrum_analyzer_init (&analyzer, 2048, 64, TEST_RATE) != 0)
+    {
+      printf ("    ❌ FAIL: Could not create analyzer\n");
+      return 1;
+    }
+
+  // 频带单调覆盖到奈奎斯特频率
+  bool bands_ok = analyzer.band_hi[63] == 1025;
+  for (uint32_t b = 1; b < 64; b++)
+    bands_ok = bands_ok && analyzer.band_lo[b] >= analyzer.band_lo[b - 1]
+	       && analyzer.band_lo[b] < analyzer.band_hi[b];
+
+  // 静音：全部为下限
+  float bands[64];
+  router_spectrum_analyzer_compute (&analyzer, bands);
+  bool silent_ok = true;
+  for (uint32_t b = 0; b < 64; b++)
+    silent_ok = silent_ok && bands[b] <= ROUTER_SPECTRUM_FLOOR_DB + 0.01f;
+
+  // 落在频点上的满幅与 -20 dB 正弦（分多次追加，超过窗长的旧数据被丢弃）
+  const double freq = 44.0 * TEST_RATE / 2048;
+  float levels[2];
+  float far_level = 0.0f;
+  static const float kAmplitudes[2] = {1.0f, 0.1f};
+  for (uint32_t a = 0; a < 2; a++)
+    {
+      float samples[1500];
+      for (uint32_t chunk = 0; chunk < 3; chunk++)
+	{
+	  for (uint32_t n = 0; n < 1500; n++)
+	    samples[n] = kAmplitudes[a]
+			 * (float) sin (2.0 * TEST_PI * freq * (chunk * 1500 + n)
+					/ TEST_RATE);
+	  router_spectrum_analyzer_push (&analyzer, samples, 1500);
+	}
+      router_spectrum_analyzer_compute (&analyzer, bands);
+      levels[a] = bands[band_of (&analyzer, freq)];
+      if (a == 0)
+	far_level = bands[band_of (&analyzer, 10000.0)];
+    }
+  router_spectrum_analyzer_destroy (&analyzer);
+
+  if (!bands_ok || !silent_ok || fabsf (levels[0]) > 0.05f
+      || fabsf (levels[1] + 20.0f) > 0.05f || far_level > -80.0f)
+    {
+      printf ("    ❌ FAIL: Bands %d, silence %d, levels %.2f/%.2f dB, "
+	      "10 kHz %.1f dB\n",
+	      bands_ok, silent_ok, levels[0], levels[1], far_level);
+      return 1;
+    }
+
+  printf ("    ✅ PASS: Full-scale sine reads %.2f dBFS, -20 dB reads %.2f, "
+	  "leakage %.0f dB\n",
+	  levels[0], levels[1], far_level);
+  return 0;
+}
+
+static int
+test_decimated_pipeline (void)
+{
+  printf ("  Testing tap feeding a decimated analyzer...\n");
+
+  static RouterSpectrumTap tap;
+  router_spectrum_tap_init (&tap);
+  router_spectrum_tap_set_decimation (&tap, 4);
+  RouterSpectrumAnalyzer analyzer;
+  if (router_spectrum_analyzer_init (&analyzer, 1024, 48, TEST_RATE / 4) != 0)
+    {
+      printf ("    ❌ FAIL: Could not create analyzer\n");
+      return 1;
+    }
+
+  // 1 kHz 正弦，幅度 0.5，分 512 帧一块写入抽头后送入分析器
+  float block[2 * 512];
+  float samples[512];
+  uint32_t phase = 0;
+  for (uint32_t b = 0; b < 16; b++)
+    {
+      for (uint32_t f = 0; f < 512; f++, phase++)
+	{
+	  float s = 0.5f * (float) sin (2.0 * TEST_PI * 1000.0 * phase
+					/ TEST_RATE);
+	  block[2 * f] = s;
+	  block[2 * f + 1] = s;
+	}
+      router_spectrum_tap_push (&tap, block, 512, 2);
+      uint32_t count = router_spectrum_tap_read (&tap, samples, 512);
+      router_spectrum_analyzer_push (&analyzer, samples, count);
+    }
+  float bands[48];
+  router_spectrum_analyzer_compute (&analyzer, bands);
+  uint32_t loudest = 0;
+  for (uint32_t b = 1; b < 48; b++)
+    if (bands[b] > bands[loudest])
+      loudest = b;
+  uint32_t expected = band_of (&analyzer, 1000.0);
+  float level = bands[expected];
+  router_spectrum_analyzer_destroy (&analyzer);
+
+  // 非 2 的幂、频带数越界、奈奎斯特频率低于最低频带
+  RouterSpectrumAnalyzer bad;
+  bool rejects = router_spectrum_analyzer_init (&bad, 1000, 48, TEST_RATE) != 0
+		 && router_spectrum_analyzer_init (&bad, 1024, 0, TEST_RATE)
+		      != 0
+		 && router_spectrum_analyzer_init (
+		      &bad, 1024, ROUTER_SPECTRUM_MAX_BANDS + 1, TEST_RATE)
+		      != 0
+		 && router_spectrum_analyzer_init (&bad, 1024, 48, 40) != 0;
+
+  // 0.5 幅度为 -6.02 dB，频点间的扇贝损失不超过 1.5 dB
+  if (loudest != expected || level > -5.9f || level < -7.7f || !rejects)
+    {
+      printf ("    ❌ FAIL: Peak in band %u (expected %u) at %.2f dB, "
+	      "rejects %d\n",
+	      loudest, expected, level, rejects);
+      return 1;
+    }
+
+  printf ("    ✅ PASS: 1 kHz at 12 kHz analysis rate reads %.2f dBFS\n",
+	  level);
+  return 0;
+}
+
+// 4 倍抽取时 10 kHz 正弦折叠到 2 kHz：读数即抗混叠滤波器的衰减
+static int
+test_anti_alias (void)
+{
+  printf ("  Testing anti-alias filter before decimation...\n");
+
+  static RouterSpectrumTap tap;
+  router_spectrum_tap_init (&tap);
+  router_spectrum_tap_set_decimation (&tap, 4);
+  RouterSpectrumAnalyzer analyzer;
+  if (router_spectrum_analyzer_init (&analyzer, 1024, 48, TEST_RATE / 4) != 0)
+    {
+      printf ("    ❌ FAIL: Could not create analyzer\n");
+      return 1;
+    }
+
+  float block[2 * 512];
+  float samples[512];
+  uint32_t phase = 0;
+  for (uint32_t b = 0; b < 16; b++)
+    {
+      for (uint32_t f = 0; f < 512; f++, phase++)
+	{
+	  float s = (float) sin (2.0 * TEST_PI * 10000.0 * phase / TEST_RATE);
+	  block[2 * f] = s;
+	  block[2 * f + 1] = s;
+	}
+      router_spectrum_tap_push (&tap, block, 512, 2);
+      uint32_t count = router_spectrum_tap_read (&tap, samples, 512);
+      router_spectrum_analyzer_push (&analyzer, samples, count);
+    }
+  float bands[48];
+  router_spectrum_analyzer_compute (&analyzer, bands);
+  float alias = bands[band_of (&analyzer, 2000.0)];
+  router_spectrum_analyzer_destroy (&analyzer);
+
+  // 4 点平均只衰减约 14 dB；8 阶低通在 2.08 倍截止频率处衰减 50 dB 以上
+  if (alias > -45.0f)
+    {
+      printf ("    ❌ FAIL: 10 kHz folds to 2 kHz at %.1f dBFS\n", alias);
+      return 1;
+    }
+
+  printf ("    ✅ PASS: 10 kHz alias at 2 kHz reads %.1f dBFS\n", alias);
+  return 0;
+}
+
+int
+run_router_spectrum_tests (void)
+{
+  printf ("\n----------------------------------------\n");
+  printf ("Router Spectrum Tests\n");
+  printf ("----------------------------------------\n");
+
+  int failed = 0;
+  failed += test_tap ();
+  failed += test_analyzer ();
+  failed += test_decimated_pipeline ();
+  failed += test_anti_alias ();
+
+  printf ("----------------------------------------\n");
+  if (failed == 0)
+    {
+      printf ("Router Spectrum Tests: PASSED ✅\n");
+    }
+  else
+    {
+      printf ("Router Spectrum Tests: %d FAILED ❌\n", failed);
+    }
+  printf ("----------------------------------------\n");
+
+  return failed;
+}